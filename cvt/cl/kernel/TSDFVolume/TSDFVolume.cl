@@ -227,8 +227,8 @@ __kernel void TSDFVolume_rayCastDepthmap( write_only image2d_t out, global float
 
 			if ( val_prev > 0.0f && val < 0.0f) {
 				float alpha = -val / ( val_prev - val );
-				float3 gpos = ( mix( pos.z, pos_prev.z, alpha ) );
-				ret = fmax( -( mat4f_transform( &TG2CAM, ( float4 ) ( gpos, 1.0f ) ).z ) * scale, 0.0f );
+				float3 gpos = mix( pos, pos_prev, alpha );
+				ret = fmax( mat4f_transform( &TG2CAM, ( float4 ) ( gpos, 1.0f ) ).z * scale, 0.0f );
 				break;
 			}
 			val_prev = val;
@@ -25,6 +25,7 @@
 
 #include "MarchingCubes.h"
 #include <cvt/math/Math.h>
+#include <cvt/util/ParallelRows.h>
 
 namespace cvt {
 
@@ -322,524 +323,342 @@ namespace cvt {
 
 
 
-	void MarchingCubes::triangulateDistance( SceneMesh& mesh, float isolevel ) const
+	/* axis and lower corner offset of the cube edges */
+	static const int _edgeAxis[ 12 ] = { 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2 };
+	static const int _edgeOffset[ 12 ][ 3 ] = {
+		{ 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 0 },
+		{ 0, 0, 1 }, { 1, 0, 1 }, { 0, 1, 1 }, { 0, 0, 1 },
+		{ 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 }
+	};
+
+	/* triangles of one block layer, vertices on the bottom and top plane are stitched with the neighbouring slabs */
+	struct MarchingCubes::Slab {
+		std::vector<Vector3f>		vertices;
+		std::vector<Vector3f>		normals;
+		std::vector<unsigned int>	faces;
+		/* ( plane edge, vertex ) for the x/y-edges in the first and last plane of the slab */
+		std::vector<std::pair<unsigned int, unsigned int> > bottom;
+		std::vector<std::pair<unsigned int, unsigned int> > top;
+		/* global index of the slab vertices */
+		std::vector<unsigned int>	global;
+		size_t						vertexOffset;
+		size_t						faceOffset;
+	};
+
+	/* cell range [ c0, cend ) in each dimension and the blocks covering it */
+	struct MarchingCubesGrid {
+		size_t c0;
+		size_t cend[ 3 ];
+		size_t nblocks[ 3 ];
+	};
+
+	static inline float _mcValue( const float* volume, size_t idx, bool weighted )
 	{
-		float gridval[ 8 ];
-		Vector3f gridvtx[ 8 ];
-		int cubeindex;
-		Vector3f vertlist[ 12 ];
-		size_t vtxIdx = 0;
-		std::vector<Vector3f> vertices;
-		std::vector<unsigned int> faces;
-
-		size_t xend = _width - 1;
-		size_t yend = _height - 1;
-		size_t zend = _depth - 1;
-
-		for( size_t z = 0; z < zend; z++  ) {
-			for( size_t y = 0; y < yend; y++ ) {
-				for( size_t x = 0; x < xend; x++ ) {
-
-#define VOLUME( x, y, z ) _volume[ ( ( z ) * _height + ( y ) ) * _width + ( x ) ]
-					/* get the values of the current grid voxel */
-					gridval[ 0 ] = VOLUME( x, y, z );
-					gridval[ 1 ] = VOLUME( x + 1, y, z );
-					gridval[ 2 ] = VOLUME( x + 1, y + 1, z );
-					gridval[ 3 ] = VOLUME( x, y + 1, z );
-					gridval[ 4 ] = VOLUME( x, y, z + 1 );
-					gridval[ 5 ] = VOLUME( x + 1, y, z + 1 );
-					gridval[ 6 ] = VOLUME( x + 1, y + 1, z + 1);
-					gridval[ 7 ] = VOLUME( x, y + 1, z + 1 );
-#undef VOLUME
-
-					/*
-					   Determine the index into the edge table which
-					   tells us which vertices are inside of the surface
-					 */
-					cubeindex = 0;
-					if( gridval[ 0 ] < isolevel ) cubeindex |= 1;
-					if( gridval[ 1 ] < isolevel ) cubeindex |= 2;
-					if( gridval[ 2 ] < isolevel ) cubeindex |= 4;
-					if( gridval[ 3 ] < isolevel ) cubeindex |= 8;
-					if( gridval[ 4 ] < isolevel ) cubeindex |= 16;
-					if( gridval[ 5 ] < isolevel ) cubeindex |= 32;
-					if( gridval[ 6 ] < isolevel ) cubeindex |= 64;
-					if( gridval[ 7 ] < isolevel ) cubeindex |= 128;
-
-					/* Cube is entirely in/out of the surface */
-					if ( _edgeTable[ cubeindex ] == 0)
-						continue;
-
-					/* set the vertex positions of the current cell */
-					gridvtx[ 0 ].set( x, y, z );
-					gridvtx[ 1 ].set( x + 1, y, z );
-					gridvtx[ 2 ].set( x + 1, y + 1, z );
-					gridvtx[ 3 ].set( x, y + 1, z );
-					gridvtx[ 4 ].set( x, y, z + 1 );
-					gridvtx[ 5 ].set( x + 1, y, z + 1 );
-					gridvtx[ 6 ].set( x + 1, y + 1, z + 1);
-					gridvtx[ 7 ].set( x, y + 1, z + 1 );
-
-
-					/* Find the vertices where the surface intersects the cube */
-					if ( _edgeTable[ cubeindex ] & 1)
-						vertexInterp( vertlist[ 0 ], gridvtx[ 0 ], gridvtx[ 1 ], gridval[ 0 ], gridval[ 1 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 2)
-						vertexInterp( vertlist[ 1 ], gridvtx[ 1 ], gridvtx[ 2 ], gridval[ 1 ], gridval[ 2 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 4)
-						vertexInterp( vertlist[ 2 ], gridvtx[ 2 ], gridvtx[ 3 ], gridval[ 2 ], gridval[ 3 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 8)
-						vertexInterp( vertlist[ 3 ], gridvtx[ 3 ], gridvtx[ 0 ], gridval[ 3 ], gridval[ 0 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 16)
-						vertexInterp( vertlist[ 4 ], gridvtx[ 4 ], gridvtx[ 5 ], gridval[ 4 ], gridval[ 5 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 32)
-						vertexInterp( vertlist[ 5 ], gridvtx[ 5 ], gridvtx[ 6 ], gridval[ 5 ], gridval[ 6 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 64)
-						vertexInterp( vertlist[ 6 ], gridvtx[ 6 ], gridvtx[ 7 ], gridval[ 6 ], gridval[ 7 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 128)
-						vertexInterp( vertlist[ 7 ], gridvtx[ 7 ], gridvtx[ 4 ], gridval[ 7 ], gridval[ 4 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 256)
-						vertexInterp( vertlist[ 8 ], gridvtx[ 0 ], gridvtx[ 4 ], gridval[ 0 ], gridval[ 4 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 512)
-						vertexInterp( vertlist[ 9 ], gridvtx[ 1 ], gridvtx[ 5 ], gridval[ 1 ], gridval[ 5 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 1024)
-						vertexInterp( vertlist[ 10 ], gridvtx[ 2 ], gridvtx[ 6 ], gridval[ 2 ], gridval[ 6 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 2048)
-						vertexInterp( vertlist[ 11 ], gridvtx[ 3 ], gridvtx[ 7 ], gridval[ 3 ], gridval[ 7 ], isolevel );
-
-					/* Create the triangle */
-					for( int i = 0; _triTable[ cubeindex ][ i ] !=-1; i += 3 ) {
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i     ] ] );
-						faces.push_back( vtxIdx++ );
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i + 1 ] ] );
-						faces.push_back( vtxIdx++ );
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i + 2 ] ] );
-						faces.push_back( vtxIdx++ );
-					}
-				}
-			}
-		}
-		mesh.clear();
-		mesh.setVertices( &vertices[ 0 ], vertices.size() );
-		mesh.setFaces( &faces[ 0 ], faces.size(), SCENEMESH_TRIANGLES );
+		return weighted ? volume[ 2 * idx ] : volume[ idx ];
 	}
 
-	void MarchingCubes::triangulateWithNormalsDistance( SceneMesh& mesh, float isolevel ) const
+	static inline bool _mcValid( const float* volume, size_t idx, bool weighted, float minweight )
 	{
-		float gridval[ 8 ];
-		Vector3f gridvtx[ 8 ];
-		Vector3f gridnormal[ 8 ];
-		int cubeindex;
-		Vector3f vertlist[ 12 ];
-		Vector3f normlist[ 12 ];
-		size_t vtxIdx = 0;
-		std::vector<Vector3f> vertices;
-		std::vector<Vector3f> normals;
-		std::vector<unsigned int> faces;
-
-		size_t xend = _width - 2;
-		size_t yend = _height - 2;
-		size_t zend = _depth - 2;
-		for( size_t z = 1; z < zend; z++  ) {
-			for( size_t y = 1; y < yend; y++ ) {
-				for( size_t x = 1; x < xend; x++ ) {
-
-#define VOLUME( x, y, z ) _volume[ ( ( z ) * _height + ( y ) ) * _width + ( x ) ]
-					/* get the values of the current grid voxel */
-					gridval[ 0 ] = VOLUME( x, y, z );
-					gridval[ 1 ] = VOLUME( x + 1, y, z );
-					gridval[ 2 ] = VOLUME( x + 1, y + 1, z );
-					gridval[ 3 ] = VOLUME( x, y + 1, z );
-					gridval[ 4 ] = VOLUME( x, y, z + 1 );
-					gridval[ 5 ] = VOLUME( x + 1, y, z + 1 );
-					gridval[ 6 ] = VOLUME( x + 1, y + 1, z + 1);
-					gridval[ 7 ] = VOLUME( x, y + 1, z + 1 );
-
-					/*
-					   Determine the index into the edge table which
-					   tells us which vertices are inside of the surface
-					 */
-					cubeindex = 0;
-					if( gridval[ 0 ] < isolevel ) cubeindex |= 1;
-					if( gridval[ 1 ] < isolevel ) cubeindex |= 2;
-					if( gridval[ 2 ] < isolevel ) cubeindex |= 4;
-					if( gridval[ 3 ] < isolevel ) cubeindex |= 8;
-					if( gridval[ 4 ] < isolevel ) cubeindex |= 16;
-					if( gridval[ 5 ] < isolevel ) cubeindex |= 32;
-					if( gridval[ 6 ] < isolevel ) cubeindex |= 64;
-					if( gridval[ 7 ] < isolevel ) cubeindex |= 128;
-
-					/* Cube is entirely in/out of the surface */
-					if ( _edgeTable[ cubeindex ] == 0)
-						continue;
-
-					/* set the vertex positions of the current cell */
-					gridvtx[ 0 ].set( x, y, z );
-					gridvtx[ 1 ].set( x + 1, y, z );
-					gridvtx[ 2 ].set( x + 1, y + 1, z );
-					gridvtx[ 3 ].set( x, y + 1, z );
-					gridvtx[ 4 ].set( x, y, z + 1 );
-					gridvtx[ 5 ].set( x + 1, y, z + 1 );
-					gridvtx[ 6 ].set( x + 1, y + 1, z + 1);
-					gridvtx[ 7 ].set( x, y + 1, z + 1 );
-
-#define VOLNORMAL( x, y, z )   -Vector3f( VOLUME( ( x ) + 1, ( y ), ( z ) ) - VOLUME( ( x ) - 1, ( y ), ( z ) ), \
-										 VOLUME( ( x ), ( y ) + 1, ( z ) ) - VOLUME( ( x ) , ( y ) - 1, ( z ) ), \
-										 VOLUME( ( x ), ( y ), ( z ) + 1 ) - VOLUME( ( x ) , ( y ), ( z ) - 1 ) )
-
-					gridnormal[ 0 ] = VOLNORMAL( x, y, z );
-					gridnormal[ 1 ] = VOLNORMAL( x + 1, y, z );
-					gridnormal[ 2 ] = VOLNORMAL( x + 1, y + 1, z );
-					gridnormal[ 3 ] = VOLNORMAL( x, y + 1, z );
-					gridnormal[ 4 ] = VOLNORMAL( x, y, z + 1 );
-					gridnormal[ 5 ] = VOLNORMAL( x + 1, y, z + 1 );
-					gridnormal[ 6 ] = VOLNORMAL( x + 1, y + 1, z + 1);
-					gridnormal[ 7 ] = VOLNORMAL( x, y + 1, z + 1 );
-
-#undef VOLNORMAL
-#undef VOLUME
-					/* Find the vertices where the surface intersects the cube */
-					if ( _edgeTable[ cubeindex ] & 1)
-						vertexNormalInterp( vertlist[ 0 ], gridvtx[ 0 ], gridvtx[ 1 ],
-										    normlist[ 0 ], gridnormal[ 0 ], gridnormal[ 1 ],
-										    gridval[ 0 ], gridval[ 1 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 2)
-						vertexNormalInterp( vertlist[ 1 ], gridvtx[ 1 ], gridvtx[ 2 ],
-										    normlist[ 1 ], gridnormal[ 1 ], gridnormal[ 2 ],
-										    gridval[ 1 ], gridval[ 2 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 4)
-						vertexNormalInterp( vertlist[ 2 ], gridvtx[ 2 ], gridvtx[ 3 ],
-										    normlist[ 2 ], gridnormal[ 2 ], gridnormal[ 3 ],
-										    gridval[ 2 ], gridval[ 3 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 8)
-						vertexNormalInterp( vertlist[ 3 ], gridvtx[ 3 ], gridvtx[ 0 ],
-										    normlist[ 3 ], gridnormal[ 3 ], gridnormal[ 0 ],
-										    gridval[ 3 ], gridval[ 0 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 16)
-						vertexNormalInterp( vertlist[ 4 ], gridvtx[ 4 ], gridvtx[ 5 ],
-										    normlist[ 4 ], gridnormal[ 4 ], gridnormal[ 5 ],
-										    gridval[ 4 ], gridval[ 5 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 32)
-						vertexNormalInterp( vertlist[ 5 ], gridvtx[ 5 ], gridvtx[ 6 ],
-										    normlist[ 5 ], gridnormal[ 5 ], gridnormal[ 6 ],
-										    gridval[ 5 ], gridval[ 6 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 64)
-						vertexNormalInterp( vertlist[ 6 ], gridvtx[ 6 ], gridvtx[ 7 ],
-										    normlist[ 6 ], gridnormal[ 6 ], gridnormal[ 7 ],
-										    gridval[ 6 ], gridval[ 7 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 128)
-						vertexNormalInterp( vertlist[ 7 ], gridvtx[ 7 ], gridvtx[ 4 ],
-										    normlist[ 7 ], gridnormal[ 7 ], gridnormal[ 4 ],
-										    gridval[ 7 ], gridval[ 4 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 256)
-						vertexNormalInterp( vertlist[ 8 ], gridvtx[ 0 ], gridvtx[ 4 ],
-										    normlist[ 8 ], gridnormal[ 0 ], gridnormal[ 4 ],
-										    gridval[ 0 ], gridval[ 4 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 512)
-						vertexNormalInterp( vertlist[ 9 ], gridvtx[ 1 ], gridvtx[ 5 ],
-										    normlist[ 9 ], gridnormal[ 1 ], gridnormal[ 5 ],
-										    gridval[ 1 ], gridval[ 5 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 1024)
-						vertexNormalInterp( vertlist[ 10 ], gridvtx[ 2 ], gridvtx[ 6 ],
-										    normlist[ 10 ], gridnormal[ 2 ], gridnormal[ 6 ],
-										    gridval[ 2 ], gridval[ 6 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 2048)
-						vertexNormalInterp( vertlist[ 11 ], gridvtx[ 3 ], gridvtx[ 7 ],
-										    normlist[ 11 ], gridnormal[ 3 ], gridnormal[ 7 ],
-										    gridval[ 3 ], gridval[ 7 ], isolevel );
-
-					/* Create the triangle */
-					for( int i = 0; _triTable[ cubeindex ][ i ] !=-1; i += 3 ) {
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i     ] ] );
-						normals.push_back( normlist[ _triTable[ cubeindex ][ i     ] ] );
-						faces.push_back( vtxIdx++ );
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i + 1 ] ] );
-						normals.push_back( normlist[ _triTable[ cubeindex ][ i + 1 ] ] );
-						faces.push_back( vtxIdx++ );
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i + 2 ] ] );
-						normals.push_back( normlist[ _triTable[ cubeindex ][ i + 2 ] ] );
-						faces.push_back( vtxIdx++ );
+		return !weighted || volume[ 2 * idx + 1 ] > minweight;
+	}
+
+	/* value range of the valid voxels of each block, a block is active if it contains the isolevel */
+	class MarchingCubes::BlockRows : public ParallelRows::Body {
+		public:
+			BlockRows( const MarchingCubes& mc, const MarchingCubesGrid& grid, float isolevel, std::vector<uint8_t>& active ) :
+				_mc( mc ), _grid( grid ), _isolevel( isolevel ), _active( active )
+			{
+			}
+
+			void process( size_t bzstart, size_t bzend ) const
+			{
+				const size_t B = MarchingCubes::BLOCK_SIZE;
+				for( size_t bz = bzstart; bz < bzend; bz++ ) {
+					for( size_t by = 0; by < _grid.nblocks[ 1 ]; by++ ) {
+						for( size_t bx = 0; bx < _grid.nblocks[ 0 ]; bx++ ) {
+							/* the cells [ start, end ) use the voxels [ start, end ] */
+							size_t xs = _grid.c0 + bx * B, xe = Math::min( xs + B, _grid.cend[ 0 ] );
+							size_t ys = _grid.c0 + by * B, ye = Math::min( ys + B, _grid.cend[ 1 ] );
+							size_t zs = _grid.c0 + bz * B, ze = Math::min( zs + B, _grid.cend[ 2 ] );
+							bool below = false, above = false;
+
+							for( size_t z = zs; z <= ze && !( below && above ); z++ ) {
+								for( size_t y = ys; y <= ye; y++ ) {
+									size_t idx = ( z * _mc._height + y ) * _mc._width + xs;
+									for( size_t x = xs; x <= xe; x++, idx++ ) {
+										if( !_mcValid( _mc._volume, idx, _mc._weighted, _mc._minweight ) )
+											continue;
+										if( _mcValue( _mc._volume, idx, _mc._weighted ) < _isolevel )
+											below = true;
+										else
+											above = true;
+									}
+								}
+							}
+							_active[ ( bz * _grid.nblocks[ 1 ] + by ) * _grid.nblocks[ 0 ] + bx ] = below && above;
+						}
 					}
 				}
 			}
+
+		private:
+			const MarchingCubes&		_mc;
+			const MarchingCubesGrid&	_grid;
+			float						_isolevel;
+			std::vector<uint8_t>&		_active;
+	};
+
+	class MarchingCubes::SlabRows : public ParallelRows::Body {
+		public:
+			SlabRows( const MarchingCubes& mc, const MarchingCubesGrid& grid, float isolevel, bool normals,
+					  const std::vector<uint8_t>& active, std::vector<Slab>& slabs ) :
+				_mc( mc ), _grid( grid ), _isolevel( isolevel ), _normals( normals ), _active( active ), _slabs( slabs )
+			{
+			}
+
+			void process( size_t start, size_t end ) const;
+
+		private:
+			/* edge cache entry, only valid if the stamp matches the current plane / layer */
+			struct CacheEntry {
+				uint32_t stamp;
+				uint32_t idx;
+			};
+
+			unsigned int edgeVertex( Slab& slab, CacheEntry* cache, uint32_t stamp, size_t x, size_t y, size_t z, int axis, bool bottom, bool top ) const;
+			Vector3f	 gradient( size_t x, size_t y, size_t z ) const;
+
+			const MarchingCubes&			_mc;
+			const MarchingCubesGrid&		_grid;
+			float							_isolevel;
+			bool							_normals;
+			const std::vector<uint8_t>&		_active;
+			std::vector<Slab>&				_slabs;
+	};
+
+	/* negative central difference gradient, the normal direction of the surface */
+	inline Vector3f MarchingCubes::SlabRows::gradient( size_t x, size_t y, size_t z ) const
+	{
+		size_t sx = 1, sy = _mc._width, sz = _mc._width * _mc._height;
+		size_t idx = z * sz + y * sy + x;
+		const float* v = _mc._volume;
+		bool w = _mc._weighted;
+		return -Vector3f( _mcValue( v, idx + sx, w ) - _mcValue( v, idx - sx, w ),
+						  _mcValue( v, idx + sy, w ) - _mcValue( v, idx - sy, w ),
+						  _mcValue( v, idx + sz, w ) - _mcValue( v, idx - sz, w ) );
+	}
+
+	/* vertex on the edge from voxel ( x, y, z ) along axis, created on the first request */
+	unsigned int MarchingCubes::SlabRows::edgeVertex( Slab& slab, CacheEntry* cache, uint32_t stamp, size_t x, size_t y, size_t z,
+													  int axis, bool bottom, bool top ) const
+	{
+		size_t pidx = y * _mc._width + x;
+		CacheEntry& entry = cache[ pidx ];
+		if( entry.stamp == stamp )
+			return entry.idx;
+
+		size_t x2 = x + ( axis == 0 ), y2 = y + ( axis == 1 ), z2 = z + ( axis == 2 );
+		size_t idx1 = ( z * _mc._height + y ) * _mc._width + x;
+		size_t idx2 = ( z2 * _mc._height + y2 ) * _mc._width + x2;
+		float val1 = _mcValue( _mc._volume, idx1, _mc._weighted );
+		float val2 = _mcValue( _mc._volume, idx2, _mc._weighted );
+		Vector3f p1( x, y, z ), p2( x2, y2, z2 ), vtx;
+
+		/* always interpolate from the lower voxel, neighbouring slabs create the same vertex */
+		if( _normals ) {
+			Vector3f norm;
+			_mc.vertexNormalInterp( vtx, p1, p2, norm, gradient( x, y, z ), gradient( x2, y2, z2 ), val1, val2, _isolevel );
+			slab.normals.push_back( norm );
+		} else {
+			_mc.vertexInterp( vtx, p1, p2, val1, val2, _isolevel );
 		}
-		mesh.clear();
-		mesh.setVertices( &vertices[ 0 ], vertices.size() );
-		mesh.setNormals( &normals[ 0 ], normals.size() );
-		mesh.setFaces( &faces[ 0 ], faces.size(), SCENEMESH_TRIANGLES );
+
+		entry.stamp = stamp;
+		entry.idx = slab.vertices.size();
+		slab.vertices.push_back( vtx );
+
+		if( axis != 2 ) {
+			unsigned int key = pidx * 2 + axis;
+			if( bottom )
+				slab.bottom.push_back( std::make_pair( key, entry.idx ) );
+			if( top )
+				slab.top.push_back( std::make_pair( key, entry.idx ) );
+		}
+		return entry.idx;
 	}
 
-	void MarchingCubes::triangulateWeightedDistance( SceneMesh& mesh, float isolevel ) const
+	void MarchingCubes::SlabRows::process( size_t start, size_t end ) const
 	{
-		const float WEIGHT_EPSILON = _minweight;
-		float gridval[ 8 ];
-		Vector3f gridvtx[ 8 ];
-		int cubeindex;
-		Vector3f vertlist[ 12 ];
-		size_t vtxIdx = 0;
-		std::vector<Vector3f> vertices;
-		std::vector<unsigned int> faces;
-
-		size_t xend = _width - 1;
-		size_t yend = _height - 1;
-		size_t zend = _depth - 1;
-
-		for( size_t z = 0; z < zend; z++  ) {
-			for( size_t y = 0; y < yend; y++ ) {
-				for( size_t x = 0; x < xend; x++ ) {
-
-#define VOLUME( x, y, z ) _volume[ ( ( ( z ) * _height + ( y ) ) * _width + ( x ) ) * 2 ]
-#define VOLUMEWEIGHT( x, y, z ) _volume[ ( ( ( z ) * _height + ( y ) ) * _width + ( x ) ) * 2 + 1 ]
-
-					/* get the values of the current grid voxel */
-					gridval[ 0 ] = VOLUME( x, y, z );
-					if( VOLUMEWEIGHT( x, y, z ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 1 ] = VOLUME( x + 1, y, z );
-					if( VOLUMEWEIGHT( x + 1, y, z ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 2 ] = VOLUME( x + 1, y + 1, z );
-					if( VOLUMEWEIGHT( x + 1, y + 1, z ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 3 ] = VOLUME( x, y + 1, z );
-					if( VOLUMEWEIGHT( x, y + 1, z ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 4 ] = VOLUME( x, y, z + 1 );
-					if( VOLUMEWEIGHT( x, y, z + 1 ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 5 ] = VOLUME( x + 1, y, z + 1 );
-					if( VOLUMEWEIGHT( x + 1, y, z + 1 ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 6 ] = VOLUME( x + 1, y + 1, z + 1);
-					if( VOLUMEWEIGHT( x + 1, y + 1, z + 1 ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 7 ] = VOLUME( x, y + 1, z + 1 );
-					if( VOLUMEWEIGHT( x, y + 1, z + 1 ) <= WEIGHT_EPSILON ) continue;
-#undef VOLUME
-
-					/*
-					   Determine the index into the edge table which
-					   tells us which vertices are inside of the surface
-					 */
-					cubeindex = 0;
-					if( gridval[ 0 ] < isolevel ) cubeindex |= 1;
-					if( gridval[ 1 ] < isolevel ) cubeindex |= 2;
-					if( gridval[ 2 ] < isolevel ) cubeindex |= 4;
-					if( gridval[ 3 ] < isolevel ) cubeindex |= 8;
-					if( gridval[ 4 ] < isolevel ) cubeindex |= 16;
-					if( gridval[ 5 ] < isolevel ) cubeindex |= 32;
-					if( gridval[ 6 ] < isolevel ) cubeindex |= 64;
-					if( gridval[ 7 ] < isolevel ) cubeindex |= 128;
-
-					/* Cube is entirely in/out of the surface */
-					if ( _edgeTable[ cubeindex ] == 0)
-						continue;
-
-					/* set the vertex positions of the current cell */
-					gridvtx[ 0 ].set( x, y, z );
-					gridvtx[ 1 ].set( x + 1, y, z );
-					gridvtx[ 2 ].set( x + 1, y + 1, z );
-					gridvtx[ 3 ].set( x, y + 1, z );
-					gridvtx[ 4 ].set( x, y, z + 1 );
-					gridvtx[ 5 ].set( x + 1, y, z + 1 );
-					gridvtx[ 6 ].set( x + 1, y + 1, z + 1);
-					gridvtx[ 7 ].set( x, y + 1, z + 1 );
-
-
-					/* Find the vertices where the surface intersects the cube */
-					if ( _edgeTable[ cubeindex ] & 1)
-						vertexInterp( vertlist[ 0 ], gridvtx[ 0 ], gridvtx[ 1 ], gridval[ 0 ], gridval[ 1 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 2)
-						vertexInterp( vertlist[ 1 ], gridvtx[ 1 ], gridvtx[ 2 ], gridval[ 1 ], gridval[ 2 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 4)
-						vertexInterp( vertlist[ 2 ], gridvtx[ 2 ], gridvtx[ 3 ], gridval[ 2 ], gridval[ 3 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 8)
-						vertexInterp( vertlist[ 3 ], gridvtx[ 3 ], gridvtx[ 0 ], gridval[ 3 ], gridval[ 0 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 16)
-						vertexInterp( vertlist[ 4 ], gridvtx[ 4 ], gridvtx[ 5 ], gridval[ 4 ], gridval[ 5 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 32)
-						vertexInterp( vertlist[ 5 ], gridvtx[ 5 ], gridvtx[ 6 ], gridval[ 5 ], gridval[ 6 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 64)
-						vertexInterp( vertlist[ 6 ], gridvtx[ 6 ], gridvtx[ 7 ], gridval[ 6 ], gridval[ 7 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 128)
-						vertexInterp( vertlist[ 7 ], gridvtx[ 7 ], gridvtx[ 4 ], gridval[ 7 ], gridval[ 4 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 256)
-						vertexInterp( vertlist[ 8 ], gridvtx[ 0 ], gridvtx[ 4 ], gridval[ 0 ], gridval[ 4 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 512)
-						vertexInterp( vertlist[ 9 ], gridvtx[ 1 ], gridvtx[ 5 ], gridval[ 1 ], gridval[ 5 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 1024)
-						vertexInterp( vertlist[ 10 ], gridvtx[ 2 ], gridvtx[ 6 ], gridval[ 2 ], gridval[ 6 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 2048)
-						vertexInterp( vertlist[ 11 ], gridvtx[ 3 ], gridvtx[ 7 ], gridval[ 3 ], gridval[ 7 ], isolevel );
-
-					/* Create the triangle */
-					for( int i = 0; _triTable[ cubeindex ][ i ] !=-1; i += 3 ) {
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i     ] ] );
-						faces.push_back( vtxIdx++ );
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i + 1 ] ] );
-						faces.push_back( vtxIdx++ );
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i + 2 ] ] );
-						faces.push_back( vtxIdx++ );
+		const size_t B = MarchingCubes::BLOCK_SIZE;
+		const float* volume = _mc._volume;
+		size_t width = _mc._width;
+		size_t plane = _mc._width * _mc._height;
+		bool weighted = _mc._weighted;
+		float minweight = _mc._minweight;
+
+		/* x- and y-edges of two planes ( by parity ) and z-edges of the current layer */
+		std::vector<CacheEntry> cachemem( plane * 5 );
+		for( size_t i = 0; i < cachemem.size(); i++ )
+			cachemem[ i ].stamp = 0;
+		CacheEntry* xcache[ 2 ] = { &cachemem[ 0 ], &cachemem[ plane ] };
+		CacheEntry* ycache[ 2 ] = { &cachemem[ 2 * plane ], &cachemem[ 3 * plane ] };
+		CacheEntry* zcache = &cachemem[ 4 * plane ];
+		uint32_t stampbase = 1;
+
+		const size_t corner[ 8 ][ 3 ] = {
+			{ 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 },
+			{ 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 }
+		};
+		size_t cornerOffset[ 8 ];
+		for( int i = 0; i < 8; i++ )
+			cornerOffset[ i ] = corner[ i ][ 2 ] * plane + corner[ i ][ 1 ] * width + corner[ i ][ 0 ];
+
+		std::vector<std::pair<size_t, size_t> > blocks;
+
+		for( size_t bz = start; bz < end; bz++ ) {
+			Slab& slab = _slabs[ bz ];
+			size_t z0 = _grid.c0 + bz * B;
+			size_t z1 = Math::min( z0 + B, _grid.cend[ 2 ] );
+
+			blocks.clear();
+			for( size_t by = 0; by < _grid.nblocks[ 1 ]; by++ )
+				for( size_t bx = 0; bx < _grid.nblocks[ 0 ]; bx++ )
+					if( _active[ ( bz * _grid.nblocks[ 1 ] + by ) * _grid.nblocks[ 0 ] + bx ] )
+						blocks.push_back( std::make_pair( bx, by ) );
+
+			for( size_t z = z0; z < z1; z++ ) {
+				/* stamps of the planes z, z + 1 and of the layer z */
+				uint32_t pstamp[ 2 ] = { stampbase + ( uint32_t ) ( z - z0 ), stampbase + ( uint32_t ) ( z - z0 ) + 1 };
+
+				for( size_t b = 0; b < blocks.size(); b++ ) {
+					size_t xs = _grid.c0 + blocks[ b ].first * B, xe = Math::min( xs + B, _grid.cend[ 0 ] );
+					size_t ys = _grid.c0 + blocks[ b ].second * B, ye = Math::min( ys + B, _grid.cend[ 1 ] );
+
+					for( size_t y = ys; y < ye; y++ ) {
+						for( size_t x = xs; x < xe; x++ ) {
+							size_t idx = ( z * _mc._height + y ) * width + x;
+							int cubeindex = 0;
+							bool valid = true;
+
+							for( int i = 0; i < 8 && valid; i++ ) {
+								valid = _mcValid( volume, idx + cornerOffset[ i ], weighted, minweight );
+								if( _mcValue( volume, idx + cornerOffset[ i ], weighted ) < _isolevel )
+									cubeindex |= 1 << i;
+							}
+
+							/* Cube is entirely in/out of the surface */
+							if( !valid || _edgeTable[ cubeindex ] == 0 )
+								continue;
+
+							unsigned int vertlist[ 12 ];
+							for( int e = 0; e < 12; e++ ) {
+								if( !( _edgeTable[ cubeindex ] & ( 1 << e ) ) )
+									continue;
+								size_t ex = x + _edgeOffset[ e ][ 0 ];
+								size_t ey = y + _edgeOffset[ e ][ 1 ];
+								size_t ez = z + _edgeOffset[ e ][ 2 ];
+								int axis = _edgeAxis[ e ];
+								if( axis == 2 ) {
+									vertlist[ e ] = edgeVertex( slab, zcache, pstamp[ 0 ], ex, ey, ez, axis, false, false );
+								} else {
+									int p = _edgeOffset[ e ][ 2 ];
+									CacheEntry* cache = axis == 0 ? xcache[ ez & 1 ] : ycache[ ez & 1 ];
+									vertlist[ e ] = edgeVertex( slab, cache, pstamp[ p ], ex, ey, ez, axis, ez == z0, ez == z1 );
+								}
+							}
+
+							/* Create the triangles */
+							for( int i = 0; _triTable[ cubeindex ][ i ] != -1; i++ )
+								slab.faces.push_back( vertlist[ _triTable[ cubeindex ][ i ] ] );
+						}
 					}
 				}
 			}
+			/* the planes of the next slab get new stamps */
+			stampbase += ( uint32_t ) ( z1 - z0 ) + 2;
 		}
-		mesh.clear();
-		mesh.setVertices( &vertices[ 0 ], vertices.size() );
-		mesh.setFaces( &faces[ 0 ], faces.size(), SCENEMESH_TRIANGLES );
 	}
 
-	void MarchingCubes::triangulateWithNormalsWeightedDistance( SceneMesh& mesh, float isolevel ) const
+	void MarchingCubes::extract( SceneMesh& mesh, float isolevel, bool normals ) const
 	{
-		const float WEIGHT_EPSILON = _minweight;
-		float gridval[ 8 ];
-		Vector3f gridvtx[ 8 ];
-		Vector3f gridnormal[ 8 ];
-		int cubeindex;
-		Vector3f vertlist[ 12 ];
-		Vector3f normlist[ 12 ];
-		size_t vtxIdx = 0;
-		std::vector<Vector3f> vertices;
-		std::vector<Vector3f> normals;
-		std::vector<unsigned int> faces;
-
-		size_t xend = _width - 2;
-		size_t yend = _height - 2;
-		size_t zend = _depth - 2;
-		for( size_t z = 1; z < zend; z++  ) {
-			for( size_t y = 1; y < yend; y++ ) {
-				for( size_t x = 1; x < xend; x++ ) {
-
-#define VOLUME( x, y, z ) _volume[ ( ( ( z ) * _height + ( y ) ) * _width + ( x ) ) * 2 ]
-#define VOLUMEWEIGHT( x, y, z ) _volume[ ( ( ( z ) * _height + ( y ) ) * _width + ( x ) ) * 2 + 1 ]
-
-					/* get the values of the current grid voxel */
-					gridval[ 0 ] = VOLUME( x, y, z );
-					if( VOLUMEWEIGHT( x, y, z ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 1 ] = VOLUME( x + 1, y, z );
-					if( VOLUMEWEIGHT( x + 1, y, z ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 2 ] = VOLUME( x + 1, y + 1, z );
-					if( VOLUMEWEIGHT( x + 1, y + 1, z ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 3 ] = VOLUME( x, y + 1, z );
-					if( VOLUMEWEIGHT( x, y + 1, z ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 4 ] = VOLUME( x, y, z + 1 );
-					if( VOLUMEWEIGHT( x, y, z + 1 ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 5 ] = VOLUME( x + 1, y, z + 1 );
-					if( VOLUMEWEIGHT( x + 1, y, z + 1 ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 6 ] = VOLUME( x + 1, y + 1, z + 1);
-					if( VOLUMEWEIGHT( x + 1, y + 1, z + 1 ) <= WEIGHT_EPSILON ) continue;
-					gridval[ 7 ] = VOLUME( x, y + 1, z + 1 );
-					if( VOLUMEWEIGHT( x, y + 1, z + 1 ) <= WEIGHT_EPSILON ) continue;
-
-					/*
-					   Determine the index into the edge table which
-					   tells us which vertices are inside of the surface
-					 */
-					cubeindex = 0;
-					if( gridval[ 0 ] < isolevel ) cubeindex |= 1;
-					if( gridval[ 1 ] < isolevel ) cubeindex |= 2;
-					if( gridval[ 2 ] < isolevel ) cubeindex |= 4;
-					if( gridval[ 3 ] < isolevel ) cubeindex |= 8;
-					if( gridval[ 4 ] < isolevel ) cubeindex |= 16;
-					if( gridval[ 5 ] < isolevel ) cubeindex |= 32;
-					if( gridval[ 6 ] < isolevel ) cubeindex |= 64;
-					if( gridval[ 7 ] < isolevel ) cubeindex |= 128;
-
-					/* Cube is entirely in/out of the surface */
-					if ( _edgeTable[ cubeindex ] == 0)
-						continue;
-
-					/* set the vertex positions of the current cell */
-					gridvtx[ 0 ].set( x, y, z );
-					gridvtx[ 1 ].set( x + 1, y, z );
-					gridvtx[ 2 ].set( x + 1, y + 1, z );
-					gridvtx[ 3 ].set( x, y + 1, z );
-					gridvtx[ 4 ].set( x, y, z + 1 );
-					gridvtx[ 5 ].set( x + 1, y, z + 1 );
-					gridvtx[ 6 ].set( x + 1, y + 1, z + 1);
-					gridvtx[ 7 ].set( x, y + 1, z + 1 );
-
-#define VOLNORMAL( x, y, z )   -Vector3f( VOLUME( ( x ) + 1, ( y ), ( z ) ) - VOLUME( ( x ) - 1, ( y ), ( z ) ), \
-										 VOLUME( ( x ), ( y ) + 1, ( z ) ) - VOLUME( ( x ) , ( y ) - 1, ( z ) ), \
-										 VOLUME( ( x ), ( y ), ( z ) + 1 ) - VOLUME( ( x ) , ( y ), ( z ) - 1 ) )
-
-					gridnormal[ 0 ] = VOLNORMAL( x, y, z );
-					gridnormal[ 1 ] = VOLNORMAL( x + 1, y, z );
-					gridnormal[ 2 ] = VOLNORMAL( x + 1, y + 1, z );
-					gridnormal[ 3 ] = VOLNORMAL( x, y + 1, z );
-					gridnormal[ 4 ] = VOLNORMAL( x, y, z + 1 );
-					gridnormal[ 5 ] = VOLNORMAL( x + 1, y, z + 1 );
-					gridnormal[ 6 ] = VOLNORMAL( x + 1, y + 1, z + 1);
-					gridnormal[ 7 ] = VOLNORMAL( x, y + 1, z + 1 );
-
-#undef VOLNORMAL
-#undef VOLUME
-#undef VOLUMEWEIGHT
-
-					/* Find the vertices where the surface intersects the cube */
-					if ( _edgeTable[ cubeindex ] & 1)
-						vertexNormalInterp( vertlist[ 0 ], gridvtx[ 0 ], gridvtx[ 1 ],
-										    normlist[ 0 ], gridnormal[ 0 ], gridnormal[ 1 ],
-										    gridval[ 0 ], gridval[ 1 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 2)
-						vertexNormalInterp( vertlist[ 1 ], gridvtx[ 1 ], gridvtx[ 2 ],
-										    normlist[ 1 ], gridnormal[ 1 ], gridnormal[ 2 ],
-										    gridval[ 1 ], gridval[ 2 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 4)
-						vertexNormalInterp( vertlist[ 2 ], gridvtx[ 2 ], gridvtx[ 3 ],
-										    normlist[ 2 ], gridnormal[ 2 ], gridnormal[ 3 ],
-										    gridval[ 2 ], gridval[ 3 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 8)
-						vertexNormalInterp( vertlist[ 3 ], gridvtx[ 3 ], gridvtx[ 0 ],
-										    normlist[ 3 ], gridnormal[ 3 ], gridnormal[ 0 ],
-										    gridval[ 3 ], gridval[ 0 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 16)
-						vertexNormalInterp( vertlist[ 4 ], gridvtx[ 4 ], gridvtx[ 5 ],
-										    normlist[ 4 ], gridnormal[ 4 ], gridnormal[ 5 ],
-										    gridval[ 4 ], gridval[ 5 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 32)
-						vertexNormalInterp( vertlist[ 5 ], gridvtx[ 5 ], gridvtx[ 6 ],
-										    normlist[ 5 ], gridnormal[ 5 ], gridnormal[ 6 ],
-										    gridval[ 5 ], gridval[ 6 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 64)
-						vertexNormalInterp( vertlist[ 6 ], gridvtx[ 6 ], gridvtx[ 7 ],
-										    normlist[ 6 ], gridnormal[ 6 ], gridnormal[ 7 ],
-										    gridval[ 6 ], gridval[ 7 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 128)
-						vertexNormalInterp( vertlist[ 7 ], gridvtx[ 7 ], gridvtx[ 4 ],
-										    normlist[ 7 ], gridnormal[ 7 ], gridnormal[ 4 ],
-										    gridval[ 7 ], gridval[ 4 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 256)
-						vertexNormalInterp( vertlist[ 8 ], gridvtx[ 0 ], gridvtx[ 4 ],
-										    normlist[ 8 ], gridnormal[ 0 ], gridnormal[ 4 ],
-										    gridval[ 0 ], gridval[ 4 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 512)
-						vertexNormalInterp( vertlist[ 9 ], gridvtx[ 1 ], gridvtx[ 5 ],
-										    normlist[ 9 ], gridnormal[ 1 ], gridnormal[ 5 ],
-										    gridval[ 1 ], gridval[ 5 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 1024)
-						vertexNormalInterp( vertlist[ 10 ], gridvtx[ 2 ], gridvtx[ 6 ],
-										    normlist[ 10 ], gridnormal[ 2 ], gridnormal[ 6 ],
-										    gridval[ 2 ], gridval[ 6 ], isolevel );
-					if ( _edgeTable[ cubeindex ] & 2048)
-						vertexNormalInterp( vertlist[ 11 ], gridvtx[ 3 ], gridvtx[ 7 ],
-										    normlist[ 11 ], gridnormal[ 3 ], gridnormal[ 7 ],
-										    gridval[ 3 ], gridval[ 7 ], isolevel );
-
-					/* Create the triangle */
-					for( int i = 0; _triTable[ cubeindex ][ i ] !=-1; i += 3 ) {
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i     ] ] );
-						normals.push_back( normlist[ _triTable[ cubeindex ][ i     ] ] );
-						faces.push_back( vtxIdx++ );
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i + 1 ] ] );
-						normals.push_back( normlist[ _triTable[ cubeindex ][ i + 1 ] ] );
-						faces.push_back( vtxIdx++ );
-						vertices.push_back( vertlist[ _triTable[ cubeindex ][ i + 2 ] ] );
-						normals.push_back( normlist[ _triTable[ cubeindex ][ i + 2 ] ] );
-						faces.push_back( vtxIdx++ );
-					}
-				}
+		const size_t B = BLOCK_SIZE;
+		MarchingCubesGrid grid;
+
+		/* the normals need one voxel border for the central differences */
+		size_t border = normals ? 1 : 0;
+		size_t dims[ 3 ] = { _width, _height, _depth };
+
+		mesh.clear();
+		grid.c0 = border;
+		for( int i = 0; i < 3; i++ ) {
+			if( dims[ i ] < 2 + 2 * border )
+				return;
+			grid.cend[ i ] = dims[ i ] - 1 - border;
+			grid.nblocks[ i ] = ( grid.cend[ i ] - grid.c0 + B - 1 ) / B;
+		}
+		if( grid.nblocks[ 0 ] == 0 || grid.nblocks[ 1 ] == 0 || grid.nblocks[ 2 ] == 0 )
+			return;
+
+		std::vector<uint8_t> active( grid.nblocks[ 0 ] * grid.nblocks[ 1 ] * grid.nblocks[ 2 ] );
+		BlockRows blockrows( *this, grid, isolevel, active );
+		/* a row is a layer of B cells, every layer may be a band of its own */
+		ParallelRows::run( blockrows, _width * _height * B, grid.nblocks[ 2 ], 0, 1 );
+
+		std::vector<Slab> slabs( grid.nblocks[ 2 ] );
+		SlabRows slabrows( *this, grid, isolevel, normals, active, slabs );
+		ParallelRows::run( slabrows, _width * _height * B, slabs.size(), 0, 1 );
+
+		/* stitch: bottom plane vertices of a slab may already exist in the top plane of the previous slab */
+		const unsigned int NEW_VERTEX = 0xffffffff;
+		std::vector<std::pair<unsigned int, unsigned int> > planeVertex( _width * _height * 2, std::make_pair( 0u, 0u ) );
+		size_t nvertices = 0, nfaces = 0;
+		for( size_t s = 0; s < slabs.size(); s++ ) {
+			Slab& slab = slabs[ s ];
+
+			slab.global.assign( slab.vertices.size(), NEW_VERTEX );
+			for( size_t i = 0; i < slab.bottom.size(); i++ ) {
+				const std::pair<unsigned int, unsigned int>& pv = planeVertex[ slab.bottom[ i ].first ];
+				if( pv.first == s + 1 )
+					slab.global[ slab.bottom[ i ].second ] = pv.second;
 			}
+
+			slab.vertexOffset = nvertices;
+			for( size_t i = 0; i < slab.global.size(); i++ ) {
+				if( slab.global[ i ] == NEW_VERTEX )
+					slab.global[ i ] = nvertices++;
+			}
+
+			/* stamp s + 2 marks the entries of this slab for slab s + 1 */
+			for( size_t i = 0; i < slab.top.size(); i++ )
+				planeVertex[ slab.top[ i ].first ] = std::make_pair( ( unsigned int ) s + 2, slab.global[ slab.top[ i ].second ] );
+
+			slab.faceOffset = nfaces;
+			nfaces += slab.faces.size();
 		}
-		mesh.clear();
+
+		if( !nfaces )
+			return;
+
+		std::vector<Vector3f> vertices( nvertices );
+		std::vector<Vector3f> vnormals( normals ? nvertices : 0 );
+		std::vector<unsigned int> faces( nfaces );
+		for( size_t s = 0; s < slabs.size(); s++ ) {
+			const Slab& slab = slabs[ s ];
+			for( size_t i = 0; i < slab.vertices.size(); i++ ) {
+				size_t g = slab.global[ i ];
+				if( g < slab.vertexOffset )
+					continue;
+				vertices[ g ] = slab.vertices[ i ];
+				if( normals )
+					vnormals[ g ] = slab.normals[ i ];
+			}
+			for( size_t i = 0; i < slab.faces.size(); i++ )
+				faces[ slab.faceOffset + i ] = slab.global[ slab.faces[ i ] ];
+		}
+
 		mesh.setVertices( &vertices[ 0 ], vertices.size() );
-		mesh.setNormals( &normals[ 0 ], normals.size() );
+		if( normals )
+			mesh.setNormals( &vnormals[ 0 ], vnormals.size() );
 		mesh.setFaces( &faces[ 0 ], faces.size(), SCENEMESH_TRIANGLES );
 	}
 }
-
-
-
@@ -30,6 +30,16 @@
 
 namespace cvt {
 
+	/**
+	 *	\class MarchingCubes
+	 *	\brief Extract the isosurface of a ( weighted ) distance volume as indexed triangle mesh.
+	 *
+	 *	Blocks of BLOCK_SIZE^3 cells whose value range does not contain the isolevel are skipped.
+	 *	The z-slabs of one block layer are triangulated in parallel, vertices on shared cell edges are
+	 *	created once using per-slab edge caches and the slabs are stitched along their common planes.
+	 *	Weighted volumes store interleaved ( distance, weight ) pairs, cells with a corner weight
+	 *	<= minimumWeight() are skipped.
+	 */
 	class MarchingCubes {
 		public:
 				  MarchingCubes( const float* volume, size_t width, size_t height, size_t depth, bool weighted = false, float minweight = 20.0f );
@@ -42,11 +52,13 @@ namespace cvt {
 			float minimumWeight() const;
 
 		private:
-			void triangulateDistance( SceneMesh& mesh, float isolevel ) const;
-			void triangulateWithNormalsDistance( SceneMesh& mesh, float isolevel ) const;
+			class BlockRows;
+			class SlabRows;
+			struct Slab;
 
-			void triangulateWeightedDistance( SceneMesh& mesh, float isolevel ) const;
-			void triangulateWithNormalsWeightedDistance( SceneMesh& mesh, float isolevel ) const;
+			static const size_t BLOCK_SIZE = 8;
+
+			void extract( SceneMesh& mesh, float isolevel, bool normals ) const;
 
 			void vertexInterp( Vector3f& vtx, const Vector3f& p1, const Vector3f& p2, float val1, float val2, float isolevel ) const;
 			void vertexNormalInterp( Vector3f& vtx, const Vector3f& p1, const Vector3f& p2, Vector3f& norm, const Vector3f& n1, const Vector3f& n2, float val1, float val2, float isolevel ) const;
@@ -75,18 +87,12 @@ namespace cvt {
 
 	inline void MarchingCubes::triangulate( SceneMesh& mesh, float isolevel ) const
 	{
-		if( _weighted )
-			triangulateWeightedDistance( mesh, isolevel );
-		else
-			triangulateDistance( mesh, isolevel );
+		extract( mesh, isolevel, false );
 	}
 
 	inline void MarchingCubes::triangulateWithNormals( SceneMesh& mesh, float isolevel ) const
 	{
-		if( _weighted )
-			triangulateWithNormalsWeightedDistance( mesh, isolevel );
-		else
-			triangulateWithNormalsWeightedDistance( mesh, isolevel );
+		extract( mesh, isolevel, true );
 	}
 
 
@@ -0,0 +1,187 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/geom/MarchingCubes.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/Time.h>
+
+#include <map>
+
+using namespace cvt;
+
+/* signed distance to a sphere, optionally interleaved with weights that are zero for x > wx */
+static void _sphereVolume( std::vector<float>& volume, size_t n, const Vector3f& center, float radius, bool weighted = false, float wx = 0.0f )
+{
+	volume.resize( n * n * n * ( weighted ? 2 : 1 ) );
+	size_t idx = 0;
+	for( size_t z = 0; z < n; z++ ) {
+		for( size_t y = 0; y < n; y++ ) {
+			for( size_t x = 0; x < n; x++ ) {
+				float d = ( Vector3f( x, y, z ) - center ).length() - radius;
+				if( weighted ) {
+					volume[ idx++ ] = d;
+					volume[ idx++ ] = ( float ) x <= wx ? 1.0f : 0.0f;
+				} else {
+					volume[ idx++ ] = d;
+				}
+			}
+		}
+	}
+}
+
+/* every directed edge at most once, with closed every edge has its twin, all vertices used */
+static bool _checkMesh( const SceneMesh& mesh, bool closed, int* euler = NULL )
+{
+	std::map<std::pair<unsigned int, unsigned int>, int> edges;
+	std::vector<bool> used( mesh.vertexSize(), false );
+	const unsigned int* f = mesh.faces();
+
+	for( size_t i = 0; i < mesh.faceSize(); i++ ) {
+		for( int k = 0; k < 3; k++ ) {
+			unsigned int a = f[ 3 * i + k ], b = f[ 3 * i + ( k + 1 ) % 3 ];
+			if( a == b || a >= mesh.vertexSize() )
+				return false;
+			if( edges[ std::make_pair( a, b ) ]++ )
+				return false;
+			used[ a ] = true;
+		}
+	}
+
+	size_t nedges = 0;
+	for( std::map<std::pair<unsigned int, unsigned int>, int>::const_iterator it = edges.begin(); it != edges.end(); ++it ) {
+		bool twin = edges.count( std::make_pair( it->first.second, it->first.first ) ) > 0;
+		if( closed && !twin )
+			return false;
+		if( !twin || it->first.first < it->first.second )
+			nedges++;
+	}
+	for( size_t i = 0; i < used.size(); i++ )
+		if( !used[ i ] )
+			return false;
+
+	if( euler )
+		*euler = ( int ) mesh.vertexSize() - ( int ) nedges + ( int ) mesh.faceSize();
+	return true;
+}
+
+BEGIN_CVTTEST( MarchingCubes )
+	bool result = true;
+	bool b;
+	const size_t n = 48;
+	const Vector3f center( 23.3f, 24.1f, 22.7f );
+	const float radius = 15.5f;
+	std::vector<float> volume;
+
+	_sphereVolume( volume, n, center, radius );
+
+	/* closed genus 0 surface with shared vertices */
+	{
+		SceneMesh mesh( "sphere" );
+		MarchingCubes mc( &volume[ 0 ], n, n, n );
+		mc.triangulate( mesh );
+
+		int euler = 0;
+		float maxerr = 0.0f;
+		for( size_t i = 0; i < mesh.vertexSize(); i++ )
+			maxerr = Math::max( maxerr, Math::abs( ( mesh.vertex( i ) - center ).length() - radius ) );
+		b = mesh.faceSize() > 1000 && _checkMesh( mesh, true, &euler ) && euler == 2 && maxerr < 0.1f && mesh.normalSize() == 0;
+
+		size_t nvertices = mesh.vertexSize();
+		mesh.removeRedundancy();
+		b &= mesh.vertexSize() == nvertices;
+		CVTTEST_PRINT( "triangulate", b );
+		result &= b;
+	}
+
+	/* normals point towards decreasing distance like the face winding, result does not depend on the number of threads */
+	{
+		SceneMesh threaded( "threaded" ), serial( "serial" );
+		MarchingCubes mc( &volume[ 0 ], n, n, n );
+		{
+			/* more bands than threads on small machines, a band may be a single slab */
+			ParallelRows::ScopedNumThreads bands( 5 );
+			mc.triangulateWithNormals( threaded );
+		}
+		{
+			ParallelRows::ScopedNumThreads single( 1 );
+			mc.triangulateWithNormals( serial );
+		}
+
+		b = threaded.normalSize() == threaded.vertexSize() && _checkMesh( threaded, true );
+		for( size_t i = 0; i < threaded.vertexSize(); i++ ) {
+			Vector3f dir = threaded.vertex( i ) - center;
+			dir.normalize();
+			b &= threaded.normal( i ) * dir < -0.99f;
+		}
+		const unsigned int* f = threaded.faces();
+		for( size_t i = 0; i < threaded.faceSize(); i++ ) {
+			Vector3f normal;
+			normal.cross( threaded.vertex( f[ 3 * i + 1 ] ) - threaded.vertex( f[ 3 * i ] ), threaded.vertex( f[ 3 * i + 2 ] ) - threaded.vertex( f[ 3 * i ] ) );
+			b &= normal * threaded.normal( f[ 3 * i ] ) > 0.0f;
+		}
+		b &= threaded.vertexSize() == serial.vertexSize() && threaded.faceSize() == serial.faceSize();
+		for( size_t i = 0; b && i < threaded.vertexSize(); i++ )
+			b &= threaded.vertex( i ) == serial.vertex( i ) && threaded.normal( i ) == serial.normal( i );
+		for( size_t i = 0; b && i < threaded.faceSize() * 3; i++ )
+			b &= threaded.faces()[ i ] == serial.faces()[ i ];
+		CVTTEST_PRINT( "triangulateWithNormals threaded == serial", b );
+		result &= b;
+	}
+
+	/* cells with low weight corners are skipped */
+	{
+		std::vector<float> wvolume;
+		_sphereVolume( wvolume, n, center, radius, true, 24.0f );
+
+		SceneMesh mesh( "weighted" );
+		MarchingCubes mc( &wvolume[ 0 ], n, n, n, true, 0.5f );
+		mc.triangulateWithNormals( mesh );
+
+		b = mesh.faceSize() > 500 && _checkMesh( mesh, false );
+		for( size_t i = 0; i < mesh.vertexSize(); i++ )
+			b &= mesh.vertex( i ).x <= 24.0f;
+		CVTTEST_PRINT( "weighted", b );
+		result &= b;
+	}
+
+	/* most blocks of a large volume do not contain the surface */
+	{
+		const size_t nl = 160;
+		std::vector<float> large;
+		_sphereVolume( large, nl, Vector3f( 80.5f, 79.2f, 81.1f ), 60.0f );
+
+		SceneMesh mesh( "large" );
+		MarchingCubes mc( &large[ 0 ], nl, nl, nl );
+		Time t;
+		mc.triangulateWithNormals( mesh );
+		std::cout << "MarchingCubes: " << nl << "^3 volume, " << mesh.faceSize() << " faces, " << mesh.vertexSize() << " vertices in "
+				  << t.elapsedMilliSeconds() << "ms" << std::endl;
+		b = _checkMesh( mesh, true );
+		CVTTEST_PRINT( "large volume", b );
+		result &= b;
+	}
+
+	return result;
+END_CVTTEST
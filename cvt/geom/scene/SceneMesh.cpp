@@ -23,52 +23,620 @@
 */
 
 #include <cvt/geom/scene/SceneMesh.h>
+#include <cvt/util/ParallelRows.h>
+
 #include <set>
+#include <queue>
+#include <algorithm>
 
 namespace cvt {
 
 
+	/* bucket of the hashed grid cell ( x, y, z ), nbuckets has to be a power of two */
+	static inline uint32_t _weldBucket( int64_t x, int64_t y, int64_t z, uint32_t nbuckets )
+	{
+		uint64_t h = ( uint64_t ) x * 0x9E3779B97F4A7C15ULL;
+		h ^= ( uint64_t ) y * 0xC2B2AE3D27D4EB4FULL;
+		h ^= ( uint64_t ) z * 0x165667B19E3779F9ULL;
+		h ^= h >> 31;
+		h *= 0xBF58476D1CE4E5B9ULL;
+		h ^= h >> 29;
+		return ( uint32_t ) h & ( nbuckets - 1 );
+	}
+
+	/* grid cell of a vertex, with epsilon 0 the cell is the exact position */
+	static inline void _weldCell( int64_t* cell, const Vector3f& v, float invcell )
+	{
+		if( invcell == 0.0f ) {
+			/* + 0.0f maps -0.0f to 0.0f, both compare equal */
+			float c[ 3 ] = { v.x + 0.0f, v.y + 0.0f, v.z + 0.0f };
+			uint32_t bits[ 3 ];
+			memcpy( bits, c, sizeof( bits ) );
+			cell[ 0 ] = bits[ 0 ];
+			cell[ 1 ] = bits[ 1 ];
+			cell[ 2 ] = bits[ 2 ];
+		} else {
+			cell[ 0 ] = ( int64_t ) Math::floor( v.x * invcell );
+			cell[ 1 ] = ( int64_t ) Math::floor( v.y * invcell );
+			cell[ 2 ] = ( int64_t ) Math::floor( v.z * invcell );
+		}
+	}
+
+	class SceneMeshWeld {
+		public:
+			SceneMeshWeld( const std::vector<Vector3f>& vertices, const std::vector<Vector3f>& normals, const std::vector<Vector2f>& texcoords,
+						   float vepsilon, float nepsilon, float tepsilon ) :
+				_vertices( vertices ), _normals( normals ), _texcoords( texcoords ),
+				_vepsilon( vepsilon ), _nepsilon( nepsilon ), _tepsilon( tepsilon ),
+				_invcell( vepsilon > 0.0f ? 1.0f / vepsilon : 0.0f ),
+				_nbuckets( 1 )
+			{
+				while( _nbuckets < vertices.size() && _nbuckets < 0x80000000 )
+					_nbuckets <<= 1;
+			}
+
+			/* same test as the original linear search */
+			bool equal( size_t i, size_t j ) const
+			{
+				if( !_vertices[ i ].isEqual( _vertices[ j ], _vepsilon ) )
+					return false;
+				if( _normals.size() && !_normals[ i ].isEqual( _normals[ j ], _nepsilon ) )
+					return false;
+				if( _texcoords.size() && !_texcoords[ i ].isEqual( _texcoords[ j ], _tepsilon ) )
+					return false;
+				return true;
+			}
+
+			uint32_t bucket( const Vector3f& v ) const
+			{
+				int64_t cell[ 3 ];
+				_weldCell( cell, v, _invcell );
+				return _weldBucket( cell[ 0 ], cell[ 1 ], cell[ 2 ], _nbuckets );
+			}
+
+			/*
+			   rep[ i ] is the first unique vertex equal to vertex i, or i if there is none.
+			   Unique vertices are created in index order, the buckets store ascending indices,
+			   so the result is the same as comparing against all unique vertices found so far.
+			 */
+			void weld( std::vector<unsigned int>& rep );
+
+		private:
+			class BucketRows;
+			class ExactRows;
+
+			const std::vector<Vector3f>&	_vertices;
+			const std::vector<Vector3f>&	_normals;
+			const std::vector<Vector2f>&	_texcoords;
+			float							_vepsilon;
+			float							_nepsilon;
+			float							_tepsilon;
+			float							_invcell;
+			uint32_t						_nbuckets;
+			std::vector<uint32_t>			_bucket;
+			std::vector<unsigned int>		_start;
+			std::vector<unsigned int>		_entries;
+	};
+
+	class SceneMeshWeld::BucketRows : public ParallelRows::Body {
+		public:
+			BucketRows( SceneMeshWeld& weld ) : _weld( weld ) {}
+
+			void process( size_t start, size_t end ) const
+			{
+				for( size_t i = start; i < end; i++ )
+					_weld._bucket[ i ] = _weld.bucket( _weld._vertices[ i ] );
+			}
+
+		private:
+			SceneMeshWeld& _weld;
+	};
+
+	/* with vepsilon 0 equal vertices share a bucket, the buckets are independent */
+	class SceneMeshWeld::ExactRows : public ParallelRows::Body {
+		public:
+			ExactRows( const SceneMeshWeld& weld, std::vector<unsigned int>& rep ) : _weld( weld ), _rep( rep ) {}
+
+			void process( size_t start, size_t end ) const
+			{
+				for( size_t b = start; b < end; b++ ) {
+					const unsigned int* entries = &_weld._entries[ 0 ] + _weld._start[ b ];
+					size_t n = _weld._start[ b + 1 ] - _weld._start[ b ];
+					for( size_t e = 0; e < n; e++ ) {
+						unsigned int i = entries[ e ];
+						_rep[ i ] = i;
+						for( size_t k = 0; k < e; k++ ) {
+							unsigned int j = entries[ k ];
+							if( _rep[ j ] == j && _weld.equal( i, j ) ) {
+								_rep[ i ] = j;
+								break;
+							}
+						}
+					}
+				}
+			}
+
+		private:
+			const SceneMeshWeld&		_weld;
+			std::vector<unsigned int>&	_rep;
+	};
+
+	void SceneMeshWeld::weld( std::vector<unsigned int>& rep )
+	{
+		size_t n = _vertices.size();
+
+		_bucket.resize( n );
+		BucketRows bucketrows( *this );
+		ParallelRows::run( bucketrows, 1, n );
+
+		/* counting sort by bucket, ascending vertex indices inside each bucket */
+		_start.assign( _nbuckets + 1, 0 );
+		for( size_t i = 0; i < n; i++ )
+			_start[ _bucket[ i ] + 1 ]++;
+		for( size_t b = 0; b < _nbuckets; b++ )
+			_start[ b + 1 ] += _start[ b ];
+		std::vector<unsigned int> fill( _start.begin(), _start.end() - 1 );
+		_entries.resize( n );
+		for( size_t i = 0; i < n; i++ )
+			_entries[ fill[ _bucket[ i ] ]++ ] = i;
+
+		rep.resize( n );
+		if( _vepsilon <= 0.0f ) {
+			ExactRows rows( *this, rep );
+			ParallelRows::run( rows, 16, _nbuckets );
+			return;
+		}
+
+		/* vertices within vepsilon are in the 27 neighbouring cells, whether an earlier vertex
+		   is unique depends on all vertices before it - process them in index order */
+		for( size_t i = 0; i < n; i++ ) {
+			unsigned int best = i;
+			int64_t cell[ 3 ];
+			_weldCell( cell, _vertices[ i ], _invcell );
+			for( int dz = -1; dz <= 1; dz++ ) {
+				for( int dy = -1; dy <= 1; dy++ ) {
+					for( int dx = -1; dx <= 1; dx++ ) {
+						uint32_t b = _weldBucket( cell[ 0 ] + dx, cell[ 1 ] + dy, cell[ 2 ] + dz, _nbuckets );
+						for( unsigned int e = _start[ b ]; e < _start[ b + 1 ]; e++ ) {
+							unsigned int j = _entries[ e ];
+							if( j >= best )
+								break;
+							if( rep[ j ] == j && equal( i, j ) ) {
+								best = j;
+								break;
+							}
+						}
+					}
+				}
+			}
+			rep[ i ] = best;
+		}
+	}
+
 	void SceneMesh::removeRedundancy( float vepsilon, float nepsilon, float tepsilon )
 	{
+		std::vector<unsigned int> rep;
+		SceneMeshWeld weld( _vertices, _normals, _texcoords, vepsilon, nepsilon, tepsilon );
+		weld.weld( rep );
+
 		std::vector<Vector3f>		nvertices;
 		std::vector<Vector3f>		nnormals;
 		std::vector<Vector2f>		ntexcoords;
-		std::vector<unsigned int>	nvindices;
+		std::vector<unsigned int>	newidx( _vertices.size() );
 
 		for( size_t idx = 0; idx < _vertices.size(); idx++ ) {
-			Vector3f v( _vertices[ idx ] );
-			bool added = false;
-
-			for( size_t i = 0; i < nvertices.size() && !added; i++ ) {
-				if( v.isEqual( nvertices[ i ], vepsilon ) ) {
-					if( normalSize() ) {
-						Vector3f n( _normals[ idx ] );
-						if( !n.isEqual( nnormals[ i ], nepsilon ) )
-							continue;
-					}
-					if( texcoordSize() ) {
-						Vector2f t = _texcoords[ idx ];
-						if( !t.isEqual( ntexcoords[ i ], tepsilon ) )
-							continue;
-					}
-					added = true;
-					nvindices.push_back( i );
+			if( rep[ idx ] != idx ) {
+				newidx[ idx ] = newidx[ rep[ idx ] ];
+				continue;
+			}
+			newidx[ idx ] = nvertices.size();
+			nvertices.push_back( _vertices[ idx ] );
+			if( normalSize() )
+				nnormals.push_back( _normals[ idx ] );
+			if( texcoordSize() )
+				ntexcoords.push_back( _texcoords[ idx ] );
+		}
+
+		for( size_t i = 0; i < _vindices.size(); i++ )
+			_vindices[ i ] = newidx[ _vindices[ i ] ];
+
+		_vertices.swap( nvertices );
+		_normals.swap( nnormals );
+		_texcoords.swap( ntexcoords );
+	}
+
+	/* error quadric v^T A v + 2 b^T v + c of a set of planes */
+	struct SceneMeshQuadric {
+		double a[ 6 ]; /* xx, xy, xz, yy, yz, zz */
+		double b[ 3 ];
+		double c;
+
+		SceneMeshQuadric()
+		{
+			for( int i = 0; i < 6; i++ )
+				a[ i ] = 0.0;
+			b[ 0 ] = b[ 1 ] = b[ 2 ] = c = 0.0;
+		}
+
+		/* plane n * p + d = 0 with unit normal n */
+		void addPlane( double nx, double ny, double nz, double d, double weight )
+		{
+			a[ 0 ] += weight * nx * nx;
+			a[ 1 ] += weight * nx * ny;
+			a[ 2 ] += weight * nx * nz;
+			a[ 3 ] += weight * ny * ny;
+			a[ 4 ] += weight * ny * nz;
+			a[ 5 ] += weight * nz * nz;
+			b[ 0 ] += weight * d * nx;
+			b[ 1 ] += weight * d * ny;
+			b[ 2 ] += weight * d * nz;
+			c += weight * d * d;
+		}
+
+		SceneMeshQuadric& operator+=( const SceneMeshQuadric& q )
+		{
+			for( int i = 0; i < 6; i++ )
+				a[ i ] += q.a[ i ];
+			for( int i = 0; i < 3; i++ )
+				b[ i ] += q.b[ i ];
+			c += q.c;
+			return *this;
+		}
+
+		double error( const Vector3f& v ) const
+		{
+			double x = v.x, y = v.y, z = v.z;
+			return x * ( a[ 0 ] * x + 2.0 * ( a[ 1 ] * y + a[ 2 ] * z + b[ 0 ] ) )
+				 + y * ( a[ 3 ] * y + 2.0 * ( a[ 4 ] * z + b[ 1 ] ) )
+				 + z * ( a[ 5 ] * z + 2.0 * b[ 2 ] ) + c;
+		}
+
+		/* position with minimal error, false if A is ( close to ) singular */
+		bool minimum( Vector3f& v ) const
+		{
+			double c00 = a[ 3 ] * a[ 5 ] - a[ 4 ] * a[ 4 ];
+			double c01 = a[ 2 ] * a[ 4 ] - a[ 1 ] * a[ 5 ];
+			double c02 = a[ 1 ] * a[ 4 ] - a[ 2 ] * a[ 3 ];
+			double det = a[ 0 ] * c00 + a[ 1 ] * c01 + a[ 2 ] * c02;
+			double trace = a[ 0 ] + a[ 3 ] + a[ 5 ];
+
+			if( Math::abs( det ) <= 1e-6 * trace * trace * trace )
+				return false;
+
+			double c11 = a[ 0 ] * a[ 5 ] - a[ 2 ] * a[ 2 ];
+			double c12 = a[ 1 ] * a[ 2 ] - a[ 0 ] * a[ 4 ];
+			double c22 = a[ 0 ] * a[ 3 ] - a[ 1 ] * a[ 1 ];
+			double inv = -1.0 / det;
+			v.x = ( float ) ( inv * ( c00 * b[ 0 ] + c01 * b[ 1 ] + c02 * b[ 2 ] ) );
+			v.y = ( float ) ( inv * ( c01 * b[ 0 ] + c11 * b[ 1 ] + c12 * b[ 2 ] ) );
+			v.z = ( float ) ( inv * ( c02 * b[ 0 ] + c12 * b[ 1 ] + c22 * b[ 2 ] ) );
+			return true;
+		}
+	};
+
+	/*
+	   Quadric error edge collapse ( Garland and Heckbert ) with a lazily updated heap.
+	   Heap entries store the version of both vertices, a collapse invalidates all entries
+	   of the surviving vertex and pushes its new edges.
+	 */
+	class SceneMeshDecimator {
+		public:
+			SceneMeshDecimator( std::vector<Vector3f>& vertices, std::vector<unsigned int>& faces );
+
+			/* collapse edges until at most maxfaces faces are left, removed faces are set to REMOVED */
+			void decimate( size_t maxfaces );
+
+			static const unsigned int REMOVED = 0xffffffff;
+
+		private:
+			struct Collapse {
+				float			cost;
+				unsigned int	v0, v1;
+				unsigned int	version0, version1;
+				Vector3f		pos;
+
+				bool operator<( const Collapse& other ) const
+				{
+					/* std::priority_queue returns the largest element */
+					if( cost != other.cost )
+						return cost > other.cost;
+					if( v0 != other.v0 )
+						return v0 > other.v0;
+					return v1 > other.v1;
+				}
+			};
+
+			static const float	BOUNDARY_WEIGHT;
+
+			void			addEdge( unsigned int v0, unsigned int v1 );
+			bool			collapsible( const Collapse& c );
+			void			collapse( const Collapse& c );
+			void			neighbours( std::vector<unsigned int>& n, unsigned int v ) const;
+			Vector3f		faceNormal( size_t f, unsigned int v, const Vector3f& pos ) const;
+
+			std::vector<Vector3f>&					_vertices;
+			std::vector<unsigned int>&				_faces;
+			std::vector<SceneMeshQuadric>			_quadrics;
+			std::vector<std::vector<unsigned int> >	_vfaces;
+			std::vector<unsigned int>				_version;
+			/* vertex a removed vertex was collapsed into, the vertex itself if alive */
+			std::vector<unsigned int>				_collapsed;
+			std::vector<bool>						_boundary;
+			std::priority_queue<Collapse>			_heap;
+			size_t									_numfaces;
+	};
+
+	const float SceneMeshDecimator::BOUNDARY_WEIGHT = 1000.0f;
+
+	SceneMeshDecimator::SceneMeshDecimator( std::vector<Vector3f>& vertices, std::vector<unsigned int>& faces ) :
+		_vertices( vertices ),
+		_faces( faces ),
+		_quadrics( vertices.size() ),
+		_vfaces( vertices.size() ),
+		_version( vertices.size(), 0 ),
+		_collapsed( vertices.size() ),
+		_boundary( vertices.size(), false ),
+		_numfaces( faces.size() / 3 )
+	{
+		for( size_t i = 0; i < _collapsed.size(); i++ )
+			_collapsed[ i ] = i;
+
+		/* face quadrics weighted by area */
+		for( size_t f = 0; f < _numfaces; f++ ) {
+			const unsigned int* idx = &_faces[ 3 * f ];
+			Vector3f normal;
+			normal.cross( _vertices[ idx[ 1 ] ] - _vertices[ idx[ 0 ] ], _vertices[ idx[ 2 ] ] - _vertices[ idx[ 0 ] ] );
+			float len = normal.length();
+			if( len > 0.0f ) {
+				normal /= len;
+				double d = -( normal * _vertices[ idx[ 0 ] ] );
+				for( int k = 0; k < 3; k++ )
+					_quadrics[ idx[ k ] ].addPlane( normal.x, normal.y, normal.z, d, 0.5 * len );
+			}
+			for( int k = 0; k < 3; k++ )
+				_vfaces[ idx[ k ] ].push_back( f );
+		}
+
+		/* edges as ( min, max, face ), edges used by a single face are on the boundary */
+		std::vector<std::pair<uint64_t, unsigned int> > edges;
+		edges.reserve( _faces.size() );
+		for( size_t f = 0; f < _numfaces; f++ ) {
+			for( int k = 0; k < 3; k++ ) {
+				uint64_t a = _faces[ 3 * f + k ];
+				uint64_t b = _faces[ 3 * f + ( k + 1 ) % 3 ];
+				edges.push_back( std::make_pair( a < b ? ( a << 32 ) | b : ( b << 32 ) | a, ( unsigned int ) f ) );
+			}
+		}
+		std::sort( edges.begin(), edges.end() );
+
+		for( size_t e = 0; e < edges.size(); ) {
+			size_t end = e + 1;
+			while( end < edges.size() && edges[ end ].first == edges[ e ].first )
+				end++;
+
+			unsigned int v0 = edges[ e ].first >> 32;
+			unsigned int v1 = edges[ e ].first & 0xffffffff;
+			if( end - e == 1 ) {
+				/* plane through the edge, perpendicular to the face */
+				const unsigned int* idx = &_faces[ 3 * edges[ e ].second ];
+				Vector3f normal, edge, perp;
+				normal.cross( _vertices[ idx[ 1 ] ] - _vertices[ idx[ 0 ] ], _vertices[ idx[ 2 ] ] - _vertices[ idx[ 0 ] ] );
+				edge = _vertices[ v1 ] - _vertices[ v0 ];
+				perp.cross( edge, normal );
+				float len = perp.length();
+				if( len > 0.0f ) {
+					perp /= len;
+					double d = -( perp * _vertices[ v0 ] );
+					double weight = BOUNDARY_WEIGHT * ( edge * edge );
+					_quadrics[ v0 ].addPlane( perp.x, perp.y, perp.z, d, weight );
+					_quadrics[ v1 ].addPlane( perp.x, perp.y, perp.z, d, weight );
 				}
+				_boundary[ v0 ] = _boundary[ v1 ] = true;
 			}
-			if( !added ) {
-				nvertices.push_back( v );
-				if( normalSize() )
-					nnormals.push_back( _normals[ idx ] );
-				if( texcoordSize() )
-					ntexcoords.push_back( _texcoords[ idx ] );
-				nvindices.push_back( nvertices.size() - 1 );
+			e = end;
+		}
+
+		for( size_t e = 0; e < edges.size(); e++ ) {
+			if( e && edges[ e ].first == edges[ e - 1 ].first )
+				continue;
+			addEdge( edges[ e ].first >> 32, edges[ e ].first & 0xffffffff );
+		}
+	}
+
+	void SceneMeshDecimator::addEdge( unsigned int v0, unsigned int v1 )
+	{
+		if( v0 > v1 )
+			std::swap( v0, v1 );
+
+		SceneMeshQuadric q = _quadrics[ v0 ];
+		q += _quadrics[ v1 ];
+
+		Collapse c;
+		c.v0 = v0;
+		c.v1 = v1;
+		c.version0 = _version[ v0 ];
+		c.version1 = _version[ v1 ];
+
+		if( !q.minimum( c.pos ) ) {
+			/* best of the end points and the midpoint */
+			Vector3f mid = 0.5f * ( _vertices[ v0 ] + _vertices[ v1 ] );
+			c.pos = _vertices[ v0 ];
+			if( q.error( _vertices[ v1 ] ) < q.error( c.pos ) )
+				c.pos = _vertices[ v1 ];
+			if( q.error( mid ) < q.error( c.pos ) )
+				c.pos = mid;
+		}
+		c.cost = ( float ) Math::max( q.error( c.pos ), 0.0 );
+		_heap.push( c );
+	}
+
+	void SceneMeshDecimator::neighbours( std::vector<unsigned int>& n, unsigned int v ) const
+	{
+		n.clear();
+		const std::vector<unsigned int>& vf = _vfaces[ v ];
+		for( size_t i = 0; i < vf.size(); i++ ) {
+			for( int k = 0; k < 3; k++ ) {
+				unsigned int u = _faces[ 3 * vf[ i ] + k ];
+				if( u != v )
+					n.push_back( u );
 			}
 		}
+		std::sort( n.begin(), n.end() );
+		n.erase( std::unique( n.begin(), n.end() ), n.end() );
+	}
 
-		_vertices = nvertices;
-		_normals = nnormals;
-		_texcoords = ntexcoords;
-		_vindices = nvindices;
+	/* normal of face f with vertex v moved to pos */
+	Vector3f SceneMeshDecimator::faceNormal( size_t f, unsigned int v, const Vector3f& pos ) const
+	{
+		Vector3f p[ 3 ];
+		for( int k = 0; k < 3; k++ ) {
+			unsigned int u = _faces[ 3 * f + k ];
+			p[ k ] = u == v ? pos : _vertices[ u ];
+		}
+		Vector3f normal;
+		normal.cross( p[ 1 ] - p[ 0 ], p[ 2 ] - p[ 0 ] );
+		return normal;
+	}
+
+	bool SceneMeshDecimator::collapsible( const Collapse& c )
+	{
+		/* collapsing an interior edge between two boundary vertices pinches the surface */
+		std::vector<unsigned int> shared;
+		const std::vector<unsigned int>& vf0 = _vfaces[ c.v0 ];
+		const std::vector<unsigned int>& vf1 = _vfaces[ c.v1 ];
+		for( size_t i = 0; i < vf0.size(); i++ ) {
+			const unsigned int* idx = &_faces[ 3 * vf0[ i ] ];
+			if( idx[ 0 ] == c.v1 || idx[ 1 ] == c.v1 || idx[ 2 ] == c.v1 )
+				shared.push_back( idx[ 0 ] + idx[ 1 ] + idx[ 2 ] - c.v0 - c.v1 );
+		}
+		if( shared.empty() || shared.size() > 2 )
+			return false;
+		if( shared.size() == 2 && _boundary[ c.v0 ] && _boundary[ c.v1 ] )
+			return false;
+
+		/* link condition: the only common neighbours are the opposite vertices of the shared faces */
+		std::vector<unsigned int> n0, n1, common;
+		neighbours( n0, c.v0 );
+		neighbours( n1, c.v1 );
+		std::set_intersection( n0.begin(), n0.end(), n1.begin(), n1.end(), std::back_inserter( common ) );
+		if( common.size() != shared.size() )
+			return false;
+
+		/* reject collapses that flip or degenerate a remaining face */
+		for( int side = 0; side < 2; side++ ) {
+			unsigned int v = side ? c.v1 : c.v0;
+			const std::vector<unsigned int>& vf = side ? vf1 : vf0;
+			for( size_t i = 0; i < vf.size(); i++ ) {
+				const unsigned int* idx = &_faces[ 3 * vf[ i ] ];
+				unsigned int other = side ? c.v0 : c.v1;
+				if( idx[ 0 ] == other || idx[ 1 ] == other || idx[ 2 ] == other )
+					continue;
+				Vector3f before = faceNormal( vf[ i ], v, _vertices[ v ] );
+				Vector3f after = faceNormal( vf[ i ], v, c.pos );
+				float lenb = before.length();
+				float lena = after.length();
+				if( lena <= 1e-6f * lenb || ( before * after ) <= 0.2f * lenb * lena )
+					return false;
+			}
+		}
+		return true;
+	}
+
+	void SceneMeshDecimator::collapse( const Collapse& c )
+	{
+		unsigned int v0 = c.v0;
+		unsigned int v1 = c.v1;
+		std::vector<unsigned int>& vf0 = _vfaces[ v0 ];
+		std::vector<unsigned int>& vf1 = _vfaces[ v1 ];
+
+		/* remove the faces of the edge from the lists of their vertices */
+		for( size_t i = 0; i < vf1.size(); i++ ) {
+			unsigned int f = vf1[ i ];
+			unsigned int* idx = &_faces[ 3 * f ];
+			if( idx[ 0 ] == v0 || idx[ 1 ] == v0 || idx[ 2 ] == v0 ) {
+				for( int k = 0; k < 3; k++ ) {
+					std::vector<unsigned int>& vf = _vfaces[ idx[ k ] ];
+					if( idx[ k ] != v1 )
+						vf.erase( std::find( vf.begin(), vf.end(), f ) );
+					idx[ k ] = REMOVED;
+				}
+				_numfaces--;
+			} else {
+				for( int k = 0; k < 3; k++ ) {
+					if( idx[ k ] == v1 )
+						idx[ k ] = v0;
+				}
+				vf0.push_back( f );
+			}
+		}
+		vf1.clear();
+
+		_vertices[ v0 ] = c.pos;
+		_quadrics[ v0 ] += _quadrics[ v1 ];
+		_boundary[ v0 ] = _boundary[ v0 ] || _boundary[ v1 ];
+		_collapsed[ v1 ] = v0;
+		_version[ v0 ]++;
+		_version[ v1 ]++;
+
+		std::vector<unsigned int> n;
+		neighbours( n, v0 );
+		for( size_t i = 0; i < n.size(); i++ )
+			addEdge( v0, n[ i ] );
+	}
+
+	void SceneMeshDecimator::decimate( size_t maxfaces )
+	{
+		while( _numfaces > maxfaces && !_heap.empty() ) {
+			Collapse c = _heap.top();
+			_heap.pop();
+
+			if( c.version0 != _version[ c.v0 ] || c.version1 != _version[ c.v1 ] ||
+				_collapsed[ c.v0 ] != c.v0 || _collapsed[ c.v1 ] != c.v1 )
+				continue;
+			if( !collapsible( c ) )
+				continue;
+			collapse( c );
+		}
+	}
+
+	void SceneMesh::decimate( size_t maxfaces )
+	{
+		quadsToTriangles();
+		if( _meshtype != SCENEMESH_TRIANGLES || faceSize() <= maxfaces )
+			return;
+
+		SceneMeshDecimator decimator( _vertices, _vindices );
+		decimator.decimate( maxfaces );
+
+		/* drop removed faces and vertices, the texture coordinates of the survivors are kept */
+		std::vector<unsigned int> newidx( _vertices.size(), 0xffffffff );
+		std::vector<unsigned int> nvindices;
+		std::vector<Vector3f>	  nvertices;
+		std::vector<Vector2f>	  ntexcoords;
+
+		for( size_t i = 0; i < _vindices.size(); i += 3 ) {
+			if( _vindices[ i ] == SceneMeshDecimator::REMOVED )
+				continue;
+			for( int k = 0; k < 3; k++ ) {
+				unsigned int v = _vindices[ i + k ];
+				if( newidx[ v ] == 0xffffffff ) {
+					newidx[ v ] = nvertices.size();
+					nvertices.push_back( _vertices[ v ] );
+					if( texcoordSize() )
+						ntexcoords.push_back( _texcoords[ v ] );
+				}
+				nvindices.push_back( newidx[ v ] );
+			}
+		}
+
+		bool donormals = normalSize();
+		_vertices.swap( nvertices );
+		_texcoords.swap( ntexcoords );
+		_vindices.swap( nvindices );
+		_tangents.clear();
+		_normals.clear();
+		if( donormals )
+			calculateNormals();
 	}
 
 	void SceneMesh::quadsToTriangles()
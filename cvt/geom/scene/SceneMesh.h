@@ -81,8 +81,10 @@ namespace cvt {
 			void				calculateNormals( float angleweight = 0.0f, float areaweight = 0.0f );
 			void				calculateTangents();
 			void				calculateAdjacency();
+			/* merge equal vertices, linear time using a hashed grid with cells of size vepsilon */
 			void				removeRedundancy( float vepsilon = 0.0f, float nepsilon = 0.0f, float tepsilon = 0.0f );
-			void				simplify( float vepsilon );
+			/* quadric error edge collapse down to maxfaces triangles, expects a mesh with merged vertices */
+			void				decimate( size_t maxfaces );
 			void				addNoise( float amount );
 			void				flipNormals( );
 			void				quadsToTriangles();
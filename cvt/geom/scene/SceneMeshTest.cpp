@@ -0,0 +1,260 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/geom/scene/SceneMesh.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/Time.h>
+
+#include <map>
+
+using namespace cvt;
+
+/* n x n unit square split into triangles, every triangle has its own vertices */
+static void _gridSoup( SceneMesh& mesh, size_t n, float noise )
+{
+	std::vector<Vector3f> vertices;
+	std::vector<Vector3f> normals;
+	std::vector<unsigned int> faces;
+	const int corners[ 6 ][ 2 ] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 1, 1 }, { 0, 1 }, { 0, 0 } };
+
+	for( size_t y = 0; y < n; y++ ) {
+		for( size_t x = 0; x < n; x++ ) {
+			for( int k = 0; k < 6; k++ ) {
+				Vector3f v( ( float ) ( x + corners[ k ][ 0 ] ) / ( float ) n, ( float ) ( y + corners[ k ][ 1 ] ) / ( float ) n, 0.0f );
+				v.x += Math::rand( -noise, noise );
+				v.y += Math::rand( -noise, noise );
+				faces.push_back( vertices.size() );
+				vertices.push_back( v );
+				normals.push_back( Vector3f( 0.0f, 0.0f, 1.0f ) );
+			}
+		}
+	}
+	mesh.setVertices( &vertices[ 0 ], vertices.size() );
+	mesh.setNormals( &normals[ 0 ], normals.size() );
+	mesh.setFaces( &faces[ 0 ], faces.size(), SCENEMESH_TRIANGLES );
+}
+
+/* closed unit sphere with shared vertices */
+static void _sphere( SceneMesh& mesh, size_t rings, size_t segments )
+{
+	std::vector<Vector3f> vertices;
+	std::vector<unsigned int> faces;
+
+	vertices.push_back( Vector3f( 0.0f, 0.0f, 1.0f ) );
+	for( size_t r = 1; r < rings; r++ ) {
+		float theta = Math::PI * ( float ) r / ( float ) rings;
+		for( size_t s = 0; s < segments; s++ ) {
+			float phi = Math::TWO_PI * ( float ) s / ( float ) segments;
+			vertices.push_back( Vector3f( Math::sin( theta ) * Math::cos( phi ), Math::sin( theta ) * Math::sin( phi ), Math::cos( theta ) ) );
+		}
+	}
+	vertices.push_back( Vector3f( 0.0f, 0.0f, -1.0f ) );
+
+	unsigned int bottom = vertices.size() - 1;
+	for( size_t s = 0; s < segments; s++ ) {
+		unsigned int s1 = ( s + 1 ) % segments;
+		faces.push_back( 0 ); faces.push_back( 1 + s ); faces.push_back( 1 + s1 );
+		for( size_t r = 0; r + 2 < rings; r++ ) {
+			unsigned int a = 1 + r * segments + s, b = 1 + r * segments + s1;
+			unsigned int c = a + segments, d = b + segments;
+			faces.push_back( a ); faces.push_back( c ); faces.push_back( d );
+			faces.push_back( a ); faces.push_back( d ); faces.push_back( b );
+		}
+		unsigned int last = 1 + ( rings - 2 ) * segments;
+		faces.push_back( last + s ); faces.push_back( bottom ); faces.push_back( last + s1 );
+	}
+	mesh.setVertices( &vertices[ 0 ], vertices.size() );
+	mesh.setFaces( &faces[ 0 ], faces.size(), SCENEMESH_TRIANGLES );
+}
+
+/* the quadratic search removeRedundancy used before, with the faces remapped */
+static void _weldReference( std::vector<Vector3f>& nvertices, std::vector<unsigned int>& nfaces, const SceneMesh& mesh,
+						    float vepsilon, float nepsilon )
+{
+	std::vector<Vector3f> nnormals;
+	std::vector<unsigned int> newidx;
+
+	nvertices.clear();
+	for( size_t idx = 0; idx < mesh.vertexSize(); idx++ ) {
+		bool added = false;
+		for( size_t i = 0; i < nvertices.size() && !added; i++ ) {
+			if( mesh.vertex( idx ).isEqual( nvertices[ i ], vepsilon ) && mesh.normal( idx ).isEqual( nnormals[ i ], nepsilon ) ) {
+				added = true;
+				newidx.push_back( i );
+			}
+		}
+		if( !added ) {
+			nvertices.push_back( mesh.vertex( idx ) );
+			nnormals.push_back( mesh.normal( idx ) );
+			newidx.push_back( nvertices.size() - 1 );
+		}
+	}
+
+	nfaces.clear();
+	for( size_t i = 0; i < mesh.faceSize() * 3; i++ )
+		nfaces.push_back( newidx[ mesh.faces()[ i ] ] );
+}
+
+static bool _sameMesh( const SceneMesh& mesh, const std::vector<Vector3f>& vertices, const std::vector<unsigned int>& faces )
+{
+	if( mesh.vertexSize() != vertices.size() || mesh.faceSize() * 3 != faces.size() )
+		return false;
+	for( size_t i = 0; i < vertices.size(); i++ )
+		if( mesh.vertex( i ) != vertices[ i ] )
+			return false;
+	for( size_t i = 0; i < faces.size(); i++ )
+		if( mesh.faces()[ i ] != faces[ i ] )
+			return false;
+	return true;
+}
+
+/* every directed edge at most once, undirected edges in one or ( closed ) two faces, no degenerate faces */
+static bool _checkManifold( const SceneMesh& mesh, bool closed )
+{
+	std::map<std::pair<unsigned int, unsigned int>, int> edges;
+	const unsigned int* f = mesh.faces();
+	std::vector<bool> used( mesh.vertexSize(), false );
+
+	for( size_t i = 0; i < mesh.faceSize(); i++ ) {
+		for( int k = 0; k < 3; k++ ) {
+			unsigned int a = f[ 3 * i + k ], b = f[ 3 * i + ( k + 1 ) % 3 ];
+			if( a == b || a >= mesh.vertexSize() )
+				return false;
+			if( edges[ std::make_pair( a, b ) ]++ )
+				return false;
+			used[ a ] = true;
+		}
+	}
+	for( std::map<std::pair<unsigned int, unsigned int>, int>::const_iterator it = edges.begin(); it != edges.end(); ++it ) {
+		bool twin = edges.count( std::make_pair( it->first.second, it->first.first ) ) > 0;
+		if( closed && !twin )
+			return false;
+	}
+	for( size_t i = 0; i < used.size(); i++ )
+		if( !used[ i ] )
+			return false;
+	return true;
+}
+
+static float _area( const SceneMesh& mesh )
+{
+	float area = 0.0f;
+	const unsigned int* f = mesh.faces();
+	for( size_t i = 0; i < mesh.faceSize(); i++ ) {
+		Vector3f n;
+		n.cross( mesh.vertex( f[ 3 * i + 1 ] ) - mesh.vertex( f[ 3 * i ] ), mesh.vertex( f[ 3 * i + 2 ] ) - mesh.vertex( f[ 3 * i ] ) );
+		area += 0.5f * n.z;
+	}
+	return area;
+}
+
+BEGIN_CVTTEST( SceneMesh )
+	bool result = true;
+	bool b;
+
+	/* same result as the quadratic search, exact and with epsilon */
+	{
+		std::vector<Vector3f> vertices;
+		std::vector<unsigned int> faces;
+		SceneMesh mesh( "grid" );
+
+		_gridSoup( mesh, 12, 0.0f );
+		_weldReference( vertices, faces, mesh, 0.0f, 0.0f );
+		mesh.removeRedundancy( 0.0f, 0.0f );
+		b = _sameMesh( mesh, vertices, faces ) && mesh.vertexSize() == 13 * 13;
+
+		_gridSoup( mesh, 12, 1e-3f );
+		_weldReference( vertices, faces, mesh, 3e-3f, 0.0f );
+		mesh.removeRedundancy( 3e-3f, 0.0f );
+		b &= _sameMesh( mesh, vertices, faces );
+
+		/* vertices further apart than epsilon stay separate */
+		_gridSoup( mesh, 12, 1e-3f );
+		_weldReference( vertices, faces, mesh, 1e-3f, 0.0f );
+		mesh.removeRedundancy( 1e-3f, 0.0f );
+		b &= _sameMesh( mesh, vertices, faces );
+		CVTTEST_PRINT( "removeRedundancy == reference", b );
+		result &= b;
+	}
+
+	/* the exact weld runs on the buckets in parallel */
+	{
+		SceneMesh threaded( "threaded" ), serial( "serial" );
+		_gridSoup( threaded, 200, 0.0f );
+		_gridSoup( serial, 200, 0.0f );
+
+		Time t;
+		threaded.removeRedundancy();
+		std::cout << "SceneMesh: welded " << 200 * 200 * 6 << " vertices in " << t.elapsedMilliSeconds() << "ms" << std::endl;
+		{
+			ParallelRows::ScopedNumThreads single( 1 );
+			serial.removeRedundancy();
+		}
+		std::vector<Vector3f> vertices( serial.vertices(), serial.vertices() + serial.vertexSize() );
+		std::vector<unsigned int> faces( serial.faces(), serial.faces() + serial.faceSize() * 3 );
+		b = _sameMesh( threaded, vertices, faces ) && threaded.vertexSize() == 201 * 201 && _checkManifold( threaded, false );
+		CVTTEST_PRINT( "removeRedundancy threaded == serial", b );
+		result &= b;
+	}
+
+	/* decimated sphere stays closed and close to the surface */
+	{
+		SceneMesh mesh( "sphere" );
+		_sphere( mesh, 64, 128 );
+		size_t faces = mesh.faceSize();
+
+		Time t;
+		mesh.decimate( faces / 10 );
+		std::cout << "SceneMesh: decimated " << faces << " to " << mesh.faceSize() << " faces in " << t.elapsedMilliSeconds() << "ms" << std::endl;
+
+		float maxerr = 0.0f;
+		for( size_t i = 0; i < mesh.vertexSize(); i++ )
+			maxerr = Math::max( maxerr, Math::abs( mesh.vertex( i ).length() - 1.0f ) );
+		b = mesh.faceSize() <= faces / 10 && mesh.faceSize() + 2 >= faces / 10 && maxerr < 0.02f && _checkManifold( mesh, true );
+		CVTTEST_PRINT( "decimate sphere", b );
+		result &= b;
+	}
+
+	/* flat grid: the boundary is kept, no face flips */
+	{
+		SceneMesh mesh( "grid" );
+		_gridSoup( mesh, 20, 0.0f );
+		mesh.removeRedundancy();
+		mesh.decimate( 40 );
+
+		Boxf bbox = mesh.boundingBox();
+		Vector3f min, max;
+		bbox.getPosition( min );
+		bbox.getSize( max );
+		max += min;
+		b = mesh.faceSize() <= 40 && Math::abs( _area( mesh ) - 1.0f ) < 1e-4f && _checkManifold( mesh, false );
+		b &= min.isEqual( Vector3f( 0.0f, 0.0f, 0.0f ), 1e-5f ) && max.isEqual( Vector3f( 1.0f, 1.0f, 0.0f ), 1e-5f );
+		b &= mesh.normalSize() == mesh.vertexSize();
+		CVTTEST_PRINT( "decimate grid", b );
+		result &= b;
+	}
+
+	return result;
+END_CVTTEST
@@ -27,77 +27,106 @@
 #include <cvt/gfx/IMapScoped.h>
 #include <cvt/util/SIMD.h>
 #include <cvt/util/ScopedBuffer.h>
+#include <cvt/util/ParallelRows.h>
 
 namespace cvt
 {
 
-	/* general template use for separable convolution ( except the constant border case ) */
+	/* row band of the box filter - rows outside the image are clamped to the border */
+	template<typename TYPE, typename BUFTYPE>
+	class IBoxFilterRows : public ParallelRows::Body
+	{
+		public:
+			typedef void ( SIMD::*HBoxFunc )( BUFTYPE*, const TYPE*, size_t, size_t ) const;
+			typedef void ( SIMD::*VConvFunc )( TYPE*, BUFTYPE*, const BUFTYPE*, const BUFTYPE*, size_t, size_t ) const;
+			typedef void ( SIMD::*AddFunc )( BUFTYPE*, const BUFTYPE*, const BUFTYPE*, size_t ) const;
+
+			IBoxFilterRows( uint8_t* dst, size_t dstride, const uint8_t* src, size_t sstride, size_t w, size_t h, size_t channels,
+							size_t hradius, size_t vradius, HBoxFunc hbox, VConvFunc vconv, AddFunc add ) :
+				_simd( SIMD::instance() ), _dst( dst ), _dstride( dstride ), _src( src ), _sstride( sstride ),
+				_w( w ), _h( h ), _channels( channels ), _hradius( hradius ), _vradius( vradius ),
+				_hbox( hbox ), _vconv( vconv ), _add( add )
+			{
+			}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				size_t widthchannels = _w * _channels;
+				size_t bstride = Math::pad16( sizeof( BUFTYPE ) * widthchannels ) / sizeof( BUFTYPE ); //FIXME: does this always work - it should
+				BUFTYPE** buf;
+				/* buf[ k ] holds the row ( y - vradius - 1 + k ), the first one is subtracted and the last one added for row y */
+				size_t bh = 2 * _vradius + 2;
+
+				/* allocate buffers and fill buffer*/
+				ScopedBuffer<BUFTYPE,true> bufmem( bstride * bh );
+				ScopedBuffer<BUFTYPE*,true> bufptr( bh );
+				ScopedBuffer<BUFTYPE,true> accum( widthchannels );
+
+				buf = bufptr.ptr();
+				for( size_t i = 0; i < bh; i++ ) {
+					buf[ i ] = bufmem.ptr() + i * bstride;
+					( _simd->*_hbox )( buf[ i ], srcLine( ( ssize_t ) ystart - ( ssize_t ) _vradius - 1 + ( ssize_t ) i ), _hradius, _w );
+				}
+
+				/* the accumulator contains the sum of the box for row ystart - 1 */
+				_simd->Memcpy( ( uint8_t* ) accum.ptr(), ( const uint8_t* ) buf[ 0 ], sizeof( BUFTYPE ) * widthchannels );
+				for( size_t i = 1; i < bh - 1; i++ )
+					( _simd->*_add )( accum.ptr(), accum.ptr(), buf[ i ], widthchannels );
+
+				for( size_t y = ystart; y < yend; y++ ) {
+					if( y != ystart ) {
+						BUFTYPE* tmp = buf[ 0 ];
+						for( size_t k = 0; k < bh - 1; k++ )
+							buf[ k ] = buf[ k + 1 ];
+						buf[ bh - 1 ] = tmp;
+						( _simd->*_hbox )( tmp, srcLine( y + _vradius ), _hradius, _w );
+					}
+					( _simd->*_vconv )( dstLine( y ), accum.ptr(), buf[ bh - 1 ], buf[ 0 ], _vradius, widthchannels );
+				}
+			}
+
+		private:
+			const TYPE* srcLine( ssize_t y ) const
+			{
+				y = Math::clamp<ssize_t>( y, 0, _h - 1 );
+				return ( const TYPE* ) ( _src + _sstride * y );
+			}
+
+			TYPE* dstLine( size_t y ) const
+			{
+				return ( TYPE* ) ( _dst + _dstride * y );
+			}
+
+			SIMD*		   _simd;
+			uint8_t*	   _dst;
+			size_t		   _dstride;
+			const uint8_t* _src;
+			size_t		   _sstride;
+			size_t		   _w;
+			ssize_t		   _h;
+			size_t		   _channels;
+			size_t		   _hradius;
+			size_t		   _vradius;
+			HBoxFunc	   _hbox;
+			VConvFunc	   _vconv;
+			AddFunc		   _add;
+	};
+
 	template<typename TYPE, typename BUFTYPE>
 	static void boxfilterTemplate( Image& dst, const Image& src, size_t hradius, size_t vradius,
 								   void ( SIMD::*hbox )( BUFTYPE*, const TYPE*, size_t, size_t ) const,
 								   void ( SIMD::*vconv )( TYPE*, BUFTYPE*, const BUFTYPE*, const BUFTYPE*, size_t, size_t ) const,
-								   void ( SIMD::*mul )( BUFTYPE*, const BUFTYPE*, const BUFTYPE, size_t ) const,
 								   void ( SIMD::*add )( BUFTYPE*, const BUFTYPE*, const BUFTYPE*, size_t ) const
 								 )
 	{
-		SIMD* simd = SIMD::instance();
-		size_t w = src.width();
-		size_t h = src.height();
-		size_t widthchannels = w * src.channels();
-		size_t bstride = Math::pad16( sizeof( BUFTYPE ) * widthchannels ) / sizeof( BUFTYPE ); //FIXME: does this always work - it should
-		BUFTYPE** buf;
-		size_t bh = 2 * vradius + 1;
-		size_t subidx = 0, addidx = vradius - 1, y;
-
 		IMapScoped<TYPE> mapdst( dst );
 		IMapScoped<const TYPE> mapsrc( src );
 
-		/* allocate buffers and fill buffer*/
-		ScopedBuffer<BUFTYPE,true> bufmem( bstride * ( bh + 1 ) );
-		ScopedBuffer<BUFTYPE*,true> bufptr( bh + 1 );
-		ScopedBuffer<BUFTYPE,true> accum( widthchannels );
-
-
-		buf = bufptr.ptr();
-		buf[ 0 ] = bufmem.ptr();
-		for( size_t i = 1; i <= bh; i++ )
-			buf[ i ] = buf[ i - 1 ] + bstride;
-
-		/* boxfilter the vradius first lines and store into buf */
-		for( size_t i = 0; i < vradius; i++ ) {
-			( simd->*hbox )( buf[ i ], mapsrc.ptr(), hradius, w );
-			mapsrc++;
-		}
-
-		( simd->*mul )( accum.ptr(), buf[ 0 ], vradius + 2, widthchannels );
-		for( size_t i = 1; i < vradius; i++ )
-			( simd->*add )( accum.ptr(), accum.ptr(), buf[ i ], widthchannels );
-
-
-		for( y = 0; y <= vradius; y++ ) {
-			addidx = ( addidx + 1 ) % ( bh + 1 );
-			( simd->*hbox )( buf[ addidx ], mapsrc.ptr(), hradius, w );
-			( simd->*vconv )( mapdst.ptr(), accum.ptr(), buf[ addidx ], buf[ 0 ], vradius, widthchannels );
-			mapsrc++;
-			mapdst++;
-		}
-
-		for( ; y < h - vradius ; y++ ) {
-			addidx = ( addidx + 1 ) % ( bh + 1 );
-			( simd->*hbox )( buf[ addidx ], mapsrc.ptr(), hradius, w );
-			( simd->*vconv )( mapdst.ptr(), accum.ptr(), buf[ addidx ], buf[ subidx ], vradius, widthchannels );
-			subidx = ( subidx + 1 ) % ( bh + 1 );
-			mapsrc++;
-			mapdst++;
-		}
-
-		for( ; y < h; y++ ) {
-			( simd->*vconv )( mapdst.ptr(), accum.ptr(), buf[ addidx ], buf[ subidx ], vradius, widthchannels );
-			subidx = ( subidx + 1 ) % ( bh + 1 );
-			mapdst++;
-		}
-
-
+		IBoxFilterRows<TYPE, BUFTYPE> rows( ( uint8_t* ) mapdst.base(), mapdst.stride(), ( const uint8_t* ) mapsrc.base(), mapsrc.stride(),
+											src.width(), src.height(), src.channels(), hradius, vradius, hbox, vconv, add );
+		/* the bands read vradius + 1 rows beyond their range, filtering in place is only correct in row order */
+		size_t numThreads = ( const TYPE* ) mapdst.base() == mapsrc.base() ? 1 : 0;
+		ParallelRows::run( rows, src.width(), src.height(), numThreads );
 	}
 
 	void IBoxFilter::boxfilter( Image& dst, const Image& src, size_t radiushorizontal, size_t radiusvertical )
@@ -114,7 +143,6 @@ namespace cvt
 				return boxfilterTemplate<uint8_t,float>( dst, src, radiushorizontal, radiusvertical,
 														&SIMD::BoxFilterHorizontal_1u8_to_f,
 														&SIMD::BoxFilterVert_f_to_u8,
-														&SIMD::MulValue1f,
 														&SIMD::Add );
 			} else
 				throw CVTException("Unimplemented");
@@ -125,7 +153,6 @@ namespace cvt
 				return boxfilterTemplate<float,float>( dst, src, radiushorizontal, radiusvertical,
 														&SIMD::BoxFilterHorizontal_1f,
 														&SIMD::BoxFilterVert_f,
-														&SIMD::MulValue1f,
 														&SIMD::Add );
 			} else
 				throw CVTException("Unimplemented");
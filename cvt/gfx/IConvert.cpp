@@ -25,6 +25,7 @@
 #include <cvt/gfx/IConvert.h>
 #include <cvt/gfx/Image.h>
 #include <cvt/util/SIMD.h>
+#include <cvt/util/ParallelRows.h>
 
 namespace cvt {
 
@@ -35,16 +36,53 @@ namespace cvt {
     IConvert* IConvert::_instance = 0;
 
 
+    /* row band of a span conversion */
+    template<typename DSTTYPE, typename SRCTYPE>
+    class IConvertRows : public ParallelRows::Body
+    {
+        public:
+            typedef void ( SIMD::*ConvFunc )( DSTTYPE*, const SRCTYPE*, const size_t ) const;
+
+            IConvertRows( SIMD* simd, ConvFunc func, uint8_t* dst, size_t dstride, const uint8_t* src, size_t sstride, size_t width ) :
+                _simd( simd ), _func( func ), _dst( dst ), _dstride( dstride ), _src( src ), _sstride( sstride ), _width( width )
+            {
+            }
+
+            void process( size_t ystart, size_t yend ) const
+            {
+                const uint8_t* src = _src + ystart * _sstride;
+                uint8_t* dst = _dst + ystart * _dstride;
+                for( size_t y = ystart; y < yend; y++ ) {
+                    ( _simd->*_func )( ( DSTTYPE* ) dst, ( const SRCTYPE* ) src, _width );
+                    src += _sstride;
+                    dst += _dstride;
+                }
+            }
+
+        private:
+            SIMD*          _simd;
+            ConvFunc       _func;
+            uint8_t*       _dst;
+            size_t         _dstride;
+            const uint8_t* _src;
+            size_t         _sstride;
+            size_t         _width;
+    };
+
+    template<typename DSTTYPE, typename SRCTYPE>
+    static inline void convRows( SIMD* simd, void ( SIMD::*func )( DSTTYPE*, const SRCTYPE*, const size_t ) const,
+                                 uint8_t* dst, size_t dstride, const uint8_t* src, size_t sstride, size_t width, size_t height )
+    {
+        IConvertRows<DSTTYPE, SRCTYPE> rows( simd, func, dst, dstride, src, sstride, width );
+        ParallelRows::run( rows, width, height );
+    }
+
     #define CONV( func, dI, dsttype, sI, srctype, width )				\
     {																	\
         sbase = src = sI.map( &sstride );								\
         dbase = dst = dI.map( &dstride );								\
         h = sI.height();												\
-        while( h-- ) {													\
-            simd->func( ( dsttype ) dst, ( const srctype ) src, width );\
-            src += sstride;												\
-            dst += dstride;												\
-        }																\
+        convRows( simd, &SIMD::func, dst, dstride, src, sstride, width, h );\
         sI.unmap( sbase );												\
         dI.unmap( dbase );												\
         return;															\
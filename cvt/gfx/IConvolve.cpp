@@ -28,9 +28,84 @@
 #include <cvt/gfx/IBorder.h>
 #include <cvt/util/SIMD.h>
 #include <cvt/util/ScopedBuffer.h>
+#include <cvt/util/ParallelRows.h>
 
 namespace cvt {
 
+	/* row band of a separable convolution ( except the constant border case ) */
+	template<typename DSTTYPE, typename SRCTYPE, typename BUFTYPE, typename KERNTYPE>
+	class IConvolveSeparableRows : public ParallelRows::Body
+	{
+		public:
+			typedef void ( SIMD::*HConvFunc )( BUFTYPE*, const SRCTYPE*, size_t, const KERNTYPE* , size_t, IBorderType type ) const;
+			typedef void ( SIMD::*VConvFunc )( DSTTYPE*, const BUFTYPE**, const KERNTYPE* , size_t, size_t ) const;
+
+			IConvolveSeparableRows( uint8_t* dst, size_t dstride, const uint8_t* src, size_t sstride, ssize_t w, ssize_t h, size_t channels,
+									const KERNTYPE* hkern, size_t kw, const KERNTYPE* vkern, size_t kh,
+									HConvFunc hconv, VConvFunc vconv, IBorderType btype ) :
+				_simd( SIMD::instance() ), _dst( dst ), _dstride( dstride ), _src( src ), _sstride( sstride ),
+				_w( w ), _h( h ), _channels( channels ), _hkern( hkern ), _kw( kw ), _vkern( vkern ), _kh( kh ),
+				_hconv( hconv ), _vconv( vconv ), _btype( btype )
+			{
+			}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				size_t widthchannels = _w * _channels;
+				size_t bstride = Math::pad16( sizeof( BUFTYPE ) * widthchannels ) / sizeof( BUFTYPE ); //FIXME: does this always work - it should
+				BUFTYPE** buf;
+
+				ssize_t b1 = ( _kh >> 1 );
+				ssize_t b2 = _kh - b1 - 1;
+
+				/* allocate buffers and fill buffer*/
+				ScopedBuffer<BUFTYPE,true> bufmem( bstride * _kh );
+				ScopedBuffer<BUFTYPE*,true> bufptr( _kh );
+
+				buf = bufptr.ptr();
+				buf[ 0 ] = bufmem.ptr();
+				for( size_t i = 1; i < _kh; i++ )
+					buf[ i ] = buf[ i - 1 ] + bstride;
+
+				for( ssize_t k = -b1; k <= b2; k++ ) {
+					ssize_t y = IBorder::value<ssize_t>( ( ssize_t ) ystart + k, _h, _btype );
+					( _simd->*_hconv )( buf[ k + b1 ], srcLine( y ), _w, _hkern, _kw, _btype );
+				}
+				/* process first line */
+				( _simd->*_vconv )( dstLine( ystart ), ( const BUFTYPE** ) buf, _vkern, _kh, widthchannels );
+
+				for( size_t cy = ystart + 1; cy < yend; cy++ ) {
+					BUFTYPE* tmp = buf[ 0 ];
+					for( size_t k = 0; k < _kh - 1; k++ )
+						buf[ k ] = buf[ k + 1 ];
+					buf[ _kh - 1 ] = tmp;
+					ssize_t y = IBorder::value<ssize_t>( cy + b2, _h, _btype );
+					( _simd->*_hconv )( tmp, srcLine( y ), _w, _hkern, _kw, _btype );
+					( _simd->*_vconv )( dstLine( cy ), ( const BUFTYPE** ) buf, _vkern, _kh, widthchannels );
+				}
+			}
+
+		private:
+			const SRCTYPE* srcLine( size_t y ) const { return ( const SRCTYPE* ) ( _src + _sstride * y ); }
+			DSTTYPE*	   dstLine( size_t y ) const { return ( DSTTYPE* ) ( _dst + _dstride * y ); }
+
+			SIMD*			_simd;
+			uint8_t*		_dst;
+			size_t			_dstride;
+			const uint8_t*	_src;
+			size_t			_sstride;
+			ssize_t			_w;
+			ssize_t			_h;
+			size_t			_channels;
+			const KERNTYPE* _hkern;
+			size_t			_kw;
+			const KERNTYPE* _vkern;
+			size_t			_kh;
+			HConvFunc		_hconv;
+			VConvFunc		_vconv;
+			IBorderType		_btype;
+	};
+
 	/* general template use for separable convolution ( except the constant border case ) */
 	template<typename DSTTYPE, typename SRCTYPE, typename BUFTYPE, typename KERNTYPE>
 	static void convolveSeparableTemplate( Image& dst, const Image& src, const KERNTYPE* hkern, size_t kw, const KERNTYPE* vkern, size_t kh,
@@ -39,65 +114,76 @@ namespace cvt {
 										   IBorderType btype
 										 )
 	{
-		SIMD* simd = SIMD::instance();
-		ssize_t w = src.width();
-		ssize_t h = src.height();
-		size_t widthchannels = w * src.channels();
-		size_t bstride = Math::pad16( sizeof( BUFTYPE ) * widthchannels ) / sizeof( BUFTYPE ); //FIXME: does this always work - it should
-		BUFTYPE** buf;
-		ssize_t cy;
-
 		IMapScoped<DSTTYPE> mapdst( dst );
 		IMapScoped<const SRCTYPE> mapsrc( src );
 
-		ssize_t b1 = ( kh >> 1 );
-		ssize_t b2 = kh - b1 - 1;
-
-		/* allocate buffers and fill buffer*/
-		ScopedBuffer<BUFTYPE,true> bufmem( bstride * kh );
-		ScopedBuffer<BUFTYPE*,true> bufptr( kh );
-
-		buf = bufptr.ptr();
-		buf[ 0 ] = bufmem.ptr();
-		for( size_t i = 1; i < kh; i++ )
-			buf[ i ] = buf[ i - 1 ] + bstride;
-
-		for( ssize_t k = -b1; k <= b2; k++ ) {
-			ssize_t y = IBorder::value( k, h, btype );
-			( simd->*hconv )( buf[ k + b1 ], mapsrc.line( y ), w, hkern, kw, btype );
-		}
-		/* process first line */
-		( simd->*vconv )( mapdst.ptr(), ( const BUFTYPE** ) buf, vkern, kh, widthchannels );
-		mapdst++;
-
-		mapsrc.setLine( b2 + 1 );
-		/* main part */
-		for( cy = 1; cy < h - b2; cy++ )
-		{
-				BUFTYPE* tmp = buf[ 0 ];
-				for( size_t k = 0; k < kh - 1; k++ )
-					buf[ k ] = buf[ k + 1 ];
-				buf[ kh - 1 ] = tmp;
-				( simd->*hconv )( tmp, mapsrc.ptr(), w, hkern, kw, btype );
-				( simd->*vconv )( mapdst.ptr(), ( const BUFTYPE** ) buf, vkern, kh, widthchannels );
-				mapdst++;
-				mapsrc++;
+		IConvolveSeparableRows<DSTTYPE, SRCTYPE, BUFTYPE, KERNTYPE> rows( ( uint8_t* ) mapdst.base(), mapdst.stride(),
+																		  ( const uint8_t* ) mapsrc.base(), mapsrc.stride(),
+																		  src.width(), src.height(), src.channels(),
+																		  hkern, kw, vkern, kh, hconv, vconv, btype );
+		/* the bands read kh / 2 rows beyond their range, convolving in place is only correct in row order */
+		size_t numThreads = ( const void* ) mapdst.base() == ( const void* ) mapsrc.base() ? 1 : 0;
+		ParallelRows::run( rows, src.width(), src.height(), numThreads );
+	}
 
-		}
+	/* row band of a general convolution ( except the constant border case ) */
+	template<typename DSTTYPE, typename SRCTYPE, typename BUFTYPE, typename KERNTYPE>
+	class IConvolveRows : public ParallelRows::Body
+	{
+		public:
+			typedef void ( SIMD::*ConvFunc )( BUFTYPE*, const SRCTYPE*, size_t, const KERNTYPE* , size_t, IBorderType type ) const;
+			typedef void ( SIMD::*AvgFunc )( DSTTYPE*, const BUFTYPE**, size_t, size_t ) const;
+
+			IConvolveRows( uint8_t* dst, size_t dstride, const uint8_t* src, size_t sstride, ssize_t w, ssize_t h, size_t channels,
+						   const KERNTYPE* kern, ssize_t kw, ssize_t kh, ConvFunc conv, AvgFunc avg, IBorderType btype ) :
+				_simd( SIMD::instance() ), _dst( dst ), _dstride( dstride ), _src( src ), _sstride( sstride ),
+				_w( w ), _h( h ), _channels( channels ), _kern( kern ), _kw( kw ), _kh( kh ),
+				_conv( conv ), _avg( avg ), _btype( btype )
+			{
+			}
 
-		/* lower border */
-		for( ; cy < h; cy++ ) {
-			BUFTYPE* tmp = buf[ 0 ];
-			for( size_t k = 0; k < kh - 1; k++ )
-				buf[ k ] = buf[ k + 1 ];
-			buf[ kh - 1 ] = tmp;
-			ssize_t y = IBorder::value( cy + b2, h, btype );
-			( simd->*hconv )( tmp, mapsrc.line( y ), w, hkern, kw, btype );
-			( simd->*vconv )( mapdst.ptr(), ( const BUFTYPE** ) buf, vkern, kh, widthchannels );
-			mapdst++;
-		}
+			void process( size_t ystart, size_t yend ) const
+			{
+				size_t widthchannels = _w * _channels;
+				size_t bstride = Math::pad16( sizeof( BUFTYPE ) * widthchannels ) / sizeof( BUFTYPE ); //FIXME: does this always work - it should
+				BUFTYPE** buf;
+
+				ssize_t b1 = ( _kh >> 1 );
+
+				/* allocate buffers */
+				ScopedBuffer<BUFTYPE,true> bufmem( bstride * _kh );
+				ScopedBuffer<BUFTYPE*,true> bufptr( _kh );
+
+				buf = bufptr.ptr();
+				buf[ 0 ] = bufmem.ptr();
+				for( ssize_t i = 1; i < _kh; i++ )
+					buf[ i ] = buf[ i - 1 ] + bstride;
+
+				for( ssize_t cy = ystart; cy < ( ssize_t ) yend; cy++ ) {
+					for( ssize_t k = 0; k < _kh; k++ ) {
+						ssize_t y = IBorder::value<ssize_t>( cy - b1 + k, _h, _btype );
+						( _simd->*_conv )( buf[ k ], ( const SRCTYPE* ) ( _src + _sstride * y ), _w, _kern + _kw * k, _kw, _btype );
+					}
+					( _simd->*_avg )( ( DSTTYPE* ) ( _dst + _dstride * cy ), ( const BUFTYPE** ) buf, _kh, widthchannels );
+				}
+			}
 
-	}
+		private:
+			SIMD*			_simd;
+			uint8_t*		_dst;
+			size_t			_dstride;
+			const uint8_t*	_src;
+			size_t			_sstride;
+			ssize_t			_w;
+			ssize_t			_h;
+			size_t			_channels;
+			const KERNTYPE* _kern;
+			ssize_t			_kw;
+			ssize_t			_kh;
+			ConvFunc		_conv;
+			AvgFunc			_avg;
+			IBorderType		_btype;
+	};
 
 	/* general template use for convolution ( except the constant border case ) */
 	template<typename DSTTYPE, typename SRCTYPE, typename BUFTYPE, typename KERNTYPE>
@@ -107,60 +193,14 @@ namespace cvt {
 										   IBorderType btype
 										 )
 	{
-		SIMD* simd = SIMD::instance();
-		ssize_t w = src.width();
-		ssize_t h = src.height();
-		size_t widthchannels = w * src.channels();
-		size_t bstride = Math::pad16( sizeof( BUFTYPE ) * widthchannels ) / sizeof( BUFTYPE ); //FIXME: does this always work - it should
-		BUFTYPE** buf;
-		ssize_t cy;
-
 		IMapScoped<DSTTYPE> mapdst( dst );
 		IMapScoped<const SRCTYPE> mapsrc( src );
 
-		ssize_t b1 = ( kh >> 1 );
-		ssize_t b2 = kh - b1 - 1;
-
-		/* allocate buffers and fill buffer*/
-		ScopedBuffer<BUFTYPE,true> bufmem( bstride * kh );
-		ScopedBuffer<BUFTYPE*,true> bufptr( kh );
-
-		buf = bufptr.ptr();
-		buf[ 0 ] = bufmem.ptr();
-		for( ssize_t i = 1; i < kh; i++ )
-			buf[ i ] = buf[ i - 1 ] + bstride;
-
-
-		/* upper border */
-		for( cy = 0; cy < b1; cy++ ) {
-			for( ssize_t k = 0; k < kh; k++ ) {
-				ssize_t y = IBorder::value( cy - b1 + k, h, btype );
-				( simd->*conv )( buf[ k ], mapsrc.line( y ), w, kern + kw * k, kw, btype );
-			}
-			( simd->*avg )( mapdst.ptr(), ( const BUFTYPE** ) buf, kh, widthchannels );
-			mapdst++;
-		}
-
-		/* main part */
-		for( ; cy < h - b2; cy++ )
-		{
-			for( ssize_t k = 0; k < kh; k++ ) {
-				( simd->*conv )( buf[ k ], mapsrc.line( cy - b1 + k ), w, kern + kw * k, kw, btype );
-			}
-			( simd->*avg )( mapdst.ptr(), ( const BUFTYPE** ) buf, kh, widthchannels );
-			mapdst++;
-		}
-
-		/* lower border */
-		for( ; cy < h; cy++ ) {
-			for( ssize_t k = 0; k < kh; k++ ) {
-				ssize_t y = IBorder::value( cy - b1 + k, h, btype );
-				( simd->*conv )( buf[ k ], mapsrc.line( y ), w, kern + kw * k, kw, btype );
-			}
-			( simd->*avg )( mapdst.ptr(), ( const BUFTYPE** ) buf, kh, widthchannels );
-			mapdst++;
-		}
-
+		IConvolveRows<DSTTYPE, SRCTYPE, BUFTYPE, KERNTYPE> rows( ( uint8_t* ) mapdst.base(), mapdst.stride(),
+																 ( const uint8_t* ) mapsrc.base(), mapsrc.stride(),
+																 src.width(), src.height(), src.channels(),
+																 kern, kw, kh, conv, avg, btype );
+		ParallelRows::run( rows, src.width(), src.height() );
 	}
 
 	void IConvolve::convolve( Image& dst, const Image& src, const IKernel& kernel, IBorderType btype, const Color& )
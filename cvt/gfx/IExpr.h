@@ -28,78 +28,197 @@
 #include <cvt/gfx/IExprType.h>
 #include <cvt/gfx/Image.h>
 #include <cvt/gfx/IMapScoped.h>
+#include <cvt/util/SIMD.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/math/Math.h>
 
 namespace cvt {
+
+	/*
+		Image expressions are evaluated lazily on assignment to an image.
+		The rows of the destination are split across threads with ParallelRows
+		and processed in chunks of at most IEXPR_CHUNKSIZE elements: for every
+		chunk the expression tree is instantiated as a tree of cursors and
+		evaluated element wise in one fused loop, which the compiler inlines
+		and vectorizes. Arbitrary per-pixel pipelines are therefore computed in
+		a single pass over the memory without temporary images.
+
+		Inputs may be UINT8, UINT16 or FLOAT images with any number of
+		channels. Non float inputs are converted chunk wise to floats before
+		the fused loop, the result is saturated to the type of the destination.
+		As in Image::convert the color channels of RGBA/BGRA UINT8 images are
+		treated as sRGB.
+	 */
+	static const size_t IEXPR_CHUNKSIZE = 256;
+
 	template<IExprType type>
 	struct IExprOperation {
-		float operator()( float a, float b );
+		static float apply( float a, float b );
+		static float apply( float a );
 	};
 
 	template<>
 	struct IExprOperation<IEXPR_ADD> {
-		float operator()( float a, float b ) { return a + b; }
+		static float apply( float a, float b ) { return a + b; }
 	};
 
 	template<>
 	struct IExprOperation<IEXPR_SUB> {
-		float operator()( float a, float b ) { return a - b; }
+		static float apply( float a, float b ) { return a - b; }
 	};
 
 	template<>
 	struct IExprOperation<IEXPR_MUL> {
-		float operator()( float a, float b ) { return a * b; }
+		static float apply( float a, float b ) { return a * b; }
 	};
 
-	template<typename T1, typename T2, IExprType op>
-	class IExprBinary
+	template<>
+	struct IExprOperation<IEXPR_DIV> {
+		static float apply( float a, float b ) { return a / b; }
+	};
+
+	/* branch free to allow vectorization */
+	template<>
+	struct IExprOperation<IEXPR_MIN> {
+		static float apply( float a, float b ) { return a < b ? a : b; }
+	};
+
+	template<>
+	struct IExprOperation<IEXPR_MAX> {
+		static float apply( float a, float b ) { return a > b ? a : b; }
+	};
+
+	template<>
+	struct IExprOperation<IEXPR_ABS> {
+		static float apply( float a ) { return Math::abs( a ); }
+	};
+
+	template<>
+	struct IExprOperation<IEXPR_SQRT> {
+		static float apply( float a ) { return Math::sqrt( a ); }
+	};
+
+	/*
+		Common interface of all expression nodes:
+
+		void map() const / void unmap() const
+			map/unmap all images referenced by the expression
+		bool hasSizeFormat( size_t width, size_t height, const IFormat& format ) const
+			check the size, format is the float equivalent of the destination format
+		class Cursor
+			constructed for the chunk [ x, x + n ) of row y with
+			Cursor( const Node&, size_t x, size_t y, size_t n ),
+			operator[]( i ) returns the value of element x + i.
+			Cursors are created concurrently for different rows.
+	 */
+
+	class IExprScalar
 	{
 		public:
-			IExprBinary( const T1& opa, const T2& opb ) : op1( opa ), op2( opb ) {}
+			IExprScalar( float v ) : value( v ) {}
 
-			void eval( Image& dst ) const
-			{
-				if( !hasSizeFormat( dst.width(), dst.height(), dst.format() ) )
-					throw CVTException( "Invalid image expression or assignment!" );
+			class Cursor {
+				public:
+					Cursor( const IExprScalar& expr, size_t, size_t, size_t ) : _value( expr.value ) {}
+					float operator[]( size_t ) const { return _value; }
 
-				map();
+				private:
+					float _value;
+			};
 
-				IMapScoped<float> imap( dst );
-				size_t height = dst.height();
-				size_t width = dst.width() * dst.format().channels;
-				for( size_t y = 0; y < height; y++ ) {
-					setLine( y );
-					imap.setLine( y );
-					float* dstptr = imap.ptr();
+			void  map() const {}
+			void  unmap() const {}
+			bool  hasSizeFormat( size_t, size_t , const IFormat& ) const { return true; }
 
-					for( size_t x = 0; x < width; x++ )
-						dstptr[ x ] = eval( x );
-				}
+			float value;
+	};
 
-				unmap();
-			}
+	class IExprImage
+	{
+		public:
+			IExprImage( const Image& i ) : img( i ), base( NULL ), stride( 0 ) {}
+
+			class Cursor {
+				public:
+					Cursor( const IExprImage& expr, size_t x, size_t y, size_t n ) : _ptr( expr.load( _buf, x, y, n ) ) {}
+					float operator[]( size_t i ) const { return _ptr[ i ]; }
+
+				private:
+					float		 _buf[ IEXPR_CHUNKSIZE ] __attribute__((aligned( 16 )));
+					const float* _ptr;
+			};
 
 			void map() const
 			{
-				op1.map();
-				op2.map();
+				base = img.map( &stride );
 			}
 
 			void unmap() const
 			{
-				op1.unmap();
-				op2.unmap();
+				img.unmap( base );
 			}
 
-			void setLine( size_t y ) const
+			/* float images are accessed directly, everything else is converted into buf */
+			const float* load( float* buf, size_t x, size_t y, size_t n ) const
+			{
+				const uint8_t* ptr = base + y * stride;
+				switch( img.format().type ) {
+					case IFORMAT_TYPE_UINT8:
+						if( img.format().channels == 4 )
+							SIMD::instance()->Conv_XXXAu8_to_XXXAf( buf, ptr + x, n >> 2 );
+						else
+							SIMD::instance()->Conv_u8_to_f( buf, ptr + x, n );
+						return buf;
+					case IFORMAT_TYPE_UINT16:
+						SIMD::instance()->Conv_u16_to_f( buf, ( const uint16_t* ) ptr + x, n );
+						return buf;
+					default:
+						return ( const float* ) ptr + x;
+				}
+			}
+
+			bool hasSizeFormat( size_t width, size_t height, const IFormat& format ) const
+			{
+				if( img.width() != width || img.height() != height )
+					return false;
+				const IFormat& f = img.format();
+				if( f.type != IFORMAT_TYPE_UINT8 && f.type != IFORMAT_TYPE_UINT16 && f.type != IFORMAT_TYPE_FLOAT )
+					return false;
+				return IFormat::floatEquivalent( f ) == format;
+			}
+
+			const Image&			img;
+			mutable const uint8_t*	base;
+			mutable size_t			stride;
+	};
+
+	template<typename T1, typename T2, IExprType op>
+	class IExprBinary
+	{
+		public:
+			IExprBinary( const T1& opa, const T2& opb ) : op1( opa ), op2( opb ) {}
+
+			class Cursor {
+				public:
+					Cursor( const IExprBinary& expr, size_t x, size_t y, size_t n ) :
+						_c1( expr.op1, x, y, n ), _c2( expr.op2, x, y, n ) {}
+					float operator[]( size_t i ) const { return IExprOperation<op>::apply( _c1[ i ], _c2[ i ] ); }
+
+				private:
+					typename T1::Cursor _c1;
+					typename T2::Cursor _c2;
+			};
+
+			void map() const
 			{
-				op1.setLine( y );
-				op2.setLine( y );
+				op1.map();
+				op2.map();
 			}
 
-			float eval( size_t x ) const
+			void unmap() const
 			{
-				IExprOperation<op> theop;
-				return theop( op1.eval( x ), op2.eval( x ) );
+				op1.unmap();
+				op2.unmap();
 			}
 
 			bool hasSizeFormat( size_t width, size_t height, const IFormat& format ) const
@@ -113,75 +232,310 @@ namespace cvt {
 			T2		  op2;
 	};
 
-	class IExprScalar
+	template<typename T1, IExprType op>
+	class IExprUnary
 	{
 		public:
-			IExprScalar( float v ) : value( v ) {}
+			IExprUnary( const T1& opa ) : op1( opa ) {}
 
-			void  map() const {}
-			void  unmap() const {}
-			void  setLine( size_t ) const {}
-			float eval( size_t ) const { return value; }
-			bool  hasSizeFormat( size_t, size_t , const IFormat& ) const { return true; }
+			class Cursor {
+				public:
+					Cursor( const IExprUnary& expr, size_t x, size_t y, size_t n ) : _c1( expr.op1, x, y, n ) {}
+					float operator[]( size_t i ) const { return IExprOperation<op>::apply( _c1[ i ] ); }
 
-			float value;
+				private:
+					typename T1::Cursor _c1;
+			};
+
+			void map() const
+			{
+				op1.map();
+			}
+
+			void unmap() const
+			{
+				op1.unmap();
+			}
+
+			bool hasSizeFormat( size_t width, size_t height, const IFormat& format ) const
+			{
+				return op1.hasSizeFormat( width, height, format );
+			}
+
+			T1		  op1;
 	};
 
-	class IExprImage
+	/*
+		select( cond, a, b ) -> cond > 0 ? a : b
+	 */
+	template<typename T1, typename T2, typename T3>
+	class IExprSelect
 	{
 		public:
-			IExprImage( const Image& i ) : img( i ) {}
+			IExprSelect( const T1& c, const T2& a, const T3& b ) : cond( c ), op1( a ), op2( b ) {}
+
+			class Cursor {
+				public:
+					Cursor( const IExprSelect& expr, size_t x, size_t y, size_t n ) :
+						_cc( expr.cond, x, y, n ), _c1( expr.op1, x, y, n ), _c2( expr.op2, x, y, n ) {}
+					float operator[]( size_t i ) const { return _cc[ i ] > 0.0f ? _c1[ i ] : _c2[ i ]; }
+
+				private:
+					typename T1::Cursor _cc;
+					typename T2::Cursor _c1;
+					typename T3::Cursor _c2;
+			};
 
 			void map() const
 			{
-				imap = new IMapScoped<const float>( img );
+				cond.map();
+				op1.map();
+				op2.map();
 			}
 
 			void unmap() const
 			{
-				delete imap;
+				cond.unmap();
+				op1.unmap();
+				op2.unmap();
 			}
 
-			void setLine( size_t y ) const
+			bool hasSizeFormat( size_t width, size_t height, const IFormat& format ) const
 			{
-				ptr = imap->line( y );
+				return cond.hasSizeFormat( width, height, format ) &&
+					   op1.hasSizeFormat( width, height, format ) &&
+					   op2.hasSizeFormat( width, height, format );
 			}
 
-			float eval( size_t x ) const
+			T1		  cond;
+			T2		  op1;
+			T3		  op2;
+	};
+
+	/*
+		Evaluate the expression chunk wise into the rows of the destination.
+		Float destinations are written directly, element i of the inputs is
+		always read before element i of the destination is written, so the
+		destination may be an operand of the expression.
+	 */
+	template<typename TEXPR>
+	class IExprEvaluator : public ParallelRows::Body
+	{
+		public:
+			IExprEvaluator( const TEXPR& expr, uint8_t* base, size_t stride, const IFormat& format, size_t width ) :
+				_expr( expr ), _base( base ), _stride( stride ), _type( format.type ), _channels( format.channels ), _width( width * format.channels )
 			{
-				return ptr[ x ];
 			}
 
-			bool hasSizeFormat( size_t width, size_t height, const IFormat& format ) const
+			void process( size_t ystart, size_t yend ) const
+			{
+				float buf[ IEXPR_CHUNKSIZE ] __attribute__((aligned( 16 )));
+				SIMD* simd = SIMD::instance();
+
+				for( size_t y = ystart; y < yend; y++ ) {
+					uint8_t* dst = _base + y * _stride;
+					for( size_t x = 0; x < _width; x += IEXPR_CHUNKSIZE ) {
+						size_t n = Math::min( IEXPR_CHUNKSIZE, _width - x );
+						typename TEXPR::Cursor cursor( _expr, x, y, n );
+						switch( _type ) {
+							case IFORMAT_TYPE_FLOAT:
+								evalChunk( ( float* ) dst + x, cursor, n );
+								break;
+							case IFORMAT_TYPE_UINT8:
+								evalChunk( buf, cursor, n );
+								if( _channels == 4 )
+									simd->Conv_XXXAf_to_XXXAu8( dst + x, buf, n >> 2 );
+								else
+									simd->Conv_f_to_u8( dst + x, buf, n );
+								break;
+							case IFORMAT_TYPE_UINT16:
+								evalChunk( buf, cursor, n );
+								simd->Conv_f_to_u16( ( uint16_t* ) dst + x, buf, n );
+								break;
+							default:
+								break;
+						}
+					}
+				}
+			}
+
+		private:
+			static void evalChunk( float* out, const typename TEXPR::Cursor& cursor, size_t n )
 			{
-				return img.width() == width && img.height() == height && img.format() == format;
+				for( size_t i = 0; i < n; i++ )
+					out[ i ] = cursor[ i ];
 			}
 
-			const Image&					 img;
-			mutable IMapScoped<const float>* imap;
-			mutable const float*			 ptr;
+			const TEXPR&	_expr;
+			uint8_t*		_base;
+			size_t			_stride;
+			IFormatType		_type;
+			size_t			_channels;
+			size_t			_width;
 	};
 
+	template<typename TEXPR>
+	inline void IExprEval( Image& dst, const TEXPR& expr )
+	{
+		const IFormat& format = dst.format();
+		if( format.type != IFORMAT_TYPE_UINT8 && format.type != IFORMAT_TYPE_UINT16 && format.type != IFORMAT_TYPE_FLOAT )
+			throw CVTException( "Invalid image expression or assignment!" );
+		if( !expr.hasSizeFormat( dst.width(), dst.height(), IFormat::floatEquivalent( format ) ) )
+			throw CVTException( "Invalid image expression or assignment!" );
+
+		/* make sure the SIMD instance exists before the rows are split */
+		SIMD::instance();
+
+		expr.map();
+		{
+			IMapScoped<uint8_t> map( dst );
+			IExprEvaluator<TEXPR> body( expr, map.base(), map.stride(), format, dst.width() );
+			ParallelRows::run( body, dst.width() * format.channels, dst.height() );
+		}
+		expr.unmap();
+	}
+
+	/*
+		Mapping of operand types to expression nodes, everything else is
+		not part of an image expression
+	 */
 	template<typename TX>
 	struct IExprTypeFromT {
-		typedef TX T;
+		static const bool Valid  = false;
+		static const bool Scalar = false;
 	};
 
 	template<>
 	struct IExprTypeFromT<float> {
+		static const bool Valid  = true;
+		static const bool Scalar = true;
+		typedef IExprScalar T;
+	};
+
+	template<>
+	struct IExprTypeFromT<double> {
+		static const bool Valid  = true;
+		static const bool Scalar = true;
+		typedef IExprScalar T;
+	};
+
+	template<>
+	struct IExprTypeFromT<int> {
+		static const bool Valid  = true;
+		static const bool Scalar = true;
 		typedef IExprScalar T;
 	};
 
 	template<>
 	struct IExprTypeFromT<Image> {
+		static const bool Valid  = true;
+		static const bool Scalar = false;
+		typedef IExprImage T;
+	};
+
+	template<>
+	struct IExprTypeFromT<IExprScalar> {
+		static const bool Valid  = true;
+		static const bool Scalar = true;
+		typedef IExprScalar T;
+	};
+
+	template<>
+	struct IExprTypeFromT<IExprImage> {
+		static const bool Valid  = true;
+		static const bool Scalar = false;
 		typedef IExprImage T;
 	};
 
+	template<typename T1, typename T2, IExprType op>
+	struct IExprTypeFromT<IExprBinary<T1,T2,op> > {
+		static const bool Valid  = true;
+		static const bool Scalar = false;
+		typedef IExprBinary<T1,T2,op> T;
+	};
+
+	template<typename T1, IExprType op>
+	struct IExprTypeFromT<IExprUnary<T1,op> > {
+		static const bool Valid  = true;
+		static const bool Scalar = false;
+		typedef IExprUnary<T1,op> T;
+	};
+
+	template<typename T1, typename T2, typename T3>
+	struct IExprTypeFromT<IExprSelect<T1,T2,T3> > {
+		static const bool Valid  = true;
+		static const bool Scalar = false;
+		typedef IExprSelect<T1,T2,T3> T;
+	};
+
+	/*
+		Result types of the operators - only defined if the operands form an
+		image expression, otherwise the operators are removed from overload resolution
+	 */
+	template<typename TA, typename TB, IExprType op,
+			 bool enable = IExprTypeFromT<TA>::Valid && IExprTypeFromT<TB>::Valid && !( IExprTypeFromT<TA>::Scalar && IExprTypeFromT<TB>::Scalar )>
+	struct IExprBinaryType {};
+
+	template<typename TA, typename TB, IExprType op>
+	struct IExprBinaryType<TA,TB,op,true> {
+		typedef IExprBinary<typename IExprTypeFromT<TA>::T,typename IExprTypeFromT<TB>::T,op> T;
+	};
+
+	template<typename TA, IExprType op,
+			 bool enable = IExprTypeFromT<TA>::Valid && !IExprTypeFromT<TA>::Scalar>
+	struct IExprUnaryType {};
+
+	template<typename TA, IExprType op>
+	struct IExprUnaryType<TA,op,true> {
+		typedef IExprUnary<typename IExprTypeFromT<TA>::T,op> T;
+	};
+
+	template<typename TA, typename TB, typename TC,
+			 bool enable = IExprTypeFromT<TA>::Valid && IExprTypeFromT<TB>::Valid && IExprTypeFromT<TC>::Valid &&
+						   !( IExprTypeFromT<TA>::Scalar && IExprTypeFromT<TB>::Scalar && IExprTypeFromT<TC>::Scalar )>
+	struct IExprSelectType {};
+
+	template<typename TA, typename TB, typename TC>
+	struct IExprSelectType<TA,TB,TC,true> {
+		typedef IExprSelect<typename IExprTypeFromT<TA>::T,typename IExprTypeFromT<TB>::T,typename IExprTypeFromT<TC>::T> T;
+	};
+
+	template<typename TA, typename TLO, typename THI,
+			 bool enable = IExprTypeFromT<TA>::Valid && !IExprTypeFromT<TA>::Scalar && IExprTypeFromT<TLO>::Valid && IExprTypeFromT<THI>::Valid>
+	struct IExprClampType {};
+
+	template<typename TA, typename TLO, typename THI>
+	struct IExprClampType<TA,TLO,THI,true> {
+		typedef IExprBinary<IExprBinary<typename IExprTypeFromT<TA>::T,typename IExprTypeFromT<TLO>::T,IEXPR_MAX>,typename IExprTypeFromT<THI>::T,IEXPR_MIN> T;
+	};
+
+	inline const char* IExprOperationName( IExprType op )
+	{
+		static const char* names[] = { "+", "-" , "*", "/", "min", "max", "abs", "sqrt" };
+		return names[ op ];
+	}
+
     template<typename T1, typename T2, IExprType op>
     inline std::ostream& operator<<( std::ostream& out, const IExprBinary<T1,T2,op>& expr )
     {
-		char opToChar[] = { '+', '-' , '*' };
-		out << "(" << expr.op1 << opToChar[ op ] << expr.op2 << ")";
+		if( op == IEXPR_MIN || op == IEXPR_MAX )
+			out << IExprOperationName( op ) << "(" << expr.op1 << "," << expr.op2 << ")";
+		else
+			out << "(" << expr.op1 << IExprOperationName( op ) << expr.op2 << ")";
+        return out;
+    }
+
+    template<typename T1, IExprType op>
+    inline std::ostream& operator<<( std::ostream& out, const IExprUnary<T1,op>& expr )
+    {
+		out << IExprOperationName( op ) << "(" << expr.op1 << ")";
+        return out;
+    }
+
+    template<typename T1, typename T2, typename T3>
+    inline std::ostream& operator<<( std::ostream& out, const IExprSelect<T1,T2,T3>& expr )
+    {
+		out << "select(" << expr.cond << "," << expr.op1 << "," << expr.op2 << ")";
         return out;
     }
 
@@ -197,95 +551,87 @@ namespace cvt {
         return out;
     }
 
-
-	/*
-		SIMD special cases go here:
-	 */
-#if 0
-	template<>
-	void IExprBinary<IExprImage,IExprScalar,IEXPR_MUL>::eval( Image& dst )
-	{
-	}
-#endif
-
-	/*
-		- Image -> Image * -1
-	 */
-	inline IExprBinary<IExprImage,IExprScalar, IEXPR_MUL> operator-( const Image& img )
-	{
-		return IExprBinary<IExprImage,IExprScalar,IEXPR_MUL>( IExprImage( img ), IExprScalar( -1.0f ) );
-	}
-
 	/*
-		Image + float
-		float + Image
+		- Expr -> Expr * -1
 	 */
-	inline IExprBinary<IExprImage,IExprScalar,IEXPR_ADD> operator+( const float val, const Image& img )
+	template<typename TA>
+	inline typename IExprBinaryType<TA,float,IEXPR_MUL>::T operator-( const TA& a )
 	{
-		return IExprBinary<IExprImage,IExprScalar,IEXPR_ADD>( IExprImage( img ), IExprScalar( val ) );
-	}
-
-	inline IExprBinary<IExprImage,IExprScalar,IEXPR_ADD> operator+( const Image& img, const float val )
-	{
-		return IExprBinary<IExprImage,IExprScalar,IEXPR_ADD>( IExprImage( img ), IExprScalar( val ) );
+		return typename IExprBinaryType<TA,float,IEXPR_MUL>::T( a, IExprScalar( -1.0f ) );
 	}
 
 	/*
-		Image - float
-		float - Image
+		General: X + Y, X - Y, X * Y, X / Y with images, expressions or scalars on both sides
 	 */
-	inline IExprBinary<IExprImage,IExprScalar,IEXPR_SUB> operator-( const float val, const Image& img )
+	template<typename TA, typename TB>
+	inline typename IExprBinaryType<TA,TB,IEXPR_ADD>::T operator+( const TA& a, const TB& b )
 	{
-		return IExprBinary<IExprImage,IExprScalar,IEXPR_SUB>( IExprImage( img ), IExprScalar( val ) );
+		return typename IExprBinaryType<TA,TB,IEXPR_ADD>::T( a, b );
 	}
 
-	inline IExprBinary<IExprImage,IExprScalar,IEXPR_SUB> operator-( const Image& img, const float val )
-	{
-		return IExprBinary<IExprImage,IExprScalar,IEXPR_SUB>( IExprImage( img ), IExprScalar( val ) );
-	}
-
-	/*
-		Image * float
-		float * Image
-	 */
-	inline IExprBinary<IExprImage,IExprScalar,IEXPR_MUL> operator*( const float val, const Image& img )
+	template<typename TA, typename TB>
+	inline typename IExprBinaryType<TA,TB,IEXPR_SUB>::T operator-( const TA& a, const TB& b )
 	{
-		return IExprBinary<IExprImage,IExprScalar,IEXPR_MUL>( IExprImage( img ), IExprScalar( val ) );
+		return typename IExprBinaryType<TA,TB,IEXPR_SUB>::T( a, b );
 	}
 
-	inline IExprBinary<IExprImage,IExprScalar,IEXPR_MUL> operator*( const Image& img, const float val )
+	template<typename TA, typename TB>
+	inline typename IExprBinaryType<TA,TB,IEXPR_MUL>::T operator*( const TA& a, const TB& b )
 	{
-		return IExprBinary<IExprImage,IExprScalar,IEXPR_MUL>( IExprImage( img ), IExprScalar( val ) );
+		return typename IExprBinaryType<TA,TB,IEXPR_MUL>::T( a, b );
 	}
 
-	/*
-		Image + Image
-	 */
-	inline IExprBinary<IExprImage,IExprImage,IEXPR_ADD> operator+( const Image& img1, const Image& img2 )
+	template<typename TA, typename TB>
+	inline typename IExprBinaryType<TA,TB,IEXPR_DIV>::T operator/( const TA& a, const TB& b )
 	{
-		return IExprBinary<IExprImage, IExprImage, IEXPR_ADD>( IExprImage( img1), IExprImage( img2 ) );
+		return typename IExprBinaryType<TA,TB,IEXPR_DIV>::T( a, b );
 	}
 
-	/*
-		Image - Image
-	 */
-	inline IExprBinary<IExprImage,IExprImage,IEXPR_SUB> operator-( const Image& img1, const Image& img2 )
-	{
-		return IExprBinary<IExprImage, IExprImage, IEXPR_SUB>( IExprImage( img1), IExprImage( img2 ) );
-	}
-
-	/*
-		Image * Image
-	 */
-	inline IExprBinary<IExprImage,IExprImage,IEXPR_MUL> operator*( const Image& img1, const Image& img2 )
-	{
-		return IExprBinary<IExprImage, IExprImage, IEXPR_MUL>( IExprImage( img1), IExprImage( img2 ) );
+	namespace iexpr {
+		/*
+			min( X, Y ), max( X, Y ), abs( X ), sqrt( X ), clamp( X, lo, hi ) and select( cond, X, Y )
+			in their own namespace, inside cvt they would hide ::sqrt, ::abs and std::min/max
+		 */
+		template<typename TA, typename TB>
+		inline typename IExprBinaryType<TA,TB,IEXPR_MIN>::T min( const TA& a, const TB& b )
+		{
+			return typename IExprBinaryType<TA,TB,IEXPR_MIN>::T( a, b );
+		}
+
+		template<typename TA, typename TB>
+		inline typename IExprBinaryType<TA,TB,IEXPR_MAX>::T max( const TA& a, const TB& b )
+		{
+			return typename IExprBinaryType<TA,TB,IEXPR_MAX>::T( a, b );
+		}
+
+		template<typename TA>
+		inline typename IExprUnaryType<TA,IEXPR_ABS>::T abs( const TA& a )
+		{
+			return typename IExprUnaryType<TA,IEXPR_ABS>::T( a );
+		}
+
+		template<typename TA>
+		inline typename IExprUnaryType<TA,IEXPR_SQRT>::T sqrt( const TA& a )
+		{
+			return typename IExprUnaryType<TA,IEXPR_SQRT>::T( a );
+		}
+
+		template<typename TA, typename TLO, typename THI>
+		inline typename IExprClampType<TA,TLO,THI>::T clamp( const TA& a, const TLO& lo, const THI& hi )
+		{
+			return min( max( a, lo ), hi );
+		}
+
+		template<typename TC, typename TA, typename TB>
+		inline typename IExprSelectType<TC,TA,TB>::T select( const TC& cond, const TA& a, const TB& b )
+		{
+			return typename IExprSelectType<TC,TA,TB>::T( cond, a, b );
+		}
 	}
 
 	/*
 		( Expr + float ) + float -> Expr + float
 	 */
-
 	template<typename T1>
 	inline IExprBinary<T1,IExprScalar,IEXPR_ADD> operator+( const IExprBinary<T1,IExprScalar,IEXPR_ADD>& expr1, const float val )
 	{
@@ -295,18 +641,15 @@ namespace cvt {
 	/*
 		( Expr + float ) - float -> Expr + float
 	 */
-
 	template<typename T1>
 	inline IExprBinary<T1,IExprScalar,IEXPR_ADD> operator-( const IExprBinary<T1,IExprScalar,IEXPR_ADD>& expr1, const float val )
 	{
 		return IExprBinary<T1,IExprScalar,IEXPR_ADD>( expr1.op1, IExprScalar( expr1.op2.value - val ) );
 	}
 
-
 	/*
 		( Expr * float ) * float -> Expr * float
 	 */
-
 	template<typename T1>
 	inline IExprBinary<T1,IExprScalar,IEXPR_MUL> operator*( const IExprBinary<T1,IExprScalar,IEXPR_MUL>& expr1, const float val )
 	{
@@ -317,50 +660,36 @@ namespace cvt {
 		( Expr1 + float ) + Expr2 -> ( Expr1 + Expr2  ) + float
 	 */
 	template<typename T1, typename T2>
-	inline IExprBinary<IExprBinary<T1,typename IExprTypeFromT<T2>::T,IEXPR_ADD>, IExprScalar, IEXPR_ADD> operator+( const IExprBinary<T1,IExprScalar,IEXPR_ADD>& expr1, const T2& expr2 )
-	{
-
-		return IExprBinary<IExprBinary<T1,typename IExprTypeFromT<T2>::T,IEXPR_ADD>, IExprScalar, IEXPR_ADD>( IExprBinary<T1,typename IExprTypeFromT<T2>::T,IEXPR_ADD>( expr1.op1, typename IExprTypeFromT<T2>::T( expr2 ) ), expr1.op2 );
-	}
-
-	/*
-		General: ( Expr1 + X )
-	 */
-	template<typename T1, typename T2, IExprType op, typename T3>
-	inline IExprBinary<IExprBinary<T1,T2,op>,typename IExprTypeFromT<T3>::T,IEXPR_ADD> operator+( const IExprBinary<T1,T2,op>& expr1, const T3& expr2 )
+	inline IExprBinary<typename IExprBinaryType<T1,T2,IEXPR_ADD,IExprTypeFromT<T2>::Valid && !IExprTypeFromT<T2>::Scalar>::T, IExprScalar, IEXPR_ADD> operator+( const IExprBinary<T1,IExprScalar,IEXPR_ADD>& expr1, const T2& expr2 )
 	{
-		return IExprBinary<IExprBinary<T1,T2,op>,typename IExprTypeFromT<T3>::T,IEXPR_ADD>( expr1, typename IExprTypeFromT<T3>::T( expr2 ) );
+		typedef typename IExprBinaryType<T1,T2,IEXPR_ADD,IExprTypeFromT<T2>::Valid && !IExprTypeFromT<T2>::Scalar>::T TSUM;
+		return IExprBinary<TSUM, IExprScalar, IEXPR_ADD>( TSUM( expr1.op1, expr2 ), expr1.op2 );
 	}
 
 	/*
-		General: ( Expr1 - X )
+		FIXME: seems to be the only way to put it here ...
 	 */
-	template<typename T1, typename T2, IExprType op, typename T3>
-	inline IExprBinary<IExprBinary<T1,T2,op>,typename IExprTypeFromT<T3>::T,IEXPR_SUB> operator-( const IExprBinary<T1,T2,op>& expr1, const T3& expr2 )
+	template<typename T1, typename T2, IExprType op>
+	inline Image& Image::operator=( const IExprBinary<T1,T2,op>& expr )
 	{
-		return IExprBinary<IExprBinary<T1,T2,op>,typename IExprTypeFromT<T3>::T,IEXPR_SUB>( expr1, typename IExprTypeFromT<T3>::T( expr2 ) );
+		IExprEval( *this, expr );
+		return *this;
 	}
 
-	/*
-		General: ( Expr1 * X )
-	 */
-	template<typename T1, typename T2, IExprType op, typename T3>
-	inline IExprBinary<IExprBinary<T1,T2,op>,typename IExprTypeFromT<T3>::T,IEXPR_MUL> operator*( const IExprBinary<T1,T2,op>& expr1, const T3& expr2 )
+	template<typename T1, IExprType op>
+	inline Image& Image::operator=( const IExprUnary<T1,op>& expr )
 	{
-		return IExprBinary<IExprBinary<T1,T2,op>,typename IExprTypeFromT<T3>::T,IEXPR_MUL>( expr1, typename IExprTypeFromT<T3>::T( expr2 ) );
+		IExprEval( *this, expr );
+		return *this;
 	}
 
-	/*
-		FIXME: seems to be the only way to put it here ...
-	 */
-	template<typename T1, typename T2, IExprType op>
-	inline Image& Image::operator=( const IExprBinary<T1,T2,op>& expr )
+	template<typename T1, typename T2, typename T3>
+	inline Image& Image::operator=( const IExprSelect<T1,T2,T3>& expr )
 	{
-		expr.eval( *this );
+		IExprEval( *this, expr );
 		return *this;
 	}
 
-
 }
 
 
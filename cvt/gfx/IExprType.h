@@ -29,7 +29,12 @@ namespace cvt {
 	enum IExprType {
 		IEXPR_ADD = 0,
 		IEXPR_SUB,
-		IEXPR_MUL
+		IEXPR_MUL,
+		IEXPR_DIV,
+		IEXPR_MIN,
+		IEXPR_MAX,
+		IEXPR_ABS,
+		IEXPR_SQRT
 	};
 }
 
@@ -26,76 +26,92 @@
 #include <cvt/gfx/IMapScoped.h>
 #include <cvt/util/SIMD.h>
 #include <cvt/util/ScopedBuffer.h>
+#include <cvt/util/ParallelRows.h>
 #include <cvt/gfx/IMorphological.h>
 
 namespace cvt
 {
 
+	/* row band of a morphological operation - rows outside the image are clamped to the border */
+	template<typename TYPE>
+	class IMorphologicalRows : public ParallelRows::Body
+	{
+		public:
+			typedef void ( SIMD::*HFunc )( TYPE*, const TYPE*, size_t, size_t ) const;
+			typedef void ( SIMD::*VFunc )( TYPE*, const TYPE**, size_t, size_t ) const;
+
+			IMorphologicalRows( uint8_t* dst, size_t dstride, const uint8_t* src, size_t sstride, size_t w, size_t h, size_t radius,
+								HFunc hfunc, VFunc vfunc ) :
+				_simd( SIMD::instance() ), _dst( dst ), _dstride( dstride ), _src( src ), _sstride( sstride ),
+				_w( w ), _h( h ), _radius( radius ), _hfunc( hfunc ), _vfunc( vfunc )
+			{
+			}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				const size_t boxsize = _radius * 2 + 1;
+				size_t bstride = Math::pad16( sizeof( TYPE ) * _w ) / sizeof( TYPE ); //FIXME: does this always work - it should
+				TYPE** buf;
+
+				/* allocate and fill buffer */
+				ScopedBuffer<TYPE,true> bufmem( bstride * boxsize );
+				ScopedBuffer<TYPE*,true> bufptr( boxsize );
+
+				buf = bufptr.ptr();
+				for( size_t i = 0; i < boxsize; i++ ) {
+					buf[ i ] = bufmem.ptr() + i * bstride;
+					( _simd->*_hfunc )( buf[ i ], srcLine( ( ssize_t ) ystart - ( ssize_t ) _radius + ( ssize_t ) i ), _w, _radius );
+				}
+				( _simd->*_vfunc )( dstLine( ystart ), ( const TYPE** ) buf, boxsize, _w );
+
+				for( size_t y = ystart + 1; y < yend; y++ ) {
+					TYPE* tmp = buf[ 0 ];
+					for( size_t k = 0; k < boxsize - 1; k++ )
+						buf[ k ] = buf[ k + 1 ];
+					buf[ boxsize - 1 ] = tmp;
+					( _simd->*_hfunc )( tmp, srcLine( y + _radius ), _w, _radius );
+					( _simd->*_vfunc )( dstLine( y ), ( const TYPE** ) buf, boxsize, _w );
+				}
+			}
+
+		private:
+			const TYPE* srcLine( ssize_t y ) const
+			{
+				y = Math::clamp<ssize_t>( y, 0, _h - 1 );
+				return ( const TYPE* ) ( _src + _sstride * y );
+			}
+
+			TYPE* dstLine( size_t y ) const
+			{
+				return ( TYPE* ) ( _dst + _dstride * y );
+			}
+
+			SIMD*		   _simd;
+			uint8_t*	   _dst;
+			size_t		   _dstride;
+			const uint8_t* _src;
+			size_t		   _sstride;
+			size_t		   _w;
+			ssize_t		   _h;
+			size_t		   _radius;
+			HFunc		   _hfunc;
+			VFunc		   _vfunc;
+	};
+
 	template<typename TYPE>
 	static void morphTemplate( Image& dst, const Image& src, size_t radius,
 								void ( SIMD::*hfunc )( TYPE*, const TYPE*, size_t, size_t ) const,
-								void ( SIMD::*hfuncborder )( TYPE*, const TYPE*, const TYPE*, size_t ) const,
 								void ( SIMD::*vfunc )( TYPE*, const TYPE**, size_t, size_t ) const
 							 )
 	{
-		SIMD* simd = SIMD::instance();
-		const size_t boxsize = radius * 2 + 1;
-		size_t curbuf;
-		size_t w = src.width();
-		size_t h = src.height();
-		size_t bstride = Math::pad16( sizeof( TYPE ) * w ) / sizeof( TYPE ); //FIXME: does this always work - it should
-		TYPE** buf;
-		size_t i;
-
 		IMapScoped<TYPE> mapdst( dst );
 		IMapScoped<const TYPE> mapsrc( src );
 
-		/* allocate and fill buffer */
-		ScopedBuffer<TYPE,true> bufmem( bstride * boxsize );
-		ScopedBuffer<TYPE*,true> bufptr( boxsize );
-
-		buf = bufptr.ptr();
-		buf[ 0 ] = bufmem.ptr();
-		for( i = 0; i < boxsize; i++ ) {
-			if( i != 0 )
-				buf[ i ] = buf[ i - 1 ] + bstride;
-			( simd->*hfunc )( buf[ i ], mapsrc.ptr(), w, radius );
-			mapsrc++;
-		}
-
-		/* upper border */
-		( simd->*vfunc )( mapdst.ptr(), ( const TYPE** ) buf, radius + 1, w );
-		for( i = 1; i < radius; i++ ) {
-			TYPE* prev = mapdst.ptr();
-			mapdst++;
-			( simd->*hfuncborder )( mapdst.ptr(), ( const TYPE* ) prev, ( const TYPE* ) buf[ radius + 1 + i ], w );
-		}
-		mapdst++;
-
-		/* center */
-		curbuf = 0;
-		i = h - 2 * radius - 1;
-		( simd->*vfunc )( mapdst.ptr(), ( const TYPE** ) buf, boxsize, w );
-		mapdst++;
-		while( i-- ) {
-			( simd->*hfunc )( buf[ curbuf ], mapsrc.ptr(), w, radius );
-			curbuf = ( curbuf + 1 ) % boxsize;
-			( simd->*vfunc )( mapdst.ptr(), ( const TYPE** ) buf, boxsize, w );
-			mapdst++;
-			mapsrc++;
-		}
-
-		/* lower border */
-		/* reorder buffer */
-		ScopedBuffer<TYPE*,true> bufptr2( boxsize );
-		TYPE** buf2 = bufptr2.ptr();
-		for( i = 0; i < boxsize; i++ )
-			buf2[ i ] = buf[ ( curbuf + i ) % boxsize ];
-
-		for( i = 1; i <= radius; i++ ) {
-			( simd->*vfunc )( mapdst.ptr(), ( const TYPE** ) ( buf2 + i ), boxsize - i, w );
-			mapdst++;
-		}
+		IMorphologicalRows<TYPE> rows( ( uint8_t* ) mapdst.base(), mapdst.stride(), ( const uint8_t* ) mapsrc.base(), mapsrc.stride(),
+									   src.width(), src.height(), radius, hfunc, vfunc );
+		/* the bands read radius rows beyond their range, filtering in place is only correct in row order */
+		size_t numThreads = ( const TYPE* ) mapdst.base() == mapsrc.base() ? 1 : 0;
+		ParallelRows::run( rows, src.width(), src.height(), numThreads );
 	}
 
 	void IMorphological::dilate( Image& dst, const Image& src, size_t radius )
@@ -107,13 +123,13 @@ namespace cvt
 
 		switch( src.format().formatID ) {
 			case IFORMAT_GRAY_UINT8:
-				morphTemplate<uint8_t>( dst, src, radius, &SIMD::dilateSpanU8, &SIMD::MaxValueU8, &SIMD::MaxValueVertU8 );
+				morphTemplate<uint8_t>( dst, src, radius, &SIMD::dilateSpanU8, &SIMD::MaxValueVertU8 );
 				return;
 			case IFORMAT_GRAY_UINT16:
-				morphTemplate<uint16_t>( dst, src, radius, &SIMD::dilateSpanU16, &SIMD::MaxValueU16, &SIMD::MaxValueVertU16 );
+				morphTemplate<uint16_t>( dst, src, radius, &SIMD::dilateSpanU16, &SIMD::MaxValueVertU16 );
 				break;
 			case IFORMAT_GRAY_FLOAT:
-				morphTemplate<float>( dst, src, radius, &SIMD::dilateSpan1f, &SIMD::MaxValue1f, &SIMD::MaxValueVert1f );
+				morphTemplate<float>( dst, src, radius, &SIMD::dilateSpan1f, &SIMD::MaxValueVert1f );
 				break;
 			default:
 				throw CVTException( "Not implemented" );
@@ -129,13 +145,13 @@ namespace cvt
 
 		switch( src.format().formatID ) {
 			case IFORMAT_GRAY_UINT8:
-				morphTemplate<uint8_t>( dst, src, radius, &SIMD::erodeSpanU8, &SIMD::MinValueU8, &SIMD::MinValueVertU8 );
+				morphTemplate<uint8_t>( dst, src, radius, &SIMD::erodeSpanU8, &SIMD::MinValueVertU8 );
 				return;
 			case IFORMAT_GRAY_UINT16:
-				morphTemplate<uint16_t>( dst, src, radius, &SIMD::erodeSpanU16, &SIMD::MinValueU16, &SIMD::MinValueVertU16 );
+				morphTemplate<uint16_t>( dst, src, radius, &SIMD::erodeSpanU16, &SIMD::MinValueVertU16 );
 				break;
 			case IFORMAT_GRAY_FLOAT:
-				morphTemplate<float>( dst, src, radius, &SIMD::erodeSpan1f, &SIMD::MinValue1f, &SIMD::MinValueVert1f );
+				morphTemplate<float>( dst, src, radius, &SIMD::erodeSpan1f, &SIMD::MinValueVert1f );
 				break;
 			default:
 				throw CVTException( "Not implemented" );
@@ -26,41 +26,94 @@
 #include <cvt/gfx/IMapScoped.h>
 #include <cvt/util/SIMD.h>
 #include <cvt/gfx/IThreshold.h>
+#include <cvt/util/ParallelRows.h>
 
 namespace cvt
 {
+	template<typename DSTTYPE, typename SRCTYPE, typename THTYPE>
+	class IThresholdRows : public ParallelRows::Body
+	{
+		public:
+			typedef void ( SIMD::*ThresholdFunc )( DSTTYPE*, const SRCTYPE*, size_t, THTYPE ) const;
+
+			IThresholdRows( uint8_t* dst, size_t dstride, const uint8_t* src, size_t sstride, size_t w, THTYPE t, ThresholdFunc func ) :
+				_simd( SIMD::instance() ), _dst( dst ), _dstride( dstride ), _src( src ), _sstride( sstride ), _w( w ), _t( t ), _func( func )
+			{
+			}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				for( size_t y = ystart; y < yend; y++ )
+					( _simd->*_func )( ( DSTTYPE* ) ( _dst + _dstride * y ), ( const SRCTYPE* ) ( _src + _sstride * y ), _w, _t );
+			}
+
+		private:
+			SIMD*		   _simd;
+			uint8_t*	   _dst;
+			size_t		   _dstride;
+			const uint8_t* _src;
+			size_t		   _sstride;
+			size_t		   _w;
+			THTYPE		   _t;
+			ThresholdFunc  _func;
+	};
+
+	template<typename DSTTYPE, typename SRCTYPE, typename THTYPE>
+	class IThresholdAdaptiveRows : public ParallelRows::Body
+	{
+		public:
+			typedef void ( SIMD::*ThresholdFunc )( DSTTYPE*, const SRCTYPE*, const SRCTYPE*, size_t, THTYPE ) const;
+
+			IThresholdAdaptiveRows( uint8_t* dst, size_t dstride, const uint8_t* src, size_t sstride, const uint8_t* mean, size_t mstride,
+									size_t w, THTYPE t, ThresholdFunc func ) :
+				_simd( SIMD::instance() ), _dst( dst ), _dstride( dstride ), _src( src ), _sstride( sstride ),
+				_mean( mean ), _mstride( mstride ), _w( w ), _t( t ), _func( func )
+			{
+			}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				for( size_t y = ystart; y < yend; y++ )
+					( _simd->*_func )( ( DSTTYPE* ) ( _dst + _dstride * y ), ( const SRCTYPE* ) ( _src + _sstride * y ),
+									   ( const SRCTYPE* ) ( _mean + _mstride * y ), _w, _t );
+			}
+
+		private:
+			SIMD*		   _simd;
+			uint8_t*	   _dst;
+			size_t		   _dstride;
+			const uint8_t* _src;
+			size_t		   _sstride;
+			const uint8_t* _mean;
+			size_t		   _mstride;
+			size_t		   _w;
+			THTYPE		   _t;
+			ThresholdFunc  _func;
+	};
+
 	template<typename DSTTYPE, typename SRCTYPE, typename THTYPE>
 	static void thresholdTemplate( Image& dst, const Image& src, THTYPE t, void ( SIMD::*func )( DSTTYPE*, const SRCTYPE*, size_t, THTYPE ) const )
 	{
-		SIMD* simd = SIMD::instance();
 		cvt::IMapScoped<DSTTYPE> mapdst( dst );
 		cvt::IMapScoped<const SRCTYPE> mapsrc( src );
-		size_t w = src.width();
-		size_t h = src.height();
 
-		while( h-- ) {
-			( simd->*func )( mapdst.ptr(), mapsrc.ptr(), w, t );
-			mapdst++;
-			mapsrc++;
-		}
+		IThresholdRows<DSTTYPE, SRCTYPE, THTYPE> rows( ( uint8_t* ) mapdst.base(), mapdst.stride(), ( const uint8_t* ) mapsrc.base(), mapsrc.stride(),
+													   src.width(), t, func );
+		ParallelRows::run( rows, src.width(), src.height() );
 	}
 
 	template<typename DSTTYPE, typename SRCTYPE, typename THTYPE>
 	static void thresholdAdaptiveTemplate( Image& dst, const Image& src, const Image& srcmean, THTYPE t, void ( SIMD::*func )( DSTTYPE*, const SRCTYPE*, const SRCTYPE*, size_t, THTYPE ) const )
 	{
-		SIMD* simd = SIMD::instance();
 		cvt::IMapScoped<DSTTYPE> mapdst( dst );
 		cvt::IMapScoped<const SRCTYPE> mapsrc( src );
 		cvt::IMapScoped<const SRCTYPE> mapsrcmean( srcmean );
-		size_t w = src.width();
-		size_t h = src.height();
-
-		while( h-- ) {
-			( simd->*func )( mapdst.ptr(), mapsrc.ptr(), mapsrcmean.ptr(), w, t );
-			mapdst++;
-			mapsrc++;
-			mapsrcmean++;
-		}
+
+		IThresholdAdaptiveRows<DSTTYPE, SRCTYPE, THTYPE> rows( ( uint8_t* ) mapdst.base(), mapdst.stride(),
+															   ( const uint8_t* ) mapsrc.base(), mapsrc.stride(),
+															   ( const uint8_t* ) mapsrcmean.base(), mapsrcmean.stride(),
+															   src.width(), t, func );
+		ParallelRows::run( rows, src.width(), src.height() );
 	}
 
 
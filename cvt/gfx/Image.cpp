@@ -68,6 +68,13 @@ namespace cvt {
 		memAllocator->alloc( w, h, format, data, stride );
 	}
 
+	Image::Image( size_t w, size_t h, const IFormat & format, const uint8_t* data, size_t stride )
+	{
+		_mem = new ImageAllocatorMem();
+		ImageAllocatorMem * memAllocator = (ImageAllocatorMem *)_mem;
+		memAllocator->alloc( w, h, format, data, stride );
+	}
+
 
 	Image::Image( const Image& img, IAllocatorType memtype )
 	{
@@ -102,7 +109,11 @@ namespace cvt {
 				_mem = new ImageAllocatorMem();
 			_mem->copy( source._mem, roi );
 		} else {
-			throw CVTException("Shared image memory not implemented yet");
+			if( memtype != IALLOCATOR_MEM || source.memType() != IALLOCATOR_MEM )
+				throw CVTException( "Shared image memory is only supported for IALLOCATOR_MEM" );
+			ImageAllocatorMem* mem = new ImageAllocatorMem();
+			_mem = mem;
+			mem->share( ( const ImageAllocatorMem* ) source._mem, roi );
 		}
 	}
 
@@ -168,6 +179,26 @@ namespace cvt {
 		delete _mem;
 	}
 
+	void Image::share( const Image& img, const Recti* roi )
+	{
+		if( img.memType() != IALLOCATOR_MEM ) {
+			_mem->copy( img._mem, roi );
+			return;
+		}
+
+		if( _mem->type() != IALLOCATOR_MEM ) {
+			delete _mem;
+			_mem = new ImageAllocatorMem();
+		}
+		( ( ImageAllocatorMem* ) _mem )->share( ( const ImageAllocatorMem* ) img._mem, roi );
+	}
+
+	void Image::setBufferPool( ImageBufferPool* pool )
+	{
+		if( _mem->type() == IALLOCATOR_MEM )
+			( ( ImageAllocatorMem* ) _mem )->setPool( pool );
+	}
+
 	Image& Image::operator=( const Color& c )
 	{
 		fill( c );
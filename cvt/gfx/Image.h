@@ -44,8 +44,11 @@
 namespace cvt {
 	class ISaver;
 	class ILoader;
+	class ImageBufferPool;
 
 	template<typename T1, typename T2, IExprType op> class IExprBinary;
+	template<typename T1, IExprType op> class IExprUnary;
+	template<typename T1, typename T2, typename T3> class IExprSelect;
 
 	class Image : public Drawable
 	{
@@ -58,6 +61,8 @@ namespace cvt {
 		public:
 			Image( size_t w = 1, size_t h = 1, const IFormat & format = IFormat::RGBA_UINT8, IAllocatorType memtype = IALLOCATOR_MEM );
 			Image( size_t w, size_t h, const IFormat & format, uint8_t* data, size_t stride = 0 );
+			/* wraps read-only data, mapping the image mutable copies it first */
+			Image( size_t w, size_t h, const IFormat & format, const uint8_t* data, size_t stride = 0 );
 			Image( const Image& img, IAllocatorType memtype = IALLOCATOR_MEM );
 			Image( const String & fileName, IAllocatorType memtype = IALLOCATOR_MEM );
 			Image( const Image& source, const Recti* roi, bool ref = false, IAllocatorType memtype = IALLOCATOR_MEM );
@@ -81,7 +86,7 @@ namespace cvt {
 			const IFormat & format() const;
 			IAllocatorType memType() const { return _mem->type(); }
 			uint8_t* map( size_t* stride ) { return _mem->map( stride ); }
-			const uint8_t * map( size_t* stride ) const { return ( const uint8_t* ) _mem->map( stride ); }
+			const uint8_t * map( size_t* stride ) const { return ( ( const ImageAllocator* ) _mem )->map( stride ); }
 			template<typename _T> _T* map( size_t* stride );
 			template<typename _T> const _T* map( size_t* stride ) const;
 			void unmap( const uint8_t* ptr ) const { _mem->unmap( ptr ); }
@@ -89,9 +94,20 @@ namespace cvt {
 
 			void reallocate( size_t w, size_t h, const IFormat & format = IFormat::RGBA_UINT8, IAllocatorType memtype = IALLOCATOR_MEM );
 			void reallocate( const Image& i, IAllocatorType memtype = IALLOCATOR_MEM );
+			/*
+			   share the memory of img (or of the region roi) instead of copying it,
+			   the buffer is copied on the first mutable map() of any of the sharing images.
+			   Images using other allocators than IALLOCATOR_MEM are copied.
+			 */
+			void share( const Image& img, const Recti* roi = NULL );
+			/* use the pool for further allocations of this memory image, NULL disables pooling */
+			void setBufferPool( ImageBufferPool* pool );
 
 			void copyRect( int x, int y, const Image& i, const Recti & roi );
 
+			/* exchange the image data with img without copying */
+			void swap( Image& img );
+
 			Image* clone() const;
 			void convert( Image& dst, const IFormat & format, IAllocatorType memtype, IConvertFlags flags = ICONVERT_DEBAYER_LINEAR  ) const;
 			void convert( Image& dst, const IFormat & format, IConvertFlags flags = ICONVERT_DEBAYER_LINEAR  ) const;
@@ -139,6 +155,10 @@ namespace cvt {
 
 			template<typename T1, typename T2, IExprType op>
 			Image& operator=( const IExprBinary<T1,T2,op>& expr );
+			template<typename T1, IExprType op>
+			Image& operator=( const IExprUnary<T1,op>& expr );
+			template<typename T1, typename T2, typename T3>
+			Image& operator=( const IExprSelect<T1,T2,T3>& expr );
 
 			void warpBilinear( Image& idst, const Image& warp ) const;
 
@@ -207,7 +227,7 @@ namespace cvt {
 	template<typename _T>
 	inline const _T* Image::map( size_t* stride ) const
 	{
-		const uint8_t* ret = _mem->map( stride );
+		const uint8_t* ret = ( ( const ImageAllocator* ) _mem )->map( stride );
 		*stride /= sizeof( _T );
 		return ( const _T * ) ret;
 	}
@@ -218,6 +238,13 @@ namespace cvt {
 		 _mem->unmap( ( uint8_t* ) ptr );
 	}
 
+	inline void Image::swap( Image& img )
+	{
+		ImageAllocator* tmp = _mem;
+		_mem = img._mem;
+		img._mem = tmp;
+	}
+
 	inline Image& Image::operator=( const Image& img )
 	{
 		if( this != &img )
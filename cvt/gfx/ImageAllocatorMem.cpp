@@ -23,13 +23,27 @@
 */
 
 #include <cvt/gfx/ImageAllocatorMem.h>
+#include <cvt/gfx/ImageBufferPool.h>
 #include <cvt/util/SIMD.h>
 #include <cvt/util/Util.h>
 
 namespace cvt {
 
-	ImageAllocatorMem::ImageAllocatorMem() : ImageAllocator(), _data( 0 ), _mem( 0 ), _refcnt( 0 )
+	ImageBufferPool* ImageAllocatorMem::_defaultPool = NULL;
+
+	ImageAllocatorMem::ImageAllocatorMem() : ImageAllocator(), _data( 0 ), _mem( 0 ), _refcnt( 0 ),
+		_pool( _defaultPool ), _pooled( false ), _readOnly( false )
+	{
+	}
+
+	void ImageAllocatorMem::setDefaultPool( ImageBufferPool* pool )
+	{
+		_defaultPool = pool;
+	}
+
+	ImageBufferPool* ImageAllocatorMem::defaultPool()
 	{
+		return _defaultPool;
 	}
 
 	ImageAllocatorMem::~ImageAllocatorMem()
@@ -53,13 +67,19 @@ namespace cvt {
 		_mem = NULL;
 		_data = data;
 		_refcnt = new size_t;
-		*_refcnt = 0;
-		retain();
+		*_refcnt = 1;
+	}
+
+	void ImageAllocatorMem::alloc( size_t width, size_t height, const IFormat & format, const uint8_t* data, size_t stride )
+	{
+		alloc( width, height, format, const_cast<uint8_t*>( data ), stride );
+		_readOnly = true;
 	}
 
 	void ImageAllocatorMem::alloc( size_t width, size_t height, const IFormat & format )
 	{
-		if( _width == width && _height == height && _format == format )
+		/* a shared or read-only buffer is replaced, the content is not preserved anyway */
+		if( _width == width && _height == height && _format == format && !isShared() && !_readOnly )
 			return;
 
 		release();
@@ -67,11 +87,95 @@ namespace cvt {
 		_height = height;
 		_format = format;
 		_stride = Math::pad16( _width * _format.bpp );
+		allocBuffer();
+	}
+
+	void ImageAllocatorMem::allocBuffer()
+	{
+		if( _pool ) {
+			/* the pool buffer carries its own reference count */
+			_mem = _data = _pool->alloc( _stride * _height );
+			_refcnt = NULL;
+			_pooled = true;
+			_readOnly = false;
+			return;
+		}
 		_mem = new uint8_t[ _stride * _height + 16 ];
 		_data = Util::alignPtr( _mem, 16 );
 		_refcnt = new size_t;
-		*_refcnt = 0;
-		retain();
+		*_refcnt = 1;
+		_pooled = false;
+		_readOnly = false;
+	}
+
+	void ImageAllocatorMem::share( const ImageAllocatorMem* x, const Recti* r )
+	{
+		if( x == this && !r )
+			return;
+
+		Recti rect( 0, 0, ( int ) x->_width, ( int ) x->_height );
+		if( r )
+			rect.intersect( *r );
+
+		/* retain first, x may already share our buffer */
+		retainBuffer( x->_mem, x->_refcnt, x->_pooled );
+		uint8_t* data = x->_data + rect.y * x->_stride + x->_format.bpp * rect.x;
+		size_t stride = x->_stride;
+		uint8_t* mem = x->_mem;
+		size_t* refcnt = x->_refcnt;
+		bool pooled = x->_pooled;
+		bool readOnly = x->_readOnly;
+		IFormat format = x->_format;
+
+		release();
+		_width = rect.width;
+		_height = rect.height;
+		_format = format;
+		_stride = stride;
+		_data = data;
+		_mem = mem;
+		_refcnt = refcnt;
+		_pooled = pooled;
+		_readOnly = readOnly;
+	}
+
+	bool ImageAllocatorMem::isShared() const
+	{
+		if( _pooled )
+			return ImageBufferPool::refCount( _mem ) > 1;
+		return _refcnt && __sync_add_and_fetch( _refcnt, 0 ) > 1;
+	}
+
+	void ImageAllocatorMem::detach()
+	{
+		const uint8_t* src = _data;
+		size_t sstride = _stride;
+		uint8_t* mem = _mem;
+		size_t* refcnt = _refcnt;
+		bool pooled = _pooled;
+		SIMD* simd = SIMD::instance();
+
+		_stride = Math::pad16( _width * _format.bpp );
+		allocBuffer();
+
+		uint8_t* dst = _data;
+		size_t n = _format.bpp * _width;
+		size_t i = _height;
+		while( i-- ) {
+			simd->Memcpy( dst, src, n );
+			dst += _stride;
+			src += sstride;
+		}
+
+		releaseBuffer( mem, refcnt, pooled );
+	}
+
+	uint8_t* ImageAllocatorMem::map( size_t* stride )
+	{
+		if( _readOnly || isShared() )
+			detach();
+		*stride = _stride;
+		return _data;
 	}
 
 	void ImageAllocatorMem::copy( const ImageAllocator* x, const Recti* r = NULL )
@@ -103,23 +207,35 @@ namespace cvt {
 		x->unmap( osrc );
 	}
 
-	void ImageAllocatorMem::release()
+	void ImageAllocatorMem::retainBuffer( uint8_t* mem, size_t* refcnt, bool pooled )
 	{
-		if( _refcnt ) {
-			*_refcnt -= 1;
-			if( *_refcnt <= 0 ) {
-				if( _mem )
-					delete[] _mem;
-				delete _refcnt;
+		if( pooled )
+			ImageBufferPool::retain( mem );
+		else if( refcnt )
+			__sync_add_and_fetch( refcnt, 1 );
+	}
+
+	void ImageAllocatorMem::releaseBuffer( uint8_t* mem, size_t* refcnt, bool pooled )
+	{
+		if( pooled ) {
+			ImageBufferPool::release( mem );
+		} else if( refcnt ) {
+			if( !__sync_sub_and_fetch( refcnt, 1 ) ) {
+				if( mem )
+					delete[] mem;
+				delete refcnt;
 			}
 		}
 	}
 
-	void ImageAllocatorMem::retain()
+	void ImageAllocatorMem::release()
 	{
-		if( _refcnt ) {
-			*_refcnt += 1;
-		}
+		releaseBuffer( _mem, _refcnt, _pooled );
+		_data = NULL;
+		_mem = NULL;
+		_refcnt = NULL;
+		_pooled = false;
+		_readOnly = false;
 	}
 
 }
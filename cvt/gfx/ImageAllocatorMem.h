@@ -27,28 +27,53 @@
 #include <cvt/gfx/ImageAllocator.h>
 
 namespace cvt {
+	class ImageBufferPool;
+
 	class ImageAllocatorMem : public ImageAllocator {
 		public:
 			ImageAllocatorMem();
 			~ImageAllocatorMem();
 			virtual void alloc( size_t width, size_t height, const IFormat & format );
 			void alloc( size_t width, size_t height, const IFormat & format, uint8_t* data, size_t stride = 0 );
+			/* wrap read-only data, the mutable map copies it first */
+			void alloc( size_t width, size_t height, const IFormat & format, const uint8_t* data, size_t stride = 0 );
 			virtual void copy( const ImageAllocator* x, const Recti* r );
-			virtual uint8_t* map( size_t* stride ) { *stride = _stride; return _data; };
+			/* the mutable map detaches a shared buffer by copying it */
+			virtual uint8_t* map( size_t* stride );
 			virtual const uint8_t* map( size_t* stride ) const { *stride = _stride; return _data; };
 			virtual void unmap( const uint8_t* ) const {};
 			virtual IAllocatorType type() const { return IALLOCATOR_MEM; };
 
+			/* share the buffer (or the region r of it) of x until one of them is mapped mutable */
+			void share( const ImageAllocatorMem* x, const Recti* r = NULL );
+			bool isShared() const;
+
+			/* pool used for further allocations, NULL allocates from the heap */
+			void setPool( ImageBufferPool* pool ) { _pool = pool; }
+			ImageBufferPool* pool() const { return _pool; }
+
+			/* pool of newly created allocators, NULL by default */
+			static void setDefaultPool( ImageBufferPool* pool );
+			static ImageBufferPool* defaultPool();
+
 		private:
 			ImageAllocatorMem( const ImageAllocatorMem& );
-			void retain();
+			void allocBuffer();
+			void detach();
 			void release();
+			static void retainBuffer( uint8_t* mem, size_t* refcnt, bool pooled );
+			static void releaseBuffer( uint8_t* mem, size_t* refcnt, bool pooled );
 
 		private:
 			uint8_t* _data;
 			size_t _stride;
-			uint8_t* _mem;
-			size_t* _refcnt;
+			uint8_t* _mem;		/* start of the heap or pool buffer, NULL for external data */
+			size_t* _refcnt;	/* atomic reference count of heap and external buffers */
+			ImageBufferPool* _pool;
+			bool _pooled;
+			bool _readOnly;		/* external data that must not be written */
+
+			static ImageBufferPool* _defaultPool;
 	};
 }
 
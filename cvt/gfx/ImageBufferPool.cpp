@@ -0,0 +1,369 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/gfx/ImageBufferPool.h>
+#include <cvt/util/Util.h>
+
+#include <sys/mman.h>
+
+namespace cvt {
+
+	/* header in front of the data of every buffer */
+	struct ImageBufferPool::Buffer {
+		size_t				refcnt;
+		size_t				cls;
+		size_t				size;
+		ImageBufferPool*	pool;
+		Buffer*				next;
+		uint8_t*			mem;
+		size_t				memsize;	/* length of the mapping, 0 for heap memory */
+	};
+
+	struct ImageBufferPool::ThreadCache {
+		ThreadCache( ImageBufferPool* p ) : pool( p ), prev( NULL ), next( NULL )
+		{
+			for( size_t i = 0; i < NUM_LOCAL_CLASSES; i++ ) {
+				free[ i ] = NULL;
+				count[ i ] = 0;
+			}
+		}
+
+		ImageBufferPool*	pool;
+		ThreadCache*		prev;
+		ThreadCache*		next;
+		Buffer*				free[ NUM_LOCAL_CLASSES ];
+		size_t				count[ NUM_LOCAL_CLASSES ];
+	};
+
+	static const size_t HEADER_SIZE	  = 64;
+	static const size_t HUGEPAGE_SIZE = 2 << 20;
+
+	ImageBufferPool::ImageBufferPool( size_t maxCachedBytes ) :
+		_caches( NULL ),
+		_maxCachedBytes( maxCachedBytes ),
+		_hugePageThreshold( HUGEPAGE_SIZE ),
+		_hits( 0 ),
+		_misses( 0 ),
+		_bytesInUse( 0 ),
+		_peakBytes( 0 ),
+		_bytesCached( 0 )
+	{
+		for( size_t i = 0; i < NUM_CLASSES; i++ )
+			_free[ i ] = NULL;
+		int err = pthread_key_create( &_key, threadExit );
+		if( err )
+			throw CVTException( err );
+	}
+
+	ImageBufferPool::~ImageBufferPool()
+	{
+		_mutex.lock();
+		for( size_t i = 0; i < NUM_CLASSES; i++ ) {
+			while( _free[ i ] ) {
+				Buffer* buf = _free[ i ];
+				_free[ i ] = buf->next;
+				freeBuffer( buf );
+			}
+		}
+		while( _caches ) {
+			ThreadCache* cache = _caches;
+			_caches = cache->next;
+			for( size_t i = 0; i < NUM_LOCAL_CLASSES; i++ ) {
+				while( cache->free[ i ] ) {
+					Buffer* buf = cache->free[ i ];
+					cache->free[ i ] = buf->next;
+					freeBuffer( buf );
+				}
+			}
+			delete cache;
+		}
+		_mutex.unlock();
+		pthread_key_delete( _key );
+	}
+
+	ImageBufferPool& ImageBufferPool::instance()
+	{
+		/* never destroyed - images may outlive the static destructors */
+		static ImageBufferPool* _pool = new ImageBufferPool();
+		return *_pool;
+	}
+
+	size_t ImageBufferPool::sizeClass( size_t size, size_t* classSize )
+	{
+		if( size <= ( ( size_t ) 1 << MIN_CLASS_SHIFT ) ) {
+			*classSize = ( size_t ) 1 << MIN_CLASS_SHIFT;
+			return 0;
+		}
+
+		/* 2^p < size <= 2^(p+1), four classes in between */
+		size_t p = sizeof( unsigned long ) * 8 - 1 - __builtin_clzl( ( unsigned long ) ( size - 1 ) );
+		size_t step = ( size_t ) 1 << ( p - 2 );
+		size_t k = ( size - ( ( size_t ) 1 << p ) + step - 1 ) / step;
+		*classSize = ( ( size_t ) 1 << p ) + k * step;
+		return 1 + ( p - MIN_CLASS_SHIFT ) * 4 + ( k - 1 );
+	}
+
+	uint8_t* ImageBufferPool::alloc( size_t size )
+	{
+		size_t classSize;
+		size_t cls = sizeClass( size, &classSize );
+		if( cls >= NUM_CLASSES )
+			throw CVTException( "Image buffer size not supported" );
+
+		Buffer* buf = NULL;
+		if( cls < NUM_LOCAL_CLASSES ) {
+			ThreadCache* cache = threadCache();
+			if( cache->free[ cls ] ) {
+				buf = cache->free[ cls ];
+				cache->free[ cls ] = buf->next;
+				cache->count[ cls ]--;
+			}
+		}
+
+		if( !buf ) {
+			_mutex.lock();
+			if( _free[ cls ] ) {
+				buf = _free[ cls ];
+				_free[ cls ] = buf->next;
+			}
+			_mutex.unlock();
+		}
+
+		if( buf ) {
+			__sync_fetch_and_sub( &_bytesCached, buf->size );
+			__sync_fetch_and_add( &_hits, 1 );
+		} else {
+			buf = allocBuffer( cls, classSize );
+			__sync_fetch_and_add( &_misses, 1 );
+		}
+
+		buf->refcnt = 1;
+		buf->next	= NULL;
+
+		size_t inuse = __sync_add_and_fetch( &_bytesInUse, buf->size );
+		size_t peak = _peakBytes;
+		while( inuse > peak && !__sync_bool_compare_and_swap( &_peakBytes, peak, inuse ) )
+			peak = _peakBytes;
+
+		return ( uint8_t* ) buf + HEADER_SIZE;
+	}
+
+	void ImageBufferPool::retain( uint8_t* ptr )
+	{
+		Buffer* buf = ( Buffer* ) ( ptr - HEADER_SIZE );
+		__sync_add_and_fetch( &buf->refcnt, 1 );
+	}
+
+	void ImageBufferPool::release( uint8_t* ptr )
+	{
+		Buffer* buf = ( Buffer* ) ( ptr - HEADER_SIZE );
+		if( !__sync_sub_and_fetch( &buf->refcnt, 1 ) )
+			buf->pool->recycle( buf );
+	}
+
+	size_t ImageBufferPool::capacity( const uint8_t* ptr )
+	{
+		return ( ( const Buffer* ) ( ptr - HEADER_SIZE ) )->size;
+	}
+
+	size_t ImageBufferPool::refCount( const uint8_t* ptr )
+	{
+		Buffer* buf = ( Buffer* ) ( ptr - HEADER_SIZE );
+		return __sync_add_and_fetch( &buf->refcnt, 0 );
+	}
+
+	ImageBufferPool::Buffer* ImageBufferPool::allocBuffer( size_t cls, size_t classSize )
+	{
+		Buffer* buf = NULL;
+
+#if defined( MAP_ANONYMOUS )
+		if( _hugePageThreshold && classSize >= _hugePageThreshold ) {
+			size_t len = ( classSize + HEADER_SIZE + HUGEPAGE_SIZE - 1 ) & ~( HUGEPAGE_SIZE - 1 );
+			/* over-allocate by one huge page to align the mapping */
+			void* map = mmap( NULL, len + HUGEPAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+			if( map != MAP_FAILED ) {
+				uint8_t* base = ( uint8_t* ) map;
+				uint8_t* aligned = Util::alignPtr( base, HUGEPAGE_SIZE );
+				size_t head = aligned - base;
+				if( head )
+					munmap( base, head );
+				if( HUGEPAGE_SIZE - head )
+					munmap( aligned + len, HUGEPAGE_SIZE - head );
+#if defined( MADV_HUGEPAGE )
+				madvise( aligned, len, MADV_HUGEPAGE );
+#endif
+				buf = ( Buffer* ) aligned;
+				buf->mem = aligned;
+				buf->memsize = len;
+			}
+		}
+#endif
+
+		if( !buf ) {
+			uint8_t* mem = new uint8_t[ classSize + HEADER_SIZE + 64 ];
+			buf = ( Buffer* ) Util::alignPtr( mem, 64 );
+			buf->mem = mem;
+			buf->memsize = 0;
+		}
+
+		buf->refcnt = 0;
+		buf->cls	= cls;
+		buf->size	= classSize;
+		buf->pool	= this;
+		buf->next	= NULL;
+		return buf;
+	}
+
+	void ImageBufferPool::freeBuffer( Buffer* buf )
+	{
+		if( buf->memsize )
+			munmap( buf->mem, buf->memsize );
+		else
+			delete[] buf->mem;
+	}
+
+	void ImageBufferPool::recycle( Buffer* buf )
+	{
+		size_t size = buf->size;
+		__sync_fetch_and_sub( &_bytesInUse, size );
+
+		if( buf->cls < NUM_LOCAL_CLASSES ) {
+			ThreadCache* cache = threadCache();
+			if( cache->count[ buf->cls ] < LOCAL_BUFFERS ) {
+				if( __sync_add_and_fetch( &_bytesCached, size ) <= _maxCachedBytes ) {
+					buf->next = cache->free[ buf->cls ];
+					cache->free[ buf->cls ] = buf;
+					cache->count[ buf->cls ]++;
+					return;
+				}
+				__sync_fetch_and_sub( &_bytesCached, size );
+			}
+		}
+
+		if( __sync_add_and_fetch( &_bytesCached, size ) <= _maxCachedBytes ) {
+			_mutex.lock();
+			buf->next = _free[ buf->cls ];
+			_free[ buf->cls ] = buf;
+			_mutex.unlock();
+			return;
+		}
+		__sync_fetch_and_sub( &_bytesCached, size );
+		freeBuffer( buf );
+	}
+
+	ImageBufferPool::ThreadCache* ImageBufferPool::threadCache()
+	{
+		ThreadCache* cache = ( ThreadCache* ) pthread_getspecific( _key );
+		if( !cache ) {
+			cache = new ThreadCache( this );
+			pthread_setspecific( _key, cache );
+			_mutex.lock();
+			cache->next = _caches;
+			if( _caches )
+				_caches->prev = cache;
+			_caches = cache;
+			_mutex.unlock();
+		}
+		return cache;
+	}
+
+	void ImageBufferPool::flushCache( ThreadCache* cache )
+	{
+		_mutex.lock();
+		for( size_t i = 0; i < NUM_LOCAL_CLASSES; i++ ) {
+			while( cache->free[ i ] ) {
+				Buffer* buf = cache->free[ i ];
+				cache->free[ i ] = buf->next;
+				buf->next = _free[ i ];
+				_free[ i ] = buf;
+			}
+			cache->count[ i ] = 0;
+		}
+		_mutex.unlock();
+	}
+
+	void ImageBufferPool::threadExit( void* ptr )
+	{
+		ThreadCache* cache = ( ThreadCache* ) ptr;
+		ImageBufferPool* pool = cache->pool;
+
+		/* the buffers of the exiting thread are still accounted in bytesCached */
+		pool->flushCache( cache );
+
+		pool->_mutex.lock();
+		if( cache->prev )
+			cache->prev->next = cache->next;
+		else
+			pool->_caches = cache->next;
+		if( cache->next )
+			cache->next->prev = cache->prev;
+		pool->_mutex.unlock();
+		delete cache;
+	}
+
+	void ImageBufferPool::trim()
+	{
+		ThreadCache* cache = ( ThreadCache* ) pthread_getspecific( _key );
+		if( cache )
+			flushCache( cache );
+
+		Buffer* list = NULL;
+		_mutex.lock();
+		for( size_t i = 0; i < NUM_CLASSES; i++ ) {
+			while( _free[ i ] ) {
+				Buffer* buf = _free[ i ];
+				_free[ i ] = buf->next;
+				buf->next = list;
+				list = buf;
+			}
+		}
+		_mutex.unlock();
+
+		while( list ) {
+			Buffer* buf = list;
+			list = buf->next;
+			__sync_fetch_and_sub( &_bytesCached, buf->size );
+			freeBuffer( buf );
+		}
+	}
+
+	ImageBufferPool::Stats ImageBufferPool::stats() const
+	{
+		Stats s;
+		s.hits		  = __sync_add_and_fetch( ( size_t* ) &_hits, 0 );
+		s.misses	  = __sync_add_and_fetch( ( size_t* ) &_misses, 0 );
+		s.bytesInUse  = __sync_add_and_fetch( ( size_t* ) &_bytesInUse, 0 );
+		s.peakBytes	  = __sync_add_and_fetch( ( size_t* ) &_peakBytes, 0 );
+		s.bytesCached = __sync_add_and_fetch( ( size_t* ) &_bytesCached, 0 );
+		return s;
+	}
+
+	void ImageBufferPool::resetStats()
+	{
+		__sync_lock_test_and_set( &_hits, 0 );
+		__sync_lock_test_and_set( &_misses, 0 );
+		__sync_lock_test_and_set( &_peakBytes, __sync_add_and_fetch( &_bytesInUse, 0 ) );
+	}
+
+}
@@ -0,0 +1,145 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_IMAGEBUFFERPOOL_H
+#define CVT_IMAGEBUFFERPOOL_H
+
+#include <cvt/util/Mutex.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+namespace cvt {
+
+	/**
+	 *	\class ImageBufferPool
+	 *	\brief Size-class pool recycling the memory of images.
+	 *
+	 *	Requests are rounded up to size classes with four classes per power of two,
+	 *	released buffers are kept in a small per-thread cache and a shared free list
+	 *	per class and are handed out again for the next request of the same class.
+	 *	Every buffer carries an intrusive, atomic reference count in its header.
+	 *
+	 *	Buffers of at least hugePageThreshold() bytes are mapped separately, aligned
+	 *	to and advised for transparent huge pages where the system supports it.
+	 *
+	 *	A pool has to outlive all of its buffers. ImageAllocatorMem uses a pool if
+	 *	one is set globally with ImageAllocatorMem::setDefaultPool() or for a single
+	 *	image with Image::setBufferPool().
+	 */
+	class ImageBufferPool {
+		public:
+			struct Stats {
+				size_t hits;		/* allocations served from a cache */
+				size_t misses;		/* allocations of new memory */
+				size_t bytesInUse;	/* capacity of all buffers handed out */
+				size_t peakBytes;	/* maximum of bytesInUse */
+				size_t bytesCached;	/* capacity of all cached buffers */
+			};
+
+			ImageBufferPool( size_t maxCachedBytes = ( 256 << 20 ) );
+			~ImageBufferPool();
+
+			/* buffer of at least size bytes, 64 byte aligned, with a reference count of one */
+			uint8_t*		alloc( size_t size );
+			static void		retain( uint8_t* ptr );
+			/* drops a reference, the last one returns the buffer to its pool */
+			static void		release( uint8_t* ptr );
+			static size_t	capacity( const uint8_t* ptr );
+			static size_t	refCount( const uint8_t* ptr );
+
+			/* free all buffers in the shared cache and in the cache of the calling thread */
+			void			trim();
+
+			void			setMaxCachedBytes( size_t bytes );
+			size_t			maxCachedBytes() const;
+			/* 0 disables huge pages */
+			void			setHugePageThreshold( size_t bytes );
+			size_t			hugePageThreshold() const;
+
+			Stats			stats() const;
+			void			resetStats();
+
+			/* process wide pool, never destroyed */
+			static ImageBufferPool& instance();
+
+		private:
+			ImageBufferPool( const ImageBufferPool& );
+			ImageBufferPool& operator=( const ImageBufferPool& );
+
+			struct Buffer;
+			struct ThreadCache;
+
+			static size_t	sizeClass( size_t size, size_t* classSize );
+			Buffer*			allocBuffer( size_t cls, size_t classSize );
+			void			freeBuffer( Buffer* buf );
+			void			recycle( Buffer* buf );
+			ThreadCache*	threadCache();
+			void			flushCache( ThreadCache* cache );
+			static void		threadExit( void* cache );
+
+			static const size_t MIN_CLASS_SHIFT	  = 12;
+			static const size_t NUM_CLASSES		  = 1 + 4 * ( 48 - MIN_CLASS_SHIFT );
+			/* classes up to 4 MB are cached per thread, at most LOCAL_BUFFERS each */
+			static const size_t NUM_LOCAL_CLASSES = 1 + 4 * ( 22 - MIN_CLASS_SHIFT );
+			static const size_t LOCAL_BUFFERS	  = 4;
+
+			Mutex			_mutex;
+			Buffer*			_free[ NUM_CLASSES ];
+			ThreadCache*	_caches;
+			pthread_key_t	_key;
+			size_t			_maxCachedBytes;
+			size_t			_hugePageThreshold;
+
+			size_t			_hits;
+			size_t			_misses;
+			size_t			_bytesInUse;
+			size_t			_peakBytes;
+			size_t			_bytesCached;
+	};
+
+	inline void ImageBufferPool::setMaxCachedBytes( size_t bytes )
+	{
+		_maxCachedBytes = bytes;
+	}
+
+	inline size_t ImageBufferPool::maxCachedBytes() const
+	{
+		return _maxCachedBytes;
+	}
+
+	inline void ImageBufferPool::setHugePageThreshold( size_t bytes )
+	{
+		_hugePageThreshold = bytes;
+	}
+
+	inline size_t ImageBufferPool::hugePageThreshold() const
+	{
+		return _hugePageThreshold;
+	}
+
+}
+
+#endif
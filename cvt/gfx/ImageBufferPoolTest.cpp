@@ -0,0 +1,130 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/CVTTest.h>
+#include <cvt/gfx/ImageBufferPool.h>
+#include <cvt/gfx/ImageAllocatorMem.h>
+#include <cvt/gfx/Image.h>
+#include <cvt/util/ParallelRows.h>
+
+namespace cvt {
+
+	class PoolChurn : public ParallelRows::Body {
+		public:
+			PoolChurn( ImageBufferPool& pool ) : _pool( pool ) {}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				for( size_t y = ystart; y < yend; y++ ) {
+					uint8_t* a = _pool.alloc( 1000 + y * 100 );
+					uint8_t* b = _pool.alloc( 50000 );
+					a[ 0 ] = b[ 0 ] = ( uint8_t ) y;
+					ImageBufferPool::release( b );
+					ImageBufferPool::release( a );
+				}
+			}
+
+		private:
+			ImageBufferPool& _pool;
+	};
+
+BEGIN_CVTTEST( ImageBufferPool )
+	bool ret = true;
+	bool b;
+
+	{
+		ImageBufferPool pool;
+		uint8_t* a = pool.alloc( 1 );
+		uint8_t* c = pool.alloc( 5000 );
+		b = ImageBufferPool::capacity( a ) == 4096 && ImageBufferPool::capacity( c ) == 5120;
+		b &= ( ( size_t ) a & 0x3f ) == 0 && ( ( size_t ) c & 0x3f ) == 0;
+		CVTTEST_PRINT( "Size classes", b );
+		ret &= b;
+
+		ImageBufferPool::retain( c );
+		ImageBufferPool::release( c );
+		b = pool.stats().bytesInUse == 4096 + 5120;
+		ImageBufferPool::release( c );
+		uint8_t* d = pool.alloc( 4500 );
+		ImageBufferPool::Stats s = pool.stats();
+		b &= d == c && s.hits == 1 && s.misses == 2 && s.peakBytes == 4096 + 5120;
+		CVTTEST_PRINT( "Reference count and recycling", b );
+		ret &= b;
+
+		ImageBufferPool::release( a );
+		ImageBufferPool::release( d );
+		pool.trim();
+		s = pool.stats();
+		b = s.bytesInUse == 0 && s.bytesCached == 0;
+		CVTTEST_PRINT( "Trim", b );
+		ret &= b;
+	}
+
+	{
+		ImageBufferPool pool;
+		pool.setHugePageThreshold( 2 << 20 );
+		uint8_t* huge = pool.alloc( 8 << 20 );
+		huge[ 0 ] = huge[ ( 8 << 20 ) - 1 ] = 1;
+		b = ( ( size_t ) huge & 0x3f ) == 0 && ImageBufferPool::capacity( huge ) >= ( 8 << 20 );
+		ImageBufferPool::release( huge );
+		b &= pool.alloc( 8 << 20 ) == huge;
+		ImageBufferPool::release( huge );
+		CVTTEST_PRINT( "Huge pages", b );
+		ret &= b;
+	}
+
+	{
+		ImageBufferPool pool;
+		ImageBufferPool* prev = ImageAllocatorMem::defaultPool();
+		ImageAllocatorMem::setDefaultPool( &pool );
+		for( size_t i = 0; i < 10; i++ ) {
+			Image tmp( 640, 480, IFormat::GRAY_FLOAT );
+			tmp.fill( Color::WHITE );
+		}
+		ImageAllocatorMem::setDefaultPool( prev );
+
+		Image img( 320, 240, IFormat::GRAY_UINT8 );
+		img.setBufferPool( &pool );
+		img.reallocate( 640, 480, IFormat::GRAY_FLOAT );
+
+		ImageBufferPool::Stats s = pool.stats();
+		b = s.misses == 1 && s.hits == 10;
+		CVTTEST_PRINT( "Image allocation", b );
+		ret &= b;
+	}
+
+	{
+		ImageBufferPool pool;
+		PoolChurn churn( pool );
+		ParallelRows::run( churn, 1 << 20, 256, 4 );
+		ImageBufferPool::Stats s = pool.stats();
+		b = s.bytesInUse == 0 && s.hits + s.misses == 512;
+		CVTTEST_PRINT( "Concurrent allocation", b );
+		ret &= b;
+	}
+
+	return ret;
+END_CVTTEST
+
+}
@@ -28,26 +28,82 @@
 #include <cvt/util/Exception.h>
 #include <cvt/util/ScopedBuffer.h>
 #include <cvt/gfx/IMapScoped.h>
+#include <cvt/util/ParallelRows.h>
 
 #include <iomanip>
 
 namespace cvt {
 
+	/* in-place/value row operations of the form dst = func( src, value ) */
+	template<typename T, typename VALUE>
+	class IValueOpRows : public ParallelRows::Body
+	{
+		public:
+			typedef void ( SIMD::*ValueFunc )( T*, const T*, VALUE, size_t ) const;
+
+			IValueOpRows( uint8_t* dst, size_t dstride, const uint8_t* src, size_t sstride, size_t n, VALUE value, ValueFunc func ) :
+				_simd( SIMD::instance() ), _dst( dst ), _dstride( dstride ), _src( src ), _sstride( sstride ), _n( n ), _value( value ), _func( func )
+			{
+			}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				for( size_t y = ystart; y < yend; y++ )
+					( _simd->*_func )( ( T* ) ( _dst + _dstride * y ), ( const T* ) ( _src + _sstride * y ), _value, _n );
+			}
+
+		private:
+			SIMD*		   _simd;
+			uint8_t*	   _dst;
+			size_t		   _dstride;
+			const uint8_t* _src;
+			size_t		   _sstride;
+			size_t		   _n;
+			VALUE		   _value;
+			ValueFunc	   _func;
+	};
+
+	/* binary row operations of the form dst = func( src1, src2 ) */
+	class IBinaryOpRows : public ParallelRows::Body
+	{
+		public:
+			typedef void ( SIMD::*BinaryFunc )( float*, const float*, const float*, size_t ) const;
+
+			IBinaryOpRows( uint8_t* dst, size_t dstride, const uint8_t* src1, size_t s1stride, const uint8_t* src2, size_t s2stride, size_t n, BinaryFunc func ) :
+				_simd( SIMD::instance() ), _dst( dst ), _dstride( dstride ), _src1( src1 ), _s1stride( s1stride ),
+				_src2( src2 ), _s2stride( s2stride ), _n( n ), _func( func )
+			{
+			}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				for( size_t y = ystart; y < yend; y++ )
+					( _simd->*_func )( ( float* ) ( _dst + _dstride * y ), ( const float* ) ( _src1 + _s1stride * y ),
+									   ( const float* ) ( _src2 + _s2stride * y ), _n );
+			}
+
+		private:
+			SIMD*		   _simd;
+			uint8_t*	   _dst;
+			size_t		   _dstride;
+			const uint8_t* _src1;
+			size_t		   _s1stride;
+			const uint8_t* _src2;
+			size_t		   _s2stride;
+			size_t		   _n;
+			BinaryFunc	   _func;
+	};
+
 	void Image::add( float alpha )
 	{
-		SIMD* simd = SIMD::instance();
 		switch( _mem->_format.type ) {
 			case IFORMAT_TYPE_FLOAT:
 				{
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-					while( h-- ) {
-						simd->AddValue1f( ( float* ) dst, ( float* ) dst, alpha, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, float> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, alpha, &SIMD::AddValue1f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			default:
@@ -59,20 +115,14 @@ namespace cvt {
 
 	void Image::add( const Color& c )
 	{
-		SIMD* simd = SIMD::instance();
 		switch( _mem->_format.formatID ) {
 			case IFORMAT_GRAY_FLOAT:
 				{
 					size_t stride;
 					uint8_t* dst = map( & stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->AddValue1f( ( float* ) dst, ( float* ) dst, c.gray(), _mem->_width );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, float> rows( dst, stride, dst, stride, _mem->_width, c.gray(), &SIMD::AddValue1f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			case IFORMAT_RGBA_FLOAT:
@@ -80,14 +130,9 @@ namespace cvt {
 					float v[ 4 ] = { c.red(), c.green(), c.blue(), c.alpha() };
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->AddValue4f( ( float* ) dst, ( float* ) dst, v, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, const float (&)[ 4 ]> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, v, &SIMD::AddValue4f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			case IFORMAT_BGRA_FLOAT:
@@ -95,14 +140,9 @@ namespace cvt {
 					float v[ 4 ] = { c.blue(), c.green(), c.red(), c.alpha() };
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->AddValue4f( ( float* ) dst, ( float* ) dst, v, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, const float (&)[ 4 ]> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, v, &SIMD::AddValue4f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			default:
@@ -113,19 +153,14 @@ namespace cvt {
 
 	void Image::sub( float alpha )
 	{
-		SIMD* simd = SIMD::instance();
 		switch( _mem->_format.type ) {
 			case IFORMAT_TYPE_FLOAT:
 				{
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-					while( h-- ) {
-						simd->SubValue1f( ( float* ) dst, ( float* ) dst, alpha, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, float> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, alpha, &SIMD::SubValue1f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			default:
@@ -136,20 +171,14 @@ namespace cvt {
 
 	void Image::sub( const Color& c )
 	{
-		SIMD* simd = SIMD::instance();
 		switch( _mem->_format.formatID ) {
 			case IFORMAT_GRAY_FLOAT:
 				{
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->SubValue1f( ( float* ) dst, ( float* ) dst, c.gray(), _mem->_width );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, float> rows( dst, stride, dst, stride, _mem->_width, c.gray(), &SIMD::SubValue1f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			case IFORMAT_RGBA_FLOAT:
@@ -157,14 +186,9 @@ namespace cvt {
 					float v[ 4 ] = { c.red(), c.green(), c.blue(), c.alpha() };
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->SubValue4f( ( float* ) dst, ( float* ) dst, v, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, const float (&)[ 4 ]> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, v, &SIMD::SubValue4f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			case IFORMAT_BGRA_FLOAT:
@@ -172,14 +196,9 @@ namespace cvt {
 					float v[ 4 ] = { c.blue(), c.green(), c.red(), c.alpha() };
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->SubValue4f( ( float* ) dst, ( float* ) dst, v, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, const float (&)[ 4 ]> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, v, &SIMD::SubValue4f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 
@@ -192,35 +211,23 @@ namespace cvt {
 
 	void Image::mul( float alpha )
 	{
-		SIMD* simd = SIMD::instance();
-
 		switch( _mem->_format.type ) {
 			case IFORMAT_TYPE_FLOAT:
 				{
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->MulValue1f( ( float* ) dst, ( float* ) dst, alpha, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, float> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, alpha, &SIMD::MulValue1f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			case IFORMAT_TYPE_UINT16:
 				{
 					size_t stride;
-					uint16_t* dst = map<uint16_t>( &stride );
-					uint16_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->MulValue1ui16( dst, dst, alpha, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					uint8_t* dst = map( &stride );
+					IValueOpRows<uint16_t, float> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, alpha, &SIMD::MulValue1ui16 );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			default:
@@ -231,20 +238,14 @@ namespace cvt {
 
 	void Image::mul( const Color& c )
 	{
-		SIMD* simd = SIMD::instance();
 		switch( _mem->_format.formatID ) {
 			case IFORMAT_GRAY_FLOAT:
 				{
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->MulValue1f( ( float* ) dst, ( float* ) dst, c.gray(), _mem->_width );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, float> rows( dst, stride, dst, stride, _mem->_width, c.gray(), &SIMD::MulValue1f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			case IFORMAT_RGBA_FLOAT:
@@ -252,14 +253,9 @@ namespace cvt {
 					float v[ 4 ] = { c.red(), c.green(), c.blue(), c.alpha() };
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->MulValue4f( ( float* ) dst, ( float* ) dst, v, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, const float (&)[ 4 ]> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, v, &SIMD::MulValue4f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			case IFORMAT_BGRA_FLOAT:
@@ -267,14 +263,9 @@ namespace cvt {
 					float v[ 4 ] = { c.blue(), c.green(), c.red(), c.alpha() };
 					size_t stride;
 					uint8_t* dst = map( &stride );
-					uint8_t* dbase = dst;
-					size_t h = _mem->_height;
-
-					while( h-- ) {
-						simd->MulValue4f( ( float* ) dst, ( float* ) dst, v, _mem->_width * _mem->_format.channels );
-						dst += stride;
-					}
-					unmap( dbase );
+					IValueOpRows<float, const float (&)[ 4 ]> rows( dst, stride, dst, stride, _mem->_width * _mem->_format.channels, v, &SIMD::MulValue4f );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
 				}
 				break;
 			default:
@@ -290,24 +281,17 @@ namespace cvt {
 			_mem->_format != i._mem->_format )
 			throw CVTException("Image mismatch");
 
-		SIMD* simd = SIMD::instance();
 		switch( _mem->_format.type ) {
 			case IFORMAT_TYPE_FLOAT:
 				{
 					size_t sstride, dstride;
 					const uint8_t* src = i.map( &sstride );
-					const uint8_t* sbase = src;
 					uint8_t* dst = map( &dstride );
-					uint8_t* dbase = dst;
 
-					size_t h = _mem->_height;
-					while( h-- ) {
-						simd->Add( ( float* ) dst, ( float* ) dst, ( float* ) src, _mem->_width * _mem->_format.channels );
-						src += sstride;
-						dst += dstride;
-					}
-					unmap( dbase );
-					i.unmap( sbase );
+					IBinaryOpRows rows( dst, dstride, dst, dstride, src, sstride, _mem->_width * _mem->_format.channels, &SIMD::Add );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
+					i.unmap( src );
 				}
 				break;
 			default:
@@ -323,24 +307,17 @@ namespace cvt {
 			_mem->_format != i._mem->_format )
 			throw CVTException("Image mismatch");
 
-		SIMD* simd = SIMD::instance();
 		switch( _mem->_format.type ) {
 			case IFORMAT_TYPE_FLOAT:
 				{
 					size_t sstride, dstride;
 					const uint8_t* src = i.map( &sstride );
-					const uint8_t* sbase = src;
 					uint8_t* dst = map( &dstride );
-					uint8_t* dbase = dst;
 
-					size_t h = _mem->_height;
-					while( h-- ) {
-						simd->Sub( ( float* ) dst, ( float* ) dst, ( float* ) src, _mem->_width * _mem->_format.channels );
-						src += sstride;
-						dst += dstride;
-					}
-					unmap( dbase );
-					i.unmap( sbase );
+					IBinaryOpRows rows( dst, dstride, dst, dstride, src, sstride, _mem->_width * _mem->_format.channels, &SIMD::Sub );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
+					i.unmap( src );
 				}
 				break;
 			default:
@@ -356,24 +333,17 @@ namespace cvt {
 			_mem->_format != i._mem->_format )
 			throw CVTException("Image mismatch");
 
-		SIMD* simd = SIMD::instance();
 		switch( _mem->_format.type ) {
 			case IFORMAT_TYPE_FLOAT:
 				{
 					size_t sstride, dstride;
 					const uint8_t* src = i.map( &sstride );
-					const uint8_t* sbase = src;
 					uint8_t* dst = map( &dstride );
-					uint8_t* dbase = dst;
 
-					size_t h = _mem->_height;
-					while( h-- ) {
-						simd->Mul(( float* ) dst, ( float* ) dst, ( float* ) src, _mem->_width * _mem->_format.channels );
-						src += sstride;
-						dst += dstride;
-					}
-					unmap( dbase);
-					i.unmap( sbase );
+					IBinaryOpRows rows( dst, dstride, dst, dstride, src, sstride, _mem->_width * _mem->_format.channels, &SIMD::Mul );
+					ParallelRows::run( rows, _mem->_width, _mem->_height );
+					unmap( dst );
+					i.unmap( src );
 				}
 				break;
 			default:
@@ -389,19 +359,15 @@ namespace cvt {
 			_mem->_format != i._mem->_format )
 			throw CVTException("Image mismatch");
 
-		SIMD* simd = SIMD::instance();
 		switch( _mem->_format.type ) {
 			case IFORMAT_TYPE_FLOAT:
 				{
 					IMapScoped<const float> srcmap( i );
 					IMapScoped<float> dstmap( *this );
 
-					size_t h = height();
-					while( h-- ) {
-						simd->MulAddValue1f( dstmap.ptr(), srcmap.ptr(), alpha, width() * _mem->_format.channels );
-						srcmap++;
-						dstmap++;
-					}
+					IValueOpRows<float, float> rows( ( uint8_t* ) dstmap.base(), dstmap.stride(), ( const uint8_t* ) srcmap.base(), srcmap.stride(),
+													 width() * _mem->_format.channels, alpha, &SIMD::MulAddValue1f );
+					ParallelRows::run( rows, width(), height() );
 				}
 				break;
 			default:
@@ -27,6 +27,14 @@
 #include <cvt/io/Resources.h>
 #include <cvt/util/SIMD.h>
 #include <cvt/util/Time.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/ThreadPool.h>
+#include <cvt/gfx/IMapScoped.h>
+#include <cvt/gfx/IKernel.h>
+#include <cvt/gfx/IExpr.h>
+
+#include <math.h>
+#include <stdlib.h>
 
 namespace cvt {
 
@@ -151,6 +159,332 @@ namespace cvt {
 		return true;
 	END_CVTTEST
 
+	static bool _image_parallel_compare( const Image& a, const Image& b )
+	{
+		return a.ssd( b ) / ( float ) ( a.width() * a.height() ) < 1e-8f;
+	}
+
+	BEGIN_CVTTEST( ImageParallel )
+		bool b, result = true;
+		Image img( 640, 480, IFormat::GRAY_FLOAT );
+		/* convolve does not allocate the destination */
+		Image st( 640, 480, IFormat::GRAY_FLOAT ), mt( 640, 480, IFormat::GRAY_FLOAT );
+
+		{
+			IMapScoped<float> map( img );
+			for( size_t y = 0; y < img.height(); y++ ) {
+				float* ptr = map.ptr();
+				for( size_t x = 0; x < img.width(); x++ )
+					ptr[ x ] = Math::rand( 0.0f, 1.0f );
+				map++;
+			}
+		}
+
+		{
+			ParallelRows::ScopedNumThreads single( 1 );
+			img.convolve( st, IKernel::GAUSS_HORIZONTAL_5, IKernel::GAUSS_VERTICAL_5 );
+		}
+		img.convolve( mt, IKernel::GAUSS_HORIZONTAL_5, IKernel::GAUSS_VERTICAL_5 );
+		b = _image_parallel_compare( st, mt );
+		CVTTEST_PRINT( "Separable convolution", b );
+		result &= b;
+
+		{
+			ParallelRows::ScopedNumThreads single( 1 );
+			img.boxfilter( st, 3, 4 );
+		}
+		img.boxfilter( mt, 3, 4 );
+		b = _image_parallel_compare( st, mt );
+		CVTTEST_PRINT( "Boxfilter", b );
+		result &= b;
+
+		{
+			ParallelRows::ScopedNumThreads single( 1 );
+			img.erode( st, 2 );
+		}
+		img.erode( mt, 2 );
+		b = _image_parallel_compare( st, mt );
+		CVTTEST_PRINT( "Erode", b );
+		result &= b;
+
+		/* in place the bands must not read rows a neighbouring band already wrote */
+		size_t poolThreads = ThreadPool::instance().numThreads();
+		ThreadPool::instance().setNumThreads( 4 );
+		{
+			ParallelRows::ScopedNumThreads nt( 4 );
+			img.convolve( st, IKernel::GAUSS_HORIZONTAL_5, IKernel::GAUSS_VERTICAL_5 );
+			mt = img;
+			mt.convolve( mt, IKernel::GAUSS_HORIZONTAL_5, IKernel::GAUSS_VERTICAL_5 );
+			b = _image_parallel_compare( st, mt );
+
+			img.boxfilter( st, 3, 4 );
+			mt = img;
+			mt.boxfilter( mt, 3, 4 );
+			b &= _image_parallel_compare( st, mt );
+
+			img.erode( st, 2 );
+			mt = img;
+			mt.erode( mt, 2 );
+			b &= _image_parallel_compare( st, mt );
+		}
+		ThreadPool::instance().setNumThreads( poolThreads );
+		CVTTEST_PRINT( "In place", b );
+		result &= b;
+
+		st = img;
+		mt = img;
+		{
+			ParallelRows::ScopedNumThreads single( 1 );
+			st.mul( 0.5f );
+			st.add( img );
+		}
+		mt.mul( 0.5f );
+		mt.add( img );
+		b = _image_parallel_compare( st, mt );
+		CVTTEST_PRINT( "Arithmetic", b );
+		result &= b;
+
+		return result;
+	END_CVTTEST
+
+	static void _image_expr_random( Image& img )
+	{
+		IMapScoped<float> map( img );
+		size_t n = img.width() * img.format().channels;
+		for( size_t y = 0; y < img.height(); y++ ) {
+			float* ptr = map.ptr();
+			for( size_t x = 0; x < n; x++ )
+				ptr[ x ] = Math::rand( -1.0f, 1.0f );
+			map++;
+		}
+	}
+
+	static bool _image_expr_compare( const Image& img, const Image& a, const Image& b, const Image& c, float (*func)( float, float, float ), float eps )
+	{
+		IMapScoped<const float> mimg( img );
+		IMapScoped<const float> ma( a );
+		IMapScoped<const float> mb( b );
+		IMapScoped<const float> mc( c );
+		size_t n = img.width() * img.format().channels;
+		for( size_t y = 0; y < img.height(); y++ ) {
+			for( size_t x = 0; x < n; x++ ) {
+				if( Math::abs( mimg.ptr()[ x ] - func( ma.ptr()[ x ], mb.ptr()[ x ], mc.ptr()[ x ] ) ) > eps )
+					return false;
+			}
+			mimg++; ma++; mb++; mc++;
+		}
+		return true;
+	}
+
+	static float _image_expr_mad( float a, float b, float c ) { return a * b + c; }
+	static float _image_expr_scalars( float a, float b, float ) { return ( 1.0f - a ) / 2.0f - 3.0f / ( Math::abs( b ) + 1.0f ); }
+	static float _image_expr_minmax( float a, float b, float c ) { return Math::max( Math::min( a, b ), c * 0.5f ); }
+	static float _image_expr_clamp( float a, float b, float ) { return Math::clamp( Math::sqrt( Math::abs( a ) ) - b, -0.25f, 0.25f ); }
+	static float _image_expr_u8( float a, float b, float ) { return a * 2.0f - b; }
+	static float _image_expr_select( float a, float b, float c ) { return a - b > 0.0f ? c : -c; }
+
+	BEGIN_CVTTEST( ImageExpr )
+		bool b, result = true;
+		Image a( 333, 201, IFormat::RGBA_FLOAT );
+		Image x( 333, 201, IFormat::RGBA_FLOAT );
+		Image y( 333, 201, IFormat::RGBA_FLOAT );
+		Image d( 333, 201, IFormat::RGBA_FLOAT );
+
+		_image_expr_random( a );
+		_image_expr_random( x );
+		_image_expr_random( y );
+
+		d = a * x + y;
+		b = _image_expr_compare( d, a, x, y, _image_expr_mad, 1e-6f );
+		CVTTEST_PRINT( "a * b + c", b );
+		result &= b;
+
+		d = ( 1.0f - a ) / 2.0f - 3.0f / ( iexpr::abs( x ) + 1.0f );
+		b = _image_expr_compare( d, a, x, y, _image_expr_scalars, 1e-5f );
+		CVTTEST_PRINT( "Scalars on both sides", b );
+		result &= b;
+
+		d = iexpr::max( iexpr::min( a, x ), y * 0.5f );
+		b = _image_expr_compare( d, a, x, y, _image_expr_minmax, 0.0f );
+		CVTTEST_PRINT( "min/max", b );
+		result &= b;
+
+		d = iexpr::clamp( iexpr::sqrt( iexpr::abs( a ) ) - x, -0.25f, 0.25f );
+		b = _image_expr_compare( d, a, x, y, _image_expr_clamp, 1e-6f );
+		CVTTEST_PRINT( "clamp/sqrt/abs", b );
+		result &= b;
+
+		d = iexpr::select( a - x, y, -y );
+		b = _image_expr_compare( d, a, x, y, _image_expr_select, 0.0f );
+		CVTTEST_PRINT( "select", b );
+		result &= b;
+
+		/* the expression functions must not hide the standard ones inside cvt */
+		b = sqrt( 4.0 ) == 2.0 && abs( -3 ) == 3;
+		CVTTEST_PRINT( "Standard functions visible", b );
+		result &= b;
+
+		{
+			Image st( d );
+			{
+				ParallelRows::ScopedNumThreads single( 1 );
+				st = iexpr::select( a, iexpr::sqrt( iexpr::abs( x ) ), y / 3.0f );
+			}
+			d = iexpr::select( a, iexpr::sqrt( iexpr::abs( x ) ), y / 3.0f );
+			b = _image_parallel_compare( st, d );
+			CVTTEST_PRINT( "Single threaded", b );
+			result &= b;
+		}
+
+		/* aliasing: the destination is also an operand */
+		d = a;
+		d = d * x + y;
+		b = _image_expr_compare( d, a, x, y, _image_expr_mad, 1e-6f );
+		CVTTEST_PRINT( "Destination as operand", b );
+		result &= b;
+
+		/* u8 input and saturating u8 output */
+		{
+			Image u8( 333, 201, IFormat::RGBA_UINT8 );
+			Image u8f, ref, res( 333, 201, IFormat::RGBA_UINT8 );
+			a.convert( u8 );
+			u8.convert( u8f, IFormat::RGBA_FLOAT );
+
+			d = u8 * 2.0f - x;
+			b = _image_expr_compare( d, u8f, x, y, _image_expr_u8, 1e-6f );
+			CVTTEST_PRINT( "UINT8 input", b );
+			result &= b;
+
+			res = u8 * 4.0f - 1.0f;
+			d = u8f * 4.0f - 1.0f;
+			d.convert( ref, IFormat::RGBA_UINT8 );
+			b = true;
+			{
+				IMapScoped<const uint8_t> mres( res );
+				IMapScoped<const uint8_t> mref( ref );
+				for( size_t yy = 0; yy < res.height(); yy++ ) {
+					b &= memcmp( mres.ptr(), mref.ptr(), res.width() * 4 ) == 0;
+					mres++;
+					mref++;
+				}
+			}
+			CVTTEST_PRINT( "UINT8 saturated output", b );
+			result &= b;
+		}
+
+		b = false;
+		try {
+			Image small( 10, 10, IFormat::RGBA_FLOAT );
+			d = a + small;
+		} catch( const Exception& ) {
+			b = true;
+		}
+		CVTTEST_PRINT( "Size mismatch", b );
+		result &= b;
+
+		return result;
+	END_CVTTEST
+
+	class ImageShareConsumer : public ParallelRows::Body {
+		public:
+			ImageShareConsumer( const Image& frame, float* sums ) : _frame( frame ), _sums( sums ) {}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				for( size_t i = ystart; i < yend; i++ ) {
+					Image local;
+					local.share( _frame );
+					IMapScoped<const float> map( local );
+					_sums[ i ] = map.ptr()[ i ];
+				}
+			}
+
+		private:
+			const Image& _frame;
+			float*		 _sums;
+	};
+
+	BEGIN_CVTTEST( ImageShare )
+		bool b, result = true;
+		Image img( 64, 64, IFormat::GRAY_FLOAT );
+		img.fill( Color( 0.5f ) );
+
+		Image shared;
+		shared.share( img );
+		{
+			size_t s1, s2;
+			const Image& cimg = img;
+			const Image& cshared = shared;
+			const uint8_t* p1 = cimg.map( &s1 );
+			const uint8_t* p2 = cshared.map( &s2 );
+			b = p1 == p2 && s1 == s2;
+			cimg.unmap( p1 );
+			cshared.unmap( p2 );
+		}
+		CVTTEST_PRINT( "Share without copy", b );
+		result &= b;
+
+		shared.fill( Color( 1.0f ) );
+		{
+			IMapScoped<const float> m1( img );
+			IMapScoped<const float> m2( shared );
+			b = m1( 10, 10 ) == 0.5f && m2( 10, 10 ) == 1.0f;
+		}
+		CVTTEST_PRINT( "Copy on write", b );
+		result &= b;
+
+		Recti roi( 8, 16, 20, 10 );
+		Image view( img, &roi, true );
+		{
+			IMapScoped<const float> m( view );
+			b = view.width() == 20 && view.height() == 10 && m( 0, 0 ) == 0.5f;
+		}
+		view.fill( Color( 0.25f ) );
+		{
+			IMapScoped<const float> m1( img );
+			IMapScoped<const float> m2( view );
+			b &= m1( 8, 16 ) == 0.5f && m2( 0, 0 ) == 0.25f;
+		}
+		CVTTEST_PRINT( "Shared region", b );
+		result &= b;
+
+		{
+			const float data[ 4 ] = { 1.0f, 2.0f, 3.0f, 4.0f };
+			Image ro( 2, 2, IFormat::GRAY_FLOAT, ( const uint8_t* ) data );
+			Image roshared;
+			roshared.share( ro );
+			ro.fill( Color( 0.0f ) );
+			roshared.fill( Color( 5.0f ) );
+			IMapScoped<const float> m1( ro );
+			IMapScoped<const float> m2( roshared );
+			b = data[ 3 ] == 4.0f && m1( 1, 1 ) == 0.0f && m2( 1, 1 ) == 5.0f;
+		}
+		CVTTEST_PRINT( "Copy read-only data on write", b );
+		result &= b;
+
+		{
+			Image frame( 256, 256, IFormat::GRAY_FLOAT );
+			{
+				IMapScoped<float> m( frame );
+				for( size_t y = 0; y < 256; y++ ) {
+					for( size_t x = 0; x < 256; x++ )
+						m.ptr()[ x ] = ( float ) x;
+					m++;
+				}
+			}
+			std::vector<float> sums( 256, 0.0f );
+			ImageShareConsumer consumer( frame, &sums[ 0 ] );
+			ParallelRows::run( consumer, 1 << 20, 256 );
+			b = true;
+			for( size_t i = 0; i < 256; i++ )
+				b &= sums[ i ] == ( float ) i;
+		}
+		CVTTEST_PRINT( "Shared between threads", b );
+		result &= b;
+
+		return result;
+	END_CVTTEST
+
 	BEGIN_CVTTEST( ImageSpeed )
 		/* Image conversion */
 
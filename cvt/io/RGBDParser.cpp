@@ -23,14 +23,41 @@
 */
 
 #include <cvt/io/RGBDParser.h>
+#include <cvt/util/Thread.h>
+#include <cvt/util/PluginManager.h>
 
 namespace cvt
 {
+    struct RGBDParser::Slot
+    {
+        enum State {
+            EMPTY,
+            QUEUED,
+            LOADING,
+            READY
+        };
+
+        Slot() : state( EMPTY ), idx( 0 ) {}
+
+        RGBDParser::RGBDSample	sample;
+        State					state;
+        size_t					idx;
+        String					error;
+    };
+
+    class RGBDParser::DecodeThread : public Thread<RGBDParser>
+    {
+        public:
+            void execute( RGBDParser* parser ) { parser->decodeLoop(); }
+    };
 
     RGBDParser::RGBDParser( const String& folder, double maxStampDiff ) :
         _maxStampDiff( maxStampDiff ), // this is 50ms
         _folder( folder ),
-        _idx( 0 )
+        _idx( 0 ),
+        _stop( false ),
+        _rgbLoader( 0 ),
+        _depthLoader( 0 )
     {
         if( _folder[ _folder.length() - 1 ] != '/' )
             _folder += "/";
@@ -71,19 +98,167 @@ namespace cvt
         std::cout << "Stamps: " << _stamps.size() << std::endl;
     }
 
+    RGBDParser::~RGBDParser()
+    {
+        stopPrefetch();
+    }
+
+    void RGBDParser::setPrefetch( size_t numFrames, size_t numThreads )
+    {
+        stopPrefetch();
+        if( !numFrames || !_stamps.size() )
+            return;
+
+        // resolve the loaders here: the plugin manager is not thread-safe
+        _rgbLoader   = PluginManager::instance().getILoaderForFilename( _rgbFiles[ 0 ] );
+        _depthLoader = PluginManager::instance().getILoaderForFilename( _depthFiles[ 0 ] );
+
+        _stop = false;
+        for( size_t i = 0; i < numFrames; i++ )
+            _slots.push_back( new Slot() );
+
+        numThreads = Math::clamp<size_t>( numThreads, 1, numFrames );
+        for( size_t i = 0; i < numThreads; i++ ){
+            _threads.push_back( new DecodeThread() );
+            _threads.back()->run( this );
+        }
+    }
+
+    void RGBDParser::stopPrefetch()
+    {
+        _mutex.lock();
+        _stop = true;
+        _workCond.notifyAll();
+        _mutex.unlock();
+
+        for( size_t i = 0; i < _threads.size(); i++ ){
+            _threads[ i ]->join();
+            delete _threads[ i ];
+        }
+        _threads.clear();
+
+        for( size_t i = 0; i < _slots.size(); i++ )
+            delete _slots[ i ];
+        _slots.clear();
+    }
+
+    void RGBDParser::loadSample( RGBDSample& sample, size_t idx ) const
+    {
+        sample.stamp	   = _stamps[ idx ];
+        sample.rgb.load( _rgbFiles[ idx ], _rgbLoader );
+        sample.depth.load( _depthFiles[ idx ], _depthLoader );
+        sample.orientation = _orientations[ idx ];
+        sample.position    = _positions[ idx ];
+        sample.poseValid   = _poseValid[ idx ];
+    }
+
+    void RGBDParser::request( size_t idx )
+    {
+        // called with _mutex locked
+        Slot* slot = _slots[ idx % _slots.size() ];
+        if( slot->idx == idx && slot->state != Slot::EMPTY )
+            return;
+
+        // a slot still being decoded is re-queued by its decoder
+        slot->idx = idx;
+        if( slot->state != Slot::LOADING ){
+            slot->state = Slot::QUEUED;
+            _workCond.notify();
+        }
+    }
+
+    void RGBDParser::decodeLoop()
+    {
+        ScopeLock lock( &_mutex );
+        while( true ){
+            // decode the queued frame that is needed first
+            Slot* slot = 0;
+            while( !_stop ){
+                for( size_t i = 0; i < _slots.size(); i++ ){
+                    if( _slots[ i ]->state == Slot::QUEUED && ( !slot || _slots[ i ]->idx < slot->idx ) )
+                        slot = _slots[ i ];
+                }
+                if( slot )
+                    break;
+                _workCond.wait( _mutex );
+            }
+            if( _stop )
+                return;
+
+            size_t idx = slot->idx;
+            slot->state = Slot::LOADING;
+            slot->error = "";
+            _mutex.unlock();
+
+            String error;
+            try {
+                loadSample( slot->sample, idx );
+            } catch( const Exception& e ){
+                error = e.what();
+            }
+
+            _mutex.lock();
+            if( slot->idx != idx ){
+                // setIdx moved on while decoding
+                slot->state = Slot::QUEUED;
+            } else {
+                slot->error = error;
+                slot->state = Slot::READY;
+                _readyCond.notifyAll();
+            }
+        }
+    }
+
+    void RGBDParser::setIdx( size_t idx )
+    {
+        ScopeLock lock( &_mutex );
+        _idx = idx;
+
+        // drop queued frames outside of the new read-ahead window
+        for( size_t i = 0; i < _slots.size(); i++ ){
+            Slot* slot = _slots[ i ];
+            if( slot->state == Slot::QUEUED && ( slot->idx < _idx || slot->idx >= _idx + _slots.size() ) )
+                slot->state = Slot::EMPTY;
+        }
+    }
+
     void RGBDParser::next()
     {
         if( _idx >= _stamps.size() ){
             std::cout << "End of data !" << std::endl;
             return;
         }
-        _sample.stamp	= _stamps[ _idx ];
-        _sample.rgb.load( _rgbFiles[ _idx ] );
-        _sample.depth.load( _depthFiles[ _idx ] );
-        _sample.orientation = _orientations[ _idx ];
-        _sample.position = _positions[ _idx ];
-        _sample.poseValid = _poseValid[ _idx ];
+
+        if( !_slots.size() ){
+            loadSample( _sample, _idx );
+            _idx++;
+            return;
+        }
+
+        ScopeLock lock( &_mutex );
+        size_t end = Math::min( _idx + _slots.size(), _stamps.size() );
+        for( size_t i = _idx; i < end; i++ )
+            request( i );
+
+        Slot* slot = _slots[ _idx % _slots.size() ];
+        while( slot->state != Slot::READY || slot->idx != _idx )
+            _readyCond.wait( _mutex );
+
+        // hand out the decoded images, the previous buffers are reused for the next frame
+        slot->state = Slot::EMPTY;
+        if( !slot->error.isEmpty() )
+            throw CVTException( slot->error.c_str() );
+
+        _sample.rgb.swap( slot->sample.rgb );
+        _sample.depth.swap( slot->sample.depth );
+        _sample.stamp		= slot->sample.stamp;
+        _sample.orientation = slot->sample.orientation;
+        _sample.position	= slot->sample.position;
+        _sample.poseValid	= slot->sample.poseValid;
         _idx++;
+
+        if( end < _stamps.size() )
+            request( end );
     }
 
     void RGBDParser::loadGroundTruth()
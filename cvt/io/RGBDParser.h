@@ -32,6 +32,8 @@
 #include <cvt/io/RGBDInput.h>
 #include <cvt/gfx/Image.h>
 #include <cvt/math/Matrix.h>
+#include <cvt/util/Mutex.h>
+#include <cvt/util/Condition.h>
 
 namespace cvt
 {
@@ -64,6 +66,15 @@ namespace cvt
             };
 
             RGBDParser( const String& folder, double maxStampDiff = 0.05 );
+            ~RGBDParser();
+
+            /**
+             * @brief decode the upcoming frames in the background
+             * @param numFrames		number of frames decoded ahead of next(), 0 disables the read-ahead
+             * @param numThreads	number of decoding threads
+             */
+            void setPrefetch( size_t numFrames, size_t numThreads = 2 );
+            size_t prefetch() const { return _slots.size(); }
 
             void next();
 
@@ -78,7 +89,7 @@ namespace cvt
 			double				stamp() const { return _sample.stamp; }
 
 			const RGBDSample&	data()  const { return _sample; }
-            void                setIdx( size_t idx ) { _idx = idx; }
+            void                setIdx( size_t idx );
             const String&       rgbFile( size_t idx ) const { return _rgbFiles[ idx ]; }
             const String&       depthFile( size_t idx ) const { return _depthFiles[ idx ]; }
 
@@ -96,6 +107,25 @@ namespace cvt
             RGBDSample				_sample;
             size_t					_idx;
 
+            /* read-ahead: frame idx is decoded into slot idx % _slots.size() */
+            struct Slot;
+            class DecodeThread;
+            friend class DecodeThread;
+
+            std::vector<Slot*>			_slots;
+            std::vector<DecodeThread*>	_threads;
+            Mutex						_mutex;
+            Condition					_workCond;
+            Condition					_readyCond;
+            bool						_stop;
+            ILoader*					_rgbLoader;
+            ILoader*					_depthLoader;
+
+            void stopPrefetch();
+            void request( size_t idx );
+            void decodeLoop();
+            void loadSample( RGBDSample& sample, size_t idx ) const;
+
 
             void loadGroundTruth();
             void loadRGBFilenames( std::vector<double> & stamps );
@@ -0,0 +1,315 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/io/RawStreamCodec.h>
+#include <cvt/gfx/IMapScoped.h>
+#include <cvt/util/Exception.h>
+#include <cvt/math/Math.h>
+
+#include <string.h>
+
+namespace cvt
+{
+	static const size_t LZ_MINMATCH		 = 4;
+	static const size_t LZ_LASTLITERALS	 = 5;
+	static const size_t LZ_MFLIMIT		 = 12;
+	static const size_t LZ_MAXOFFSET	 = 65535;
+	static const size_t LZ_HASHLOG		 = 14;
+
+	static inline uint32_t lzRead32( const uint8_t* p )
+	{
+		uint32_t v;
+		memcpy( &v, p, sizeof( v ) );
+		return v;
+	}
+
+	static inline uint32_t lzHash( uint32_t v )
+	{
+		return ( v * 2654435761U ) >> ( 32 - LZ_HASHLOG );
+	}
+
+	static inline uint8_t* lzWriteLength( uint8_t* op, size_t len )
+	{
+		while( len >= 255 ){
+			*op++ = 255;
+			len -= 255;
+		}
+		*op++ = ( uint8_t )len;
+		return op;
+	}
+
+	static inline size_t lzReadLength( const uint8_t*& ip, const uint8_t* iend )
+	{
+		size_t len = 0;
+		uint8_t b;
+		do {
+			if( ip >= iend )
+				throw CVTException( "Corrupt LZ stream" );
+			b = *ip++;
+			len += b;
+		} while( b == 255 );
+		return len;
+	}
+
+	static inline uint8_t* lzWriteSequence( uint8_t* op, const uint8_t* literals, size_t litLen, size_t matchLen )
+	{
+		uint8_t* token = op++;
+		*token = ( uint8_t )( Math::min<size_t>( litLen, 15 ) << 4 );
+		if( litLen >= 15 )
+			op = lzWriteLength( op, litLen - 15 );
+		memcpy( op, literals, litLen );
+		op += litLen;
+		if( matchLen != ( size_t )-1 )
+			*token |= ( uint8_t )Math::min<size_t>( matchLen, 15 );
+		return op;
+	}
+
+	size_t RawStreamCodec::lzCompress( uint8_t* dst, const uint8_t* src, size_t n )
+	{
+		uint8_t* op = dst;
+		const uint8_t* ip = src;
+		const uint8_t* anchor = src;
+		const uint8_t* end = src + n;
+
+		if( n > LZ_MFLIMIT ){
+			const uint8_t* mflimit	  = end - LZ_MFLIMIT;
+			const uint8_t* matchlimit = end - LZ_LASTLITERALS;
+			std::vector<uint32_t> table( 1 << LZ_HASHLOG, 0 );
+			size_t misses = 0;
+
+			while( ip < mflimit ){
+				uint32_t seq = lzRead32( ip );
+				uint32_t h = lzHash( seq );
+				const uint8_t* ref = src + table[ h ];
+				table[ h ] = ( uint32_t )( ip - src );
+
+				if( ref >= ip || ( size_t )( ip - ref ) > LZ_MAXOFFSET || lzRead32( ref ) != seq ){
+					// step faster through incompressible data
+					ip += 1 + ( misses++ >> 6 );
+					continue;
+				}
+				misses = 0;
+
+				const uint8_t* mp = ip + LZ_MINMATCH;
+				const uint8_t* rp = ref + LZ_MINMATCH;
+				while( mp < matchlimit && *mp == *rp ){
+					mp++;
+					rp++;
+				}
+
+				size_t matchLen = mp - ip - LZ_MINMATCH;
+				size_t offset = ip - ref;
+				op = lzWriteSequence( op, anchor, ip - anchor, matchLen );
+				*op++ = ( uint8_t )( offset & 0xff );
+				*op++ = ( uint8_t )( offset >> 8 );
+				if( matchLen >= 15 )
+					op = lzWriteLength( op, matchLen - 15 );
+
+				ip = anchor = mp;
+			}
+		}
+
+		// the last sequence only has literals
+		op = lzWriteSequence( op, anchor, end - anchor, ( size_t )-1 );
+		return op - dst;
+	}
+
+	void RawStreamCodec::lzDecompress( uint8_t* dst, size_t dstSize, const uint8_t* src, size_t n )
+	{
+		const uint8_t* ip = src;
+		const uint8_t* iend = src + n;
+		uint8_t* op = dst;
+		uint8_t* oend = dst + dstSize;
+
+		while( ip < iend ){
+			uint8_t token = *ip++;
+
+			size_t litLen = token >> 4;
+			if( litLen == 15 )
+				litLen += lzReadLength( ip, iend );
+			if( litLen > ( size_t )( iend - ip ) || litLen > ( size_t )( oend - op ) )
+				throw CVTException( "Corrupt LZ stream" );
+			memcpy( op, ip, litLen );
+			op += litLen;
+			ip += litLen;
+
+			if( ip == iend )
+				break;
+
+			if( iend - ip < 2 )
+				throw CVTException( "Corrupt LZ stream" );
+			size_t offset = ip[ 0 ] | ( ip[ 1 ] << 8 );
+			ip += 2;
+
+			size_t matchLen = token & 0xf;
+			if( matchLen == 15 )
+				matchLen += lzReadLength( ip, iend );
+			matchLen += LZ_MINMATCH;
+
+			if( offset == 0 || offset > ( size_t )( op - dst ) || matchLen > ( size_t )( oend - op ) )
+				throw CVTException( "Corrupt LZ stream" );
+
+			const uint8_t* ref = op - offset;
+			if( offset >= matchLen ){
+				memcpy( op, ref, matchLen );
+				op += matchLen;
+			} else {
+				// overlapping match repeats the last offset bytes
+				while( matchLen-- )
+					*op++ = *ref++;
+			}
+		}
+
+		if( op != oend )
+			throw CVTException( "Corrupt LZ stream" );
+	}
+
+	bool RawStreamCodec::isSupported( RawStreamCodecType codec, const IFormat& format )
+	{
+		switch( codec ){
+			case RAWSTREAM_CODEC_NONE:
+			case RAWSTREAM_CODEC_LZ:
+				return true;
+			case RAWSTREAM_CODEC_DELTA16:
+				return format.channels == 1 && format.bpc == 2;
+			default:
+				return false;
+		}
+	}
+
+	void RawStreamCodec::packRows( uint8_t* dst, const Image& img )
+	{
+		IMapScoped<const uint8_t> map( img );
+		size_t rowBytes = img.width() * img.bpp();
+		size_t h = img.height();
+		while( h-- ){
+			memcpy( dst, map.ptr(), rowBytes );
+			dst += rowBytes;
+			map++;
+		}
+	}
+
+	void RawStreamCodec::unpackRows( Image& img, const uint8_t* src )
+	{
+		IMapScoped<uint8_t> map( img );
+		size_t rowBytes = img.width() * img.bpp();
+		size_t h = img.height();
+		while( h-- ){
+			memcpy( map.ptr(), src, rowBytes );
+			src += rowBytes;
+			map++;
+		}
+	}
+
+	void RawStreamCodec::deltaEncode16( uint8_t* dst, const Image& img )
+	{
+		IMapScoped<const uint16_t> map( img );
+		size_t w = img.width();
+		size_t h = img.height();
+		uint8_t* lo = dst;
+		uint8_t* hi = dst + w * h;
+		const uint16_t* prev = NULL;
+
+		// predict from the left neighbour, the first pixel of a row from the one above
+		for( size_t y = 0; y < h; y++ ){
+			const uint16_t* row = map.ptr();
+			uint16_t pred = prev ? prev[ 0 ] : 0;
+			for( size_t x = 0; x < w; x++ ){
+				int16_t d = ( int16_t )( row[ x ] - pred );
+				uint16_t zz = ( uint16_t )( ( d << 1 ) ^ ( d >> 15 ) );
+				*lo++ = ( uint8_t )zz;
+				*hi++ = ( uint8_t )( zz >> 8 );
+				pred = row[ x ];
+			}
+			prev = row;
+			map++;
+		}
+	}
+
+	void RawStreamCodec::deltaDecode16( Image& img, const uint8_t* src )
+	{
+		IMapScoped<uint16_t> map( img );
+		size_t w = img.width();
+		size_t h = img.height();
+		const uint8_t* lo = src;
+		const uint8_t* hi = src + w * h;
+		const uint16_t* prev = NULL;
+
+		for( size_t y = 0; y < h; y++ ){
+			uint16_t* row = map.ptr();
+			uint16_t pred = prev ? prev[ 0 ] : 0;
+			for( size_t x = 0; x < w; x++ ){
+				uint16_t zz = ( uint16_t )( *lo++ | ( *hi++ << 8 ) );
+				uint16_t d = ( uint16_t )( ( zz >> 1 ) ^ ( -( zz & 1 ) ) );
+				row[ x ] = ( uint16_t )( pred + d );
+				pred = row[ x ];
+			}
+			prev = row;
+			map++;
+		}
+	}
+
+	void RawStreamCodec::encode( std::vector<uint8_t>& dst, std::vector<uint8_t>& tmp, const Image& img, RawStreamCodecType codec )
+	{
+		if( !isSupported( codec, img.format() ) )
+			throw CVTException( "Codec not supported for image format" );
+
+		size_t size = img.width() * img.height() * img.bpp();
+		if( codec == RAWSTREAM_CODEC_NONE ){
+			dst.resize( size );
+			packRows( &dst[ 0 ], img );
+			return;
+		}
+
+		tmp.resize( size );
+		if( codec == RAWSTREAM_CODEC_LZ )
+			packRows( &tmp[ 0 ], img );
+		else
+			deltaEncode16( &tmp[ 0 ], img );
+
+		dst.resize( lzBound( size ) );
+		dst.resize( lzCompress( &dst[ 0 ], &tmp[ 0 ], size ) );
+	}
+
+	void RawStreamCodec::decode( Image& dst, std::vector<uint8_t>& tmp, const uint8_t* src, size_t n, RawStreamCodecType codec )
+	{
+		if( !isSupported( codec, dst.format() ) )
+			throw CVTException( "Codec not supported for image format" );
+
+		size_t size = dst.width() * dst.height() * dst.bpp();
+		if( codec == RAWSTREAM_CODEC_NONE ){
+			if( n != size )
+				throw CVTException( "Frame size does not match the image" );
+			unpackRows( dst, src );
+			return;
+		}
+
+		tmp.resize( size );
+		lzDecompress( &tmp[ 0 ], size, src, n );
+		if( codec == RAWSTREAM_CODEC_LZ )
+			unpackRows( dst, &tmp[ 0 ] );
+		else
+			deltaDecode16( dst, &tmp[ 0 ] );
+	}
+}
@@ -0,0 +1,84 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_RAWSTREAMCODEC_H
+#define CVT_RAWSTREAMCODEC_H
+
+#include <cvt/gfx/Image.h>
+
+#include <vector>
+#include <stdint.h>
+
+namespace cvt
+{
+	enum RawStreamCodecType {
+		RAWSTREAM_CODEC_NONE	= 0,	/* packed rows */
+		RAWSTREAM_CODEC_LZ		= 1,	/* byte oriented LZ77, LZ4 style token stream */
+		RAWSTREAM_CODEC_DELTA16 = 2		/* 1 channel 16 bit images (depth): left/up delta, zigzag, byte planes, LZ */
+	};
+
+	/**
+	 *	\brief	lossless per frame compression for the RawStream container
+	 *
+	 *	All codecs store the image rows packed without stride padding.
+	 */
+	class RawStreamCodec
+	{
+		public:
+			/* check if codec can be used for images of the given format */
+			static bool		isSupported( RawStreamCodecType codec, const IFormat& format );
+
+			/**
+			 *	\brief	encode img into dst, dst is resized to the encoded size
+			 *	\param	tmp		scratch buffer, keep it around to avoid reallocations
+			 */
+			static void		encode( std::vector<uint8_t>& dst, std::vector<uint8_t>& tmp, const Image& img, RawStreamCodecType codec );
+
+			/**
+			 *	\brief	decode n bytes from src into dst
+			 *	\param	tmp		scratch buffer, keep it around to avoid reallocations
+			 *
+			 *	dst has to be allocated with the size and format of the encoded image.
+			 *	Throws on corrupt input.
+			 */
+			static void		decode( Image& dst, std::vector<uint8_t>& tmp, const uint8_t* src, size_t n, RawStreamCodecType codec );
+
+			/* upper bound of the LZ compressed size of n bytes */
+			static size_t	lzBound( size_t n ) { return n + n / 255 + 16; }
+
+			/* compress n bytes from src to dst, dst has to hold lzBound( n ) bytes, returns the compressed size */
+			static size_t	lzCompress( uint8_t* dst, const uint8_t* src, size_t n );
+
+			/* decompress n bytes from src to exactly dstSize bytes in dst */
+			static void		lzDecompress( uint8_t* dst, size_t dstSize, const uint8_t* src, size_t n );
+
+		private:
+			static void		packRows( uint8_t* dst, const Image& img );
+			static void		unpackRows( Image& img, const uint8_t* src );
+			static void		deltaEncode16( uint8_t* dst, const Image& img );
+			static void		deltaDecode16( Image& img, const uint8_t* src );
+	};
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/CVTTest.h>
+#include <cvt/io/RawStreamCodec.h>
+#include <cvt/gfx/IMapScoped.h>
+
+#include <stdlib.h>
+
+namespace cvt {
+
+	static bool imagesEqual( const Image& a, const Image& b )
+	{
+		IMapScoped<const uint8_t> ma( a );
+		IMapScoped<const uint8_t> mb( b );
+		size_t rowBytes = a.width() * a.bpp();
+		for( size_t y = 0; y < a.height(); y++ ){
+			if( memcmp( ma.ptr(), mb.ptr(), rowBytes ) )
+				return false;
+			ma++;
+			mb++;
+		}
+		return true;
+	}
+
+	static bool roundtrip( const Image& img, RawStreamCodecType codec, size_t* encodedSize = NULL )
+	{
+		std::vector<uint8_t> buffer, tmp;
+		RawStreamCodec::encode( buffer, tmp, img, codec );
+		if( encodedSize )
+			*encodedSize = buffer.size();
+
+		Image result( img.width(), img.height(), img.format() );
+		RawStreamCodec::decode( result, tmp, buffer.size() ? &buffer[ 0 ] : NULL, buffer.size(), codec );
+		return imagesEqual( img, result );
+	}
+
+BEGIN_CVTTEST( RawStreamCodec )
+	bool ret = true;
+	bool b;
+
+	srand( 42 );
+
+	// smooth depth image with invalid ( zero ) regions
+	Image depth( 320, 240, IFormat::GRAY_UINT16 );
+	{
+		IMapScoped<uint16_t> map( depth );
+		for( size_t y = 0; y < depth.height(); y++ ){
+			uint16_t* row = map.ptr();
+			for( size_t x = 0; x < depth.width(); x++ )
+				row[ x ] = ( x > 300 && y < 20 ) ? 0 : ( uint16_t )( 1000 + 3 * x + y + ( rand() & 0x3 ) );
+			map++;
+		}
+	}
+
+	// noise does not compress, the LZ output has to stay within the bound
+	Image noise( 123, 77, IFormat::RGBA_UINT8 );
+	{
+		IMapScoped<uint8_t> map( noise );
+		for( size_t y = 0; y < noise.height(); y++ ){
+			uint8_t* row = map.ptr();
+			for( size_t x = 0; x < noise.width() * 4; x++ )
+				row[ x ] = rand() & 0xff;
+			map++;
+		}
+	}
+
+	size_t rawSize = depth.width() * depth.height() * depth.bpp();
+	size_t lzSize, deltaSize, noiseSize;
+
+	b = roundtrip( depth, RAWSTREAM_CODEC_NONE );
+	CVTTEST_PRINT( "NONE roundtrip", b );
+	ret &= b;
+
+	b = roundtrip( depth, RAWSTREAM_CODEC_LZ, &lzSize );
+	CVTTEST_PRINT( "LZ roundtrip", b );
+	ret &= b;
+
+	b = roundtrip( depth, RAWSTREAM_CODEC_DELTA16, &deltaSize );
+	b &= deltaSize < lzSize && deltaSize < rawSize / 2;
+	CVTTEST_PRINT( "DELTA16 roundtrip and ratio", b );
+	ret &= b;
+
+	b = roundtrip( noise, RAWSTREAM_CODEC_LZ, &noiseSize );
+	b &= noiseSize <= RawStreamCodec::lzBound( noise.width() * noise.height() * 4 );
+	CVTTEST_PRINT( "LZ incompressible data", b );
+	ret &= b;
+
+	b = !RawStreamCodec::isSupported( RAWSTREAM_CODEC_DELTA16, IFormat::RGBA_UINT8 );
+	CVTTEST_PRINT( "DELTA16 format check", b );
+	ret &= b;
+
+	// truncated input has to be rejected
+	{
+		std::vector<uint8_t> buffer, tmp;
+		RawStreamCodec::encode( buffer, tmp, depth, RAWSTREAM_CODEC_LZ );
+		Image result( depth.width(), depth.height(), depth.format() );
+		b = false;
+		try {
+			RawStreamCodec::decode( result, tmp, &buffer[ 0 ], buffer.size() / 2, RAWSTREAM_CODEC_LZ );
+		} catch( const Exception& ){
+			b = true;
+		}
+		CVTTEST_PRINT( "LZ corrupt input", b );
+		ret &= b;
+	}
+
+	return ret;
+END_CVTTEST
+
+}
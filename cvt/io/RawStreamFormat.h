@@ -0,0 +1,79 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_RAWSTREAMFORMAT_H
+#define CVT_RAWSTREAMFORMAT_H
+
+#include <stdint.h>
+
+namespace cvt
+{
+	/* on-disk structures of the RawStream container shared by RawStreamWriter and RawStreamReader */
+
+	static const char		RAWSTREAM_MAGIC[ 8 ]	= { 'C', 'V', 'T', 'R', 'A', 'W', 'S', 0 };
+	static const uint32_t	RAWSTREAM_VERSION		= 1;
+	static const uint32_t	RAWSTREAM_CHUNKTAG		= 0x454d5246; /* "FRME" */
+	static const uint32_t	RAWSTREAM_RESERVEDTAG	= 0x44565352; /* "RSVD": chunk whose data is not completely written */
+
+	struct RawStreamFileHeader {
+		char		magic[ 8 ];
+		uint32_t	version;
+		uint32_t	numStreams;
+		uint64_t	indexOffset;	/* 0 if the file was not closed */
+		uint64_t	numEntries;
+	};
+
+	struct RawStreamStreamHeader {
+		uint32_t	width;
+		uint32_t	height;
+		uint32_t	formatID;
+		uint32_t	codec;
+	};
+
+	struct RawStreamChunkHeader {
+		uint32_t	tag;
+		uint32_t	stream;
+		uint32_t	frame;
+		uint32_t	size;
+		double		stamp;
+	};
+
+	struct RawStreamIndexEntry {
+		uint64_t	offset;			/* offset of the encoded data, behind the chunk header */
+		uint32_t	size;
+		uint32_t	stream;
+		uint32_t	frame;
+		uint32_t	reserved;
+		double		stamp;
+
+		bool operator<( const RawStreamIndexEntry& other ) const
+		{
+			if( stream != other.stream )
+				return stream < other.stream;
+			return frame < other.frame;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,389 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/io/RawStreamReader.h>
+#include <cvt/util/Thread.h>
+#include <cvt/util/Exception.h>
+#include <cvt/math/Math.h>
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace cvt
+{
+	struct RawStreamReader::Slot
+	{
+		enum State {
+			EMPTY,
+			QUEUED,
+			LOADING,
+			READY
+		};
+
+		Slot() : state( EMPTY ), idx( 0 ) {}
+
+		std::vector<Image>	frames;
+		State				state;
+		size_t				idx;
+		String				error;
+	};
+
+	class RawStreamReader::DecodeThread : public Thread<RawStreamReader>
+	{
+		public:
+			void execute( RawStreamReader* reader ) { reader->decodeLoop(); }
+	};
+
+	RawStreamReader::RawStreamReader( const String& filename ) :
+		_fd( -1 ),
+		_data( 0 ),
+		_size( 0 ),
+		_stamp( 0.0 ),
+		_pos( 0 ),
+		_stop( false )
+	{
+		_fd = open( filename.c_str(), O_RDONLY, 0 );
+		if( _fd < 0 ){
+			String msg( "Could not open file: " );
+			msg += strerror( errno );
+			throw CVTException( msg.c_str() );
+		}
+
+		struct stat fileInfo;
+		if( fstat( _fd, &fileInfo ) == -1 ){
+			String msg( "fstat error: " );
+			msg += strerror( errno );
+			::close( _fd );
+			throw CVTException( msg.c_str() );
+		}
+		_size = fileInfo.st_size;
+
+		if( _size < sizeof( RawStreamFileHeader ) ){
+			::close( _fd );
+			throw CVTException( "Not a RawStream file" );
+		}
+
+		void* map = mmap( 0, _size, PROT_READ, MAP_SHARED, _fd, 0 );
+		if( map == MAP_FAILED ){
+			String msg( "Could not map file: " );
+			msg += strerror( errno );
+			::close( _fd );
+			throw CVTException( msg.c_str() );
+		}
+		_data = ( uint8_t* )map;
+
+		try {
+			RawStreamFileHeader header;
+			memcpy( &header, _data, sizeof( header ) );
+			if( memcmp( header.magic, RAWSTREAM_MAGIC, sizeof( header.magic ) ) )
+				throw CVTException( "Not a RawStream file" );
+			if( header.version != RAWSTREAM_VERSION )
+				throw CVTException( "Unsupported RawStream version" );
+
+			size_t offset = sizeof( header );
+			if( header.numStreams > ( _size - offset ) / sizeof( RawStreamStreamHeader ) )
+				throw CVTException( "Corrupt RawStream header" );
+			_streams.resize( header.numStreams );
+			if( header.numStreams )
+				memcpy( &_streams[ 0 ], _data + offset, header.numStreams * sizeof( RawStreamStreamHeader ) );
+			offset += header.numStreams * sizeof( RawStreamStreamHeader );
+
+			for( size_t i = 0; i < _streams.size(); i++ ){
+				if( !RawStreamCodec::isSupported( codec( i ), format( i ) ) )
+					throw CVTException( "Unsupported codec in RawStream file" );
+			}
+
+			_index.resize( _streams.size() );
+			if( header.indexOffset )
+				readIndex( header.indexOffset, header.numEntries );
+			else
+				scanChunks( offset );
+
+			_frames.resize( _streams.size() );
+		} catch( const Exception& ){
+			munmap( _data, _size );
+			::close( _fd );
+			throw;
+		}
+	}
+
+	RawStreamReader::~RawStreamReader()
+	{
+		stopPrefetch();
+		munmap( _data, _size );
+		::close( _fd );
+	}
+
+	void RawStreamReader::readIndex( uint64_t offset, uint64_t numEntries )
+	{
+		if( offset > _size || numEntries > ( _size - offset ) / sizeof( RawStreamIndexEntry ) )
+			throw CVTException( "Corrupt RawStream index" );
+
+		const uint8_t* ptr = _data + offset;
+		for( uint64_t i = 0; i < numEntries; i++ ){
+			RawStreamIndexEntry entry;
+			memcpy( &entry, ptr, sizeof( entry ) );
+			ptr += sizeof( entry );
+			addEntry( entry );
+		}
+	}
+
+	void RawStreamReader::scanChunks( size_t offset )
+	{
+		// unfinished file: walk the chunks, a truncated chunk ends the scan
+		while( _size - offset >= sizeof( RawStreamChunkHeader ) ){
+			RawStreamChunkHeader chunk;
+			memcpy( &chunk, _data + offset, sizeof( chunk ) );
+			offset += sizeof( chunk );
+			if( ( chunk.tag != RAWSTREAM_CHUNKTAG && chunk.tag != RAWSTREAM_RESERVEDTAG ) || chunk.size > _size - offset )
+				break;
+
+			// the data of a reserved chunk was not completely written, later chunks may be
+			if( chunk.tag == RAWSTREAM_RESERVEDTAG ){
+				offset += chunk.size;
+				continue;
+			}
+
+			RawStreamIndexEntry entry;
+			entry.offset   = offset;
+			entry.size	   = chunk.size;
+			entry.stream   = chunk.stream;
+			entry.frame	   = chunk.frame;
+			entry.reserved = 0;
+			entry.stamp	   = chunk.stamp;
+			addEntry( entry );
+			offset += chunk.size;
+		}
+
+		// the chunks are not ordered, frames that were never written leave gaps
+		for( size_t i = 0; i < _index.size(); i++ )
+			std::sort( _index[ i ].begin(), _index[ i ].end() );
+	}
+
+	void RawStreamReader::addEntry( const RawStreamIndexEntry& entry )
+	{
+		if( entry.stream >= _streams.size() || entry.offset > _size || entry.size > _size - entry.offset )
+			throw CVTException( "Corrupt RawStream index" );
+		_index[ entry.stream ].push_back( entry );
+	}
+
+	size_t RawStreamReader::findFrame( size_t stream, double stamp ) const
+	{
+		const std::vector<RawStreamIndexEntry>& index = _index[ stream ];
+		if( !index.size() )
+			throw CVTException( "Stream is empty" );
+
+		// stamps are increasing with the frame number
+		size_t lo = 0, hi = index.size();
+		while( lo < hi ){
+			size_t mid = ( lo + hi ) >> 1;
+			if( index[ mid ].stamp < stamp )
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		if( lo == index.size() )
+			return lo - 1;
+		if( lo > 0 && stamp - index[ lo - 1 ].stamp <= index[ lo ].stamp - stamp )
+			return lo - 1;
+		return lo;
+	}
+
+	void RawStreamReader::readFrame( Image& img, size_t stream, size_t idx ) const
+	{
+		if( stream >= _streams.size() || idx >= _index[ stream ].size() )
+			throw CVTException( "Frame index out of bounds" );
+
+		const RawStreamStreamHeader& s = _streams[ stream ];
+		const IFormat& fmt = format( stream );
+		if( img.width() != s.width || img.height() != s.height || img.format() != fmt )
+			img.reallocate( s.width, s.height, fmt );
+
+		const RawStreamIndexEntry& entry = _index[ stream ][ idx ];
+		std::vector<uint8_t> tmp;
+		RawStreamCodec::decode( img, tmp, _data + entry.offset, entry.size, codec( stream ) );
+	}
+
+	void RawStreamReader::loadFrames( std::vector<Image>& frames, size_t idx ) const
+	{
+		frames.resize( _streams.size() );
+		readFrame( frames[ 0 ], 0, idx );
+
+		double stamp = _index[ 0 ][ idx ].stamp;
+		for( size_t s = 1; s < _streams.size(); s++ ){
+			if( _index[ s ].size() )
+				readFrame( frames[ s ], s, findFrame( s, stamp ) );
+		}
+	}
+
+	void RawStreamReader::setPrefetch( size_t numFrames, size_t numThreads )
+	{
+		stopPrefetch();
+		if( !numFrames )
+			return;
+
+		_stop = false;
+		for( size_t i = 0; i < numFrames; i++ )
+			_slots.push_back( new Slot() );
+
+		numThreads = Math::clamp<size_t>( numThreads, 1, numFrames );
+		for( size_t i = 0; i < numThreads; i++ ){
+			_threads.push_back( new DecodeThread() );
+			_threads.back()->run( this );
+		}
+	}
+
+	void RawStreamReader::stopPrefetch()
+	{
+		_mutex.lock();
+		_stop = true;
+		_workCond.notifyAll();
+		_mutex.unlock();
+
+		for( size_t i = 0; i < _threads.size(); i++ ){
+			_threads[ i ]->join();
+			delete _threads[ i ];
+		}
+		_threads.clear();
+
+		for( size_t i = 0; i < _slots.size(); i++ )
+			delete _slots[ i ];
+		_slots.clear();
+	}
+
+	void RawStreamReader::request( size_t idx )
+	{
+		// called with _mutex locked
+		Slot* slot = _slots[ idx % _slots.size() ];
+		if( slot->idx == idx && slot->state != Slot::EMPTY )
+			return;
+
+		// a slot still being decoded is re-queued by its decoder
+		slot->idx = idx;
+		if( slot->state != Slot::LOADING ){
+			slot->state = Slot::QUEUED;
+			_workCond.notify();
+		}
+	}
+
+	void RawStreamReader::decodeLoop()
+	{
+		ScopeLock lock( &_mutex );
+		while( true ){
+			// decode the queued frame that is needed first
+			Slot* slot = 0;
+			while( !_stop ){
+				for( size_t i = 0; i < _slots.size(); i++ ){
+					if( _slots[ i ]->state == Slot::QUEUED && ( !slot || _slots[ i ]->idx < slot->idx ) )
+						slot = _slots[ i ];
+				}
+				if( slot )
+					break;
+				_workCond.wait( _mutex );
+			}
+			if( _stop )
+				return;
+
+			size_t idx = slot->idx;
+			slot->state = Slot::LOADING;
+			slot->error = "";
+			_mutex.unlock();
+
+			String error;
+			try {
+				loadFrames( slot->frames, idx );
+			} catch( const Exception& e ){
+				error = e.what();
+			}
+
+			_mutex.lock();
+			if( slot->idx != idx ){
+				// seek moved on while decoding
+				slot->state = Slot::QUEUED;
+			} else {
+				slot->error = error;
+				slot->state = Slot::READY;
+				_readyCond.notifyAll();
+			}
+		}
+	}
+
+	void RawStreamReader::seek( size_t idx )
+	{
+		if( idx > numFrames() )
+			throw CVTException( "Frame index out of bounds" );
+
+		ScopeLock lock( &_mutex );
+		_pos = idx;
+
+		// drop queued frames outside of the new read-ahead window
+		for( size_t i = 0; i < _slots.size(); i++ ){
+			Slot* slot = _slots[ i ];
+			if( slot->state == Slot::QUEUED && ( slot->idx < _pos || slot->idx >= _pos + _slots.size() ) )
+				slot->state = Slot::EMPTY;
+		}
+	}
+
+	void RawStreamReader::nextFrame()
+	{
+		size_t n = numFrames();
+		if( _pos >= n )
+			throw CVTException( "End of stream" );
+
+		if( !_slots.size() ){
+			loadFrames( _frames, _pos );
+			_stamp = _index[ 0 ][ _pos ].stamp;
+			_pos++;
+			return;
+		}
+
+		ScopeLock lock( &_mutex );
+		size_t end = Math::min( _pos + _slots.size(), n );
+		for( size_t i = _pos; i < end; i++ )
+			request( i );
+
+		Slot* slot = _slots[ _pos % _slots.size() ];
+		while( slot->state != Slot::READY || slot->idx != _pos )
+			_readyCond.wait( _mutex );
+
+		// hand out the decoded images, the previous buffers are reused for the next frame
+		slot->state = Slot::EMPTY;
+		if( !slot->error.isEmpty() )
+			throw CVTException( slot->error.c_str() );
+
+		for( size_t s = 0; s < _frames.size(); s++ )
+			_frames[ s ].swap( slot->frames[ s ] );
+		_stamp = _index[ 0 ][ _pos ].stamp;
+		_pos++;
+
+		if( end < n )
+			request( end );
+	}
+}
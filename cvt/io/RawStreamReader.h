@@ -0,0 +1,122 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_RAWSTREAMREADER_H
+#define CVT_RAWSTREAMREADER_H
+
+#include <cvt/io/RawStreamCodec.h>
+#include <cvt/io/RawStreamFormat.h>
+#include <cvt/util/String.h>
+#include <cvt/util/Mutex.h>
+#include <cvt/util/Condition.h>
+#include <cvt/gfx/Image.h>
+
+#include <vector>
+
+namespace cvt
+{
+	/**
+	 *	\brief	random access to the streams of a RawStream file written by RawStreamWriter
+	 *
+	 *	Frames are located through the index, seeking is O(1). Files that were not
+	 *	closed properly are indexed by scanning the chunk headers.
+	 *
+	 *	For synchronized playback stream 0 is the master stream: nextFrame() advances
+	 *	to its next frame and selects the frames of all other streams with the closest
+	 *	timestamp.
+	 */
+	class RawStreamReader
+	{
+		public:
+			RawStreamReader( const String& filename );
+			~RawStreamReader();
+
+			size_t			numStreams() const { return _streams.size(); }
+			size_t			width( size_t stream ) const { return _streams[ stream ].width; }
+			size_t			height( size_t stream ) const { return _streams[ stream ].height; }
+			const IFormat&	format( size_t stream ) const { return IFormat::formatForId( ( IFormatID )_streams[ stream ].formatID ); }
+			RawStreamCodecType codec( size_t stream ) const { return ( RawStreamCodecType )_streams[ stream ].codec; }
+
+			size_t			numFrames( size_t stream ) const { return _index[ stream ].size(); }
+			double			stamp( size_t stream, size_t idx ) const { return _index[ stream ][ idx ].stamp; }
+
+			/* index of the frame of stream with the timestamp closest to stamp */
+			size_t			findFrame( size_t stream, double stamp ) const;
+
+			/* decode frame idx of stream into img, safe to call from multiple threads */
+			void			readFrame( Image& img, size_t stream, size_t idx ) const;
+
+			/**
+			 * @brief decode the upcoming frames of all streams in the background
+			 * @param numFrames		number of frames decoded ahead of nextFrame(), 0 disables the read-ahead
+			 * @param numThreads	number of decoding threads
+			 */
+			void			setPrefetch( size_t numFrames, size_t numThreads = 2 );
+			size_t			prefetch() const { return _slots.size(); }
+
+			/* synchronized playback */
+			size_t			numFrames() const { return _streams.size() ? _index[ 0 ].size() : 0; }
+			size_t			position() const { return _pos; }
+			bool			hasNext() const { return _pos < numFrames(); }
+			void			seek( size_t idx );
+			void			nextFrame();
+			const Image&	frame( size_t stream ) const { return _frames[ stream ]; }
+			double			stamp() const { return _stamp; }
+
+		private:
+			int									_fd;
+			uint8_t*							_data;
+			size_t								_size;
+
+			std::vector<RawStreamStreamHeader>	_streams;
+			std::vector< std::vector<RawStreamIndexEntry> >	_index;
+
+			std::vector<Image>					_frames;
+			double								_stamp;
+			size_t								_pos;
+
+			/* read-ahead: master frame idx is decoded into slot idx % _slots.size() */
+			struct Slot;
+			class DecodeThread;
+			friend class DecodeThread;
+
+			std::vector<Slot*>					_slots;
+			std::vector<DecodeThread*>			_threads;
+			Mutex								_mutex;
+			Condition							_workCond;
+			Condition							_readyCond;
+			bool								_stop;
+
+			void	readIndex( uint64_t offset, uint64_t numEntries );
+			void	scanChunks( size_t offset );
+			void	addEntry( const RawStreamIndexEntry& entry );
+
+			void	loadFrames( std::vector<Image>& frames, size_t idx ) const;
+			void	stopPrefetch();
+			void	request( size_t idx );
+			void	decodeLoop();
+	};
+}
+
+#endif
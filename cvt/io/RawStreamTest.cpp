@@ -0,0 +1,250 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/CVTTest.h>
+#include <cvt/io/RawStreamWriter.h>
+#include <cvt/io/RawStreamReader.h>
+#include <cvt/gfx/IMapScoped.h>
+#include <cvt/math/Math.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace cvt {
+
+	/* stream 0: RGBA color at 30 Hz, stream 1: 16 bit depth at 20 Hz */
+	static const size_t _rsNumFrames[ 2 ] = { 20, 14 };
+	static const double _rsPeriod[ 2 ] = { 1.0 / 30.0, 1.0 / 20.0 };
+
+	static void _rsFrame( Image& img, size_t stream, size_t frame )
+	{
+		if( stream == 0 ){
+			img.reallocate( 64, 48, IFormat::RGBA_UINT8 );
+			IMapScoped<uint8_t> map( img );
+			for( size_t y = 0; y < img.height(); y++ ){
+				uint8_t* row = map.ptr();
+				for( size_t x = 0; x < img.width() * 4; x++ )
+					row[ x ] = ( uint8_t )( 3 * x + y + 11 * frame );
+				map++;
+			}
+		} else {
+			img.reallocate( 32, 24, IFormat::GRAY_UINT16 );
+			IMapScoped<uint16_t> map( img );
+			for( size_t y = 0; y < img.height(); y++ ){
+				uint16_t* row = map.ptr();
+				for( size_t x = 0; x < img.width(); x++ )
+					row[ x ] = ( uint16_t )( 1000 + x + 3 * y + 7 * frame );
+				map++;
+			}
+		}
+	}
+
+	static bool _rsCheck( const Image& img, size_t stream, size_t frame )
+	{
+		Image ref;
+		_rsFrame( ref, stream, frame );
+		if( img.width() != ref.width() || img.height() != ref.height() || img.format() != ref.format() )
+			return false;
+
+		IMapScoped<const uint8_t> a( img );
+		IMapScoped<const uint8_t> b( ref );
+		for( size_t y = 0; y < ref.height(); y++ ){
+			if( memcmp( a.ptr(), b.ptr(), ref.width() * ref.bpp() ) )
+				return false;
+			a++;
+			b++;
+		}
+		return true;
+	}
+
+	/* frame of stream 1 closest to master frame idx, the earlier one on ties */
+	static size_t _rsSyncFrame( size_t idx )
+	{
+		double stamp = idx * _rsPeriod[ 0 ];
+		size_t best = 0;
+		for( size_t i = 1; i < _rsNumFrames[ 1 ]; i++ ){
+			if( Math::abs( i * _rsPeriod[ 1 ] - stamp ) < Math::abs( best * _rsPeriod[ 1 ] - stamp ) )
+				best = i;
+		}
+		return best;
+	}
+
+	static bool _rsPlayback( RawStreamReader& reader, size_t start )
+	{
+		bool b = true;
+		reader.seek( start );
+		for( size_t i = start; i < _rsNumFrames[ 0 ]; i++ ){
+			b &= reader.hasNext() && reader.position() == i;
+			reader.nextFrame();
+			b &= reader.stamp() == i * _rsPeriod[ 0 ];
+			b &= _rsCheck( reader.frame( 0 ), 0, i );
+			b &= _rsCheck( reader.frame( 1 ), 1, _rsSyncFrame( i ) );
+		}
+		return b && !reader.hasNext();
+	}
+
+	static void _rsWrite( const char* path )
+	{
+		RawStreamWriter writer( path, 3 );
+		writer.addStream( 64, 48, IFormat::RGBA_UINT8, RAWSTREAM_CODEC_LZ );
+		writer.addStream( 32, 24, IFormat::GRAY_UINT16, RAWSTREAM_CODEC_DELTA16 );
+
+		/* interleaved in time, the encoders finish out of order */
+		size_t next[ 2 ] = { 0, 0 };
+		Image img;
+		while( next[ 0 ] < _rsNumFrames[ 0 ] || next[ 1 ] < _rsNumFrames[ 1 ] ){
+			size_t s = ( next[ 1 ] >= _rsNumFrames[ 1 ] ||
+						 ( next[ 0 ] < _rsNumFrames[ 0 ] && next[ 0 ] * _rsPeriod[ 0 ] <= next[ 1 ] * _rsPeriod[ 1 ] ) ) ? 0 : 1;
+			_rsFrame( img, s, next[ s ] );
+			writer.write( s, img, next[ s ] * _rsPeriod[ s ] );
+			next[ s ]++;
+		}
+		writer.close();
+	}
+
+	static bool _rsReadFile( std::vector<uint8_t>& data, const char* path )
+	{
+		FILE* f = fopen( path, "rb" );
+		if( !f )
+			return false;
+		fseek( f, 0, SEEK_END );
+		data.resize( ftell( f ) );
+		fseek( f, 0, SEEK_SET );
+		size_t n = fread( &data[ 0 ], 1, data.size(), f );
+		fclose( f );
+		return n == data.size();
+	}
+
+	static bool _rsWriteFile( const std::vector<uint8_t>& data, const char* path )
+	{
+		FILE* f = fopen( path, "wb" );
+		if( !f )
+			return false;
+		size_t n = fwrite( &data[ 0 ], 1, data.size(), f );
+		fclose( f );
+		return n == data.size();
+	}
+
+BEGIN_CVTTEST( RawStream )
+	bool ret = true;
+	bool b;
+
+	char path[] = "/tmp/cvt_rawstreamXXXXXX";
+	int fd = mkstemp( path );
+	close( fd );
+	_rsWrite( path );
+
+	/* random access through the index */
+	{
+		RawStreamReader reader( path );
+		b = reader.numStreams() == 2 && reader.numFrames() == _rsNumFrames[ 0 ];
+		b &= reader.width( 0 ) == 64 && reader.height( 1 ) == 24 && reader.format( 1 ) == IFormat::GRAY_UINT16;
+		b &= reader.codec( 0 ) == RAWSTREAM_CODEC_LZ && reader.codec( 1 ) == RAWSTREAM_CODEC_DELTA16;
+		Image img;
+		for( size_t s = 0; s < 2; s++ ){
+			b &= reader.numFrames( s ) == _rsNumFrames[ s ];
+			/* backwards, every access is a seek */
+			for( size_t i = reader.numFrames( s ); i-- > 0; ){
+				reader.readFrame( img, s, i );
+				b &= _rsCheck( img, s, i ) && reader.stamp( s, i ) == i * _rsPeriod[ s ];
+			}
+		}
+		CVTTEST_PRINT( "RawStream write/read roundtrip", b );
+		ret &= b;
+
+		b = _rsPlayback( reader, 0 );
+		b &= _rsPlayback( reader, 13 );
+		CVTTEST_PRINT( "RawStream synchronized playback and seek", b );
+		ret &= b;
+
+		reader.setPrefetch( 4, 2 );
+		b = reader.prefetch() == 4;
+		b &= _rsPlayback( reader, 0 );
+		b &= _rsPlayback( reader, 15 );
+		b &= _rsPlayback( reader, 2 );
+		/* seek while the read-ahead is in flight */
+		reader.seek( 5 );
+		reader.nextFrame();
+		reader.seek( 11 );
+		reader.nextFrame();
+		b &= _rsCheck( reader.frame( 0 ), 0, 11 ) && _rsCheck( reader.frame( 1 ), 1, _rsSyncFrame( 11 ) );
+		reader.setPrefetch( 0 );
+		b &= reader.prefetch() == 0;
+		b &= _rsPlayback( reader, 7 );
+		CVTTEST_PRINT( "RawStream prefetch", b );
+		ret &= b;
+	}
+
+	/* a file that was not closed: no index, an interrupted chunk in the middle and a truncated last chunk */
+	{
+		std::vector<uint8_t> data;
+		b = _rsReadFile( data, path );
+
+		RawStreamFileHeader header;
+		memcpy( &header, &data[ 0 ], sizeof( header ) );
+		data.resize( header.indexOffset - 10 );
+		header.indexOffset = 0;
+		header.numEntries = 0;
+		memcpy( &data[ 0 ], &header, sizeof( header ) );
+
+		/* the chunks are in the order the encoders finished */
+		size_t offset = sizeof( RawStreamFileHeader ) + 2 * sizeof( RawStreamStreamHeader );
+		RawStreamChunkHeader chunk = RawStreamChunkHeader(), reserved = chunk, last = chunk;
+		for( size_t i = 0; offset + sizeof( chunk ) <= data.size(); i++ ){
+			memcpy( &chunk, &data[ offset ], sizeof( chunk ) );
+			if( i == 5 ){
+				reserved = chunk;
+				chunk.tag = RAWSTREAM_RESERVEDTAG;
+				memcpy( &data[ offset ], &chunk, sizeof( chunk ) );
+			}
+			last = chunk;
+			offset += sizeof( chunk ) + chunk.size;
+		}
+		b &= _rsWriteFile( data, path );
+
+		RawStreamReader reader( path );
+		Image img;
+		for( size_t s = 0; s < 2; s++ ){
+			size_t missing = ( reserved.stream == s ) + ( last.stream == s );
+			b &= reader.numFrames( s ) == _rsNumFrames[ s ] - missing;
+
+			size_t frame = 0;
+			for( size_t i = 0; i < reader.numFrames( s ); i++, frame++ ){
+				while( ( reserved.stream == s && reserved.frame == frame ) || ( last.stream == s && last.frame == frame ) )
+					frame++;
+				reader.readFrame( img, s, i );
+				b &= _rsCheck( img, s, frame ) && reader.stamp( s, i ) == frame * _rsPeriod[ s ];
+			}
+		}
+		CVTTEST_PRINT( "RawStream recovery without index", b );
+		ret &= b;
+	}
+
+	unlink( path );
+	return ret;
+END_CVTTEST
+
+}
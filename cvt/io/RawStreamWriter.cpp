@@ -0,0 +1,316 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/io/RawStreamWriter.h>
+#include <cvt/util/Thread.h>
+#include <cvt/util/Exception.h>
+
+#include <algorithm>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace cvt
+{
+	class RawStreamWriter::EncodeThread : public Thread<RawStreamWriter>
+	{
+		public:
+			void execute( RawStreamWriter* writer ) { writer->encodeLoop(); }
+	};
+
+	RawStreamWriter::RawStreamWriter( const String& filename, size_t numThreads ) :
+		_fd( -1 ),
+		_fileSize( 0 ),
+		_started( false ),
+		_maxQueue( 2 * numThreads ),
+		_busy( 0 ),
+		_stop( false )
+	{
+		_fd = open( filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRWXU | S_IRWXG );
+		if( _fd < 0 ){
+			String msg( "Could not open file: " );
+			msg += strerror( errno );
+			throw CVTException( msg.c_str() );
+		}
+
+		for( size_t i = 0; i < numThreads; i++ )
+			_threads.push_back( new EncodeThread() );
+	}
+
+	RawStreamWriter::~RawStreamWriter()
+	{
+		try {
+			close();
+		} catch( const Exception& e ){
+			std::cerr << "RawStreamWriter: " << e.what() << std::endl;
+		}
+
+		for( size_t i = 0; i < _pool.size(); i++ )
+			delete _pool[ i ];
+	}
+
+	size_t RawStreamWriter::addStream( size_t width, size_t height, const IFormat& format, RawStreamCodecType codec )
+	{
+		if( _started )
+			throw CVTException( "Streams have to be added before the first frame is written" );
+		if( !RawStreamCodec::isSupported( codec, format ) )
+			throw CVTException( "Codec not supported for image format" );
+
+		Stream s;
+		s.width		= width;
+		s.height	= height;
+		s.formatID	= format.formatID;
+		s.codec		= codec;
+		s.numFrames = 0;
+		_streams.push_back( s );
+		return _streams.size() - 1;
+	}
+
+	void RawStreamWriter::write( size_t stream, const Image& img, double stamp )
+	{
+		if( _fd < 0 )
+			throw CVTException( "Stream file already closed" );
+		if( stream >= _streams.size() )
+			throw CVTException( "Invalid stream id" );
+
+		Stream& s = _streams[ stream ];
+		if( img.width() != s.width || img.height() != s.height || ( uint32_t )img.format().formatID != s.formatID )
+			throw CVTException( "Image size or format does not match the stream" );
+
+		if( !_started ){
+			_started = true;
+			_fileSize = sizeof( RawStreamFileHeader ) + _streams.size() * sizeof( RawStreamStreamHeader );
+			writeHeader( 0, 0 );
+			for( size_t i = 0; i < _threads.size(); i++ )
+				_threads[ i ]->run( this );
+		}
+
+		// get a free job, blocks while the encoders are behind
+		Job* job;
+		{
+			ScopeLock lock( &_mutex );
+			while( _threads.size() && _queue.size() >= _maxQueue && _error.isEmpty() )
+				_doneCond.wait( _mutex );
+			if( !_error.isEmpty() )
+				throw CVTException( _error.c_str() );
+
+			if( _pool.size() ){
+				job = _pool.back();
+				_pool.pop_back();
+			} else {
+				job = new Job();
+			}
+		}
+
+		job->stream = stream;
+		job->frame	= s.numFrames++;
+		job->stamp	= stamp;
+
+		if( !_threads.size() ){
+			try {
+				encode( job, img );
+			} catch( ... ){
+				_pool.push_back( job );
+				throw;
+			}
+			_pool.push_back( job );
+			return;
+		}
+
+		/* copy-on-write: only copied if the caller modifies img before it is encoded */
+		job->image.share( img );
+		ScopeLock lock( &_mutex );
+		_queue.push_back( job );
+		_workCond.notify();
+	}
+
+	void RawStreamWriter::close()
+	{
+		if( _fd < 0 )
+			return;
+
+		if( !_started ){
+			_fileSize = sizeof( RawStreamFileHeader ) + _streams.size() * sizeof( RawStreamStreamHeader );
+			writeHeader( 0, 0 );
+		} else {
+			_mutex.lock();
+			while( _queue.size() || _busy )
+				_doneCond.wait( _mutex );
+			_stop = true;
+			_workCond.notifyAll();
+			_mutex.unlock();
+
+			for( size_t i = 0; i < _threads.size(); i++ )
+				_threads[ i ]->join();
+		}
+
+		for( size_t i = 0; i < _threads.size(); i++ )
+			delete _threads[ i ];
+		_threads.clear();
+
+		int fd = _fd;
+		try {
+			if( _error.isEmpty() ){
+				// the encoders finish out of order, the index is sorted by stream and frame
+				std::sort( _index.begin(), _index.end() );
+				uint64_t indexOffset = _fileSize;
+				if( _index.size() )
+					pwriteAll( &_index[ 0 ], _index.size() * sizeof( RawStreamIndexEntry ), indexOffset );
+				writeHeader( indexOffset, _index.size() );
+			}
+		} catch( const Exception& ){
+			::close( fd );
+			_fd = -1;
+			throw;
+		}
+
+		_fd = -1;
+		if( ::close( fd ) < 0 ){
+			String msg( "Could not close file: " );
+			msg += strerror( errno );
+			throw CVTException( msg.c_str() );
+		}
+		checkError();
+	}
+
+	void RawStreamWriter::writeHeader( uint64_t indexOffset, uint64_t numEntries )
+	{
+		RawStreamFileHeader header;
+		memcpy( header.magic, RAWSTREAM_MAGIC, sizeof( header.magic ) );
+		header.version	   = RAWSTREAM_VERSION;
+		header.numStreams  = _streams.size();
+		header.indexOffset = indexOffset;
+		header.numEntries  = numEntries;
+
+		std::vector<RawStreamStreamHeader> streams( _streams.size() );
+		for( size_t i = 0; i < _streams.size(); i++ ){
+			streams[ i ].width	  = _streams[ i ].width;
+			streams[ i ].height	  = _streams[ i ].height;
+			streams[ i ].formatID = _streams[ i ].formatID;
+			streams[ i ].codec	  = _streams[ i ].codec;
+		}
+
+		pwriteAll( &header, sizeof( header ), 0 );
+		if( streams.size() )
+			pwriteAll( &streams[ 0 ], streams.size() * sizeof( RawStreamStreamHeader ), sizeof( header ) );
+	}
+
+	void RawStreamWriter::encode( Job* job, const Image& img )
+	{
+		RawStreamCodec::encode( job->buffer, job->tmp, img, ( RawStreamCodecType )_streams[ job->stream ].codec );
+		if( job->buffer.size() > 0xffffffffUL )
+			throw CVTException( "Encoded frame exceeds the chunk size limit" );
+
+		RawStreamIndexEntry entry;
+		entry.size	   = job->buffer.size();
+		entry.stream   = job->stream;
+		entry.frame	   = job->frame;
+		entry.reserved = 0;
+		entry.stamp	   = job->stamp;
+
+		RawStreamChunkHeader chunk;
+		chunk.tag	 = RAWSTREAM_RESERVEDTAG;
+		chunk.stream = entry.stream;
+		chunk.frame	 = entry.frame;
+		chunk.size	 = entry.size;
+		chunk.stamp	 = entry.stamp;
+
+		// reserve the chunk: its header is on disk before any later chunk, a scan can always skip it
+		uint64_t offset;
+		{
+			ScopeLock lock( &_mutex );
+			offset = _fileSize;
+			pwriteAll( &chunk, sizeof( chunk ), offset );
+			_fileSize += sizeof( RawStreamChunkHeader ) + entry.size;
+			entry.offset = offset + sizeof( RawStreamChunkHeader );
+			_index.push_back( entry );
+		}
+
+		// the data is written without holding the lock
+		if( entry.size )
+			pwriteAll( &job->buffer[ 0 ], entry.size, entry.offset );
+		chunk.tag = RAWSTREAM_CHUNKTAG;
+		pwriteAll( &chunk.tag, sizeof( chunk.tag ), offset );
+	}
+
+	void RawStreamWriter::encodeLoop()
+	{
+		ScopeLock lock( &_mutex );
+		while( true ){
+			while( !_queue.size() && !_stop )
+				_workCond.wait( _mutex );
+			if( !_queue.size() )
+				return;
+
+			Job* job = _queue.front();
+			_queue.erase( _queue.begin() );
+			_busy++;
+			_mutex.unlock();
+
+			String error;
+			try {
+				encode( job, job->image );
+			} catch( const Exception& e ){
+				error = e.what();
+			}
+			/* drop the reference to the shared frame */
+			job->image.reallocate( 1, 1, job->image.format() );
+
+			_mutex.lock();
+			if( !error.isEmpty() && _error.isEmpty() )
+				_error = error;
+			_busy--;
+			_pool.push_back( job );
+			_doneCond.notifyAll();
+		}
+	}
+
+	void RawStreamWriter::pwriteAll( const void* data, size_t n, uint64_t offset )
+	{
+		const uint8_t* ptr = ( const uint8_t* )data;
+		while( n ){
+			ssize_t written = pwrite( _fd, ptr, n, offset );
+			if( written < 0 ){
+				if( errno == EINTR )
+					continue;
+				String msg( "Could not write to file: " );
+				msg += strerror( errno );
+				throw CVTException( msg.c_str() );
+			}
+			ptr += written;
+			offset += written;
+			n -= written;
+		}
+	}
+
+	void RawStreamWriter::checkError()
+	{
+		ScopeLock lock( &_mutex );
+		if( !_error.isEmpty() )
+			throw CVTException( _error.c_str() );
+	}
+}
@@ -0,0 +1,128 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_RAWSTREAMWRITER_H
+#define CVT_RAWSTREAMWRITER_H
+
+#include <cvt/io/RawStreamCodec.h>
+#include <cvt/io/RawStreamFormat.h>
+#include <cvt/util/String.h>
+#include <cvt/util/Mutex.h>
+#include <cvt/util/Condition.h>
+#include <cvt/gfx/Image.h>
+
+#include <vector>
+
+namespace cvt
+{
+	/**
+	 *	\brief	writes one or more synchronized image streams into an indexed RawStream file
+	 *
+	 *	File layout (native byte order):
+	 *		header		"CVTRAWS", version, number of streams, index offset, number of index entries
+	 *		streams		width, height, format id and codec per stream
+	 *		chunks		chunk header (tag, stream, frame, size, stamp) followed by the encoded frame
+	 *		index		offset, size, stream, frame and stamp of every chunk, written on close()
+	 *
+	 *	Frames are encoded by background threads and the chunks are appended in the order
+	 *	the encoders finish. A file that was not closed can still be read, the reader then
+	 *	rebuilds the index from the chunk headers. The header of a chunk is written as
+	 *	reserved when its space is allocated and tagged as frame once the data is complete,
+	 *	so the reader can skip chunks that were interrupted while later ones were finished.
+	 */
+	class RawStreamWriter
+	{
+		public:
+			/**
+			 *	\param	filename	output file, existing files are truncated
+			 *	\param	numThreads	number of encoding threads, 0 encodes synchronously in write()
+			 */
+			RawStreamWriter( const String& filename, size_t numThreads = 2 );
+			~RawStreamWriter();
+
+			/**
+			 *	\brief	add a stream, all streams have to be added before the first write
+			 *	\return	the stream id
+			 */
+			size_t	addStream( size_t width, size_t height, const IFormat& format, RawStreamCodecType codec = RAWSTREAM_CODEC_LZ );
+			size_t	numStreams() const { return _streams.size(); }
+
+			/**
+			 *	\brief	append img to stream
+			 *
+			 *	The image memory is shared copy-on-write, write() only blocks if the encoders fall behind.
+			 *	Errors of the background encoders are rethrown here.
+			 */
+			void	write( size_t stream, const Image& img, double stamp );
+
+			/* wait for the pending frames, write the index and close the file */
+			void	close();
+
+		private:
+			struct Stream {
+				uint32_t			width;
+				uint32_t			height;
+				uint32_t			formatID;
+				uint32_t			codec;
+				size_t				numFrames;
+			};
+
+			struct Job {
+				Image					image;
+				size_t					stream;
+				size_t					frame;
+				double					stamp;
+				std::vector<uint8_t>	buffer;
+				std::vector<uint8_t>	tmp;
+			};
+
+			class EncodeThread;
+			friend class EncodeThread;
+
+			int							_fd;
+			uint64_t					_fileSize;
+			bool						_started;
+			std::vector<Stream>			_streams;
+			std::vector<RawStreamIndexEntry>	_index;
+
+			std::vector<EncodeThread*>	_threads;
+			std::vector<Job*>			_queue;
+			std::vector<Job*>			_pool;
+			size_t						_maxQueue;
+			size_t						_busy;
+			bool						_stop;
+			String						_error;
+			Mutex						_mutex;
+			Condition					_workCond;
+			Condition					_doneCond;
+
+			void	writeHeader( uint64_t indexOffset, uint64_t numEntries );
+			void	encode( Job* job, const Image& img );
+			void	encodeLoop();
+			void	pwriteAll( const void* data, size_t n, uint64_t offset );
+			void	checkError();
+	};
+}
+
+#endif
@@ -32,13 +32,17 @@
 
 namespace cvt
 {
-	RawVideoReader::RawVideoReader( const String & filename, bool autoRewind ):
+	/* number of frames to request ahead of the current one */
+	static const size_t READ_AHEAD_FRAMES = 2;
+
+	RawVideoReader::RawVideoReader( const String & filename, bool autoRewind, bool zeroCopy ):
 		_fd( -1 ),
 		_format( IFormat::RGBA_UINT8 ),
 		_autoRewind( autoRewind ),
+		_zeroCopy( zeroCopy ),
 		_map( 0 ),
 		_mappedSize( 0 ),
-		_ptr( 0 )
+		_data( 0 )
 	{
 		// create the file (open, truncate to header size)
 		_fd = open( filename.c_str(), O_RDONLY , 0 );
@@ -68,13 +72,17 @@ namespace cvt
 			_map = 0;
 			throw CVTException( msg.c_str() );
 		}
-		_ptr = ( uint8_t* )_map;
+		madvise( _map, _mappedSize, MADV_SEQUENTIAL );
 
 		readHeader();	
 	}
 
 	RawVideoReader::~RawVideoReader()
 	{
+		// drop the image before it can reference unmapped memory
+		Image empty;
+		_frame.swap( empty );
+
 		if( _fd != -1 ){
 			if( _map != 0 ){
 				if( munmap( _map, _mappedSize ) != 0 ){
@@ -96,51 +104,115 @@ namespace cvt
 
 	void RawVideoReader::readHeader()
 	{
-		_width = *( ( uint32_t* ) _ptr );
-		_ptr += sizeof( uint32_t );
-		_height = *( ( uint32_t* ) _ptr );
-		_ptr += sizeof( uint32_t );
-		_stride = *( ( uint32_t* ) _ptr );
-		_ptr += sizeof( uint32_t );
-		_format = IFormat::formatForId( (IFormatID ) *( ( uint32_t* ) _ptr ) );
-		_ptr += sizeof( uint32_t );
+		uint8_t* ptr = ( uint8_t* )_map;
+		_width = *( ( uint32_t* ) ptr );
+		ptr += sizeof( uint32_t );
+		_height = *( ( uint32_t* ) ptr );
+		ptr += sizeof( uint32_t );
+		_stride = *( ( uint32_t* ) ptr );
+		ptr += sizeof( uint32_t );
+		_format = IFormat::formatForId( (IFormatID ) *( ( uint32_t* ) ptr ) );
+		ptr += sizeof( uint32_t );
+		_data = ptr;
 		
-		uint32_t dataSize = _mappedSize - ( 4 * sizeof( uint32_t ) );
-		uint32_t frameSize = _stride * _height;
+		size_t dataSize = _mappedSize - ( 4 * sizeof( uint32_t ) );
+		_frameSize = _stride * _height;
 
-		_numFrames = dataSize / frameSize;
-		_currentFrame = 1;
+		_numFrames = dataSize / _frameSize;
+		_currentFrame = 0;
 
 		_frame.reallocate( _width, _height, _format );
+		adviseFrames( 0, READ_AHEAD_FRAMES, MADV_WILLNEED );
 	}
 
+	void RawVideoReader::adviseFrames( size_t first, size_t n, int advice ) const
+	{
+		if( first >= _numFrames )
+			return;
+		n = Math::min( n, _numFrames - first );
+
+		size_t start = ( _data - ( uint8_t* )_map ) + first * _frameSize;
+		size_t end	 = start + n * _frameSize;
+
+		if( advice == MADV_DONTNEED ){
+			// only release pages that are completely covered by the frames
+			start = ( ( start + _pageSize - 1 ) / _pageSize ) * _pageSize;
+			end	  = ( end / _pageSize ) * _pageSize;
+		} else {
+			start = ( start / _pageSize ) * _pageSize;
+			end	  = Math::min( ( ( end + _pageSize - 1 ) / _pageSize ) * _pageSize, _mappedSize );
+		}
+
+		if( start < end )
+			madvise( ( uint8_t* )_map + start, end - start, advice );
+	}
+
+	void RawVideoReader::rewind()
+	{
+		seek( 0 );
+	}
+
+	void RawVideoReader::seek( size_t idx )
+	{
+		if( idx >= _numFrames )
+			throw CVTException( "Frame index out of range" );
+
+		_currentFrame = idx;
+		adviseFrames( _currentFrame, READ_AHEAD_FRAMES, MADV_WILLNEED );
+	}
+
+	void RawVideoReader::setZeroCopy( bool zeroCopy )
+	{
+		if( zeroCopy == _zeroCopy )
+			return;
+
+		_zeroCopy = zeroCopy;
+		if( !_zeroCopy ){
+			// do not copy the next frames into the mapping
+			Image img( _width, _height, _format );
+			_frame.swap( img );
+		}
+	}
 
 	bool RawVideoReader::nextFrame( size_t )
 	{
-		if( _currentFrame < _numFrames ){
+		if( _currentFrame >= _numFrames ){
+			if( !_autoRewind || !_numFrames )
+				return false;
+			rewind();
+		}
+
+		const uint8_t* src = _data + _currentFrame * _frameSize;
+		if( _zeroCopy ){
+			// read-only wrapper, writing to the frame copies it
+			Image img( _width, _height, _format, src, _stride );
+			_frame.swap( img );
+		} else {
 			size_t istride;
 			uint8_t* iptr = _frame.map<uint8_t>( &istride );
 
 			SIMD* simd = SIMD::instance();
 			if( istride == _stride ){
-				size_t num = _height * _stride;
-				simd->Memcpy( iptr, _ptr, num );
-				_ptr += num;
+				simd->Memcpy( iptr, src, _frameSize );
 			} else {
 				size_t h = _height;
 				uint8_t * p = iptr;
 				size_t bytesPerRow = _width * _frame.bpp();
 				while( h-- ){
-					simd->Memcpy( p, _ptr, bytesPerRow );
-					_ptr += _stride;
+					simd->Memcpy( p, src, bytesPerRow );
+					src += _stride;
 					p += istride;
 				}
 			}
 			_frame.unmap( iptr );
-			_currentFrame++;
-			return true;
 		}
-		return false;
+
+		// the previous frame is not needed anymore, request the upcoming ones. Dropped pages
+		// still referenced by zero-copy frames are read from the file again
+		if( _currentFrame > 0 )
+			adviseFrames( _currentFrame - 1, 1, MADV_DONTNEED );
+		adviseFrames( _currentFrame + 1, READ_AHEAD_FRAMES, MADV_WILLNEED );
+		_currentFrame++;
+		return true;
 	}
 }
-
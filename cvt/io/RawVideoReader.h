@@ -34,7 +34,13 @@ namespace cvt {
 	class RawVideoReader : public VideoInput
 	{
 		public:
-			RawVideoReader( const String & fileName, bool autoRewind = true );
+			/**
+			 *	\param	fileName	the raw video file
+			 *	\param	autoRewind	restart with the first frame after the last one instead of
+			 *						returning false from nextFrame()
+			 *	\param	zeroCopy	see setZeroCopy
+			 */
+			RawVideoReader( const String & fileName, bool autoRewind = false, bool zeroCopy = false );
 			~RawVideoReader();
 
 			size_t  width() const;
@@ -44,6 +50,23 @@ namespace cvt {
 			bool    nextFrame( size_t timeout = 0 );
 			size_t	numFrames() const { return _numFrames; }
 
+			/**
+			 *	\brief	position the reader, the next call to nextFrame() reads frame idx
+			 */
+			void	seek( size_t idx );
+
+			/* index of the frame read by the next call to nextFrame() */
+			size_t	position() const { return _currentFrame; }
+
+			/**
+			 *	\brief	hand out the frames without copying
+			 *
+			 *	frame() then wraps the read-only mapping of the file directly. The image stays
+			 *	valid until the reader is destroyed, mapping it mutable copies the frame first.
+			 */
+			void	setZeroCopy( bool zeroCopy );
+			bool	zeroCopy() const { return _zeroCopy; }
+
 		private:
 			int			_fd;
 			Image		_frame;
@@ -53,16 +76,19 @@ namespace cvt {
 			size_t		_height;
 			IFormat		_format;
 			bool		_autoRewind;
+			bool		_zeroCopy;
 
 			void*		_map;
 			size_t		_mappedSize;
-			uint8_t*	_ptr;
+			uint8_t*	_data;
 			size_t		_stride;
+			size_t		_frameSize;
 			size_t		_numFrames;
 			size_t		_currentFrame;
 
 			void rewind();
 			void readHeader();
+			void adviseFrames( size_t first, size_t n, int advice ) const;
 	};
 
 	inline size_t RawVideoReader::width() const
@@ -25,87 +25,362 @@
 #ifndef CVT_SPARSE_BLOCK_MATRIX_H
 #define CVT_SPARSE_BLOCK_MATRIX_H
 
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+#include <vector>
+#include <algorithm>
+
+#include <cvt/math/Math.h>
+#include <cvt/util/Exception.h>
+#include <cvt/util/ParallelRows.h>
+
 namespace cvt
 {
+	/**
+	 *	\class SparseBlockMatrix
+	 *	\brief Block compressed sparse row matrix with fixed size bRows x bCols blocks
+	 *
+	 *	The sparsity pattern is set once with setPattern(): for each block row the sorted list
+	 *	of block columns. The blocks are stored row by row, so the memory only depends on the
+	 *	number of non-zero blocks. A column index (CSC view on the same blocks) is built along
+	 *	with the pattern for column wise traversal and the transposed products.
+	 *
+	 *	The block positions are fixed once the pattern is set, so different threads can fill
+	 *	different blocks concurrently without locking.
+	 */
 	template<size_t bRows, size_t bCols>
 	class SparseBlockMatrix
 	{
 		public:
 			typedef typename Eigen::Matrix<double, bRows, bCols> BlockMatType;
-			
+			typedef typename Eigen::Matrix<double, bRows, bRows> RowDiagType;
+			typedef typename Eigen::Matrix<double, bCols, bCols> ColDiagType;
+
+			static const size_t INVALID_BLOCK = ( size_t ) -1;
+
 			SparseBlockMatrix();
 			~SparseBlockMatrix();
 
-
+			/* set the size and clear the pattern */
 			void resize( size_t numRowBlocks, size_t numColBlocks );
 
-			bool containsBlock( size_t row, size_t col ) const;
+			/**
+			 *	\brief Set the sparsity pattern, all blocks are set to zero
+			 *	\param rowStart	numRowBlocks + 1 offsets into cols, row r uses cols[ rowStart[ r ] ... rowStart[ r + 1 ] - 1 ]
+			 *	\param cols		block column indices, sorted ascending within each row
+			 */
+			void setPattern( size_t numRowBlocks, size_t numColBlocks, const std::vector<size_t>& rowStart, const std::vector<size_t>& cols );
+
+			void setZero();
 
-			BlockMatType&	block( size_t row, size_t col );
+			bool				containsBlock( size_t row, size_t col ) const;
+			/* index of block ( row, col ) or INVALID_BLOCK */
+			size_t				blockIndex( size_t row, size_t col ) const;
+
+			BlockMatType&		block( size_t row, size_t col );
+			const BlockMatType&	block( size_t row, size_t col ) const;
+			BlockMatType&		blockAt( size_t idx )		{ return _blocks[ idx ]; }
+			const BlockMatType&	blockAt( size_t idx ) const { return _blocks[ idx ]; }
 
 			size_t			numBlockRows() const { return _numRows; }
 			size_t			numBlockCols() const { return _numCols; }
+			size_t			numBlocks() const	 { return _blocks.size(); }
+
+			/* blocks of row r are [ rowBegin( r ), rowEnd( r ) ), blockCol( idx ) is the column of block idx */
+			size_t			rowBegin( size_t r ) const	{ return _rowStart[ r ]; }
+			size_t			rowEnd( size_t r ) const	{ return _rowStart[ r + 1 ]; }
+			size_t			blockCol( size_t idx ) const{ return _cols[ idx ]; }
+
+			/* entries of column c are [ colBegin( c ), colEnd( c ) ), sorted by row */
+			size_t			colBegin( size_t c ) const	{ return _colStart[ c ]; }
+			size_t			colEnd( size_t c ) const	{ return _colStart[ c + 1 ]; }
+			size_t			colBlock( size_t i ) const	{ return _colBlocks[ i ]; }
+			size_t			colRow( size_t i ) const	{ return _colRows[ i ]; }
+
+			/* y = A * x */
+			void multiply( Eigen::VectorXd& y, const Eigen::VectorXd& x ) const;
+			/* y = A^T * x */
+			void transposeMultiply( Eigen::VectorXd& y, const Eigen::VectorXd& x ) const;
+
+			/**
+			 *	\brief Product with the Schur complement S = D - A * Vinv * A^T
+			 *	\param diag	numBlockRows() blocks of the block diagonal D
+			 *	\param vinv	numBlockCols() blocks of the block diagonal Vinv
+			 */
+			void schurProduct( Eigen::VectorXd& y, const Eigen::VectorXd& x, const RowDiagType* diag, const ColDiagType* vinv ) const;
+
+			/* diagonal blocks of the Schur complement S = D - A * Vinv * A^T, e.g. for a block Jacobi preconditioner */
+			void schurDiagonal( RowDiagType* dst, const RowDiagType* diag, const ColDiagType* vinv ) const;
 
 		private:
-			int*	_filled;
-			size_t	_numRows;
-			size_t	_numCols;
+			SparseBlockMatrix( const SparseBlockMatrix& );
+			SparseBlockMatrix& operator=( const SparseBlockMatrix& );
+
+			class RowProduct;
+			class ColProduct;
+			class SchurRowProduct;
+			class SchurDiagonal;
+
+			/* approximate number of multiply adds per block row for the ParallelRows threshold */
+			size_t rowCost() const { return ( _blocks.size() / Math::max<size_t>( _numRows, 1 ) + 1 ) * bRows * bCols; }
+			size_t colCost() const { return ( _blocks.size() / Math::max<size_t>( _numCols, 1 ) + 1 ) * bRows * bCols; }
+
+			size_t				_numRows;
+			size_t				_numCols;
+			std::vector<size_t> _rowStart;
+			std::vector<size_t> _cols;
+			std::vector<size_t> _colStart;
+			std::vector<size_t> _colBlocks;
+			std::vector<size_t> _colRows;
 			std::vector<BlockMatType, Eigen::aligned_allocator<BlockMatType> >	_blocks;
 	};
 
+	template <size_t bRows, size_t bCols>
+	class SparseBlockMatrix<bRows, bCols>::RowProduct : public ParallelRows::Body
+	{
+		public:
+			RowProduct( const SparseBlockMatrix<bRows, bCols>& m, Eigen::VectorXd& y, const Eigen::VectorXd& x ) : _m( m ), _y( y ), _x( x )
+			{
+			}
+
+			void process( size_t rstart, size_t rend ) const
+			{
+				for( size_t r = rstart; r < rend; r++ ) {
+					Eigen::Matrix<double, bRows, 1> sum = Eigen::Matrix<double, bRows, 1>::Zero();
+					for( size_t b = _m.rowBegin( r ); b < _m.rowEnd( r ); b++ )
+						sum.noalias() += _m.blockAt( b ) * _x.template segment<bCols>( bCols * _m.blockCol( b ) );
+					_y.template segment<bRows>( bRows * r ) = sum;
+				}
+			}
+
+		private:
+			const SparseBlockMatrix<bRows, bCols>&	_m;
+			Eigen::VectorXd&						_y;
+			const Eigen::VectorXd&					_x;
+	};
+
+	/* y = A^T x, optionally followed by y_c = vinv_c * y_c */
+	template <size_t bRows, size_t bCols>
+	class SparseBlockMatrix<bRows, bCols>::ColProduct : public ParallelRows::Body
+	{
+		public:
+			ColProduct( const SparseBlockMatrix<bRows, bCols>& m, Eigen::VectorXd& y, const Eigen::VectorXd& x, const ColDiagType* vinv ) :
+				_m( m ), _y( y ), _x( x ), _vinv( vinv )
+			{
+			}
+
+			void process( size_t cstart, size_t cend ) const
+			{
+				for( size_t c = cstart; c < cend; c++ ) {
+					Eigen::Matrix<double, bCols, 1> sum = Eigen::Matrix<double, bCols, 1>::Zero();
+					for( size_t i = _m.colBegin( c ); i < _m.colEnd( c ); i++ )
+						sum.noalias() += _m.blockAt( _m.colBlock( i ) ).transpose() * _x.template segment<bRows>( bRows * _m.colRow( i ) );
+					if( _vinv )
+						_y.template segment<bCols>( bCols * c ) = _vinv[ c ] * sum;
+					else
+						_y.template segment<bCols>( bCols * c ) = sum;
+				}
+			}
+
+		private:
+			const SparseBlockMatrix<bRows, bCols>&	_m;
+			Eigen::VectorXd&						_y;
+			const Eigen::VectorXd&					_x;
+			const ColDiagType*						_vinv;
+	};
+
+	/* y = D x - A t */
+	template <size_t bRows, size_t bCols>
+	class SparseBlockMatrix<bRows, bCols>::SchurRowProduct : public ParallelRows::Body
+	{
+		public:
+			SchurRowProduct( const SparseBlockMatrix<bRows, bCols>& m, Eigen::VectorXd& y, const Eigen::VectorXd& x, const Eigen::VectorXd& t, const RowDiagType* diag ) :
+				_m( m ), _y( y ), _x( x ), _t( t ), _diag( diag )
+			{
+			}
+
+			void process( size_t rstart, size_t rend ) const
+			{
+				for( size_t r = rstart; r < rend; r++ ) {
+					Eigen::Matrix<double, bRows, 1> sum = _diag[ r ] * _x.template segment<bRows>( bRows * r );
+					for( size_t b = _m.rowBegin( r ); b < _m.rowEnd( r ); b++ )
+						sum.noalias() -= _m.blockAt( b ) * _t.template segment<bCols>( bCols * _m.blockCol( b ) );
+					_y.template segment<bRows>( bRows * r ) = sum;
+				}
+			}
+
+		private:
+			const SparseBlockMatrix<bRows, bCols>&	_m;
+			Eigen::VectorXd&						_y;
+			const Eigen::VectorXd&					_x;
+			const Eigen::VectorXd&					_t;
+			const RowDiagType*						_diag;
+	};
+
+	template <size_t bRows, size_t bCols>
+	class SparseBlockMatrix<bRows, bCols>::SchurDiagonal : public ParallelRows::Body
+	{
+		public:
+			SchurDiagonal( const SparseBlockMatrix<bRows, bCols>& m, RowDiagType* dst, const RowDiagType* diag, const ColDiagType* vinv ) :
+				_m( m ), _dst( dst ), _diag( diag ), _vinv( vinv )
+			{
+			}
+
+			void process( size_t rstart, size_t rend ) const
+			{
+				for( size_t r = rstart; r < rend; r++ ) {
+					RowDiagType s = _diag[ r ];
+					for( size_t b = _m.rowBegin( r ); b < _m.rowEnd( r ); b++ ) {
+						const BlockMatType& w = _m.blockAt( b );
+						s.noalias() -= w * _vinv[ _m.blockCol( b ) ] * w.transpose();
+					}
+					_dst[ r ] = s;
+				}
+			}
+
+		private:
+			const SparseBlockMatrix<bRows, bCols>&	_m;
+			RowDiagType*							_dst;
+			const RowDiagType*						_diag;
+			const ColDiagType*						_vinv;
+	};
+
 	template <size_t bRows, size_t bCols>
 	inline SparseBlockMatrix<bRows, bCols>::SparseBlockMatrix() :
-		_filled( 0 ),
 		_numRows( 0 ),
 		_numCols( 0 )
 	{
+		resize( 0, 0 );
+	}
+
+	template <size_t bRows, size_t bCols>
+	inline SparseBlockMatrix<bRows, bCols>::~SparseBlockMatrix()
+	{
+	}
+
+	template <size_t bRows, size_t bCols>
+	inline void SparseBlockMatrix<bRows, bCols>::resize( size_t rows, size_t cols )
+	{
+		_numRows = rows;
+		_numCols = cols;
+		_rowStart.assign( rows + 1, 0 );
+		_colStart.assign( cols + 1, 0 );
+		_cols.clear();
+		_colBlocks.clear();
+		_colRows.clear();
+		_blocks.clear();
 	}
-	
+
 	template <size_t bRows, size_t bCols>
-	inline SparseBlockMatrix<bRows, bCols>::~SparseBlockMatrix() 
+	inline void SparseBlockMatrix<bRows, bCols>::setPattern( size_t rows, size_t cols, const std::vector<size_t>& rowStart, const std::vector<size_t>& colIdx )
 	{
-		if( _filled ){
-			delete[] _filled;
+		if( rowStart.size() != rows + 1 || rowStart[ rows ] != colIdx.size() )
+			throw CVTException( "Invalid block pattern" );
+
+		_numRows = rows;
+		_numCols = cols;
+		_rowStart = rowStart;
+		_cols = colIdx;
+		_blocks.resize( _cols.size() );
+		setZero();
+
+		/* column index: count, prefix sum and scatter - rows are visited in order, so each column is sorted by row */
+		_colStart.assign( cols + 1, 0 );
+		for( size_t i = 0; i < _cols.size(); i++ ) {
+			if( _cols[ i ] >= cols )
+				throw CVTException( "Block column out of range" );
+			_colStart[ _cols[ i ] + 1 ]++;
 		}
+		for( size_t c = 0; c < cols; c++ )
+			_colStart[ c + 1 ] += _colStart[ c ];
+
+		std::vector<size_t> pos( _colStart.begin(), _colStart.end() - 1 );
+		_colBlocks.resize( _cols.size() );
+		_colRows.resize( _cols.size() );
+		for( size_t r = 0; r < rows; r++ ) {
+			for( size_t b = _rowStart[ r ]; b < _rowStart[ r + 1 ]; b++ ) {
+				size_t p = pos[ _cols[ b ] ]++;
+				_colBlocks[ p ] = b;
+				_colRows[ p ] = r;
+			}
+		}
+	}
+
+	template <size_t bRows, size_t bCols>
+	inline void SparseBlockMatrix<bRows, bCols>::setZero()
+	{
+		for( size_t i = 0; i < _blocks.size(); i++ )
+			_blocks[ i ].setZero();
+	}
+
+	template <size_t bRows, size_t bCols>
+	inline size_t SparseBlockMatrix<bRows, bCols>::blockIndex( size_t row, size_t col ) const
+	{
+		std::vector<size_t>::const_iterator begin = _cols.begin() + _rowStart[ row ];
+		std::vector<size_t>::const_iterator end = _cols.begin() + _rowStart[ row + 1 ];
+		std::vector<size_t>::const_iterator it = std::lower_bound( begin, end, col );
+		if( it == end || *it != col )
+			return INVALID_BLOCK;
+		return it - _cols.begin();
 	}
 
 	template <size_t bRows, size_t bCols>
 	inline bool SparseBlockMatrix<bRows, bCols>::containsBlock( size_t row, size_t col ) const
 	{
-		return _filled[ row * _numCols + col ] != -1;
+		return blockIndex( row, col ) != INVALID_BLOCK;
 	}
 
 	template <size_t bRows, size_t bCols>
 	inline Eigen::Matrix<double, bRows, bCols>& SparseBlockMatrix<bRows, bCols>::block( size_t r, size_t c )
 	{
-		int* a = _filled + ( r * _numCols + c );
+		size_t idx = blockIndex( r, c );
+		if( idx == INVALID_BLOCK )
+			throw CVTException( "Block not in sparsity pattern" );
+		return _blocks[ idx ];
+	}
 
-		if( *a == -1 ){
-			*a = _blocks.size();
-			_blocks.push_back( BlockMatType() );
-			_blocks.back().setZero();
-		}
+	template <size_t bRows, size_t bCols>
+	inline const Eigen::Matrix<double, bRows, bCols>& SparseBlockMatrix<bRows, bCols>::block( size_t r, size_t c ) const
+	{
+		size_t idx = blockIndex( r, c );
+		if( idx == INVALID_BLOCK )
+			throw CVTException( "Block not in sparsity pattern" );
+		return _blocks[ idx ];
+	}
 
-		return _blocks[ *a ];
+	template <size_t bRows, size_t bCols>
+	inline void SparseBlockMatrix<bRows, bCols>::multiply( Eigen::VectorXd& y, const Eigen::VectorXd& x ) const
+	{
+		y.resize( bRows * _numRows );
+		RowProduct body( *this, y, x );
+		ParallelRows::run( body, rowCost(), _numRows );
 	}
-	
-	template <size_t bRows, size_t bCols>
-	inline void SparseBlockMatrix<bRows, bCols>::resize( size_t rows, size_t cols ) 	
-	{
-		if( _numRows == rows && _numCols == cols ) {
-			_blocks.clear();
-			size_t n = _numRows * _numCols;
-			memset( _filled, -1, sizeof( int ) * n );
-			return;
-		} else {
-			delete[] _filled;
-			_numRows = rows; 
-			_numCols = cols;
-			size_t n = _numRows * _numCols;
-			_filled = new int[ n ];
-			memset( _filled, -1, sizeof( int ) * n );
-			_blocks.clear();
-		}
+
+	template <size_t bRows, size_t bCols>
+	inline void SparseBlockMatrix<bRows, bCols>::transposeMultiply( Eigen::VectorXd& y, const Eigen::VectorXd& x ) const
+	{
+		y.resize( bCols * _numCols );
+		ColProduct body( *this, y, x, NULL );
+		ParallelRows::run( body, colCost(), _numCols );
+	}
+
+	template <size_t bRows, size_t bCols>
+	inline void SparseBlockMatrix<bRows, bCols>::schurProduct( Eigen::VectorXd& y, const Eigen::VectorXd& x, const RowDiagType* diag, const ColDiagType* vinv ) const
+	{
+		Eigen::VectorXd t( bCols * _numCols );
+		ColProduct tbody( *this, t, x, vinv );
+		ParallelRows::run( tbody, colCost(), _numCols );
+
+		y.resize( bRows * _numRows );
+		SchurRowProduct body( *this, y, x, t, diag );
+		ParallelRows::run( body, rowCost(), _numRows );
+	}
+
+	template <size_t bRows, size_t bCols>
+	inline void SparseBlockMatrix<bRows, bCols>::schurDiagonal( RowDiagType* dst, const RowDiagType* diag, const ColDiagType* vinv ) const
+	{
+		SchurDiagonal body( *this, dst, diag, vinv );
+		ParallelRows::run( body, rowCost() * bRows, _numRows );
 	}
 }
 
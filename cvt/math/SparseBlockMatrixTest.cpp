@@ -0,0 +1,161 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/CVTTest.h>
+#include <cvt/math/SparseBlockMatrix.h>
+#include <cvt/math/Math.h>
+
+namespace cvt {
+
+	typedef SparseBlockMatrix<6, 3> TestBlockMatrix;
+
+	/* random pattern with roughly fill percent of the blocks set, filled with random values */
+	static void randomBlockMatrix( TestBlockMatrix& m, Eigen::MatrixXd& dense, size_t rows, size_t cols, int fill )
+	{
+		std::vector<size_t> rowStart( rows + 1 );
+		std::vector<size_t> colIdx;
+		for( size_t r = 0; r < rows; r++ ) {
+			rowStart[ r ] = colIdx.size();
+			for( size_t c = 0; c < cols; c++ ) {
+				if( Math::rand( 0, 100 ) < fill )
+					colIdx.push_back( c );
+			}
+		}
+		rowStart[ rows ] = colIdx.size();
+		m.setPattern( rows, cols, rowStart, colIdx );
+
+		dense = Eigen::MatrixXd::Zero( 6 * rows, 3 * cols );
+		for( size_t r = 0; r < rows; r++ ) {
+			for( size_t b = m.rowBegin( r ); b < m.rowEnd( r ); b++ ) {
+				m.blockAt( b ).setRandom();
+				dense.block<6, 3>( 6 * r, 3 * m.blockCol( b ) ) = m.blockAt( b );
+			}
+		}
+	}
+
+	static bool patternTest()
+	{
+		TestBlockMatrix m;
+		Eigen::MatrixXd dense;
+		randomBlockMatrix( m, dense, 13, 57, 20 );
+
+		bool b = true;
+		size_t num = 0;
+		for( size_t r = 0; r < m.numBlockRows(); r++ ) {
+			for( size_t c = 0; c < m.numBlockCols(); c++ ) {
+				bool nonzero = dense.block<6, 3>( 6 * r, 3 * c ).squaredNorm() != 0;
+				b &= m.containsBlock( r, c ) == nonzero;
+				if( nonzero ) {
+					b &= m.block( r, c ) == dense.block<6, 3>( 6 * r, 3 * c );
+					num++;
+				}
+			}
+		}
+		b &= num == m.numBlocks();
+
+		/* the column index has to list the same blocks sorted by row */
+		size_t colEntries = 0;
+		for( size_t c = 0; c < m.numBlockCols(); c++ ) {
+			for( size_t i = m.colBegin( c ); i < m.colEnd( c ); i++ ) {
+				b &= m.blockCol( m.colBlock( i ) ) == c;
+				b &= m.blockIndex( m.colRow( i ), c ) == m.colBlock( i );
+				if( i > m.colBegin( c ) )
+					b &= m.colRow( i - 1 ) < m.colRow( i );
+				colEntries++;
+			}
+		}
+		b &= colEntries == m.numBlocks();
+
+		bool thrown = false;
+		try {
+			for( size_t c = 0; c < m.numBlockCols(); c++ ) {
+				if( !m.containsBlock( 0, c ) )
+					m.block( 0, c );
+			}
+		} catch( const Exception& ) {
+			thrown = true;
+		}
+		b &= thrown;
+		return b;
+	}
+
+	static bool productTest()
+	{
+		TestBlockMatrix m;
+		Eigen::MatrixXd dense;
+		randomBlockMatrix( m, dense, 40, 300, 10 );
+
+		bool b = true;
+		Eigen::VectorXd x = Eigen::VectorXd::Random( dense.cols() );
+		Eigen::VectorXd y;
+		m.multiply( y, x );
+		b &= ( y - dense * x ).norm() < 1e-9;
+
+		Eigen::VectorXd xt = Eigen::VectorXd::Random( dense.rows() );
+		m.transposeMultiply( y, xt );
+		b &= ( y - dense.transpose() * xt ).norm() < 1e-9;
+
+		/* Schur complement with random SPD block diagonals */
+		std::vector<TestBlockMatrix::RowDiagType, Eigen::aligned_allocator<TestBlockMatrix::RowDiagType> > diag( m.numBlockRows() ), sdiag( m.numBlockRows() );
+		std::vector<TestBlockMatrix::ColDiagType, Eigen::aligned_allocator<TestBlockMatrix::ColDiagType> > vinv( m.numBlockCols() );
+		Eigen::MatrixXd denseD = Eigen::MatrixXd::Zero( dense.rows(), dense.rows() );
+		Eigen::MatrixXd denseV = Eigen::MatrixXd::Zero( dense.cols(), dense.cols() );
+		for( size_t r = 0; r < diag.size(); r++ ) {
+			TestBlockMatrix::RowDiagType a = TestBlockMatrix::RowDiagType::Random();
+			diag[ r ] = a * a.transpose() + TestBlockMatrix::RowDiagType::Identity();
+			denseD.block<6, 6>( 6 * r, 6 * r ) = diag[ r ];
+		}
+		for( size_t c = 0; c < vinv.size(); c++ ) {
+			TestBlockMatrix::ColDiagType a = TestBlockMatrix::ColDiagType::Random();
+			vinv[ c ] = a * a.transpose() + TestBlockMatrix::ColDiagType::Identity();
+			denseV.block<3, 3>( 3 * c, 3 * c ) = vinv[ c ];
+		}
+		Eigen::MatrixXd S = denseD - dense * denseV * dense.transpose();
+
+		m.schurProduct( y, xt, &diag[ 0 ], &vinv[ 0 ] );
+		b &= ( y - S * xt ).norm() < 1e-8 * S.norm();
+
+		m.schurDiagonal( &sdiag[ 0 ], &diag[ 0 ], &vinv[ 0 ] );
+		for( size_t r = 0; r < sdiag.size(); r++ )
+			b &= ( sdiag[ r ] - S.block<6, 6>( 6 * r, 6 * r ) ).norm() < 1e-8 * S.norm();
+
+		return b;
+	}
+
+BEGIN_CVTTEST( SparseBlockMatrix )
+	bool ret = true;
+	bool b;
+
+	b = patternTest();
+	CVTTEST_PRINT( "setPattern()", b );
+	ret &= b;
+
+	b = productTest();
+	CVTTEST_PRINT( "multiply(), transposeMultiply(), schurProduct()", b );
+	ret &= b;
+
+	return ret;
+END_CVTTEST
+
+}
@@ -76,6 +76,7 @@ namespace cvt
         ResultType refine( const ResultType& res, const std::vector<size_t> & inlierIndices ) const;
 
         void inliers( std::vector<size_t> & inlierIndices, const ResultType & estimate, const DistanceType maxDistance ) const;
+        size_t numInliers( const ResultType & estimate, const DistanceType maxDistance, const size_t* indices, size_t n ) const;
 
       private:
 		const PointSet<3, T> &    _points3d;
@@ -150,6 +151,35 @@ namespace cvt
         }
     }
 
+	template <typename T>
+	inline size_t EPnPSAC<T>::numInliers( const ResultType & estimate,
+									 const DistanceType maxDistance,
+									 const size_t* indices, size_t n ) const
+    {
+		Vector2<T> p2;
+		Vector3<T> p3;
+
+		Matrix3<T> R = _intrinsics * estimate.toMatrix3();
+		Vector3<T> t( estimate[ 0 ][ 3 ], estimate[ 1 ][ 3 ], estimate[ 2 ][ 3 ] );
+		t = _intrinsics * t;
+
+        size_t num = 0;
+        for( size_t i = 0; i < n; i++ ){
+            size_t idx = indices[ i ];
+            p3 = R * _points3d[ idx ] + t;
+
+			if( Math::abs( p3.z ) < ( T )1e-6 )
+				continue;
+
+			p2.x = p3.x / p3.z;
+			p2.y = p3.y / p3.z;
+
+            if( ( p2 - _points2d[ idx ] ).length() < maxDistance )
+                num++;
+        }
+        return num;
+    }
+
 }
 
 #endif
@@ -29,6 +29,7 @@
 #include <cvt/math/Matrix.h>
 #include <cvt/vision/features/FeatureMatch.h>
 #include <cvt/geom/PointSet.h>
+#include <cvt/geom/Line2D.h>
 
 namespace cvt
 {
@@ -69,6 +70,7 @@ namespace cvt
             ResultType refine( const ResultType& res, const std::vector<size_t> & inlierIndices ) const;
 
 			void inliers( std::vector<size_t> & inlierIndices, const ResultType & estimate, const DistanceType maxDistance ) const;
+			size_t numInliers( const ResultType & estimate, const DistanceType maxDistance, const size_t* indices, size_t n ) const;
 
 		private:
 			const std::vector<FeatureMatch>&    _matches;
@@ -112,6 +114,26 @@ namespace cvt
                 inlierIndices.push_back( i );
         }
     }
+
+    inline size_t EssentialSAC::numInliers( const ResultType & estimate,
+                                            const DistanceType maxDistance,
+                                            const size_t* indices, size_t n ) const
+    {
+		Matrix3f funda = _Kinv.transpose() * estimate * _Kinv;
+        Vector3f tmp;
+        size_t num = 0;
+        for( size_t i = 0; i < n; i++ ){
+            const FeatureMatch& m = _matches[ indices[ i ] ];
+			tmp[ 0 ] = m.feature0->pt.x;
+			tmp[ 1 ] = m.feature0->pt.y;
+			tmp[ 2 ] = 1.0f;
+
+			Line2Df line( funda * tmp );
+            if( line.distance( m.feature1->pt ) < maxDistance )
+                num++;
+        }
+        return num;
+    }
 }
 
 #endif
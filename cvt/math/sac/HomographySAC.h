@@ -76,6 +76,7 @@ namespace cvt
         ResultType refine( const ResultType& res, const std::vector<size_t> & inlierIndices ) const;
 
         void inliers( std::vector<size_t> & inlierIndices, const ResultType & estimate, const DistanceType maxDistance ) const;
+        size_t numInliers( const ResultType & estimate, const DistanceType maxDistance, const size_t* indices, size_t n ) const;
 
       private:
         const std::vector<FeatureMatch>&    _matches;
@@ -113,6 +114,22 @@ namespace cvt
                 inlierIndices.push_back( i );
         }
     }
+
+    inline size_t HomographySAC::numInliers( const ResultType & estimate,
+                                             const DistanceType maxDistance,
+                                             const size_t* indices, size_t n ) const
+    {
+        Vector2f pPrime;
+        size_t num = 0;
+        for( size_t i = 0; i < n; i++ ){
+            const FeatureMatch& m = _matches[ indices[ i ] ];
+            pPrime = estimate * m.feature0->pt;
+
+            if( ( pPrime - m.feature1->pt ).length() < maxDistance )
+                num++;
+        }
+        return num;
+    }
 }
 
 #endif
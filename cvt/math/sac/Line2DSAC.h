@@ -66,6 +66,7 @@ namespace cvt
         ResultType refine( const ResultType& res, const std::vector<size_t> & inliers  ) const;
 
         void inliers( std::vector<size_t> & inlierIndices, const ResultType & estimate, const DistanceType maxDistance ) const;
+        size_t numInliers( const ResultType & estimate, const DistanceType maxDistance, const size_t* indices, size_t n ) const;
 
       private:
         const std::vector<Vector2f>&    _points;
@@ -113,6 +114,18 @@ namespace cvt
         }
     }
 
+    inline size_t Line2DSAC::numInliers( const Line2DSAC::ResultType & estimate,
+                                         const Line2DSAC::DistanceType maxDistance,
+                                         const size_t* indices, size_t n ) const
+    {
+        size_t num = 0;
+        for( size_t i = 0; i < n; i++ ){
+            if( Math::abs( estimate.distance( _points[ indices[ i ] ] ) ) < maxDistance )
+                num++;
+        }
+        return num;
+    }
+
 
 
 }
@@ -34,9 +34,28 @@
 
 #include <cvt/math/Math.h>
 #include <cvt/math/sac/SampleConsensusModel.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/Exception.h>
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
 
 namespace cvt
 {
+    /**
+     *  \class RANSAC
+     *  \brief Random sample consensus with parallel hypothesis generation
+     *
+     *  The hypotheses are generated and scored in rounds on the ThreadPool. Every hypothesis
+     *  draws its sample from its own random stream, so the result depends on the seed but not
+     *  on the number of threads.
+     *  The points are scored in blocks in a random order, a hypothesis is dropped as soon as it
+     *  cannot beat the best one so far or, with the sequential probability ratio test ( SPRT ),
+     *  as soon as it is likely to be a bad one.
+     *  If the points are ordered by their quality with setSampleOrder(), the samples are drawn
+     *  from growing sets of the best points first ( PROSAC ).
+     */
     template <class Model>
     class RANSAC
     {
@@ -44,99 +63,366 @@ namespace cvt
         typedef typename Model::ResultType   ResultType;
         typedef typename Model::DistanceType DistanceType;
 
+        /**
+         *  \param maxDistance  inlier threshold of the model
+         *  \param outlierProb  accepted probability of missing the best model
+         */
         RANSAC( SampleConsensusModel<Model> & model,
                 DistanceType maxDistance,
                 float outlierProb = 0.05f ) :
-            _model( model ), _maxDistance( maxDistance ), _outlierProb( outlierProb )
+            _model( model ), _maxDistance( maxDistance ), _outlierProb( outlierProb ),
+            _sprt( true ), _seed( 1 ), _numThreads( 0 ), _iterations( 0 )
         {
         }
 
+        /* maxIter = 0 stops only on the adaptive bound, but after at most MAX_ITERATIONS hypotheses */
         ResultType estimate( size_t maxIter = 0 );
 
 		const std::vector<size_t> &  inlierIndices() const { return _lastInliers; }
 
+        /* number of hypotheses of the last estimate() */
+        size_t iterations() const { return _iterations; }
+
+        /* indices of all points sorted by decreasing quality ( e.g. increasing match distance ), empty for uniform sampling */
+        void setSampleOrder( const std::vector<size_t> & order ) { _sampleOrder = order; }
+
+        /* without SPRT every hypothesis is scored until it cannot beat the best one */
+        void setSPRT( bool enable ) { _sprt = enable; }
+        void setSeed( uint32_t seed ) { _seed = seed; }
+
+        /* 0 uses ParallelRows::numThreads() */
+        void setNumThreads( size_t n ) { _numThreads = n; }
+
+        static const size_t MAX_ITERATIONS = 100000;
+
       private:
+        struct Hypothesis {
+            enum State { SCORED, BAILED, REJECTED };
+
+            ResultType model;
+            size_t     subset;      /* PROSAC: sample from the first subset points of the order, 0 for all points */
+            bool       forceLast;   /* PROSAC: always take the last point of the subset */
+            size_t     inliers;
+            size_t     evaluated;
+            State      state;
+        };
+
+        struct SPRT {
+            bool   enabled;
+            double A;
+            double logA;
+            double logConsistent;   /* log( delta / epsilon ) */
+            double logInconsistent; /* log( ( 1 - delta ) / ( 1 - epsilon ) ) */
+        };
+
+        /* splitmix64 */
+        class Random {
+          public:
+            Random( uint64_t seed ) : _state( seed ) {}
+
+            uint64_t next()
+            {
+                uint64_t z = ( _state += 0x9e3779b97f4a7c15ULL );
+                z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+                z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+                return z ^ ( z >> 31 );
+            }
+
+            /* uniform in [ 0, n ) */
+            size_t uniform( size_t n ) { return ( size_t ) ( ( ( next() >> 32 ) * ( uint64_t ) n ) >> 32 ); }
+
+          private:
+            uint64_t _state;
+        };
+
+        class HypothesisRows;
+
+        void   schedule( size_t first, size_t num );
+        void   drawSample( std::vector<size_t> & sample, Random & rng, const Hypothesis & h ) const;
+        void   score( Hypothesis & h, size_t numBest, const SPRT & sprt ) const;
+        size_t requiredIterations( size_t numBest, const SPRT & sprt ) const;
+        static void sprtParameters( SPRT & sprt, double epsilon, double delta );
+
+        static const size_t ROUND_SIZE  = 64;
+        static const size_t BLOCK_SIZE  = 32;
+        /* time to estimate a model in point evaluations */
+        static const size_t MODEL_COST  = 200;
+
         SampleConsensusModel<Model>&  _model;
 
         DistanceType                  _maxDistance;
         float                         _outlierProb;
         std::vector<size_t>           _lastInliers;
 
-        void randomSamples( std::vector<size_t> & indices );
+        bool                          _sprt;
+        uint32_t                      _seed;
+        size_t                        _numThreads;
+        size_t                        _iterations;
+
+        std::vector<size_t>           _sampleOrder;
+        std::vector<size_t>           _evalOrder;
+        std::vector<Hypothesis>       _round;
+
+        /* PROSAC growth function */
+        size_t                        _subset;
+        double                        _Tn;
+        size_t                        _TnPrime;
+    };
+
+    template <class Model> const size_t RANSAC<Model>::MAX_ITERATIONS;
+    template <class Model> const size_t RANSAC<Model>::ROUND_SIZE;
+    template <class Model> const size_t RANSAC<Model>::BLOCK_SIZE;
+    template <class Model> const size_t RANSAC<Model>::MODEL_COST;
+
+    template <class Model>
+    class RANSAC<Model>::HypothesisRows : public ParallelRows::Body
+    {
+      public:
+        HypothesisRows( RANSAC<Model> & ransac, size_t first, size_t numBest, const SPRT & sprt ) :
+            _ransac( ransac ), _first( first ), _numBest( numBest ), _sprt( sprt )
+        {
+        }
+
+        void process( size_t start, size_t end ) const
+        {
+            std::vector<size_t> sample;
+            sample.reserve( _ransac._model.minSampleSize() );
+
+            for( size_t h = start; h < end; h++ ){
+                Hypothesis & hyp = _ransac._round[ h ];
+                /* stream 0 of the seed is used for the evaluation order */
+                Random rng( ( ( uint64_t ) _ransac._seed << 32 ) + _first + h + 1 );
+
+                _ransac.drawSample( sample, rng, hyp );
+                hyp.model = _ransac._model.estimate( sample );
+                _ransac.score( hyp, _numBest, _sprt );
+            }
+        }
+
+      private:
+        RANSAC<Model> & _ransac;
+        size_t          _first;
+        size_t          _numBest;
+        const SPRT &    _sprt;
     };
 
     template<class Model>
     inline typename RANSAC<Model>::ResultType RANSAC<Model>::estimate( size_t maxIter )
     {
-        size_t n = ( size_t )-1;
-        size_t samples = 0;
+        const size_t n = _model.size();
+        const size_t m = _model.minSampleSize();
+
+        if( n < m )
+            throw CVTException( "Not enough points for a minimal sample" );
+        if( !_sampleOrder.empty() && _sampleOrder.size() != n )
+            throw CVTException( "Sample order does not match the number of points" );
+
+        /* with SPRT the points are scored in random order, otherwise it would be biased by sorted data */
+        _evalOrder.resize( n );
+        if( _sprt ){
+            Random rng( ( uint64_t ) _seed << 32 );
+            for( size_t i = 0; i < n; i++ ){
+                size_t j = rng.uniform( i + 1 );
+                _evalOrder[ i ] = _evalOrder[ j ];
+                _evalOrder[ j ] = i;
+            }
+        } else {
+            for( size_t i = 0; i < n; i++ )
+                _evalOrder[ i ] = i;
+        }
 
-        ResultType result;
+        if( !_sampleOrder.empty() ){
+            /* T_m for T_N = 200000 */
+            _Tn = 200000.0;
+            for( size_t i = 0; i < m; i++ )
+                _Tn *= ( double ) ( m - i ) / ( double ) ( n - i );
+            _subset = m;
+            _TnPrime = 1;
+        }
 
-        std::vector<size_t> indices;        
+        double epsilon = 0.1, delta = 0.05;
+        size_t rejectedConsistent = 0, rejectedEvaluated = 0;
+        SPRT sprt;
+        sprt.enabled = false;
+        if( _sprt )
+            sprtParameters( sprt, epsilon, delta );
 
-        std::vector<size_t> bestIndices;
+        const size_t limit = maxIter ? maxIter : MAX_ITERATIONS;
+        size_t needed = limit;
         size_t numBest = 0;
+        size_t t = 0;
+        ResultType best;
 
-        if( maxIter )
-            n = maxIter;
-
-        while( n > samples ){
-            randomSamples( indices );
-            result = _model.estimate( indices );
+        while( t < needed ){
+            size_t num = Math::min( ROUND_SIZE, needed - t );
 
-            _model.inliers( _lastInliers, result, _maxDistance );
+            _round.resize( num );
+            schedule( t, num );
 
-            if( _lastInliers.size() > numBest ){
-                numBest = _lastInliers.size();
-                bestIndices = indices;
+            HypothesisRows body( *this, t, numBest, sprt );
+            ParallelRows::run( body, n + MODEL_COST, num, _numThreads );
 
-                float epsilon = 1.0f - ( float )_lastInliers.size() / ( float )_model.size();
+            if( !t )
+                best = _round[ 0 ].model;
 
-                size_t newn = Math::log( _outlierProb ) / Math::log( 1.0f - Math::pow( 1.0f - epsilon, ( float )_model.minSampleSize() ) );
-
-                if( maxIter > 0 ){
-					if( newn < maxIter ){
-						n = newn;
-					}
-				} else {
-                    n = newn;
-				}
+            for( size_t h = 0; h < num; h++ ){
+                const Hypothesis & hyp = _round[ h ];
+                if( hyp.state == Hypothesis::REJECTED ){
+                    rejectedConsistent += hyp.inliers;
+                    rejectedEvaluated  += hyp.evaluated;
+                } else if( hyp.state == Hypothesis::SCORED && hyp.inliers > numBest ){
+                    numBest = hyp.inliers;
+                    best = hyp.model;
+                }
+            }
+            t += num;
+
+            if( _sprt ){
+                /* epsilon from the best model, delta from the rejected ones */
+                if( numBest )
+                    epsilon = ( double ) numBest / ( double ) n;
+                if( rejectedEvaluated )
+                    delta = Math::max( ( double ) rejectedConsistent / ( double ) rejectedEvaluated, 0.001 );
+                sprtParameters( sprt, epsilon, delta );
             }
 
-
-            samples++;
+            if( numBest )
+                needed = Math::min( limit, Math::max( t, requiredIterations( numBest, sprt ) ) );
         }
+        _iterations = t;
+
+        _model.inliers( _lastInliers, best, _maxDistance );
+        if( _lastInliers.size() < m )
+            return best;
 
-        result = _model.estimate( bestIndices );
-        _model.inliers( _lastInliers, result, _maxDistance );
+        return _model.refine( best, _lastInliers );
+    }
+
+    template<class Model>
+    inline void RANSAC<Model>::schedule( size_t first, size_t num )
+    {
+        const size_t n = _model.size();
+        const size_t m = _model.minSampleSize();
+
+        for( size_t h = 0; h < num; h++ ){
+            Hypothesis & hyp = _round[ h ];
+            if( _sampleOrder.empty() ){
+                hyp.subset = 0;
+                hyp.forceLast = false;
+                continue;
+            }
 
-        return _model.refine( result, _lastInliers );
+            /* PROSAC: grow the subset at sample T'_n, until then the newest point is part of every sample */
+            size_t t = first + h + 1;
+            if( t >= _TnPrime && _subset < n ){
+                double Tn1 = _Tn * ( double ) ( _subset + 1 ) / ( double ) ( _subset + 1 - m );
+                _TnPrime += ( size_t ) Math::ceil( Tn1 - _Tn );
+                _Tn = Tn1;
+                _subset++;
+            }
+            hyp.subset = _subset;
+            hyp.forceLast = _TnPrime >= t;
+        }
     }
 
     template<class Model>
-    inline void RANSAC<Model>::randomSamples( std::vector<size_t> & indices )
+    inline void RANSAC<Model>::drawSample( std::vector<size_t> & sample, Random & rng, const Hypothesis & h ) const
 	{
-        indices.clear();
+        size_t range = h.subset ? h.subset : _model.size();
+        size_t k = _model.minSampleSize();
 
-		size_t idx;
-		while( indices.size() < _model.minSampleSize() ){
-			idx = Math::rand( 0, _model.size() - 1 );
+        if( h.forceLast ){
+            range--;
+            k--;
+        }
 
-            bool insert = true;
-            for( size_t i = 0; i < indices.size(); i++ ){
-                if( idx == indices[ i ] ){
-                    insert = false;
+        /* Floyd's algorithm: k distinct indices out of [ 0, range ) without rejection */
+        sample.clear();
+        for( size_t j = range - k; j < range; j++ ){
+            size_t idx = rng.uniform( j + 1 );
+            if( std::find( sample.begin(), sample.end(), idx ) != sample.end() )
+                idx = j;
+            sample.push_back( idx );
+        }
+
+        if( h.forceLast )
+            sample.push_back( range );
+
+        if( h.subset ){
+            for( size_t i = 0; i < sample.size(); i++ )
+                sample[ i ] = _sampleOrder[ sample[ i ] ];
+        }
+	}
+
+    template<class Model>
+    inline void RANSAC<Model>::score( Hypothesis & h, size_t numBest, const SPRT & sprt ) const
+    {
+        const size_t n = _evalOrder.size();
+        size_t inliers = 0;
+        size_t evaluated = 0;
+        double logLambda = 0.0;
+
+        h.state = Hypothesis::SCORED;
+        while( evaluated < n ){
+            size_t num = Math::min( BLOCK_SIZE, n - evaluated );
+            size_t k = _model.numInliers( h.model, _maxDistance, &_evalOrder[ evaluated ], num );
+            inliers += k;
+            evaluated += num;
+
+            if( inliers + n - evaluated <= numBest ){
+                h.state = Hypothesis::BAILED;
+                break;
+            }
+
+            if( sprt.enabled && evaluated < n ){
+                logLambda += k * sprt.logConsistent + ( num - k ) * sprt.logInconsistent;
+                if( logLambda > sprt.logA ){
+                    h.state = Hypothesis::REJECTED;
                     break;
                 }
             }
+        }
 
-            if( insert ){
-                indices.push_back( idx );
-			}
-		}
-	}
+        h.inliers = inliers;
+        h.evaluated = evaluated;
+    }
+
+    template<class Model>
+    inline size_t RANSAC<Model>::requiredIterations( size_t numBest, const SPRT & sprt ) const
+    {
+        /* probability of an all inlier sample, that is not rejected by SPRT */
+        double p = Math::pow( ( double ) numBest / ( double ) _model.size(), ( double ) _model.minSampleSize() );
+        if( sprt.enabled )
+            p *= 1.0 - 1.0 / sprt.A;
+
+        if( p >= 1.0 )
+            return 0;
+        double k = Math::log( ( double ) _outlierProb ) / Math::log( 1.0 - p );
+        if( !( k < ( double ) MAX_ITERATIONS ) )
+            return MAX_ITERATIONS;
+        return ( size_t ) Math::ceil( k );
+    }
+
+    template<class Model>
+    inline void RANSAC<Model>::sprtParameters( SPRT & sprt, double epsilon, double delta )
+    {
+        sprt.enabled = epsilon > delta && epsilon < 1.0;
+        if( !sprt.enabled )
+            return;
+
+        sprt.logConsistent   = Math::log( delta / epsilon );
+        sprt.logInconsistent = Math::log( ( 1.0 - delta ) / ( 1.0 - epsilon ) );
+
+        /* optimal threshold: A = MODEL_COST * C + 1 + log( A ), C is the Kullback-Leibler divergence of the two hypotheses */
+        double C = ( 1.0 - delta ) * sprt.logInconsistent + delta * sprt.logConsistent;
+        double K = ( double ) MODEL_COST * C;
+        double A = K + 1.0;
+        for( size_t i = 0; i < 10; i++ )
+            A = K + 1.0 + Math::log( A );
+
+        sprt.A = A;
+        sprt.logA = Math::log( A );
+    }
 }
 
 #endif	/* RANSAC_H */
-
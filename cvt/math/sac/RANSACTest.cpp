@@ -0,0 +1,159 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/math/sac/RANSAC.h>
+#include <cvt/math/sac/Line2DSAC.h>
+#include <cvt/math/sac/HomographySAC.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/Time.h>
+
+#include <iostream>
+#include <stdlib.h>
+
+using namespace cvt;
+
+/* points on y = 0.5 x + 3 with a little noise, the rest is uniform in [ 0, 100 ]^2 */
+static void _linePoints( std::vector<Vector2f>& pts, std::vector<size_t>& order, size_t n, size_t numInliers )
+{
+	std::vector<std::pair<float, size_t> > quality;
+	pts.resize( n );
+	for( size_t i = 0; i < n; i++ ) {
+		if( i < numInliers ) {
+			float x = Math::rand( 0.0f, 100.0f );
+			pts[ i ].x = x;
+			pts[ i ].y = 0.5f * x + 3.0f + Math::rand( -0.3f, 0.3f );
+		} else {
+			pts[ i ].x = Math::rand( 0.0f, 100.0f );
+			pts[ i ].y = Math::rand( 0.0f, 100.0f );
+		}
+		/* a quality measure that favors the inliers without separating them */
+		quality.push_back( std::make_pair( Math::rand( 0.0f, 1.0f ) + ( i < numInliers ? 0.3f : 0.0f ), i ) );
+	}
+	std::sort( quality.rbegin(), quality.rend() );
+	order.clear();
+	for( size_t i = 0; i < n; i++ )
+		order.push_back( quality[ i ].second );
+}
+
+static bool _lineOK( const Line2Df& line, const std::vector<size_t>& inliers, size_t numInliers )
+{
+	Line2Df truth( Vector2f( 0.0f, 3.0f ), Vector2f( 100.0f, 53.0f ) );
+	size_t trueInliers = 0;
+	for( size_t i = 0; i < inliers.size(); i++ )
+		trueInliers += inliers[ i ] < numInliers;
+	return trueInliers > numInliers * 0.95f &&
+		   Math::abs( line.distance( Vector2f( 0.0f, 3.0f ) ) ) < 0.2f &&
+		   Math::abs( line.distance( Vector2f( 100.0f, 53.0f ) ) ) < 0.2f;
+}
+
+static bool _lineTest()
+{
+	std::vector<Vector2f> pts;
+	std::vector<size_t> order;
+	const size_t n = 4000, numInliers = 1200;
+	_linePoints( pts, order, n, numInliers );
+
+	Line2DSAC model( pts );
+	bool result = true;
+	for( int sprt = 0; sprt < 2; sprt++ ) {
+		RANSAC<Line2DSAC> ransac( model, 1.0f, 0.01f );
+		ransac.setSPRT( sprt );
+		Line2Df line = ransac.estimate();
+		result &= _lineOK( line, ransac.inlierIndices(), numInliers );
+	}
+	CVTTEST_PRINT( "RANSAC line", result );
+
+	/* the hypotheses only depend on the seed */
+	bool b = true;
+	for( int sprt = 0; sprt < 2; sprt++ ) {
+		RANSAC<Line2DSAC> serial( model, 1.0f, 0.01f ), parallel( model, 1.0f, 0.01f );
+		serial.setSPRT( sprt );
+		parallel.setSPRT( sprt );
+		serial.setSeed( 42 );
+		parallel.setSeed( 42 );
+		serial.setNumThreads( 1 );
+		parallel.setNumThreads( 4 );
+		serial.estimate( 500 );
+		parallel.estimate( 500 );
+		b &= serial.inlierIndices() == parallel.inlierIndices() && serial.iterations() == parallel.iterations();
+	}
+	CVTTEST_PRINT( "RANSAC threaded == serial", b );
+	result &= b;
+
+	RANSAC<Line2DSAC> prosac( model, 1.0f, 0.01f );
+	prosac.setSampleOrder( order );
+	Line2Df line = prosac.estimate();
+	b = _lineOK( line, prosac.inlierIndices(), numInliers );
+	CVTTEST_PRINT( "RANSAC PROSAC", b );
+	result &= b;
+
+	return result;
+}
+
+static void _homographyBenchmark()
+{
+	const size_t n = 5000, numInliers = 1500;
+	Matrix3f H;
+	H.setIdentity();
+	H[ 0 ][ 0 ] = 1.1f;  H[ 0 ][ 1 ] = 0.05f; H[ 0 ][ 2 ] = 10.0f;
+	H[ 1 ][ 0 ] = -0.03f; H[ 1 ][ 1 ] = 0.95f; H[ 1 ][ 2 ] = -5.0f;
+	H[ 2 ][ 0 ] = 1e-4f; H[ 2 ][ 1 ] = -5e-5f;
+
+	std::vector<Feature> f0( n ), f1( n );
+	std::vector<FeatureMatch> matches( n );
+	for( size_t i = 0; i < n; i++ ) {
+		f0[ i ].pt = Vector2f( Math::rand( 0.0f, 640.0f ), Math::rand( 0.0f, 480.0f ) );
+		if( i < numInliers )
+			f1[ i ].pt = H * f0[ i ].pt + Vector2f( Math::rand( -0.5f, 0.5f ), Math::rand( -0.5f, 0.5f ) );
+		else
+			f1[ i ].pt = Vector2f( Math::rand( 0.0f, 640.0f ), Math::rand( 0.0f, 480.0f ) );
+		matches[ i ].feature0 = &f0[ i ];
+		matches[ i ].feature1 = &f1[ i ];
+	}
+
+	HomographySAC model( matches );
+	for( int sprt = 0; sprt < 2; sprt++ ) {
+		for( size_t threads = 1; threads <= 4; threads += 3 ) {
+			RANSAC<HomographySAC> ransac( model, 2.0f, 0.01f );
+			ransac.setSPRT( sprt );
+			ransac.setNumThreads( threads );
+			Time t;
+			ransac.estimate();
+			std::cout << "RANSAC homography " << ( sprt ? "SPRT" : "bail-out" ) << ", " << threads << " thread(s): "
+					  << t.elapsedMilliSeconds() << " ms, " << ransac.iterations() << " hypotheses, "
+					  << ransac.inlierIndices().size() << " inliers" << std::endl;
+		}
+	}
+}
+
+BEGIN_CVTTEST( RANSAC )
+	bool result = true;
+
+	srandom( 2013 );
+	result &= _lineTest();
+	_homographyBenchmark();
+
+	return result;
+END_CVTTEST
@@ -39,6 +39,8 @@ namespace cvt
     /**
      * SampleConsensusModelTraits:
      * -> typedefs on ResultType and DistanceType
+     *
+     * Models are used concurrently by RANSAC, estimate() and numInliers() have to be thread-safe.
      */
     template<class T>
     struct SACModelTraits;
@@ -77,6 +79,14 @@ namespace cvt
             sampleIndices.clear();
             ( ( Derived *)this )->inliers( sampleIndices, estimate, maxDistance );
         }
+
+        /* number of inliers among the points indices[ 0 ] ... indices[ n - 1 ], used for scoring blocks of points */
+        size_t numInliers( const ResultType & estimate,
+                           const DistanceType maxDistance,
+                           const size_t* indices, size_t n ) const
+        {
+            return ( ( Derived *)this )->numInliers( estimate, maxDistance, indices, n );
+        }
     };
 }
 
@@ -47,6 +47,7 @@ namespace cvt {
 			float				  entropy() const;
 
 			void				  addSample( size_t classLabel );
+			void				  addSamples( size_t classLabel, size_t n );
 			size_t				  sampleCount() const;
 			void				  clear();
 
@@ -127,6 +128,13 @@ namespace cvt {
 		_numSamples++;
 	}
 
+	template<size_t N>
+	inline void RDFClassHistogram<N>::addSamples( size_t classLabel, size_t n )
+	{
+		_bin[ classLabel ] += n;
+		_numSamples += n;
+	}
+
 	template<size_t N>
 	inline void RDFClassHistogram<N>::clear()
 	{
@@ -26,36 +26,233 @@
 #define CVT_RDFORESTTRAINERCLASSIFICATION_H
 
 #include <vector>
+#include <algorithm>
+#include <stdint.h>
 #include <cvt/ml/rdf/RDFNode.h>
 #include <cvt/ml/rdf/RDFTest.h>
 #include <cvt/ml/rdf/RDFClassHistogram.h>
 #include <cvt/ml/rdf/RDFClassificationTree.h>
+#include <cvt/ml/rdf/RDFClassifier.h>
+#include <cvt/util/ThreadPool.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/Mutex.h>
+#include <cvt/util/Time.h>
 
 namespace cvt {
 
+	/**
+	 *	\class RDFClassificationTrainer
+	 *	\brief Greedy information gain training of classification trees.
+	 *
+	 *	The trees of a forest and the two subtrees of large nodes are trained as independent
+	 *	ThreadPool tasks, the candidate tests of large nodes are evaluated in parallel.
+	 *	Subtrees are only forked and candidates only spread while fewer than setNumThreads()
+	 *	threads are busy training.
+	 *	All samples of a tree share one index array, every node owns a range of it and
+	 *	partitions it in place for its children.
+	 *	Every node draws its candidate tests from its own Random, seeded by its parent, so the
+	 *	trained trees only depend on the seed and not on the number of threads.
+	 *	dataSize(), classLabel(), trainingData() and randomTest() are called concurrently.
+	 */
 	template<typename DATA, typename DATACOLLECTION, size_t N>
 	class RDFClassificationTrainer
 	{
 		public:
+			/* splitmix64 */
+			class Random {
+				public:
+					Random( uint64_t seed ) : _state( seed ) {}
+
+					uint64_t next()
+					{
+						uint64_t z = ( _state += 0x9e3779b97f4a7c15ULL );
+						z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+						z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+						return z ^ ( z >> 31 );
+					}
+
+					/* uniform in [ 0, n ) */
+					size_t uniform( size_t n ) { return ( size_t ) ( ( ( next() >> 32 ) * ( uint64_t ) n ) >> 32 ); }
+
+					/* uniform in [ min, max ) */
+					float  uniform( float min, float max ) { return min + ( max - min ) * ( float ) ( next() >> 40 ) * ( 1.0f / 16777216.0f ); }
+
+				private:
+					uint64_t _state;
+			};
+
+			/* accumulated over all nodes of a depth, depth 0 is the root */
+			struct LevelStatistics {
+				LevelStatistics() : nodes( 0 ), leaves( 0 ), samples( 0 ), informationGain( 0.0f ), seconds( 0.0 ) {}
+
+				size_t nodes;
+				size_t leaves;
+				size_t samples;
+				float  informationGain;	/* sum over the split nodes */
+				double seconds;			/* time spent in the nodes, summed over all threads */
+			};
+
 			RDFClassificationTrainer();
-			~RDFClassificationTrainer();
+			virtual ~RDFClassificationTrainer();
 
 			size_t				   classCount() const { return N; }
-			virtual size_t		   dataSize( const DATACOLLECTION& data ) = 0;
-			virtual RDFTest<DATA>* randomTest() = 0;
-			virtual size_t		   classLabel( const DATACOLLECTION& data, size_t index ) = 0;
-			virtual DATA&		   trainingData( const DATACOLLECTION& data, size_t index ) = 0;
+			virtual size_t		   dataSize( const DATACOLLECTION& data ) const = 0;
+			virtual RDFTest<DATA>* randomTest( Random& rng ) const = 0;
+			virtual size_t		   classLabel( const DATACOLLECTION& data, size_t index ) const = 0;
+			virtual const DATA&	   trainingData( const DATACOLLECTION& data, size_t index ) const = 0;
+
+			void				   setSeed( uint64_t seed ) { _seed = seed; }
+			/* maximum number of busy threads, 0 uses the ThreadPool size, 1 trains on the calling thread */
+			void				   setNumThreads( size_t n ) { _numThreads = n; }
 
 			RDFClassificationTree<DATA,N>* train( const DATACOLLECTION& data, size_t maxdepth, size_t randTries );
+			void						   train( RDFClassifier<DATA,N>& forest, const DATACOLLECTION& data, size_t numTrees, size_t maxdepth, size_t randTries );
+
+			/* statistics of the last train() call */
+			const std::vector<LevelStatistics>& statistics() const { return _statistics; }
 
 		private:
-			RDFNode<DATA,RDFClassHistogram<N> >* trainRecursive( const DATACOLLECTION& data, const RDFClassHistogram<N>& hist, std::vector<size_t>& indices, size_t level, size_t randTries );
+			typedef RDFNode<DATA,RDFClassHistogram<N> > Node;
+
+			class TreeTask;
+			class NodeTask;
+			class CandidateRows;
+
+			void	 prepare( const DATACOLLECTION& data, size_t maxdepth );
+			Node*	 trainTree( size_t tree, size_t maxdepth, size_t randTries );
+			Node*	 trainNode( size_t* indices, size_t n, const size_t* hist, size_t level, size_t depth, uint64_t seed, size_t randTries );
+			Node*	 leaf( const size_t* hist, size_t n, size_t depth, const Time& time );
+			void	 record( size_t depth, bool leaf, size_t n, float gain, const Time& time );
+			size_t	 numThreads() const;
+			bool	 reserveThread();
+			void	 releaseThread();
+
+			static float entropy( const size_t* hist, size_t n );
+
+			/* nodes with less samples are trained serially */
+			static const size_t PARALLEL_SAMPLES = 4096;
 
-			static float IG( const RDFClassHistogram<N>& parent, const RDFClassHistogram<N>& left, const RDFClassHistogram<N>& right );
+			uint64_t					 _seed;
+			size_t						 _numThreads;
+			size_t						 _busyThreads;	/* threads training trees or subtrees, atomic */
+
+			/* copies of the training set for the current train() call */
+			std::vector<const DATA*>	 _samples;
+			std::vector<size_t>			 _labels;
+
+			Mutex						 _statisticsMutex;
+			std::vector<LevelStatistics> _statistics;
 	};
 
 	template<typename DATA, typename DATACOLLECTION, size_t N>
-	inline RDFClassificationTrainer<DATA,DATACOLLECTION,N>::RDFClassificationTrainer()
+	const size_t RDFClassificationTrainer<DATA,DATACOLLECTION,N>::PARALLEL_SAMPLES;
+
+	/* class counts of the candidate tests, 2 * N per test: test false / left first */
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	class RDFClassificationTrainer<DATA,DATACOLLECTION,N>::CandidateRows : public ParallelRows::Body {
+		public:
+			CandidateRows( size_t* counts, RDFTest<DATA>* const* tests, const DATA* const* samples, const size_t* labels, size_t n ) :
+				_counts( counts ), _tests( tests ), _samples( samples ), _labels( labels ), _n( n )
+			{
+			}
+
+			void process( size_t start, size_t end ) const
+			{
+				for( size_t t = start; t < end; t++ ) {
+					size_t* counts = _counts + t * 2 * N;
+					for( size_t c = 0; c < 2 * N; c++ )
+						counts[ c ] = 0;
+
+					const RDFTest<DATA>& test = *_tests[ t ];
+					for( size_t i = 0; i < _n; i++ )
+						counts[ ( test( *_samples[ i ] ) ? N : 0 ) + _labels[ i ] ]++;
+				}
+			}
+
+		private:
+			size_t*				  _counts;
+			RDFTest<DATA>* const* _tests;
+			const DATA* const*	  _samples;
+			const size_t*		  _labels;
+			size_t				  _n;
+	};
+
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	class RDFClassificationTrainer<DATA,DATACOLLECTION,N>::NodeTask : public ThreadPool::Task {
+		public:
+			NodeTask() : _result( NULL ) {}
+
+			void set( RDFClassificationTrainer<DATA,DATACOLLECTION,N>* trainer, size_t* indices, size_t n, const size_t* hist,
+					  size_t level, size_t depth, uint64_t seed, size_t randTries )
+			{
+				_trainer = trainer;
+				_indices = indices;
+				_n = n;
+				_hist = hist;
+				_level = level;
+				_depth = depth;
+				_seed = seed;
+				_randTries = randTries;
+			}
+
+			void execute()
+			{
+				_result = _trainer->trainNode( _indices, _n, _hist, _level, _depth, _seed, _randTries );
+			}
+
+			Node* result() const { return _result; }
+
+		private:
+			RDFClassificationTrainer<DATA,DATACOLLECTION,N>* _trainer;
+			size_t*			_indices;
+			size_t			_n;
+			const size_t*	_hist;
+			size_t			_level;
+			size_t			_depth;
+			uint64_t		_seed;
+			size_t			_randTries;
+			Node*			_result;
+	};
+
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	class RDFClassificationTrainer<DATA,DATACOLLECTION,N>::TreeTask : public ThreadPool::Task {
+		public:
+			TreeTask() : _results( NULL ) {}
+
+			/* trains the trees first, first + step, ... < numTrees */
+			void set( RDFClassificationTrainer<DATA,DATACOLLECTION,N>* trainer, size_t first, size_t step, size_t numTrees,
+					  size_t maxdepth, size_t randTries, Node** results )
+			{
+				_trainer = trainer;
+				_first = first;
+				_step = step;
+				_numTrees = numTrees;
+				_maxdepth = maxdepth;
+				_randTries = randTries;
+				_results = results;
+			}
+
+			void execute()
+			{
+				for( size_t t = _first; t < _numTrees; t += _step )
+					_results[ t ] = _trainer->trainTree( t, _maxdepth, _randTries );
+			}
+
+		private:
+			RDFClassificationTrainer<DATA,DATACOLLECTION,N>* _trainer;
+			size_t _first;
+			size_t _step;
+			size_t _numTrees;
+			size_t _maxdepth;
+			size_t _randTries;
+			Node** _results;
+	};
+
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	inline RDFClassificationTrainer<DATA,DATACOLLECTION,N>::RDFClassificationTrainer() :
+		_seed( 0 ),
+		_numThreads( 0 ),
+		_busyThreads( 0 )
 	{
 	}
 
@@ -64,145 +261,237 @@ namespace cvt {
 	{
 	}
 
-
 	template<typename DATA, typename DATACOLLECTION, size_t N>
-	inline float RDFClassificationTrainer<DATA,DATACOLLECTION,N>::IG( const RDFClassHistogram<N>& parent, const RDFClassHistogram<N>& left, const RDFClassHistogram<N>& right )
+	inline float RDFClassificationTrainer<DATA,DATACOLLECTION,N>::entropy( const size_t* hist, size_t n )
 	{
-		float entropyParent = parent.entropy();
-		size_t allSamples = left.sampleCount() + right.sampleCount();
+		float ret = 0.0f;
+		if( !n )
+			return ret;
+
+		float scale = 1.0f / ( float ) n;
+		for( size_t i = 0; i < N; i++ ) {
+			if( hist[ i ] ) {
+				float p = ( float ) hist[ i ] * scale;
+				ret -= p * Math::log2( p );
+			}
+		}
+		return ret;
+	}
 
-		if( allSamples <= 1 )
-			return 0.0;
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	inline size_t RDFClassificationTrainer<DATA,DATACOLLECTION,N>::numThreads() const
+	{
+		return _numThreads ? _numThreads : ThreadPool::instance().numThreads();
+	}
 
-		float entropyChildren = ( left.sampleCount() * left.entropy() + right.sampleCount() * right.entropy()) / allSamples;
-		return entropyParent - entropyChildren;
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	inline bool RDFClassificationTrainer<DATA,DATACOLLECTION,N>::reserveThread()
+	{
+		if( __sync_add_and_fetch( &_busyThreads, 1 ) <= numThreads() )
+			return true;
+		__sync_sub_and_fetch( &_busyThreads, 1 );
+		return false;
 	}
 
 	template<typename DATA, typename DATACOLLECTION, size_t N>
-	inline RDFClassificationTree<DATA,N>* RDFClassificationTrainer<DATA,DATACOLLECTION,N>::train( const DATACOLLECTION& data, size_t level, size_t randTries )
+	inline void RDFClassificationTrainer<DATA,DATACOLLECTION,N>::releaseThread()
 	{
-		RDFTest<DATA>* best = NULL;
-		RDFNode<DATA,RDFClassHistogram<N> >* left;
-		RDFNode<DATA,RDFClassHistogram<N> >* right;
-		float IGmax = 0.0f;
-		RDFClassHistogram<N> histparent, histleft, histright;
-		RDFClassHistogram<N> histbestleft, histbestright;
+		__sync_sub_and_fetch( &_busyThreads, 1 );
+	}
 
-		// get histogram for the root
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	inline void RDFClassificationTrainer<DATA,DATACOLLECTION,N>::prepare( const DATACOLLECTION& data, size_t maxdepth )
+	{
 		const size_t size = dataSize( data );
+		if( !size )
+			throw CVTException( "No training data" );
+
+		_samples.resize( size );
+		_labels.resize( size );
 		for( size_t i = 0; i < size; i++ ) {
-			histparent.addSample( classLabel( data, i ) );
+			_samples[ i ] = &trainingData( data, i );
+			_labels[ i ] = classLabel( data, i );
+			if( _labels[ i ] >= N )
+				throw CVTException( "Class label out of range" );
 		}
 
-		for( size_t t = 0; t < randTries; t++ ) {
-			// new random test
-			RDFTest<DATA>* test = randomTest();
-			histright.clear();
-			histleft.clear();
-
-			for( size_t i = 0; i < size; i++ ) {
-				if( test->operator()( trainingData( data, i ) ) ) {
-					histright.addSample( classLabel( data, i ) );
-				} else {
-					histleft.addSample( classLabel( data, i ) );
-				}
-			}
+		_statistics.clear();
+		_statistics.resize( maxdepth + 1 );
+	}
 
-			// how good is the information gain
-			// keep the best otherwise die like the rest
-			float ig = IG( histparent, histleft, histright);
-			if( ig > IGmax ) {
-				IGmax = ig;
-				if( best )
-					delete best;
-				best = test;
-				histbestleft = histleft;
-				histbestright = histright;
-				std::cout << ( 100.0f * ( float ) t / ( float ) randTries) << " \%  IG:" << IGmax << std::endl;
-			} else {
-				delete test;
-			}
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	inline RDFClassificationTree<DATA,N>* RDFClassificationTrainer<DATA,DATACOLLECTION,N>::train( const DATACOLLECTION& data, size_t maxdepth, size_t randTries )
+	{
+		prepare( data, maxdepth );
+		_busyThreads = 1;
+		Node* root = trainTree( 0, maxdepth, randTries );
+		_samples.clear();
+		_labels.clear();
+		return new RDFClassificationTree<DATA,N>( root );
+	}
+
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	inline void RDFClassificationTrainer<DATA,DATACOLLECTION,N>::train( RDFClassifier<DATA,N>& forest, const DATACOLLECTION& data, size_t numTrees, size_t maxdepth, size_t randTries )
+	{
+		prepare( data, maxdepth );
+
+		/* at most one task per thread, each trains every numTasks-th tree */
+		size_t numTasks = Math::min( numTrees, numThreads() );
+		std::vector<Node*> roots( numTrees, ( Node* ) NULL );
+		std::vector<TreeTask> trees( numTasks );
+		std::vector<ThreadPool::Task*> tasks( numTasks );
+		for( size_t i = 0; i < numTasks; i++ ) {
+			trees[ i ].set( this, i, numTasks, numTrees, maxdepth, randTries, &roots[ 0 ] );
+			tasks[ i ] = &trees[ i ];
 		}
 
-		// split the data into two sets containing the indices
-		std::vector<size_t> leftindices, rightindices;
-		for( size_t i = 0; i < size; i++ ) {
-			if( best->operator()( trainingData( data, i ) ) ) {
-				rightindices.push_back( i );
-			} else {
-				leftindices.push_back( i );
-			}
+		_busyThreads = numTasks;
+		if( numTasks > 1 ) {
+			ThreadPool::instance().run( &tasks[ 0 ], numTasks );
+		} else if( numTasks ) {
+			trees[ 0 ].execute();
 		}
 
-		left  = trainRecursive( data, histbestleft, leftindices, level - 1, randTries );
-		right = trainRecursive( data, histbestright, rightindices, level - 1, randTries );
-		return new RDFClassificationTree<DATA,N>( new RDFNode<DATA,RDFClassHistogram<N> >( NULL, best, left, right ) );
+		for( size_t t = 0; t < numTrees; t++ )
+			forest.addTree( new RDFClassificationTree<DATA,N>( roots[ t ] ) );
+
+		_samples.clear();
+		_labels.clear();
 	}
 
 	template<typename DATA, typename DATACOLLECTION, size_t N>
-	inline RDFNode<DATA,RDFClassHistogram<N> >* RDFClassificationTrainer<DATA,DATACOLLECTION,N>::trainRecursive( const DATACOLLECTION& data, const RDFClassHistogram<N>& hist, std::vector<size_t>& indices, size_t level, size_t randTries )
+	inline typename RDFClassificationTrainer<DATA,DATACOLLECTION,N>::Node* RDFClassificationTrainer<DATA,DATACOLLECTION,N>::trainTree( size_t tree, size_t maxdepth, size_t randTries )
 	{
-		RDFTest<DATA>* best = NULL;
-		RDFNode<DATA,RDFClassHistogram<N> >* left;
-		RDFNode<DATA,RDFClassHistogram<N> >* right;
-		float IGmax = 0.0f;
-		RDFClassHistogram<N> histparent, histleft, histright;
-		RDFClassHistogram<N> histbestleft, histbestright;
+		const size_t size = _samples.size();
+		std::vector<size_t> indices( size );
+		size_t hist[ N ] = { 0 };
+		for( size_t i = 0; i < size; i++ ) {
+			indices[ i ] = i;
+			hist[ _labels[ i ] ]++;
+		}
+
+		Random rng( _seed ^ ( 0xd1b54a32d192ed03ULL * ( tree + 1 ) ) );
+		return trainNode( &indices[ 0 ], size, hist, maxdepth, 0, rng.next(), randTries );
+	}
 
-		if( !level ) {
-			return new RDFNode<DATA,RDFClassHistogram<N> >( new RDFClassHistogram<N>( hist ), NULL, NULL, NULL );
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	inline typename RDFClassificationTrainer<DATA,DATACOLLECTION,N>::Node* RDFClassificationTrainer<DATA,DATACOLLECTION,N>::trainNode( size_t* indices, size_t n,
+																																 const size_t* hist, size_t level, size_t depth,
+																																 uint64_t seed, size_t randTries )
+	{
+		Time time;
+		if( !level || n < 2 || !randTries )
+			return leaf( hist, n, depth, time );
+
+		/* gather the samples of the node, the candidates run over contiguous arrays */
+		std::vector<const DATA*> samples( n );
+		std::vector<size_t> labels( n );
+		for( size_t i = 0; i < n; i++ ) {
+			samples[ i ] = _samples[ indices[ i ] ];
+			labels[ i ] = _labels[ indices[ i ] ];
 		}
 
-		const size_t size = indices.size();
-		for( size_t t = 0; t < randTries; t++ ) {
-			// new random test
-			RDFTest<DATA>* test = randomTest();
-			histright.clear();
-			histleft.clear();
-
-			for( size_t i = 0; i < size; i++ ) {
-				size_t idx = indices[ i ];
-				if( test->operator()( trainingData( data, idx ) ) ) {
-					histright.addSample( classLabel( data, idx ) );
-				} else {
-					histleft.addSample( classLabel( data, idx ) );
-				}
-			}
+		Random rng( seed );
+		std::vector<RDFTest<DATA>*> tests( randTries );
+		for( size_t t = 0; t < randTries; t++ )
+			tests[ t ] = randomTest( rng );
+
+		std::vector<size_t> counts( randTries * 2 * N );
+		CandidateRows body( &counts[ 0 ], &tests[ 0 ], &samples[ 0 ], &labels[ 0 ], n );
+		/* spread over the threads not busy with other subtrees */
+		size_t busy = __sync_add_and_fetch( &_busyThreads, 0 );
+		ParallelRows::run( body, n, randTries, busy < numThreads() ? numThreads() - busy + 1 : 1 );
 
-			// how good is the information gain
-			// keep the best otherwise die like the rest
-			float ig = IG( hist, histleft, histright);
+		// keep the test with the best information gain, the first one on ties
+		float entropyParent = entropy( hist, n );
+		float IGmax = 0.0f;
+		size_t best = randTries;
+		for( size_t t = 0; t < randTries; t++ ) {
+			const size_t* left = &counts[ t * 2 * N ];
+			const size_t* right = left + N;
+			size_t nleft = 0;
+			for( size_t c = 0; c < N; c++ )
+				nleft += left[ c ];
+			size_t nright = n - nleft;
+			if( !nleft || !nright )
+				continue;
+
+			float ig = entropyParent - ( nleft * entropy( left, nleft ) + nright * entropy( right, nright ) ) / ( float ) n;
 			if( ig > IGmax ) {
 				IGmax = ig;
-				if( best )
-					delete best;
-				best = test;
-				histbestleft = histleft;
-				histbestright = histright;
-				std::cout << ( 100.0f * ( float ) t / ( float ) randTries) << " \%  IG:" << IGmax << " Level: " << level << std::endl;
-			} else {
-				delete test;
+				best = t;
 			}
 		}
 
-		if( !best ) {
-			return new RDFNode<DATA,RDFClassHistogram<N> >( new RDFClassHistogram<N>( hist ), NULL, NULL, NULL );
+		for( size_t t = 0; t < randTries; t++ ) {
+			if( t != best )
+				delete tests[ t ];
+		}
+
+		if( best == randTries )
+			return leaf( hist, n, depth, time );
+
+		// partition the index range in place, the samples failing the test go to the left
+		const RDFTest<DATA>& test = *tests[ best ];
+		size_t nleft = 0, end = n;
+		while( nleft < end ) {
+			if( test( *_samples[ indices[ nleft ] ] ) )
+				std::swap( indices[ nleft ], indices[ --end ] );
+			else
+				nleft++;
 		}
 
-		// split the data into two sets containing the indices
-		std::vector<size_t> leftindices, rightindices;
-		for( size_t i = 0; i < size; i++ ) {
-			size_t idx = indices[ i ];
-			if( best->operator()( trainingData( data, idx ) ) ) {
-				rightindices.push_back( idx );
-			} else {
-				leftindices.push_back( idx );
-			}
+		size_t histchildren[ 2 * N ];
+		for( size_t c = 0; c < 2 * N; c++ )
+			histchildren[ c ] = counts[ best * 2 * N + c ];
+		uint64_t seedleft = rng.next();
+		uint64_t seedright = rng.next();
+
+		record( depth, false, n, IGmax, time );
+		/* free the gather buffers before the recursion, clear() would keep them allocated on every level */
+		std::vector<const DATA*>().swap( samples );
+		std::vector<size_t>().swap( labels );
+		std::vector<size_t>().swap( counts );
+
+		NodeTask children[ 2 ];
+		children[ 0 ].set( this, indices, nleft, histchildren, level - 1, depth + 1, seedleft, randTries );
+		children[ 1 ].set( this, indices + nleft, n - nleft, histchildren + N, level - 1, depth + 1, seedright, randTries );
+
+		/* the calling thread trains one of the subtrees, the other one needs another thread */
+		if( n >= PARALLEL_SAMPLES && reserveThread() ) {
+			ThreadPool::Task* tasks[ 2 ] = { &children[ 0 ], &children[ 1 ] };
+			ThreadPool::instance().run( tasks, 2 );
+			releaseThread();
+		} else {
+			children[ 0 ].execute();
+			children[ 1 ].execute();
 		}
 
-		left  = trainRecursive( data, histbestleft, leftindices, level - 1, randTries );
-		right = trainRecursive( data, histbestright, rightindices, level - 1, randTries );
-		return new RDFNode<DATA,RDFClassHistogram<N> >( NULL, best, left, right );
+		return new Node( NULL, tests[ best ], children[ 0 ].result(), children[ 1 ].result() );
+	}
+
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	inline typename RDFClassificationTrainer<DATA,DATACOLLECTION,N>::Node* RDFClassificationTrainer<DATA,DATACOLLECTION,N>::leaf( const size_t* hist, size_t n, size_t depth, const Time& time )
+	{
+		RDFClassHistogram<N>* data = new RDFClassHistogram<N>();
+		for( size_t c = 0; c < N; c++ )
+			data->addSamples( c, hist[ c ] );
+		record( depth, true, n, 0.0f, time );
+		return new Node( data, NULL, NULL, NULL );
+	}
+
+	template<typename DATA, typename DATACOLLECTION, size_t N>
+	inline void RDFClassificationTrainer<DATA,DATACOLLECTION,N>::record( size_t depth, bool leaf, size_t n, float gain, const Time& time )
+	{
+		double seconds = time.elapsedSeconds();
+		_statisticsMutex.lock();
+		LevelStatistics& stats = _statistics[ depth ];
+		stats.nodes++;
+		stats.leaves += leaf;
+		stats.samples += n;
+		stats.informationGain += gain;
+		stats.seconds += seconds;
+		_statisticsMutex.unlock();
 	}
 
 }
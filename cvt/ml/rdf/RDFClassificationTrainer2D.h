@@ -39,7 +39,7 @@ namespace cvt {
 			public:
 				RDFTestLinear2D( const Vector2f& vec, float threshold  ) : _norm( vec ), _threshold( threshold ) {}
 
-				bool operator()( const Vector2f& other )
+				bool operator()( const Vector2f& other ) const
 				{
 					return Math::abs( _norm.x *  other.x + _norm.y * other.y ) < _threshold;
 				}
@@ -60,26 +60,26 @@ namespace cvt {
 				{
 				}
 
-				virtual size_t dataSize( const std::vector<Vector3f>& data )
+				virtual size_t dataSize( const std::vector<Vector3f>& data ) const
 				{
 					return data.size();
 				}
 
-				virtual RDFTest<Vector2f>*  randomTest()
+				virtual RDFTest<Vector2f>*  randomTest( Random& rng ) const
 				{
-					float x = Math::rand( -1.0f, 1.0f );
+					float x = rng.uniform( -1.0f, 1.0f );
 					float y = Math::sqrt( 1.0f - Math::sqr( x ) );
-					return new RDFTestLinear2D( Vector2f( x, y ), Math::rand( -10000.0f, 10000.0f  ) );
+					return new RDFTestLinear2D( Vector2f( x, y ), rng.uniform( -10000.0f, 10000.0f  ) );
 				}
 
-				virtual size_t classLabel( const std::vector<Vector3f>& data, size_t index )
+				virtual size_t classLabel( const std::vector<Vector3f>& data, size_t index ) const
 				{
 					return ( size_t ) data[ index ].z;
 				}
 
 
-				virtual Vector2f& trainingData(  const std::vector<Vector3f>& data, size_t index ) {
-					return *( ( Vector2f*) ( &data[ index ] ) );
+				virtual const Vector2f& trainingData(  const std::vector<Vector3f>& data, size_t index ) const {
+					return *( ( const Vector2f*) ( &data[ index ] ) );
 				}
 
 				static void visualizeClassifier( Image& dst, const RDFClassifier<Vector2f,2>& classifier, const Rectf& range, size_t width, size_t height );
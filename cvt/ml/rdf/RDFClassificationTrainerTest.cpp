@@ -0,0 +1,182 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/ml/rdf/RDFClassificationTrainer2D.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/Time.h>
+
+#include <iostream>
+
+using namespace cvt;
+
+/* same data layout as RDFClassificationTrainer2D, but with thresholds matching the data */
+class RDFTrainerTest2D : public RDFClassificationTrainer<Vector2f,std::vector<Vector3f>,2>
+{
+	public:
+		size_t dataSize( const std::vector<Vector3f>& data ) const { return data.size(); }
+
+		RDFTest<Vector2f>* randomTest( Random& rng ) const
+		{
+			float angle = rng.uniform( 0.0f, Math::TWO_PI );
+			return new RDFTestLinear2D( Vector2f( Math::cos( angle ), Math::sin( angle ) ), rng.uniform( 0.0f, 1.5f ) );
+		}
+
+		size_t classLabel( const std::vector<Vector3f>& data, size_t index ) const { return ( size_t ) data[ index ].z; }
+
+		const Vector2f& trainingData( const std::vector<Vector3f>& data, size_t index ) const
+		{
+			return *( ( const Vector2f* ) &data[ index ] );
+		}
+};
+
+typedef RDFNode<Vector2f,RDFClassHistogram<2> > Node2D;
+
+/* points in [ -1, 1 ]^2, class 1 inside the ring 0.3 < |p| < 0.7 */
+static void _ringData( std::vector<Vector3f>& data, size_t n )
+{
+	data.resize( n );
+	for( size_t i = 0; i < n; i++ ) {
+		Vector2f pt( Math::rand( -1.0f, 1.0f ), Math::rand( -1.0f, 1.0f ) );
+		float r = pt.length();
+		data[ i ] = Vector3f( pt.x, pt.y, ( r > 0.3f && r < 0.7f ) ? 1.0f : 0.0f );
+	}
+}
+
+static bool _equal( const Node2D* a, const Node2D* b )
+{
+	if( a->isLeaf() != b->isLeaf() )
+		return false;
+	if( a->isLeaf() )
+		return a->data()->sampleCount() == b->data()->sampleCount() && a->data()->probability( 1 ) == b->data()->probability( 1 );
+
+	/* the tests have to agree on a set of probe points */
+	for( float y = -1.0f; y <= 1.0f; y += 0.05f ) {
+		for( float x = -1.0f; x <= 1.0f; x += 0.05f ) {
+			if( ( *a->test() )( Vector2f( x, y ) ) != ( *b->test() )( Vector2f( x, y ) ) )
+				return false;
+		}
+	}
+	return _equal( a->left(), b->left() ) && _equal( a->right(), b->right() );
+}
+
+static void _deleteTree( const Node2D* node )
+{
+	if( !node->isLeaf() ) {
+		_deleteTree( node->left() );
+		_deleteTree( node->right() );
+	}
+	delete node->data();
+	delete node->test();
+	delete node;
+}
+
+static void _deleteForest( RDFClassifier<Vector2f,2>& rdf )
+{
+	for( size_t t = 0; t < rdf.treeCount(); t++ ) {
+		_deleteTree( rdf.tree( t ).root() );
+		delete &rdf.tree( t );
+	}
+}
+
+static float _accuracy( const RDFClassifier<Vector2f,2>& rdf, const std::vector<Vector3f>& data )
+{
+	RDFClassHistogram<2> hist;
+	size_t correct = 0;
+	for( size_t i = 0; i < data.size(); i++ ) {
+		rdf.classify( hist, Vector2f( data[ i ].x, data[ i ].y ) );
+		correct += ( hist.probability( 1 ) > 0.5f ) == ( data[ i ].z > 0.5f );
+	}
+	return ( float ) correct / ( float ) data.size();
+}
+
+static void _benchmark()
+{
+	std::vector<Vector3f> data;
+	_ringData( data, 200000 );
+
+	for( size_t threads = 1; threads <= 4; threads += 3 ) {
+		RDFTrainerTest2D trainer;
+		RDFClassifier<Vector2f,2> rdf;
+		trainer.setNumThreads( threads );
+		Time time;
+		trainer.train( rdf, data, 4, 12, 100 );
+		std::cout << "RDF training 200000 samples, 4 trees of depth 12, 100 tests per node, " << threads << " thread(s): "
+				  << time.elapsedMilliSeconds() << " ms" << std::endl;
+		if( threads > 1 ) {
+			for( size_t d = 0; d < trainer.statistics().size(); d++ ) {
+				const RDFTrainerTest2D::LevelStatistics& stats = trainer.statistics()[ d ];
+				std::cout << "  depth " << d << ": " << stats.nodes << " nodes, " << stats.leaves << " leaves, "
+						  << stats.samples << " samples, IG " << stats.informationGain << ", " << stats.seconds * 1000.0 << " ms" << std::endl;
+			}
+		}
+		_deleteForest( rdf );
+	}
+}
+
+BEGIN_CVTTEST( RDFClassificationTrainer )
+	bool result = true;
+
+	srandom( 2013 );
+	std::vector<Vector3f> data, testdata;
+	_ringData( data, 20000 );
+	_ringData( testdata, 5000 );
+
+	RDFTrainerTest2D trainer;
+	RDFClassifier<Vector2f,2> serial, parallel;
+	trainer.setSeed( 42 );
+	trainer.setNumThreads( 1 );
+	trainer.train( serial, data, 3, 10, 50 );
+
+	trainer.setNumThreads( 4 );
+	trainer.train( parallel, data, 3, 10, 50 );
+
+	bool b = true;
+	for( size_t t = 0; t < 3; t++ )
+		b &= _equal( serial.tree( t ).root(), parallel.tree( t ).root() );
+	b &= !_equal( serial.tree( 0 ).root(), serial.tree( 1 ).root() );
+	CVTTEST_PRINT( "RDFClassificationTrainer threaded == serial", b );
+	result &= b;
+
+	/* every split node has two children on the next level */
+	const std::vector<RDFTrainerTest2D::LevelStatistics>& stats = trainer.statistics();
+	b = stats.size() == 11 && stats[ 0 ].nodes == 3 && stats[ 0 ].samples == 3 * data.size() && stats[ 10 ].nodes == stats[ 10 ].leaves;
+	for( size_t d = 1; d < stats.size(); d++ )
+		b &= stats[ d ].nodes == 2 * ( stats[ d - 1 ].nodes - stats[ d - 1 ].leaves ) && stats[ d ].samples <= stats[ d - 1 ].samples;
+	CVTTEST_PRINT( "RDFClassificationTrainer statistics", b );
+	result &= b;
+
+	float accuracy = _accuracy( serial, testdata );
+	b = accuracy > 0.95f;
+	CVTTEST_PRINT( "RDFClassificationTrainer accuracy", b );
+	std::cout << "accuracy: " << accuracy << std::endl;
+	result &= b;
+
+	_deleteForest( serial );
+	_deleteForest( parallel );
+
+	_benchmark();
+
+	return result;
+END_CVTTEST
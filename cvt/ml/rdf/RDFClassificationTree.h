@@ -37,6 +37,7 @@ namespace cvt {
 			~RDFClassificationTree();
 
 			const RDFClassHistogram<N>& classify( const DATA& d );
+			const RDFNode<DATA,RDFClassHistogram<N> >* root() const { return _root; }
 		private:
 			RDFClassificationTree( const RDFClassificationTree<DATA,N>& );
 
@@ -37,6 +37,7 @@ namespace cvt {
 
 			void    addTree( RDFClassificationTree<DATA,N>* tree );
 			size_t  treeCount() const;
+			const RDFClassificationTree<DATA,N>& tree( size_t i ) const { return *_trees[ i ]; }
 
 			void    classify( RDFClassHistogram<N>& classhist, const DATA& data ) const;
 
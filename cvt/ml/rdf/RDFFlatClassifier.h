@@ -0,0 +1,321 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_RDFFLATCLASSIFIER_H
+#define CVT_RDFFLATCLASSIFIER_H
+
+#include <vector>
+#include <stdint.h>
+
+#include <cvt/ml/rdf/RDFClassifier.h>
+#include <cvt/gfx/Image.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/Exception.h>
+
+namespace cvt {
+
+	/**
+	 *	\class RDFFlatClassifier
+	 *	\brief Compiled form of a trained RDFClassifier for fast inference.
+	 *
+	 *	The split nodes of all trees are stored breadth first in one array, each node holds a copy
+	 *	of its TEST, which is called non-virtually. All tests of the forest have to be of type TEST.
+	 *	The leaves keep their class distribution quantized to 16 bit.
+	 *	Samples are classified in blocks: a block walks through one tree level by level before the
+	 *	next tree is used, the blocks are distributed over the ThreadPool.
+	 *	Unlike RDFClassifier, which pools the sample counts of the leaves, the result is the mean of
+	 *	the leaf distributions.
+	 */
+	template<typename DATA, size_t N, typename TEST>
+	class RDFFlatClassifier {
+		public:
+			RDFFlatClassifier();
+			RDFFlatClassifier( const RDFClassifier<DATA,N>& classifier );
+
+			void	compile( const RDFClassifier<DATA,N>& classifier );
+
+			size_t	treeCount() const { return _roots.size(); }
+			size_t	nodeCount() const { return _nodes.size(); }
+			size_t	leafCount() const { return _leaves.size() / N; }
+
+			/* N class probabilities per sample */
+			void	classify( float* probabilities, const DATA& data ) const;
+			void	classify( float* probabilities, const DATA* data, size_t n ) const;
+
+			/**
+			 *	\brief classify all pixels of a width x height image
+			 *	\param labels			GRAY_UINT8 image with the most probable class of every pixel
+			 *	\param sampler			sampler( DATA& d, size_t x, size_t y ) creates the sample of a pixel
+			 *	\param probabilities	if not NULL, N probabilities per pixel in row major order
+			 */
+			template<typename SAMPLER>
+			void	classify( Image& labels, const SAMPLER& sampler, size_t width, size_t height, float* probabilities = NULL ) const;
+
+		private:
+			struct Node {
+				Node( const TEST& t ) : test( t )
+				{
+					/* the flattening sets the children right after adding the node */
+					child[ 0 ] = child[ 1 ] = 0;
+				}
+
+				TEST	 test;
+				uint32_t child[ 2 ];	/* false / left and true / right */
+			};
+
+			template<typename SAMPLER> class ImageRows;
+			class SampleRows;
+
+			uint32_t addLeaf( const RDFClassHistogram<N>& hist );
+			void	 classifyBlock( uint32_t* acc, const DATA* data, size_t n ) const;
+			void	 probabilities( float* dst, const uint32_t* acc, size_t n ) const;
+
+			static const uint32_t LEAF = 0x80000000;
+			static const uint32_t QUANTIZATION = 0xffff;
+			static const size_t	  BLOCK_SIZE = 64;
+
+			std::vector<Node>	  _nodes;
+			std::vector<uint16_t> _leaves;	/* N per leaf */
+			std::vector<uint32_t> _roots;
+	};
+
+	template<typename DATA, size_t N, typename TEST>
+	class RDFFlatClassifier<DATA,N,TEST>::SampleRows : public ParallelRows::Body {
+		public:
+			SampleRows( const RDFFlatClassifier<DATA,N,TEST>& rdf, float* probabilities, const DATA* data, size_t n ) :
+				_rdf( rdf ), _probabilities( probabilities ), _data( data ), _n( n )
+			{
+			}
+
+			void process( size_t start, size_t end ) const
+			{
+				uint32_t acc[ BLOCK_SIZE * N ];
+				for( size_t b = start; b < end; b++ ) {
+					size_t offset = b * BLOCK_SIZE;
+					size_t n = Math::min( _n - offset, BLOCK_SIZE );
+					_rdf.classifyBlock( acc, _data + offset, n );
+					_rdf.probabilities( _probabilities + offset * N, acc, n );
+				}
+			}
+
+		private:
+			const RDFFlatClassifier<DATA,N,TEST>& _rdf;
+			float*								  _probabilities;
+			const DATA*							  _data;
+			size_t								  _n;
+	};
+
+	template<typename DATA, size_t N, typename TEST>
+	template<typename SAMPLER>
+	class RDFFlatClassifier<DATA,N,TEST>::ImageRows : public ParallelRows::Body {
+		public:
+			ImageRows( const RDFFlatClassifier<DATA,N,TEST>& rdf, uint8_t* labels, size_t stride, const SAMPLER& sampler,
+					   size_t width, float* probabilities ) :
+				_rdf( rdf ), _labels( labels ), _stride( stride ), _sampler( sampler ), _width( width ), _probabilities( probabilities )
+			{
+			}
+
+			void process( size_t ystart, size_t yend ) const
+			{
+				std::vector<DATA> data( BLOCK_SIZE );
+				uint32_t acc[ BLOCK_SIZE * N ];
+
+				for( size_t y = ystart; y < yend; y++ ) {
+					uint8_t* labels = _labels + _stride * y;
+					for( size_t x = 0; x < _width; x += BLOCK_SIZE ) {
+						size_t n = Math::min( _width - x, BLOCK_SIZE );
+						for( size_t i = 0; i < n; i++ )
+							_sampler( data[ i ], x + i, y );
+
+						_rdf.classifyBlock( acc, &data[ 0 ], n );
+
+						for( size_t i = 0; i < n; i++ ) {
+							const uint32_t* a = acc + i * N;
+							size_t best = 0;
+							for( size_t c = 1; c < N; c++ ) {
+								if( a[ c ] > a[ best ] )
+									best = c;
+							}
+							labels[ x + i ] = ( uint8_t ) best;
+						}
+
+						if( _probabilities )
+							_rdf.probabilities( _probabilities + ( y * _width + x ) * N, acc, n );
+					}
+				}
+			}
+
+		private:
+			const RDFFlatClassifier<DATA,N,TEST>& _rdf;
+			uint8_t*							  _labels;
+			size_t								  _stride;
+			const SAMPLER&						  _sampler;
+			size_t								  _width;
+			float*								  _probabilities;
+	};
+
+	template<typename DATA, size_t N, typename TEST>
+	inline RDFFlatClassifier<DATA,N,TEST>::RDFFlatClassifier()
+	{
+	}
+
+	template<typename DATA, size_t N, typename TEST>
+	inline RDFFlatClassifier<DATA,N,TEST>::RDFFlatClassifier( const RDFClassifier<DATA,N>& classifier )
+	{
+		compile( classifier );
+	}
+
+	template<typename DATA, size_t N, typename TEST>
+	inline void RDFFlatClassifier<DATA,N,TEST>::compile( const RDFClassifier<DATA,N>& classifier )
+	{
+		typedef RDFNode<DATA,RDFClassHistogram<N> > TreeNode;
+
+		_nodes.clear();
+		_leaves.clear();
+		_roots.clear();
+
+		std::vector<const TreeNode*> queue;
+		for( size_t t = 0; t < classifier.treeCount(); t++ ) {
+			const TreeNode* root = classifier.tree( t ).root();
+			if( root->isLeaf() ) {
+				_roots.push_back( addLeaf( *root->data() ) );
+				continue;
+			}
+
+			/* breadth first, the children of the split nodes get their index when they are queued */
+			_roots.push_back( _nodes.size() );
+			queue.clear();
+			queue.push_back( root );
+			for( size_t q = 0; q < queue.size(); q++ ) {
+				const TreeNode* node = queue[ q ];
+				const TEST* test = dynamic_cast<const TEST*>( node->test() );
+				if( !test )
+					throw CVTException( "Forest contains a test of another type" );
+
+				_nodes.push_back( Node( *test ) );
+				const TreeNode* children[ 2 ] = { node->left(), node->right() };
+				for( size_t c = 0; c < 2; c++ ) {
+					if( children[ c ]->isLeaf() ) {
+						_nodes.back().child[ c ] = addLeaf( *children[ c ]->data() );
+					} else {
+						_nodes.back().child[ c ] = _roots.back() + queue.size();
+						queue.push_back( children[ c ] );
+					}
+				}
+			}
+		}
+	}
+
+	template<typename DATA, size_t N, typename TEST>
+	inline uint32_t RDFFlatClassifier<DATA,N,TEST>::addLeaf( const RDFClassHistogram<N>& hist )
+	{
+		uint32_t idx = _leaves.size() / N;
+		for( size_t c = 0; c < N; c++ ) {
+			float p = hist.sampleCount() ? hist.probability( c ) : 0.0f;
+			_leaves.push_back( ( uint16_t ) ( p * ( float ) QUANTIZATION + 0.5f ) );
+		}
+		return idx | LEAF;
+	}
+
+	template<typename DATA, size_t N, typename TEST>
+	inline void RDFFlatClassifier<DATA,N,TEST>::classifyBlock( uint32_t* acc, const DATA* data, size_t n ) const
+	{
+		uint32_t idx[ BLOCK_SIZE ];
+		uint32_t active[ BLOCK_SIZE ];
+
+		for( size_t i = 0; i < n * N; i++ )
+			acc[ i ] = 0;
+
+		for( size_t t = 0; t < _roots.size(); t++ ) {
+			for( size_t i = 0; i < n; i++ )
+				idx[ i ] = _roots[ t ];
+
+			/* all samples of the block descend one level, samples that reached a leaf drop out */
+			size_t nactive = 0;
+			if( !( _roots[ t ] & LEAF ) ) {
+				for( size_t i = 0; i < n; i++ )
+					active[ i ] = i;
+				nactive = n;
+			}
+			while( nactive ) {
+				size_t next = 0;
+				for( size_t k = 0; k < nactive; k++ ) {
+					size_t i = active[ k ];
+					const Node& node = _nodes[ idx[ i ] ];
+					idx[ i ] = node.child[ node.test.TEST::operator()( data[ i ] ) ];
+					active[ next ] = i;
+					next += !( idx[ i ] & LEAF );
+				}
+				nactive = next;
+			}
+
+			for( size_t i = 0; i < n; i++ ) {
+				const uint16_t* leaf = &_leaves[ ( idx[ i ] & ~LEAF ) * N ];
+				uint32_t* a = acc + i * N;
+				for( size_t c = 0; c < N; c++ )
+					a[ c ] += leaf[ c ];
+			}
+		}
+	}
+
+	template<typename DATA, size_t N, typename TEST>
+	inline void RDFFlatClassifier<DATA,N,TEST>::probabilities( float* dst, const uint32_t* acc, size_t n ) const
+	{
+		float scale = 1.0f / ( ( float ) QUANTIZATION * ( float ) _roots.size() );
+		for( size_t i = 0; i < n * N; i++ )
+			dst[ i ] = ( float ) acc[ i ] * scale;
+	}
+
+	template<typename DATA, size_t N, typename TEST>
+	inline void RDFFlatClassifier<DATA,N,TEST>::classify( float* probabilities, const DATA& data ) const
+	{
+		classify( probabilities, &data, 1 );
+	}
+
+	template<typename DATA, size_t N, typename TEST>
+	inline void RDFFlatClassifier<DATA,N,TEST>::classify( float* probabilities, const DATA* data, size_t n ) const
+	{
+		SampleRows body( *this, probabilities, data, n );
+		ParallelRows::run( body, BLOCK_SIZE * _roots.size(), ( n + BLOCK_SIZE - 1 ) / BLOCK_SIZE );
+	}
+
+	template<typename DATA, size_t N, typename TEST>
+	template<typename SAMPLER>
+	inline void RDFFlatClassifier<DATA,N,TEST>::classify( Image& labels, const SAMPLER& sampler, size_t width, size_t height, float* probabilities ) const
+	{
+		if( N > 256 )
+			throw CVTException( "Labels of more than 256 classes do not fit into GRAY_UINT8" );
+
+		labels.reallocate( width, height, IFormat::GRAY_UINT8 );
+
+		size_t stride;
+		uint8_t* ptr = labels.map( &stride );
+		ImageRows<SAMPLER> body( *this, ptr, stride, sampler, width, probabilities );
+		ParallelRows::run( body, width * _roots.size(), height );
+		labels.unmap( ptr );
+	}
+
+}
+
+#endif
@@ -0,0 +1,245 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/ml/rdf/RDFFlatClassifier.h>
+#include <cvt/ml/rdf/RDFClassificationTrainer2D.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/Time.h>
+
+#include <iostream>
+
+using namespace cvt;
+
+typedef RDFNode<Vector2f,RDFClassHistogram<4> > Node2D;
+
+/* random split tests, the leaves get a random class distribution */
+static Node2D* _randomTree( size_t depth )
+{
+	if( !depth || Math::rand( 0.0f, 1.0f ) < 0.05f ) {
+		RDFClassHistogram<4>* hist = new RDFClassHistogram<4>();
+		size_t n = 1 + random() % 50;
+		for( size_t i = 0; i < n; i++ )
+			hist->addSample( random() % 4 );
+		return new Node2D( hist, NULL, NULL, NULL );
+	}
+
+	float angle = Math::rand( 0.0f, Math::TWO_PI );
+	RDFTestLinear2D* test = new RDFTestLinear2D( Vector2f( Math::cos( angle ), Math::sin( angle ) ), Math::rand( 0.05f, 1.0f ) );
+	Node2D* left = _randomTree( depth - 1 );
+	Node2D* right = _randomTree( depth - 1 );
+	return new Node2D( NULL, test, left, right );
+}
+
+static void _deleteTree( const Node2D* node )
+{
+	if( !node->isLeaf() ) {
+		_deleteTree( node->left() );
+		_deleteTree( node->right() );
+	}
+	delete node->data();
+	delete node->test();
+	delete node;
+}
+
+/* mean of the leaf distributions of the pointer trees */
+static void _reference( float* probs, const RDFClassifier<Vector2f,4>& rdf, const Vector2f& pt )
+{
+	for( size_t c = 0; c < 4; c++ )
+		probs[ c ] = 0.0f;
+	for( size_t t = 0; t < rdf.treeCount(); t++ ) {
+		const Node2D* node = rdf.tree( t ).root();
+		while( !node->isLeaf() )
+			node = ( *node->test() )( pt ) ? node->right() : node->left();
+		for( size_t c = 0; c < 4; c++ )
+			probs[ c ] += node->data()->probability( c ) / ( float ) rdf.treeCount();
+	}
+}
+
+class PixelSampler {
+	public:
+		PixelSampler( size_t width, size_t height ) : _sx( 2.0f / ( float ) width ), _sy( 2.0f / ( float ) height ) {}
+
+		void operator()( Vector2f& pt, size_t x, size_t y ) const
+		{
+			pt.x = ( float ) x * _sx - 1.0f;
+			pt.y = ( float ) y * _sy - 1.0f;
+		}
+
+	private:
+		float _sx, _sy;
+};
+
+static bool _compare( const RDFClassifier<Vector2f,4>& rdf, const RDFFlatClassifier<Vector2f,4,RDFTestLinear2D>& flat )
+{
+	const size_t n = 5000;
+	std::vector<Vector2f> pts( n );
+	for( size_t i = 0; i < n; i++ )
+		pts[ i ] = Vector2f( Math::rand( -1.0f, 1.0f ), Math::rand( -1.0f, 1.0f ) );
+
+	std::vector<float> probs( n * 4 );
+	flat.classify( &probs[ 0 ], &pts[ 0 ], n );
+
+	bool b = true;
+	float ref[ 4 ], single[ 4 ];
+	for( size_t i = 0; i < n; i++ ) {
+		_reference( ref, rdf, pts[ i ] );
+		flat.classify( single, pts[ i ] );
+		for( size_t c = 0; c < 4; c++ ) {
+			b &= Math::abs( probs[ i * 4 + c ] - ref[ c ] ) < 1e-4f;
+			b &= single[ c ] == probs[ i * 4 + c ];
+		}
+	}
+	CVTTEST_PRINT( "RDFFlatClassifier samples", b );
+	return b;
+}
+
+static bool _compareImage( const RDFClassifier<Vector2f,4>& rdf, const RDFFlatClassifier<Vector2f,4,RDFTestLinear2D>& flat )
+{
+	const size_t width = 200, height = 150;
+	PixelSampler sampler( width, height );
+	Image labels, labels1;
+	std::vector<float> probs( width * height * 4 ), probs1( width * height * 4 );
+
+	flat.classify( labels, sampler, width, height, &probs[ 0 ] );
+	{
+		ParallelRows::ScopedNumThreads nt( 1 );
+		flat.classify( labels1, sampler, width, height, &probs1[ 0 ] );
+	}
+
+	bool b = probs == probs1;
+	IMapScoped<const uint8_t> map( labels ), map1( labels1 );
+	float ref[ 4 ];
+	for( size_t y = 0; y < height; y++ ) {
+		const uint8_t* l = map.ptr();
+		const uint8_t* l1 = map1.ptr();
+		for( size_t x = 0; x < width; x++ ) {
+			Vector2f pt;
+			sampler( pt, x, y );
+			_reference( ref, rdf, pt );
+
+			const float* p = &probs[ ( y * width + x ) * 4 ];
+			size_t best = 0;
+			for( size_t c = 1; c < 4; c++ ) {
+				b &= Math::abs( p[ c ] - ref[ c ] ) < 1e-4f;
+				if( ref[ c ] > ref[ best ] )
+					best = c;
+			}
+			/* skip pixels where the quantization may flip the decision */
+			bool unique = true;
+			for( size_t c = 0; c < 4; c++ )
+				unique &= c == best || ref[ best ] - ref[ c ] > 1e-3f;
+			b &= !unique || l[ x ] == best;
+			b &= l[ x ] == l1[ x ];
+		}
+		map++;
+		map1++;
+	}
+	CVTTEST_PRINT( "RDFFlatClassifier image", b );
+	return b;
+}
+
+static void _benchmark()
+{
+	const size_t width = 640, height = 480;
+	RDFClassifier<Vector2f,4> rdf;
+	for( size_t t = 0; t < 8; t++ )
+		rdf.addTree( new RDFClassificationTree<Vector2f,4>( _randomTree( 14 ) ) );
+
+	PixelSampler sampler( width, height );
+	Time time;
+	RDFClassHistogram<4> hist;
+	size_t sum = 0;
+	for( size_t y = 0; y < height; y++ ) {
+		for( size_t x = 0; x < width; x++ ) {
+			Vector2f pt;
+			sampler( pt, x, y );
+			rdf.classify( hist, pt );
+			sum += hist.sampleCount();
+		}
+	}
+	double pointer = time.elapsedMilliSeconds();
+
+	RDFFlatClassifier<Vector2f,4,RDFTestLinear2D> flat( rdf );
+	Image labels;
+	time.reset();
+	flat.classify( labels, sampler, width, height );
+	double flattened = time.elapsedMilliSeconds();
+
+	std::cout << "RDF 640x480, 8 trees of depth 14: pointer trees " << pointer << " ms, flattened "
+			  << flattened << " ms ( " << flat.nodeCount() << " nodes, " << flat.leafCount() << " leaves )" << std::endl;
+
+	/* incoherent samples, neighbouring samples take different paths */
+	const size_t n = width * height;
+	std::vector<Vector2f> pts( n );
+	for( size_t i = 0; i < n; i++ )
+		pts[ i ] = Vector2f( Math::rand( -1.0f, 1.0f ), Math::rand( -1.0f, 1.0f ) );
+
+	time.reset();
+	for( size_t i = 0; i < n; i++ ) {
+		rdf.classify( hist, pts[ i ] );
+		sum += hist.sampleCount();
+	}
+	pointer = time.elapsedMilliSeconds();
+
+	std::vector<float> probs( n * 4 );
+	time.reset();
+	flat.classify( &probs[ 0 ], &pts[ 0 ], n );
+	flattened = time.elapsedMilliSeconds();
+
+	std::cout << "RDF " << n << " random samples: pointer trees " << pointer << " ms, flattened " << flattened << " ms" << std::endl;
+
+	for( size_t t = 0; t < rdf.treeCount(); t++ ) {
+		_deleteTree( rdf.tree( t ).root() );
+		delete &rdf.tree( t );
+	}
+}
+
+BEGIN_CVTTEST( RDFFlatClassifier )
+	bool result = true;
+
+	srandom( 2013 );
+	RDFClassifier<Vector2f,4> rdf;
+	for( size_t t = 0; t < 5; t++ )
+		rdf.addTree( new RDFClassificationTree<Vector2f,4>( _randomTree( 8 ) ) );
+	/* a tree consisting of a single leaf */
+	rdf.addTree( new RDFClassificationTree<Vector2f,4>( _randomTree( 0 ) ) );
+
+	RDFFlatClassifier<Vector2f,4,RDFTestLinear2D> flat( rdf );
+	bool b = flat.treeCount() == rdf.treeCount();
+	CVTTEST_PRINT( "RDFFlatClassifier compile", b );
+	result &= b;
+
+	result &= _compare( rdf, flat );
+	result &= _compareImage( rdf, flat );
+
+	for( size_t t = 0; t < rdf.treeCount(); t++ ) {
+		_deleteTree( rdf.tree( t ).root() );
+		delete &rdf.tree( t );
+	}
+
+	_benchmark();
+
+	return result;
+END_CVTTEST
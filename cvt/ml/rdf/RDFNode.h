@@ -42,6 +42,9 @@ namespace cvt {
 			RDFNode<DATA,NODEDATA>*	left();
 			RDFNode<DATA,NODEDATA>* right();
 			RDFTest<DATA>*			test();
+			const RDFNode<DATA,NODEDATA>* left() const;
+			const RDFNode<DATA,NODEDATA>* right() const;
+			const RDFTest<DATA>*	test() const;
 			NODEDATA*				data();
 			const NODEDATA*			data() const;
 
@@ -104,6 +107,24 @@ namespace cvt {
 		return _right;
 	}
 
+	template<typename DATA, typename NODEDATA>
+	inline const RDFTest<DATA>* RDFNode<DATA, NODEDATA>::test() const
+	{
+		return _test;
+	}
+
+	template<typename DATA, typename NODEDATA>
+	inline const RDFNode<DATA,NODEDATA>* RDFNode<DATA, NODEDATA>::left() const
+	{
+		return _left;
+	}
+
+	template<typename DATA, typename NODEDATA>
+	inline const RDFNode<DATA,NODEDATA>* RDFNode<DATA, NODEDATA>::right() const
+	{
+		return _right;
+	}
+
 	template<typename DATA, typename NODEDATA>
 	inline NODEDATA* RDFNode<DATA, NODEDATA>::data()
 	{
@@ -34,7 +34,8 @@ namespace cvt {
 			RDFTest() {}
 			virtual ~RDFTest() {}
 
-			virtual bool operator()( const DATA& d ) = 0;
+			/* tests are evaluated concurrently */
+			virtual bool operator()( const DATA& d ) const = 0;
 	};
 }
 
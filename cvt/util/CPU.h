@@ -30,49 +30,73 @@
 
 namespace cvt {
 	enum CPUFeatureFlags {
-		CPU_BASE   =  0,
-		CPU_MMX    = ( 1 << 1 ),
-		CPU_SSE    = ( 1 << 2 ),
-		CPU_SSE2   = ( 1 << 3 ),
-		CPU_SSE3   = ( 1 << 4 ),
-		CPU_SSSE3  = ( 1 << 5 ),
-		CPU_SSE4_1 = ( 1 << 6 ),
-		CPU_SSE4_2 = ( 1 << 7 ),
-		CPU_AVX    = ( 1 << 8 ),
+		CPU_BASE	  =  0,
+		CPU_MMX		  = ( 1 << 1 ),
+		CPU_SSE		  = ( 1 << 2 ),
+		CPU_SSE2	  = ( 1 << 3 ),
+		CPU_SSE3	  = ( 1 << 4 ),
+		CPU_SSSE3	  = ( 1 << 5 ),
+		CPU_SSE4_1	  = ( 1 << 6 ),
+		CPU_SSE4_2	  = ( 1 << 7 ),
+		CPU_AVX		  = ( 1 << 8 ),
+		CPU_FMA		  = ( 1 << 9 ),
+		CPU_AVX2	  = ( 1 << 10 ),
+		CPU_AVX512F	  = ( 1 << 11 ),
+		CPU_AVX512BW  = ( 1 << 12 ),
 	};
 
 	CVT_ENUM_TO_FLAGS( CPUFeatureFlags, CPUFeatures )
 
-	static inline CPUFeatures cpuFeatures( void )
+	static inline void cpuid( uint32_t leaf, uint32_t subleaf, uint32_t& eax, uint32_t& ebx, uint32_t& ecx, uint32_t& edx )
 	{
-		CPUFeatures ret = CPU_BASE;
-		uint32_t eax, ebx, ecx, edx;
-
 #ifdef ARCH_x86_64
-		/* FIXME: what a clusterfuck - this works only for x86_64, we need to save ebx on x86
-				  BUT cpuid on x86_64 destroys rbx and not only ebx
-		 */
 		asm volatile(
-			"movl $1, %%eax;\n\t"
 			"cpuid;\n\t"
 				: "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
-				:
+				: "a"(leaf), "c"(subleaf)
 				:
 			);
 #elif ARCH_x86
+		/* ebx is the PIC register on x86 - save it */
 		asm volatile(
 			"movl %%ebx, %%esi;\n\t"
-			"movl $1, %%eax;\n\t"
 			"cpuid;\n\t"
 			"xchgl %%ebx, %%esi;\n\t"
 				: "=a"(eax), "=S"(ebx), "=c"(ecx), "=d"(edx)
-				:
+				: "a"(leaf), "c"(subleaf)
 				:
 			);
-
 #else
+		( void ) leaf;
+		( void ) subleaf;
 		eax = ebx = ecx = edx = 0;
 #endif
+	}
+
+	/* the extended register state enabled by the OS ( XCR0 ), only valid if OSXSAVE is set */
+	static inline uint64_t xgetbv0( void )
+	{
+#if defined( ARCH_x86_64 ) || defined( ARCH_x86 )
+		uint32_t eax, edx;
+		asm volatile(
+			".byte 0x0f, 0x01, 0xd0;\n\t" /* xgetbv */
+				: "=a"(eax), "=d"(edx)
+				: "c"(0)
+				:
+			);
+		return ( ( uint64_t ) edx << 32 ) | eax;
+#else
+		return 0;
+#endif
+	}
+
+	static inline CPUFeatures cpuFeatures( void )
+	{
+		CPUFeatures ret = CPU_BASE;
+		uint32_t eax, ebx, ecx, edx, maxleaf;
+
+		cpuid( 0, 0, maxleaf, ebx, ecx, edx );
+		cpuid( 1, 0, eax, ebx, ecx, edx );
 
 		if( edx & ( 1 << 23 ) )
 			ret |= CPU_MMX;
@@ -82,16 +106,36 @@ namespace cvt {
 			ret |= CPU_SSE2;
 		if( ecx & ( 1 <<  0 ) )
 			ret |= CPU_SSE3;
-		if( ecx & ( 1 <<  0 ) )
-			ret |= CPU_SSE3;
 		if( ecx & ( 1 <<  9 ) )
 			ret |= CPU_SSSE3;
 		if( ecx & ( 1 << 19 ) )
 			ret |= CPU_SSE4_1;
 		if( ecx & ( 1 << 20 ) )
 			ret |= CPU_SSE4_2;
+
+		/* AVX and above need the OS to save the YMM/ZMM state ( OSXSAVE + XCR0 ) */
+		if( !( ecx & ( 1 << 27 ) ) )
+			return ret;
+		uint64_t xcr0 = xgetbv0();
+		bool ymm = ( xcr0 & 0x06 ) == 0x06;
+		bool zmm = ( xcr0 & 0xe6 ) == 0xe6;
+
+		if( !ymm )
+			return ret;
 		if( ecx & ( 1 << 28 ) )
 			ret |= CPU_AVX;
+		if( ecx & ( 1 << 12 ) )
+			ret |= CPU_FMA;
+
+		if( maxleaf < 7 )
+			return ret;
+		cpuid( 7, 0, eax, ebx, ecx, edx );
+		if( ebx & ( 1 << 5 ) )
+			ret |= CPU_AVX2;
+		if( zmm && ( ebx & ( 1 << 16 ) ) )
+			ret |= CPU_AVX512F;
+		if( zmm && ( ebx & ( 1 << 30 ) ) )
+			ret |= CPU_AVX512BW;
 		return ret;
 	}
 
@@ -116,6 +160,14 @@ namespace cvt {
 			std::cout << "SSE4.2 ";
 		if( f & CPU_AVX )
 			std::cout << "AVX ";
+		if( f & CPU_FMA )
+			std::cout << "FMA ";
+		if( f & CPU_AVX2 )
+			std::cout << "AVX2 ";
+		if( f & CPU_AVX512F )
+			std::cout << "AVX512F ";
+		if( f & CPU_AVX512BW )
+			std::cout << "AVX512BW ";
 		std::cout << std::endl;
 	}
 }
@@ -0,0 +1,118 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/ThreadPool.h>
+#include <cvt/math/Math.h>
+
+#include <vector>
+
+namespace cvt {
+
+	size_t ParallelRows::_pixelThreshold = 1 << 16;
+
+	static __thread size_t _tlsNumThreads = 0;
+
+	class ParallelRowsTask : public ThreadPool::Task {
+		public:
+			ParallelRowsTask() : _body( 0 ), _ystart( 0 ), _yend( 0 ) {}
+
+			void set( const ParallelRows::Body* body, size_t ystart, size_t yend )
+			{
+				_body	= body;
+				_ystart = ystart;
+				_yend	= yend;
+			}
+
+			void execute()
+			{
+				_body->process( _ystart, _yend );
+			}
+
+		private:
+			const ParallelRows::Body* _body;
+			size_t					  _ystart;
+			size_t					  _yend;
+	};
+
+	void ParallelRows::run( const Body& body, size_t width, size_t height, size_t nthreads, size_t minRows )
+	{
+		if( !nthreads )
+			nthreads = numThreads();
+		if( !minRows )
+			minRows = MIN_BAND_ROWS;
+
+		size_t nbands = Math::min( nthreads, height / minRows );
+		if( nbands <= 1 || width * height < _pixelThreshold ) {
+			if( height )
+				body.process( 0, height );
+			return;
+		}
+
+		std::vector<ParallelRowsTask> bands( nbands );
+		std::vector<ThreadPool::Task*> tasks( nbands );
+		size_t ystart = 0;
+		for( size_t i = 0; i < nbands; i++ ) {
+			size_t yend = ( height * ( i + 1 ) ) / nbands;
+			bands[ i ].set( &body, ystart, yend );
+			tasks[ i ] = &bands[ i ];
+			ystart = yend;
+		}
+
+		ThreadPool::instance().run( &tasks[ 0 ], nbands );
+	}
+
+	void ParallelRows::setPixelThreshold( size_t pixels )
+	{
+		_pixelThreshold = pixels;
+	}
+
+	size_t ParallelRows::pixelThreshold()
+	{
+		return _pixelThreshold;
+	}
+
+	void ParallelRows::setNumThreads( size_t n )
+	{
+		_tlsNumThreads = n;
+	}
+
+	size_t ParallelRows::numThreads()
+	{
+		if( _tlsNumThreads )
+			return _tlsNumThreads;
+		return ThreadPool::instance().numThreads();
+	}
+
+	ParallelRows::ScopedNumThreads::ScopedNumThreads( size_t n ) : _prev( _tlsNumThreads )
+	{
+		_tlsNumThreads = n;
+	}
+
+	ParallelRows::ScopedNumThreads::~ScopedNumThreads()
+	{
+		_tlsNumThreads = _prev;
+	}
+
+}
@@ -0,0 +1,87 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_PARALLELROWS_H
+#define CVT_PARALLELROWS_H
+
+#include <stdlib.h>
+
+namespace cvt {
+
+	/**
+	 *	\class ParallelRows
+	 *	\brief Split row based image operations into bands of rows and run them on the ThreadPool.
+	 *
+	 *	Images with less pixels than pixelThreshold() are processed on the calling thread.
+	 *	The number of threads is taken from the ThreadPool and can be limited for the calling
+	 *	thread with setNumThreads() or ScopedNumThreads, or for a single call by passing it to run().
+	 */
+	class ParallelRows {
+		public:
+			class Body {
+				public:
+					virtual		 ~Body() {}
+					/* process the rows [ ystart, yend ) - called concurrently for disjoint bands */
+					virtual void process( size_t ystart, size_t yend ) const = 0;
+			};
+
+			class ScopedNumThreads {
+				public:
+					ScopedNumThreads( size_t n );
+					~ScopedNumThreads();
+
+				private:
+					ScopedNumThreads( const ScopedNumThreads& );
+					size_t _prev;
+			};
+
+			/**
+			 *	\brief Process all rows of a width x height image
+			 *	\param body			the row band operation
+			 *	\param width		width of the image - only used for the pixel threshold
+			 *	\param height		number of rows
+			 *	\param numThreads	maximum number of threads for this call, 0 uses numThreads()
+			 *	\param minRows		minimum number of rows per band, 0 uses the default of 8 rows -
+			 *						pass 1 if a single row is a large amount of work (e.g. a volume slab)
+			 */
+			static void		run( const Body& body, size_t width, size_t height, size_t numThreads = 0, size_t minRows = 0 );
+
+			static void		setPixelThreshold( size_t pixels );
+			static size_t	pixelThreshold();
+
+			/* thread count for calls from the current thread, 0 falls back to the ThreadPool size */
+			static void		setNumThreads( size_t n );
+			static size_t	numThreads();
+
+		private:
+			ParallelRows();
+			ParallelRows( const ParallelRows& );
+
+			static const size_t MIN_BAND_ROWS = 8;
+			static size_t		_pixelThreshold;
+	};
+
+}
+
+#endif
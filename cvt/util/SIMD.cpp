@@ -33,8 +33,12 @@
 #include <cvt/util/SIMDSSE41.h>
 #include <cvt/util/SIMDSSE42.h>
 #include <cvt/util/SIMDAVX.h>
+#include <cvt/util/SIMDAVX2.h>
+#include <cvt/util/SIMDAVX512.h>
 #include <cvt/util/CPU.h>
 
+#include <pthread.h>
+
 
 namespace cvt {
     const float _table_alpha_u8_f[256] = {
@@ -739,13 +743,18 @@ namespace cvt {
     }
 
     SIMD* SIMD::_simd = 0;
+    static pthread_once_t _simdOnce = PTHREAD_ONCE_INIT;
 
     SIMD* SIMD::get( SIMDType type )
     {
         if( type == SIMD_BEST ) {
             CPUFeatures cpuf;
             cpuf = cpuFeatures();
-            if( cpuf & CPU_AVX ){
+            if( ( cpuf & CPU_AVX512F ) && ( cpuf & CPU_AVX512BW ) && ( cpuf & CPU_AVX2 ) && ( cpuf & CPU_FMA ) ){
+                return new SIMDAVX512();
+            } else if( ( cpuf & CPU_AVX2 ) && ( cpuf & CPU_FMA ) ){
+                return new SIMDAVX2();
+            } else if( cpuf & CPU_AVX ){
                 return new SIMDAVX();
             } else if( cpuf & CPU_SSE4_2 ){
                 return new SIMDSSE42();
@@ -773,6 +782,8 @@ namespace cvt {
                 case SIMD_SSE41: return new SIMDSSE41();
                 case SIMD_SSE42: return new SIMDSSE42();
                 case SIMD_AVX: return new SIMDAVX();
+                case SIMD_AVX2: return new SIMDAVX2();
+                case SIMD_AVX512: return new SIMDAVX512();
             }
         }
     }
@@ -781,7 +792,11 @@ namespace cvt {
     {
         CPUFeatures cpuf;
         cpuf = cpuFeatures();
-        if( cpuf & CPU_AVX ){
+        if( ( cpuf & CPU_AVX512F ) && ( cpuf & CPU_AVX512BW ) && ( cpuf & CPU_AVX2 ) && ( cpuf & CPU_FMA ) ){
+            return SIMD_AVX512;
+        } else if( ( cpuf & CPU_AVX2 ) && ( cpuf & CPU_FMA ) ){
+            return SIMD_AVX2;
+        } else if( cpuf & CPU_AVX ){
             return SIMD_AVX;
         } else if( cpuf & CPU_SSE4_2 ){
             return SIMD_SSE42;
@@ -807,10 +822,16 @@ namespace cvt {
         _simd = get( type );
     }
 
-    SIMD* SIMD::instance()
+    void SIMD::initInstance()
     {
         if( !_simd )
             _simd = get( SIMD_BEST );
+    }
+
+    /* the first call may happen concurrently on ThreadPool workers, force() is not thread safe */
+    SIMD* SIMD::instance()
+    {
+        pthread_once( &_simdOnce, initInstance );
         return _simd;
     }
 
@@ -1402,6 +1423,14 @@ namespace cvt {
 		}
 	}
 
+	void SIMD::AddU8_to_U16( uint16_t* dst, const uint8_t* src, size_t n ) const
+	{
+		while( n-- ) {
+			uint32_t sum = ( uint32_t ) *dst + ( uint32_t ) *src++;
+			*dst++ = sum > 0xffff ? 0xffff : sum;
+		}
+	}
+
 	void SIMD::MinValueVertU8( uint8_t* dst, const uint8_t** bufs, size_t numbufs, size_t n ) const
 	{
 		size_t i;
@@ -5728,6 +5757,14 @@ namespace cvt {
         return d;
     }
 
+	void SIMD::hammingDistances( uint32_t* dst, const uint8_t* src, const uint8_t* set, size_t stride, size_t num, size_t n ) const
+	{
+		while( num-- ) {
+			*dst++ = ( uint32_t ) hammingDistance( src, set, n );
+			set += stride;
+		}
+	}
+
     /*
     {
         size_t d = 0;
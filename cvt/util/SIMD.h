@@ -44,6 +44,8 @@ namespace cvt {
         SIMD_SSE41,
         SIMD_SSE42,
         SIMD_AVX,
+        SIMD_AVX2,
+        SIMD_AVX512,
         SIMD_BEST
     };
 
@@ -96,6 +98,9 @@ namespace cvt {
 			virtual void MaxValueU16( uint16_t* dst, const uint16_t* src1, const uint16_t* src2, size_t n ) const;
 			virtual void MaxValue1f( float* dst, const float* src1, const float* src2, size_t n ) const;
 
+			/* dst += src, saturated to 0xffff */
+			virtual void AddU8_to_U16( uint16_t* dst, const uint8_t* src, size_t n ) const;
+
             virtual void MinValueVertU8( uint8_t* dst, const uint8_t** bufs, size_t numbufs, size_t n ) const;
             virtual void MinValueVertU16( uint16_t* dst, const uint16_t** bufs, size_t numbufs, size_t n ) const;
             virtual void MinValueVert1f( float* dst, const float** bufs, size_t numbufs, size_t n ) const;
@@ -324,6 +329,8 @@ namespace cvt {
             virtual void debayer_ODD_RGGBu8_GRAYu8( uint32_t* dst, const uint32_t* src1, const uint32_t* src2, const uint32_t* src3, size_t n ) const;
 
             virtual size_t hammingDistance( const uint8_t* src1, const uint8_t* src2, size_t n ) const;
+			/* hamming distances of the n byte descriptor src to num descriptors stored every stride bytes in set */
+			virtual void hammingDistances( uint32_t* dst, const uint8_t* src, const uint8_t* set, size_t stride, size_t num, size_t n ) const;
 
 			// prefix sum for 1 channel images
 			virtual void prefixSum1_u8_to_f( float * dst, size_t dstStride, const uint8_t* src, size_t srcStride, size_t width, size_t height ) const;
@@ -386,6 +393,7 @@ namespace cvt {
 
         private:
             static void cleanup();
+            static void initInstance();
 
             static SIMD* _simd;
     };
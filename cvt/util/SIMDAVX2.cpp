@@ -0,0 +1,769 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/SIMDAVX2.h>
+#include <immintrin.h>
+
+namespace cvt
+{
+	/* pack 4 x 8 floats into 32 bytes with rounding and saturation, restoring the lane order of the packs */
+	static inline __m256i _mm256_packround_ps_u8( __m256 s0, __m256 s1, __m256 s2, __m256 s3 )
+	{
+		__m256i p01 = _mm256_packs_epi32( _mm256_cvtps_epi32( s0 ), _mm256_cvtps_epi32( s1 ) );
+		__m256i p23 = _mm256_packs_epi32( _mm256_cvtps_epi32( s2 ), _mm256_cvtps_epi32( s3 ) );
+		return _mm256_permutevar8x32_epi32( _mm256_packus_epi16( p01, p23 ), _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 ) );
+	}
+
+	/* inclusive prefix sum of 8 floats */
+	static inline __m256 _mm256_prefixsum_ps( __m256 x )
+	{
+		x = _mm256_add_ps( x, _mm256_castsi256_ps( _mm256_slli_si256( _mm256_castps_si256( x ), 4 ) ) );
+		x = _mm256_add_ps( x, _mm256_castsi256_ps( _mm256_slli_si256( _mm256_castps_si256( x ), 8 ) ) );
+		/* carry the last element of the lower lane into the upper lane */
+		__m256 carry = _mm256_permute2f128_ps( x, x, 0x08 );
+		return _mm256_add_ps( x, _mm256_shuffle_ps( carry, carry, _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+	}
+
+	void SIMDAVX2::ConvolveHorizontal1f( float* dst, const float* src, const size_t width, float const* weights, const size_t wn, IBorderType btype ) const
+	{
+		if( wn == 1 ) {
+			MulValue1f( dst, src, *weights, width );
+			return;
+		}
+
+		ssize_t b1 = ( wn >> 1 );
+		ssize_t b2 = wn - b1 - 1;
+		ssize_t x;
+
+		for( x = 0; x < b1 && x < ( ssize_t ) width; x++ ) {
+			float tmp = 0;
+			for( size_t k = 0; k < wn; k++ ) {
+				ssize_t pos = IBorder::value<ssize_t>( x - b1 + k, width, btype );
+				tmp += weights[ k ] * src[ pos ];
+			}
+			*dst++ = tmp;
+		}
+
+		for( ; x + 16 <= ( ssize_t ) width - b2; x += 16 ) {
+			__m256 f;
+			__m256 s0 = _mm256_setzero_ps(), s1 = s0;
+
+			for( size_t k = 0; k < wn; k++ ) {
+				f = _mm256_broadcast_ss( weights + k );
+				s0 = _mm256_fmadd_ps( _mm256_loadu_ps( src + x - b1 + k ), f, s0 );
+				s1 = _mm256_fmadd_ps( _mm256_loadu_ps( src + x - b1 + k + 8 ), f, s1 );
+			}
+			_mm256_storeu_ps( dst, s0 );
+			_mm256_storeu_ps( dst + 8, s1 );
+			dst += 16;
+		}
+
+		for( ; x < ( ssize_t ) width - b2; x++ ) {
+			float tmp = 0;
+			for( size_t k = 0; k < wn; k++ )
+				tmp += weights[ k ] * src[ x - b1 + k ];
+			*dst++ = tmp;
+		}
+
+		for( ; x < ( ssize_t ) width; x++ ) {
+			float tmp = 0;
+			for( size_t k = 0; k < wn; k++ ) {
+				ssize_t pos = IBorder::value<ssize_t>( x - b1 + k, width, btype );
+				tmp += weights[ k ] * src[ pos ];
+			}
+			*dst++ = tmp;
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::ConvolveHorizontal4f( float* dst, const float* src, const size_t width, float const* weights, const size_t wn, IBorderType btype ) const
+	{
+		if( wn == 1 ) {
+			MulValue1f( dst, src, *weights, width * 4 );
+			return;
+		}
+
+		ssize_t b1 = ( wn >> 1 );
+		ssize_t b2 = wn - b1 - 1;
+		ssize_t x;
+
+		for( x = 0; x < b1 && x < ( ssize_t ) width; x++ ) {
+			float tmp[ 4 ] = { 0, 0, 0, 0 };
+			for( size_t k = 0; k < wn; k++ ) {
+				ssize_t pos = IBorder::value<ssize_t>( x - b1 + k, width, btype ) << 2;
+				tmp[ 0 ] += weights[ k ] * src[ pos + 0 ];
+				tmp[ 1 ] += weights[ k ] * src[ pos + 1 ];
+				tmp[ 2 ] += weights[ k ] * src[ pos + 2 ];
+				tmp[ 3 ] += weights[ k ] * src[ pos + 3 ];
+			}
+			*dst++ = tmp[ 0 ];
+			*dst++ = tmp[ 1 ];
+			*dst++ = tmp[ 2 ];
+			*dst++ = tmp[ 3 ];
+		}
+
+		for( ; x + 4 <= ( ssize_t ) width - b2; x += 4 ) {
+			__m256 f;
+			__m256 s0 = _mm256_setzero_ps(), s1 = s0;
+
+			for( size_t k = 0; k < wn; k++ ) {
+				f = _mm256_broadcast_ss( weights + k );
+				s0 = _mm256_fmadd_ps( _mm256_loadu_ps( src + ( ( x - b1 + k ) << 2 ) ), f, s0 );
+				s1 = _mm256_fmadd_ps( _mm256_loadu_ps( src + ( ( x - b1 + k ) << 2 ) + 8 ), f, s1 );
+			}
+			_mm256_storeu_ps( dst, s0 );
+			_mm256_storeu_ps( dst + 8, s1 );
+			dst += 16;
+		}
+
+		for( ; x < ( ssize_t ) width; x++ ) {
+			float tmp[ 4 ] = { 0, 0, 0, 0 };
+			for( size_t k = 0; k < wn; k++ ) {
+				ssize_t pos = IBorder::value<ssize_t>( x - b1 + k, width, btype ) << 2;
+				tmp[ 0 ] += weights[ k ] * src[ pos + 0 ];
+				tmp[ 1 ] += weights[ k ] * src[ pos + 1 ];
+				tmp[ 2 ] += weights[ k ] * src[ pos + 2 ];
+				tmp[ 3 ] += weights[ k ] * src[ pos + 3 ];
+			}
+			*dst++ = tmp[ 0 ];
+			*dst++ = tmp[ 1 ];
+			*dst++ = tmp[ 2 ];
+			*dst++ = tmp[ 3 ];
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::ConvolveHorizontalSym1f( float* dst, const float* src, const size_t width, float const* weights, const size_t wn, IBorderType btype ) const
+	{
+		if( wn == 1 ) {
+			MulValue1f( dst, src, *weights, width );
+			return;
+		}
+
+		ssize_t b1 = ( wn >> 1 );
+		ssize_t b2 = wn - b1 - 1;
+		ssize_t x;
+		const float* wsym = weights + b1;
+
+		for( x = 0; x < b1 && x < ( ssize_t ) width; x++ ) {
+			float tmp = 0;
+			for( size_t k = 0; k < wn; k++ ) {
+				ssize_t pos = IBorder::value<ssize_t>( x - b1 + k, width, btype );
+				tmp += weights[ k ] * src[ pos ];
+			}
+			*dst++ = tmp;
+		}
+
+		for( ; x + 16 <= ( ssize_t ) width - b2; x += 16 ) {
+			__m256 f;
+			__m256 s0, s1, x0, x1;
+
+			f = _mm256_broadcast_ss( wsym );
+			s0 = _mm256_mul_ps( _mm256_loadu_ps( src + x ), f );
+			s1 = _mm256_mul_ps( _mm256_loadu_ps( src + x + 8 ), f );
+
+			for( ssize_t k = 1; k <= b1; k++ ) {
+				f = _mm256_broadcast_ss( wsym + k );
+				x0 = _mm256_add_ps( _mm256_loadu_ps( src + x - k ), _mm256_loadu_ps( src + x + k ) );
+				x1 = _mm256_add_ps( _mm256_loadu_ps( src + x - k + 8 ), _mm256_loadu_ps( src + x + k + 8 ) );
+				s0 = _mm256_fmadd_ps( x0, f, s0 );
+				s1 = _mm256_fmadd_ps( x1, f, s1 );
+			}
+			_mm256_storeu_ps( dst, s0 );
+			_mm256_storeu_ps( dst + 8, s1 );
+			dst += 16;
+		}
+
+		for( ; x < ( ssize_t ) width - b2; x++ ) {
+			float tmp = 0;
+			for( size_t k = 0; k < wn; k++ )
+				tmp += weights[ k ] * src[ x - b1 + k ];
+			*dst++ = tmp;
+		}
+
+		for( ; x < ( ssize_t ) width; x++ ) {
+			float tmp = 0;
+			for( size_t k = 0; k < wn; k++ ) {
+				ssize_t pos = IBorder::value<ssize_t>( x - b1 + k, width, btype );
+				tmp += weights[ k ] * src[ pos ];
+			}
+			*dst++ = tmp;
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::ConvolveClampVert_f( float* dst, const float** bufs, const float* weights, size_t numw, size_t width ) const
+	{
+		size_t x;
+		__m256 s0, s1, s2, s3, mul;
+
+		for( x = 0; x + 32 <= width; x += 32 ) {
+			mul = _mm256_broadcast_ss( weights );
+			s0 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ 0 ] + x ), mul );
+			s1 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ 0 ] + x + 8 ), mul );
+			s2 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ 0 ] + x + 16 ), mul );
+			s3 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ 0 ] + x + 24 ), mul );
+
+			for( size_t k = 1; k < numw; k++ ) {
+				mul = _mm256_broadcast_ss( weights + k );
+				s0 = _mm256_fmadd_ps( _mm256_loadu_ps( bufs[ k ] + x ), mul, s0 );
+				s1 = _mm256_fmadd_ps( _mm256_loadu_ps( bufs[ k ] + x + 8 ), mul, s1 );
+				s2 = _mm256_fmadd_ps( _mm256_loadu_ps( bufs[ k ] + x + 16 ), mul, s2 );
+				s3 = _mm256_fmadd_ps( _mm256_loadu_ps( bufs[ k ] + x + 24 ), mul, s3 );
+			}
+			_mm256_storeu_ps( dst + 0 , s0 );
+			_mm256_storeu_ps( dst + 8 , s1 );
+			_mm256_storeu_ps( dst + 16 , s2 );
+			_mm256_storeu_ps( dst + 24 , s3 );
+			dst += 32;
+		}
+
+		for( ; x < width; x++ ) {
+			float tmp = bufs[ 0 ][ x ] * *weights;
+			for( size_t k = 1; k < numw; k++ )
+				tmp += bufs[ k ][ x ] * weights[ k ];
+			*dst++ = tmp;
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::ConvolveClampVert_f_to_u8( uint8_t* dst, const float** bufs, const float* weights, size_t numw, size_t width ) const
+	{
+		size_t x;
+		__m256 s0, s1, s2, s3, mul;
+
+		for( x = 0; x + 32 <= width; x += 32 ) {
+			mul = _mm256_broadcast_ss( weights );
+			s0 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ 0 ] + x ), mul );
+			s1 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ 0 ] + x + 8 ), mul );
+			s2 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ 0 ] + x + 16 ), mul );
+			s3 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ 0 ] + x + 24 ), mul );
+
+			for( size_t k = 1; k < numw; k++ ) {
+				mul = _mm256_broadcast_ss( weights + k );
+				s0 = _mm256_fmadd_ps( _mm256_loadu_ps( bufs[ k ] + x ), mul, s0 );
+				s1 = _mm256_fmadd_ps( _mm256_loadu_ps( bufs[ k ] + x + 8 ), mul, s1 );
+				s2 = _mm256_fmadd_ps( _mm256_loadu_ps( bufs[ k ] + x + 16 ), mul, s2 );
+				s3 = _mm256_fmadd_ps( _mm256_loadu_ps( bufs[ k ] + x + 24 ), mul, s3 );
+			}
+			_mm256_storeu_si256( ( __m256i* ) dst, _mm256_packround_ps_u8( s0, s1, s2, s3 ) );
+			dst += 32;
+		}
+
+		for( ; x < width; x++ ) {
+			float tmp = bufs[ 0 ][ x ] * *weights;
+			for( size_t k = 1; k < numw; k++ )
+				tmp += bufs[ k ][ x ] * weights[ k ];
+			*dst++ = ( uint8_t ) Math::clamp( tmp, 0.0f, 255.0f );
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::ConvolveClampVertSym_f( float* dst, const float** bufs, const float* weights, size_t numw, size_t width ) const
+	{
+		size_t x;
+		ssize_t b1 = ( numw >> 1 );
+		const float* wsym = weights + b1;
+		__m256 s0, s1, s2, s3, mul;
+
+		for( x = 0; x + 32 <= width; x += 32 ) {
+			mul = _mm256_broadcast_ss( wsym );
+			s0 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ b1 ] + x ), mul );
+			s1 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ b1 ] + x + 8 ), mul );
+			s2 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ b1 ] + x + 16 ), mul );
+			s3 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ b1 ] + x + 24 ), mul );
+
+			for( ssize_t k = 1; k <= b1; k++ ) {
+				const float* lo = bufs[ b1 - k ] + x;
+				const float* hi = bufs[ b1 + k ] + x;
+				mul = _mm256_broadcast_ss( wsym + k );
+				s0 = _mm256_fmadd_ps( _mm256_add_ps( _mm256_loadu_ps( lo ), _mm256_loadu_ps( hi ) ), mul, s0 );
+				s1 = _mm256_fmadd_ps( _mm256_add_ps( _mm256_loadu_ps( lo + 8 ), _mm256_loadu_ps( hi + 8 ) ), mul, s1 );
+				s2 = _mm256_fmadd_ps( _mm256_add_ps( _mm256_loadu_ps( lo + 16 ), _mm256_loadu_ps( hi + 16 ) ), mul, s2 );
+				s3 = _mm256_fmadd_ps( _mm256_add_ps( _mm256_loadu_ps( lo + 24 ), _mm256_loadu_ps( hi + 24 ) ), mul, s3 );
+			}
+			_mm256_storeu_ps( dst + 0 , s0 );
+			_mm256_storeu_ps( dst + 8 , s1 );
+			_mm256_storeu_ps( dst + 16 , s2 );
+			_mm256_storeu_ps( dst + 24 , s3 );
+			dst += 32;
+		}
+
+		for( ; x < width; x++ ) {
+			float tmp = bufs[ 0 ][ x ] * *weights;
+			for( size_t k = 1; k < numw; k++ )
+				tmp += bufs[ k ][ x ] * weights[ k ];
+			*dst++ = tmp;
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::ConvolveClampVertSym_f_to_u8( uint8_t* dst, const float** bufs, const float* weights, size_t numw, size_t width ) const
+	{
+		size_t x;
+		ssize_t b1 = ( numw >> 1 );
+		const float* wsym = weights + b1;
+		__m256 s0, s1, s2, s3, mul;
+
+		for( x = 0; x + 32 <= width; x += 32 ) {
+			mul = _mm256_broadcast_ss( wsym );
+			s0 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ b1 ] + x ), mul );
+			s1 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ b1 ] + x + 8 ), mul );
+			s2 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ b1 ] + x + 16 ), mul );
+			s3 = _mm256_mul_ps( _mm256_loadu_ps( bufs[ b1 ] + x + 24 ), mul );
+
+			for( ssize_t k = 1; k <= b1; k++ ) {
+				const float* lo = bufs[ b1 - k ] + x;
+				const float* hi = bufs[ b1 + k ] + x;
+				mul = _mm256_broadcast_ss( wsym + k );
+				s0 = _mm256_fmadd_ps( _mm256_add_ps( _mm256_loadu_ps( lo ), _mm256_loadu_ps( hi ) ), mul, s0 );
+				s1 = _mm256_fmadd_ps( _mm256_add_ps( _mm256_loadu_ps( lo + 8 ), _mm256_loadu_ps( hi + 8 ) ), mul, s1 );
+				s2 = _mm256_fmadd_ps( _mm256_add_ps( _mm256_loadu_ps( lo + 16 ), _mm256_loadu_ps( hi + 16 ) ), mul, s2 );
+				s3 = _mm256_fmadd_ps( _mm256_add_ps( _mm256_loadu_ps( lo + 24 ), _mm256_loadu_ps( hi + 24 ) ), mul, s3 );
+			}
+			_mm256_storeu_si256( ( __m256i* ) dst, _mm256_packround_ps_u8( s0, s1, s2, s3 ) );
+			dst += 32;
+		}
+
+		for( ; x < width; x++ ) {
+			float tmp = bufs[ 0 ][ x ] * *weights;
+			for( size_t k = 1; k < numw; k++ )
+				tmp += bufs[ k ][ x ] * weights[ k ];
+			*dst++ = ( uint8_t ) Math::clamp( tmp, 0.0f, 255.0f );
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::Conv_f_to_u8( uint8_t* dst, float const* src, const size_t n ) const
+	{
+		size_t i = n >> 5;
+		const __m256 scale = _mm256_set1_ps( 255.0f );
+		const __m256 half = _mm256_set1_ps( 0.5f );
+		const __m256 zero = _mm256_setzero_ps();
+		__m256 s[ 4 ];
+		__m256i p01, p23;
+
+		while( i-- ) {
+			/* clamp( x * 255 + 0.5 ) and truncate - identical to the scalar conversion */
+			for( int k = 0; k < 4; k++ ) {
+				s[ k ] = _mm256_fmadd_ps( _mm256_loadu_ps( src + 8 * k ), scale, half );
+				s[ k ] = _mm256_min_ps( _mm256_max_ps( s[ k ], zero ), scale );
+			}
+			p01 = _mm256_packs_epi32( _mm256_cvttps_epi32( s[ 0 ] ), _mm256_cvttps_epi32( s[ 1 ] ) );
+			p23 = _mm256_packs_epi32( _mm256_cvttps_epi32( s[ 2 ] ), _mm256_cvttps_epi32( s[ 3 ] ) );
+			_mm256_storeu_si256( ( __m256i* ) dst, _mm256_permutevar8x32_epi32( _mm256_packus_epi16( p01, p23 ),
+																				_mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 ) ) );
+			src += 32;
+			dst += 32;
+		}
+
+		_mm256_zeroupper();
+
+		i = n & 0x1f;
+		while( i-- )
+			*dst++ = ( uint8_t ) Math::clamp( *src++ * 255.0f + 0.5f, 0.0f, 255.0f );
+	}
+
+	void SIMDAVX2::Conv_u8_to_f( float* dst, const uint8_t* src, const size_t n ) const
+	{
+		size_t i = n >> 4;
+		const __m256 scale = _mm256_set1_ps( 1.0f / 255.0f );
+
+		while( i-- ) {
+			__m128i v = _mm_loadu_si128( ( const __m128i* ) src );
+			_mm256_storeu_ps( dst, _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( v ) ), scale ) );
+			_mm256_storeu_ps( dst + 8, _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_srli_si128( v, 8 ) ) ), scale ) );
+			src += 16;
+			dst += 16;
+		}
+
+		_mm256_zeroupper();
+
+		i = n & 0xf;
+		while( i-- )
+			*dst++ = ( float ) *src++ * ( 1.0f / 255.0f );
+	}
+
+	void SIMDAVX2::Conv_XYZAu8_to_ZYXAu8( uint8_t* dst, uint8_t const* src, const size_t n ) const
+	{
+		const __m256i mask = _mm256_setr_epi8( 0x2, 0x1, 0x0, 0x3, 0x6, 0x5, 0x4, 0x7,
+											   0xa, 0x9, 0x8, 0xb, 0xe, 0xd, 0xc, 0xf,
+											   0x2, 0x1, 0x0, 0x3, 0x6, 0x5, 0x4, 0x7,
+											   0xa, 0x9, 0x8, 0xb, 0xe, 0xd, 0xc, 0xf );
+		size_t i = n >> 3;
+
+		while( i-- ) {
+			__m256i x = _mm256_loadu_si256( ( const __m256i* ) src );
+			_mm256_storeu_si256( ( __m256i* ) dst, _mm256_shuffle_epi8( x, mask ) );
+			src += 32;
+			dst += 32;
+		}
+
+		_mm256_zeroupper();
+
+		if( n & 0x7 )
+			SIMDAVX::Conv_XYZAu8_to_ZYXAu8( dst, src, n & 0x7 );
+	}
+
+	void SIMDAVX2::Conv_XXXAu8_to_XXXAf( float* dst, uint8_t const* src, const size_t n ) const
+	{
+		/* same sRGB approximation as the SSE4.1 version: f^2 * ( A * f + B ), alpha is linear */
+		const __m256 A = _mm256_set1_ps( 0.28387f );
+		const __m256 B = _mm256_set1_ps( 1.0f - 0.28387f );
+		const __m256 C = _mm256_set1_ps( 1.0f / 255.0f );
+		size_t i = n >> 1;
+
+		while( i-- ) {
+			__m256 f = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_loadl_epi64( ( const __m128i* ) src ) ) ), C );
+			__m256 srgb = _mm256_mul_ps( _mm256_mul_ps( f, f ), _mm256_fmadd_ps( f, A, B ) );
+			_mm256_storeu_ps( dst, _mm256_blend_ps( srgb, f, 0x88 ) );
+			src += 8;
+			dst += 8;
+		}
+
+		_mm256_zeroupper();
+
+		if( n & 0x1 )
+			SIMDAVX::Conv_XXXAu8_to_XXXAf( dst, src, 1 );
+	}
+
+	void SIMDAVX2::BoxFilterVert_f_to_u8( uint8_t* dst, float* accum, const float* add, const float* sub, size_t radius, size_t width ) const
+	{
+		size_t x;
+		float invmean = 1.0f / ( float ) ( 2 * radius + 1 );
+		const __m256 mul = _mm256_set1_ps( invmean );
+		__m256 acc[ 4 ];
+
+		for( x = 0; x + 32 <= width; x += 32 ) {
+			for( int k = 0; k < 4; k++ ) {
+				acc[ k ] = _mm256_add_ps( _mm256_loadu_ps( accum + 8 * k ), _mm256_loadu_ps( add + 8 * k ) );
+				acc[ k ] = _mm256_sub_ps( acc[ k ], _mm256_loadu_ps( sub + 8 * k ) );
+				_mm256_storeu_ps( accum + 8 * k, acc[ k ] );
+				acc[ k ] = _mm256_mul_ps( acc[ k ], mul );
+			}
+			_mm256_storeu_si256( ( __m256i* ) dst, _mm256_packround_ps_u8( acc[ 0 ], acc[ 1 ], acc[ 2 ], acc[ 3 ] ) );
+
+			accum += 32;
+			add += 32;
+			sub += 32;
+			dst += 32;
+		}
+
+		for( ; x < width; x++ ) {
+			float tmp;
+			tmp = *accum + *add++ - *sub++;
+			*accum++ = tmp;
+			*dst++ = ( uint8_t ) Math::clamp( tmp * invmean, 0.0f, 255.0f );
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::BoxFilterVert_f( float* dst, float* accum, const float* add, const float* sub, size_t radius, size_t width ) const
+	{
+		size_t x;
+		float invmean = 1.0f / ( float ) ( 2 * radius + 1 );
+		const __m256 mul = _mm256_set1_ps( invmean );
+
+		for( x = 0; x + 16 <= width; x += 16 ) {
+			__m256 acc0, acc1;
+
+			acc0 = _mm256_sub_ps( _mm256_add_ps( _mm256_loadu_ps( accum ), _mm256_loadu_ps( add ) ), _mm256_loadu_ps( sub ) );
+			acc1 = _mm256_sub_ps( _mm256_add_ps( _mm256_loadu_ps( accum + 8 ), _mm256_loadu_ps( add + 8 ) ), _mm256_loadu_ps( sub + 8 ) );
+			_mm256_storeu_ps( accum, acc0 );
+			_mm256_storeu_ps( accum + 8, acc1 );
+			_mm256_storeu_ps( dst, _mm256_mul_ps( acc0, mul ) );
+			_mm256_storeu_ps( dst + 8, _mm256_mul_ps( acc1, mul ) );
+
+			accum += 16;
+			add += 16;
+			sub += 16;
+			dst += 16;
+		}
+
+		for( ; x < width; x++ ) {
+			float tmp;
+			tmp = *accum + *add++ - *sub++;
+			*accum++ = tmp;
+			*dst++ = tmp * invmean;
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::warpBilinear1f( float* dst, const float* coords, const float* src, size_t srcStride, size_t srcWidth, size_t srcHeight, float fillcolor, size_t n ) const
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i endx = _mm256_set1_epi32( ( int ) srcWidth - 1 );
+		const __m256i endy = _mm256_set1_epi32( ( int ) srcHeight - 1 );
+		const __m256i stride = _mm256_set1_epi32( ( int ) srcStride );
+		const __m256i four = _mm256_set1_epi32( sizeof( float ) );
+		size_t i = n >> 3;
+
+		while( i-- ) {
+			__m256 c0 = _mm256_loadu_ps( coords );
+			__m256 c1 = _mm256_loadu_ps( coords + 8 );
+			/* deinterleave x0 y0 x1 y1 ... into x0 ... x7 and y0 ... y7 */
+			__m256 fx = _mm256_castpd_ps( _mm256_permute4x64_pd( _mm256_castps_pd( _mm256_shuffle_ps( c0, c1, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+			__m256 fy = _mm256_castpd_ps( _mm256_permute4x64_pd( _mm256_castps_pd( _mm256_shuffle_ps( c0, c1, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+			__m256 flx = _mm256_floor_ps( fx );
+			__m256 fly = _mm256_floor_ps( fy );
+			__m256i lx = _mm256_cvttps_epi32( flx );
+			__m256i ly = _mm256_cvttps_epi32( fly );
+
+			/* inside if 0 <= lx < endx and 0 <= ly < endy, the interpolation needs no border handling then */
+			__m256i outside = _mm256_or_si256( _mm256_or_si256( _mm256_cmpgt_epi32( zero, lx ), _mm256_cmpgt_epi32( zero, ly ) ),
+											   _mm256_or_si256( _mm256_cmpgt_epi32( lx, _mm256_sub_epi32( endx, _mm256_set1_epi32( 1 ) ) ),
+																_mm256_cmpgt_epi32( ly, _mm256_sub_epi32( endy, _mm256_set1_epi32( 1 ) ) ) ) );
+			if( !_mm256_testz_si256( outside, outside ) ) {
+				SIMD::warpBilinear1f( dst, coords, src, srcStride, srcWidth, srcHeight, fillcolor, 8 );
+			} else {
+				__m256i offset = _mm256_add_epi32( _mm256_mullo_epi32( ly, stride ), _mm256_mullo_epi32( lx, four ) );
+				const float* base = src;
+				__m256 a = _mm256_i32gather_ps( base, offset, 1 );
+				__m256 b = _mm256_i32gather_ps( base + 1, offset, 1 );
+				offset = _mm256_add_epi32( offset, stride );
+				__m256 c = _mm256_i32gather_ps( base, offset, 1 );
+				__m256 d = _mm256_i32gather_ps( base + 1, offset, 1 );
+				__m256 alpha1 = _mm256_sub_ps( fx, flx );
+				__m256 alpha2 = _mm256_sub_ps( fy, fly );
+
+				a = _mm256_fmadd_ps( _mm256_sub_ps( b, a ), alpha1, a );
+				c = _mm256_fmadd_ps( _mm256_sub_ps( d, c ), alpha1, c );
+				_mm256_storeu_ps( dst, _mm256_fmadd_ps( _mm256_sub_ps( c, a ), alpha2, a ) );
+			}
+			coords += 16;
+			dst += 8;
+		}
+
+		_mm256_zeroupper();
+
+		if( n & 0x7 )
+			SIMD::warpBilinear1f( dst, coords, src, srcStride, srcWidth, srcHeight, fillcolor, n & 0x7 );
+	}
+
+	void SIMDAVX2::warpBilinear4f( float* dst, const float* coords, const float* _src, size_t srcStride, size_t srcWidth, size_t srcHeight, const float* fillcolor, size_t n ) const
+	{
+		const uint8_t* src = ( const uint8_t* ) _src;
+		int endx = ( ( int ) srcWidth ) - 1;
+		int endy = ( ( int ) srcHeight ) - 1;
+
+		while( n-- ) {
+			float fx = coords[ 0 ];
+			float fy = coords[ 1 ];
+			int lx = ( int ) Math::floor( fx );
+			int ly = ( int ) Math::floor( fy );
+
+			if( lx >= 0 && lx < endx && ly >= 0 && ly < endy ) {
+				/* both pixels of a row in one register, interpolate vertically first */
+				const float* ptr = ( const float* ) ( src + srcStride * ly + sizeof( float ) * lx * 4 );
+				__m256 top = _mm256_loadu_ps( ptr );
+				__m256 bottom = _mm256_loadu_ps( ( const float* ) ( ( const uint8_t* ) ptr + srcStride ) );
+				__m256 v = _mm256_fmadd_ps( _mm256_sub_ps( bottom, top ), _mm256_set1_ps( fy - ( float ) ly ), top );
+				__m128 left = _mm256_castps256_ps128( v );
+				__m128 right = _mm256_extractf128_ps( v, 1 );
+				_mm_storeu_ps( dst, _mm_fmadd_ps( _mm_sub_ps( right, left ), _mm_set1_ps( fx - ( float ) lx ), left ) );
+			} else {
+				SIMD::warpBilinear4f( dst, coords, _src, srcStride, srcWidth, srcHeight, fillcolor, 1 );
+			}
+			coords += 2;
+			dst += 4;
+		}
+
+		_mm256_zeroupper();
+	}
+
+	size_t SIMDAVX2::hammingDistance( const uint8_t* src1, const uint8_t* src2, size_t n ) const
+	{
+		const __m256i lut = _mm256_setr_epi8( 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+											  0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+		const __m256i mask = _mm256_set1_epi8( 0x0f );
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i sum = zero;
+		size_t i = n >> 5;
+
+		while( i-- ) {
+			__m256i x = _mm256_xor_si256( _mm256_loadu_si256( ( const __m256i* ) src1 ), _mm256_loadu_si256( ( const __m256i* ) src2 ) );
+			__m256i cnt = _mm256_add_epi8( _mm256_shuffle_epi8( lut, _mm256_and_si256( x, mask ) ),
+										   _mm256_shuffle_epi8( lut, _mm256_and_si256( _mm256_srli_epi16( x, 4 ), mask ) ) );
+			/* at most 8 per byte - reduce to 64 bit right away, no overflow handling needed */
+			sum = _mm256_add_epi64( sum, _mm256_sad_epu8( cnt, zero ) );
+			src1 += 32;
+			src2 += 32;
+		}
+
+		__m128i sum2 = _mm_add_epi64( _mm256_castsi256_si128( sum ), _mm256_extracti128_si256( sum, 1 ) );
+		sum2 = _mm_add_epi64( sum2, _mm_unpackhi_epi64( sum2, sum2 ) );
+		size_t d = ( size_t ) _mm_cvtsi128_si64( sum2 );
+
+		_mm256_zeroupper();
+
+		i = n & 0x1f;
+		while( i >= 8 ) {
+			d += __builtin_popcountll( *( ( const uint64_t* ) src1 ) ^ *( ( const uint64_t* ) src2 ) );
+			src1 += 8;
+			src2 += 8;
+			i -= 8;
+		}
+		while( i-- )
+			d += __builtin_popcount( *src1++ ^ *src2++ );
+		return d;
+	}
+
+	static inline __m256i _mm256_popcnt8_xor( const uint8_t* a, const uint8_t* b, const __m256i& lut, const __m256i& mask )
+	{
+		__m256i x = _mm256_xor_si256( _mm256_loadu_si256( ( const __m256i* ) a ), _mm256_loadu_si256( ( const __m256i* ) b ) );
+		return _mm256_add_epi8( _mm256_shuffle_epi8( lut, _mm256_and_si256( x, mask ) ),
+								_mm256_shuffle_epi8( lut, _mm256_and_si256( _mm256_srli_epi16( x, 4 ), mask ) ) );
+	}
+
+	/* sum the four 64 bit lanes of a and b into [ sum( a ), sum( b ), sum( a ), sum( b ) ] as 32 bit values */
+	static inline __m128i _mm256_hsum2_epi64( const __m256i& a, const __m256i& b )
+	{
+		__m256i ab = _mm256_or_si256( a, _mm256_slli_epi64( b, 32 ) );
+		ab = _mm256_add_epi32( ab, _mm256_shuffle_epi32( ab, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+		return _mm_add_epi32( _mm256_castsi256_si128( ab ), _mm256_extracti128_si256( ab, 1 ) );
+	}
+
+	void SIMDAVX2::hammingDistances( uint32_t* dst, const uint8_t* src, const uint8_t* set, size_t stride, size_t num, size_t n ) const
+	{
+		/* byte counters hold at most 8 per chunk, so up to 31 chunks can be accumulated before the sad */
+		if( ( n & 0x1f ) || n > 31 * 32 ) {
+			SIMD::hammingDistances( dst, src, set, stride, num, n );
+			return;
+		}
+
+		const __m256i lut = _mm256_setr_epi8( 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+											  0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+		const __m256i mask = _mm256_set1_epi8( 0x0f );
+		const __m256i zero = _mm256_setzero_si256();
+		const size_t chunks = n >> 5;
+
+		/* four descriptors of the set per iteration */
+		while( num >= 4 ) {
+			const uint8_t* s0 = set;
+			const uint8_t* s1 = set + stride;
+			const uint8_t* s2 = set + 2 * stride;
+			const uint8_t* s3 = set + 3 * stride;
+			__m256i c0 = zero, c1 = zero, c2 = zero, c3 = zero;
+
+			for( size_t off = 0; off < ( chunks << 5 ); off += 32 ) {
+				c0 = _mm256_add_epi8( c0, _mm256_popcnt8_xor( src + off, s0 + off, lut, mask ) );
+				c1 = _mm256_add_epi8( c1, _mm256_popcnt8_xor( src + off, s1 + off, lut, mask ) );
+				c2 = _mm256_add_epi8( c2, _mm256_popcnt8_xor( src + off, s2 + off, lut, mask ) );
+				c3 = _mm256_add_epi8( c3, _mm256_popcnt8_xor( src + off, s3 + off, lut, mask ) );
+			}
+
+			__m128i d01 = _mm256_hsum2_epi64( _mm256_sad_epu8( c0, zero ), _mm256_sad_epu8( c1, zero ) );
+			__m128i d23 = _mm256_hsum2_epi64( _mm256_sad_epu8( c2, zero ), _mm256_sad_epu8( c3, zero ) );
+			_mm_storeu_si128( ( __m128i* ) dst, _mm_unpacklo_epi64( d01, d23 ) );
+
+			dst += 4;
+			set += 4 * stride;
+			num -= 4;
+		}
+
+		while( num-- ) {
+			__m256i c = zero;
+			for( size_t off = 0; off < ( chunks << 5 ); off += 32 )
+				c = _mm256_add_epi8( c, _mm256_popcnt8_xor( src + off, set + off, lut, mask ) );
+			__m128i d = _mm256_hsum2_epi64( _mm256_sad_epu8( c, zero ), zero );
+			*dst++ = ( uint32_t ) _mm_cvtsi128_si32( d );
+			set += stride;
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::prefixSum1_u8_to_f( float * dst, size_t dstStride, const uint8_t* src, size_t srcStride, size_t width, size_t height ) const
+	{
+		const __m256i last = _mm256_set1_epi32( 7 );
+		const float* prevRow = NULL;
+
+		while( height-- ) {
+			__m256 y = _mm256_setzero_ps();
+			size_t x;
+
+			for( x = 0; x + 8 <= width; x += 8 ) {
+				__m256 v = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_loadl_epi64( ( const __m128i* ) ( src + x ) ) ) );
+				v = _mm256_add_ps( _mm256_prefixsum_ps( v ), y );
+				y = _mm256_permutevar8x32_ps( v, last );
+				if( prevRow )
+					v = _mm256_add_ps( v, _mm256_loadu_ps( prevRow + x ) );
+				_mm256_storeu_ps( dst + x, v );
+			}
+
+			float yl = _mm256_cvtss_f32( y );
+			for( ; x < width; x++ ) {
+				yl += src[ x ];
+				dst[ x ] = prevRow ? yl + prevRow[ x ] : yl;
+			}
+
+			prevRow = dst;
+			dst += dstStride;
+			src += srcStride;
+		}
+
+		_mm256_zeroupper();
+	}
+
+	void SIMDAVX2::prefixSum1_f_to_f( float * dst, size_t dstStride, const float* src, size_t srcStride, size_t width, size_t height ) const
+	{
+		const __m256i last = _mm256_set1_epi32( 7 );
+		const float* prevRow = NULL;
+
+		while( height-- ) {
+			__m256 y = _mm256_setzero_ps();
+			size_t x;
+
+			for( x = 0; x + 8 <= width; x += 8 ) {
+				__m256 v = _mm256_add_ps( _mm256_prefixsum_ps( _mm256_loadu_ps( src + x ) ), y );
+				y = _mm256_permutevar8x32_ps( v, last );
+				if( prevRow )
+					v = _mm256_add_ps( v, _mm256_loadu_ps( prevRow + x ) );
+				_mm256_storeu_ps( dst + x, v );
+			}
+
+			float yl = _mm256_cvtss_f32( y );
+			for( ; x < width; x++ ) {
+				yl += src[ x ];
+				dst[ x ] = prevRow ? yl + prevRow[ x ] : yl;
+			}
+
+			prevRow = dst;
+			dst += dstStride;
+			src += srcStride;
+		}
+
+		_mm256_zeroupper();
+	}
+
+}
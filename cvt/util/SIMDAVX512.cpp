@@ -0,0 +1,176 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/SIMDAVX512.h>
+#include <immintrin.h>
+#include <vector>
+
+namespace cvt
+{
+	/* the 512 bit versions only handle full vectors, the remainder is left to the AVX2 code */
+
+	/* row pointers of the remainder, on the stack for the usual kernel sizes */
+	static const size_t MAX_STACK_ROWS = 32;
+
+	static inline const float** restPointers( const float** buf, std::vector<const float*>& heap, size_t numw )
+	{
+		if( numw <= MAX_STACK_ROWS )
+			return buf;
+		heap.resize( numw );
+		return &heap[ 0 ];
+	}
+
+	void SIMDAVX512::ConvolveClampVert_f( float* dst, const float** bufs, const float* weights, size_t numw, size_t width ) const
+	{
+		size_t x;
+		__m512 s0, s1, mul;
+
+		for( x = 0; x + 32 <= width; x += 32 ) {
+			mul = _mm512_set1_ps( weights[ 0 ] );
+			s0 = _mm512_mul_ps( _mm512_loadu_ps( bufs[ 0 ] + x ), mul );
+			s1 = _mm512_mul_ps( _mm512_loadu_ps( bufs[ 0 ] + x + 16 ), mul );
+
+			for( size_t k = 1; k < numw; k++ ) {
+				mul = _mm512_set1_ps( weights[ k ] );
+				s0 = _mm512_fmadd_ps( _mm512_loadu_ps( bufs[ k ] + x ), mul, s0 );
+				s1 = _mm512_fmadd_ps( _mm512_loadu_ps( bufs[ k ] + x + 16 ), mul, s1 );
+			}
+			_mm512_storeu_ps( dst + x, s0 );
+			_mm512_storeu_ps( dst + x + 16, s1 );
+		}
+
+		_mm256_zeroupper();
+
+		if( x < width ) {
+			const float* rbuf[ MAX_STACK_ROWS ];
+			std::vector<const float*> rheap;
+			const float** rest = restPointers( rbuf, rheap, numw );
+			for( size_t k = 0; k < numw; k++ )
+				rest[ k ] = bufs[ k ] + x;
+			SIMDAVX2::ConvolveClampVert_f( dst + x, rest, weights, numw, width - x );
+		}
+	}
+
+	void SIMDAVX512::ConvolveClampVertSym_f( float* dst, const float** bufs, const float* weights, size_t numw, size_t width ) const
+	{
+		size_t x;
+		ssize_t b1 = ( numw >> 1 );
+		const float* wsym = weights + b1;
+		__m512 s0, s1, mul;
+
+		for( x = 0; x + 32 <= width; x += 32 ) {
+			mul = _mm512_set1_ps( wsym[ 0 ] );
+			s0 = _mm512_mul_ps( _mm512_loadu_ps( bufs[ b1 ] + x ), mul );
+			s1 = _mm512_mul_ps( _mm512_loadu_ps( bufs[ b1 ] + x + 16 ), mul );
+
+			for( ssize_t k = 1; k <= b1; k++ ) {
+				const float* lo = bufs[ b1 - k ] + x;
+				const float* hi = bufs[ b1 + k ] + x;
+				mul = _mm512_set1_ps( wsym[ k ] );
+				s0 = _mm512_fmadd_ps( _mm512_add_ps( _mm512_loadu_ps( lo ), _mm512_loadu_ps( hi ) ), mul, s0 );
+				s1 = _mm512_fmadd_ps( _mm512_add_ps( _mm512_loadu_ps( lo + 16 ), _mm512_loadu_ps( hi + 16 ) ), mul, s1 );
+			}
+			_mm512_storeu_ps( dst + x, s0 );
+			_mm512_storeu_ps( dst + x + 16, s1 );
+		}
+
+		_mm256_zeroupper();
+
+		if( x < width ) {
+			const float* rbuf[ MAX_STACK_ROWS ];
+			std::vector<const float*> rheap;
+			const float** rest = restPointers( rbuf, rheap, numw );
+			for( size_t k = 0; k < numw; k++ )
+				rest[ k ] = bufs[ k ] + x;
+			SIMDAVX2::ConvolveClampVertSym_f( dst + x, rest, weights, numw, width - x );
+		}
+	}
+
+	void SIMDAVX512::Conv_u8_to_f( float* dst, const uint8_t* src, const size_t n ) const
+	{
+		size_t i = n >> 4;
+		const __m512 scale = _mm512_set1_ps( 1.0f / 255.0f );
+
+		/* masked conversions, gcc warns about the undefined register the unmasked ones start from */
+		while( i-- ) {
+			__m512i v = _mm512_maskz_cvtepu8_epi32( 0xffff, _mm_loadu_si128( ( const __m128i* ) src ) );
+			_mm512_storeu_ps( dst, _mm512_mul_ps( _mm512_maskz_cvtepi32_ps( 0xffff, v ), scale ) );
+			src += 16;
+			dst += 16;
+		}
+
+		_mm256_zeroupper();
+
+		if( n & 0xf )
+			SIMDAVX2::Conv_u8_to_f( dst, src, n & 0xf );
+	}
+
+	void SIMDAVX512::BoxFilterVert_f( float* dst, float* accum, const float* add, const float* sub, size_t radius, size_t width ) const
+	{
+		size_t x;
+		const __m512 mul = _mm512_set1_ps( 1.0f / ( float ) ( 2 * radius + 1 ) );
+
+		for( x = 0; x + 16 <= width; x += 16 ) {
+			__m512 acc = _mm512_sub_ps( _mm512_add_ps( _mm512_loadu_ps( accum + x ), _mm512_loadu_ps( add + x ) ), _mm512_loadu_ps( sub + x ) );
+			_mm512_storeu_ps( accum + x, acc );
+			_mm512_storeu_ps( dst + x, _mm512_mul_ps( acc, mul ) );
+		}
+
+		_mm256_zeroupper();
+
+		if( x < width )
+			SIMDAVX2::BoxFilterVert_f( dst + x, accum + x, add + x, sub + x, radius, width - x );
+	}
+
+	size_t SIMDAVX512::hammingDistance( const uint8_t* src1, const uint8_t* src2, size_t n ) const
+	{
+		const __m512i lut = _mm512_set4_epi32( 0x04030302, 0x03020201, 0x03020201, 0x02010100 );
+		const __m512i mask = _mm512_set1_epi8( 0x0f );
+		const __m512i zero = _mm512_setzero_si512();
+		__m512i sum = zero;
+		size_t i = n >> 6;
+
+		while( i-- ) {
+			__m512i x = _mm512_xor_si512( _mm512_loadu_si512( src1 ), _mm512_loadu_si512( src2 ) );
+			__m512i cnt = _mm512_add_epi8( _mm512_shuffle_epi8( lut, _mm512_and_si512( x, mask ) ),
+										   _mm512_shuffle_epi8( lut, _mm512_and_si512( _mm512_srli_epi16( x, 4 ), mask ) ) );
+			sum = _mm512_add_epi64( sum, _mm512_sad_epu8( cnt, zero ) );
+			src1 += 64;
+			src2 += 64;
+		}
+
+		uint64_t lanes[ 8 ];
+		_mm512_storeu_si512( lanes, sum );
+		size_t d = 0;
+		for( size_t k = 0; k < 8; k++ )
+			d += lanes[ k ];
+
+		_mm256_zeroupper();
+
+		if( n & 0x3f )
+			d += SIMDAVX2::hammingDistance( src1, src2, n & 0x3f );
+		return d;
+	}
+
+}
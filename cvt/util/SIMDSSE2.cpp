@@ -219,6 +219,31 @@ namespace cvt
 	}
 
 
+	void SIMDSSE2::AddU8_to_U16( uint16_t* dst, const uint8_t* src, size_t n ) const
+	{
+		size_t i = n >> 4;
+		const __m128i zero = _mm_setzero_si128();
+		__m128i s, lo, hi;
+
+		while( i-- ) {
+			s = _mm_loadu_si128( ( __m128i* ) src );
+			lo = _mm_loadu_si128( ( __m128i* ) dst );
+			hi = _mm_loadu_si128( ( __m128i* ) ( dst + 8 ) );
+			lo = _mm_adds_epu16( lo, _mm_unpacklo_epi8( s, zero ) );
+			hi = _mm_adds_epu16( hi, _mm_unpackhi_epi8( s, zero ) );
+			_mm_storeu_si128( ( __m128i* ) dst, lo );
+			_mm_storeu_si128( ( __m128i* ) ( dst + 8 ), hi );
+			src += 16;
+			dst += 16;
+		}
+
+		i = n & 0xf;
+		while( i-- ) {
+			uint32_t sum = ( uint32_t ) *dst + ( uint32_t ) *src++;
+			*dst++ = sum > 0xffff ? 0xffff : sum;
+		}
+	}
+
 	size_t SIMDSSE2::SAD( uint8_t const* src1, uint8_t const* src2, const size_t n ) const
 	{
 		size_t i = n >> 4;
@@ -40,6 +40,8 @@ namespace cvt {
 			virtual void MulValue1fx( Fixed* dst, const Fixed* src, Fixed value, size_t n ) const;			
 			virtual void MulAddValue1fx( Fixed* dst, const Fixed* src, Fixed value, size_t n ) const;
 
+			virtual void AddU8_to_U16( uint16_t* dst, const uint8_t* src, size_t n ) const;
+
 			using SIMDSSE::SAD;
 			virtual size_t SAD( uint8_t const* src1, uint8_t const* src2, const size_t n ) const;
             virtual float SAD( const float* src1, const float* src2, const size_t n ) const;
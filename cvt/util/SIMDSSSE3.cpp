@@ -149,12 +149,17 @@ namespace cvt {
 		_mm_storel_epi64( ( __m128i* ) &tmp, sum );
         bitcount += tmp;
         
-        if( r ){
+        // up to 15 bytes remain, at most 8 fit into the 64 bit words
+        while( r ){
             uint64_t a = 0, b = 0;
             uint64_t xored;
+            size_t k = Math::min<size_t>( r, 8 );
 
-            Memcpy( ( uint8_t* )( &a ), src1, r );
-			Memcpy( ( uint8_t* )( &b ), src2, r );
+            Memcpy( ( uint8_t* )( &a ), src1, k );
+			Memcpy( ( uint8_t* )( &b ), src2, k );
+            src1 += k;
+            src2 += k;
+            r -= k;
 
             xored = ( a^b );
             xored = ( ( xored & 0xAAAAAAAAAAAAAAAAll ) >> 1 ) + ( xored & 0x5555555555555555ll );
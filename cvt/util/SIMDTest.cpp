@@ -27,6 +27,8 @@
 #include <cvt/util/CVTTest.h>
 #include <cvt/math/Math.h>
 #include <sstream>
+#include <algorithm>
+#include <string.h>
 
 using namespace cvt;
 
@@ -141,6 +143,330 @@ static bool _hammingTest()
     return result;
 }
 
+static bool _convolveVertTest()
+{
+	bool result = true;
+	const size_t width = 643;
+	/* the SSE kernels expect 16 byte aligned rows */
+	const size_t stride = 644;
+	const size_t numw = 5;
+	const float weights[ numw ] = { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f };
+	float* rows = new float[ numw * stride ];
+	float* ref = new float[ width ];
+	float* out = new float[ width ];
+	const float* bufs[ numw ];
+
+	for( size_t i = 0; i < numw * stride; i++ )
+		rows[ i ] = Math::rand( 0.0f, 255.0f );
+	for( size_t k = 0; k < numw; k++ )
+		bufs[ k ] = rows + k * stride;
+
+	SIMD* base = SIMD::get( SIMD_BASE );
+	base->ConvolveClampVert_f( ref, bufs, weights, numw, width );
+	delete base;
+
+	SIMDType bestType = SIMD::bestSupportedType();
+	for( int st = SIMD_BASE; st <= bestType; st++ ) {
+		SIMD* simd = SIMD::get( ( SIMDType ) st );
+		bool tRes = true;
+
+		simd->ConvolveClampVert_f( out, bufs, weights, numw, width );
+		for( size_t i = 0; i < width; i++ )
+			tRes &= Math::abs( out[ i ] - ref[ i ] ) < 1e-3f;
+		simd->ConvolveClampVertSym_f( out, bufs, weights, numw, width );
+		for( size_t i = 0; i < width; i++ )
+			tRes &= Math::abs( out[ i ] - ref[ i ] ) < 1e-3f;
+
+		result &= tRes;
+		CVTTEST_PRINT( "ConvolveClampVert " + simd->name() + ": ", tRes );
+		delete simd;
+	}
+
+	delete[] rows;
+	delete[] ref;
+	delete[] out;
+	return result;
+}
+
+static bool _boxFilterVertTest()
+{
+	bool result = true;
+	const size_t width = 643;
+	const size_t radius = 3;
+	float* add = new float[ width ];
+	float* sub = new float[ width ];
+	float* accum = new float[ width ];
+	float* refAccum = new float[ width ];
+	float* ref = new float[ width ];
+	float* out = new float[ width ];
+	uint8_t* ref8 = new uint8_t[ width ];
+	uint8_t* out8 = new uint8_t[ width ];
+
+	for( size_t i = 0; i < width; i++ ) {
+		add[ i ] = Math::rand( 0.0f, 255.0f );
+		sub[ i ] = Math::rand( 0.0f, 255.0f );
+		refAccum[ i ] = Math::rand( 255.0f, 7.0f * 255.0f );
+	}
+
+	SIMD* base = SIMD::get( SIMD_BASE );
+	std::copy( refAccum, refAccum + width, accum );
+	base->BoxFilterVert_f_to_u8( ref8, accum, add, sub, radius, width );
+	std::copy( refAccum, refAccum + width, accum );
+	base->BoxFilterVert_f( ref, accum, add, sub, radius, width );
+	delete base;
+
+	SIMDType bestType = SIMD::bestSupportedType();
+	for( int st = SIMD_BASE; st <= bestType; st++ ) {
+		SIMD* simd = SIMD::get( ( SIMDType ) st );
+		bool tRes = true;
+
+		std::copy( refAccum, refAccum + width, accum );
+		simd->BoxFilterVert_f( out, accum, add, sub, radius, width );
+		for( size_t i = 0; i < width; i++ ) {
+			tRes &= Math::abs( out[ i ] - ref[ i ] ) < 1e-3f;
+			tRes &= Math::abs( accum[ i ] - ( refAccum[ i ] + add[ i ] - sub[ i ] ) ) < 1e-3f;
+		}
+
+		/* rounding may differ from the truncation of the base version */
+		std::copy( refAccum, refAccum + width, accum );
+		simd->BoxFilterVert_f_to_u8( out8, accum, add, sub, radius, width );
+		for( size_t i = 0; i < width; i++ )
+			tRes &= Math::abs( ( int ) out8[ i ] - ( int ) ref8[ i ] ) <= 1;
+
+		result &= tRes;
+		CVTTEST_PRINT( "BoxFilterVert " + simd->name() + ": ", tRes );
+		delete simd;
+	}
+
+	delete[] add;
+	delete[] sub;
+	delete[] accum;
+	delete[] refAccum;
+	delete[] ref;
+	delete[] out;
+	delete[] ref8;
+	delete[] out8;
+	return result;
+}
+
+static bool _convTest()
+{
+	bool result = true;
+	/* pixels, not a multiple of any vector width */
+	const size_t n = 1003;
+	float* fsrc = new float[ 4 * n ];
+	uint8_t* u8src = new uint8_t[ 4 * n ];
+	float* fref = new float[ 4 * n ];
+	float* fout = new float[ 4 * n ];
+	uint8_t* u8ref = new uint8_t[ 4 * n ];
+	uint8_t* u8out = new uint8_t[ 4 * n ];
+
+	for( size_t i = 0; i < 4 * n; i++ ) {
+		fsrc[ i ] = Math::rand( -0.1f, 1.1f );
+		u8src[ i ] = ( uint8_t ) rand();
+	}
+
+	SIMD* base = SIMD::get( SIMD_BASE );
+	SIMDType bestType = SIMD::bestSupportedType();
+	for( int st = SIMD_BASE; st <= bestType; st++ ) {
+		SIMD* simd = SIMD::get( ( SIMDType ) st );
+		bool tRes = true;
+
+		base->Conv_f_to_u8( u8ref, fsrc, 4 * n );
+		simd->Conv_f_to_u8( u8out, fsrc, 4 * n );
+		for( size_t i = 0; i < 4 * n; i++ )
+			tRes &= Math::abs( ( int ) u8out[ i ] - ( int ) u8ref[ i ] ) <= 1;
+
+		base->Conv_u8_to_f( fref, u8src, 4 * n );
+		simd->Conv_u8_to_f( fout, u8src, 4 * n );
+		for( size_t i = 0; i < 4 * n; i++ )
+			tRes &= Math::abs( fout[ i ] - fref[ i ] ) < 1e-5f;
+
+		base->Conv_XYZAu8_to_ZYXAu8( u8ref, u8src, n );
+		simd->Conv_XYZAu8_to_ZYXAu8( u8out, u8src, n );
+		tRes &= memcmp( u8out, u8ref, 4 * n ) == 0;
+
+		/* the SSE4.1 and AVX2 versions approximate the sRGB curve */
+		base->Conv_XXXAu8_to_XXXAf( fref, u8src, n );
+		simd->Conv_XXXAu8_to_XXXAf( fout, u8src, n );
+		for( size_t i = 0; i < 4 * n; i++ )
+			tRes &= Math::abs( fout[ i ] - fref[ i ] ) < 5e-3f;
+
+		result &= tRes;
+		CVTTEST_PRINT( "Conv " + simd->name() + ": ", tRes );
+		delete simd;
+	}
+	delete base;
+
+	delete[] fsrc;
+	delete[] u8src;
+	delete[] fref;
+	delete[] fout;
+	delete[] u8ref;
+	delete[] u8out;
+	return result;
+}
+
+static bool _hammingDistancesTest()
+{
+	bool result = true;
+	/* descriptors of 32 and 64 byte and one with a remainder */
+	const size_t sizes[ 3 ] = { 32, 64, 45 };
+	const size_t num = 37;
+	const size_t stride = 80;
+	uint8_t* set = new uint8_t[ num * stride ];
+	uint8_t src[ 64 ];
+	uint32_t dst[ num ];
+
+	for( size_t i = 0; i < num * stride; i++ )
+		set[ i ] = ( uint8_t ) rand();
+	for( size_t i = 0; i < 64; i++ )
+		src[ i ] = ( uint8_t ) rand();
+
+	SIMD* base = SIMD::get( SIMD_BASE );
+	SIMDType bestType = SIMD::bestSupportedType();
+	for( int st = SIMD_BASE; st <= bestType; st++ ) {
+		SIMD* simd = SIMD::get( ( SIMDType ) st );
+		bool tRes = true;
+
+		for( size_t s = 0; s < 3; s++ ) {
+			simd->hammingDistances( dst, src, set, stride, num, sizes[ s ] );
+			for( size_t i = 0; i < num; i++ )
+				tRes &= dst[ i ] == base->hammingDistance( src, set + i * stride, sizes[ s ] );
+		}
+
+		result &= tRes;
+		CVTTEST_PRINT( "HammingDistances " + simd->name() + ": ", tRes );
+		delete simd;
+	}
+	delete base;
+
+	delete[] set;
+	return result;
+}
+
+static bool _prefixSumTest()
+{
+	bool result = true;
+	const size_t width = 317;
+	const size_t height = 13;
+	/* the SSE kernels expect 16 byte aligned output rows */
+	const size_t stride = 320;
+	uint8_t* src = new uint8_t[ width * height ];
+	float* ref = new float[ stride * height ];
+	float* out = new float[ stride * height ];
+
+	for( size_t i = 0; i < width * height; i++ )
+		src[ i ] = ( uint8_t ) rand();
+
+	SIMD* base = SIMD::get( SIMD_BASE );
+	base->prefixSum1_u8_to_f( ref, stride, src, width, width, height );
+	delete base;
+
+	SIMDType bestType = SIMD::bestSupportedType();
+	for( int st = SIMD_BASE; st <= bestType; st++ ) {
+		SIMD* simd = SIMD::get( ( SIMDType ) st );
+		bool tRes = true;
+
+		simd->prefixSum1_u8_to_f( out, stride, src, width, width, height );
+		for( size_t y = 0; y < height; y++ ) {
+			for( size_t x = 0; x < width; x++ )
+				tRes &= out[ y * stride + x ] == ref[ y * stride + x ];
+		}
+
+		result &= tRes;
+		CVTTEST_PRINT( "PrefixSum " + simd->name() + ": ", tRes );
+		delete simd;
+	}
+
+	delete[] src;
+	delete[] ref;
+	delete[] out;
+	return result;
+}
+
+static bool _addU8ToU16Test()
+{
+	bool result = true;
+	const size_t n = 1000 + 7;
+	uint8_t* src = new uint8_t[ n ];
+	uint16_t* start = new uint16_t[ n ];
+	uint16_t* out = new uint16_t[ n ];
+
+	for( size_t i = 0; i < n; i++ ) {
+		src[ i ] = ( uint8_t ) rand();
+		/* some values close to the saturation */
+		start[ i ] = ( i & 1 ) ? 0xffff - ( rand() & 0x1ff ) : ( uint16_t ) rand();
+	}
+
+	SIMDType bestType = SIMD::bestSupportedType();
+	for( int st = SIMD_BASE; st <= bestType; st++ ) {
+		SIMD* simd = SIMD::get( ( SIMDType ) st );
+		bool tRes = true;
+
+		/* unaligned start */
+		for( size_t i = 0; i < n; i++ )
+			out[ i ] = start[ i ];
+		simd->AddU8_to_U16( out + 1, src + 1, n - 1 );
+		tRes &= out[ 0 ] == start[ 0 ];
+		for( size_t i = 1; i < n; i++ )
+			tRes &= out[ i ] == Math::min<uint32_t>( ( uint32_t ) start[ i ] + src[ i ], 0xffff );
+
+		result &= tRes;
+		CVTTEST_PRINT( "AddU8_to_U16 " + simd->name() + ": ", tRes );
+		delete simd;
+	}
+
+	delete[] src;
+	delete[] start;
+	delete[] out;
+	return result;
+}
+
+static bool _warpBilinearTest()
+{
+	bool result = true;
+	const size_t width = 61;
+	const size_t height = 37;
+	const size_t n = 1027;
+	float* src = new float[ width * height ];
+	float* coords = new float[ 2 * n ];
+	float* ref = new float[ n ];
+	float* out = new float[ n ];
+
+	for( size_t i = 0; i < width * height; i++ )
+		src[ i ] = Math::rand( 0.0f, 1.0f );
+	/* include coordinates outside of the image to test the border handling */
+	for( size_t i = 0; i < n; i++ ) {
+		coords[ 2 * i ] = Math::rand( -2.0f, ( float ) width + 2.0f );
+		coords[ 2 * i + 1 ] = Math::rand( -2.0f, ( float ) height + 2.0f );
+	}
+
+	SIMD* base = SIMD::get( SIMD_BASE );
+	base->warpBilinear1f( ref, coords, src, width * sizeof( float ), width, height, 0.5f, n );
+	delete base;
+
+	SIMDType bestType = SIMD::bestSupportedType();
+	for( int st = SIMD_BASE; st <= bestType; st++ ) {
+		SIMD* simd = SIMD::get( ( SIMDType ) st );
+		bool tRes = true;
+
+		simd->warpBilinear1f( out, coords, src, width * sizeof( float ), width, height, 0.5f, n );
+		for( size_t i = 0; i < n; i++ )
+			tRes &= Math::abs( out[ i ] - ref[ i ] ) < 1e-5f;
+
+		result &= tRes;
+		CVTTEST_PRINT( "WarpBilinear " + simd->name() + ": ", tRes );
+		delete simd;
+	}
+
+	delete[] src;
+	delete[] coords;
+	delete[] ref;
+	delete[] out;
+	return result;
+}
+
 static bool _projectTest()
 {
 	std::vector<Vector2f> gtProjected;
@@ -335,6 +661,27 @@ BEGIN_CVTTEST( simd )
                 
         bool testResult = _hammingTest();
         CVTTEST_PRINT( "HammingDistance", testResult );
+
+		testResult = _convolveVertTest();
+		CVTTEST_PRINT( "ConvolveClampVert", testResult );
+
+		testResult = _boxFilterVertTest();
+		CVTTEST_PRINT( "BoxFilterVert", testResult );
+
+		testResult = _convTest();
+		CVTTEST_PRINT( "Conv", testResult );
+
+		testResult = _hammingDistancesTest();
+		CVTTEST_PRINT( "HammingDistances", testResult );
+
+		testResult = _prefixSumTest();
+		CVTTEST_PRINT( "PrefixSum", testResult );
+
+		testResult = _addU8ToU16Test();
+		CVTTEST_PRINT( "AddU8_to_U16", testResult );
+
+		testResult = _warpBilinearTest();
+		CVTTEST_PRINT( "WarpBilinear", testResult );
         
 		testResult = _projectTest();
         CVTTEST_PRINT( "Project Points 3d->2d", testResult );
@@ -0,0 +1,283 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/ThreadPool.h>
+#include <cvt/util/Exception.h>
+
+#include <deque>
+#include <string>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace cvt {
+
+	struct ThreadPool::Batch {
+		Batch( size_t n ) : pending( n ), failed( false ) {}
+
+		size_t		pending;
+		bool		failed;
+		std::string	error;
+		Mutex		mutex;
+		Condition	cond;
+	};
+
+	struct ThreadPool::Job {
+		Task*  task;
+		Batch* batch;
+	};
+
+	struct ThreadPool::Worker {
+		ThreadPool*		 pool;
+		size_t			 id;
+		pthread_t		 tid;
+		Mutex			 mutex;
+		std::deque<Job>	 jobs;
+	};
+
+	ThreadPool& ThreadPool::instance()
+	{
+		static ThreadPool _pool;
+		return _pool;
+	}
+
+	ThreadPool::ThreadPool() : _numQueued( 0 ), _nextQueue( 0 ), _stop( false )
+	{
+		size_t n = 0;
+		const char* env = getenv( "CVT_NUM_THREADS" );
+		if( env )
+			n = strtoul( env, NULL, 10 );
+		if( !n )
+			n = hardwareConcurrency();
+		startWorkers( n - 1 );
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		stopWorkers();
+	}
+
+	size_t ThreadPool::hardwareConcurrency()
+	{
+		long n = sysconf( _SC_NPROCESSORS_ONLN );
+		return n > 0 ? ( size_t ) n : 1;
+	}
+
+	void ThreadPool::setNumThreads( size_t n )
+	{
+		if( !n )
+			n = hardwareConcurrency();
+		if( n == numThreads() )
+			return;
+		stopWorkers();
+		startWorkers( n - 1 );
+	}
+
+	void ThreadPool::startWorkers( size_t n )
+	{
+		_stop = false;
+
+		/* the workers steal from each other - set up all queues before the first thread runs */
+		for( size_t i = 0; i < n; i++ ) {
+			Worker* w = new Worker();
+			w->pool = this;
+			w->id	= i;
+			_workers.push_back( w );
+		}
+
+		for( size_t i = 0; i < n; i++ ) {
+			int err = pthread_create( &_workers[ i ]->tid, NULL, ThreadPool::_workerMain, _workers[ i ] );
+			if( err ) {
+				_sleepMutex.lock();
+				_stop = true;
+				_sleepCond.notifyAll();
+				_sleepMutex.unlock();
+				for( size_t k = 0; k < i; k++ )
+					pthread_join( _workers[ k ]->tid, NULL );
+				for( size_t k = 0; k < n; k++ )
+					delete _workers[ k ];
+				_workers.clear();
+				throw CVTException( err );
+			}
+		}
+	}
+
+	void ThreadPool::stopWorkers()
+	{
+		_sleepMutex.lock();
+		_stop = true;
+		_sleepCond.notifyAll();
+		_sleepMutex.unlock();
+
+		/* a running worker may still look into the queues of the others */
+		for( size_t i = 0; i < _workers.size(); i++ )
+			pthread_join( _workers[ i ]->tid, NULL );
+		for( size_t i = 0; i < _workers.size(); i++ )
+			delete _workers[ i ];
+		_workers.clear();
+	}
+
+	bool ThreadPool::fetchJob( Job& job, size_t id )
+	{
+		size_t n = _workers.size();
+
+		/* own queue first - LIFO, the most recent job is the one with the hottest cache */
+		if( id < n ) {
+			Worker* w = _workers[ id ];
+			w->mutex.lock();
+			if( !w->jobs.empty() ) {
+				job = w->jobs.back();
+				w->jobs.pop_back();
+				w->mutex.unlock();
+				__sync_fetch_and_sub( &_numQueued, 1 );
+				return true;
+			}
+			w->mutex.unlock();
+		}
+
+		/* steal from the front of the other queues */
+		for( size_t i = 1; i <= n; i++ ) {
+			Worker* w = _workers[ ( id + i ) % n ];
+			w->mutex.lock();
+			if( !w->jobs.empty() ) {
+				job = w->jobs.front();
+				w->jobs.pop_front();
+				w->mutex.unlock();
+				__sync_fetch_and_sub( &_numQueued, 1 );
+				return true;
+			}
+			w->mutex.unlock();
+		}
+		return false;
+	}
+
+	void ThreadPool::executeJob( const Job& job )
+	{
+		bool failed = false;
+		std::string error;
+
+		try {
+			job.task->execute();
+		} catch( const Exception& e ) {
+			failed = true;
+			error = e.what();
+		} catch( const std::exception& e ) {
+			failed = true;
+			error = e.what();
+		} catch( ... ) {
+			failed = true;
+			error = "Unknown exception in ThreadPool task";
+		}
+
+		Batch* batch = job.batch;
+		batch->mutex.lock();
+		if( failed && !batch->failed ) {
+			batch->failed = true;
+			batch->error  = error;
+		}
+		if( !--batch->pending )
+			batch->cond.notifyAll();
+		batch->mutex.unlock();
+	}
+
+	void ThreadPool::run( Task** tasks, size_t n )
+	{
+		if( !n )
+			return;
+
+		size_t nworkers = _workers.size();
+		if( !nworkers || n == 1 ) {
+			for( size_t i = 0; i < n; i++ )
+				tasks[ i ]->execute();
+			return;
+		}
+
+		Batch batch( n );
+
+		size_t start = __sync_fetch_and_add( &_nextQueue, n );
+		for( size_t i = 0; i < n; i++ ) {
+			Worker* w = _workers[ ( start + i ) % nworkers ];
+			Job job;
+			job.task  = tasks[ i ];
+			job.batch = &batch;
+			w->mutex.lock();
+			w->jobs.push_back( job );
+			w->mutex.unlock();
+		}
+
+		_sleepMutex.lock();
+		__sync_fetch_and_add( &_numQueued, n );
+		_sleepCond.notifyAll();
+		_sleepMutex.unlock();
+
+		/* help until our batch is done */
+		for( ;; ) {
+			batch.mutex.lock();
+			bool done = !batch.pending;
+			batch.mutex.unlock();
+			if( done )
+				break;
+
+			Job job;
+			if( fetchJob( job, nworkers ) ) {
+				executeJob( job );
+			} else {
+				/* all remaining jobs of this batch are in flight */
+				batch.mutex.lock();
+				while( batch.pending )
+					batch.cond.wait( batch.mutex );
+				batch.mutex.unlock();
+				break;
+			}
+		}
+
+		if( batch.failed )
+			throw CVTException( batch.error );
+	}
+
+	void* ThreadPool::_workerMain( void* arg )
+	{
+		Worker* w = ( Worker* ) arg;
+		ThreadPool* pool = w->pool;
+		Job job;
+
+		for( ;; ) {
+			if( pool->fetchJob( job, w->id ) ) {
+				pool->executeJob( job );
+				continue;
+			}
+
+			/* _numQueued is decremented without the sleep mutex, so read it atomically */
+			pool->_sleepMutex.lock();
+			while( !__sync_add_and_fetch( &pool->_numQueued, 0 ) && !pool->_stop )
+				pool->_sleepCond.wait( pool->_sleepMutex );
+			bool stop = pool->_stop && !__sync_add_and_fetch( &pool->_numQueued, 0 );
+			pool->_sleepMutex.unlock();
+
+			if( stop )
+				break;
+		}
+		return NULL;
+	}
+
+}
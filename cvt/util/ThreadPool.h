@@ -0,0 +1,107 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_THREADPOOL_H
+#define CVT_THREADPOOL_H
+
+#include <cvt/util/Mutex.h>
+#include <cvt/util/Condition.h>
+
+#include <vector>
+#include <stdlib.h>
+
+namespace cvt {
+
+	/**
+	 *	\class ThreadPool
+	 *	\brief Process wide work-stealing thread pool.
+	 *
+	 *	Each worker owns a task queue. The tasks of a run() call are spread round-robin over
+	 *	the queues, a worker pops from the back of its own queue and steals from the front of
+	 *	the other queues when it runs dry. The thread calling run() helps executing tasks
+	 *	until all tasks of its batch are done, so nested run() calls from inside a task are fine.
+	 */
+	class ThreadPool {
+		public:
+			class Task {
+				public:
+					virtual		 ~Task() {}
+					virtual void execute() = 0;
+			};
+
+			static ThreadPool& instance();
+
+			/**
+			 *	\brief Execute the tasks and wait for all of them to finish
+			 *	\param tasks	array of tasks
+			 *	\param n		number of tasks
+			 *
+			 *	Exceptions thrown by a task are caught and re-thrown as CVTException after all
+			 *	tasks of the batch finished.
+			 */
+			void			run( Task** tasks, size_t n );
+
+			/**
+			 *	\brief Set the number of threads used by the pool including the calling thread.
+			 *	\param n	number of threads, 0 selects the number of online cpus
+			 *
+			 *	Must not be called while tasks are running.
+			 */
+			void			setNumThreads( size_t n );
+			size_t			numThreads() const;
+
+			static size_t	hardwareConcurrency();
+
+		private:
+			ThreadPool();
+			~ThreadPool();
+			ThreadPool( const ThreadPool& );
+			ThreadPool& operator=( const ThreadPool& );
+
+			struct Batch;
+			struct Job;
+			struct Worker;
+
+			void			startWorkers( size_t n );
+			void			stopWorkers();
+			bool			fetchJob( Job& job, size_t id );
+			void			executeJob( const Job& job );
+			static void*	_workerMain( void* arg );
+
+			std::vector<Worker*> _workers;
+			Mutex				 _sleepMutex;
+			Condition			 _sleepCond;
+			volatile size_t		 _numQueued;
+			volatile size_t		 _nextQueue;
+			bool				 _stop;
+	};
+
+	inline size_t ThreadPool::numThreads() const
+	{
+		return _workers.size() + 1;
+	}
+
+}
+
+#endif
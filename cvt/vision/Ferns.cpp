@@ -24,64 +24,180 @@
 
 #include <cvt/vision/Ferns.h>
 
-#include <cvt/vision/FAST.h>
+#include <cvt/vision/features/FAST.h>
+#include <cvt/vision/features/FeatureSet.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/SIMD.h>
+#include <cvt/util/Exception.h>
+
+#include <fstream>
+#include <sstream>
 
 namespace cvt
 {
+	/* the leaf tables have 2^tests entries per class */
+	static const uint32_t MAX_TESTS_PER_FERN = 24;
+
+	static void _checkRead( const std::istringstream & strTok, const std::string & fileName )
+	{
+		if( strTok.fail() )
+			throw CVTException( "Ferns: could not read file " + fileName );
+	}
+
+	/* trains the classes [ start, end ), each band uses its own patch generator and leaf histograms */
+	class Ferns::TrainRows : public ParallelRows::Body
+	{
+		public:
+			TrainRows( std::vector<Fern> & ferns, const std::vector<Feature> & features, const Image & img,
+					   uint32_t patchSize, uint32_t samples, uint64_t seed ) :
+				_ferns( ferns ), _features( features ), _img( img ),
+				_patchSize( patchSize ), _samples( samples ), _seed( seed )
+			{
+			}
+
+			void process( size_t start, size_t end ) const
+			{
+				PatchGenerator patchGen( Rangef( 0.0f, Math::TWO_PI ), Rangef( 0.6f, 1.5f ), _patchSize, 3.0 /* noise */ );
+				Image patch( _patchSize, _patchSize, _img.format() );
+				size_t numLeaves = _ferns[ 0 ].numLeaves();
+				std::vector<uint32_t> counts( _ferns.size() * numLeaves );
+				size_t pStride;
+
+				for( size_t c = start; c < end; c++ ){
+					/* seed per class, the training does not depend on the band layout */
+					patchGen.setSeed( _seed + c + 1 );
+					counts.assign( counts.size(), 0 );
+
+					for( uint32_t i = 0; i < _samples; i++ ){
+						patchGen.next( patch, _img, _features[ c ].pt );
+
+						const uint8_t * p = patch.map( &pStride );
+						for( size_t f = 0; f < _ferns.size(); f++ )
+							counts[ f * numLeaves + _ferns[ f ].test( p, pStride ) ]++;
+						patch.unmap( p );
+					}
+
+					for( size_t f = 0; f < _ferns.size(); f++ )
+						_ferns[ f ].setClass( c, &counts[ f * numLeaves ], _samples );
+				}
+			}
+
+		private:
+			std::vector<Fern> &				_ferns;
+			const std::vector<Feature> &	_features;
+			const Image &					_img;
+			uint32_t						_patchSize;
+			uint32_t						_samples;
+			uint64_t						_seed;
+	};
+
+	/* classifies the features [ start, end ) */
+	class Ferns::MatchRows : public ParallelRows::Body
+	{
+		public:
+			MatchRows( const Ferns & ferns, const std::vector<Eigen::Vector2i> & features, const Image & img,
+					   const uint8_t * p, size_t stride, std::vector<size_t> & classes, std::vector<double> & probs ) :
+				_ferns( ferns ), _features( features ), _img( img ), _p( p ), _stride( stride ),
+				_classes( classes ), _probs( probs )
+			{
+			}
+
+			void process( size_t start, size_t end ) const
+			{
+				std::vector<uint16_t> scores( _ferns._ferns[ 0 ].classStride() );
+				int32_t patchHalfSize = _ferns._patchSize >> 1;
+
+				for( size_t i = start; i < end; i++ ){
+					const Eigen::Vector2i & pt = _features[ i ];
+					if( !_ferns.insideImage( _img, pt[ 0 ], pt[ 1 ] ) ){
+						_probs[ i ] = 0.0;
+						continue;
+					}
+
+					const uint8_t * uL = _p + _stride * ( pt[ 1 ] - patchHalfSize ) + pt[ 0 ] - patchHalfSize;
+					size_t best = _ferns.classScores( &scores[ 0 ], uL, _stride );
+					_classes[ i ] = best;
+					_probs[ i ] = _ferns.probability( &scores[ 0 ], best );
+				}
+			}
+
+		private:
+			const Ferns &						_ferns;
+			const std::vector<Eigen::Vector2i> &	_features;
+			const Image &						_img;
+			const uint8_t *						_p;
+			size_t								_stride;
+			std::vector<size_t> &				_classes;
+			std::vector<double> &				_probs;
+	};
 
 	Ferns::Ferns( uint32_t patchSize, uint32_t numOverallTests, uint32_t numFerns ) :
 		_patchSize( patchSize ),
 		_numFerns( numFerns ),
 		_nTests( numOverallTests ),
 		_trainingSamples( 15000 ),
-		_featureDetector( 0 )
+		_seed( time( NULL ) )
 	{
+		/* the summed costs of 256 ferns still fit into uint16_t */
+		if( _numFerns == 0 || _numFerns > 256 )
+			throw CVTException( "Ferns: number of ferns has to be in [ 1, 256 ]" );
+
 		_ferns.reserve( numFerns );
 
 		while( ( _nTests % _numFerns ) != 0 ){
 			_nTests++;
 		}
 		_testsPerFern = _nTests / _numFerns;
-
-		_featureDetector = new FAST( SEGMENT_9 );
-		_featureDetector->setThreshold( 40 );
+		if( _testsPerFern > MAX_TESTS_PER_FERN )
+			throw CVTException( "Ferns: number of tests per fern has to be in [ 1, 24 ]" );
 	}
 
-	Ferns::Ferns( const std::string & fileName ) : _featureDetector( 0 )
+	Ferns::Ferns( const std::string & fileName ) :
+		_trainingSamples( 15000 ),
+		_seed( time( NULL ) )
 	{
 		std::ifstream file;
 		std::string line;
 		std::istringstream strTok;
 
 		file.open( fileName.c_str(), std::ifstream::in );
+		if( !file.is_open() )
+			throw CVTException( "Ferns: could not open file " + fileName );
 
 		getline( file, line );
 		strTok.str( line );
 		strTok >> _patchSize;
+		_checkRead( strTok, fileName );
 
 		getline( file, line );
 		strTok.clear();
 		strTok.str( line );
 		strTok >> _numFerns;
+		/* same bound as for trained ferns, matching sums the costs of all ferns in uint16_t */
+		if( strTok.fail() || _numFerns == 0 || _numFerns > 256 )
+			throw CVTException( "Ferns: number of ferns has to be in [ 1, 256 ] in file " + fileName );
 
 		getline( file, line );
 		strTok.clear();
 		strTok.str( line );
 		strTok >> _nTests;
+		_checkRead( strTok, fileName );
 
 		getline( file, line );
 		strTok.clear();
 		strTok.str( line );
 		strTok >> _testsPerFern;
+		if( strTok.fail() || _testsPerFern == 0 || _testsPerFern > MAX_TESTS_PER_FERN )
+			throw CVTException( "Ferns: number of tests per fern has to be in [ 1, 24 ] in file " + fileName );
 
 		uint32_t numFeatures;
 		getline( file, line );
 		strTok.clear();
 		strTok.str( line );
 		strTok >> numFeatures;
+		_checkRead( strTok, fileName );
 
-        int x, y;
-		std::string lineVal;
+		float x, y;
 		for( size_t i = 0; i < numFeatures; i++ ){
 			getline( file, line );
 
@@ -89,8 +205,9 @@ namespace cvt
 			strTok.str( line );
 			strTok >> x;
 			strTok >> y;
+			_checkRead( strTok, fileName );
 
-			_modelFeatures.push_back( Feature2Df( x, y ) );
+			_modelFeatures.push_back( Feature( x, y ) );
 		}
 
 		uint32_t numProbs;
@@ -100,13 +217,19 @@ namespace cvt
 			strTok.clear();
 			strTok.str( line );
 			strTok >> numProbs;
+			/* one row per leaf, more would be written past the table */
+			if( strTok.fail() || numProbs != ( 1u << _testsPerFern ) )
+				throw CVTException( "Ferns: number of probabilities does not match the tests per fern in file " + fileName );
 
 			getline( file, line );
 			strTok.clear();
 			strTok.str( line );
 			strTok >> regPrior;
+			_checkRead( strTok, fileName );
 
 			_ferns.push_back( Fern( _testsPerFern, _patchSize ) );
+			_ferns.back().allocate( _modelFeatures.size() );
+
 			Eigen::Vector2i p0, p1;
 			for( uint32_t t = 0; t < _testsPerFern; t++ ){
 				getline( file, line );
@@ -118,6 +241,7 @@ namespace cvt
 				strTok >> p0[ 1 ];
 				strTok >> p1[ 0 ];
 				strTok >> p1[ 1 ];
+				_checkRead( strTok, fileName );
 				_ferns.back().addTest( p0, p1 );
 			}
 
@@ -128,22 +252,26 @@ namespace cvt
 				strTok.str( line );
 				for( size_t c = 0; c < _modelFeatures.size(); c++ ){
 					strTok >> prob;
-					_ferns.back().setProbabilityForTest( p, c, prob );
+					_checkRead( strTok, fileName );
+					_ferns.back().setLogProbability( p, c, prob );
 				}
-
 			}
 		}
 	}
 
 	Ferns::~Ferns()
 	{
-		if( _featureDetector )
-			delete _featureDetector;
 	}
 
 	void Ferns::train( const Image & img )
 	{
-		RNG rng( time( NULL ) );
+		if( img.format() != IFormat::GRAY_UINT8 )
+			throw CVTException( "Ferns: only GRAY_UINT8 images are supported" );
+
+		RNG rng( _seed );
+
+		_ferns.clear();
+		_modelFeatures.clear();
 
 		Eigen::Vector2i x0, x1;
 		for( uint32_t i = 0; i < _numFerns; i++ ){
@@ -160,145 +288,89 @@ namespace cvt
 		}
 
 		// detect features in the "model"-image
-		std::vector<Feature2Df> features;
-        VectorFeature2DInserter<float> inserter( features );
-		_featureDetector->extract( img, inserter );
-
-		int32_t patchHalfSize = _patchSize >> 1;
-
-		/* train the class */
-		PatchGenerator patchGen( Rangef( 0.0f, Math::TWO_PI ), Rangef( 0.6f, 1.5f ), _patchSize, 3.0 /* noise */ );
+		FeatureSet features;
+		FAST detector( SEGMENT_9, 40 );
+		detector.detect( features, img );
 
-		int x, y;
 		for( size_t i = 0; i < features.size(); i++ ){
-			std::cout << "FEATURE " << i+1 << " / " << features.size() << std::endl;
-			x = features[ i ].pt.x;
-			y = features[ i ].pt.y;
-
-			if( ( x - patchHalfSize ) < 0 ||
-			 	( x + patchHalfSize ) >= ( int32_t )img.width() ||
-				( y - patchHalfSize ) < 0 ||
-				( y + patchHalfSize ) >= ( int32_t )img.height() )
-				continue;
+			if( insideImage( img, ( int32_t ) features[ i ].pt.x, ( int32_t ) features[ i ].pt.y ) )
+				_modelFeatures.push_back( Feature( ( int32_t ) features[ i ].pt.x, ( int32_t ) features[ i ].pt.y ) );
+		}
 
-			_modelFeatures.push_back( features[ i ] );
+		if( _modelFeatures.empty() )
+			return;
 
-			this->trainClass( _modelFeatures.size() - 1, patchGen, img );
-		}
+		for( size_t i = 0; i < _ferns.size(); i++ )
+			_ferns[ i ].allocate( _modelFeatures.size() );
 
-		for( size_t i = 0; i < _ferns.size(); i++ ){
-			_ferns[ i ].normalizeStatistics( _trainingSamples );
-		}
+		/* one row per class, the width only estimates the work for the serial threshold */
+		TrainRows body( _ferns, _modelFeatures, img, _patchSize, _trainingSamples, _seed );
+		ParallelRows::run( body, ( size_t ) _trainingSamples * _patchSize * _patchSize, _modelFeatures.size() );
 	}
 
 	void Ferns::match( const::std::vector<Eigen::Vector2i> & features,
 					   const Image & img,
 					   std::vector<Eigen::Vector2d> & matchedModel,
-					   std::vector<Eigen::Vector2d> & matchedFeatures )
+					   std::vector<Eigen::Vector2d> & matchedFeatures ) const
 	{
-		std::vector<double> bestProbsForPoint( _modelFeatures.size(), 0.0 );
-		std::vector<size_t> featureIndicesForPoint( _modelFeatures.size(), 0 );
+		if( _modelFeatures.empty() || features.empty() )
+			return;
 
-		int32_t patchHalfSize = _patchSize >> 1;
+		if( img.format() != IFormat::GRAY_UINT8 )
+			throw CVTException( "Ferns: only GRAY_UINT8 images are supported" );
+
+		std::vector<size_t> classes( features.size(), 0 );
+		std::vector<double> probs( features.size(), 0.0 );
 
 		size_t stride;
 		const uint8_t * p = img.map( &stride );
 
-		uint32_t testResult;
-		for( size_t i = 0; i < features.size(); i++ ){
-			if( features[ i ][ 0 ] - patchHalfSize < 0 ||
-			    features[ i ][ 0 ] + patchHalfSize > ( int32_t )img.width() ||
-			    features[ i ][ 1 ] - patchHalfSize < 0 ||
-			    features[ i ][ 1 ] + patchHalfSize > ( int32_t )img.height() ){
-				continue;
-			}
-
-			const uint8_t * uL = p + stride * ( features[ i ][ 1 ] - patchHalfSize ) + features[ i ][ 0 ] - patchHalfSize;
-			std::vector<double> classProbs( _modelFeatures.size(), 0.0 );
-
-
-			for( size_t f = 0; f < _ferns.size(); f++) {
-				testResult = _ferns[ f ].test( uL, stride );
-				const std::vector<double> & trainedProbabilities = _ferns[ f ].probsForResult( testResult );
-				for( size_t k = 0; k < trainedProbabilities.size(); k++ ){
-					classProbs[ k ] += trainedProbabilities[ k ];
-				}
-			}
-
-			size_t bestIdx = 0;
-			double probSum = exp( classProbs[ 0 ] );
-			for( size_t k = 1; k < classProbs.size(); k++ ){
-				probSum += exp( classProbs[ k ] );
-				if( classProbs[ k ] > classProbs[ bestIdx ] )
-					bestIdx = k;
-			}
+		MatchRows body( *this, features, img, p, stride, classes, probs );
+		ParallelRows::run( body, _ferns.size() * _ferns[ 0 ].classStride(), features.size() );
 
-			double probability = exp( classProbs[ bestIdx ] ) / probSum;
+		img.unmap( p );
 
-			if( probability > bestProbsForPoint[ bestIdx ] ){
-				bestProbsForPoint[ bestIdx ] = probability;
-				featureIndicesForPoint[ bestIdx ] = i;
+		/* best feature per class, ties go to the first feature */
+		std::vector<double> bestProbsForPoint( _modelFeatures.size(), 0.0 );
+		std::vector<size_t> featureIndicesForPoint( _modelFeatures.size(), 0 );
+		for( size_t i = 0; i < features.size(); i++ ){
+			if( probs[ i ] > bestProbsForPoint[ classes[ i ] ] ){
+				bestProbsForPoint[ classes[ i ] ] = probs[ i ];
+				featureIndicesForPoint[ classes[ i ] ] = i;
 			}
 		}
-		img.unmap( p );
 
-		// no check the result:
 		for( size_t i = 0; i < bestProbsForPoint.size(); i++ ){
-			std::cout << "Prob: " << bestProbsForPoint[ i ] << std::endl;
 			if( bestProbsForPoint[ i ] > 0.96 ){
 				matchedModel.push_back( Eigen::Vector2d( _modelFeatures[ i ].pt.x, _modelFeatures[ i ].pt.y ) );
 				matchedFeatures.push_back( features[ featureIndicesForPoint[ i ] ].cast<double>() );
 			}
 		}
-
 	}
 
-	double Ferns::classify( Eigen::Vector2i & bestClass, const Image & img, const Eigen::Vector2i & p )
+	double Ferns::classify( Eigen::Vector2i & bestClass, const Image & img, const Eigen::Vector2i & p ) const
 	{
-		size_t imStride;
+		if( _modelFeatures.empty() || !insideImage( img, p[ 0 ], p[ 1 ] ) )
+			return 0.0;
 
-        const uint8_t * imP = img.map( &imStride );
+		size_t imStride;
+		const uint8_t * imP = img.map( &imStride );
 		int32_t patchHalfSize = _patchSize >> 1;
 
-        if( p[ 0 ] - patchHalfSize < 0 ||
-            p[ 0 ] + patchHalfSize > ( int32_t )img.width() ||
-            p[ 1 ] - patchHalfSize < 0 ||
-            p[ 1 ] + patchHalfSize > ( int32_t )img.height() )
-            return 0.0f;
-
 		const uint8_t * uL = imP + imStride * ( p[ 1 ] - patchHalfSize ) + p[ 0 ] - patchHalfSize;
 
-		std::vector<double> classProbs( _modelFeatures.size(), 0.0 );
-
-		uint32_t testResult;
-
-		// for each fern
-		for( size_t i = 0; i < _ferns.size(); i++ ){
-			testResult = _ferns[ i ].test( uL, imStride );
-			const std::vector<double> & trainedProbs = _ferns[ i ].probsForResult( testResult );
-
-			for( size_t f = 0; f < trainedProbs.size(); f++ ){
-				classProbs[ f ] += trainedProbs[ f ];
-			}
-		}
+		std::vector<uint16_t> scores( _ferns[ 0 ].classStride() );
+		size_t bestIdx = classScores( &scores[ 0 ], uL, imStride );
 
 		img.unmap( imP );
 
-		uint32_t bestIdx = 0;
-		double probSum = 0.0;
-		for( size_t i = 0; i < classProbs.size(); i++ ){
-			probSum += exp( classProbs[ i ] );
-			if( classProbs[ i ] > classProbs[ bestIdx ] )
-				bestIdx = i;
-		}
-
 		bestClass[ 0 ] = _modelFeatures[ bestIdx ].pt.x;
 		bestClass[ 1 ] = _modelFeatures[ bestIdx ].pt.y;
 
-		return exp( classProbs[ bestIdx ] ) / probSum;
+		return probability( &scores[ 0 ], bestIdx );
 	}
 
-	void Ferns::save( const std::string & fileName )
+	void Ferns::save( const std::string & fileName ) const
 	{
 		std::ofstream out;
 
@@ -321,24 +393,46 @@ namespace cvt
 		out.close();
 	}
 
-	void Ferns::trainClass( size_t idx, PatchGenerator & patchGen, const Image & img )
+	bool Ferns::insideImage( const Image & img, int32_t x, int32_t y ) const
 	{
-		Image patch( _patchSize, _patchSize, img.format() );
-		size_t pStride;
-		uint8_t * p;
+		int32_t patchHalfSize = _patchSize >> 1;
+		return x - patchHalfSize >= 0 &&
+			   x - patchHalfSize + ( int32_t ) _patchSize <= ( int32_t ) img.width() &&
+			   y - patchHalfSize >= 0 &&
+			   y - patchHalfSize + ( int32_t ) _patchSize <= ( int32_t ) img.height();
+	}
 
-		for( size_t i = 0; i < _trainingSamples; i++ ) {
-			// generate a new patch
-			patchGen.next( patch, img, _modelFeatures[ idx ].pt );
+	/* sum of the quantized class costs over all ferns, returns the class with the lowest cost */
+	size_t Ferns::classScores( uint16_t * scores, const uint8_t * uL, size_t stride ) const
+	{
+		SIMD * simd = SIMD::instance();
+		size_t n = _ferns[ 0 ].classStride();
 
-			p = patch.map( &pStride );
+		memset( scores, 0, sizeof( uint16_t ) * n );
+		for( size_t f = 0; f < _ferns.size(); f++ )
+			simd->AddU8_to_U16( scores, _ferns[ f ].scores( _ferns[ f ].test( uL, stride ) ), n );
 
-			// train each fern
-			for( size_t f = 0; f < _ferns.size(); f++ ){
-				_ferns[ f ].trainClass( idx , p,  pStride );
-			}
+		size_t best = 0;
+		for( size_t c = 1; c < _modelFeatures.size(); c++ ){
+			if( scores[ c ] < scores[ best ] )
+				best = c;
+		}
+		return best;
+	}
+
+	/* posterior of the best class, assuming equal class priors */
+	double Ferns::probability( const uint16_t * scores, size_t best ) const
+	{
+		/* classes more than 32 nats worse do not change the result */
+		const uint32_t maxDiff = 32 * Fern::LOG_SCALE;
+		const double scale = 1.0 / ( double ) Fern::LOG_SCALE;
 
-			patch.unmap( p );
+		double probSum = 0.0;
+		for( size_t c = 0; c < _modelFeatures.size(); c++ ){
+			uint32_t diff = scores[ c ] - scores[ best ];
+			if( diff < maxDiff )
+				probSum += Math::exp( -( double ) diff * scale );
 		}
+		return 1.0 / probSum;
 	}
-}
\ No newline at end of file
+}
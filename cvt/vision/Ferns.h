@@ -28,7 +28,7 @@
 #include <cvt/gfx/Image.h>
 #include <cvt/vision/PatchGenerator.h>
 #include <cvt/vision/internal/Fern.h>
-#include <cvt/vision/FAST.h>
+#include <cvt/vision/features/Feature.h>
 
 #include <Eigen/Core>
 #include <vector>
@@ -38,6 +38,16 @@
 namespace cvt 
 {
 	
+	/**
+	 *	\class Ferns
+	 *	\brief Keypoint recognition with random ferns.
+	 *
+	 *	Every FAST corner of the model image is a class. The ferns store quantized log-probabilities
+	 *	for all classes, a patch is classified by summing the class costs of all ferns with
+	 *	SIMD::AddU8_to_U16. Training of the classes and matching of the features are spread
+	 *	across the ParallelRows threads, the results do not depend on the number of threads.
+	 *	Only GRAY_UINT8 images are supported.
+	 */
 	class Ferns 
 	{
 		
@@ -46,30 +56,42 @@ namespace cvt
 			Ferns( const std::string & fileName );
 			~Ferns();
 			
+			/* seed for the tests and the training patches, training with the same seed is reproducible */
+			void setSeed( uint64_t seed ) { _seed = seed; }
+			/* number of generated patches per class */
+			void setTrainingSamples( uint32_t n ) { _trainingSamples = n; }
+
 			void train( const Image & img );
+
+			size_t numClasses() const { return _modelFeatures.size(); }
 			
-			double classify( Eigen::Vector2i & bestClass, const Image & img, const Eigen::Vector2i & p );
+			double classify( Eigen::Vector2i & bestClass, const Image & img, const Eigen::Vector2i & p ) const;
 		
 			void match( const::std::vector<Eigen::Vector2i> & features,
 						const Image & img,
 						std::vector<Eigen::Vector2d> & matchedModel,
-					    std::vector<Eigen::Vector2d> & matchedFeatures );
+					    std::vector<Eigen::Vector2d> & matchedFeatures ) const;
 			
-			void save( const std::string & fileName );
+			void save( const std::string & fileName ) const;
 			
 		private:						
+			class TrainRows;
+			class MatchRows;
+
 			uint32_t	_patchSize;
 			uint32_t	_numFerns;
 			uint32_t 	_nTests;
 			uint32_t	_testsPerFern;
 			uint32_t	_trainingSamples;
+			uint64_t	_seed;
 			
 			std::vector<Fern>				_ferns;						
-			FAST*                           _featureDetector;			
-			std::vector<Feature2Df>	_modelFeatures;	
+			std::vector<Feature>			_modelFeatures;	
 
-			void trainClass( size_t idx, PatchGenerator & patchGen, const Image & img );
+			bool	insideImage( const Image & img, int32_t x, int32_t y ) const;
+			size_t	classScores( uint16_t * scores, const uint8_t * uL, size_t stride ) const;
+			double	probability( const uint16_t * scores, size_t best ) const;
 	};
 	
 }
-#endif
\ No newline at end of file
+#endif
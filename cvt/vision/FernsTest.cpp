@@ -0,0 +1,207 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/Ferns.h>
+#include <cvt/vision/features/FAST.h>
+#include <cvt/vision/features/FeatureSet.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/RNG.h>
+#include <cvt/util/Time.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+using namespace cvt;
+
+/* random rectangles with constant intensity, lots of strong corners */
+static void _modelImage( Image& img, size_t w, size_t h )
+{
+	RNG rng( 1234 );
+	img.reallocate( w, h, IFormat::GRAY_UINT8 );
+
+	size_t stride;
+	uint8_t* p = img.map( &stride );
+	for( size_t y = 0; y < h; y++ )
+		memset( p + y * stride, 128, w );
+
+	for( size_t r = 0; r < 20; r++ ) {
+		int x0 = rng.uniform( 0, ( int ) w - 20 );
+		int y0 = rng.uniform( 0, ( int ) h - 20 );
+		int rw = rng.uniform( 6, 30 );
+		int rh = rng.uniform( 6, 30 );
+		uint8_t val = ( uint8_t ) rng.uniform( 0, 255 );
+		for( int y = y0; y < Math::min( y0 + rh, ( int ) h ); y++ )
+			for( int x = x0; x < Math::min( x0 + rw, ( int ) w ); x++ )
+				p[ y * stride + x ] = val;
+	}
+	img.unmap( p );
+}
+
+/* dst( x + dx, y + dy ) = src( x, y ) */
+static void _shiftImage( Image& dst, const Image& src, int dx, int dy )
+{
+	dst.reallocate( src.width(), src.height(), IFormat::GRAY_UINT8 );
+
+	size_t sstride, dstride;
+	const uint8_t* s = src.map( &sstride );
+	uint8_t* d = dst.map( &dstride );
+	for( int y = 0; y < ( int ) src.height(); y++ ) {
+		for( int x = 0; x < ( int ) src.width(); x++ ) {
+			int sx = Math::clamp( x - dx, 0, ( int ) src.width() - 1 );
+			int sy = Math::clamp( y - dy, 0, ( int ) src.height() - 1 );
+			d[ y * dstride + x ] = s[ sy * sstride + sx ];
+		}
+	}
+	dst.unmap( d );
+	src.unmap( s );
+}
+
+static void _detect( std::vector<Eigen::Vector2i>& pts, const Image& img )
+{
+	FeatureSet features;
+	FAST detector( SEGMENT_9, 40 );
+	detector.detect( features, img );
+	for( size_t i = 0; i < features.size(); i++ )
+		pts.push_back( Eigen::Vector2i( ( int ) features[ i ].pt.x, ( int ) features[ i ].pt.y ) );
+}
+
+static std::string _serialized( const Ferns& ferns, const std::string& file )
+{
+	ferns.save( file );
+	std::ifstream in( file.c_str() );
+	std::stringstream ss;
+	ss << in.rdbuf();
+	return ss.str();
+}
+
+BEGIN_CVTTEST( Ferns )
+	bool result = true;
+	const int dx = 5, dy = 3;
+
+	Image model, shifted;
+	_modelImage( model, 128, 96 );
+	_shiftImage( shifted, model, dx, dy );
+
+	std::vector<Eigen::Vector2i> pts;
+	_detect( pts, shifted );
+
+	Ferns ferns( 21, 300, 30 );
+	ferns.setSeed( 42 );
+	ferns.setTrainingSamples( 400 );
+
+	Time t;
+	ferns.train( model );
+	std::cout << "Ferns: trained " << ferns.numClasses() << " classes in " << t.elapsedMilliSeconds() << "ms" << std::endl;
+	CVTTEST_PRINT( "classes", ferns.numClasses() > 20 );
+	result &= ferns.numClasses() > 20;
+
+	std::vector<Eigen::Vector2d> matchedModel, matchedFeatures;
+	t.reset();
+	ferns.match( pts, shifted, matchedModel, matchedFeatures );
+	std::cout << "Ferns: matched " << matchedModel.size() << " of " << pts.size() << " features in " << t.elapsedMilliSeconds() << "ms" << std::endl;
+
+	size_t correct = 0;
+	for( size_t i = 0; i < matchedModel.size(); i++ ) {
+		Eigen::Vector2d d = matchedFeatures[ i ] - matchedModel[ i ] - Eigen::Vector2d( dx, dy );
+		if( d.norm() <= 2.0 )
+			correct++;
+	}
+	std::cout << "Ferns: " << correct << " correct matches" << std::endl;
+	bool b = matchedModel.size() >= 10 && correct * 4 >= matchedModel.size() * 3;
+	CVTTEST_PRINT( "match shifted image", b );
+	result &= b;
+
+	/* classify agrees with match */
+	b = true;
+	for( size_t i = 0; i < matchedModel.size(); i++ ) {
+		Eigen::Vector2i cls;
+		double prob = ferns.classify( cls, shifted, matchedFeatures[ i ].cast<int>() );
+		b &= prob > 0.96 && cls == matchedModel[ i ].cast<int>();
+	}
+	CVTTEST_PRINT( "classify", b );
+	result &= b;
+
+	/* training does not depend on the number of threads */
+	std::string fileThreaded( "ferns_threaded.txt" ), fileSerial( "ferns_serial.txt" );
+	Ferns serial( 21, 300, 30 );
+	serial.setSeed( 42 );
+	serial.setTrainingSamples( 400 );
+	{
+		ParallelRows::ScopedNumThreads single( 1 );
+		serial.train( model );
+	}
+	std::string strThreaded = _serialized( ferns, fileThreaded );
+	b = strThreaded == _serialized( serial, fileSerial );
+	CVTTEST_PRINT( "threaded == serial", b );
+	result &= b;
+
+	/* save / load roundtrip */
+	Ferns loaded( fileThreaded );
+	b = loaded.numClasses() == ferns.numClasses() && _serialized( loaded, fileSerial ) == strThreaded;
+	std::vector<Eigen::Vector2d> loadedModel, loadedFeatures;
+	loaded.match( pts, shifted, loadedModel, loadedFeatures );
+	b &= loadedModel == matchedModel && loadedFeatures == matchedFeatures;
+	CVTTEST_PRINT( "save / load", b );
+	result &= b;
+
+	/* a file with more ferns than the matching can sum up is rejected */
+	{
+		std::ofstream out( fileSerial.c_str() );
+		out << "21\n300\n300\n1\n0\n";
+	}
+	b = false;
+	try {
+		Ferns invalid( fileSerial );
+	} catch( const Exception& ) {
+		b = true;
+	}
+	CVTTEST_PRINT( "load invalid number of ferns", b );
+	result &= b;
+
+	/* 32 tests per fern overflow the leaf index, 8 leaves do not match 2 tests, a truncated file */
+	const char* invalidFiles[] = { "21\n1\n32\n32\n0\n", "21\n1\n2\n2\n0\n8\n1\n", "21\n1\n2\n2\n1\n" };
+	b = true;
+	for( size_t i = 0; i < 3; i++ ){
+		{
+			std::ofstream out( fileSerial.c_str() );
+			out << invalidFiles[ i ];
+		}
+		bool thrown = false;
+		try {
+			Ferns invalid( fileSerial );
+		} catch( const Exception& ) {
+			thrown = true;
+		}
+		b &= thrown;
+	}
+	CVTTEST_PRINT( "load invalid tests per fern", b );
+	result &= b;
+
+	remove( fileThreaded.c_str() );
+	remove( fileSerial.c_str() );
+
+	return result;
+END_CVTTEST
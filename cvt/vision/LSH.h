@@ -29,190 +29,566 @@
  * Created on July 22, 2011, 3:56 PM
  */
 
-#ifndef LSH_H
-#define	LSH_H
+#ifndef CVT_LSH_H
+#define CVT_LSH_H
+
+#include <cvt/vision/features/DescriptorMatrix.h>
+#include <cvt/vision/features/FeatureDescriptor.h>
+#include <cvt/vision/features/FeatureMatch.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/Exception.h>
+#include <cvt/util/SIMD.h>
+#include <cvt/math/Math.h>
 
-#include <cvt/vision/ORB.h>
 #include <algorithm>
-#include <list>
+#include <vector>
+#include <stdint.h>
 
 namespace cvt {
 
-    template <size_t NumBits = 8, size_t NumTables = 4>
+    /**
+     *  \class LSH
+     *  \brief Multi-probe locality sensitive hashing index for 256 bit binary descriptors.
+     *
+     *  Each of the NumTables hash tables uses NumBits bit positions of the descriptor as key.
+     *  A query visits every bucket within Hamming distance probeRadius() of its key in all tables
+     *  and ranks the candidates by their full descriptor distance.
+     *  Entries are addressed by an id, e.g. the map feature id used by DescriptorDatabase, and
+     *  can be inserted, replaced and removed at any time. The descriptors are kept in one
+     *  contiguous array of slots. Every table stores the slot indices of all buckets in one array
+     *  with bucket offsets (CSR), entries inserted since the last rebuild are kept in a short overflow
+     *  list per table and removed entries are marked. Once the overflow and the removed entries exceed
+     *  a fraction of the index, the tables are rebuilt. Ids are mapped to slots by a hash table, so
+     *  they may be sparse.
+     *  Queries may run concurrently, insert/remove must not overlap with queries.
+     */
+    template <size_t NumBits = 16, size_t NumTables = 8>
     class LSH {
       public:
-        LSH( const std::vector<ORBFeature> * features );
-        int find( const ORBFeature& feature, size_t& dist, size_t maxDistance = 30 );
+        typedef FeatureDescriptorInternal<32, uint8_t, FEATUREDESC_CMP_HAMMING> Descriptor;
 
-        void updateFeatures( const std::vector<ORBFeature> * features );
+        LSH( size_t probeRadius = 1, unsigned int seed = 1 );
 
-      private:
-        struct HistPos
-        {
-            int accum;
-            size_t pos;
-            static int halfOrbSize;
+        /* probe all keys with at most radius flipped bits */
+        void   setProbeRadius( size_t radius );
+        size_t probeRadius() const { return _probeRadius; }
 
-            bool operator<( const HistPos & other ) const
-            {
-                return ::abs( accum * 2 - halfOrbSize ) <= ::abs( other.accum * 2 - halfOrbSize );
-            }
-        };
+        /* only report neighbours with distance < maxDistance */
+        void   setMaxDistance( float maxDistance ) { _maxDistance = maxDistance; }
+        float  maxDistance() const { return _maxDistance; }
 
-        void hashORBFeatures();
+        /* maximum number of threads for the batch queries, 0 uses ParallelRows::numThreads() */
+        void   setNumThreads( size_t n ) { _numThreads = n; }
+        size_t numThreads() const { return _numThreads; }
 
-        void entropy();
+        /* choose the most balanced bits of the sample as hash keys and rehash the index */
+        void   selectBits( const DescriptorMatrix& sample );
 
-        size_t hash( const ORBFeature & ft, size_t table ) const;
+        size_t size() const { return _ids.size() - _freeSlots.size(); }
+        bool   contains( size_t id ) const { return findId( id ) != NO_MATCH; }
+        void   clear();
 
-        const std::vector<ORBFeature> * _features;
+        /* insert the descriptor under id, an existing entry with the same id is replaced */
+        void   insert( const uint8_t* desc, size_t id );
+        void   insert( const Descriptor& desc, size_t id ) { insert( desc.desc, id ); }
+        /* insert all rows of the matrix with the ids firstId, firstId + 1, ... */
+        void   insert( const DescriptorMatrix& descriptors, size_t firstId );
+        /* false if there is no entry with this id */
+        bool   remove( size_t id );
 
-        size_t _bitPos[ NumTables ][ NumBits ];
+        /* k nearest neighbours sorted by distance, dstIdx is the id of the entry, srcIdx is 0 */
+        void   knn( std::vector<MatchingIndices>& neighbours, const uint8_t* desc, size_t k ) const;
 
-        std::list<int> _htable[ NumTables ][ ( 1 << NumBits ) ];
+        /* k nearest neighbours of every query row, processed in parallel, srcIdx is the query row */
+        void   knnMatch( std::vector<std::vector<MatchingIndices> >& matches, const DescriptorMatrix& query, size_t k ) const;
+
+        /* nearest neighbour of every query row with a neighbour closer than maxDistance() */
+        void   match( std::vector<MatchingIndices>& matches, const DescriptorMatrix& query ) const;
+
+      private:
+        class QueryRows;
+
+        typedef std::pair<uint32_t, uint32_t> KeySlot;
+
+        static const size_t   DESC_BYTES = 32;
+        static const uint32_t NO_SLOT = ( uint32_t ) -1;
+        static const uint32_t REMOVED_SLOT = ( uint32_t ) -2;
+        static const size_t   NO_MATCH = ( size_t ) -1;
+        /* minimum number of overflow and removed entries before the tables are rebuilt */
+        static const size_t   MIN_PENDING = 1024;
+
+        uint32_t hash( const uint8_t* desc, size_t table ) const;
+        void     addProbes( uint32_t mask, size_t first, size_t left );
+        void     addEntry( const uint8_t* desc, size_t id );
+        bool     removeEntry( size_t id );
+        void     rebuild();
+        void     updateTables();
+        void     nearest( MatchingIndices* best, size_t k, const uint8_t* desc, size_t srcIdx ) const;
+        void     candidate( MatchingIndices* best, size_t k, const uint8_t* desc, uint32_t slot, SIMD* simd ) const;
+
+        /* position of id in the id table or NO_MATCH */
+        size_t   findId( size_t id ) const;
+        /* add the id of a slot, _ids[ slot ] has to be set */
+        void     mapId( uint32_t slot );
+        void     rehashIds( size_t capacity );
+        size_t   idHash( size_t id ) const { return ( size_t )( ( ( uint64_t ) id * 0x9e3779b97f4a7c15ULL ) >> 32 ) & ( _idTable.size() - 1 ); }
+
+        const uint8_t* slotDescriptor( uint32_t slot ) const { return &_desc[ slot * DESC_BYTES ]; }
+
+        /* byte offset and bit shift of the key bits of every table */
+        uint8_t  _byte[ NumTables ][ NumBits ];
+        uint8_t  _shift[ NumTables ][ NumBits ];
+
+        size_t   _probeRadius;
+        float    _maxDistance;
+        size_t   _numThreads;
+
+        std::vector<uint32_t>  _probes;                 /* xor masks of the probed keys, by increasing radius */
+        std::vector<uint32_t>  _offsets[ NumTables ];   /* ( 1 << NumBits ) + 1 bucket offsets into _slots */
+        std::vector<uint32_t>  _slots[ NumTables ];     /* slot indices sorted by key, REMOVED_SLOT for removed entries */
+        std::vector<KeySlot>   _overflow[ NumTables ];  /* ( key, slot ) of the entries inserted since the last rebuild */
+        size_t                 _numRemoved;             /* REMOVED_SLOT entries in every table */
+        std::vector<uint8_t>   _desc;                   /* DESC_BYTES per slot */
+        std::vector<size_t>    _ids;                    /* id of every slot */
+        std::vector<uint32_t>  _freeSlots;
+        std::vector<uint32_t>  _idTable;                /* open addressing id -> slot map, NO_SLOT empty, REMOVED_SLOT deleted */
+        size_t                 _idTableUsed;            /* entries of _idTable that are not empty */
     };
 
-    template<size_t NumBits, size_t NumTables>
-    int LSH<NumBits, NumTables>::HistPos::halfOrbSize;
+    template <size_t NumBits, size_t NumTables>
+    const size_t LSH<NumBits, NumTables>::DESC_BYTES;
 
     template <size_t NumBits, size_t NumTables>
-    inline LSH<NumBits, NumTables>::LSH( const std::vector<ORBFeature>* orb ) : _features( orb )
-    {
-        entropy();
-        hashORBFeatures();
-    }
+    const uint32_t LSH<NumBits, NumTables>::NO_SLOT;
+
+    template <size_t NumBits, size_t NumTables>
+    const uint32_t LSH<NumBits, NumTables>::REMOVED_SLOT;
+
+    template <size_t NumBits, size_t NumTables>
+    const size_t LSH<NumBits, NumTables>::MIN_PENDING;
+
+    template <size_t NumBits, size_t NumTables>
+    const size_t LSH<NumBits, NumTables>::NO_MATCH;
+
+    template <size_t NumBits, size_t NumTables>
+    class LSH<NumBits, NumTables>::QueryRows : public ParallelRows::Body {
+      public:
+        QueryRows( MatchingIndices* best, size_t k, const LSH<NumBits, NumTables>& lsh, const DescriptorMatrix& query ) :
+            _best( best ), _k( k ), _lsh( lsh ), _query( query )
+        {
+        }
+
+        void process( size_t qstart, size_t qend ) const
+        {
+            for( size_t q = qstart; q < qend; q++ )
+                _lsh.nearest( _best + q * _k, _k, _query.descriptor( q ), q );
+        }
+
+      private:
+        MatchingIndices*                 _best;
+        size_t                           _k;
+        const LSH<NumBits, NumTables>&   _lsh;
+        const DescriptorMatrix&          _query;
+    };
 
     template <size_t NumBits, size_t NumTables>
-    inline void LSH<NumBits, NumTables>::updateFeatures( const std::vector<ORBFeature> * features )
+    inline LSH<NumBits, NumTables>::LSH( size_t probeRadius, unsigned int seed ) :
+        _probeRadius( 0 ),
+        _maxDistance( Math::MAXF ),
+        _numThreads( 0 ),
+        _numRemoved( 0 ),
+        _idTableUsed( 0 )
     {
-        _features = features;
-        for( size_t i = 0; i < NumTables; i++ ){
-            for( size_t k = 0; k < ( 1 << NumBits ); k++ ){
-                _htable[ i ][ k ].clear();
+        /* the bucket offsets take NumTables * 4 << NumBits bytes */
+        if( NumBits == 0 || NumBits > 20 )
+            throw CVTException( "NumBits has to be in [ 1, 20 ]" );
+
+        /* distinct random bit positions for every table, drawn with a partial Fisher-Yates shuffle */
+        uint32_t state = seed ? seed : 1;
+        for( size_t t = 0; t < NumTables; t++ ) {
+            uint8_t bits[ 256 ];
+            for( size_t i = 0; i < 256; i++ )
+                bits[ i ] = i;
+            for( size_t i = 0; i < NumBits; i++ ) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                std::swap( bits[ i ], bits[ i + state % ( 256 - i ) ] );
+                _byte[ t ][ i ]  = bits[ i ] >> 3;
+                _shift[ t ][ i ] = bits[ i ] & 0x07;
             }
         }
 
-        entropy();
-        hashORBFeatures();
+        setProbeRadius( probeRadius );
+        rebuild();
     }
 
-    #define GETBIT( ft, n ) ( ( ft.desc[ n >> 3 ] >> ( n & 0x07 ) ) & 1 )
     template <size_t NumBits, size_t NumTables>
-    inline void LSH<NumBits, NumTables>::entropy()
+    inline void LSH<NumBits, NumTables>::setProbeRadius( size_t radius )
     {
-        std::vector<HistPos> hist;
-		hist.reserve( 256 );
-
-        HistPos::halfOrbSize = _features->size();
+        radius = Math::min( radius, NumBits );
+        _probeRadius = radius;
+        _probes.clear();
+        for( size_t r = 0; r <= radius; r++ )
+            addProbes( 0, 0, r );
+    }
 
-        for( size_t i = 0; i < 256; i++ ){
-            hist[ i ].accum = 0;
-            hist[ i ].pos = i;
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::addProbes( uint32_t mask, size_t first, size_t left )
+    {
+        if( !left ) {
+            _probes.push_back( mask );
+            return;
         }
+        for( size_t b = first; b + left <= NumBits; b++ )
+            addProbes( mask | ( 1u << b ), b + 1, left - 1 );
+    }
 
-        for ( size_t i = 0, end = _features->size( ); i < end; i++ ) {
-            const ORBFeature& feature = ( *_features )[ i ];
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::selectBits( const DescriptorMatrix& sample )
+    {
+        if( NumBits * NumTables > 256 )
+            throw CVTException( "selectBits needs NumBits * NumTables <= 256" );
+        if( sample.descriptorBytes() != DESC_BYTES )
+            throw CVTException( "Descriptor sizes do not match" );
+
+        /* rank the bits by | ones - zeros |, the best ones are spread evenly over the tables */
+        std::vector<std::pair<size_t, size_t> > balance( 256 );
+        std::vector<size_t> ones( 256, 0 );
+        for( size_t i = 0; i < sample.size(); i++ ) {
+            const uint8_t* d = sample.descriptor( i );
+            for( size_t b = 0; b < 256; b++ )
+                ones[ b ] += ( d[ b >> 3 ] >> ( b & 0x07 ) ) & 1;
+        }
+        for( size_t b = 0; b < 256; b++ ) {
+            size_t zeros = sample.size() - ones[ b ];
+            balance[ b ] = std::make_pair( ones[ b ] > zeros ? ones[ b ] - zeros : zeros - ones[ b ], b );
+        }
+        std::sort( balance.begin(), balance.end() );
 
-            for( size_t b = 0; b < 0xFF; b++ ){
-                if( GETBIT( feature, b ) )
-                    hist[ b ].accum++;
+        for( size_t t = 0; t < NumTables; t++ ) {
+            for( size_t i = 0; i < NumBits; i++ ) {
+                size_t b = balance[ i * NumTables + t ].second;
+                _byte[ t ][ i ]  = b >> 3;
+                _shift[ t ][ i ] = b & 0x07;
             }
         }
 
-        std::sort( hist.begin(), hist.end() );
+        rebuild();
+    }
 
-        // save the NumBits best bit positions for hash generation
-        for ( size_t n = 0; n < NumTables; n++ ) {
-            for ( size_t i = 0; i < NumBits; i++ ) {
-                _bitPos[ n ][ i ] = hist[ n * NumBits + i ].pos;
-            }
-        }
+    template <size_t NumBits, size_t NumTables>
+    inline uint32_t LSH<NumBits, NumTables>::hash( const uint8_t* desc, size_t table ) const
+    {
+        uint32_t key = 0;
+        for( size_t i = 0; i < NumBits; i++ )
+            key |= ( ( desc[ _byte[ table ][ i ] ] >> _shift[ table ][ i ] ) & 1u ) << i;
+        return key;
+    }
 
-        /*
-        for( size_t b = 0; b < 0xFF; b++ ){
-            std::cout << ( float )hist[ b ].accum / ( float )_features->size()  << " " << hist[ b ].pos << " acuum: " << hist[ b ].accum << " abs:"<< ::abs( hist[ b ].accum * 2 - HistPos::halfOrbSize ) <<"\n";
-        }
-        std::cout << std::endl;
-         */
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::clear()
+    {
+        _desc.clear();
+        _ids.clear();
+        _freeSlots.clear();
+        _idTable.clear();
+        _idTableUsed = 0;
+        rebuild();
     }
 
     template <size_t NumBits, size_t NumTables>
-    inline size_t LSH<NumBits, NumTables>::hash( const ORBFeature & ft, size_t table ) const
+    inline void LSH<NumBits, NumTables>::insert( const uint8_t* desc, size_t id )
     {
-        size_t ret = 0;
+        addEntry( desc, id );
+        updateTables();
+    }
 
-        for( size_t i = 0; i < NumBits; i++ ){
-            ret |= GETBIT( ft, _bitPos[ table ][ i ] ) << i;
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::insert( const DescriptorMatrix& descriptors, size_t firstId )
+    {
+        if( descriptors.descriptorBytes() != DESC_BYTES )
+            throw CVTException( "Descriptor sizes do not match" );
+
+        _desc.reserve( _desc.size() + descriptors.size() * DESC_BYTES );
+        _ids.reserve( _ids.size() + descriptors.size() );
+        for( size_t i = 0; i < descriptors.size(); i++ )
+            addEntry( descriptors.descriptor( i ), firstId + i );
+        updateTables();
+    }
+
+    template <size_t NumBits, size_t NumTables>
+    inline bool LSH<NumBits, NumTables>::remove( size_t id )
+    {
+        if( !removeEntry( id ) )
+            return false;
+        updateTables();
+        return true;
+    }
+
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::addEntry( const uint8_t* desc, size_t id )
+    {
+        removeEntry( id );
+
+        uint32_t slot;
+        if( _freeSlots.size() ) {
+            slot = _freeSlots.back();
+            _freeSlots.pop_back();
+            _ids[ slot ] = id;
+        } else {
+            if( _ids.size() >= REMOVED_SLOT )
+                throw CVTException( "LSH index is full" );
+            slot = _ids.size();
+            _ids.push_back( id );
+            _desc.resize( _desc.size() + DESC_BYTES );
+        }
+        SIMD::instance()->Memcpy( &_desc[ slot * DESC_BYTES ], desc, DESC_BYTES );
+        mapId( slot );
+
+        for( size_t t = 0; t < NumTables; t++ )
+            _overflow[ t ].push_back( KeySlot( hash( desc, t ), slot ) );
+    }
+
+    template <size_t NumBits, size_t NumTables>
+    inline bool LSH<NumBits, NumTables>::removeEntry( size_t id )
+    {
+        size_t pos = findId( id );
+        if( pos == NO_MATCH )
+            return false;
+
+        uint32_t slot = _idTable[ pos ];
+        _idTable[ pos ] = REMOVED_SLOT;
+
+        /* an entry is either in the tables or in the overflow lists of all tables */
+        const uint8_t* desc = slotDescriptor( slot );
+        bool removed = false;
+        for( size_t t = 0; t < NumTables; t++ ) {
+            uint32_t key = hash( desc, t );
+            for( uint32_t i = _offsets[ t ][ key ]; i < _offsets[ t ][ key + 1 ]; i++ ) {
+                if( _slots[ t ][ i ] == slot ) {
+                    _slots[ t ][ i ] = REMOVED_SLOT;
+                    removed = true;
+                    break;
+                }
+            }
+            if( removed )
+                continue;
+
+            std::vector<KeySlot>& overflow = _overflow[ t ];
+            for( size_t i = 0; i < overflow.size(); i++ ) {
+                if( overflow[ i ].second == slot ) {
+                    overflow[ i ] = overflow.back();
+                    overflow.pop_back();
+                    break;
+                }
+            }
         }
+        if( removed )
+            _numRemoved++;
 
-        return ret;
+        _ids[ slot ] = NO_MATCH;
+        _freeSlots.push_back( slot );
+        return true;
     }
 
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::updateTables()
+    {
+        /* queries scan the overflow lists linearly, rebuilding costs O( ( 1 << NumBits ) + size() ) per table */
+        if( _overflow[ 0 ].size() + _numRemoved > Math::max( MIN_PENDING, size() / 32 ) )
+            rebuild();
+    }
 
     template <size_t NumBits, size_t NumTables>
-    inline void LSH<NumBits, NumTables>::hashORBFeatures()
+    inline void LSH<NumBits, NumTables>::rebuild()
     {
-        for ( size_t i = 0, end = _features->size( ); i < end; i++ ) {
-            const ORBFeature& feature = ( *_features )[ i ];
+        const size_t numKeys = ( size_t ) 1 << NumBits;
+        for( size_t t = 0; t < NumTables; t++ ) {
+            std::vector<uint32_t>& offsets = _offsets[ t ];
+            std::vector<uint32_t>& slots = _slots[ t ];
+
+            /* count, prefix sum to the bucket starts, fill advances every start to the next bucket */
+            offsets.assign( numKeys + 1, 0 );
+            for( size_t slot = 0; slot < _ids.size(); slot++ ) {
+                if( _ids[ slot ] != NO_MATCH )
+                    offsets[ hash( slotDescriptor( slot ), t ) + 1 ]++;
+            }
+            for( size_t key = 0; key < numKeys; key++ )
+                offsets[ key + 1 ] += offsets[ key ];
 
-            for( size_t n = 0; n < NumTables; n++ ){
-                size_t idx = hash( feature, n );
-                _htable[ n ][ idx ].push_back( i );
+            slots.resize( offsets[ numKeys ] );
+            for( size_t slot = 0; slot < _ids.size(); slot++ ) {
+                if( _ids[ slot ] != NO_MATCH )
+                    slots[ offsets[ hash( slotDescriptor( slot ), t ) ]++ ] = slot;
             }
+            for( size_t key = numKeys; key > 0; key-- )
+                offsets[ key ] = offsets[ key - 1 ];
+            offsets[ 0 ] = 0;
+
+            _overflow[ t ].clear();
         }
+        _numRemoved = 0;
+    }
 
-        /*
-        for( size_t i = 0; i < ( 1 << NumBits ) - 1; i++ ){
-            std::cout << _htable[ i ].size() << std::endl;
+    template <size_t NumBits, size_t NumTables>
+    inline size_t LSH<NumBits, NumTables>::findId( size_t id ) const
+    {
+        if( _idTable.empty() )
+            return NO_MATCH;
+
+        /* linear probing, the table is at most half full */
+        size_t mask = _idTable.size() - 1;
+        for( size_t i = idHash( id ); ; i = ( i + 1 ) & mask ) {
+            uint32_t slot = _idTable[ i ];
+            if( slot == NO_SLOT )
+                return NO_MATCH;
+            if( slot != REMOVED_SLOT && _ids[ slot ] == id )
+                return i;
         }
-         */
+    }
 
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::mapId( uint32_t slot )
+    {
+        if( 2 * ( _idTableUsed + 1 ) > _idTable.size() ) {
+            /* the rehash picks up the new slot, it is already in _ids */
+            size_t capacity = 16;
+            while( capacity < 4 * size() )
+                capacity <<= 1;
+            rehashIds( capacity );
+            return;
+        }
 
-        /*		for( size_t k = 0; k < MAXIDX; k++ ) {
-                    for( size_t l = 0; l < 256; l++ ) {
-                        std::cout << k << " " << l << " " << _htable[ k ][ l ].size() << std::endl;
-                    }
-                }*/
+        size_t mask = _idTable.size() - 1;
+        size_t i = idHash( _ids[ slot ] );
+        while( _idTable[ i ] != NO_SLOT && _idTable[ i ] != REMOVED_SLOT )
+            i = ( i + 1 ) & mask;
+        if( _idTable[ i ] == NO_SLOT )
+            _idTableUsed++;
+        _idTable[ i ] = slot;
     }
 
     template <size_t NumBits, size_t NumTables>
-    inline int LSH<NumBits, NumTables>::find( const ORBFeature& feature, size_t& dist, size_t maxDistance )
+    inline void LSH<NumBits, NumTables>::rehashIds( size_t capacity )
     {
-        int ret = -1;
-        size_t retdist = maxDistance;
+        _idTable.assign( capacity, NO_SLOT );
+        _idTableUsed = 0;
+        size_t mask = capacity - 1;
+        for( size_t slot = 0; slot < _ids.size(); slot++ ) {
+            if( _ids[ slot ] == NO_MATCH )
+                continue;
+            size_t i = idHash( _ids[ slot ] );
+            while( _idTable[ i ] != NO_SLOT )
+                i = ( i + 1 ) & mask;
+            _idTable[ i ] = slot;
+            _idTableUsed++;
+        }
+    }
 
-        for ( size_t n = 0; n < NumTables; n++ ) {
-            /* Simple test without any descriptor bit twiddling */
-            size_t idx = hash( feature, n );
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::nearest( MatchingIndices* best, size_t k, const uint8_t* desc, size_t srcIdx ) const
+    {
+        SIMD* simd = SIMD::instance();
 
-            for ( std::list<int>::iterator it = _htable[ n ][ idx ].begin( ), end = _htable[ n ][ idx ].end( ); it != end; ++it ) {
-                const ORBFeature& current = ( *_features )[ *it ];
-                size_t d = feature.distance( current );
-                if ( d < retdist ) {
-                    retdist = d;
-                    ret = *it;
+        for( size_t j = 0; j < k; j++ ) {
+            best[ j ].srcIdx = srcIdx;
+            best[ j ].dstIdx = NO_MATCH;
+            best[ j ].distance = _maxDistance;
+        }
+
+        for( size_t t = 0; t < NumTables; t++ ) {
+            uint32_t key = hash( desc, t );
+            const uint32_t* offsets = &_offsets[ t ][ 0 ];
+            const uint32_t* slots = _slots[ t ].empty() ? NULL : &_slots[ t ][ 0 ];
+            for( size_t p = 0; p < _probes.size(); p++ ) {
+                uint32_t probe = key ^ _probes[ p ];
+                for( uint32_t i = offsets[ probe ]; i < offsets[ probe + 1 ]; i++ ) {
+                    if( slots[ i ] != REMOVED_SLOT )
+                        candidate( best, k, desc, slots[ i ], simd );
                 }
             }
 
-            /* toggle one bit at each position and probe */
-            for ( size_t i = 0; i < NumBits; i++ ) {
-                size_t index = idx ^ ( 1 << i );
-                for ( std::list<int>::iterator it = _htable[ n ][ index ].begin( ), end = _htable[ n ][ index ].end( ); it != end; ++it ) {
-                    const ORBFeature& current = ( *_features )[ *it ];
-                    size_t d = feature.distance( current );
-                    if ( d < retdist ) {
-                        retdist = d;
-                        ret = *it;
-                    }
-                }
+            /* the overflow entries within the probe radius */
+            const std::vector<KeySlot>& overflow = _overflow[ t ];
+            for( size_t i = 0; i < overflow.size(); i++ ) {
+                if( Math::popcount( overflow[ i ].first ^ key ) <= _probeRadius )
+                    candidate( best, k, desc, overflow[ i ].second, simd );
             }
         }
+    }
 
-        dist = retdist;
-        return ret;
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::candidate( MatchingIndices* best, size_t k, const uint8_t* desc, uint32_t slot, SIMD* simd ) const
+    {
+        float d = ( float ) simd->hammingDistance( desc, slotDescriptor( slot ), DESC_BYTES );
+        if( !( d < best[ k - 1 ].distance ) )
+            return;
+
+        /* the same entry shows up in several tables - it is already in the list with the same distance */
+        size_t id = _ids[ slot ];
+        size_t j = k - 1;
+        while( j > 0 && d <= best[ j - 1 ].distance && best[ j - 1 ].dstIdx != id )
+            j--;
+        if( j > 0 && best[ j - 1 ].dstIdx == id )
+            return;
+
+        /* equal distances keep the entry found first in front */
+        j = k - 1;
+        while( j > 0 && d < best[ j - 1 ].distance ) {
+            best[ j ] = best[ j - 1 ];
+            j--;
+        }
+        best[ j ].dstIdx = id;
+        best[ j ].distance = d;
     }
-}
 
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::knn( std::vector<MatchingIndices>& neighbours, const uint8_t* desc, size_t k ) const
+    {
+        neighbours.clear();
+        if( !k )
+            return;
+
+        std::vector<MatchingIndices> best( k );
+        nearest( &best[ 0 ], k, desc, 0 );
+        for( size_t j = 0; j < k && best[ j ].dstIdx != NO_MATCH; j++ )
+            neighbours.push_back( best[ j ] );
+    }
+
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::knnMatch( std::vector<std::vector<MatchingIndices> >& matches, const DescriptorMatrix& query, size_t k ) const
+    {
+        matches.resize( query.size() );
+        if( !query.size() || !k )
+            return;
+        if( query.descriptorBytes() != DESC_BYTES )
+            throw CVTException( "Descriptor sizes do not match" );
+
+        std::vector<MatchingIndices> best( query.size() * k );
+        QueryRows body( &best[ 0 ], k, *this, query );
+        /* the pixel threshold of ParallelRows is applied to the number of probed buckets */
+        ParallelRows::run( body, NumTables * _probes.size(), query.size(), _numThreads );
+
+        for( size_t q = 0; q < query.size(); q++ ) {
+            const MatchingIndices* b = &best[ q * k ];
+            matches[ q ].clear();
+            for( size_t j = 0; j < k && b[ j ].dstIdx != NO_MATCH; j++ )
+                matches[ q ].push_back( b[ j ] );
+        }
+    }
 
-#endif	/* LSH_H */
+    template <size_t NumBits, size_t NumTables>
+    inline void LSH<NumBits, NumTables>::match( std::vector<MatchingIndices>& matches, const DescriptorMatrix& query ) const
+    {
+        std::vector<std::vector<MatchingIndices> > nn;
+        knnMatch( nn, query, 1 );
+        matches.reserve( matches.size() + query.size() );
+        for( size_t q = 0; q < nn.size(); q++ ) {
+            if( nn[ q ].size() )
+                matches.push_back( nn[ q ][ 0 ] );
+        }
+    }
+}
 
+#endif
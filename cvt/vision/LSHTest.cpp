@@ -0,0 +1,237 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/LSH.h>
+#include <cvt/vision/features/HammingMatcher.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/Time.h>
+
+#include <iostream>
+#include <stdlib.h>
+
+using namespace cvt;
+
+static void _randomDescriptor( uint8_t* desc )
+{
+	for( size_t i = 0; i < 32; i++ )
+		desc[ i ] = rand() & 0xff;
+}
+
+/* copy of desc with nflip random bits flipped */
+static void _noisyDescriptor( uint8_t* dst, const uint8_t* desc, size_t nflip )
+{
+	for( size_t i = 0; i < 32; i++ )
+		dst[ i ] = desc[ i ];
+	for( size_t i = 0; i < nflip; i++ ) {
+		size_t b = rand() % 256;
+		dst[ b >> 3 ] ^= 1 << ( b & 0x07 );
+	}
+}
+
+static void _testData( DescriptorMatrix& train, DescriptorMatrix& query, size_t ntrain, size_t nquery, size_t nflip )
+{
+	uint8_t desc[ 32 ], noisy[ 32 ];
+	Feature f;
+	for( size_t i = 0; i < ntrain; i++ ) {
+		_randomDescriptor( desc );
+		train.add( f, desc );
+	}
+	for( size_t i = 0; i < nquery; i++ ) {
+		_noisyDescriptor( noisy, train.descriptor( rand() % ntrain ), nflip );
+		query.add( f, noisy );
+	}
+}
+
+/* fraction of the queries where the index finds a neighbour as close as the brute force one */
+static float _recall( const std::vector<std::vector<MatchingIndices> >& lsh, const std::vector<std::vector<MatchingIndices> >& bf )
+{
+	size_t found = 0;
+	for( size_t q = 0; q < bf.size(); q++ )
+		found += lsh[ q ].size() && bf[ q ].size() && lsh[ q ][ 0 ].distance == bf[ q ][ 0 ].distance;
+	return ( float ) found / ( float ) bf.size();
+}
+
+static bool _recallTest()
+{
+	DescriptorMatrix train, query;
+	_testData( train, query, 20000, 500, 16 );
+
+	LSH<> lsh( 1 );
+	lsh.insert( train, 0 );
+
+	HammingMatcher matcher;
+	std::vector<std::vector<MatchingIndices> > bf, nn;
+	matcher.knnMatch( bf, query, train, 2 );
+	lsh.knnMatch( nn, query, 2 );
+
+	bool result = lsh.size() == train.size() && _recall( nn, bf ) > 0.95f;
+	for( size_t q = 0; q < nn.size() && result; q++ ) {
+		result &= nn[ q ].size() == 2 && nn[ q ][ 0 ].srcIdx == q && nn[ q ][ 0 ].distance <= nn[ q ][ 1 ].distance;
+		result &= nn[ q ][ 0 ].dstIdx != nn[ q ][ 1 ].dstIdx;
+		result &= nn[ q ][ 0 ].distance == ( float ) SIMD::instance()->hammingDistance( query.descriptor( q ), train.descriptor( nn[ q ][ 0 ].dstIdx ), 32 );
+	}
+	CVTTEST_PRINT( "LSH recall", result );
+
+	/* every query on its own and on a single thread gives the same neighbours */
+	std::vector<std::vector<MatchingIndices> > serial;
+	{
+		ParallelRows::ScopedNumThreads nt( 1 );
+		lsh.knnMatch( serial, query, 2 );
+	}
+	bool b = true;
+	std::vector<MatchingIndices> single;
+	for( size_t q = 0; q < nn.size() && b; q++ ) {
+		lsh.knn( single, query.descriptor( q ), 2 );
+		b &= single.size() == nn[ q ].size() && serial[ q ].size() == nn[ q ].size();
+		for( size_t j = 0; j < single.size() && b; j++ )
+			b &= single[ j ].dstIdx == nn[ q ][ j ].dstIdx && serial[ q ][ j ].dstIdx == nn[ q ][ j ].dstIdx;
+	}
+	CVTTEST_PRINT( "LSH threaded == serial", b );
+	return result && b;
+}
+
+static bool _insertRemoveTest()
+{
+	LSH<12, 6> lsh( 2 );
+	uint8_t desc[ 32 ], other[ 32 ];
+	std::vector<MatchingIndices> nn;
+	bool result = true;
+
+	_randomDescriptor( desc );
+	_randomDescriptor( other );
+	lsh.insert( desc, 5 );
+	lsh.insert( other, 1000 );
+	result &= lsh.size() == 2 && lsh.contains( 5 ) && lsh.contains( 1000 ) && !lsh.contains( 6 );
+
+	lsh.knn( nn, desc, 1 );
+	result &= nn.size() == 1 && nn[ 0 ].dstIdx == 5 && nn[ 0 ].distance == 0.0f;
+
+	/* reinserting an id replaces its descriptor */
+	lsh.insert( other, 5 );
+	lsh.knn( nn, desc, 2 );
+	result &= lsh.size() == 2 && ( nn.empty() || nn[ 0 ].distance > 0.0f );
+	lsh.knn( nn, other, 2 );
+	result &= nn.size() == 2 && nn[ 0 ].distance == 0.0f && nn[ 1 ].distance == 0.0f;
+
+	result &= lsh.remove( 1000 ) && !lsh.remove( 1000 ) && !lsh.contains( 1000 );
+	lsh.knn( nn, other, 2 );
+	result &= lsh.size() == 1 && nn.size() == 1 && nn[ 0 ].dstIdx == 5;
+
+	/* the freed slot is reused */
+	lsh.insert( desc, 7 );
+	lsh.knn( nn, desc, 1 );
+	result &= lsh.size() == 2 && nn.size() == 1 && nn[ 0 ].dstIdx == 7;
+
+	lsh.setMaxDistance( 1.0f );
+	_noisyDescriptor( other, desc, 5 );
+	lsh.knn( nn, other, 1 );
+	result &= nn.empty();
+
+	lsh.clear();
+	lsh.knn( nn, desc, 1 );
+	result &= lsh.size() == 0 && nn.empty() && !lsh.contains( 7 );
+
+	CVTTEST_PRINT( "LSH insert/remove", result );
+	return result;
+}
+
+/* single inserts and removes with sparse ids, across several rebuilds of the tables */
+static bool _incrementalTest()
+{
+	LSH<12, 4> lsh( 1 );
+	const size_t n = 3000;
+	std::vector<uint8_t> descs( n * 32 );
+	for( size_t i = 0; i < n; i++ ) {
+		_randomDescriptor( &descs[ i * 32 ] );
+		lsh.insert( &descs[ i * 32 ], i * 1000003 );
+	}
+	bool result = lsh.size() == n;
+
+	/* remove every third entry, move every fifth to a new id */
+	for( size_t i = 0; i < n; i++ ) {
+		if( i % 3 == 0 )
+			result &= lsh.remove( i * 1000003 );
+		else if( i % 5 == 0 ) {
+			result &= lsh.remove( i * 1000003 );
+			lsh.insert( &descs[ i * 32 ], i * 1000003 + 1 );
+		}
+	}
+
+	std::vector<MatchingIndices> nn;
+	size_t num = 0;
+	for( size_t i = 0; i < n && result; i++ ) {
+		lsh.knn( nn, &descs[ i * 32 ], 1 );
+		if( i % 3 == 0 ) {
+			result &= !lsh.contains( i * 1000003 ) && ( nn.empty() || nn[ 0 ].distance > 0.0f );
+			continue;
+		}
+		size_t id = i % 5 ? i * 1000003 : i * 1000003 + 1;
+		result &= lsh.contains( id ) && nn.size() == 1 && nn[ 0 ].dstIdx == id && nn[ 0 ].distance == 0.0f;
+		result &= lsh.contains( i * 1000003 ) == ( id == i * 1000003 );
+		num++;
+	}
+	result &= lsh.size() == num;
+
+	CVTTEST_PRINT( "LSH incremental insert/remove", result );
+	return result;
+}
+
+static void _benchmark()
+{
+	DescriptorMatrix train, query;
+	_testData( train, query, 100000, 1000, 20 );
+
+	LSH<> lsh( 1 );
+	Time t;
+	lsh.insert( train, 0 );
+	double tinsert = t.elapsedMilliSeconds();
+
+	HammingMatcher matcher;
+	std::vector<std::vector<MatchingIndices> > bf, nn;
+	t.reset();
+	matcher.knnMatch( bf, query, train, 1 );
+	double tbf = t.elapsedMilliSeconds();
+
+	for( size_t r = 0; r <= 2; r++ ) {
+		lsh.setProbeRadius( r );
+		t.reset();
+		lsh.knnMatch( nn, query, 1 );
+		double tlsh = t.elapsedMilliSeconds();
+		std::cout << "LSH probe radius " << r << ": " << tlsh << " ms, recall " << _recall( nn, bf )
+				  << " ( brute force " << tbf << " ms, insert " << tinsert << " ms, "
+				  << train.size() << " x " << query.size() << " )" << std::endl;
+	}
+}
+
+BEGIN_CVTTEST( LSH )
+	bool result = true;
+
+	srand( 4711 );
+	result &= _recallTest();
+	result &= _insertRemoveTest();
+	result &= _incrementalTest();
+	_benchmark();
+
+	return result;
+END_CVTTEST
@@ -72,17 +72,17 @@ namespace cvt
 		// generate new random affine Transform
 		randomizeAffine();
 		
-		outputPatch.reallocate( _patchSize, _patchSize, inputImage.format() );
+		_warped.reallocate( _patchSize, _patchSize, inputImage.format() );
 		
 		size_t inStride, outStride;
 		const uint8_t * in = inputImage.map( &inStride );
-		uint8_t * out = outputPatch.map( &outStride );
+		uint8_t * out = _warped.map( &outStride );
 		uint8_t * outSave = out;
 		
 		Eigen::Vector2f currentP, pPrime;
 		
 		int32_t x0, y0, x1, y1;	
-		uint32_t numChannels = outputPatch.channels();
+		uint32_t numChannels = _warped.channels();
 		
 		currentP[ 1 ] = -(float)_patchSize / 2.0f;	
 		float fracX, fracY;
@@ -92,13 +92,15 @@ namespace cvt
 			currentP[ 0 ] = -(float)_patchSize / 2.0f;
 			for( uint32_t j = 0; j < _patchSize; j++ ){	
 				pPrime = _affine * currentP;
-												
-				x0 = int32_t( pPrime[ 0 ] + float( patchCenter[ 0 ] ) );
-				y0 = int32_t( pPrime[ 1 ] + float( patchCenter[ 1 ] ) );
-				x1 = x0++;
-				y1 = y0++;
-				fracX = pPrime[ 0 ] - Math::floor( pPrime[ 0 ] );
-				fracY = pPrime[ 1 ] - Math::floor( pPrime[ 1 ] );
+				pPrime[ 0 ] += patchCenter[ 0 ];
+				pPrime[ 1 ] += patchCenter[ 1 ];
+
+				x0 = ( int32_t ) Math::floor( pPrime[ 0 ] );
+				y0 = ( int32_t ) Math::floor( pPrime[ 1 ] );
+				x1 = x0 + 1;
+				y1 = y0 + 1;
+				fracX = pPrime[ 0 ] - ( float ) x0;
+				fracY = pPrime[ 1 ] - ( float ) y0;
 				
 				if( x0 < 0 ||
 				    y0 < 0 ||
@@ -109,15 +111,15 @@ namespace cvt
 				} else {
 					pixelNoise = Math::clamp( _rng.gaussian( _whiteNoiseSigma ), -20.0, 20.0 );
 					
+					// replicate the last row / column
+					if( ( uint32_t )x1 >= inputImage.width() )
+						x1 = x0;
+					if( ( uint32_t )y1 >= inputImage.height() )
+						y1 = y0;
+
 					for( size_t c = 0; c < numChannels; c++ ){						
-						if( ( uint32_t )x1 < inputImage.width() )
-							tmp0 = Math::mix( in[ y0 * inStride + x0 * numChannels + c ], in[ y0 * inStride + x1 * numChannels + c ], fracX );
-						else
-							tmp0 = in[ y0 * inStride + x0 * numChannels + c ];
-						if( ( uint32_t )y1 < inputImage.height() )
-							tmp1 = Math::mix( in[ y1 * inStride + x0 * numChannels + c ], in[ y1 * inStride + x1 * numChannels + c ], fracX );
-						else
-							tmp1 = in[ y1 * inStride + x0 * numChannels + c ];
+						tmp0 = Math::mix( in[ y0 * inStride + x0 * numChannels + c ], in[ y0 * inStride + x1 * numChannels + c ], fracX );
+						tmp1 = Math::mix( in[ y1 * inStride + x0 * numChannels + c ], in[ y1 * inStride + x1 * numChannels + c ], fracX );
 						tmp = Math::mix( tmp0, tmp1, fracY ) + pixelNoise;
 						
 						out[ numChannels * j + c ] = ( uint8_t )Math::clamp( tmp, 0, 255 );
@@ -131,12 +133,9 @@ namespace cvt
 		}
 		
 		inputImage.unmap( in );
-		outputPatch.unmap( outSave );
-		
-		Image tmpPatch( outputPatch );
+		_warped.unmap( outSave );
 		
-		outputPatch.convolve( tmpPatch, IKernel::GAUSS_HORIZONTAL_3 );
-		tmpPatch.convolve( outputPatch, IKernel::GAUSS_VERTICAL_3 );
+		_warped.convolve( outputPatch, IKernel::GAUSS_HORIZONTAL_3, IKernel::GAUSS_VERTICAL_3 );
 	}
 	
 }
\ No newline at end of file
@@ -40,8 +40,11 @@ namespace cvt
 			PatchGenerator( const Rangef & angleRange, const Rangef & scaleRange, uint32_t patchSize = 32, double whiteNoiseSigma = 5.0 );
 			~PatchGenerator();
 			
-			/* generate the next patch */
+			/* generate the next patch, outputPatch is only reallocated if its size or format changes */
 			void next( Image & outputPatch, const cvt::Image & inputImage, const Vector2f & patchCenter );			
+
+			/* generators are not thread safe, use one generator with its own seed per thread */
+			void setSeed( uint64_t seed ) { _rng = RNG( seed ); }
 			
 		private:
 			uint32_t			_patchSize;
@@ -50,6 +53,7 @@ namespace cvt
 			double				_whiteNoiseSigma;			
 			Eigen::Matrix2f		_affine;
 			RNG					_rng;
+			Image				_warped;
 			size_t				_inHandle, _outHandle;
 			
 			void randomizeAffine();		
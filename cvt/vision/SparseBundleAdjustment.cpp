@@ -29,8 +29,11 @@
 #include <cvt/math/Math.h>
 #include <cvt/math/SE3.h>
 #include <cvt/vision/Vision.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/Mutex.h>
 
 #include <cstring>
+#include <map>
 
 namespace cvt {
 
@@ -42,7 +45,13 @@ namespace cvt {
         _invAugPJTJ( 0 ),
         _camsJTJ( 0 ),
         _camResiduals( 0 ),
-        _pointResiduals( 0 )
+        _pointResiduals( 0 ),
+        _lambda( 0.0 ),
+        _iterations( 0 ),
+        _costs( 0.0 ),
+        _solverType( SOLVER_CHOLESKY ),
+        _pcgMaxIterations( 100 ),
+        _pcgTolerance( 1e-6 )
     {
     }
 
@@ -60,6 +69,7 @@ namespace cvt {
             delete[] _pointResiduals;
     }
 
+
     static bool _vectorHasNaNOrInf( Eigen::VectorXd& v )
     {
         for( size_t i = 0; i < v.rows(); ++i ){
@@ -70,6 +80,326 @@ namespace cvt {
         return false;
     }
 
+    /* ParallelRows width for loops over points: ~ cost of the measurements of a point relative to a pixel */
+    static inline size_t _pointCost( size_t numMeas, size_t numPoints )
+    {
+        return 64 * ( numMeas / Math::max<size_t>( numPoints, 1 ) + 1 );
+    }
+
+    /*
+     * Jacobians and residuals of all measurements, one band of points per thread:
+     * the point blocks and the columns of _camPointJTJ belong to a single band, the camera
+     * sums are accumulated per band and reduced afterwards.
+     */
+    class SparseBundleAdjustment::EvalHessians : public ParallelRows::Body
+    {
+        public:
+            struct CamSums {
+                std::vector<CamJTJ, Eigen::aligned_allocator<CamJTJ> >						camsJTJ;
+                std::vector<CamResidualType, Eigen::aligned_allocator<CamResidualType> >	camResiduals;
+            };
+
+            EvalHessians( SparseBundleAdjustment & sba, const SlamMap & map ) :
+                _sba( sba ),
+                _map( map ),
+                _pointCosts( sba._nPts ),
+                _pointDiag( sba._nPts )
+            {
+            }
+
+            ~EvalHessians()
+            {
+                std::map<size_t, CamSums*>::iterator it = _sums.begin();
+                while( it != _sums.end() ){
+                    delete it->second;
+                    ++it;
+                }
+            }
+
+            void process( size_t pstart, size_t pend ) const
+            {
+                CamSums* sums = new CamSums();
+                {
+                    ScopeLock lock( &_mutex );
+                    _sums[ pstart ] = sums;
+                }
+                sums->camsJTJ.resize( _sba._nCams, CamJTJ::Zero() );
+                sums->camResiduals.resize( _sba._nCams, CamResidualType::Zero() );
+
+                CamScreenJacType	screenJacCam;
+                PointScreenJacType	screenJacPoint;
+                Eigen::Matrix<double, 6, 2> jCamTCovInv;
+                Eigen::Matrix<double, 3, 2> jPointTCovInv;
+                Eigen::Matrix<double, 3, 1> point3d, pCam;
+                Eigen::Matrix<double, 2, 1> residual;
+                Eigen::Matrix<double, 2, 1> reproj;
+
+                const Eigen::Matrix3d & K = _map.intrinsics();
+                SparseBlockMatrix<camParamDim, pointParamDim> & camPointJTJ = _sba._camPointJTJ;
+
+                for( size_t i = pstart; i < pend; i++ ){
+                    PointJTJ & pointJTJ = _sba._pointsJTJ[ i ];
+                    PointResidualType & pointRes = _sba._pointResiduals[ i ];
+                    pointJTJ.setZero();
+                    pointRes.setZero();
+
+                    // get the MapFeature:
+                    const MapFeature & feature = _map.featureForId( i );
+                    const Eigen::Vector4d & ptmp = feature.estimate();
+                    point3d = ptmp.head<3>() / ptmp[ 3 ];
+
+                    // for all point tracks (meas. in the cams) of this point
+                    // -> the column of the point in _camPointJTJ has the blocks in the same ( sorted ) camera order
+                    size_t cpEntry = camPointJTJ.colBegin( i );
+                    const MapFeature::ConstPointTrackIterator camIterEnd  = feature.pointTrackEnd();
+                    double costs = 0.0;
+
+                    for( MapFeature::ConstPointTrackIterator camIter = feature.pointTrackBegin();
+                         camIter != camIterEnd;
+                         camIter++, cpEntry++ ){
+                        if( cpEntry == camPointJTJ.colEnd( i ) || camPointJTJ.colRow( cpEntry ) != *camIter )
+                            throw CVTException( "Point track does not match the keyframe measurements" );
+
+                        // get the keyframe:
+                        const Keyframe & keyframe = _map.keyframeForId( *camIter );
+
+                        // screen jacobian for this 3D point in that camera
+                        const Eigen::Matrix4d & trans = keyframe.pose().transformation();
+                        const Eigen::Matrix<double, 3, 3> & R = trans.block<3, 3>( 0, 0 );
+                        pCam = R * point3d + trans.block<3, 1>( 0, 3 );
+
+                        // screen jacobian for this camera
+                        keyframe.pose().screenJacobian( screenJacCam, pCam, K );
+
+                        // point jacobian for this point in this cam:
+                        _sba.evalScreenJacWrtPoint( reproj, screenJacPoint, pCam, K, R );
+
+                        const MapMeasurement & mm = keyframe.measurementForId( i );
+                        residual = mm.point - reproj;
+
+                        // J^T * Cov^-1
+                        jCamTCovInv = screenJacCam.transpose() * mm.information;
+                        jPointTCovInv = screenJacPoint.transpose() * mm.information;
+
+                        // accumulate the jacobians
+                        pointJTJ						+= jPointTCovInv * screenJacPoint;
+                        sums->camsJTJ[ *camIter ]		+= jCamTCovInv * screenJacCam;
+
+                        // accumulate the residuals
+                        pointRes						+= ( jPointTCovInv * residual );
+                        sums->camResiduals[ *camIter ]	+= ( jCamTCovInv   * residual );
+
+                        costs += residual.transpose() * mm.information * residual;
+
+                        /* camPointJacobian */
+                        camPointJTJ.blockAt( camPointJTJ.colBlock( cpEntry ) ) = ( jCamTCovInv * screenJacPoint );
+                    }
+
+                    _pointCosts[ i ] = costs;
+                    _pointDiag[ i ] = pointJTJ.diagonal().array().sum();
+                }
+            }
+
+            /* sum up per point and per band, always in the same order */
+            void reduce( double & costs, double & pointDiag )
+            {
+                costs = 0.0;
+                pointDiag = 0.0;
+                for( size_t i = 0; i < _pointCosts.size(); i++ ){
+                    costs += _pointCosts[ i ];
+                    pointDiag += _pointDiag[ i ];
+                }
+
+                std::map<size_t, CamSums*>::const_iterator it = _sums.begin();
+                while( it != _sums.end() ){
+                    const CamSums & s = *it->second;
+                    for( size_t c = 0; c < _sba._nCams; c++ ){
+                        _sba._camsJTJ[ c ]		+= s.camsJTJ[ c ];
+                        _sba._camResiduals[ c ] += s.camResiduals[ c ];
+                    }
+                    ++it;
+                }
+            }
+
+        private:
+            SparseBundleAdjustment &				_sba;
+            const SlamMap &							_map;
+            mutable std::vector<double>				_pointCosts;
+            mutable std::vector<double>				_pointDiag;
+            mutable Mutex							_mutex;
+            mutable std::map<size_t, CamSums*>		_sums;
+    };
+
+    class SparseBundleAdjustment::InvertPointHessians : public ParallelRows::Body
+    {
+        public:
+            InvertPointHessians( SparseBundleAdjustment & sba ) : _sba( sba )
+            {
+            }
+
+            void process( size_t pstart, size_t pend ) const
+            {
+                PointJTJ inv;
+                for( size_t i = pstart; i < pend; i++ ){
+                    inv = _sba._pointsJTJ[ i ];
+                    // augment the diagonal:
+                    //inv.diagonal().array() += _lambda;
+                    inv.diagonal().array() *= ( 1.0 + _sba._lambda );
+                    // TODO: is there a way to exploit symmetry when inverting with Eigen?
+                    _sba._invAugPJTJ[ i ] = inv.inverse();
+                }
+            }
+
+        private:
+            SparseBundleAdjustment & _sba;
+    };
+
+    /*
+     * the blocks of camera c only go to the columns of c in _sparseReduced, which are allocated
+     * by prepareSparseMatrix -> each camera can be filled independently without locking
+     */
+    class SparseBundleAdjustment::FillReducedColumns : public ParallelRows::Body
+    {
+        public:
+            FillReducedColumns( SparseBundleAdjustment & sba ) : _sba( sba )
+            {
+            }
+
+            void process( size_t cstart, size_t cend ) const
+            {
+                CamJTJ tmpBlock;
+                Eigen::Matrix<double, camParamDim, pointParamDim> tmpEval;
+                CamResidualType tmpRes;
+                const SparseBlockMatrix<camParamDim, pointParamDim> & camPointJTJ = _sba._camPointJTJ;
+
+                for( size_t c = cstart; c < cend; c++ ){
+                    // first create block for this cam:
+                    tmpBlock = _sba._camsJTJ[ c ];
+                    tmpRes   = _sba._camResiduals[ c ];
+
+                    // augment the jacobian diagonal
+                    //tmpBlock.diagonal().array() += _lambda;
+                    tmpBlock.diagonal().array() *= ( 1.0 + _sba._lambda );
+
+                    // go over all point measures ( = the blocks in row c ):
+                    for( size_t b = camPointJTJ.rowBegin( c ); b < camPointJTJ.rowEnd( c ); b++ ){
+                        size_t pointId = camPointJTJ.blockCol( b );
+
+                        const Eigen::Matrix<double, camParamDim, pointParamDim> & cp = camPointJTJ.blockAt( b );
+                        tmpEval = cp * _sba._invAugPJTJ[ pointId ];
+                        tmpBlock -= tmpEval * cp.transpose();
+                        tmpRes   -= tmpEval * _sba._pointResiduals[ pointId ];
+                    }
+
+                    // set the block in the sparse matrix:
+                    _sba.setBlockInReducedSparse( tmpBlock, c, c );
+                    _sba._reducedRHS.segment<camParamDim>( camParamDim * c ) = tmpRes;
+
+                    JointMeasurements::ConstMapIterType iter   = _sba._jointMeasures.secondEntityIteratorBegin( c );
+                    JointMeasurements::ConstMapIterType iStop  = _sba._jointMeasures.secondEntityIteratorEnd( c );
+                    while( iter != iStop ){
+                        size_t c2 = iter->first; // id of second cam:
+
+                        // iterate over the joint measurements of the two cameras
+                        std::set<size_t>::const_iterator pIdIter = iter->second.begin();
+                        std::set<size_t>::const_iterator pEnd    = iter->second.end();
+                        tmpBlock.setZero();
+                        while( pIdIter != pEnd ){
+                            size_t pId = *pIdIter;
+                            tmpBlock -= camPointJTJ.block( c, pId ) * _sba._invAugPJTJ[ pId ] * camPointJTJ.block( c2, pId ).transpose();
+                            ++pIdIter;
+                        }
+                        ++iter;
+
+                        _sba.setBlockInReducedSparse( tmpBlock.transpose(), c2, c );
+                    }
+                }
+            }
+
+        private:
+            SparseBundleAdjustment & _sba;
+    };
+
+    class SparseBundleAdjustment::SolveStructure : public ParallelRows::Body
+    {
+        public:
+            SolveStructure( SparseBundleAdjustment & sba, Eigen::VectorXd & deltaStruct, const Eigen::VectorXd & deltaCam, SlamMap & map ) :
+                _sba( sba ),
+                _deltaStruct( deltaStruct ),
+                _deltaCam( deltaCam ),
+                _map( map ),
+                _features( map.numFeatures() ),
+                _pointCosts( sba._nPts )
+            {
+                // a snapshot shares its feature chunks with the map it was copied from: detach them
+                // here, concurrent bands would otherwise copy the same shared chunk
+                for( size_t i = 0; i < _features.size(); i++ )
+                    _features[ i ] = &map.featureForId( i );
+            }
+
+            void process( size_t pstart, size_t pend ) const
+            {
+                Eigen::Vector3d res;
+                Eigen::Vector3d tmp;
+                Eigen::Vector2d pp, r;
+
+                const Eigen::Matrix3d & K = _map.intrinsics();
+                const SparseBlockMatrix<camParamDim, pointParamDim> & camPointJTJ = _sba._camPointJTJ;
+
+                for( size_t i = pstart; i < pend; i++ ){
+                    MapFeature& f = *_features[ i ];
+                    const MapFeature::ConstPointTrackIterator itEnd = f.pointTrackEnd();
+
+                    res = _sba._pointResiduals[ i ];
+                    for( size_t e = camPointJTJ.colBegin( i ); e < camPointJTJ.colEnd( i ); e++ ){
+                        size_t cam = camPointJTJ.colRow( e );
+                        res -= camPointJTJ.blockAt( camPointJTJ.colBlock( e ) ).transpose() * _deltaCam.segment<camParamDim>( cam * camParamDim );
+                    }
+
+                    tmp = _sba._invAugPJTJ[ i ] * res;
+                    _deltaStruct.segment<pointParamDim>( pointParamDim * i ) = tmp;
+
+                    // apply the delta:
+                    f.estimate().head<pointParamDim>() += tmp;
+
+                    // evaluate the current costs again:
+                    double costs = 0.0;
+                    MapFeature::ConstPointTrackIterator camIter = f.pointTrackBegin();
+                    while( camIter != itEnd ){
+                        const Keyframe & kf = _map.keyframeForId( *camIter );
+
+                        Vision::project( pp,
+                                         K,
+                                         kf.pose().transformation(),
+                                         f.estimate() );
+
+                        // get the measurement of point i in keyframe *camIter:
+                        const MapMeasurement & meas = kf.measurementForId( i );
+                        r = ( meas.point - pp );
+                        costs += ( r.transpose() * meas.information * r );
+                        ++camIter;
+                    }
+                    _pointCosts[ i ] = costs;
+                }
+            }
+
+            double costs() const
+            {
+                double sum = 0.0;
+                for( size_t i = 0; i < _pointCosts.size(); i++ )
+                    sum += _pointCosts[ i ];
+                return sum;
+            }
+
+        private:
+            SparseBundleAdjustment &	_sba;
+            Eigen::VectorXd &			_deltaStruct;
+            const Eigen::VectorXd &		_deltaCam;
+            const SlamMap &				_map;
+            std::vector<MapFeature*>	_features;
+            mutable std::vector<double> _pointCosts;
+    };
+
     void SparseBundleAdjustment::optimize( SlamMap & map, const TerminationCriteria<double> & criteria )
     {
         _iterations = 0;
@@ -81,6 +411,7 @@ namespace cvt {
 
         // resize internal structures for jacobians etc.
         resize( numCams, numPoints, map.numMeasurements() );
+        buildCamPointPattern( map );
 
         Eigen::VectorXd	deltaCam( camParamDim * numCams );
         Eigen::VectorXd	deltaPoint( pointParamDim * numPoints );
@@ -89,19 +420,25 @@ namespace cvt {
         // SimplicialCholesky -> LDLt by default, can also set LLt
         Eigen::SimplicialCholesky<Eigen::SparseMatrix<double, Eigen::ColMajor>, Eigen::Lower> solver;
 
+        if( _solverType == SOLVER_CHOLESKY ){
+            // the structure of the reduced system only depends on the joint point tracks
+            updateJointMeasurements( map );
+            prepareSparseMatrix( numCams );
+            solver.analyzePattern( _sparseReduced );
+        }
+
         double lastCosts = 1e20;
         while( true ){
             // build the reduced system: in first iteration, eval costs
             buildReducedCameraSystem( map );
 
-            if( _iterations == 0 ){
-                // solve symbolic
-                solver.analyzePattern( _sparseReduced );
+            if( _solverType == SOLVER_PCG ){
+                solveReducedPCG( deltaCam );
+            } else {
+                solver.factorize( _sparseReduced );
+                deltaCam = solver.solve( _reducedRHS );
             }
 
-            solver.factorize( _sparseReduced );
-            deltaCam = solver.solve( _reducedRHS );
-
             // safety check on computed delta
             if( _vectorHasNaNOrInf( deltaCam ) ){
                 // increase lambda and try again
@@ -149,105 +486,43 @@ namespace cvt {
         evaluateApproxHessians( map );
         updateInverseAugmentedPointHessians();
 
-        if( _iterations == 0 ){
-            // prepare the sparse matrix (storage allocation) <- need jointMeasures to be filled
-            prepareSparseMatrix( map.numKeyframes() );
-        }
-
-        fillSparseMatrix( map );
+        // the PCG solver works on the implicit Schur complement
+        if( _solverType == SOLVER_CHOLESKY )
+            fillSparseMatrix( map );
     }
 
-    void SparseBundleAdjustment::evaluateApproxHessians( const SlamMap & map )
+    void SparseBundleAdjustment::updateJointMeasurements( const SlamMap & map )
     {
-        CamScreenJacType	screenJacCam;
-        PointScreenJacType	screenJacPoint;
-        Eigen::Matrix<double, 6, 2> jCamTCovInv;
-        Eigen::Matrix<double, 3, 2> jPointTCovInv;
-        Eigen::Matrix<double, 3, 1> point3d, pCam;
-        Eigen::Matrix<double, 2, 1> residual;
-        Eigen::Matrix<double, 2, 1> reproj;
-
-        const Eigen::Matrix3d & K = map.intrinsics();
-
-        size_t currMeas = 0;
-        double avgDiag = 0.0;
-        bool firstIter = ( _iterations == 0 );
-
-        // for all 3D Points
-        clear();
-        _costs = 0.0;
-        for( size_t i = 0; i < _nPts; i++ ){
-            _pointsJTJ[ i ].setZero();
-            _pointResiduals[ i ].setZero();
+        _jointMeasures.resize( map.numKeyframes() );
 
-            // get the MapFeature:
+        for( size_t i = 0; i < map.numFeatures(); i++ ){
             const MapFeature & feature = map.featureForId( i );
-            const Eigen::Vector4d & ptmp = feature.estimate();
-            point3d = ptmp.head<3>() / ptmp[ 3 ];
-
-
-            // for all point tracks (meas. in the cams) of this point
             MapFeature::ConstPointTrackIterator camIterCurr = feature.pointTrackBegin();
             const MapFeature::ConstPointTrackIterator camIterEnd  = feature.pointTrackEnd();
 
-            /* update the joint meas structure: -> only needed in first iteration! */
-            if( firstIter ){
-                while( camIterCurr != camIterEnd ){
-                    MapFeature::ConstPointTrackIterator camIter = camIterCurr;
-                    camIter++;
-                    while( camIter != camIterEnd ) {
-                        _jointMeasures.addMeasurementForEntity( *camIterCurr, *camIter, i );
-                        ++camIter;
-                    }
-                    ++camIterCurr;
+            while( camIterCurr != camIterEnd ){
+                MapFeature::ConstPointTrackIterator camIter = camIterCurr;
+                camIter++;
+                while( camIter != camIterEnd ) {
+                    _jointMeasures.addMeasurementForEntity( *camIterCurr, *camIter, i );
+                    ++camIter;
                 }
+                ++camIterCurr;
             }
+        }
+    }
 
-            for( MapFeature::ConstPointTrackIterator camIter = feature.pointTrackBegin();
-                 camIter != camIterEnd;
-                 camIter++, currMeas++ ){
-                // get the keyframe:
-                const Keyframe & keyframe = map.keyframeForId( *camIter );
-
-                // screen jacobian for this 3D point in that camera
-                const Eigen::Matrix4d & trans = keyframe.pose().transformation();
-                const Eigen::Matrix<double, 3, 3> & R = trans.block<3, 3>( 0, 0 );
-                pCam = R * point3d + trans.block<3, 1>( 0, 3 );
-
-                // screen jacobian for this camera
-                keyframe.pose().screenJacobian( screenJacCam, pCam, K );
-
-                // point jacobian for this point in this cam:
-                evalScreenJacWrtPoint( reproj, screenJacPoint, pCam, K, R );
-
-                const MapMeasurement & mm = keyframe.measurementForId( i );
-                residual = mm.point - reproj;
-
-                // J^T * Cov^-1
-                jCamTCovInv = screenJacCam.transpose() * mm.information;
-                jPointTCovInv = screenJacPoint.transpose() * mm.information;
-
-                // accumulate the jacobians
-                _pointsJTJ[ i ]			+= jPointTCovInv * screenJacPoint;
-                _camsJTJ[ *camIter ]	+= jCamTCovInv * screenJacCam;
-
-                // accumulate the residuals
-                _pointResiduals[ i ]		+= ( jPointTCovInv * residual );
-                _camResiduals[ *camIter ]   += ( jCamTCovInv   * residual );
-
-                _costs += residual.transpose() * mm.information * residual;
-
-                /* camPointJacobian */
-                _camPointJTJ.block( *camIter, i ) = ( jCamTCovInv * screenJacPoint );
+    void SparseBundleAdjustment::evaluateApproxHessians( const SlamMap & map )
+    {
+        bool firstIter = ( _iterations == 0 );
 
-            }
+        clear();
 
-            // the pointjac JTJ & pointResidual sums for pt i are complete now
-            if( firstIter )
-                avgDiag += _pointsJTJ[ i ].diagonal().array().sum();
-
-        }
+        EvalHessians body( *this, map );
+        ParallelRows::run( body, _pointCost( _nMeas, _nPts ), _nPts );
 
+        double avgDiag;
+        body.reduce( _costs, avgDiag );
         _costs /= _nMeas;
 
         // compute initial lambda on first iteration
@@ -274,6 +549,7 @@ namespace cvt {
     void SparseBundleAdjustment::prepareSparseMatrix( size_t numCams )
     {
         // according to the joint Point tracks, we can create the matrix once
+        _sparseReduced.resize( camParamDim * numCams, camParamDim * numCams );
         _sparseReduced.reserve( camParamDim * camParamDim * _jointMeasures.numBlocks() );
 
         size_t c2;
@@ -311,75 +587,39 @@ namespace cvt {
         _sparseReduced.finalize();
     }
 
-    void SparseBundleAdjustment::fillSparseMatrix( const SlamMap & map )
+    void SparseBundleAdjustment::buildCamPointPattern( const SlamMap & map )
     {
-        // according to the joint Point tracks, we can now fill our matrix:
-        CamJTJ tmpBlock;
-        Eigen::Matrix<double, camParamDim, pointParamDim> tmpEval;
-        CamResidualType tmpRes;
-
+        // one pass over the measurements of all keyframes, they are sorted by point id
         size_t numCams = map.numKeyframes();
-        for( size_t c = 0; c < numCams; c++ ){
-            // first create block for this cam:
-            tmpBlock = _camsJTJ[ c ];
-            tmpRes   = _camResiduals[ c ];
+        std::vector<size_t> rowStart( numCams + 1 );
+        std::vector<size_t> cols;
+        cols.reserve( map.numMeasurements() );
 
-			// augment the jacobian diagonal
-            //tmpBlock.diagonal().array() += _lambda;
-            tmpBlock.diagonal().array() *= ( 1.0 + _lambda );
-
-            // go over all point measures:
+        for( size_t c = 0; c < numCams; c++ ){
+            rowStart[ c ] = cols.size();
             const Keyframe & k = map.keyframeForId( c );
             Keyframe::MeasurementIterator measIter = k.measurementsBegin();
             Keyframe::MeasurementIterator measEnd  = k.measurementsEnd();
             while( measIter != measEnd ){
-                size_t pointId = measIter->first;
-
-                const Eigen::Matrix<double, camParamDim, pointParamDim> & cp = _camPointJTJ.block( c, pointId );
-                tmpEval = cp * _invAugPJTJ[ pointId ];
-                tmpBlock -= tmpEval * cp.transpose();
-                tmpRes   -= tmpEval * _pointResiduals[ pointId ];
-
+                cols.push_back( measIter->first );
                 ++measIter;
             }
+        }
+        rowStart[ numCams ] = cols.size();
 
-            // set the block in the sparse matrix:
-            setBlockInReducedSparse( tmpBlock, c, c );
-            _reducedRHS.segment<camParamDim>( camParamDim * c ) = tmpRes;
-
-
-            JointMeasurements::ConstMapIterType iter   = _jointMeasures.secondEntityIteratorBegin( c );
-            JointMeasurements::ConstMapIterType iStop  = _jointMeasures.secondEntityIteratorEnd( c );
-            while( iter != iStop ){
-                size_t c2 = iter->first; // id of second cam:
-
-                // iterate over the joint measurements of the two cameras
-                std::set<size_t>::const_iterator pIdIter = iter->second.begin();
-                std::set<size_t>::const_iterator pEnd    = iter->second.end();
-                tmpBlock.setZero();
-                while( pIdIter != pEnd ){
-                    size_t pId = *pIdIter;
-                    tmpBlock -= _camPointJTJ.block( c, pId ) * _invAugPJTJ[ pId ] * _camPointJTJ.block( c2, pId ).transpose();
-                    ++pIdIter;
-                }
-                ++iter;
+        _camPointJTJ.setPattern( numCams, map.numFeatures(), rowStart, cols );
+    }
 
-                setBlockInReducedSparse( tmpBlock.transpose(), c2, c );
-            }
-        }
+    void SparseBundleAdjustment::fillSparseMatrix( const SlamMap & map )
+    {
+        FillReducedColumns body( *this );
+        ParallelRows::run( body, _pointCost( _nMeas, _nCams ), map.numKeyframes() );
     }
 
     void SparseBundleAdjustment::updateInverseAugmentedPointHessians()
     {
-        PointJTJ inv;
-        for( size_t i = 0; i < _nPts; i++ ){
-            inv = _pointsJTJ[ i ];
-            // augment the diagonal:
-            //inv.diagonal().array() += _lambda;
-            inv.diagonal().array() *= ( 1.0 + _lambda );
-            // TODO: is there a way to exploit symmetry when inverting with Eigen?
-            _invAugPJTJ[ i ] = inv.inverse();
-        }
+        InvertPointHessians body( *this );
+        ParallelRows::run( body, pointParamDim * pointParamDim, _nPts );
     }
 
     void SparseBundleAdjustment::setBlockInReducedSparse( const CamJTJ & m,
@@ -406,49 +646,63 @@ namespace cvt {
                                                  const Eigen::VectorXd & deltaCam,
                                                  SlamMap & map )
     {
-        size_t nPts = map.numFeatures();
-        Eigen::Vector3d res;
-        Eigen::Vector3d tmp;
-        Eigen::Vector2d pp, r;
-
-        const Eigen::Matrix3d & K = map.intrinsics();
-
-        _costs = 0.0;
-        for( size_t i = 0; i < nPts; i++ ){
-            MapFeature& f = map.featureForId( i );
-            MapFeature::ConstPointTrackIterator camIter = f.pointTrackBegin();
-            const MapFeature::ConstPointTrackIterator itEnd = f.pointTrackEnd();
-
-            res = _pointResiduals[ i ];
-            while( camIter != itEnd ){
-                res -= _camPointJTJ.block( *camIter, i ).transpose() * deltaCam.segment<camParamDim>( *camIter * camParamDim );
-                ++camIter;
-            }
-
-            tmp = _invAugPJTJ[ i ] * res;
-            deltaStruct.segment<pointParamDim>( pointParamDim * i ) = tmp;
+        SolveStructure body( *this, deltaStruct, deltaCam, map );
+        ParallelRows::run( body, _pointCost( _nMeas, _nPts ), map.numFeatures() );
+        _costs = body.costs() / _nMeas;
+    }
 
-            // apply the delta:
-            f.estimate().head<pointParamDim>() += tmp;
+    void SparseBundleAdjustment::solveReducedPCG( Eigen::VectorXd & deltaCam )
+    {
+        const size_t n = camParamDim * _nCams;
+        std::vector<CamJTJ, Eigen::aligned_allocator<CamJTJ> > augCams( _nCams ), precond( _nCams );
 
-            // evaluate the current costs again:
-            camIter = f.pointTrackBegin();
-            while( camIter != itEnd ){
-                const Keyframe & kf = map.keyframeForId( *camIter );
+        // augmented camera blocks and the inverse diagonal blocks of the Schur complement
+        for( size_t c = 0; c < _nCams; c++ ){
+            augCams[ c ] = _camsJTJ[ c ];
+            augCams[ c ].diagonal().array() *= ( 1.0 + _lambda );
+        }
+        _camPointJTJ.schurDiagonal( &precond[ 0 ], &augCams[ 0 ], _invAugPJTJ );
+        for( size_t c = 0; c < _nCams; c++ )
+            precond[ c ] = precond[ c ].inverse();
+
+        // rhs of the reduced system: camRes - W * V^-1 * pointRes
+        Eigen::VectorXd t( pointParamDim * _nPts ), wt, b( n );
+        for( size_t i = 0; i < _nPts; i++ )
+            t.segment<pointParamDim>( pointParamDim * i ) = _invAugPJTJ[ i ] * _pointResiduals[ i ];
+        _camPointJTJ.multiply( wt, t );
+        for( size_t c = 0; c < _nCams; c++ )
+            b.segment<camParamDim>( camParamDim * c ) = _camResiduals[ c ] - wt.segment<camParamDim>( camParamDim * c );
+
+        deltaCam.setZero( n );
+        double bnorm = b.norm();
+        if( bnorm == 0.0 )
+            return;
+
+        Eigen::VectorXd r = b, z( n ), p, Ap;
+        for( size_t c = 0; c < _nCams; c++ )
+            z.segment<camParamDim>( camParamDim * c ) = precond[ c ] * r.segment<camParamDim>( camParamDim * c );
+        p = z;
+        double rz = r.dot( z );
+
+        for( size_t iter = 0; iter < _pcgMaxIterations; iter++ ){
+            _camPointJTJ.schurProduct( Ap, p, &augCams[ 0 ], _invAugPJTJ );
+
+            double pAp = p.dot( Ap );
+            if( pAp <= 0.0 )
+                break;
 
-                Vision::project( pp,
-                                 K,
-                                 kf.pose().transformation(),
-                                 f.estimate() );
+            double alpha = rz / pAp;
+            deltaCam += alpha * p;
+            r -= alpha * Ap;
+            if( r.norm() <= _pcgTolerance * bnorm )
+                break;
 
-                // get the measurement of point i in keyframe *camIter:
-                const MapMeasurement & meas = kf.measurementForId( i );
-                r = ( meas.point - pp );
-                _costs += ( r.transpose() * meas.information * r );
-                ++camIter;
-            }
+            for( size_t c = 0; c < _nCams; c++ )
+                z.segment<camParamDim>( camParamDim * c ) = precond[ c ] * r.segment<camParamDim>( camParamDim * c );
+            double rzNew = r.dot( z );
+            p = z + ( rzNew / rz ) * p;
+            rz = rzNew;
         }
-        _costs /= _nMeas;
     }
 
     void SparseBundleAdjustment::undoStep( const Eigen::VectorXd & dCam,
@@ -479,8 +733,6 @@ namespace cvt {
                 delete[] _pointResiduals;
             _pointResiduals = new PointResidualType[ numPoints ];
 
-            _camPointJTJ.resize( numCams, numPoints );
-
             _nPts = numPoints;
         }
 
@@ -497,9 +749,6 @@ namespace cvt {
             _sparseReduced.resize( camParamDim * numCams, camParamDim * numCams );
             _reducedRHS.resize( camParamDim * numCams );
 
-            if( _camPointJTJ.numBlockRows() != numCams )
-                _camPointJTJ.resize( numCams, numPoints );
-
             _nCams = numCams;
         }
     }
@@ -41,6 +41,12 @@ namespace cvt {
 	class SparseBundleAdjustment
 	{
 		public:
+			/* solver for the reduced camera system */
+			enum SolverType {
+				SOLVER_CHOLESKY,	/* sparse LDLt of the explicitly assembled system */
+				SOLVER_PCG			/* conjugate gradients on the implicit Schur complement, block Jacobi preconditioned */
+			};
+
 			SparseBundleAdjustment();
 			~SparseBundleAdjustment();
 
@@ -55,6 +61,15 @@ namespace cvt {
 			double lambda( ) const { return _lambda; }
 			void setLambda( double newValue ) { _lambda = newValue; }
 
+			SolverType solverType() const { return _solverType; }
+			void setSolverType( SolverType type ) { _solverType = type; }
+
+			/* PCG stops after maxIterations or when |r| <= tolerance * |b| */
+			size_t pcgMaxIterations() const { return _pcgMaxIterations; }
+			void setPCGMaxIterations( size_t n ) { _pcgMaxIterations = n; }
+			double pcgTolerance() const { return _pcgTolerance; }
+			void setPCGTolerance( double tol ) { _pcgTolerance = tol; }
+
 //		private:
 			/* jacobians for each point */		
 			static const size_t pointParamDim = 3;
@@ -111,8 +126,22 @@ namespace cvt {
 			size_t _iterations;
 			double _costs;
 
+			SolverType _solverType;
+			size_t	   _pcgMaxIterations;
+			double	   _pcgTolerance;
+
+			class EvalHessians;
+			class InvertPointHessians;
+			class FillReducedColumns;
+			class SolveStructure;
+			friend class EvalHessians;
+			friend class InvertPointHessians;
+			friend class FillReducedColumns;
+			friend class SolveStructure;
+
 		public:
 			void buildReducedCameraSystem( const SlamMap & map );
+			void updateJointMeasurements( const SlamMap & map );
 			void evaluateApproxHessians( const SlamMap & map );
 			void fillSparseMatrix( const SlamMap & map );
 
@@ -125,10 +154,16 @@ namespace cvt {
 			/* reserve appropriate space and create internal blocks once! */
 			void prepareSparseMatrix( size_t numCams );
 
+			/* block pattern of the camera/point part of the Hessian from the measurements of the map */
+			void buildCamPointPattern( const SlamMap & map );
+
 			void setBlockInReducedSparse( const CamJTJ & m,
 										  size_t bRow,
 										  size_t bCol );
 
+			/* solve the reduced camera system with PCG, without assembling it */
+			void solveReducedPCG( Eigen::VectorXd & deltaCam );
+
 			void updateCameras( const Eigen::VectorXd & deltaCam,
 							    SlamMap & map );
 
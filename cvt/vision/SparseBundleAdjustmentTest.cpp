@@ -0,0 +1,128 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/ThreadPool.h>
+#include <cvt/vision/SparseBundleAdjustment.h>
+
+namespace cvt {
+
+	/* stereo-like track of a camera moving along x, every point seen by a few keyframes */
+	static void _sbaMap( SlamMap& map, size_t numKF, size_t numFeatures )
+	{
+		Eigen::Matrix3d K;
+		K << 500.0, 0.0, 320.0, 0.0, 500.0, 240.0, 0.0, 0.0, 1.0;
+		map.setIntrinsics( K );
+
+		std::vector<Eigen::Matrix4d, Eigen::aligned_allocator<Eigen::Matrix4d> > poses( numKF );
+		for( size_t c = 0; c < numKF; c++ ){
+			poses[ c ].setIdentity();
+			poses[ c ]( 0, 3 ) = -0.2 * c;
+			poses[ c ]( 1, 3 ) = 0.05 * ( c % 3 );
+
+			// disturb all but the first keyframe
+			Eigen::Matrix4d noisy = poses[ c ];
+			if( c ){
+				noisy( 0, 3 ) += 0.01 * ( ( c % 5 ) - 2.0 );
+				noisy( 2, 3 ) += 0.01;
+			}
+			map.addKeyframe( noisy );
+		}
+
+		MapMeasurement mm;
+		mm.information.setIdentity();
+		for( size_t i = 0; i < numFeatures; i++ ){
+			Eigen::Vector4d p( -2.0 + 0.2 * numKF * ( i % 97 ) / 97.0, -1.5 + 3.0 * ( i % 31 ) / 31.0, 5.0 + ( i % 13 ) * 0.3, 1.0 );
+			Eigen::Vector4d noisy = p;
+			noisy[ 0 ] += 0.01 * ( ( i % 7 ) - 3.0 );
+			noisy[ 2 ] -= 0.02 * ( ( i % 3 ) - 1.0 );
+
+			size_t first = i % numKF;
+			size_t id = 0;
+			for( size_t k = 0; k < 3; k++ ){
+				size_t c = ( first + k * 2 ) % numKF;
+				Eigen::Vector3d pc = K * ( poses[ c ] * p ).head<3>();
+				mm.point = pc.head<2>() / pc[ 2 ];
+				if( k == 0 )
+					id = map.addFeatureToKeyframe( MapFeature( noisy, Eigen::Matrix4d::Identity() ), mm, c );
+				else
+					map.addMeasurement( id, c, mm );
+			}
+		}
+	}
+
+	static void _sbaOptimize( SlamMap& map )
+	{
+		TerminationCriteria<double> criteria( TERM_MAX_ITER );
+		criteria.setMaxIterations( 5 );
+
+		SparseBundleAdjustment sba;
+		sba.optimize( map, criteria );
+	}
+
+BEGIN_CVTTEST( SparseBundleAdjustment )
+	bool ret = true;
+	bool b;
+
+	// run the bands concurrently even on a single core machine
+	size_t poolThreads = ThreadPool::instance().numThreads();
+	size_t threshold = ParallelRows::pixelThreshold();
+	ThreadPool::instance().setNumThreads( 4 );
+	ParallelRows::setPixelThreshold( 0 );
+	ParallelRows::ScopedNumThreads nt( 4 );
+
+	// 700 features: the band boundaries fall inside the chunks of the feature storage
+	SlamMap reference;
+	_sbaMap( reference, 10, 700 );
+	_sbaOptimize( reference );
+
+	SlamMap head;
+	_sbaMap( head, 10, 700 );
+	std::vector<Eigen::Vector4d, Eigen::aligned_allocator<Eigen::Vector4d> > initial;
+	for( size_t i = 0; i < head.numFeatures(); i++ )
+		initial.push_back( head.featureForId( i ).estimate() );
+
+	// the snapshot shares all chunks with the head map
+	SlamMap snapshot( head );
+	_sbaOptimize( snapshot );
+
+	const SlamMap& chead = head;
+	const SlamMap& csnap = snapshot;
+	b = true;
+	for( size_t i = 0; i < chead.numFeatures(); i++ ){
+		b &= ( chead.featureForId( i ).estimate() == initial[ i ] );
+		b &= ( csnap.featureForId( i ).estimate() == reference.featureForId( i ).estimate() );
+	}
+	for( size_t c = 0; c < csnap.numKeyframes(); c++ )
+		b &= ( csnap.keyframeForId( c ).pose().transformation() == reference.keyframeForId( c ).pose().transformation() );
+	CVTTEST_PRINT( "parallel SBA on a shared snapshot", b );
+	ret &= b;
+
+	ParallelRows::setPixelThreshold( threshold );
+	ThreadPool::instance().setNumThreads( poolThreads );
+	return ret;
+END_CVTTEST
+
+}
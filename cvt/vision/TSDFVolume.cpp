@@ -24,37 +24,321 @@
 
 #include <cvt/vision/TSDFVolume.h>
 #include <cvt/cl/kernel/TSDFVolume/TSDFVolume.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/Exception.h>
+
+#include <stdio.h>
+#include <math.h>
+#include <emmintrin.h>
 
 namespace cvt
 {
 
-	TSDFVolume::TSDFVolume( const Matrix4f& gridtoworld, size_t width, size_t height, size_t depth, float truncation ) :
+	/* the CPU backend follows the OpenCL kernels in TSDFVolume.cl operation by operation */
+
+	static inline float _dot4( const float* row, float x, float y, float z )
+	{
+		return row[ 0 ] * x + row[ 1 ] * y + row[ 2 ] * z + row[ 3 ];
+	}
+
+	static inline bool _isFinite( float v )
+	{
+		return v - v == 0.0f;
+	}
+
+	static inline float _mix( float a, float b, float t )
+	{
+		return a + ( b - a ) * t;
+	}
+
+	static inline void _voxelUpdate( float* voxel, const float* depth, size_t dstride, float ix, float iy, float z, float dscale, float trunc )
+	{
+		float d = depth[ dstride * ( size_t ) iy + ( size_t ) ix ] * dscale;
+		if( d > 0.0f ) {
+			float sdf = d - z;
+			if( Math::abs( sdf ) <= trunc ) {
+				float tsdf = sdf / trunc;
+				voxel[ 0 ] = ( voxel[ 0 ] * voxel[ 1 ] + tsdf ) / ( voxel[ 1 ] + 1.0f );
+				voxel[ 1 ] = voxel[ 1 ] + 1.0f;
+			}
+		}
+	}
+
+	class TSDFVolume::ClearSlabs : public ParallelRows::Body {
+		public:
+			ClearSlabs( float* volume, size_t slab, float weight ) : _volume( volume ), _slab( slab ), _weight( weight )
+			{
+			}
+
+			void process( size_t zstart, size_t zend ) const
+			{
+				float* ptr = _volume + 2 * _slab * zstart;
+				size_t n = _slab * ( zend - zstart );
+				while( n-- ) {
+					*ptr++ = 1.0f;
+					*ptr++ = _weight;
+				}
+			}
+
+		private:
+			float* _volume;
+			size_t _slab;
+			float  _weight;
+	};
+
+	class TSDFVolume::AddSlabs : public ParallelRows::Body {
+		public:
+			AddSlabs( float* volume, size_t width, size_t height, const Matrix4f& proj,
+					  const float* depth, size_t dstride, size_t dwidth, size_t dheight, float dscale, float trunc ) :
+				_volume( volume ), _width( width ), _height( height ), _proj( proj ),
+				_depth( depth ), _dstride( dstride ), _dwidth( dwidth ), _dheight( dheight ), _dscale( dscale ), _trunc( trunc )
+			{
+			}
+
+			void process( size_t zstart, size_t zend ) const
+			{
+				const float* m0 = _proj.ptr();
+				const float* m1 = m0 + 4;
+				const float* m2 = m0 + 8;
+				const float iwidth = ( float ) _dwidth;
+				const float iheight = ( float ) _dheight;
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 four = _mm_set1_ps( 4.0f );
+				const __m128 iw = _mm_set1_ps( iwidth );
+				const __m128 ih = _mm_set1_ps( iheight );
+				float __attribute__( ( aligned( 16 ) ) ) ix[ 4 ], iy[ 4 ], gz[ 4 ];
+
+				for( size_t z = zstart; z < zend; z++ ) {
+					for( size_t y = 0; y < _height; y++ ) {
+						float* voxel = _volume + 2 * ( z * _height + y ) * _width;
+						float fy = ( float ) y, fz = ( float ) z;
+
+						/* the same row-wise dot products as the scalar tail, lane by lane */
+						const __m128 rx0 = _mm_set1_ps( m0[ 0 ] ), ry0 = _mm_set1_ps( m0[ 1 ] * fy ), rz0 = _mm_set1_ps( m0[ 2 ] * fz ), rw0 = _mm_set1_ps( m0[ 3 ] );
+						const __m128 rx1 = _mm_set1_ps( m1[ 0 ] ), ry1 = _mm_set1_ps( m1[ 1 ] * fy ), rz1 = _mm_set1_ps( m1[ 2 ] * fz ), rw1 = _mm_set1_ps( m1[ 3 ] );
+						const __m128 rx2 = _mm_set1_ps( m2[ 0 ] ), ry2 = _mm_set1_ps( m2[ 1 ] * fy ), rz2 = _mm_set1_ps( m2[ 2 ] * fz ), rw2 = _mm_set1_ps( m2[ 3 ] );
+						__m128 vx = _mm_set_ps( 3.0f, 2.0f, 1.0f, 0.0f );
+
+						size_t x = 0;
+						for( ; x + 4 <= _width; x += 4, vx = _mm_add_ps( vx, four ) ) {
+							__m128 px = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( rx0, vx ), ry0 ), rz0 ), rw0 );
+							__m128 py = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( rx1, vx ), ry1 ), rz1 ), rw1 );
+							__m128 pz = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( rx2, vx ), ry2 ), rz2 ), rw2 );
+							__m128 qx = _mm_div_ps( px, pz );
+							__m128 qy = _mm_div_ps( py, pz );
+
+							__m128 inside = _mm_and_ps( _mm_and_ps( _mm_cmplt_ps( qx, iw ), _mm_cmplt_ps( qy, ih ) ),
+														_mm_and_ps( _mm_cmpge_ps( qx, zero ), _mm_cmpge_ps( qy, zero ) ) );
+							int mask = _mm_movemask_ps( _mm_and_ps( inside, _mm_cmpgt_ps( pz, zero ) ) );
+							if( !mask )
+								continue;
+
+							_mm_store_ps( ix, qx );
+							_mm_store_ps( iy, qy );
+							_mm_store_ps( gz, pz );
+							for( size_t i = 0; i < 4; i++ ) {
+								if( mask & ( 1 << i ) )
+									_voxelUpdate( voxel + 2 * ( x + i ), _depth, _dstride, ix[ i ], iy[ i ], gz[ i ], _dscale, _trunc );
+							}
+						}
+
+						for( ; x < _width; x++ ) {
+							float fx = ( float ) x;
+							float px = m0[ 0 ] * fx + m0[ 1 ] * fy + m0[ 2 ] * fz + m0[ 3 ];
+							float py = m1[ 0 ] * fx + m1[ 1 ] * fy + m1[ 2 ] * fz + m1[ 3 ];
+							float pz = m2[ 0 ] * fx + m2[ 1 ] * fy + m2[ 2 ] * fz + m2[ 3 ];
+							float qx = px / pz;
+							float qy = py / pz;
+							if( qx < iwidth && qy < iheight && qx >= 0.0f && qy >= 0.0f && pz > 0.0f )
+								_voxelUpdate( voxel + 2 * x, _depth, _dstride, qx, qy, pz, _dscale, _trunc );
+						}
+					}
+				}
+			}
+
+		private:
+			float*			_volume;
+			size_t			_width;
+			size_t			_height;
+			const Matrix4f& _proj;
+			const float*	_depth;
+			size_t			_dstride;
+			size_t			_dwidth;
+			size_t			_dheight;
+			float			_dscale;
+			float			_trunc;
+	};
+
+	class TSDFVolume::RayCastTiles : public ParallelRows::Body {
+		public:
+			RayCastTiles( float* out, size_t ostride, size_t owidth, size_t oheight, const float* volume, size_t width, size_t height, size_t depth,
+						  const Matrix4f& cam2g, const Matrix4f& g2cam, float scale ) :
+				_out( out ), _ostride( ostride ), _owidth( owidth ), _oheight( oheight ),
+				_volume( volume ), _width( width ), _height( height ), _depth( depth ),
+				_cam2g( cam2g ), _g2cam( g2cam ), _scale( scale )
+			{
+			}
+
+			static const size_t TILE_SIZE = 16;
+
+			/* the bands are pixel rows, tiles are cut at the band boundaries */
+			void process( size_t ystart, size_t yend ) const
+			{
+				size_t tyend;
+				for( size_t ty = ystart; ty < yend; ty = tyend ) {
+					tyend = Math::min( ( ty / TILE_SIZE + 1 ) * TILE_SIZE, yend );
+					for( size_t tx = 0; tx < _owidth; tx += TILE_SIZE ) {
+						size_t xend = Math::min( tx + TILE_SIZE, _owidth );
+						for( size_t y = ty; y < tyend; y++ ) {
+							float* dst = _out + _ostride * y;
+							for( size_t x = tx; x < xend; x++ )
+								dst[ x ] = rayCast( ( float ) x, ( float ) y );
+						}
+					}
+				}
+			}
+
+		private:
+			float value( float x, float y, float z ) const
+			{
+				x = Math::min( Math::max( 0.0f, x ), ( float ) ( _width - 2 ) );
+				y = Math::min( Math::max( 0.0f, y ), ( float ) ( _height - 2 ) );
+				z = Math::min( Math::max( 0.0f, z ), ( float ) ( _depth - 2 ) );
+
+				/* the position is clamped to positive values, truncation is floor */
+				size_t ix = ( size_t ) x, iy = ( size_t ) y, iz = ( size_t ) z;
+				float ax = x - ( float ) ix, ay = y - ( float ) iy, az = z - ( float ) iz;
+				const float* base = _volume + 2 * ( ( iz * _height + iy ) * _width + ix );
+				const size_t dy = 2 * _width;
+				const size_t dz = 2 * _width * _height;
+				const float* v[ 8 ] = { base, base + 2, base + dy, base + dy + 2,
+										base + dz, base + dz + 2, base + dz + dy, base + dz + dy + 2 };
+
+				for( size_t i = 0; i < 8; i++ ) {
+					if( v[ i ][ 1 ] < 1.0f )
+						return 1e10f;
+				}
+
+				float z0 = _mix( v[ 0 ][ 0 ], v[ 4 ][ 0 ], az );
+				float z1 = _mix( v[ 1 ][ 0 ], v[ 5 ][ 0 ], az );
+				float z2 = _mix( v[ 2 ][ 0 ], v[ 6 ][ 0 ], az );
+				float z3 = _mix( v[ 3 ][ 0 ], v[ 7 ][ 0 ], az );
+				return _mix( _mix( z0, z2, ay ), _mix( z1, z3, ay ), ax );
+			}
+
+			float rayCast( float gx, float gy ) const
+			{
+				const float* c0 = _cam2g.ptr();
+				float ox = c0[ 3 ], oy = c0[ 7 ], oz = c0[ 11 ];
+				float dx = _dot4( c0, gx, gy, 1.0f ) - ox;
+				float dy = _dot4( c0 + 4, gx, gy, 1.0f ) - oy;
+				float dz = _dot4( c0 + 8, gx, gy, 1.0f ) - oz;
+				float len = sqrtf( dx * dx + dy * dy + dz * dz );
+				dx /= len;
+				dy /= len;
+				dz /= len;
+
+				float start = fmaxf( fmaxf( ( ( dx > 0.0f ? 0.0f : ( float ) _width ) - ox ) / dx,
+											( ( dy > 0.0f ? 0.0f : ( float ) _height ) - oy ) / dy ),
+											( ( dz > 0.0f ? 0.0f : ( float ) _depth ) - oz ) / dz );
+				float end = fminf( fminf( ( ( dx > 0.0f ? ( float ) _width : 0.0f ) - ox ) / dx,
+										  ( ( dy > 0.0f ? ( float ) _height : 0.0f ) - oy ) / dy ),
+										  ( ( dz > 0.0f ? ( float ) _depth : 0.0f ) - oz ) / dz );
+
+				if( !( start < end && _isFinite( start ) && _isFinite( end ) && _isFinite( dx ) && _isFinite( dy ) && _isFinite( dz ) ) )
+					return 0.0f;
+
+				float vx = Math::abs( dx * ( end - start ) );
+				float vy = Math::abs( dy * ( end - start ) );
+				float vz = Math::abs( dz * ( end - start ) );
+				float step = 0.5f * sqrtf( vx * vx + vy * vy + vz * vz ) / fmaxf( vx, fmaxf( vy, vz ) );
+
+				float px = ox + dx * start, py = oy + dy * start, pz = oz + dz * start;
+				float prev = value( px, py, pz );
+
+				for( float lambda = start + step; lambda <= end; lambda += step ) {
+					float cx = ox + dx * lambda, cy = oy + dy * lambda, cz = oz + dz * lambda;
+					float val = value( cx, cy, cz );
+
+					if( prev < 0.0f && val > 0.0f )
+						break;
+
+					if( prev > 0.0f && val < 0.0f ) {
+						/* linear interpolation of the zero crossing between the two samples */
+						float alpha = -val / ( prev - val );
+						float sx = _mix( cx, px, alpha ), sy = _mix( cy, py, alpha ), sz = _mix( cz, pz, alpha );
+						return fmaxf( _dot4( _g2cam.ptr() + 8, sx, sy, sz ) * _scale, 0.0f );
+					}
+					prev = val;
+					px = cx;
+					py = cy;
+					pz = cz;
+				}
+				return 0.0f;
+			}
+
+			float*			_out;
+			size_t			_ostride;
+			size_t			_owidth;
+			size_t			_oheight;
+			const float*	_volume;
+			size_t			_width;
+			size_t			_height;
+			size_t			_depth;
+			const Matrix4f& _cam2g;
+			const Matrix4f& _g2cam;
+			float			_scale;
+	};
+
+	TSDFVolume::TSDFVolume( const Matrix4f& gridtoworld, size_t width, size_t height, size_t depth, float truncation, TSDFVolumeBackend backend ) :
 		_width( width ),
 		_height( height ),
 		_depth( depth ),
 		_trunc( truncation ),
 		_g2w( gridtoworld ),
-		_clvolume( sizeof( cl_float2 ) * width * height * depth ),
-		_clproj( sizeof( float ) * 12 ),
-		_clvolclear( _TSDFVolume_source, "TSDFVolume_clear" ),
-		_clvoladd( _TSDFVolume_source, "TSDFVolume_add" ),
-		_clsliceX( _TSDFVolume_source, "TSDFVolume_sliceX"),
-		_clsliceY( _TSDFVolume_source, "TSDFVolume_sliceY"),
-		_clsliceZ( _TSDFVolume_source, "TSDFVolume_sliceZ"),
-		_clraycastdepth( _TSDFVolume_source, "TSDFVolume_rayCastDepthmap" )
+		_backend( backend ),
+		_volume( NULL ),
+		_clvolume( NULL ),
+		_clvolclear( NULL ),
+		_clvoladd( NULL ),
+		_clraycastdepth( NULL )
 	{
+		if( _backend == TSDFVOLUME_BACKEND_CPU ) {
+			_volume = new float[ 2 * width * height * depth ];
+			clear();
+		} else {
+			_clvolume = new CLBuffer( sizeof( cl_float2 ) * width * height * depth );
+			_clvolclear = new CLKernel( _TSDFVolume_source, "TSDFVolume_clear" );
+			_clvoladd = new CLKernel( _TSDFVolume_source, "TSDFVolume_add" );
+			_clraycastdepth = new CLKernel( _TSDFVolume_source, "TSDFVolume_rayCastDepthmap" );
+		}
+	}
+
+	TSDFVolume::~TSDFVolume()
+	{
+		delete[] _volume;
+		delete _clvolume;
+		delete _clvolclear;
+		delete _clvoladd;
+		delete _clraycastdepth;
 	}
 
 	void TSDFVolume::clear( float weight )
 	{
+		if( _backend == TSDFVOLUME_BACKEND_CPU ) {
+			ClearSlabs body( _volume, _width * _height, weight );
+			ParallelRows::run( body, _width * _height, _depth );
+			return;
+		}
+
 		/* clear the volume */
-		_clvolclear.setArg( 0, _clvolume );
-		_clvolclear.setArg( 1, ( int ) _width);
-		_clvolclear.setArg( 2, ( int ) _height );
-		_clvolclear.setArg( 3, ( int ) _depth);
-		_clvolclear.setArg( 4, weight );
+		_clvolclear->setArg( 0, *_clvolume );
+		_clvolclear->setArg( 1, ( int ) _width);
+		_clvolclear->setArg( 2, ( int ) _height );
+		_clvolclear->setArg( 3, ( int ) _depth);
+		_clvolclear->setArg( 4, weight );
 		// FIXME: maybe 8 x 8 x ? for the local range is better
-		_clvolclear.run( CLNDRange( Math::pad16( _width ), Math::pad16( _height ), _depth ), CLNDRange( 16, 16, 1 ) );
+		_clvolclear->run( CLNDRange( Math::pad16( _width ), Math::pad16( _height ), _depth ), CLNDRange( 16, 16, 1 ) );
 	}
 
 
@@ -63,16 +347,33 @@ namespace cvt
 		// update projection matrix
 		Matrix4f projall = proj * _g2w;
 
+		if( _backend == TSDFVOLUME_BACKEND_CPU ) {
+			/* other formats are read normalized, like read_imagef does */
+			Image tmp;
+			const Image* dmap = &depthmap;
+			if( depthmap.format() != IFormat::GRAY_FLOAT ) {
+				depthmap.convert( tmp, IFormat::GRAY_FLOAT );
+				dmap = &tmp;
+			}
+
+			size_t dstride;
+			const float* dptr = dmap->map<float>( &dstride );
+			AddSlabs body( _volume, _width, _height, projall, dptr, dstride, dmap->width(), dmap->height(), scale, _trunc );
+			ParallelRows::run( body, _width * _height, _depth );
+			dmap->unmap( dptr );
+			return;
+		}
+
 		// add depthmap
-		_clvoladd.setArg( 0, _clvolume );
-		_clvoladd.setArg( 1, ( int ) _width );
-		_clvoladd.setArg( 2, ( int ) _height );
-		_clvoladd.setArg( 3, ( int ) _depth );
-		_clvoladd.setArg( 4, depthmap );
-		_clvoladd.setArg( 5, scale );
-		_clvoladd.setArg( 6, sizeof( float ) * 16, projall.ptr() );
-		_clvoladd.setArg( 7, _trunc );
-		_clvoladd.run( CLNDRange( Math::pad16( _width ), Math::pad16( _height ), _depth ), CLNDRange( 16, 16, 1 ) );
+		_clvoladd->setArg( 0, *_clvolume );
+		_clvoladd->setArg( 1, ( int ) _width );
+		_clvoladd->setArg( 2, ( int ) _height );
+		_clvoladd->setArg( 3, ( int ) _depth );
+		_clvoladd->setArg( 4, depthmap );
+		_clvoladd->setArg( 5, scale );
+		_clvoladd->setArg( 6, sizeof( float ) * 16, projall.ptr() );
+		_clvoladd->setArg( 7, _trunc );
+		_clvoladd->run( CLNDRange( Math::pad16( _width ), Math::pad16( _height ), _depth ), CLNDRange( 16, 16, 1 ) );
 	}
 
 	void TSDFVolume::addDepthMap( const Matrix3f& intrinsics, const Matrix4f& extrinsics, const Image& depthmap, float scale )
@@ -94,26 +395,50 @@ namespace cvt
 	{
 		Matrix4f projall = proj * _g2w;
 
+		if( _backend == TSDFVOLUME_BACKEND_CPU ) {
+			depthmap.reallocate( depthmap.width(), depthmap.height(), IFormat::GRAY_FLOAT, IALLOCATOR_MEM );
+
+			Matrix4f cam2g = projall.inverse();
+			size_t stride;
+			float* ptr = depthmap.map<float>( &stride );
+			RayCastTiles body( ptr, stride, depthmap.width(), depthmap.height(), _volume, _width, _height, _depth, cam2g, projall, scale );
+			ParallelRows::run( body, depthmap.width() * 32, depthmap.height() );
+			depthmap.unmap( ptr );
+			return;
+		}
+
 		depthmap.reallocate( depthmap.width(), depthmap.height(), IFormat::GRAY_FLOAT, IALLOCATOR_CL );
 
-		_clraycastdepth.setArg( 0, depthmap );
-		_clraycastdepth.setArg( 1, _clvolume );
-		_clraycastdepth.setArg( 2, ( int ) _width);
-		_clraycastdepth.setArg( 3, ( int ) _height );
-		_clraycastdepth.setArg( 4, ( int ) _depth);
-		_clraycastdepth.setArg( 5, sizeof( float ) * 16, projall.inverse().ptr() );
-		_clraycastdepth.setArg( 6, sizeof( float ) * 16, projall.ptr() );
-		_clraycastdepth.setArg( 7, scale );
-		_clraycastdepth.run( CLNDRange( Math::pad16( depthmap.width() ), Math::pad16( depthmap.height() ) ), CLNDRange( 16, 16 ) );
+		_clraycastdepth->setArg( 0, depthmap );
+		_clraycastdepth->setArg( 1, *_clvolume );
+		_clraycastdepth->setArg( 2, ( int ) _width);
+		_clraycastdepth->setArg( 3, ( int ) _height );
+		_clraycastdepth->setArg( 4, ( int ) _depth);
+		_clraycastdepth->setArg( 5, sizeof( float ) * 16, projall.inverse().ptr() );
+		_clraycastdepth->setArg( 6, sizeof( float ) * 16, projall.ptr() );
+		_clraycastdepth->setArg( 7, scale );
+		_clraycastdepth->run( CLNDRange( Math::pad16( depthmap.width() ), Math::pad16( depthmap.height() ) ), CLNDRange( 16, 16 ) );
+	}
+
+	const float* TSDFVolume::mapVolume() const
+	{
+		if( _backend == TSDFVOLUME_BACKEND_CPU )
+			return _volume;
+		return ( const float* ) _clvolume->map();
 	}
 
+	void TSDFVolume::unmapVolume( const float* ptr ) const
+	{
+		if( _backend != TSDFVOLUME_BACKEND_CPU )
+			_clvolume->unmap( ptr );
+	}
 
 	void TSDFVolume::toSceneMesh( SceneMesh& mesh ) const
 	{
-		float* ptr = ( float* ) _clvolume.map();
+		const float* ptr = mapVolume();
 		MarchingCubes mc( ptr, _width, _height, _depth, true );
 		mc.triangulateWithNormals( mesh, 0.0f );
-		_clvolume.unmap( ptr );
+		unmapVolume( ptr );
 	}
 
 	void TSDFVolume::sliceX( Image& img ) const
@@ -131,8 +456,8 @@ namespace cvt
 
 	void TSDFVolume::saveRaw( const String& path, bool weighted ) const
 	{
-		float* ptr = ( float* ) _clvolume.map();
-		float* origptr = ptr;
+		const float* ptr = mapVolume();
+		const float* origptr = ptr;
 		size_t n = _width * _height * _depth;
 
 		FILE* f;
@@ -148,6 +473,6 @@ namespace cvt
 		}
 		fclose( f );
 
-		_clvolume.unmap( origptr );
+		unmapVolume( origptr );
 	}
 }
@@ -33,10 +33,25 @@
 
 namespace cvt
 {
+	enum TSDFVolumeBackend {
+		TSDFVOLUME_BACKEND_CL = 0,
+		TSDFVOLUME_BACKEND_CPU
+	};
+
+	/**
+	 *	\class TSDFVolume
+	 *	\brief Truncated signed distance volume, fused from depth maps.
+	 *
+	 *	The voxels are ( distance, weight ) pairs in x, y, z order. The OpenCL backend keeps the
+	 *	volume in a CLBuffer, the CPU backend in host memory and runs its loops on the ThreadPool;
+	 *	both compute the same voxel updates and ray casts.
+	 */
 	class TSDFVolume
 	{
 		public:
-			TSDFVolume( const Matrix4f& gridtoworld, size_t width, size_t height, size_t depth, float truncation = 0.1f );
+			TSDFVolume( const Matrix4f& gridtoworld, size_t width, size_t height, size_t depth, float truncation = 0.1f,
+					    TSDFVolumeBackend backend = TSDFVOLUME_BACKEND_CL );
+			~TSDFVolume();
 
 			void clear( float weight = 0.0f );
 			void addDepthMap( const Matrix4f& proj, const Image& depthmap, float scale );
@@ -48,6 +63,7 @@ namespace cvt
 			size_t width() const { return _width; }
 			size_t height() const { return _height; }
 			size_t depth() const { return _depth; }
+			TSDFVolumeBackend backend() const { return _backend; }
 
 			void toSceneMesh( SceneMesh& mesh ) const;
 
@@ -66,17 +82,27 @@ namespace cvt
 			void saveRaw( const String& path, bool weighted ) const;
 
 		private:
+			TSDFVolume( const TSDFVolume& );
+			TSDFVolume& operator=( const TSDFVolume& );
+
+			class ClearSlabs;
+			class AddSlabs;
+			class RayCastTiles;
+
+			const float* mapVolume() const;
+			void		 unmapVolume( const float* ptr ) const;
+
 			size_t	 _width;
 			size_t	 _height;
 			size_t	 _depth;
 			float	 _trunc;
 			Matrix4f _g2w;
-			CLBuffer _clvolume;
-			CLBuffer _clproj;
-			CLKernel _clvolclear;
-			CLKernel _clvoladd;
-			CLKernel _clsliceX, _clsliceY, _clsliceZ;
-			CLKernel _clraycastdepth;
+			TSDFVolumeBackend _backend;
+			float*	  _volume; /* CPU backend */
+			CLBuffer* _clvolume;
+			CLKernel* _clvolclear;
+			CLKernel* _clvoladd;
+			CLKernel* _clraycastdepth;
 	};
 
 
@@ -0,0 +1,242 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/TSDFVolume.h>
+#include <cvt/gfx/IMapScoped.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/Time.h>
+
+#include <iostream>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace cvt;
+
+/* voxels of 2cm, the volume starts 0.5m in front of the camera and is centered on its axis */
+static Matrix4f _gridToWorld( size_t width, size_t height )
+{
+	Matrix4f g2w;
+	g2w.setIdentity();
+	g2w[ 0 ][ 0 ] = g2w[ 1 ][ 1 ] = g2w[ 2 ][ 2 ] = 0.02f;
+	g2w[ 0 ][ 3 ] = -0.01f * width;
+	g2w[ 1 ][ 3 ] = -0.01f * height;
+	g2w[ 2 ][ 3 ] = 0.5f;
+	return g2w;
+}
+
+static Matrix3f _intrinsics()
+{
+	Matrix3f K;
+	K.setIdentity();
+	K[ 0 ][ 0 ] = K[ 1 ][ 1 ] = 100.0f;
+	K[ 0 ][ 2 ] = 80.0f;
+	K[ 1 ][ 2 ] = 60.0f;
+	return K;
+}
+
+/* a plane at 1m, tilted around the y axis */
+static void _depthMap( Image& depth, float slope )
+{
+	depth.reallocate( 160, 120, IFormat::GRAY_FLOAT );
+	IMapScoped<float> map( depth );
+	for( size_t y = 0; y < depth.height(); y++ ) {
+		float* ptr = map.ptr();
+		for( size_t x = 0; x < depth.width(); x++ ) {
+			float u = ( ( float ) x - 80.0f ) / 100.0f;
+			/* z = 1 + slope * X with X = u * z */
+			ptr[ x ] = 1.0f / ( 1.0f - slope * u );
+		}
+		map++;
+	}
+}
+
+static void _readVolume( std::vector<float>& data, const TSDFVolume& volume )
+{
+	char path[] = "/tmp/cvt_tsdfXXXXXX";
+	int fd = mkstemp( path );
+	close( fd );
+	volume.saveRaw( path, true );
+
+	data.resize( 2 * volume.width() * volume.height() * volume.depth() );
+	FILE* f = fopen( path, "rb" );
+	size_t n = fread( &data[ 0 ], sizeof( float ), data.size(), f );
+	fclose( f );
+	unlink( path );
+	if( n != data.size() )
+		data.clear();
+}
+
+/* TSDFVolume_add from TSDFVolume.cl, voxel by voxel */
+static void _referenceAdd( std::vector<float>& data, size_t width, size_t height, size_t depth,
+						   const Matrix4f& proj, const Image& dmap, float trunc )
+{
+	IMapScoped<const float> map( dmap );
+	const float* m = proj.ptr();
+	for( size_t gz = 0; gz < depth; gz++ ) {
+		for( size_t gy = 0; gy < height; gy++ ) {
+			for( size_t gx = 0; gx < width; gx++ ) {
+				float* cv = &data[ 2 * ( ( gz * height + gy ) * width + gx ) ];
+				float px = m[ 0 ] * gx + m[ 1 ] * gy + m[ 2 ] * gz + m[ 3 ];
+				float py = m[ 4 ] * gx + m[ 5 ] * gy + m[ 6 ] * gz + m[ 7 ];
+				float pz = m[ 8 ] * gx + m[ 9 ] * gy + m[ 10 ] * gz + m[ 11 ];
+				float ix = px / pz, iy = py / pz;
+				if( ix < dmap.width() && iy < dmap.height() && ix >= 0 && iy >= 0 ) {
+					float d = map.line( ( size_t ) iy )[ ( size_t ) ix ];
+					if( d > 0 && pz > 0 ) {
+						float sdf = d - pz;
+						if( Math::abs( sdf ) <= trunc ) {
+							cv[ 0 ] = ( cv[ 0 ] * cv[ 1 ] + sdf / trunc ) / ( cv[ 1 ] + 1.0f );
+							cv[ 1 ] = cv[ 1 ] + 1.0f;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+static bool _fusionTest()
+{
+	/* odd width for the scalar tail of the SIMD loop */
+	const size_t w = 61, h = 50, d = 40;
+	Matrix4f g2w = _gridToWorld( w, h );
+	Matrix3f K = _intrinsics();
+	Matrix4f ext;
+	ext.setIdentity();
+
+	Image depth0, depth1;
+	_depthMap( depth0, 0.0f );
+	_depthMap( depth1, 0.2f );
+
+	TSDFVolume volume( g2w, w, h, d, 0.1f, TSDFVOLUME_BACKEND_CPU );
+	volume.addDepthMap( K, ext, depth0 );
+	volume.addDepthMap( K, ext, depth1 );
+
+	std::vector<float> data, ref( 2 * w * h * d );
+	for( size_t i = 0; i < ref.size(); i += 2 ) {
+		ref[ i ] = 1.0f;
+		ref[ i + 1 ] = 0.0f;
+	}
+	Matrix4f proj = K.toMatrix4() * ext * g2w;
+	_referenceAdd( ref, w, h, d, proj, depth0, 0.1f );
+	_referenceAdd( ref, w, h, d, proj, depth1, 0.1f );
+	_readVolume( data, volume );
+
+	bool result = data.size() == ref.size() && !memcmp( &data[ 0 ], &ref[ 0 ], sizeof( float ) * ref.size() );
+
+	TSDFVolume serial( g2w, w, h, d, 0.1f, TSDFVOLUME_BACKEND_CPU );
+	{
+		ParallelRows::ScopedNumThreads nt( 1 );
+		serial.addDepthMap( K, ext, depth0 );
+		serial.addDepthMap( K, ext, depth1 );
+	}
+	std::vector<float> sdata;
+	_readVolume( sdata, serial );
+	result &= sdata == data;
+	CVTTEST_PRINT( "TSDFVolume CPU add", result );
+
+	/* the ray cast of the fused planes sees the last one */
+	Image raycast( 160, 120, IFormat::GRAY_FLOAT );
+	TSDFVolume plane( g2w, w, h, d, 0.1f, TSDFVOLUME_BACKEND_CPU );
+	plane.addDepthMap( K, ext, depth1 );
+	plane.rayCastDepthMap( raycast, K, ext );
+
+	bool b = true;
+	size_t hits = 0;
+	{
+		IMapScoped<const float> rmap( raycast );
+		IMapScoped<const float> dmap( depth1 );
+		for( size_t y = 0; y < raycast.height(); y++ ) {
+			for( size_t x = 0; x < raycast.width(); x++ ) {
+				float r = rmap.ptr()[ x ];
+				if( r > 0.0f ) {
+					hits++;
+					b &= Math::abs( r - dmap.ptr()[ x ] ) < 0.01f;
+				}
+			}
+			rmap++;
+			dmap++;
+		}
+	}
+	/* the volume covers the center 60% x 80% of the image */
+	b &= hits > raycast.width() * raycast.height() / 3;
+
+	/* band boundaries that cut through the tiles do not change the result */
+	Image rserial( 160, 120, IFormat::GRAY_FLOAT ), rbands( 160, 120, IFormat::GRAY_FLOAT );
+	{
+		ParallelRows::ScopedNumThreads nt( 1 );
+		plane.rayCastDepthMap( rserial, K, ext );
+	}
+	{
+		ParallelRows::ScopedNumThreads nt( 7 );
+		plane.rayCastDepthMap( rbands, K, ext );
+	}
+	{
+		IMapScoped<const float> smap( rserial );
+		IMapScoped<const float> pmap( rbands );
+		for( size_t y = 0; y < rserial.height(); y++ ) {
+			b &= !memcmp( smap.ptr(), pmap.ptr(), sizeof( float ) * rserial.width() );
+			smap++;
+			pmap++;
+		}
+	}
+	CVTTEST_PRINT( "TSDFVolume CPU raycast", b );
+
+	return result && b;
+}
+
+static void _benchmark()
+{
+	const size_t n = 128;
+	Matrix4f g2w = _gridToWorld( n, n );
+	Matrix3f K = _intrinsics();
+	K[ 0 ][ 0 ] = K[ 1 ][ 1 ] = 400.0f;
+	K[ 0 ][ 2 ] = 320.0f;
+	K[ 1 ][ 2 ] = 240.0f;
+	Matrix4f ext;
+	ext.setIdentity();
+
+	Image depth( 640, 480, IFormat::GRAY_FLOAT ), raycast( 640, 480, IFormat::GRAY_FLOAT );
+	depth.fill( Color( 1.5f ) );
+
+	TSDFVolume volume( g2w, n, n, n, 0.1f, TSDFVOLUME_BACKEND_CPU );
+	Time t;
+	for( size_t i = 0; i < 10; i++ )
+		volume.addDepthMap( K, ext, depth );
+	double tadd = t.elapsedMilliSeconds() / 10.0;
+	t.reset();
+	for( size_t i = 0; i < 10; i++ )
+		volume.rayCastDepthMap( raycast, K, ext );
+	std::cout << "TSDFVolume CPU " << n << "^3: add " << tadd << " ms, raycast 640x480 "
+			  << t.elapsedMilliSeconds() / 10.0 << " ms" << std::endl;
+}
+
+BEGIN_CVTTEST( TSDFVolume )
+	bool result = _fusionTest();
+	_benchmark();
+	return result;
+END_CVTTEST
@@ -24,51 +24,40 @@
 
 #include <cvt/vision/features/AGAST.h>
 
-#include <cvt/vision/features/agast/OAST9_16.h>
-#include <cvt/vision/features/agast/Agast5_8.h>
-#include <cvt/vision/features/agast/Agast7_12d.h>
-#include <cvt/vision/features/agast/Agast7_12s.h>
-
 namespace cvt
 {
     AGAST::AGAST( ASTType astType, uint8_t threshold, size_t border ) :
         _astType( astType ),
-        _astDetector( 0 ),
+        _segmentTest( segmentTest( astType ) ),
         _threshold( threshold ),
-        _border( border )
+        _border( border ),
+        _nonMaxSuppress( false )
     {
-        switch( _astType ){
-            case AGAST_5_8:   _astDetector = new Agast5_8();   break;
-            case AGAST_7_12d: _astDetector = new Agast7_12d(); break;
-            case AGAST_7_12s: _astDetector = new Agast7_12s(); break;
-            case OAST_9_16:   _astDetector = new OAST9_16();   break;
-            default: throw CVTException( "unkown AST Type for AGAST!" );
-        }
     }
 
     AGAST::~AGAST()
     {
     }
 
-    void AGAST::detect( FeatureSet& features, const Image& img )
+    SegmentTest AGAST::segmentTest( ASTType astType )
     {
-        if( img.format() != IFormat::GRAY_UINT8 )
-            throw CVTException( "Input Image format must be GRAY_UINT8" );
+        switch( astType ){
+            case AGAST_5_8:   return SegmentTest( SegmentTest::CIRCLE_8, 5 );
+            case AGAST_7_12d: return SegmentTest( SegmentTest::CIRCLE_12_DIAMOND, 7 );
+            case AGAST_7_12s: return SegmentTest( SegmentTest::CIRCLE_12_SQUARE, 7 );
+            case OAST_9_16:   return SegmentTest( SegmentTest::CIRCLE_16, 9 );
+            default: throw CVTException( "unkown AST Type for AGAST!" );
+        }
+    }
 
-        FeatureSetWrapper fset( features );
-        _astDetector->detect( img, _threshold, fset, _border );
+    void AGAST::detect( FeatureSet& features, const Image& img )
+    {
+        _segmentTest.detect( features, img, _threshold, _border, _nonMaxSuppress );
     }
 
     void AGAST::detect( FeatureSet& featureSet, const ImagePyramid& imgpyr )
     {
-        if( imgpyr[ 0 ].format() != IFormat::GRAY_UINT8 )
-            throw CVTException( "Input Image format must be GRAY_UINT8" );
-
-        for( size_t coctave = 0; coctave < imgpyr.octaves(); coctave++ ) {
-            float cscale = Math::pow( imgpyr.scaleFactor(), -( float )coctave );
-            FeatureSetWrapper features( featureSet, cscale, coctave );
-            _astDetector->detect( imgpyr[ coctave ], _threshold, features, _border );
-        }
+        _segmentTest.detect( featureSet, imgpyr, _threshold, _border, _nonMaxSuppress );
     }
 
 }
@@ -26,10 +26,9 @@
 #define CVT_AGAST_H
 
 #include <cvt/vision/features/FeatureDetector.h>
+#include <cvt/vision/features/SegmentTest.h>
 
 namespace cvt {
-    class ASTDetector;
-
     class AGAST : public FeatureDetector
     {
         public:
@@ -52,12 +51,19 @@ namespace cvt {
             void setBorder( size_t border )			{ _border = Math::max<size_t>( border, 3 ); }
             size_t border() const					{ return _border; }
 
+            /* 3x3 non-maximum suppression of the scores, done in the detection pass */
+            void setNonMaxSuppress( bool nms )		{ _nonMaxSuppress = nms; }
+            bool nonMaxSuppress() const				{ return _nonMaxSuppress; }
+
         private:
+            static SegmentTest segmentTest( ASTType astType );
+
             ASTType         _astType;
-            ASTDetector*    _astDetector;
+            SegmentTest     _segmentTest;
 
             uint8_t _threshold;
             size_t	_border;
+            bool    _nonMaxSuppress;
     };
 }
 
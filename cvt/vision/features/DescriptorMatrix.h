@@ -0,0 +1,224 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_DESCRIPTORMATRIX_H
+#define CVT_DESCRIPTORMATRIX_H
+
+#include <cvt/util/Exception.h>
+#include <cvt/util/SIMD.h>
+#include <cvt/vision/features/Feature.h>
+
+#include <vector>
+#include <stdlib.h>
+#include <stdint.h>
+
+namespace cvt {
+
+	/**
+	 *	\class DescriptorMatrix
+	 *	\brief Packed structure of arrays storage for binary feature descriptors.
+	 *
+	 *	The descriptor bits of all features are stored row by row in one 64 byte aligned block,
+	 *	positions, angles and octaves are kept in separate arrays. This keeps the descriptor
+	 *	rows dense in memory for the blocked matching in HammingMatcher.
+	 */
+	class DescriptorMatrix {
+		public:
+			DescriptorMatrix( size_t descriptorBytes = 32 );
+			DescriptorMatrix( const DescriptorMatrix& other );
+			~DescriptorMatrix();
+
+			DescriptorMatrix& operator=( const DescriptorMatrix& other );
+
+			size_t			size() const;
+			size_t			descriptorBytes() const;
+			/* distance in bytes between two descriptor rows - multiple of 32 */
+			size_t			stride() const;
+
+			void			clear();
+			void			reserve( size_t n );
+			void			add( const Feature& feature, const uint8_t* desc );
+
+			const uint8_t*	descriptors() const;
+			const uint8_t*	descriptor( size_t i ) const;
+			const float*	x() const;
+			const float*	y() const;
+			const float*	angle() const;
+			const int*		octave() const;
+
+		private:
+			size_t				_bytes;
+			size_t				_stride;
+			size_t				_size;
+			size_t				_capacity;
+			uint8_t*			_desc;
+			std::vector<float>	_x;
+			std::vector<float>	_y;
+			std::vector<float>	_angle;
+			std::vector<int>	_octave;
+	};
+
+	inline DescriptorMatrix::DescriptorMatrix( size_t descriptorBytes ) :
+		_bytes( descriptorBytes ),
+		_stride( ( descriptorBytes + 0x1f ) & ~( ( size_t ) 0x1f ) ),
+		_size( 0 ),
+		_capacity( 0 ),
+		_desc( NULL )
+	{
+	}
+
+	inline DescriptorMatrix::DescriptorMatrix( const DescriptorMatrix& other ) :
+		_bytes( other._bytes ),
+		_stride( other._stride ),
+		_size( 0 ),
+		_capacity( 0 ),
+		_desc( NULL )
+	{
+		*this = other;
+	}
+
+	inline DescriptorMatrix::~DescriptorMatrix()
+	{
+		free( _desc );
+	}
+
+	inline DescriptorMatrix& DescriptorMatrix::operator=( const DescriptorMatrix& other )
+	{
+		if( this == &other )
+			return *this;
+
+		if( _stride != other._stride ) {
+			free( _desc );
+			_desc = NULL;
+			_capacity = 0;
+		}
+		_bytes = other._bytes;
+		_stride = other._stride;
+		_size = 0;
+		reserve( other._size );
+		if( other._size )
+			SIMD::instance()->Memcpy( _desc, other._desc, other._size * _stride );
+		_size = other._size;
+		_x = other._x;
+		_y = other._y;
+		_angle = other._angle;
+		_octave = other._octave;
+		return *this;
+	}
+
+	inline size_t DescriptorMatrix::size() const
+	{
+		return _size;
+	}
+
+	inline size_t DescriptorMatrix::descriptorBytes() const
+	{
+		return _bytes;
+	}
+
+	inline size_t DescriptorMatrix::stride() const
+	{
+		return _stride;
+	}
+
+	inline void DescriptorMatrix::clear()
+	{
+		_size = 0;
+		_x.clear();
+		_y.clear();
+		_angle.clear();
+		_octave.clear();
+	}
+
+	inline void DescriptorMatrix::reserve( size_t n )
+	{
+		if( n <= _capacity )
+			return;
+
+		uint8_t* ndesc;
+		if( posix_memalign( ( void** ) &ndesc, 64, n * _stride ) )
+			throw CVTException( "Out of memory" );
+		if( _size )
+			SIMD::instance()->Memcpy( ndesc, _desc, _size * _stride );
+		free( _desc );
+		_desc = ndesc;
+		_capacity = n;
+
+		_x.reserve( n );
+		_y.reserve( n );
+		_angle.reserve( n );
+		_octave.reserve( n );
+	}
+
+	inline void DescriptorMatrix::add( const Feature& feature, const uint8_t* desc )
+	{
+		if( _size == _capacity )
+			reserve( _capacity ? 2 * _capacity : 256 );
+
+		uint8_t* row = _desc + _size * _stride;
+		SIMD::instance()->Memcpy( row, desc, _bytes );
+		/* clear the padding, so that the rows can be compared in 32 byte chunks */
+		for( size_t i = _bytes; i < _stride; i++ )
+			row[ i ] = 0;
+		_size++;
+
+		_x.push_back( feature.pt.x );
+		_y.push_back( feature.pt.y );
+		_angle.push_back( feature.angle );
+		_octave.push_back( feature.octave );
+	}
+
+	inline const uint8_t* DescriptorMatrix::descriptors() const
+	{
+		return _desc;
+	}
+
+	inline const uint8_t* DescriptorMatrix::descriptor( size_t i ) const
+	{
+		return _desc + i * _stride;
+	}
+
+	inline const float* DescriptorMatrix::x() const
+	{
+		return &_x[ 0 ];
+	}
+
+	inline const float* DescriptorMatrix::y() const
+	{
+		return &_y[ 0 ];
+	}
+
+	inline const float* DescriptorMatrix::angle() const
+	{
+		return &_angle[ 0 ];
+	}
+
+	inline const int* DescriptorMatrix::octave() const
+	{
+		return &_octave[ 0 ];
+	}
+
+}
+
+#endif
@@ -26,8 +26,8 @@
 #define CVT_FAST_H
 
 #include <cvt/vision/features/FeatureDetector.h>
+#include <cvt/vision/features/SegmentTest.h>
 #include <cvt/math/Math.h>
-#include <cvt/util/CPU.h>
 #include <cvt/util/Exception.h>
 #include <cvt/gfx/Image.h>
 
@@ -57,52 +57,20 @@ namespace cvt
 			void setBorder( size_t border )			{ _border = Math::max<size_t>( border, 3 ); }
 			size_t border() const					{ return _border; }
 
-		private:
-            FASTSize    _fastSize;
-			uint8_t		_threshold;
-            size_t		_border;
-
-            static void make_offsets( int * offsets, size_t row_stride );
-
-			static void detect9( const Image& img, uint8_t threshold, FeatureSetWrapper& features, size_t border = 3 );
-			static void detect9cpu( const Image& img, uint8_t threshold, FeatureSetWrapper& features, size_t border = 3 );
-			static void detect9simd( const Image& img, uint8_t threshold, FeatureSetWrapper& features, size_t border = 3 );
-			static void detect10( const Image& img, uint8_t threshold, FeatureSetWrapper& features, size_t border = 3 );
-			static void detect11( const Image& img, uint8_t threshold, FeatureSetWrapper& features, size_t border = 3 );
-			static void detect12( const Image& img, uint8_t threshold, FeatureSetWrapper& features, size_t border = 3 );
-
-            static int score9Pixel( const uint8_t* p, const int * offsets, uint8_t threshold );
-            static int score10Pixel( const uint8_t* p, const int * offsets, uint8_t threshold );
-            static int score11Pixel( const uint8_t* p, const int * offsets, uint8_t threshold );
-            static int score12Pixel( const uint8_t* p, const int * offsets, uint8_t threshold );
+			/* 3x3 non-maximum suppression of the scores, done in the detection pass */
+			void setNonMaxSuppress( bool nms )		{ _nonMaxSuppress = nms; }
+			bool nonMaxSuppress() const				{ return _nonMaxSuppress; }
 
-            static bool isCorner9( const uint8_t * p, const int * offsets, uint8_t threshold );
-            static bool isCorner10( const uint8_t * p, const int * offsets, uint8_t threshold );
-            static bool isCorner11( const uint8_t * p, const int * offsets, uint8_t threshold );
-            static bool isCorner12( const uint8_t * p, const int * offsets, uint8_t threshold );
+		private:
+			static size_t arcLength( FASTSize size );
 
+			FASTSize	_fastSize;
+			uint8_t		_threshold;
+			size_t		_border;
+			bool		_nonMaxSuppress;
+			SegmentTest	_segmentTest;
 	};
 
-	inline void FAST::make_offsets( int* offsets, size_t row_stride )
-	{
-        offsets[ 0  ] =  0 + row_stride * 3;
-		offsets[ 1  ] =  1 + row_stride * 3;
-		offsets[ 2  ] =  2 + row_stride * 2;
-		offsets[ 3  ] =  3 + row_stride * 1;
-		offsets[ 4  ] =  3;
-		offsets[ 5  ] =  3 - row_stride * 1;
-		offsets[ 6  ] =  2 - row_stride * 2;
-		offsets[ 7  ] =  1 - row_stride * 3;
-		offsets[ 8  ] =    - row_stride * 3;
-		offsets[ 9  ] = -1 - row_stride * 3;
-		offsets[ 10 ] = -2 - row_stride * 2;
-		offsets[ 11 ] = -3 - row_stride * 1;
-		offsets[ 12 ] = -3;
-		offsets[ 13 ] = -3 + row_stride;
-		offsets[ 14 ] = -2 + row_stride * 2;
-		offsets[ 15 ] = -1 + row_stride * 3;
-    }
-
 }
 
 #endif
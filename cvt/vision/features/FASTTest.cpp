@@ -0,0 +1,210 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/features/FAST.h>
+#include <cvt/vision/features/AGAST.h>
+#include <cvt/gfx/IMapScoped.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+
+#include <stdlib.h>
+
+using namespace cvt;
+
+static const int _fastCircle[ 16 ][ 2 ] = { {  0,  3 }, {  1,  3 }, {  2,  2 }, {  3,  1 },
+											{  3,  0 }, {  3, -1 }, {  2, -2 }, {  1, -3 },
+											{  0, -3 }, { -1, -3 }, { -2, -2 }, { -3, -1 },
+											{ -3,  0 }, { -3,  1 }, { -2,  2 }, { -1,  3 } };
+
+/* blocks and discs of random intensity with noise */
+static void _testImage( Image& img, size_t w, size_t h )
+{
+	std::vector<int> buf( w * h, 128 );
+	for( size_t r = 0; r < 150; r++ ) {
+		int x0 = rand() % w, y0 = rand() % h;
+		int rw = rand() % 40 + 3, rh = rand() % 40 + 3;
+		int v = rand() % 256;
+		bool disc = rand() & 1;
+		for( int y = y0; y < y0 + rh && y < ( int ) h; y++ ) {
+			for( int x = x0; x < x0 + rw && x < ( int ) w; x++ ) {
+				int dx = 2 * ( x - x0 ) - rw, dy = 2 * ( y - y0 ) - rh;
+				if( disc && dx * dx * rh * rh + dy * dy * rw * rw > rw * rw * rh * rh )
+					continue;
+				buf[ y * w + x ] = v;
+			}
+		}
+	}
+
+	img.reallocate( w, h, IFormat::GRAY_UINT8 );
+	IMapScoped<uint8_t> map( img );
+	for( size_t y = 0; y < h; y++ ) {
+		uint8_t* ptr = map.ptr();
+		for( size_t x = 0; x < w; x++ )
+			ptr[ x ] = ( uint8_t ) Math::clamp( buf[ y * w + x ] + rand() % 13 - 6, 0, 255 );
+		map++;
+	}
+}
+
+static bool _isCorner( const IMapScoped<const uint8_t>& map, int x, int y, int arc, int threshold )
+{
+	int c = map( x, y );
+	for( int j = 0; j < 16; j++ ) {
+		int bright = 0, dark = 0;
+		for( int k = 0; k < arc; k++ ) {
+			int q = map( x + _fastCircle[ ( j + k ) % 16 ][ 0 ], y + _fastCircle[ ( j + k ) % 16 ][ 1 ] );
+			bright += q > c + threshold;
+			dark   += q < c - threshold;
+		}
+		if( bright == arc || dark == arc )
+			return true;
+	}
+	return false;
+}
+
+/* brute force segment test with the bisection score of the FAST decision trees */
+static void _detectReference( FeatureSet& features, const Image& img, int arc, int threshold, int border )
+{
+	IMapScoped<const uint8_t> map( img );
+	for( int y = border; y < ( int ) img.height() - border; y++ ) {
+		for( int x = border; x < ( int ) img.width() - border; x++ ) {
+			if( !_isCorner( map, x, y, arc, threshold ) )
+				continue;
+			int bmin = threshold, bmax = 255;
+			while( bmax - bmin > 1 ) {
+				int b = ( bmin + bmax ) / 2;
+				if( _isCorner( map, x, y, arc, b ) )
+					bmin = b;
+				else
+					bmax = b;
+			}
+			features.add( Feature( x, y, 0.0f, 0, bmin ) );
+		}
+	}
+}
+
+static bool _sameFeatures( const FeatureSet& a, const FeatureSet& b )
+{
+	if( a.size() != b.size() )
+		return false;
+	for( size_t i = 0; i < a.size(); i++ ) {
+		if( a[ i ].pt != b[ i ].pt || a[ i ].score != b[ i ].score || a[ i ].octave != b[ i ].octave )
+			return false;
+	}
+	return true;
+}
+
+static bool _segmentTest( const Image& img )
+{
+	bool result = true;
+	const FASTSize sizes[ 4 ] = { SEGMENT_9, SEGMENT_10, SEGMENT_11, SEGMENT_12 };
+
+	for( size_t i = 0; i < 4; i++ ) {
+		FAST fast( sizes[ i ], 25, 4 );
+		FeatureSet features, reference;
+		fast.detect( features, img );
+		_detectReference( reference, img, 9 + i, 25, 4 );
+
+		bool b = _sameFeatures( features, reference ) && reference.size() > 0;
+		CVTTEST_PRINT( "FAST segment test " << 9 + i, b );
+		result &= b;
+	}
+	return result;
+}
+
+static bool _nmsTest( const Image& img )
+{
+	FAST fast( SEGMENT_9, 20 );
+	FeatureSet features, reference;
+	fast.detect( reference, img );
+	reference.filterNMS( 1, true );
+
+	fast.setNonMaxSuppress( true );
+	fast.detect( features, img );
+
+	bool result = _sameFeatures( features, reference ) && reference.size() > 0;
+
+	AGAST agast( AGAST::OAST_9_16, 20 );
+	agast.setNonMaxSuppress( true );
+	FeatureSet oast;
+	agast.detect( oast, img );
+	result &= _sameFeatures( oast, reference );
+
+	CVTTEST_PRINT( "non-maximum suppression", result );
+	return result;
+}
+
+static bool _pyramidTest( const Image& img )
+{
+	bool result = true;
+	ImagePyramid pyr( 3, 0.5f );
+	pyr[ 0 ] = img;
+	pyr[ 1 ].reallocate( img.width() / 2, img.height() / 2, IFormat::GRAY_UINT8 );
+	pyr[ 2 ].reallocate( img.width() / 4, img.height() / 4, IFormat::GRAY_UINT8 );
+	_testImage( pyr[ 1 ], pyr[ 1 ].width(), pyr[ 1 ].height() );
+	_testImage( pyr[ 2 ], pyr[ 2 ].width(), pyr[ 2 ].height() );
+
+	const AGAST::ASTType types[ 4 ] = { AGAST::AGAST_5_8, AGAST::AGAST_7_12d, AGAST::AGAST_7_12s, AGAST::OAST_9_16 };
+	for( size_t t = 0; t < 4; t++ ) {
+		AGAST agast( types[ t ], 20 );
+		agast.setNonMaxSuppress( t & 1 );
+
+		/* octave by octave on the calling thread */
+		FeatureSet serial;
+		{
+			ParallelRows::ScopedNumThreads nt( 1 );
+			for( size_t o = 0; o < pyr.octaves(); o++ ) {
+				FeatureSet octave;
+				agast.detect( octave, pyr[ o ] );
+				for( size_t i = 0; i < octave.size(); i++ ) {
+					Feature f = octave[ i ];
+					f.pt *= Math::pow( 2.0f, ( float ) o );
+					f.octave = o;
+					serial.add( f );
+				}
+			}
+		}
+
+		FeatureSet features;
+		agast.detect( features, pyr );
+
+		bool b = _sameFeatures( features, serial ) && serial.size() > 0;
+		CVTTEST_PRINT( "AGAST pyramid " << t, b );
+		result &= b;
+	}
+	return result;
+}
+
+BEGIN_CVTTEST( FAST )
+	bool result = true;
+
+	srand( 4321 );
+	Image img;
+	_testImage( img, 397, 283 );
+
+	result &= _segmentTest( img );
+	result &= _nmsTest( img );
+	result &= _pyramidTest( img );
+
+	return result;
+END_CVTTEST
@@ -41,6 +41,7 @@ namespace cvt {
 			~FeatureSet();
 
 			void			add( const Feature& feature );
+			void			add( const Feature* features, size_t n );
 			void			clear();
 
 			size_t			size() const;
@@ -166,6 +167,11 @@ namespace cvt {
 		_features.push_back( feature );
 	}
 
+	inline void FeatureSet::add( const Feature* features, size_t n )
+	{
+		_features.insert( _features.end(), features, features + n );
+	}
+
 	inline void FeatureSet::clear()
 	{
 		_features.clear();
@@ -0,0 +1,323 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/features/HammingMatcher.h>
+#include <cvt/vision/features/RowLookupTable.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/math/Math.h>
+
+namespace cvt {
+
+	static const size_t NO_MATCH = ( size_t ) -1;
+
+	/* geometric constraint for scan line matching, sign flips the disparity for the reverse direction */
+	struct ScanLineWindow {
+		float minDisp;
+		float maxDisp;
+		float maxLineDist;
+		float sign;
+	};
+
+	static inline void initNeighbours( MatchingIndices* best, size_t k, size_t q, float limit )
+	{
+		for( size_t j = 0; j < k; j++ ) {
+			best[ j ].srcIdx = q;
+			best[ j ].dstIdx = NO_MATCH;
+			best[ j ].distance = limit;
+		}
+	}
+
+	/* insert into the sorted k best list, equal distances keep the smaller train index first */
+	static inline void insertNeighbour( MatchingIndices* best, size_t k, size_t q, size_t t, float d )
+	{
+		size_t j = k - 1;
+		while( j > 0 && d < best[ j - 1 ].distance ) {
+			best[ j ] = best[ j - 1 ];
+			j--;
+		}
+		best[ j ].srcIdx = q;
+		best[ j ].dstIdx = t;
+		best[ j ].distance = d;
+	}
+
+	class HammingNearestRows : public ParallelRows::Body {
+		public:
+			HammingNearestRows( MatchingIndices* best, size_t k, float limit,
+								const DescriptorMatrix& query, const DescriptorMatrix& train,
+								const ScanLineWindow* window ) :
+				_best( best ), _k( k ), _limit( limit ), _query( query ), _train( train ), _window( window )
+			{
+			}
+
+			void process( size_t qstart, size_t qend ) const
+			{
+				SIMD* simd = SIMD::instance();
+				const size_t stride = _query.stride();
+				const size_t ntrain = _train.size();
+				uint32_t dist[ HammingMatcher::TRAIN_BLOCK ];
+				uint8_t  valid[ HammingMatcher::TRAIN_BLOCK ];
+
+				for( size_t q = qstart; q < qend; q++ )
+					initNeighbours( _best + q * _k, _k, q, _limit );
+
+				for( size_t q0 = qstart; q0 < qend; q0 += HammingMatcher::QUERY_BLOCK ) {
+					size_t q1 = Math::min( q0 + HammingMatcher::QUERY_BLOCK, qend );
+
+					for( size_t t0 = 0; t0 < ntrain; t0 += HammingMatcher::TRAIN_BLOCK ) {
+						size_t tn = Math::min( HammingMatcher::TRAIN_BLOCK, ntrain - t0 );
+						const uint8_t* tdesc = _train.descriptor( t0 );
+
+						for( size_t q = q0; q < q1; q++ ) {
+							MatchingIndices* best = _best + q * _k;
+
+							if( _window ) {
+								if( !candidates( valid, q, t0, tn ) )
+									continue;
+								simd->hammingDistances( dist, _query.descriptor( q ), tdesc, stride, tn, stride );
+								for( size_t i = 0; i < tn; i++ ) {
+									if( valid[ i ] && ( float ) dist[ i ] < best[ _k - 1 ].distance )
+										insertNeighbour( best, _k, q, t0 + i, ( float ) dist[ i ] );
+								}
+							} else {
+								simd->hammingDistances( dist, _query.descriptor( q ), tdesc, stride, tn, stride );
+								for( size_t i = 0; i < tn; i++ ) {
+									if( ( float ) dist[ i ] < best[ _k - 1 ].distance )
+										insertNeighbour( best, _k, q, t0 + i, ( float ) dist[ i ] );
+								}
+							}
+						}
+					}
+				}
+			}
+
+		private:
+			/* mark the train features in [ t0, t0 + tn ) inside the scan line window of query q */
+			bool candidates( uint8_t* valid, size_t q, size_t t0, size_t tn ) const
+			{
+				const float  qx = _query.x()[ q ];
+				const float  qy = _query.y()[ q ];
+				const int	 qo = _query.octave()[ q ];
+				const float* tx = _train.x() + t0;
+				const float* ty = _train.y() + t0;
+				const int*	 to = _train.octave() + t0;
+				size_t		 num = 0;
+
+				for( size_t i = 0; i < tn; i++ ) {
+					float disp = _window->sign * ( qx - tx[ i ] );
+					valid[ i ] = Math::abs( qy - ty[ i ] ) < _window->maxLineDist &&
+								 qo == to[ i ] &&
+								 disp > _window->minDisp && disp < _window->maxDisp;
+					num += valid[ i ];
+				}
+				return num != 0;
+			}
+
+			MatchingIndices*		_best;
+			size_t					_k;
+			float					_limit;
+			const DescriptorMatrix& _query;
+			const DescriptorMatrix& _train;
+			const ScanLineWindow*	_window;
+	};
+
+	class HammingRowTableRows : public ParallelRows::Body {
+		public:
+			HammingRowTableRows( MatchingIndices* best, size_t k, float limit, const RowLookupTable& rlt,
+								 const DescriptorMatrix& query, const DescriptorMatrix& train,
+								 float minDisp, float maxDisp, float maxLineDist ) :
+				_best( best ), _k( k ), _limit( limit ), _rlt( rlt ), _query( query ), _train( train ),
+				_minDisp( minDisp ), _maxDisp( maxDisp ), _maxLineDist( maxLineDist )
+			{
+			}
+
+			void process( size_t qstart, size_t qend ) const
+			{
+				SIMD* simd = SIMD::instance();
+				const size_t stride = _query.stride();
+				const float* tx = _train.x();
+				uint32_t dist[ HammingMatcher::TRAIN_BLOCK ];
+
+				for( size_t q = qstart; q < qend; q++ ) {
+					MatchingIndices* best = _best + q * _k;
+					initNeighbours( best, _k, q, _limit );
+
+					float minX = _query.x()[ q ] - _maxDisp;
+					float maxX = _query.x()[ q ] - _minDisp;
+					float minY = _query.y()[ q ] - _maxLineDist;
+					float maxY = _query.y()[ q ] + _maxLineDist;
+
+					for( int y = minY; y < maxY; ++y ) {
+						if( !_rlt.isValidRow( y ) )
+							continue;
+
+						/* the features of a row are sorted by x - stop at the first one right of the window */
+						const RowLookupTable::Row& row = _rlt.row( y );
+						size_t t0 = row.start;
+						size_t tend = t0 + row.len;
+						while( t0 < tend && tx[ t0 ] < minX )
+							t0++;
+						size_t t1 = t0;
+						while( t1 < tend && !( tx[ t1 ] > maxX ) )
+							t1++;
+
+						for( ; t0 < t1; t0 += HammingMatcher::TRAIN_BLOCK ) {
+							size_t tn = Math::min( HammingMatcher::TRAIN_BLOCK, t1 - t0 );
+							simd->hammingDistances( dist, _query.descriptor( q ), _train.descriptor( t0 ), stride, tn, stride );
+							for( size_t i = 0; i < tn; i++ ) {
+								if( tx[ t0 + i ] < minX )
+									continue;
+								if( ( float ) dist[ i ] < best[ _k - 1 ].distance )
+									insertNeighbour( best, _k, q, t0 + i, ( float ) dist[ i ] );
+							}
+						}
+					}
+				}
+			}
+
+		private:
+			MatchingIndices*		_best;
+			size_t					_k;
+			float					_limit;
+			const RowLookupTable&	_rlt;
+			const DescriptorMatrix& _query;
+			const DescriptorMatrix& _train;
+			float					_minDisp;
+			float					_maxDisp;
+			float					_maxLineDist;
+	};
+
+	static void nearestNeighbours( std::vector<MatchingIndices>& best, size_t k, float limit,
+								   const DescriptorMatrix& query, const DescriptorMatrix& train,
+								   const ScanLineWindow* window, size_t numThreads )
+	{
+		if( query.stride() != train.stride() )
+			throw CVTException( "Descriptor sizes do not match" );
+
+		best.resize( query.size() * k );
+		HammingNearestRows body( &best[ 0 ], k, limit, query, train, window );
+		/* the pixel threshold of ParallelRows is applied to the number of descriptor pairs */
+		ParallelRows::run( body, train.size(), query.size(), numThreads );
+	}
+
+	HammingMatcher::HammingMatcher() :
+		_maxDistance( Math::MAXF ),
+		_ratio( 1.0f ),
+		_crossCheck( false ),
+		_numThreads( 0 )
+	{
+	}
+
+	void HammingMatcher::select( std::vector<MatchingIndices>& matches, const MatchingIndices* best, size_t k, size_t n, const MatchingIndices* reverse ) const
+	{
+		for( size_t q = 0; q < n; q++, best += k ) {
+			if( best[ 0 ].dstIdx == NO_MATCH || !( best[ 0 ].distance < _maxDistance ) )
+				continue;
+			if( k > 1 && best[ 1 ].dstIdx != NO_MATCH && !( best[ 0 ].distance < _ratio * best[ 1 ].distance ) )
+				continue;
+			if( reverse && reverse[ best[ 0 ].dstIdx ].dstIdx != q )
+				continue;
+			matches.push_back( best[ 0 ] );
+		}
+	}
+
+	void HammingMatcher::match( std::vector<MatchingIndices>& matches, const DescriptorMatrix& query, const DescriptorMatrix& train ) const
+	{
+		if( !query.size() || !train.size() )
+			return;
+
+		/* the ratio test needs the real second best distance, not only the ones below maxDistance */
+		size_t k = _ratio < 1.0f ? 2 : 1;
+		std::vector<MatchingIndices> best, reverse;
+		nearestNeighbours( best, k, k > 1 ? Math::MAXF : _maxDistance, query, train, NULL, _numThreads );
+		if( _crossCheck )
+			nearestNeighbours( reverse, 1, _maxDistance, train, query, NULL, _numThreads );
+
+		matches.reserve( matches.size() + query.size() );
+		select( matches, &best[ 0 ], k, query.size(), _crossCheck ? &reverse[ 0 ] : NULL );
+	}
+
+	void HammingMatcher::knnMatch( std::vector<std::vector<MatchingIndices> >& matches, const DescriptorMatrix& query, const DescriptorMatrix& train, size_t k ) const
+	{
+		matches.resize( query.size() );
+		if( !query.size() || !train.size() || !k )
+			return;
+
+		std::vector<MatchingIndices> best;
+		nearestNeighbours( best, k, _maxDistance, query, train, NULL, _numThreads );
+
+		for( size_t q = 0; q < query.size(); q++ ) {
+			const MatchingIndices* b = &best[ q * k ];
+			matches[ q ].clear();
+			for( size_t j = 0; j < k && b[ j ].dstIdx != NO_MATCH; j++ )
+				matches[ q ].push_back( b[ j ] );
+		}
+	}
+
+	void HammingMatcher::scanLineMatch( std::vector<MatchingIndices>& matches,
+										const DescriptorMatrix& query,
+										const DescriptorMatrix& train,
+										float minDisp,
+										float maxDisp,
+										float maxLineDist ) const
+	{
+		if( !query.size() || !train.size() )
+			return;
+
+		ScanLineWindow window = { minDisp, maxDisp, maxLineDist, 1.0f };
+		size_t k = _ratio < 1.0f ? 2 : 1;
+		std::vector<MatchingIndices> best, reverse;
+		nearestNeighbours( best, k, k > 1 ? Math::MAXF : _maxDistance, query, train, &window, _numThreads );
+		if( _crossCheck ) {
+			ScanLineWindow rwindow = { minDisp, maxDisp, maxLineDist, -1.0f };
+			nearestNeighbours( reverse, 1, _maxDistance, train, query, &rwindow, _numThreads );
+		}
+
+		matches.reserve( matches.size() + query.size() );
+		select( matches, &best[ 0 ], k, query.size(), _crossCheck ? &reverse[ 0 ] : NULL );
+	}
+
+	void HammingMatcher::scanLineMatch( std::vector<MatchingIndices>& matches,
+										const RowLookupTable& rlt,
+										const DescriptorMatrix& query,
+										const DescriptorMatrix& train,
+										float minDisp,
+										float maxDisp,
+										float maxLineDist ) const
+	{
+		if( !query.size() || !train.size() )
+			return;
+		if( query.stride() != train.stride() )
+			throw CVTException( "Descriptor sizes do not match" );
+
+		/* no cross check here - the row table only indexes the train features */
+		size_t k = _ratio < 1.0f ? 2 : 1;
+		std::vector<MatchingIndices> best( query.size() * k );
+		HammingRowTableRows body( &best[ 0 ], k, k > 1 ? Math::MAXF : _maxDistance, rlt, query, train, minDisp, maxDisp, maxLineDist );
+		ParallelRows::run( body, train.size(), query.size(), _numThreads );
+
+		matches.reserve( matches.size() + query.size() );
+		select( matches, &best[ 0 ], k, query.size(), NULL );
+	}
+
+}
@@ -0,0 +1,154 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_HAMMINGMATCHER_H
+#define CVT_HAMMINGMATCHER_H
+
+#include <cvt/vision/features/DescriptorMatrix.h>
+#include <cvt/vision/features/FeatureMatch.h>
+
+#include <vector>
+
+namespace cvt {
+	class RowLookupTable;
+
+	/**
+	 *	\class HammingMatcher
+	 *	\brief Blocked many-to-many matcher for binary descriptors stored in a DescriptorMatrix.
+	 *
+	 *	The distances are computed in tiles of query x train descriptors with SIMD::hammingDistances,
+	 *	so that a block of train descriptors stays in the cache while it is compared to a block of
+	 *	queries. The queries are split into bands which are processed in parallel with ParallelRows.
+	 *	Matches are reported as MatchingIndices with srcIdx being the query and dstIdx the train index.
+	 */
+	class HammingMatcher {
+		public:
+			HammingMatcher();
+
+			/* only report matches with distance < maxDistance */
+			void	setMaxDistance( float maxDistance );
+			float	maxDistance() const;
+
+			/* Lowe's ratio test: best < ratio * secondBest, a ratio >= 1 disables the test */
+			void	setRatio( float ratio );
+			float	ratio() const;
+
+			/* only keep matches where the query is also the best match of the train descriptor */
+			void	setCrossCheck( bool crossCheck );
+			bool	crossCheck() const;
+
+			/* maximum number of threads, 0 uses ParallelRows::numThreads() */
+			void	setNumThreads( size_t n );
+			size_t	numThreads() const;
+
+			void	match( std::vector<MatchingIndices>& matches, const DescriptorMatrix& query, const DescriptorMatrix& train ) const;
+
+			/* the k nearest neighbours within maxDistance of each query, sorted by distance */
+			void	knnMatch( std::vector<std::vector<MatchingIndices> >& matches, const DescriptorMatrix& query, const DescriptorMatrix& train, size_t k ) const;
+
+			/**
+			 *	\brief Stereo matching along scan lines
+			 *
+			 *	Only train features with |yq - yt| < maxLineDist, the same octave and a disparity
+			 *	xq - xt in ( minDisp, maxDisp ) are considered. Ratio test and cross check are
+			 *	applied within these windows.
+			 */
+			void	scanLineMatch( std::vector<MatchingIndices>& matches,
+								   const DescriptorMatrix& query,
+								   const DescriptorMatrix& train,
+								   float minDisp,
+								   float maxDisp,
+								   float maxLineDist ) const;
+
+			/**
+			 *	\brief Stereo matching along scan lines with the train features indexed by row
+			 *
+			 *	The train matrix has to be sorted by y, rlt is the RowLookupTable built from it.
+			 *	The octaves are not compared and the cross check is not applied.
+			 */
+			void	scanLineMatch( std::vector<MatchingIndices>& matches,
+								   const RowLookupTable& rlt,
+								   const DescriptorMatrix& query,
+								   const DescriptorMatrix& train,
+								   float minDisp,
+								   float maxDisp,
+								   float maxLineDist ) const;
+
+			/* number of train descriptors per tile */
+			static const size_t TRAIN_BLOCK = 512;
+			/* number of query descriptors per tile */
+			static const size_t QUERY_BLOCK = 32;
+
+		private:
+			void	select( std::vector<MatchingIndices>& matches, const MatchingIndices* best, size_t k, size_t n, const MatchingIndices* reverse ) const;
+
+			float	_maxDistance;
+			float	_ratio;
+			bool	_crossCheck;
+			size_t	_numThreads;
+	};
+
+	inline void HammingMatcher::setMaxDistance( float maxDistance )
+	{
+		_maxDistance = maxDistance;
+	}
+
+	inline float HammingMatcher::maxDistance() const
+	{
+		return _maxDistance;
+	}
+
+	inline void HammingMatcher::setRatio( float ratio )
+	{
+		_ratio = ratio;
+	}
+
+	inline float HammingMatcher::ratio() const
+	{
+		return _ratio;
+	}
+
+	inline void HammingMatcher::setCrossCheck( bool crossCheck )
+	{
+		_crossCheck = crossCheck;
+	}
+
+	inline bool HammingMatcher::crossCheck() const
+	{
+		return _crossCheck;
+	}
+
+	inline void HammingMatcher::setNumThreads( size_t n )
+	{
+		_numThreads = n;
+	}
+
+	inline size_t HammingMatcher::numThreads() const
+	{
+		return _numThreads;
+	}
+
+}
+
+#endif
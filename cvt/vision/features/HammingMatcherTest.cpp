@@ -0,0 +1,204 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/features/HammingMatcher.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/math/Math.h>
+
+#include <stdlib.h>
+
+using namespace cvt;
+
+static void _randomDescriptors( DescriptorMatrix& query, DescriptorMatrix& train, size_t nquery, size_t ntrain )
+{
+	uint8_t desc[ 32 ];
+	std::vector<uint8_t> tdesc( ntrain * 32 );
+	Feature f;
+
+	for( size_t i = 0; i < ntrain; i++ ) {
+		for( size_t b = 0; b < 32; b++ )
+			tdesc[ i * 32 + b ] = ( uint8_t ) rand();
+		f.pt.x = Math::rand( 0.0f, 640.0f );
+		f.pt.y = ( float ) ( rand() % 48 );
+		f.octave = rand() % 2;
+		train.add( f, &tdesc[ i * 32 ] );
+	}
+
+	/* most queries are noisy copies of a train descriptor, so that there are real matches */
+	for( size_t i = 0; i < nquery; i++ ) {
+		size_t t = rand() % ntrain;
+		for( size_t b = 0; b < 32; b++ )
+			desc[ b ] = tdesc[ t * 32 + b ];
+		if( i % 5 ) {
+			for( size_t n = 0; n < 20; n++ )
+				desc[ rand() % 32 ] ^= ( uint8_t ) ( 1 << ( rand() % 8 ) );
+		} else {
+			for( size_t b = 0; b < 32; b++ )
+				desc[ b ] = ( uint8_t ) rand();
+		}
+		f.pt.x = train.x()[ t ] + Math::rand( 0.0f, 40.0f );
+		f.pt.y = train.y()[ t ] + Math::rand( -1.5f, 1.5f );
+		f.octave = train.octave()[ t ];
+		query.add( f, desc );
+	}
+}
+
+/* straight forward reference: best match per query, ties resolved to the smaller train index */
+static size_t _nearest( const DescriptorMatrix& query, size_t q, const DescriptorMatrix& train, float& dist, const float* window )
+{
+	SIMD* simd = SIMD::instance();
+	size_t best = ( size_t ) -1;
+	dist = Math::MAXF;
+	for( size_t t = 0; t < train.size(); t++ ) {
+		if( window ) {
+			float disp = query.x()[ q ] - train.x()[ t ];
+			if( !( Math::abs( query.y()[ q ] - train.y()[ t ] ) < window[ 2 ] &&
+				   query.octave()[ q ] == train.octave()[ t ] &&
+				   disp > window[ 0 ] && disp < window[ 1 ] ) )
+				continue;
+		}
+		float d = simd->hammingDistance( query.descriptor( q ), train.descriptor( t ), 32 );
+		if( d < dist ) {
+			dist = d;
+			best = t;
+		}
+	}
+	return best;
+}
+
+static bool _sameMatches( const std::vector<MatchingIndices>& a, const std::vector<MatchingIndices>& b )
+{
+	if( a.size() != b.size() )
+		return false;
+	for( size_t i = 0; i < a.size(); i++ ) {
+		if( a[ i ].srcIdx != b[ i ].srcIdx || a[ i ].dstIdx != b[ i ].dstIdx || a[ i ].distance != b[ i ].distance )
+			return false;
+	}
+	return true;
+}
+
+static bool _matchTest( const DescriptorMatrix& query, const DescriptorMatrix& train )
+{
+	const float maxDist = 60.0f;
+	std::vector<MatchingIndices> ref, matches, single;
+
+	for( size_t q = 0; q < query.size(); q++ ) {
+		MatchingIndices m;
+		m.srcIdx = q;
+		m.dstIdx = _nearest( query, q, train, m.distance, NULL );
+		if( m.distance < maxDist )
+			ref.push_back( m );
+	}
+
+	HammingMatcher matcher;
+	matcher.setMaxDistance( maxDist );
+	matcher.match( matches, query, train );
+	{
+		ParallelRows::ScopedNumThreads st( 1 );
+		matcher.match( single, query, train );
+	}
+
+	bool b = _sameMatches( ref, matches ) && _sameMatches( ref, single ) && ref.size() > query.size() / 2;
+	CVTTEST_PRINT( "match", b );
+	return b;
+}
+
+static bool _knnTest( const DescriptorMatrix& query, const DescriptorMatrix& train )
+{
+	bool b = true;
+	std::vector<std::vector<MatchingIndices> > knn;
+	std::vector<MatchingIndices> ratio, cross;
+
+	HammingMatcher matcher;
+	matcher.knnMatch( knn, query, train, 3 );
+	b &= knn.size() == query.size();
+	for( size_t q = 0; q < knn.size() && b; q++ ) {
+		float dist;
+		size_t best = _nearest( query, q, train, dist, NULL );
+		b &= knn[ q ].size() == 3 && knn[ q ][ 0 ].dstIdx == best && knn[ q ][ 0 ].distance == dist;
+		b &= knn[ q ][ 0 ].distance <= knn[ q ][ 1 ].distance && knn[ q ][ 1 ].distance <= knn[ q ][ 2 ].distance;
+	}
+	CVTTEST_PRINT( "knnMatch", b );
+
+	bool r = true;
+	matcher.setRatio( 0.8f );
+	matcher.match( ratio, query, train );
+	for( size_t i = 0; i < ratio.size(); i++ ) {
+		const std::vector<MatchingIndices>& nn = knn[ ratio[ i ].srcIdx ];
+		r &= ratio[ i ].dstIdx == nn[ 0 ].dstIdx && nn[ 0 ].distance < 0.8f * nn[ 1 ].distance;
+	}
+	r &= ratio.size() > 0 && ratio.size() < query.size();
+	CVTTEST_PRINT( "ratio test", r );
+
+	bool c = true;
+	matcher.setRatio( 1.0f );
+	matcher.setCrossCheck( true );
+	matcher.match( cross, query, train );
+	for( size_t i = 0; i < cross.size(); i++ ) {
+		float dist;
+		c &= _nearest( train, cross[ i ].dstIdx, query, dist, NULL ) == cross[ i ].srcIdx;
+	}
+	c &= cross.size() > 0;
+	CVTTEST_PRINT( "cross check", c );
+
+	return b && r && c;
+}
+
+static bool _scanLineTest( const DescriptorMatrix& query, const DescriptorMatrix& train )
+{
+	const float window[ 3 ] = { 0.0f, 48.0f, 1.0f };
+	const float maxDist = 60.0f;
+	std::vector<MatchingIndices> ref, matches;
+
+	for( size_t q = 0; q < query.size(); q++ ) {
+		MatchingIndices m;
+		m.srcIdx = q;
+		m.dstIdx = _nearest( query, q, train, m.distance, window );
+		if( m.distance < maxDist )
+			ref.push_back( m );
+	}
+
+	HammingMatcher matcher;
+	matcher.setMaxDistance( maxDist );
+	matcher.scanLineMatch( matches, query, train, window[ 0 ], window[ 1 ], window[ 2 ] );
+
+	bool b = _sameMatches( ref, matches ) && ref.size() > 0;
+	CVTTEST_PRINT( "scanLineMatch", b );
+	return b;
+}
+
+BEGIN_CVTTEST( HammingMatcher )
+	bool result = true;
+
+	srand( 1234 );
+	DescriptorMatrix query, train;
+	_randomDescriptors( query, train, 1500, 2100 );
+
+	result &= _matchTest( query, train );
+	result &= _knnTest( query, train );
+	result &= _scanLineTest( query, train );
+
+	return result;
+END_CVTTEST
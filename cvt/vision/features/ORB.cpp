@@ -23,6 +23,9 @@
 */
 
 #include <cvt/vision/features/ORB.h>
+#include <cvt/util/ParallelRows.h>
+
+#include <emmintrin.h>
 
 namespace cvt {
 
@@ -32,4 +35,302 @@ namespace cvt {
 	};
 
 	#include "ORBPattern.h"
+
+	/* octave data shared by all extraction threads */
+	struct ORB::Octave {
+		Octave() : base( 0 ), stride( 0 ), scale( 1.0f ) {}
+
+		const uint8_t*	 base;
+		size_t			 stride;	/* in elements */
+		float			 scale;
+		std::vector<int> offsets;	/* element offsets of the 30 rotated test patterns */
+	};
+
+	/* features in octave-sorted order, each one writes only its own descriptor */
+	class ORB::ExtractBody : public ParallelRows::Body {
+		public:
+			ExtractBody( Descriptor* descriptors, const size_t* order, const Octave* octaves, size_t noctaves, bool integral ) :
+				_descriptors( descriptors ), _order( order ), _octaves( octaves ), _noctaves( noctaves ), _integral( integral )
+			{
+			}
+
+			void process( size_t start, size_t end ) const
+			{
+				for( size_t k = start; k < end; k++ ) {
+					Descriptor& desc = _descriptors[ _order[ k ] ];
+					const Octave& octave = _octaves[ _noctaves == 1 ? 0 : desc.octave ];
+					int x = ( int ) ( desc.pt.x * octave.scale );
+					int y = ( int ) ( desc.pt.y * octave.scale );
+
+					if( _integral ) {
+						const float* p = ( const float* ) octave.base + y * octave.stride + x;
+						desc.angle = centroidAngle( p, octave.stride );
+						descriptor( desc, p, octave.stride, &octave.offsets[ 0 ] );
+					} else {
+						const uint8_t* p = octave.base + y * octave.stride + x;
+						desc.angle = centroidAngle( p, octave.stride );
+						descriptor( desc, p, &octave.offsets[ 0 ] );
+					}
+				}
+			}
+
+		private:
+			Descriptor*	  _descriptors;
+			const size_t* _order;
+			const Octave* _octaves;
+			size_t		  _noctaves;
+			bool		  _integral;
+	};
+
+	void ORB::extract( const ImagePyramid& pyr, const FeatureSet& features )
+	{
+		if( pyr[ 0 ].channels() != 1 ||
+			( pyr[ 0 ].format() != IFormat::GRAY_UINT8 && pyr[ 0 ].format() != IFormat::GRAY_FLOAT ) )
+			throw CVTException( "Unimplemented" );
+
+		ImagePyramid integralPyr( pyr.octaves(), pyr.scaleFactor() );
+		pyr.integralImage( integralPyr );
+		extractIntegral( integralPyr, features );
+	}
+
+	void ORB::extract( const Image& img, const FeatureSet& features )
+	{
+		if( img.channels() != 1 ||
+			( img.format() != IFormat::GRAY_UINT8 && img.format() != IFormat::GRAY_FLOAT ) )
+			throw CVTException( "Unimplemented" );
+
+		IntegralImage iimage( img );
+		const Image* octaves[ 1 ] = { &iimage.sumImage() };
+		extractOctaves( octaves, 1, 1.0f, features, true );
+	}
+
+	void ORB::extractIntegral( const ImagePyramid& integralPyr, const FeatureSet& features )
+	{
+		std::vector<const Image*> octaves( integralPyr.octaves() );
+		for( size_t i = 0; i < octaves.size(); i++ ) {
+			if( integralPyr[ i ].format() != IFormat::GRAY_FLOAT )
+				throw CVTException( "Integral images must be GRAY_FLOAT" );
+			octaves[ i ] = &integralPyr[ i ];
+		}
+		if( octaves.size() )
+			extractOctaves( &octaves[ 0 ], octaves.size(), integralPyr.scaleFactor(), features, true );
+	}
+
+	void ORB::extractSmoothed( const ImagePyramid& smoothedPyr, const FeatureSet& features )
+	{
+		std::vector<const Image*> octaves( smoothedPyr.octaves() );
+		for( size_t i = 0; i < octaves.size(); i++ ) {
+			if( smoothedPyr[ i ].format() != IFormat::GRAY_UINT8 )
+				throw CVTException( "Smoothed images must be GRAY_UINT8" );
+			octaves[ i ] = &smoothedPyr[ i ];
+		}
+		if( octaves.size() )
+			extractOctaves( &octaves[ 0 ], octaves.size(), smoothedPyr.scaleFactor(), features, false );
+	}
+
+	void ORB::extractOctaves( const Image* const* images, size_t n, float scaleFactor, const FeatureSet& features, bool integral )
+	{
+		size_t nfeatures = features.size();
+		size_t first = _features.size();
+
+		/* sort the features by octave with a counting sort, a single image takes all features */
+		std::vector<size_t> count( n + 1, 0 );
+		for( size_t i = 0; i < nfeatures; i++ ) {
+			size_t o = n == 1 ? 0 : features[ i ].octave;
+			if( o >= n )
+				throw CVTException( "Feature octave exceeds the number of octaves" );
+			count[ o + 1 ]++;
+		}
+		for( size_t o = 0; o < n; o++ )
+			count[ o + 1 ] += count[ o ];
+
+		std::vector<size_t> order( nfeatures );
+		for( size_t i = 0; i < nfeatures; i++ ) {
+			size_t o = n == 1 ? 0 : features[ i ].octave;
+			order[ count[ o ]++ ] = i;
+		}
+
+		_features.reserve( first + nfeatures );
+		for( size_t i = 0; i < nfeatures; i++ )
+			_features.push_back( Descriptor( features[ i ] ) );
+
+		std::vector<Octave> octaves( n );
+		std::vector<bool> used( n, false );
+		for( size_t i = 0; i < nfeatures; i++ )
+			used[ n == 1 ? 0 : features[ i ].octave ] = true;
+
+		for( size_t o = 0; o < n; o++ ) {
+			if( !used[ o ] )
+				continue;
+			size_t stride;
+			octaves[ o ].base	= images[ o ]->map( &stride );
+			octaves[ o ].stride = integral ? stride / sizeof( float ) : stride;
+			octaves[ o ].scale	= Math::pow( scaleFactor, ( float ) o );
+			/* the integral image offsets address the upper left corner of the 5x5 box in front of the sample */
+			testOffsets( octaves[ o ].offsets, octaves[ o ].stride, integral ? -3 : 0 );
+		}
+
+		try {
+			ExtractBody body( &_features[ first ], &order[ 0 ], &octaves[ 0 ], n, integral );
+			if( nfeatures )
+				ParallelRows::run( body, 512, nfeatures );
+		} catch( ... ) {
+			for( size_t o = 0; o < n; o++ ) {
+				if( used[ o ] )
+					images[ o ]->unmap( octaves[ o ].base );
+			}
+			_features.resize( first, Descriptor( Feature() ) );
+			throw;
+		}
+
+		for( size_t o = 0; o < n; o++ ) {
+			if( used[ o ] )
+				images[ o ]->unmap( octaves[ o ].base );
+		}
+
+		_matrix.reserve( _matrix.size() + nfeatures );
+		for( size_t i = first; i < _features.size(); i++ )
+			_matrix.add( _features[ i ], _features[ i ].desc );
+	}
+
+	void ORB::testOffsets( std::vector<int>& offsets, size_t stride, int shift )
+	{
+		offsets.resize( 30 * 512 );
+		for( size_t bin = 0; bin < 30; bin++ ) {
+			for( size_t i = 0; i < 512; i++ )
+				offsets[ bin * 512 + i ] = ( _patterns[ bin ][ i ][ 1 ] + shift ) * ( int ) stride + _patterns[ bin ][ i ][ 0 ] + shift;
+		}
+	}
+
+	float ORB::centroidAngle( float mx, float my )
+	{
+		float angle = Math::atan2( my, mx );
+
+		if( angle < 0 )
+			angle += Math::TWO_PI;
+		angle = Math::TWO_PI - angle + Math::HALF_PI;
+
+		while( angle > Math::TWO_PI )
+			angle -= Math::TWO_PI;
+		return angle;
+	}
+
+	/* sum of the w x h box with the upper left corner right below and right of p */
+	static inline float _boxSum( const float* p, ssize_t w, ssize_t h )
+	{
+		return p[ h + w ] - p[ w ] - p[ h ] + p[ 0 ];
+	}
+
+	float ORB::centroidAngle( const float* p, size_t stride )
+	{
+		const ssize_t s = stride;
+		float mx = 0;
+		float my = 0;
+
+		for( int i = 0; i < 15; i++ ) {
+			ssize_t w = 2 * _circularoffset[ i ] + 1;
+			const float* top	= p + ( i - 16 ) * s - _circularoffset[ i ] - 1;
+			const float* bottom = p + ( 14 - i ) * s - _circularoffset[ i ] - 1;
+			mx += ( ( float ) i - 15.0f ) * ( _boxSum( top, w, s ) - _boxSum( bottom, w, s ) );
+		}
+
+		for( int i = 0; i < 15; i++ ) {
+			ssize_t h = ( 2 * _circularoffset[ i ] + 1 ) * s;
+			const float* left  = p - ( _circularoffset[ i ] + 1 ) * s + i - 16;
+			const float* right = p - ( _circularoffset[ i ] + 1 ) * s + 14 - i;
+			my += ( ( float ) i - 15.0f ) * ( _boxSum( left, 1, h ) - _boxSum( right, 1, h ) );
+		}
+
+		return centroidAngle( mx, my );
+	}
+
+	float ORB::centroidAngle( const uint8_t* p, size_t stride )
+	{
+		/* row dy covers the pixels dx in [ -16, 15 ], pixels outside of the circle are masked */
+		static const int16_t __attribute__( ( aligned( 16 ) ) ) weights[ 32 ] = {
+			-16, -15, -14, -13, -12, -11, -10, -9, -8, -7, -6, -5, -4, -3, -2, -1,
+			  0,   1,   2,   3,   4,   5,   6,  7,  8,  9, 10, 11, 12, 13, 14, 15
+		};
+		/* distance to the center column, compared with the half width of the row */
+		static const int8_t __attribute__( ( aligned( 16 ) ) ) dist[ 32 ] = {
+			16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,
+			 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15
+		};
+		const __m128i zero = _mm_setzero_si128();
+		__m128i m10 = zero;
+		int m01 = 0;
+
+		for( int dy = -15; dy <= 15; dy++ ) {
+			const int r = _circularoffset[ dy + 15 ];
+			const uint8_t* row = p + dy * ( ssize_t ) stride - 16;
+			const __m128i radius = _mm_set1_epi8( ( char ) ( r + 1 ) );
+			__m128i mask0 = _mm_cmpgt_epi8( radius, _mm_load_si128( ( const __m128i* ) dist ) );
+			__m128i mask1 = _mm_cmpgt_epi8( radius, _mm_load_si128( ( const __m128i* ) ( dist + 16 ) ) );
+			__m128i v0 = _mm_and_si128( _mm_loadu_si128( ( const __m128i* ) row ), mask0 );
+			__m128i v1 = _mm_and_si128( _mm_loadu_si128( ( const __m128i* ) ( row + 16 ) ), mask1 );
+
+			__m128i sum = _mm_add_epi64( _mm_sad_epu8( v0, zero ), _mm_sad_epu8( v1, zero ) );
+			m01 += dy * ( _mm_cvtsi128_si32( sum ) + _mm_extract_epi16( sum, 4 ) );
+
+			m10 = _mm_add_epi32( m10, _mm_madd_epi16( _mm_unpacklo_epi8( v0, zero ), _mm_load_si128( ( const __m128i* ) weights ) ) );
+			m10 = _mm_add_epi32( m10, _mm_madd_epi16( _mm_unpackhi_epi8( v0, zero ), _mm_load_si128( ( const __m128i* ) ( weights + 8 ) ) ) );
+			m10 = _mm_add_epi32( m10, _mm_madd_epi16( _mm_unpacklo_epi8( v1, zero ), _mm_load_si128( ( const __m128i* ) ( weights + 16 ) ) ) );
+			m10 = _mm_add_epi32( m10, _mm_madd_epi16( _mm_unpackhi_epi8( v1, zero ), _mm_load_si128( ( const __m128i* ) ( weights + 24 ) ) ) );
+		}
+
+		m10 = _mm_add_epi32( m10, _mm_srli_si128( m10, 8 ) );
+		m10 = _mm_add_epi32( m10, _mm_srli_si128( m10, 4 ) );
+
+		return centroidAngle( ( float ) m01, ( float ) _mm_cvtsi128_si32( m10 ) );
+	}
+
+	static inline size_t _angleBin( float angle )
+	{
+		size_t index = ( size_t ) ( angle * 30.0f / Math::TWO_PI );
+		if( index >= 30 )
+			index = 0;
+		return index;
+	}
+
+	void ORB::descriptor( Descriptor& feature, const float* p, size_t stride, const int* offsets )
+	{
+		const ssize_t s5 = 5 * stride;
+		const int* off = offsets + 512 * _angleBin( feature.angle );
+
+		/* gather the box sums of both samples of the 256 tests, then compare four tests at a time */
+		float __attribute__( ( aligned( 16 ) ) ) a[ 256 ];
+		float __attribute__( ( aligned( 16 ) ) ) b[ 256 ];
+		for( size_t i = 0; i < 256; i++ ) {
+			a[ i ] = _boxSum( p + off[ 2 * i ], 5, s5 );
+			b[ i ] = _boxSum( p + off[ 2 * i + 1 ], 5, s5 );
+		}
+
+		for( size_t i = 0; i < 32; i++ ) {
+			int lo = _mm_movemask_ps( _mm_cmplt_ps( _mm_load_ps( a + 8 * i ), _mm_load_ps( b + 8 * i ) ) );
+			int hi = _mm_movemask_ps( _mm_cmplt_ps( _mm_load_ps( a + 8 * i + 4 ), _mm_load_ps( b + 8 * i + 4 ) ) );
+			feature.desc[ i ] = ( uint8_t ) ( lo | ( hi << 4 ) );
+		}
+	}
+
+	void ORB::descriptor( Descriptor& feature, const uint8_t* p, const int* offsets )
+	{
+		const int* off = offsets + 512 * _angleBin( feature.angle );
+
+		uint8_t __attribute__( ( aligned( 16 ) ) ) a[ 256 ];
+		uint8_t __attribute__( ( aligned( 16 ) ) ) b[ 256 ];
+		for( size_t i = 0; i < 256; i++ ) {
+			a[ i ] = p[ off[ 2 * i ] ];
+			b[ i ] = p[ off[ 2 * i + 1 ] ];
+		}
+
+		/* a < b if the saturated b - a is not zero, sixteen tests at a time */
+		const __m128i zero = _mm_setzero_si128();
+		for( size_t i = 0; i < 16; i++ ) {
+			__m128i d = _mm_subs_epu8( _mm_load_si128( ( const __m128i* ) ( b + 16 * i ) ), _mm_load_si128( ( const __m128i* ) ( a + 16 * i ) ) );
+			int bits = ~_mm_movemask_epi8( _mm_cmpeq_epi8( d, zero ) );
+			feature.desc[ 2 * i ]	  = ( uint8_t ) bits;
+			feature.desc[ 2 * i + 1 ] = ( uint8_t ) ( bits >> 8 );
+		}
+	}
+
 }
@@ -33,6 +33,8 @@
 #include <cvt/vision/features/FeatureDescriptor.h>
 #include <cvt/vision/features/FeatureDescriptorExtractor.h>
 #include <cvt/vision/features/MatchBruteForce.h>
+#include <cvt/vision/features/DescriptorMatrix.h>
+#include <cvt/vision/features/HammingMatcher.h>
 
 namespace cvt {
 
@@ -54,6 +56,19 @@ namespace cvt {
 			void extract( const Image& img, const FeatureSet& features );
 			void extract( const ImagePyramid& pyr, const FeatureSet& features );
 
+			/* extract with the integral images of the octaves, e.g. kept from ImagePyramid::integralImage() */
+			void extractIntegral( const ImagePyramid& integralPyr, const FeatureSet& features );
+
+			/*
+			 * extract from GRAY_UINT8 octaves smoothed with a 5x5 box filter ( ImagePyramid::boxfilter( out, 2 ) ):
+			 * the tests compare the rounded box means instead of the box sums and the angle is the intensity
+			 * centroid of the smoothed patch, so the descriptors are not bit-identical to the ones of extract()
+			 */
+			void extractSmoothed( const ImagePyramid& smoothedPyr, const FeatureSet& features );
+
+			/* packed copy of the descriptors for the HammingMatcher, row i belongs to ( *this )[ i ] */
+			const DescriptorMatrix& descriptorMatrix() const;
+
 			void matchBruteForce( std::vector<FeatureMatch>& matches, const FeatureDescriptorExtractor& other, float distThresh ) const;
 
 			void matchInWindow( std::vector<MatchingIndices>& matches, const std::vector<FeatureDescriptor*>& other, float maxFeatureDist, float maxDescDistance ) const;
@@ -93,13 +108,28 @@ namespace cvt {
 				SIMD* _simd;
 			};
 
-			float centroidAngle( const Vector2f& pt, const IMapScoped<const float>& map );
-			void descriptor( Descriptor& feature, const Vector2f& pt, const IMapScoped<const float>& map );
+			struct Octave;
+			class ExtractBody;
+
+			void extractOctaves( const Image* const* octaves, size_t n, float scaleFactor, const FeatureSet& features, bool integral );
+			static void testOffsets( std::vector<int>& offsets, size_t stride, int shift );
+			static float centroidAngle( float mx, float my );
+			static float centroidAngle( const float* p, size_t stride );
+			static float centroidAngle( const uint8_t* p, size_t stride );
+			static void descriptor( Descriptor& feature, const float* p, size_t stride, const int* offsets );
+			static void descriptor( Descriptor& feature, const uint8_t* p, const int* offsets );
+
+			static void gatherDescriptors( DescriptorMatrix& dst, const std::vector<const FeatureDescriptor*>& descs );
+			template<typename SETA, typename SETB>
+			static void toFeatureMatches( std::vector<FeatureMatch>& matches, const std::vector<MatchingIndices>& indices, const SETA& seta, const SETB& setb );
+			static const Feature* featurePtr( const Descriptor& d ) { return &d; }
+			static const Feature* featurePtr( const FeatureDescriptor* d ) { return d; }
 
 			static const int		_patterns[ 30 ][ 512 ][ 2 ];
 			static const int		_circularoffset[ 31 ];
 
 			std::vector<Descriptor> _features;
+			DescriptorMatrix		_matrix;
 	};
 
 	inline ORB::ORB()
@@ -108,7 +138,8 @@ namespace cvt {
 
 	inline ORB::ORB( const ORB& orb ) :
 		FeatureDescriptorExtractor(),
-		_features( orb._features )
+		_features( orb._features ),
+		_matrix( orb._matrix )
 	{
 	}
 
@@ -125,6 +156,7 @@ namespace cvt {
 	{
 		ORB* ocopy = new ORB();
 		ocopy->_features = _features;
+		ocopy->_matrix = _matrix;
 		return ocopy;
 	}
 
@@ -141,123 +173,46 @@ namespace cvt {
 	inline void ORB::clear()
 	{
 		_features.clear();
+		_matrix.clear();
 	}
 
-	inline void ORB::extract( const ImagePyramid& pyr, const FeatureSet& features )
+	inline const DescriptorMatrix& ORB::descriptorMatrix() const
 	{
-		if( pyr[ 0 ].channels() != 1 ||
-			( pyr[ 0 ].format() != IFormat::GRAY_UINT8 && pyr[ 0 ].format() != IFormat::GRAY_FLOAT ) )
-			throw CVTException( "Unimplemented" );
-
-		ImagePyramid integralPyr( pyr.octaves(), pyr.scaleFactor() );
-		pyr.integralImage( integralPyr );
-
-		size_t octaves = pyr.octaves();
-		std::vector<IMapScoped<const float>*> maps;
-		std::vector<float> scales;
-		for( size_t i = 0; i < octaves; ++i ){
-			maps.push_back( new IMapScoped<const float>( integralPyr[ i ] ) );
-			scales.push_back( Math::pow( integralPyr.scaleFactor(), ( float )i ) );
-		}
-
-		size_t iend = features.size();
-		Vector2f vs;
-		for( size_t i = 0; i < iend; ++i ) {
-			_features.push_back( Descriptor( features[ i ] ) );
-			Descriptor& desc = _features.back();
-			size_t o = desc.octave;
-			vs = desc.pt * scales[ o ];
-
-			desc.angle = centroidAngle( vs, *maps[ o ] );
-			descriptor( desc, vs, *maps[ o ] );
-		}
-
-		for( size_t i = 0; i < octaves; ++i ){
-			delete maps[ i ];
-		}
-	}
-
-	inline void ORB::extract( const Image& img, const FeatureSet& features )
-	{
-		if( img.channels() != 1 ||
-			( img.format() != IFormat::GRAY_UINT8 && img.format() != IFormat::GRAY_FLOAT ) )
-			throw CVTException( "Unimplemented" );
-
-		IntegralImage iimage( img );
-		IMapScoped<const float> map( iimage.sumImage() );
-
-		size_t iend = features.size();
-		for( size_t i = 0; i < iend; ++i ) {
-			_features.push_back( Descriptor( features[ i ] ) );
-			Descriptor& desc = _features.back();
-			desc.angle = centroidAngle( desc.pt, map );
-			descriptor( desc, desc.pt, map );
-		}
+		return _matrix;
 	}
 
-	inline float ORB::centroidAngle( const Vector2f& pt, const IMapScoped<const float>& map )
+	inline void ORB::gatherDescriptors( DescriptorMatrix& dst, const std::vector<const FeatureDescriptor*>& descs )
 	{
-		float mx = 0;
-		float my = 0;
-		float angle = 0.0f;
-
-		int cury = ( int ) pt.y - 15;
-		int curx = ( int ) pt.x;
-
-		for( int i = 0; i < 15; i++ ) {
-			mx +=( ( float ) i - 15.0f ) * ( IntegralImage::area( map, curx - _circularoffset[ i ], cury + i, 2 * _circularoffset[ i ] + 1, 1 )
-										   - IntegralImage::area( map, curx - _circularoffset[ i ], cury + 30 - i, 2 * _circularoffset[ i ] + 1, 1) );
-		}
-
-		cury = ( int ) pt.y;
-		curx = ( int ) pt.x - 15;
-		for( int i = 0; i < 15; i++ ) {
-			my += ( ( float ) i - 15.0f ) * ( IntegralImage::area( map, curx + i, cury - _circularoffset[ i ], 1, 2 * _circularoffset[ i ] + 1 )
-											- IntegralImage::area( map, curx + 30 - i, cury - _circularoffset[ i ], 1, 2 * _circularoffset[ i ] + 1 ) );
+		dst.reserve( descs.size() );
+		for( size_t i = 0; i < descs.size(); i++ ) {
+			const Descriptor* d = ( const Descriptor* ) descs[ i ];
+			dst.add( *d, d->desc );
 		}
-
-		angle = Math::atan2( my, mx );
-
-		if( angle < 0 )
-			angle += Math::TWO_PI;
-		angle = Math::TWO_PI - angle + Math::HALF_PI;
-
-		while( angle > Math::TWO_PI )
-			angle -= Math::TWO_PI;
-		return angle;
 	}
 
-	inline void ORB::descriptor( Descriptor& feature, const Vector2f& pt, const IMapScoped<const float>& map )
+	template<typename SETA, typename SETB>
+	inline void ORB::toFeatureMatches( std::vector<FeatureMatch>& matches, const std::vector<MatchingIndices>& indices, const SETA& seta, const SETB& setb )
 	{
-		size_t index = ( size_t ) ( feature.angle * 30.0f / Math::TWO_PI );
-		if( index >= 30 )
-			index = 0;
-		int x = ( int ) pt.x;
-		int y = ( int ) pt.y;
-
-
-#define ORBTEST( n ) ( IntegralImage::area( map, x + _patterns[ index ][ ( n ) * 2 ][ 0 ] - 2,\
-										         y + _patterns[ index ][ ( n ) * 2 ][ 1 ] - 2, 5, 5 ) < \
-					   IntegralImage::area( map, x + _patterns[ index ][ ( n ) * 2 + 1 ][ 0 ] - 2,\
-										         y + _patterns[ index ][ ( n ) * 2 + 1 ][ 1 ] - 2, 5, 5 ) )
-		int idx;
-		for( int i = 0; i < 32; i++ ) {
-			idx = i << 3;
-			feature.desc[ i ]  =   ORBTEST( idx );
-			feature.desc[ i ] |= ( ORBTEST( idx + 1 ) ) << 1;
-			feature.desc[ i ] |= ( ORBTEST( idx + 2 ) ) << 2;
-			feature.desc[ i ] |= ( ORBTEST( idx + 3 ) ) << 3;
-			feature.desc[ i ] |= ( ORBTEST( idx + 4 ) ) << 4;
-			feature.desc[ i ] |= ( ORBTEST( idx + 5 ) ) << 5;
-			feature.desc[ i ] |= ( ORBTEST( idx + 6 ) ) << 6;
-			feature.desc[ i ] |= ( ORBTEST( idx + 7 ) ) << 7;
+		matches.reserve( matches.size() + indices.size() );
+		FeatureMatch m;
+		for( size_t i = 0; i < indices.size(); i++ ) {
+			m.feature0 = featurePtr( seta[ indices[ i ].srcIdx ] );
+			m.feature1 = featurePtr( setb[ indices[ i ].dstIdx ] );
+			m.distance = indices[ i ].distance;
+			matches.push_back( m );
 		}
 	}
 
 	inline void ORB::matchBruteForce( std::vector<FeatureMatch>& matches, const FeatureDescriptorExtractor& other, float distThresh ) const
 	{
-		DistFunc dfunc;
-		FeatureMatcher::matchBruteForce<Descriptor,DistFunc>( matches, this->_features, ( ( const ORB& ) other)._features, dfunc, distThresh );
+		const ORB& orb = ( const ORB& ) other;
+		std::vector<MatchingIndices> indices;
+
+		HammingMatcher matcher;
+		matcher.setMaxDistance( distThresh );
+		matcher.match( indices, _matrix, orb._matrix );
+
+		toFeatureMatches( matches, indices, _features, orb._features );
 	}
 
 	inline void ORB::matchInWindow( std::vector<MatchingIndices>& matches,
@@ -297,15 +252,15 @@ namespace cvt {
 									float maxDescDist,
 									float maxLineDist ) const
 	{
-		DistFunc dfunc;
-		FeatureMatcher::scanLineMatch( matches,
-									   left,
-									   _features,
-									   dfunc,
-									   minDisp,
-									   maxDisp,
-									   maxDescDist,
-									   maxLineDist );
+		DescriptorMatrix query;
+		gatherDescriptors( query, left );
+
+		std::vector<MatchingIndices> indices;
+		HammingMatcher matcher;
+		matcher.setMaxDistance( maxDescDist );
+		matcher.scanLineMatch( indices, query, _matrix, minDisp, maxDisp, maxLineDist );
+
+		toFeatureMatches( matches, indices, left, _features );
 	}
 
     inline void ORB::scanLineMatch( std::vector<FeatureMatch>& matches,
@@ -316,16 +271,15 @@ namespace cvt {
                                     float maxDescDist,
                                     float maxLineDist ) const
     {
-        DistFunc dfunc;
-        FeatureMatcher::scanLineMatch( matches,
-                                       rlt,
-                                       left,
-                                       _features,
-                                       dfunc,
-                                       minDisp,
-                                       maxDisp,
-                                       maxDescDist,
-                                       maxLineDist );
+        DescriptorMatrix query;
+        gatherDescriptors( query, left );
+
+        std::vector<MatchingIndices> indices;
+        HammingMatcher matcher;
+        matcher.setMaxDistance( maxDescDist );
+        matcher.scanLineMatch( indices, rlt, query, _matrix, minDisp, maxDisp, maxLineDist );
+
+        toFeatureMatches( matches, indices, left, _features );
     }
 }
 
@@ -0,0 +1,200 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/features/ORB.h>
+#include <cvt/vision/ImagePyramid.h>
+#include <cvt/gfx/IMapScoped.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+
+#include <stdlib.h>
+
+using namespace cvt;
+
+/* blocks of random intensity with noise */
+static void _testImage( Image& img, size_t w, size_t h )
+{
+	std::vector<int> buf( w * h, 128 );
+	for( size_t r = 0; r < 150; r++ ) {
+		int x0 = rand() % w, y0 = rand() % h;
+		int rw = rand() % 60 + 3, rh = rand() % 60 + 3;
+		int v = rand() % 256;
+		for( int y = y0; y < y0 + rh && y < ( int ) h; y++ ) {
+			for( int x = x0; x < x0 + rw && x < ( int ) w; x++ )
+				buf[ y * w + x ] = v;
+		}
+	}
+
+	img.reallocate( w, h, IFormat::GRAY_UINT8 );
+	IMapScoped<uint8_t> map( img );
+	for( size_t y = 0; y < h; y++ ) {
+		uint8_t* ptr = map.ptr();
+		for( size_t x = 0; x < w; x++ )
+			ptr[ x ] = ( uint8_t ) Math::clamp( buf[ y * w + x ] + rand() % 13 - 6, 0, 255 );
+		map++;
+	}
+}
+
+/* features away from the border of their octave, given in octave 0 coordinates */
+static void _testFeatures( FeatureSet& features, const ImagePyramid& pyr, size_t n )
+{
+	for( size_t i = 0; i < n; i++ ) {
+		size_t o = rand() % pyr.octaves();
+		float s = Math::pow( pyr.scaleFactor(), -( float ) o );
+		float x = 24 + rand() % ( pyr[ o ].width() - 48 );
+		float y = 24 + rand() % ( pyr[ o ].height() - 48 );
+		features.add( Feature( x * s, y * s, 0.0f, o, 0.0f ) );
+	}
+}
+
+/* orientation of the intensity centroid of the radius 15 disc */
+static float _referenceAngle( const IMapScoped<const uint8_t>& map, int x, int y )
+{
+	double m01 = 0, m10 = 0;
+	for( int dy = -15; dy <= 15; dy++ ) {
+		int r = ( int ) Math::sqrt( 15.5 * 15.5 - dy * dy );
+		for( int dx = -r; dx <= r; dx++ ) {
+			m01 += dy * map( x + dx, y + dy );
+			m10 += dx * map( x + dx, y + dy );
+		}
+	}
+
+	float angle = Math::TWO_PI - Math::atan2( m10, m01 ) + Math::HALF_PI;
+	while( angle > Math::TWO_PI )
+		angle -= Math::TWO_PI;
+	return angle;
+}
+
+static float _angleDistance( float a, float b )
+{
+	float d = Math::abs( a - b );
+	return Math::min( d, Math::TWO_PI - d );
+}
+
+static bool _sameDescriptors( const ORB& a, const ORB& b )
+{
+	if( a.size() != b.size() )
+		return false;
+	for( size_t i = 0; i < a.size(); i++ ) {
+		const ORB::Descriptor& da = ( const ORB::Descriptor& ) a[ i ];
+		const ORB::Descriptor& db = ( const ORB::Descriptor& ) b[ i ];
+		if( da.pt != db.pt || da.octave != db.octave || da.angle != db.angle || memcmp( da.desc, db.desc, 32 ) )
+			return false;
+		if( memcmp( a.descriptorMatrix().descriptor( i ), da.desc, 32 ) )
+			return false;
+	}
+	return true;
+}
+
+static bool _angleTest()
+{
+	/* small enough for the float integral image to hold exact sums */
+	Image img;
+	_testImage( img, 96, 96 );
+
+	FeatureSet features;
+	for( size_t i = 0; i < 200; i++ )
+		features.add( Feature( 24 + rand() % ( img.width() - 48 ), 24 + rand() % ( img.height() - 48 ) ) );
+
+	ORB orb;
+	orb.extract( img, features );
+
+	IMapScoped<const uint8_t> map( img );
+	bool result = orb.size() == features.size();
+	for( size_t i = 0; i < orb.size() && result; i++ )
+		result &= _angleDistance( orb[ i ].angle, _referenceAngle( map, orb[ i ].pt.x, orb[ i ].pt.y ) ) < 1e-3f;
+
+	CVTTEST_PRINT( "ORB centroid angle", result );
+	return result;
+}
+
+static bool _pyramidTest( const ImagePyramid& pyr, const FeatureSet& features )
+{
+	ORB orb;
+	orb.extract( pyr, features );
+
+	ImagePyramid integralPyr( pyr.octaves(), pyr.scaleFactor() );
+	pyr.integralImage( integralPyr );
+	ORB integral;
+	integral.extractIntegral( integralPyr, features );
+
+	ORB serial;
+	{
+		ParallelRows::ScopedNumThreads nt( 1 );
+		serial.extract( pyr, features );
+	}
+
+	bool result = orb.size() == features.size();
+	for( size_t i = 0; i < orb.size() && result; i++ )
+		result &= orb[ i ].pt == features[ i ].pt && orb[ i ].octave == features[ i ].octave;
+	result &= _sameDescriptors( orb, integral );
+	CVTTEST_PRINT( "ORB integral pyramid reuse", result );
+
+	bool b = _sameDescriptors( orb, serial );
+	CVTTEST_PRINT( "ORB threaded == serial", b );
+	return result && b;
+}
+
+static bool _smoothedTest( const ImagePyramid& pyr, const FeatureSet& features )
+{
+	ORB orb;
+	orb.extract( pyr, features );
+
+	ImagePyramid smoothed( pyr.octaves(), pyr.scaleFactor() );
+	pyr.boxfilter( smoothed, 2 );
+	ORB orbSmoothed;
+	orbSmoothed.extractSmoothed( smoothed, features );
+
+	bool result = orbSmoothed.size() == orb.size();
+	/* the box means are quantized, the descriptors have to stay much closer than unrelated ones */
+	size_t bits = 0;
+	float angle = 0;
+	for( size_t i = 0; i < orb.size() && result; i++ ) {
+		bits += SIMD::instance()->hammingDistance( ( ( const ORB::Descriptor& ) orb[ i ] ).desc, ( ( const ORB::Descriptor& ) orbSmoothed[ i ] ).desc, 32 );
+		angle += _angleDistance( orb[ i ].angle, orbSmoothed[ i ].angle );
+	}
+	result &= bits < 48 * orb.size() && angle < 0.2f * orb.size();
+
+	CVTTEST_PRINT( "ORB smoothed pyramid", result );
+	return result;
+}
+
+BEGIN_CVTTEST( ORB )
+	bool result = true;
+
+	srand( 1234 );
+	ImagePyramid pyr( 3, 0.5f );
+	_testImage( pyr[ 0 ], 640, 480 );
+	_testImage( pyr[ 1 ], 320, 240 );
+	_testImage( pyr[ 2 ], 160, 120 );
+
+	FeatureSet features;
+	_testFeatures( features, pyr, 1000 );
+
+	result &= _angleTest();
+	result &= _pyramidTest( pyr, features );
+	result &= _smoothedTest( pyr, features );
+
+	return result;
+END_CVTTEST
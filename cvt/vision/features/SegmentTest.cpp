@@ -0,0 +1,450 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/features/SegmentTest.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/ThreadPool.h>
+#include <cvt/util/Exception.h>
+#include <cvt/util/CPU.h>
+#include <cvt/math/Math.h>
+
+#include <emmintrin.h>
+
+namespace cvt {
+
+	/* circle pixels as x, y pairs in cyclic order, pixel i * size / 4 are the compass pixels */
+	static const int8_t _circle16[ 32 ] = {  0,  3,  1,  3,  2,  2,  3,  1,  3,  0,  3, -1,  2, -2,  1, -3,
+											 0, -3, -1, -3, -2, -2, -3, -1, -3,  0, -3,  1, -2,  2, -1,  3 };
+	static const int8_t _circle12d[ 24 ] = { -3,  0, -2, -1, -1, -2,  0, -3,  1, -2,  2, -1,
+											  3,  0,  2,  1,  1,  2,  0,  3, -1,  2, -2,  1 };
+	static const int8_t _circle12s[ 24 ] = { -2,  0, -2, -1, -1, -2,  0, -2,  1, -2,  2, -1,
+											  2,  0,  2,  1,  1,  2,  0,  2, -1,  2, -2,  1 };
+	static const int8_t _circle8[ 16 ]	 = { -1,  0, -1, -1,  0, -1,  1, -1,  1,  0,  1,  1,  0,  1, -1,  1 };
+
+	/* rows of at least this many pixels form a band of the pyramid detection */
+	static const size_t _bandPixels	  = 1 << 16;
+	static const size_t _minBandRows  = 16;
+
+	static inline bool _hasArc( uint32_t mask, size_t n, size_t arc )
+	{
+		uint32_t cyclic = mask | ( mask << n );
+		uint32_t runs = cyclic;
+		for( size_t k = 1; k < arc; k++ )
+			runs &= cyclic >> k;
+		return ( runs & ( ( 1u << n ) - 1 ) ) != 0;
+	}
+
+	/* maximum over all arcs of the minimum difference on the arc */
+	static inline uint8_t _arcScore( const uint8_t* diff, size_t n, size_t arc )
+	{
+		uint8_t best = 0;
+		for( size_t j = 0; j < n; j++ ) {
+			uint8_t m = diff[ j ];
+			for( size_t k = 1; k < arc && m > best; k++ )
+				m = Math::min( m, diff[ ( j + k ) % n ] );
+			best = Math::max( best, m );
+		}
+		return best;
+	}
+
+	static inline uint8_t _scorePixel( const uint8_t* p, const int* offsets, size_t n, size_t arc, uint8_t threshold )
+	{
+		uint8_t bright[ 16 ], dark[ 16 ];
+		uint32_t bmask = 0, dmask = 0;
+		const int c = *p;
+
+		for( size_t j = 0; j < n; j++ ) {
+			int q = p[ offsets[ j ] ];
+			bright[ j ] = q > c ? q - c : 0;
+			dark[ j ]	= q < c ? c - q : 0;
+			if( bright[ j ] > threshold )
+				bmask |= 1u << j;
+			if( dark[ j ] > threshold )
+				dmask |= 1u << j;
+		}
+
+		if( !_hasArc( bmask, n, arc ) && !_hasArc( dmask, n, arc ) )
+			return 0;
+		return Math::max( _arcScore( bright, n, arc ), _arcScore( dark, n, arc ) );
+	}
+
+	static void _scoreRowC( uint8_t* scores, const uint8_t* row, const int* offsets, size_t xstart, size_t xend,
+							size_t n, size_t arc, uint8_t threshold )
+	{
+		for( size_t x = xstart; x < xend; x++ )
+			scores[ x ] = _scorePixel( row + x, offsets, n, arc, threshold );
+	}
+
+	template<size_t N, size_t ARC>
+	static inline __m128i _arcScoreSSE2( __m128i* diff )
+	{
+		/* minimum over windows of length len by doubling, the final window is composed of two overlapping ones */
+		__m128i tmp[ N ];
+		size_t len = 1;
+		while( 2 * len <= ARC ) {
+			for( size_t j = 0; j < N; j++ )
+				tmp[ j ] = _mm_min_epu8( diff[ j ], diff[ ( j + len ) % N ] );
+			for( size_t j = 0; j < N; j++ )
+				diff[ j ] = tmp[ j ];
+			len *= 2;
+		}
+
+		__m128i s = _mm_setzero_si128();
+		for( size_t j = 0; j < N; j++ )
+			s = _mm_max_epu8( s, _mm_min_epu8( diff[ j ], diff[ ( j + ARC - len ) % N ] ) );
+		return s;
+	}
+
+	template<size_t N, size_t ARC>
+	static void _scoreRowSSE2( uint8_t* scores, const uint8_t* row, const int* offsets, size_t xstart, size_t xend,
+							   size_t n, size_t arc, uint8_t threshold )
+	{
+		if( xend - xstart < 16 ) {
+			_scoreRowC( scores, row, offsets, xstart, xend, n, arc, threshold );
+			return;
+		}
+
+		/* every arc covers at least K consecutive compass pixels */
+		const size_t K = ARC / ( N / 4 );
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i t = _mm_set1_epi8( ( char ) threshold );
+
+		size_t x = xstart;
+		for( ;; ) {
+			const uint8_t* p = row + x;
+			const __m128i c	 = _mm_loadu_si128( ( const __m128i* ) p );
+			const __m128i hi = _mm_adds_epu8( c, t );
+			const __m128i lo = _mm_subs_epu8( c, t );
+
+			/* set bytes mark compass pixels which are not brighter / not darker */
+			__m128i nb[ 4 ], nd[ 4 ];
+			for( size_t i = 0; i < 4; i++ ) {
+				__m128i q = _mm_loadu_si128( ( const __m128i* ) ( p + offsets[ i * N / 4 ] ) );
+				nb[ i ] = _mm_cmpeq_epi8( _mm_subs_epu8( q, hi ), zero );
+				nd[ i ] = _mm_cmpeq_epi8( _mm_subs_epu8( lo, q ), zero );
+			}
+
+			__m128i reject = _mm_cmpeq_epi8( zero, zero );
+			for( size_t i = 0; i < 4; i++ ) {
+				__m128i rb = nb[ i ], rd = nd[ i ];
+				for( size_t k = 1; k < K; k++ ) {
+					rb = _mm_or_si128( rb, nb[ ( i + k ) & 3 ] );
+					rd = _mm_or_si128( rd, nd[ ( i + k ) & 3 ] );
+				}
+				reject = _mm_and_si128( reject, _mm_and_si128( rb, rd ) );
+			}
+
+			if( _mm_movemask_epi8( reject ) == 0xffff ) {
+				_mm_storeu_si128( ( __m128i* ) ( scores + x ), zero );
+			} else {
+				__m128i bright[ N ], dark[ N ];
+				for( size_t j = 0; j < N; j++ ) {
+					__m128i q = _mm_loadu_si128( ( const __m128i* ) ( p + offsets[ j ] ) );
+					bright[ j ] = _mm_subs_epu8( q, c );
+					dark[ j ]	= _mm_subs_epu8( c, q );
+				}
+				__m128i s = _mm_max_epu8( _arcScoreSSE2<N, ARC>( bright ), _arcScoreSSE2<N, ARC>( dark ) );
+				/* only scores above the threshold are corners */
+				s = _mm_andnot_si128( _mm_cmpeq_epi8( _mm_subs_epu8( s, t ), zero ), s );
+				_mm_storeu_si128( ( __m128i* ) ( scores + x ), s );
+			}
+
+			if( x + 16 >= xend )
+				break;
+			/* the last block overlaps the previous one */
+			x = Math::min( x + 16, xend - 16 );
+		}
+	}
+
+	static inline void _addFeature( std::vector<Feature>& features, size_t x, size_t y, uint8_t s, float scale, size_t octave )
+	{
+		features.push_back( Feature( x * scale, y * scale, 0.0f, octave, s - 1 ) );
+	}
+
+	/* emit the corners of the score row cur, with prev and next a corner must not be smaller than its 8 neighbours */
+	static void _emitRow( std::vector<Feature>& features, const uint8_t* prev, const uint8_t* cur, const uint8_t* next,
+						  size_t xstart, size_t xend, size_t y, float scale, size_t octave, bool simd )
+	{
+		if( !simd ) {
+			for( size_t x = xstart; x < xend; x++ ) {
+				uint8_t s = cur[ x ];
+				if( !s )
+					continue;
+				if( prev && ( cur[ x - 1 ] > s || cur[ x + 1 ] > s ||
+							  prev[ x - 1 ] > s || prev[ x ] > s || prev[ x + 1 ] > s ||
+							  next[ x - 1 ] > s || next[ x ] > s || next[ x + 1 ] > s ) )
+					continue;
+				_addFeature( features, x, y, s, scale, octave );
+			}
+			return;
+		}
+
+		/* the score rows are zero padded by 16 bytes on both sides */
+		const __m128i zero = _mm_setzero_si128();
+		for( size_t x = xstart; x < xend; x += 16 ) {
+			__m128i s = _mm_loadu_si128( ( const __m128i* ) ( cur + x ) );
+			uint32_t mask = ~_mm_movemask_epi8( _mm_cmpeq_epi8( s, zero ) ) & 0xffff;
+			if( !mask )
+				continue;
+
+			if( prev ) {
+				__m128i m = _mm_max_epu8( _mm_loadu_si128( ( const __m128i* ) ( cur + x - 1 ) ),
+										  _mm_loadu_si128( ( const __m128i* ) ( cur + x + 1 ) ) );
+				m = _mm_max_epu8( m, _mm_loadu_si128( ( const __m128i* ) ( prev + x - 1 ) ) );
+				m = _mm_max_epu8( m, _mm_loadu_si128( ( const __m128i* ) ( prev + x ) ) );
+				m = _mm_max_epu8( m, _mm_loadu_si128( ( const __m128i* ) ( prev + x + 1 ) ) );
+				m = _mm_max_epu8( m, _mm_loadu_si128( ( const __m128i* ) ( next + x - 1 ) ) );
+				m = _mm_max_epu8( m, _mm_loadu_si128( ( const __m128i* ) ( next + x ) ) );
+				m = _mm_max_epu8( m, _mm_loadu_si128( ( const __m128i* ) ( next + x + 1 ) ) );
+				mask &= _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_subs_epu8( m, s ), zero ) );
+			}
+
+			while( mask ) {
+				size_t i = __builtin_ctz( mask );
+				_addFeature( features, x + i, y, cur[ x + i ], scale, octave );
+				mask &= mask - 1;
+			}
+		}
+	}
+
+	class SegmentTestBand : public ThreadPool::Task {
+		public:
+			SegmentTestBand() : _st( 0 ), _img( 0 ), _stride( 0 ), _width( 0 ), _height( 0 ), _ystart( 0 ), _yend( 0 ),
+				_threshold( 0 ), _border( 0 ), _nms( false ), _scale( 1.0f ), _octave( 0 )
+			{
+			}
+
+			void set( const SegmentTest* st, const uint8_t* img, size_t stride, size_t width, size_t height,
+					  size_t ystart, size_t yend, uint8_t threshold, size_t border, bool nms, float scale, size_t octave )
+			{
+				_st		   = st;
+				_img	   = img;
+				_stride	   = stride;
+				_width	   = width;
+				_height	   = height;
+				_ystart	   = ystart;
+				_yend	   = yend;
+				_threshold = threshold;
+				_border	   = border;
+				_nms	   = nms;
+				_scale	   = scale;
+				_octave	   = octave;
+			}
+
+			void execute()
+			{
+				_st->detectRows( features, _img, _stride, _width, _height, _ystart, _yend, _threshold, _border, _nms, _scale, _octave );
+			}
+
+			std::vector<Feature> features;
+
+		private:
+			const SegmentTest*	_st;
+			const uint8_t*		_img;
+			size_t				_stride;
+			size_t				_width;
+			size_t				_height;
+			size_t				_ystart;
+			size_t				_yend;
+			uint8_t				_threshold;
+			size_t				_border;
+			bool				_nms;
+			float				_scale;
+			size_t				_octave;
+	};
+
+	SegmentTest::SegmentTest( Pattern pattern, size_t arc ) :
+		_pattern( pattern ),
+		_arc( arc ),
+		_scoreRow( _scoreRowC ),
+		_simd( false )
+	{
+		switch( _pattern ) {
+			case CIRCLE_16:			_size = 16; _radius = 3; _circle = _circle16;  break;
+			case CIRCLE_12_DIAMOND: _size = 12; _radius = 3; _circle = _circle12d; break;
+			case CIRCLE_12_SQUARE:	_size = 12; _radius = 2; _circle = _circle12s; break;
+			case CIRCLE_8:			_size = 8;	_radius = 1; _circle = _circle8;   break;
+			default: throw CVTException( "Unknown segment test pattern" );
+		}
+
+		if( _arc <= _size / 2 || _arc > _size )
+			throw CVTException( "Invalid arc length for segment test pattern" );
+
+		if( !( cpuFeatures() & CPU_SSE2 ) )
+			return;
+
+		_simd = true;
+		if( _size == 16 && _arc == 9 )
+			_scoreRow = _scoreRowSSE2<16, 9>;
+		else if( _size == 16 && _arc == 10 )
+			_scoreRow = _scoreRowSSE2<16, 10>;
+		else if( _size == 16 && _arc == 11 )
+			_scoreRow = _scoreRowSSE2<16, 11>;
+		else if( _size == 16 && _arc == 12 )
+			_scoreRow = _scoreRowSSE2<16, 12>;
+		else if( _size == 12 && _arc == 7 )
+			_scoreRow = _scoreRowSSE2<12, 7>;
+		else if( _size == 8 && _arc == 5 )
+			_scoreRow = _scoreRowSSE2<8, 5>;
+	}
+
+	void SegmentTest::makeOffsets( int* offsets, size_t stride ) const
+	{
+		for( size_t i = 0; i < _size; i++ )
+			offsets[ i ] = _circle[ 2 * i ] + _circle[ 2 * i + 1 ] * ( int ) stride;
+	}
+
+	void SegmentTest::detectRows( std::vector<Feature>& features, const uint8_t* img, size_t stride, size_t width, size_t height,
+								  size_t ystart, size_t yend, uint8_t threshold, size_t border, bool nms,
+								  float scale, size_t octave ) const
+	{
+		border = Math::max( border, _radius );
+		if( width <= 2 * border || height <= 2 * border )
+			return;
+		ystart = Math::max( ystart, border );
+		yend   = Math::min( yend, height - border );
+		if( ystart >= yend )
+			return;
+
+		int offsets[ 16 ];
+		makeOffsets( offsets, stride );
+
+		const size_t xstart	 = border;
+		const size_t xend	 = width - border;
+		const size_t rowsize = width + 32;
+
+		/* one zero row and three score rows, each padded with zeros by 16 bytes on both sides */
+		std::vector<uint8_t> buffer( 4 * rowsize, 0 );
+		const uint8_t* zero = &buffer[ 16 ];
+		uint8_t* rows[ 3 ] = { &buffer[ rowsize + 16 ], &buffer[ 2 * rowsize + 16 ], &buffer[ 3 * rowsize + 16 ] };
+
+		if( !nms ) {
+			for( size_t y = ystart; y < yend; y++ ) {
+				_scoreRow( rows[ 0 ], img + y * stride, offsets, xstart, xend, _size, _arc, threshold );
+				_emitRow( features, NULL, rows[ 0 ], NULL, xstart, xend, y, scale, octave, _simd );
+			}
+			return;
+		}
+
+		/* rows outside of the border have no corners */
+		const uint8_t* prev = zero;
+		if( ystart > border ) {
+			_scoreRow( rows[ 0 ], img + ( ystart - 1 ) * stride, offsets, xstart, xend, _size, _arc, threshold );
+			prev = rows[ 0 ];
+		}
+		_scoreRow( rows[ 1 ], img + ystart * stride, offsets, xstart, xend, _size, _arc, threshold );
+		const uint8_t* cur = rows[ 1 ];
+
+		size_t slot = 2;
+		for( size_t y = ystart; y < yend; y++ ) {
+			const uint8_t* next = zero;
+			if( y + 1 < height - border ) {
+				_scoreRow( rows[ slot ], img + ( y + 1 ) * stride, offsets, xstart, xend, _size, _arc, threshold );
+				next = rows[ slot ];
+				slot = ( slot + 1 ) % 3;
+			}
+			_emitRow( features, prev, cur, next, xstart, xend, y, scale, octave, _simd );
+			prev = cur;
+			cur	 = next;
+		}
+	}
+
+	void SegmentTest::detect( FeatureSet& features, const Image& img, uint8_t threshold, size_t border, bool nms ) const
+	{
+		const Image* images[ 1 ] = { &img };
+		const float scales[ 1 ] = { 1.0f };
+		detectImages( features, images, scales, 1, threshold, border, nms );
+	}
+
+	void SegmentTest::detect( FeatureSet& features, const ImagePyramid& pyr, uint8_t threshold, size_t border, bool nms ) const
+	{
+		std::vector<const Image*> images( pyr.octaves() );
+		std::vector<float> scales( pyr.octaves() );
+		for( size_t o = 0; o < pyr.octaves(); o++ ) {
+			images[ o ] = &pyr[ o ];
+			scales[ o ] = Math::pow( pyr.scaleFactor(), -( float ) o );
+		}
+		if( images.size() )
+			detectImages( features, &images[ 0 ], &scales[ 0 ], images.size(), threshold, border, nms );
+	}
+
+	void SegmentTest::detectImages( FeatureSet& features, const Image* const* images, const float* scales, size_t n,
+									uint8_t threshold, size_t border, bool nms ) const
+	{
+		size_t pixels = 0;
+		for( size_t o = 0; o < n; o++ ) {
+			if( images[ o ]->format() != IFormat::GRAY_UINT8 )
+				throw CVTException( "Input Image format must be GRAY_UINT8" );
+			pixels += images[ o ]->width() * images[ o ]->height();
+		}
+
+		/* small inputs are processed as one band per octave on the calling thread */
+		const bool parallel = ParallelRows::numThreads() > 1 && pixels >= ParallelRows::pixelThreshold();
+
+		std::vector<const uint8_t*> ptrs( n );
+		std::vector<size_t> strides( n );
+		std::vector<size_t> bandRows( n );
+		size_t nbands = 0;
+		for( size_t o = 0; o < n; o++ ) {
+			size_t h = images[ o ]->height();
+			bandRows[ o ] = parallel ? Math::max( _minBandRows, _bandPixels / Math::max<size_t>( images[ o ]->width(), 1 ) ) : h;
+			nbands += h ? ( h + bandRows[ o ] - 1 ) / bandRows[ o ] : 0;
+			ptrs[ o ] = images[ o ]->map( &strides[ o ] );
+		}
+
+		std::vector<SegmentTestBand> bands( nbands );
+		std::vector<ThreadPool::Task*> tasks( nbands );
+		size_t b = 0;
+		for( size_t o = 0; o < n; o++ ) {
+			size_t w = images[ o ]->width();
+			size_t h = images[ o ]->height();
+			for( size_t y = 0; y < h; y += bandRows[ o ], b++ ) {
+				bands[ b ].set( this, ptrs[ o ], strides[ o ], w, h, y, Math::min( y + bandRows[ o ], h ), threshold, border, nms, scales[ o ], o );
+				tasks[ b ] = &bands[ b ];
+			}
+		}
+
+		try {
+			if( parallel && nbands > 1 ) {
+				ThreadPool::instance().run( &tasks[ 0 ], nbands );
+			} else {
+				for( size_t i = 0; i < nbands; i++ )
+					bands[ i ].execute();
+			}
+		} catch( ... ) {
+			for( size_t o = 0; o < n; o++ )
+				images[ o ]->unmap( ptrs[ o ] );
+			throw;
+		}
+
+		for( size_t o = 0; o < n; o++ )
+			images[ o ]->unmap( ptrs[ o ] );
+
+		for( size_t i = 0; i < nbands; i++ ) {
+			if( bands[ i ].features.size() )
+				features.add( &bands[ i ].features[ 0 ], bands[ i ].features.size() );
+		}
+	}
+
+}
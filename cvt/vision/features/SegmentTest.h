@@ -0,0 +1,97 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_SEGMENTTEST_H
+#define CVT_SEGMENTTEST_H
+
+#include <cvt/gfx/Image.h>
+#include <cvt/vision/ImagePyramid.h>
+#include <cvt/vision/features/FeatureSet.h>
+
+#include <vector>
+
+namespace cvt {
+
+	/**
+	 *	\class SegmentTest
+	 *	\brief Accelerated segment test corner detection ( FAST, AGAST ) on bands of image rows.
+	 *
+	 *	A pixel is a corner if arc contiguous pixels of the circle around it are all brighter than the
+	 *	center plus the threshold or all darker than the center minus the threshold. The score of a
+	 *	corner is the largest threshold for which it still is a corner, which is the value the bisection
+	 *	of the FAST and AGAST decision trees converges to.
+	 *
+	 *	With SSE2 the rows are processed in blocks of 16 pixels: the four compass pixels of the circle
+	 *	reject most blocks, the remaining ones compute segment test and score for all 16 pixels at once
+	 *	and the optional 3x3 non-maximum suppression runs on the score rows in the same pass.
+	 *	Images and all octaves of a pyramid are split into bands of rows which run on the ThreadPool, each
+	 *	band collects its features in its own buffer and the buffers are appended in raster order, so
+	 *	the result does not depend on the number of threads.
+	 */
+	class SegmentTest {
+		public:
+			enum Pattern {
+				CIRCLE_16,			/* Bresenham circle of radius 3 - FAST and OAST 9_16 */
+				CIRCLE_12_DIAMOND,	/* AGAST 7_12d */
+				CIRCLE_12_SQUARE,	/* AGAST 7_12s */
+				CIRCLE_8			/* AGAST 5_8 */
+			};
+
+			SegmentTest( Pattern pattern, size_t arc );
+
+			/* image must be GRAY_UINT8, border is raised to the radius of the pattern */
+			void	detect( FeatureSet& features, const Image& img, uint8_t threshold, size_t border, bool nms ) const;
+			void	detect( FeatureSet& features, const ImagePyramid& pyr, uint8_t threshold, size_t border, bool nms ) const;
+
+			/* append the corners of the rows [ ystart, yend ) to features, coordinates are multiplied by scale */
+			void	detectRows( std::vector<Feature>& features, const uint8_t* img, size_t stride, size_t width, size_t height,
+								size_t ystart, size_t yend, uint8_t threshold, size_t border, bool nms,
+								float scale = 1.0f, size_t octave = 0 ) const;
+
+			Pattern pattern() const { return _pattern; }
+			size_t	arc() const		{ return _arc; }
+			size_t	size() const	{ return _size; }
+			size_t	radius() const	{ return _radius; }
+
+		private:
+			/* raw scores of the pixels [ xstart, xend ) of the row: score + 1 for corners, 0 otherwise */
+			typedef void ( *ScoreRowFunc )( uint8_t* scores, const uint8_t* row, const int* offsets, size_t xstart, size_t xend,
+											size_t size, size_t arc, uint8_t threshold );
+
+			void	makeOffsets( int* offsets, size_t stride ) const;
+			void	detectImages( FeatureSet& features, const Image* const* images, const float* scales, size_t n,
+								  uint8_t threshold, size_t border, bool nms ) const;
+
+			Pattern			_pattern;
+			size_t			_arc;
+			size_t			_size;
+			size_t			_radius;
+			const int8_t*	_circle;
+			ScoreRowFunc	_scoreRow;
+			bool			_simd;
+	};
+
+}
+
+#endif
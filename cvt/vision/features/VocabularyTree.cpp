@@ -0,0 +1,570 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/features/VocabularyTree.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/Exception.h>
+#include <cvt/util/SIMD.h>
+#include <cvt/math/Math.h>
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+namespace cvt {
+
+	static const uint32_t VOCABULARY_NONE = ( uint32_t ) -1;
+	static const size_t	  VOCABULARY_MAX_BRANCHING = 256;
+	static const char	  VOCABULARY_MAGIC[ 4 ] = { 'C', 'V', 'O', 'C' };
+	static const uint32_t VOCABULARY_VERSION = 1;
+
+	static inline uint32_t _xorshift( uint32_t& state )
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	/* a node split at the current level, its training descriptors are order[ start ] ... order[ end - 1 ] */
+	struct VocabularyCluster {
+		uint32_t node;
+		uint32_t start;
+		uint32_t end;
+	};
+
+	/* k-means++ seeding: the first center is random, the next ones are drawn with probability ~ d^2 */
+	class VocabularySeedRows : public ParallelRows::Body {
+		public:
+			VocabularySeedRows( uint8_t* centers, const uint8_t* desc, const uint32_t* order, const VocabularyCluster* clusters, size_t k, uint32_t seed ) :
+				_centers( centers ), _desc( desc ), _order( order ), _clusters( clusters ), _k( k ), _seed( seed )
+			{
+			}
+
+			void process( size_t cstart, size_t cend ) const
+			{
+				SIMD* simd = SIMD::instance();
+				std::vector<uint32_t> mind;
+
+				for( size_t c = cstart; c < cend; c++ ) {
+					const VocabularyCluster& cluster = _clusters[ c ];
+					const uint32_t* order = _order + cluster.start;
+					size_t n = cluster.end - cluster.start;
+					uint8_t* centers = _centers + c * _k * 32;
+					/* the random sequence only depends on the node, not on the thread */
+					uint32_t state = ( _seed ^ ( cluster.node * 2654435761u ) ) | 1;
+
+					mind.assign( n, VOCABULARY_NONE );
+					size_t pick = _xorshift( state ) % n;
+					for( size_t j = 0; j < _k; j++ ) {
+						memcpy( centers + j * 32, _desc + order[ pick ] * 32, 32 );
+						if( j + 1 == _k )
+							break;
+
+						uint64_t sum = 0;
+						for( size_t i = 0; i < n; i++ ) {
+							uint32_t d = simd->hammingDistance( _desc + order[ i ] * 32, centers + j * 32, 32 );
+							mind[ i ] = Math::min( mind[ i ], d );
+							sum += mind[ i ] * mind[ i ];
+						}
+
+						if( !sum ) {
+							pick = _xorshift( state ) % n;
+							continue;
+						}
+						uint64_t r = ( ( ( uint64_t ) _xorshift( state ) << 32 ) | _xorshift( state ) ) % sum;
+						for( pick = 0; pick < n - 1; pick++ ) {
+							uint64_t w = mind[ pick ] * mind[ pick ];
+							if( r < w )
+								break;
+							r -= w;
+						}
+					}
+				}
+			}
+
+		private:
+			uint8_t*				 _centers;
+			const uint8_t*			 _desc;
+			const uint32_t*			 _order;
+			const VocabularyCluster* _clusters;
+			size_t					 _k;
+			uint32_t				 _seed;
+	};
+
+	/* nearest center of every descriptor of a split node */
+	class VocabularyAssignRows : public ParallelRows::Body {
+		public:
+			VocabularyAssignRows( uint32_t* assign, const uint8_t* centers, const uint8_t* desc, const uint32_t* order, const uint32_t* clusterOf, size_t k ) :
+				_assign( assign ), _centers( centers ), _desc( desc ), _order( order ), _clusterOf( clusterOf ), _k( k )
+			{
+			}
+
+			void process( size_t pstart, size_t pend ) const
+			{
+				SIMD* simd = SIMD::instance();
+				uint32_t dist[ VOCABULARY_MAX_BRANCHING ];
+
+				for( size_t p = pstart; p < pend; p++ ) {
+					if( _clusterOf[ p ] == VOCABULARY_NONE )
+						continue;
+					simd->hammingDistances( dist, _desc + _order[ p ] * 32, _centers + _clusterOf[ p ] * _k * 32, 32, _k, 32 );
+					_assign[ p ] = std::min_element( dist, dist + _k ) - dist;
+				}
+			}
+
+		private:
+			uint32_t*		_assign;
+			const uint8_t*	_centers;
+			const uint8_t*	_desc;
+			const uint32_t* _order;
+			const uint32_t* _clusterOf;
+			size_t			_k;
+	};
+
+	/* bitwise majority of the members of every center, the members of center u are order[ begin[ u ] ] ... order[ end[ u ] - 1 ] */
+	class VocabularyMajorityRows : public ParallelRows::Body {
+		public:
+			VocabularyMajorityRows( uint8_t* centers, const uint8_t* desc, const uint32_t* order, const uint32_t* begin, const uint32_t* end ) :
+				_centers( centers ), _desc( desc ), _order( order ), _begin( begin ), _end( end )
+			{
+			}
+
+			void process( size_t ustart, size_t uend ) const
+			{
+				uint32_t count[ 256 ];
+
+				for( size_t u = ustart; u < uend; u++ ) {
+					size_t n = _end[ u ] - _begin[ u ];
+					if( !n )
+						continue;
+
+					memset( count, 0, sizeof( count ) );
+					for( size_t i = _begin[ u ]; i < _end[ u ]; i++ ) {
+						const uint8_t* d = _desc + _order[ i ] * 32;
+						for( size_t b = 0; b < 256; b++ )
+							count[ b ] += ( d[ b >> 3 ] >> ( b & 0x07 ) ) & 1;
+					}
+
+					uint8_t* center = _centers + u * 32;
+					memset( center, 0, 32 );
+					for( size_t b = 0; b < 256; b++ ) {
+						if( 2 * count[ b ] > n )
+							center[ b >> 3 ] |= 1 << ( b & 0x07 );
+					}
+				}
+			}
+
+		private:
+			uint8_t*		_centers;
+			const uint8_t*	_desc;
+			const uint32_t* _order;
+			const uint32_t* _begin;
+			const uint32_t* _end;
+	};
+
+	class VocabularyTree::TransformRows : public ParallelRows::Body {
+		public:
+			TransformRows( uint32_t* words, uint32_t* nodes, const VocabularyTree& tree, const uint8_t* desc, size_t stride, size_t directLevel ) :
+				_words( words ), _nodes( nodes ), _tree( tree ), _desc( desc ), _stride( stride ), _directLevel( directLevel )
+			{
+			}
+
+			void process( size_t start, size_t end ) const
+			{
+				for( size_t i = start; i < end; i++ )
+					_words[ i ] = _tree.descend( _nodes[ i ], _desc + i * _stride, _directLevel );
+			}
+
+		private:
+			uint32_t*			  _words;
+			uint32_t*			  _nodes;
+			const VocabularyTree& _tree;
+			const uint8_t*		  _desc;
+			size_t				  _stride;
+			size_t				  _directLevel;
+	};
+
+	VocabularyTree::VocabularyTree() :
+		_branching( 0 ),
+		_levels( 0 )
+	{
+	}
+
+	void VocabularyTree::train( const std::vector<const DescriptorMatrix*>& images, size_t branching, size_t levels, size_t maxIterations, unsigned int seed )
+	{
+		if( branching < 2 || branching > VOCABULARY_MAX_BRANCHING || !levels )
+			throw CVTException( "Invalid vocabulary size" );
+
+		/* all training descriptors in one array */
+		size_t n = 0;
+		for( size_t i = 0; i < images.size(); i++ ) {
+			if( images[ i ]->descriptorBytes() != DESC_BYTES )
+				throw CVTException( "Descriptor sizes do not match" );
+			n += images[ i ]->size();
+		}
+		if( n < 2 || n >= VOCABULARY_NONE )
+			throw CVTException( "Invalid number of training descriptors" );
+
+		std::vector<uint8_t> desc( n * DESC_BYTES );
+		for( size_t i = 0, pos = 0; i < images.size(); i++ ) {
+			for( size_t j = 0; j < images[ i ]->size(); j++, pos++ )
+				memcpy( &desc[ pos * DESC_BYTES ], images[ i ]->descriptor( j ), DESC_BYTES );
+		}
+
+		maxIterations = Math::max<size_t>( maxIterations, 1 );
+		_branching = branching;
+		_levels = levels;
+		_nodes.clear();
+		_centers.clear();
+		_words.clear();
+
+		Node root = { 0, 0, 0, 0.0f };
+		_nodes.push_back( root );
+		_centers.resize( DESC_BYTES, 0 );
+
+		std::vector<uint32_t> order( n ), tmp( n ), assign( n ), next( n ), clusterOf( n );
+		for( size_t i = 0; i < n; i++ )
+			order[ i ] = i;
+
+		std::vector<VocabularyCluster> clusters( 1 );
+		clusters[ 0 ].node = 0;
+		clusters[ 0 ].start = 0;
+		clusters[ 0 ].end = n;
+
+		const size_t k = branching;
+		for( size_t level = 0; level < levels && clusters.size(); level++ ) {
+			/* nodes with more than k descriptors are clustered, the smaller ones get a child per descriptor */
+			std::vector<VocabularyCluster> split;
+			std::fill( clusterOf.begin(), clusterOf.end(), VOCABULARY_NONE );
+			for( size_t c = 0; c < clusters.size(); c++ ) {
+				if( clusters[ c ].end - clusters[ c ].start <= k )
+					continue;
+				for( size_t p = clusters[ c ].start; p < clusters[ c ].end; p++ )
+					clusterOf[ p ] = split.size();
+				split.push_back( clusters[ c ] );
+			}
+
+			std::vector<uint8_t> centers( split.size() * k * DESC_BYTES );
+			std::vector<uint32_t> begin( split.size() * k ), end( split.size() * k );
+			if( split.size() ) {
+				VocabularySeedRows seedRows( &centers[ 0 ], &desc[ 0 ], &order[ 0 ], &split[ 0 ], k, seed );
+				ParallelRows::run( seedRows, n / split.size(), split.size() );
+			}
+
+			std::fill( assign.begin(), assign.end(), VOCABULARY_NONE );
+			for( size_t iter = 0; iter < maxIterations && split.size(); iter++ ) {
+				VocabularyAssignRows assignRows( &next[ 0 ], &centers[ 0 ], &desc[ 0 ], &order[ 0 ], &clusterOf[ 0 ], k );
+				ParallelRows::run( assignRows, k, n );
+
+				size_t changes = 0;
+				for( size_t c = 0; c < split.size(); c++ ) {
+					for( size_t p = split[ c ].start; p < split[ c ].end; p++ )
+						changes += next[ p ] != assign[ p ];
+				}
+				assign.swap( next );
+
+				/* stable counting sort of the descriptors of every split node by their center */
+				for( size_t c = 0; c < split.size(); c++ ) {
+					uint32_t* b = &begin[ c * k ];
+					uint32_t* e = &end[ c * k ];
+					std::fill( e, e + k, 0 );
+					for( size_t p = split[ c ].start; p < split[ c ].end; p++ )
+						e[ assign[ p ] ]++;
+					for( size_t j = 0, sum = split[ c ].start; j < k; j++ ) {
+						b[ j ] = sum;
+						sum += e[ j ];
+						e[ j ] = b[ j ];
+					}
+					for( size_t p = split[ c ].start; p < split[ c ].end; p++ )
+						tmp[ e[ assign[ p ] ]++ ] = order[ p ];
+					for( size_t j = 0; j < k; j++ ) {
+						for( size_t p = b[ j ]; p < e[ j ]; p++ ) {
+							order[ p ] = tmp[ p ];
+							assign[ p ] = j;
+						}
+					}
+				}
+
+				if( !changes )
+					break;
+
+				VocabularyMajorityRows majorityRows( &centers[ 0 ], &desc[ 0 ], &order[ 0 ], &begin[ 0 ], &end[ 0 ] );
+				ParallelRows::run( majorityRows, n / ( split.size() * k ), split.size() * k );
+			}
+
+			/* add the non-empty clusters as children, the ones with more than one descriptor are split on the next level */
+			std::vector<VocabularyCluster> children;
+			size_t s = 0;
+			for( size_t c = 0; c < clusters.size(); c++ ) {
+				const VocabularyCluster& cluster = clusters[ c ];
+				_nodes[ cluster.node ].firstChild = _nodes.size();
+
+				if( s < split.size() && split[ s ].node == cluster.node ) {
+					for( size_t u = s * k; u < ( s + 1 ) * k; u++ ) {
+						if( begin[ u ] == end[ u ] )
+							continue;
+						VocabularyCluster child = { ( uint32_t ) _nodes.size(), begin[ u ], end[ u ] };
+						_nodes.push_back( root );
+						_centers.insert( _centers.end(), &centers[ u * DESC_BYTES ], &centers[ ( u + 1 ) * DESC_BYTES ] );
+						if( end[ u ] - begin[ u ] > 1 )
+							children.push_back( child );
+					}
+					s++;
+				} else {
+					for( size_t p = cluster.start; p < cluster.end; p++ ) {
+						_nodes.push_back( root );
+						_centers.insert( _centers.end(), &desc[ order[ p ] * DESC_BYTES ], &desc[ ( order[ p ] + 1 ) * DESC_BYTES ] );
+					}
+				}
+				_nodes[ cluster.node ].numChildren = _nodes.size() - _nodes[ cluster.node ].firstChild;
+			}
+			clusters.swap( children );
+		}
+
+		for( size_t i = 1; i < _nodes.size(); i++ ) {
+			if( !_nodes[ i ].numChildren ) {
+				_nodes[ i ].word = _words.size();
+				_words.push_back( i );
+			}
+		}
+
+		/* idf weights: log( #images / #images containing the word ) */
+		std::vector<uint32_t> words( n ), nodes( n ), docs( _words.size(), 0 );
+		TransformRows transformRows( &words[ 0 ], &nodes[ 0 ], *this, &desc[ 0 ], DESC_BYTES, 0 );
+		ParallelRows::run( transformRows, _levels * _branching, n );
+		for( size_t i = 0, pos = 0; i < images.size(); i++ ) {
+			std::vector<uint32_t>::iterator begin = words.begin() + pos;
+			std::vector<uint32_t>::iterator end = begin + images[ i ]->size();
+			std::sort( begin, end );
+			end = std::unique( begin, end );
+			for( ; begin != end; ++begin )
+				docs[ *begin ]++;
+			pos += images[ i ]->size();
+		}
+		for( size_t w = 0; w < _words.size(); w++ )
+			_nodes[ _words[ w ] ].weight = Math::log( ( float ) images.size() / ( float ) Math::max<uint32_t>( docs[ w ], 1 ) );
+	}
+
+	uint32_t VocabularyTree::descend( uint32_t& directNode, const uint8_t* desc, size_t directLevel ) const
+	{
+		if( _words.empty() )
+			throw CVTException( "Vocabulary is empty" );
+
+		SIMD* simd = SIMD::instance();
+		uint32_t dist[ VOCABULARY_MAX_BRANCHING ];
+		uint32_t node = 0;
+		size_t level = 0;
+
+		directNode = 0;
+		while( _nodes[ node ].numChildren ) {
+			const Node& n = _nodes[ node ];
+			simd->hammingDistances( dist, desc, &_centers[ n.firstChild * DESC_BYTES ], DESC_BYTES, n.numChildren, DESC_BYTES );
+			node = n.firstChild + ( std::min_element( dist, dist + n.numChildren ) - dist );
+			if( ++level <= directLevel )
+				directNode = node;
+		}
+		return _nodes[ node ].word;
+	}
+
+	void VocabularyTree::transform( BowVector& bow, FeatureVector* features, const DescriptorMatrix& descriptors, size_t directLevel ) const
+	{
+		bow.clear();
+		if( features )
+			features->clear();
+
+		size_t n = descriptors.size();
+		if( !n )
+			return;
+		if( descriptors.descriptorBytes() != DESC_BYTES )
+			throw CVTException( "Descriptor sizes do not match" );
+		if( _words.empty() )
+			throw CVTException( "Vocabulary is empty" );
+
+		std::vector<uint32_t> words( n ), nodes( n );
+		TransformRows transformRows( &words[ 0 ], &nodes[ 0 ], *this, descriptors.descriptors(), descriptors.stride(), directLevel );
+		ParallelRows::run( transformRows, _levels * _branching, n );
+
+		if( features ) {
+			std::vector<std::pair<uint32_t, uint32_t> > grouped( n );
+			for( size_t i = 0; i < n; i++ )
+				grouped[ i ] = std::make_pair( nodes[ i ], ( uint32_t ) i );
+			std::sort( grouped.begin(), grouped.end() );
+
+			features->features.resize( n );
+			for( size_t i = 0; i < n; i++ ) {
+				if( !i || grouped[ i ].first != grouped[ i - 1 ].first ) {
+					features->nodes.push_back( grouped[ i ].first );
+					features->offsets.push_back( i );
+				}
+				features->features[ i ] = grouped[ i ].second;
+			}
+			features->offsets.push_back( n );
+		}
+
+		/* term frequency times idf, normalized to unit L1 norm */
+		std::sort( words.begin(), words.end() );
+		float sum = 0.0f;
+		for( size_t i = 0; i < n; ) {
+			size_t j = i + 1;
+			while( j < n && words[ j ] == words[ i ] )
+				j++;
+			float value = weight( words[ i ] ) * ( float ) ( j - i );
+			if( value > 0.0f ) {
+				bow.words.push_back( words[ i ] );
+				bow.values.push_back( value );
+				sum += value;
+			}
+			i = j;
+		}
+		for( size_t i = 0; i < bow.values.size(); i++ )
+			bow.values[ i ] /= sum;
+	}
+
+	float VocabularyTree::score( const BowVector& a, const BowVector& b )
+	{
+		/* | a - b |_1 = 2 - sum over the common words of ( a + b - | a - b | ) */
+		float common = 0.0f;
+		size_t i = 0, j = 0;
+		while( i < a.words.size() && j < b.words.size() ) {
+			if( a.words[ i ] < b.words[ j ] ) {
+				i++;
+			} else if( b.words[ j ] < a.words[ i ] ) {
+				j++;
+			} else {
+				common += a.values[ i ] + b.values[ j ] - Math::abs( a.values[ i ] - b.values[ j ] );
+				i++;
+				j++;
+			}
+		}
+		return 0.5f * common;
+	}
+
+	void VocabularyTree::matchGuided( std::vector<MatchingIndices>& matches,
+									  const DescriptorMatrix& query, const FeatureVector& queryFeatures,
+									  const DescriptorMatrix& train, const FeatureVector& trainFeatures,
+									  float maxDistance, float ratio )
+	{
+		SIMD* simd = SIMD::instance();
+		size_t bytes = query.descriptorBytes();
+		if( bytes != train.descriptorBytes() )
+			throw CVTException( "Descriptor sizes do not match" );
+
+		size_t i = 0, j = 0;
+		while( i < queryFeatures.nodes.size() && j < trainFeatures.nodes.size() ) {
+			if( queryFeatures.nodes[ i ] < trainFeatures.nodes[ j ] ) {
+				i++;
+				continue;
+			}
+			if( trainFeatures.nodes[ j ] < queryFeatures.nodes[ i ] ) {
+				j++;
+				continue;
+			}
+
+			for( size_t qi = queryFeatures.offsets[ i ]; qi < queryFeatures.offsets[ i + 1 ]; qi++ ) {
+				uint32_t q = queryFeatures.features[ qi ];
+				MatchingIndices best = { q, 0, Math::MAXF };
+				float second = Math::MAXF;
+				for( size_t ti = trainFeatures.offsets[ j ]; ti < trainFeatures.offsets[ j + 1 ]; ti++ ) {
+					uint32_t t = trainFeatures.features[ ti ];
+					float d = ( float ) simd->hammingDistance( query.descriptor( q ), train.descriptor( t ), bytes );
+					if( d < best.distance ) {
+						second = best.distance;
+						best.dstIdx = t;
+						best.distance = d;
+					} else if( d < second ) {
+						second = d;
+					}
+				}
+				if( best.distance < maxDistance && ( ratio >= 1.0f || best.distance < ratio * second ) )
+					matches.push_back( best );
+			}
+			i++;
+			j++;
+		}
+	}
+
+	void VocabularyTree::save( const String& path ) const
+	{
+		FILE* f = fopen( path.c_str(), "wb" );
+		if( !f )
+			throw CVTException( "Could not open vocabulary file for writing" );
+
+		uint32_t header[ 4 ] = { VOCABULARY_VERSION, ( uint32_t ) _branching, ( uint32_t ) _levels, ( uint32_t ) _nodes.size() };
+		bool ok = fwrite( VOCABULARY_MAGIC, 1, 4, f ) == 4 &&
+				  fwrite( header, sizeof( uint32_t ), 4, f ) == 4;
+		if( ok && _nodes.size() ) {
+			ok = fwrite( &_nodes[ 0 ], sizeof( Node ), _nodes.size(), f ) == _nodes.size() &&
+				 fwrite( &_centers[ 0 ], DESC_BYTES, _nodes.size(), f ) == _nodes.size();
+		}
+		fclose( f );
+
+		if( !ok )
+			throw CVTException( "Could not write vocabulary file" );
+	}
+
+	void VocabularyTree::load( const String& path )
+	{
+		FILE* f = fopen( path.c_str(), "rb" );
+		if( !f )
+			throw CVTException( "Could not open vocabulary file" );
+
+		char magic[ 4 ];
+		uint32_t header[ 4 ];
+		std::vector<Node> nodes;
+		std::vector<uint8_t> centers;
+		bool ok = fread( magic, 1, 4, f ) == 4 && !memcmp( magic, VOCABULARY_MAGIC, 4 ) &&
+				  fread( header, sizeof( uint32_t ), 4, f ) == 4 && header[ 0 ] == VOCABULARY_VERSION &&
+				  header[ 1 ] <= VOCABULARY_MAX_BRANCHING;
+		if( ok && header[ 3 ] ) {
+			nodes.resize( header[ 3 ] );
+			centers.resize( header[ 3 ] * DESC_BYTES );
+			ok = fread( &nodes[ 0 ], sizeof( Node ), nodes.size(), f ) == nodes.size() &&
+				 fread( &centers[ 0 ], DESC_BYTES, nodes.size(), f ) == nodes.size() &&
+				 fgetc( f ) == EOF;
+		}
+		fclose( f );
+
+		/* the children have to be inside the tree and after their parent */
+		std::vector<uint32_t> words;
+		for( size_t i = 0; ok && i < nodes.size(); i++ ) {
+			if( nodes[ i ].numChildren ) {
+				ok = nodes[ i ].firstChild > i && nodes[ i ].numChildren <= header[ 1 ] &&
+					 ( size_t ) nodes[ i ].firstChild + nodes[ i ].numChildren <= nodes.size();
+			} else if( i ) {
+				ok = nodes[ i ].word == words.size();
+				words.push_back( i );
+			}
+		}
+		if( !ok )
+			throw CVTException( "Invalid vocabulary file" );
+
+		_branching = header[ 1 ];
+		_levels = header[ 2 ];
+		_nodes.swap( nodes );
+		_centers.swap( centers );
+		_words.swap( words );
+	}
+
+}
@@ -0,0 +1,151 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_VOCABULARYTREE_H
+#define CVT_VOCABULARYTREE_H
+
+#include <cvt/vision/features/DescriptorMatrix.h>
+#include <cvt/vision/features/FeatureMatch.h>
+#include <cvt/util/String.h>
+
+#include <vector>
+#include <stdint.h>
+
+namespace cvt {
+
+	/**
+	 *	\class VocabularyTree
+	 *	\brief Hierarchical k-majority vocabulary ( bag of binary words ) for 256 bit descriptors.
+	 *
+	 *	Every node of the tree splits its training descriptors into up to branching() clusters,
+	 *	the centers are the bitwise majority of their members. The leaves are the words, each one
+	 *	weighted with its inverse document frequency over the training images.
+	 *	An image is described by its L1 normalized tf-idf BowVector and, for guided matching,
+	 *	by a FeatureVector grouping its features by their ancestor node at a chosen level.
+	 */
+	class VocabularyTree {
+		public:
+			/* sparse tf-idf vector, sorted by word */
+			struct BowVector {
+				std::vector<uint32_t> words;
+				std::vector<float>	  values;
+
+				void   clear()		 { words.clear(); values.clear(); }
+				size_t size() const	 { return words.size(); }
+			};
+
+			/* direct index: the features of nodes[ i ] are features[ offsets[ i ] ] ... features[ offsets[ i + 1 ] - 1 ] */
+			struct FeatureVector {
+				std::vector<uint32_t> nodes;
+				std::vector<uint32_t> offsets;
+				std::vector<uint32_t> features;
+
+				void   clear()		 { nodes.clear(); offsets.clear(); features.clear(); }
+				size_t size() const	 { return nodes.size(); }
+			};
+
+			VocabularyTree();
+
+			/**
+			 *	\brief train the tree, the nodes of a level are clustered in parallel
+			 *	\param images	the descriptors of every training image, they define the idf weights
+			 */
+			void	train( const std::vector<const DescriptorMatrix*>& images, size_t branching, size_t levels, size_t maxIterations = 10, unsigned int seed = 1 );
+
+			size_t	branching() const	{ return _branching; }
+			size_t	levels() const		{ return _levels; }
+			size_t	numNodes() const	{ return _nodes.size(); }
+			size_t	numWords() const	{ return _words.size(); }
+			float	weight( uint32_t word ) const { return _nodes[ _words[ word ] ].weight; }
+
+			uint32_t word( const uint8_t* desc ) const;
+			/* the word and the node on its path at level directLevel ( 1 = children of the root ), or the word node if it is above */
+			uint32_t word( uint32_t& node, const uint8_t* desc, size_t directLevel ) const;
+
+			void	transform( BowVector& bow, const DescriptorMatrix& descriptors ) const;
+			void	transform( BowVector& bow, FeatureVector& features, const DescriptorMatrix& descriptors, size_t directLevel ) const;
+
+			/* 1 - | a - b |_1 / 2 of two L1 normalized vectors, 1 for identical and 0 for disjoint words */
+			static float score( const BowVector& a, const BowVector& b );
+
+			/**
+			 *	\brief match only features sharing their direct index node
+			 *
+			 *	Matches have distance < maxDistance and pass the ratio test best < ratio * secondBest
+			 *	within the node. srcIdx indexes the query and dstIdx the train descriptors.
+			 */
+			static void matchGuided( std::vector<MatchingIndices>& matches,
+									 const DescriptorMatrix& query, const FeatureVector& queryFeatures,
+									 const DescriptorMatrix& train, const FeatureVector& trainFeatures,
+									 float maxDistance, float ratio = 1.0f );
+
+			void	save( const String& path ) const;
+			void	load( const String& path );
+
+		private:
+			struct Node {
+				uint32_t firstChild;
+				uint32_t numChildren;
+				uint32_t word;
+				float	 weight;
+			};
+
+			class TransformRows;
+
+			void	 transform( BowVector& bow, FeatureVector* features, const DescriptorMatrix& descriptors, size_t directLevel ) const;
+			uint32_t descend( uint32_t& node, const uint8_t* desc, size_t directLevel ) const;
+
+			static const size_t DESC_BYTES = 32;
+
+			size_t				  _branching;
+			size_t				  _levels;
+			std::vector<Node>	  _nodes;	 /* the children of a node are stored consecutively, node 0 is the root */
+			std::vector<uint8_t>  _centers;	 /* DESC_BYTES per node */
+			std::vector<uint32_t> _words;	 /* node of every word */
+	};
+
+	inline uint32_t VocabularyTree::word( const uint8_t* desc ) const
+	{
+		uint32_t node;
+		return descend( node, desc, 0 );
+	}
+
+	inline uint32_t VocabularyTree::word( uint32_t& node, const uint8_t* desc, size_t directLevel ) const
+	{
+		return descend( node, desc, directLevel );
+	}
+
+	inline void VocabularyTree::transform( BowVector& bow, const DescriptorMatrix& descriptors ) const
+	{
+		transform( bow, NULL, descriptors, 0 );
+	}
+
+	inline void VocabularyTree::transform( BowVector& bow, FeatureVector& features, const DescriptorMatrix& descriptors, size_t directLevel ) const
+	{
+		transform( bow, &features, descriptors, directLevel );
+	}
+
+}
+
+#endif
@@ -0,0 +1,206 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/features/VocabularyTree.h>
+#include <cvt/vision/slam/KeyframeDatabase.h>
+#include <cvt/util/ParallelRows.h>
+#include <cvt/util/CVTTest.h>
+#include <cvt/util/Time.h>
+
+#include <iostream>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace cvt;
+
+static const size_t _numScenes = 40;
+static const size_t _numSceneFeatures = 150;
+
+/* the scenes are sets of random descriptors, a view keeps most of them with a few flipped bits */
+static void _makeScenes( std::vector<DescriptorMatrix>& scenes )
+{
+	scenes.resize( _numScenes );
+	uint8_t desc[ 32 ];
+	for( size_t s = 0; s < _numScenes; s++ ) {
+		for( size_t i = 0; i < _numSceneFeatures; i++ ) {
+			for( size_t b = 0; b < 32; b++ )
+				desc[ b ] = rand() & 0xff;
+			scenes[ s ].add( Feature(), desc );
+		}
+	}
+}
+
+static void _makeView( DescriptorMatrix& view, const DescriptorMatrix& scene )
+{
+	uint8_t desc[ 32 ];
+	view.clear();
+	for( size_t i = 0; i < scene.size(); i++ ) {
+		memcpy( desc, scene.descriptor( i ), 32 );
+		for( size_t k = 0; k < 8; k++ ) {
+			size_t b = rand() % 256;
+			desc[ b >> 3 ] ^= 1 << ( b & 0x07 );
+		}
+		view.add( Feature(), desc );
+	}
+}
+
+static bool _sameVocabulary( const VocabularyTree& a, const VocabularyTree& b, const std::vector<DescriptorMatrix>& scenes )
+{
+	if( a.numNodes() != b.numNodes() || a.numWords() != b.numWords() )
+		return false;
+	for( size_t w = 0; w < a.numWords(); w++ ) {
+		if( a.weight( w ) != b.weight( w ) )
+			return false;
+	}
+	for( size_t s = 0; s < scenes.size(); s++ ) {
+		for( size_t i = 0; i < scenes[ s ].size(); i++ ) {
+			if( a.word( scenes[ s ].descriptor( i ) ) != b.word( scenes[ s ].descriptor( i ) ) )
+				return false;
+		}
+	}
+	return true;
+}
+
+static bool _trainTest( VocabularyTree& voc, const std::vector<DescriptorMatrix>& scenes )
+{
+	std::vector<DescriptorMatrix> views( scenes.size() );
+	std::vector<const DescriptorMatrix*> images;
+	for( size_t s = 0; s < scenes.size(); s++ ) {
+		_makeView( views[ s ], scenes[ s ] );
+		images.push_back( &views[ s ] );
+	}
+
+	voc.train( images, 6, 3 );
+	bool result = voc.numWords() > 100 && voc.numWords() <= 6 * 6 * 6 && voc.branching() == 6 && voc.levels() == 3;
+
+	VocabularyTree serial;
+	{
+		ParallelRows::ScopedNumThreads nt( 1 );
+		serial.train( images, 6, 3 );
+	}
+	result &= _sameVocabulary( voc, serial, scenes );
+	CVTTEST_PRINT( "VocabularyTree train", result );
+
+	char path[] = "/tmp/cvt_vocabularyXXXXXX";
+	int fd = mkstemp( path );
+	close( fd );
+	VocabularyTree loaded;
+	voc.save( path );
+	loaded.load( path );
+	unlink( path );
+	bool b = _sameVocabulary( voc, loaded, scenes ) && loaded.branching() == 6 && loaded.levels() == 3;
+	CVTTEST_PRINT( "VocabularyTree save/load", b );
+
+	return result && b;
+}
+
+static bool _retrievalTest( const VocabularyTree& voc, const std::vector<DescriptorMatrix>& scenes )
+{
+	KeyframeDatabase db;
+	std::vector<DescriptorMatrix> keyframes( scenes.size() );
+	for( size_t s = 0; s < scenes.size(); s++ ) {
+		VocabularyTree::BowVector bow;
+		VocabularyTree::FeatureVector features;
+		_makeView( keyframes[ s ], scenes[ s ] );
+		voc.transform( bow, features, keyframes[ s ], 2 );
+		/* keyframe ids do not have to be consecutive */
+		db.add( 3 * s, bow, features );
+	}
+
+	bool result = db.size() == scenes.size();
+	size_t guided = 0, correct = 0;
+	DescriptorMatrix view;
+	std::vector<KeyframeDatabase::Result> results;
+	for( size_t s = 0; s < scenes.size(); s++ ) {
+		VocabularyTree::BowVector bow;
+		VocabularyTree::FeatureVector features;
+		_makeView( view, scenes[ s ] );
+		voc.transform( bow, features, view, 2 );
+
+		db.query( results, bow, 4 );
+		result &= results.size() == 4 && results[ 0 ].keyframeId == 3 * s && results[ 0 ].score > results[ 1 ].score;
+		result &= Math::abs( results[ 0 ].score - VocabularyTree::score( bow, db.bowVector( 3 * s ) ) ) < 1e-5f;
+
+		std::vector<MatchingIndices> matches;
+		VocabularyTree::matchGuided( matches, view, features, keyframes[ s ], db.featureVector( 3 * s ), 64.0f, 0.8f );
+		guided += matches.size();
+		for( size_t i = 0; i < matches.size(); i++ )
+			correct += matches[ i ].srcIdx == matches[ i ].dstIdx;
+	}
+	/* most features end up in the same node as their match */
+	result &= guided > scenes.size() * _numSceneFeatures / 2 && correct == guided;
+	CVTTEST_PRINT( "KeyframeDatabase query", result );
+
+	/* removing and replacing keyframes */
+	bool b = db.remove( 0 ) && !db.remove( 0 ) && !db.contains( 0 ) && db.size() == scenes.size() - 1;
+	VocabularyTree::BowVector bow;
+	voc.transform( bow, keyframes[ 0 ] );
+	db.query( results, bow, 1 );
+	b &= results.size() == 1 && results[ 0 ].keyframeId != 0;
+	db.add( 3, bow );
+	db.query( results, bow, 1 );
+	b &= db.size() == scenes.size() - 1 && results.size() == 1 && results[ 0 ].keyframeId == 3 && results[ 0 ].score > 0.999f;
+	CVTTEST_PRINT( "KeyframeDatabase remove/replace", b );
+
+	return result && b;
+}
+
+/* retrieval time for a large map: random word histograms of a 10^5 word vocabulary */
+static void _benchmark()
+{
+	const size_t numKeyframes = 20000, numWords = 100000, wordsPerFrame = 300;
+	KeyframeDatabase db;
+	VocabularyTree::BowVector bow;
+	for( size_t k = 0; k < numKeyframes; k++ ) {
+		std::vector<uint32_t> words( wordsPerFrame );
+		for( size_t i = 0; i < wordsPerFrame; i++ )
+			words[ i ] = ( uint32_t ) ( ( double ) rand() / RAND_MAX * ( double ) rand() / RAND_MAX * ( numWords - 1 ) );
+		std::sort( words.begin(), words.end() );
+		words.erase( std::unique( words.begin(), words.end() ), words.end() );
+		bow.words = words;
+		bow.values.assign( words.size(), 1.0f / words.size() );
+		db.add( k, bow );
+	}
+
+	std::vector<KeyframeDatabase::Result> results;
+	Time t;
+	for( size_t k = 0; k < 100; k++ )
+		db.query( results, db.bowVector( k * 97 ), 10 );
+	std::cout << "KeyframeDatabase query: " << t.elapsedMilliSeconds() / 100.0 << " ms ( " << numKeyframes << " keyframes )" << std::endl;
+}
+
+BEGIN_CVTTEST( VocabularyTree )
+	bool result = true;
+
+	srand( 2013 );
+	std::vector<DescriptorMatrix> scenes;
+	_makeScenes( scenes );
+
+	VocabularyTree voc;
+	result &= _trainTest( voc, scenes );
+	result &= _retrievalTest( voc, scenes );
+	_benchmark();
+
+	return result;
+END_CVTTEST
@@ -25,20 +25,36 @@
 #ifndef CVT_FERN_H
 #define CVT_FERN_H
 
-/* a fern is a set of pixel tests */
+#include <cvt/math/Math.h>
+#include <Eigen/Core>
+
+#include <vector>
+#include <utility>
+#include <fstream>
+
 namespace cvt {
+	/**
+	 *	\class Fern
+	 *	\brief A fern is a set of pixel tests, the test results index a table of class log-probabilities.
+	 *
+	 *	The table stores the quantized negative log-probabilities -log( p ) * LOG_SCALE as uint8_t,
+	 *	one row of classStride() entries per leaf. The rows are padded to a multiple of 16 classes,
+	 *	so that the scores of all classes can be accumulated with SIMD::AddU8_to_U16.
+	 */
 	class Fern
 	{
 		public:
-			Fern( uint32_t numTests, uint32_t patchSize ) : 
-				_regPrior( 1.0 ),
-					_patchSize( patchSize )
+			/* quantization steps per unit of -log( p ) */
+			static const uint32_t LOG_SCALE = 16;
+
+			Fern( uint32_t numTests, uint32_t patchSize ) :
+				_numProbs( 1 << numTests ),
+				_regPrior( 1.0f ),
+				_patchSize( patchSize ),
+				_numClasses( 0 ),
+				_classStride( 0 )
 			{					
 				_tests.reserve( numTests );
-				_numProbs = ( 1 << numTests );
-			
-				// one result per class
-				_probsForResult.resize( _numProbs );
 			}
 		
 			~Fern()
@@ -52,66 +68,58 @@ namespace cvt {
 			}
 		
 			/* imP must point to the top left corner of the patch */
-			uint32_t test( const uint8_t * imP, size_t stride )
+			uint32_t test( const uint8_t * imP, size_t stride ) const
 			{										
 				uint32_t idx = 0;
 				for( size_t i = 0; i < _tests.size(); i++ ){						
-					Eigen::Vector2i & x0 = _tests[ i ].first;
-					Eigen::Vector2i & x1 = _tests[ i ].second;
+					const Eigen::Vector2i & x0 = _tests[ i ].first;
+					const Eigen::Vector2i & x1 = _tests[ i ].second;
 				
-					if( imP[ x0[ 1 ] * stride + x0[ 0 ] ] < imP[ x1[ 1 ] * stride + x1[ 0 ] ] )
-						idx++;
 					idx <<= 1;
+					if( imP[ x0[ 1 ] * stride + x0[ 0 ] ] < imP[ x1[ 1 ] * stride + x1[ 0 ] ] )
+						idx |= 1;
 				}
-				idx >>= 1;
-			
 				return idx;
 			}
-	
-			void normalizeStatistics( uint32_t numSamples )
+
+			uint32_t numLeaves() const { return _numProbs; }
+			size_t	 numClasses() const { return _numClasses; }
+			size_t	 classStride() const { return _classStride; }
+
+			/* allocate the table, all entries are set to the maximum cost */
+			void allocate( size_t numClasses )
 			{
-				// for each possible testResult
-				for( size_t t = 0; t < _probsForResult.size(); t++ ){					
-					// for each class
-					for( size_t c = 0; c < _probsForResult[ t ].size(); c++ ){
-						_probsForResult[ t ][ c ] = log( ( _probsForResult[ t ][ c ] + _regPrior ) / ( ( double )numSamples + _numProbs * _regPrior ) );
-					}
-				}		
+				_numClasses = numClasses;
+				_classStride = ( numClasses + 15 ) & ~( ( size_t ) 15 );
+				_table.assign( ( size_t ) _numProbs * _classStride, 0xff );
 			}
-		
-			/* update statistics for a class with a new patch information */
-			void trainClass( size_t idx, const uint8_t * p, size_t pStride )
-			{	
-				size_t classIndex = _probsForResult[ 0 ].size();
-			
-				if( classIndex <= idx ){
-					// it's a new class: initialize probabilities with 0.0
-					for( size_t i = 0; i < _probsForResult.size(); i++ ){
-						_probsForResult[ i ].push_back( 0.0 );
-					}					
-				}				
-						
-				uint32_t testResult;
-					
-				testResult = test( p, pStride );
-				_probsForResult[ testResult ][ idx ] += 1.0;
+
+			/* set the column of class c from the leaf histogram of numSamples training patches,
+			   different classes may be set concurrently */
+			void setClass( size_t c, const uint32_t * counts, uint32_t numSamples )
+			{
+				double norm = ( double ) numSamples + _numProbs * _regPrior;
+				for( uint32_t t = 0; t < _numProbs; t++ )
+					_table[ t * _classStride + c ] = quantize( Math::log( ( counts[ t ] + _regPrior ) / norm ) );
 			}
-		
-			const std::vector<double> & probsForResult( uint32_t result )
+
+			void setLogProbability( size_t t, size_t c, double logProb )
 			{
-				return _probsForResult[ result ];					
+				_table[ t * _classStride + c ] = quantize( logProb );
 			}
-				
-			void setProbabilityForTest( size_t p, size_t c, double prob )
+
+			double logProbability( size_t t, size_t c ) const
 			{
-				if( _probsForResult[ p ].size() <= c ){
-					_probsForResult[ p ].resize( c + 1 );
-				}
-								
-				_probsForResult[ p ][ c ] = prob;
+				return -( double ) _table[ t * _classStride + c ] / ( double ) LOG_SCALE;
+			}
+
+			/* quantized costs of all classes for test result t */
+			const uint8_t* scores( uint32_t t ) const
+			{
+				return &_table[ t * _classStride ];
 			}
 		
-			void serialize( std::ofstream & out )
+			void serialize( std::ofstream & out ) const
 			{
 				out << _numProbs << std::endl;
 				out << _regPrior << std::endl;
@@ -123,25 +131,37 @@ namespace cvt {
 						<< _tests[ t ].second.y() << std::endl;
 				}
 			
-				for( size_t i = 0; i <  _probsForResult.size(); i++ ){
-					for( size_t c = 0; c < _probsForResult[ i ].size(); c++ ){
-						out << _probsForResult[ i ][ c ] << " ";
+				for( size_t i = 0; i < _numProbs; i++ ){
+					for( size_t c = 0; c < _numClasses; c++ ){
+						out << logProbability( i, c ) << " ";
 					}
 					out << std::endl;
 				}
 			}
 		
 			private:				
+				static uint8_t quantize( double logProb )
+				{
+					double q = -logProb * ( double ) LOG_SCALE + 0.5;
+					if( q >= 255.0 )
+						return 255;
+					if( q <= 0.0 )
+						return 0;
+					return ( uint8_t ) q;
+				}
+
 				// tests in a fern: two points w.r.t. upper left corner of patch
 				typedef std::pair<Eigen::Vector2i, Eigen::Vector2i> PixelPair;
 				std::vector<PixelPair>	_tests;
 				uint32_t				_numProbs;
 				float					_regPrior;
 				uint32_t				_patchSize;
+				size_t					_numClasses;
+				size_t					_classStride;
 			
-				/* trained probabilities for each possible result and classes (2^S per class) */
-				std::vector< std::vector<double> > _probsForResult;			
+				/* quantized -log( p ) for each possible result ( rows ) and class ( columns ) */
+				std::vector<uint8_t>	_table;
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
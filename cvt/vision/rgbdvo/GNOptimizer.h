@@ -70,13 +70,10 @@ namespace cvt {
         result.iterations = 0;
         result.numPixels = 0;
 
-        std::vector<float> residuals;
-        typename CostFunction<Derived>::JacobianVectorType jacobians;
+        typename CostFunction<Derived>::ResidualVectorType& residuals = this->_residuals;
+        typename CostFunction<Derived>::JacobianVectorType& jacobians = this->_jacobians;
 
         while( result.iterations < this->_maxIter ){
-            residuals.clear();
-            jacobians.clear();
-
             // re-evaluate the cost function
             costFunc.evaluate( residuals, jacobians, octave );
 
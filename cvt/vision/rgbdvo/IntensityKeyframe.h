@@ -26,6 +26,7 @@
 #define CVT_INTENSITYKEYFRAME_H
 
 #include <cvt/vision/rgbdvo/RGBDKeyframe.h>
+#include <cvt/util/ParallelRows.h>
 
 namespace cvt {
 
@@ -56,13 +57,89 @@ namespace cvt {
                                     const ImagePyramid& pyrf,
                                     const Image& depth );
 
+            /**
+             * \brief linearize the reference points of octave at warp
+             *
+             * Projection, sampling, residuals and jacobians are computed tile by tile in a
+             * single pass, the tiles are distributed over the ThreadPool. Only the points
+             * that project into the image are returned.
+             */
             void recompute( std::vector<float>& residuals,
                             JacobianVec& jacobians,
                             const Warp& warp,
                             const IMapScoped<const float>& gray,
-                            const IMapScoped<const float>& depth,
                             size_t octave );
 
+        private:
+            class LinearizeTiles;
+
+            /* per point scratch of recompute, kept to avoid reallocations */
+            std::vector<Vector2f>   _warpedPts;
+            std::vector<float>      _interpolated;
+            std::vector<float>      _tileResiduals;
+            std::vector<size_t>     _bandValid;
+    };
+
+    template <class Warp>
+    class IntensityKeyframe<Warp>::LinearizeTiles : public ParallelRows::Body
+    {
+        public:
+            LinearizeTiles( IntensityKeyframe<Warp>& kf,
+                            const IntensityData<Warp>& data,
+                            const Warp& warp,
+                            const Matrix4f& projMat,
+                            const IMapScoped<const float>& gray,
+                            float* residuals,
+                            JacobianType* jacobians ) :
+                _kf( kf ),
+                _data( data ),
+                _warp( warp ),
+                _projMat( projMat ),
+                _gray( gray ),
+                _residuals( residuals ),
+                _jacobians( jacobians )
+            {
+            }
+
+            /* the valid points of a band are stored consecutively from the first point of the band */
+            void process( size_t tstart, size_t tend ) const
+            {
+                const size_t tileSize = IntensityData<Warp>::TileSize;
+                const size_t n = _data.size();
+                const size_t bandStart = tstart * tileSize;
+                size_t savePos = bandStart;
+                SIMD* simd = SIMD::instance();
+
+                for( size_t t = tstart; t < tend; t++ ){
+                    size_t start = t * tileSize;
+                    size_t m = Math::min( tileSize, n - start );
+                    Vector2f* warped = &_kf._warpedPts[ start ];
+                    float* interpolated = &_kf._interpolated[ start ];
+                    float* tileResiduals = &_kf._tileResiduals[ start ];
+
+                    // project the points:
+                    simd->projectPoints( warped, _projMat, _data.points() + start, m );
+
+                    // interpolate the pixel values
+                    simd->warpBilinear1f( interpolated, &warped->x, _gray.ptr(), _gray.stride(), _gray.width(), _gray.height(), -10.0f, m );
+
+                    // compute the residuals
+                    _warp.computeResiduals( tileResiduals, _data.pixels() + start, interpolated, m );
+
+                    savePos += _data.recomputeJacobians( _jacobians + savePos, _residuals + savePos, tileResiduals, warped, interpolated, start, m );
+                }
+
+                _kf._bandValid[ tstart ] = savePos - bandStart;
+            }
+
+        private:
+            IntensityKeyframe<Warp>&        _kf;
+            const IntensityData<Warp>&      _data;
+            const Warp&                     _warp;
+            const Matrix4f&                 _projMat;
+            const IMapScoped<const float>&  _gray;
+            float*                          _residuals;
+            JacobianType*                   _jacobians;
     };
 
     template <class Warp>
@@ -104,38 +181,43 @@ namespace cvt {
                                                     JacobianVec& jacobians,
                                                     const Warp &warp,
                                                     const IMapScoped<const float>& gray,
-                                                    const IMapScoped<const float>& /*depth*/,
                                                     size_t octave )
     {
-        SIMD* simd = SIMD::instance();
-        const size_t width = gray.width();
-        const size_t height = gray.height();
-        std::vector<Vector2f> warpedPts;
-        std::vector<float> interpolatedPixels;
-
         const IntensityData<Warp>* data = ( const IntensityData<Warp>* )this->dataForScale( octave );
+        const size_t tileSize = IntensityData<Warp>::TileSize;
         size_t n = data->size();
+        size_t numTiles = ( n + tileSize - 1 ) / tileSize;
 
         // construct the projection matrix
         Matrix4f projMat( data->intrinsics() );
         projMat *= warp.pose();
 
-        // resize the data storage
-        warpedPts.resize( n );
-        interpolatedPixels.resize( n );
+        // resize the data storage, only grows the capacity of the buffers
+        _warpedPts.resize( n );
+        _interpolated.resize( n );
+        _tileResiduals.resize( n );
+        _bandValid.assign( numTiles, 0 );
         residuals.resize( n );
         jacobians.resize( n );
-
-        // project the points:
-        simd->projectPoints( &warpedPts[ 0 ], projMat, data->points(), n );
-
-        // interpolate the pixel values
-        simd->warpBilinear1f( &interpolatedPixels[ 0 ], &warpedPts[ 0 ].x, gray.ptr(), gray.stride(), width, height, -10.0f, n );
-
-        // compute the residuals
-        warp.computeResiduals( &residuals[ 0 ], data->pixels(), &interpolatedPixels[ 0 ], n );
-
-        data->recomputeJacobians( jacobians, residuals, warpedPts, interpolatedPixels );
+        if( !n )
+            return;
+
+        // the work per point is a few times the work per pixel of an image operation
+        LinearizeTiles body( *this, *data, warp, projMat, gray, &residuals[ 0 ], &jacobians[ 0 ] );
+        ParallelRows::run( body, 4 * tileSize, numTiles );
+
+        // close the gaps between the bands
+        size_t savePos = _bandValid[ 0 ];
+        for( size_t t = 1; t < numTiles; t++ ){
+            size_t start = t * tileSize;
+            for( size_t i = 0; i < _bandValid[ t ]; i++ ){
+                residuals[ savePos ] = residuals[ start + i ];
+                jacobians[ savePos ] = jacobians[ start + i ];
+                ++savePos;
+            }
+        }
+        residuals.resize( savePos );
+        jacobians.resize( savePos );
     }
 
     template <class Warp>
@@ -94,10 +94,25 @@ namespace cvt {
                 _jacobians.reserve( size );
             }
 
-            virtual void recomputeJacobians( JacobianVec& jacobians,
-                                             std::vector<float>& residuals,
-                                             const std::vector<Vector2f>& warpedPts,
-                                             const std::vector<float>& interpolated ) const = 0;
+            /* number of points linearized at once, sized for the on-stack gradient samples */
+            static const size_t TileSize = 1024;
+
+            /**
+             * \brief compute the jacobians of the points [ start, start + n )
+             *
+             * The input arrays are relative to start. Points that were not sampled inside the
+             * image ( interpolated < 0 ) are dropped, the jacobians and residuals of the valid
+             * points are stored consecutively. Called concurrently for disjoint ranges.
+             *
+             * \return the number of valid points
+             */
+            virtual size_t recomputeJacobians( JacobianType* jacobians,
+                                               float* residuals,
+                                               const float* tileResiduals,
+                                               const Vector2f* warpedPts,
+                                               const float* interpolated,
+                                               size_t start,
+                                               size_t n ) const = 0;
 
             const float* pixels()    const { return &_pixelValues[ 0 ]; }
 
@@ -137,10 +152,10 @@ namespace cvt {
             }
 
 
-            static void interpolateGradients( std::vector<float>& result, const Image& gradImg, const std::vector<Vector2f>& positions, const SIMD* simd, float outOfBoundsVal = -20.0f )
+            static void interpolateGradients( float* result, const Image& gradImg, const Vector2f* positions, size_t n, const SIMD* simd, float outOfBoundsVal = -20.0f )
             {
                 IMapScoped<const float> map( gradImg );
-                simd->warpBilinear1f( &result[ 0 ], &positions[ 0 ].x, map.ptr(), map.stride(), gradImg.width(), gradImg.height(), outOfBoundsVal, positions.size() );
+                simd->warpBilinear1f( result, &positions[ 0 ].x, map.ptr(), map.stride(), gradImg.width(), gradImg.height(), outOfBoundsVal, n );
             }
 
             const JacobianVec& jacobians() const { return _jacobians; }
@@ -178,24 +193,25 @@ namespace cvt {
             IntensityDataInvComp(){}
 
 
-            void recomputeJacobians( JacobianVecType& jacobians,
-                                     std::vector<float>& residuals,
-                                     const std::vector<Vector2f>& /*warpedPts*/,
-                                     const std::vector<float>& interpolated ) const
+            size_t recomputeJacobians( JacobianType* jacobians,
+                                       float* residuals,
+                                       const float* tileResiduals,
+                                       const Vector2f* /*warpedPts*/,
+                                       const float* interpolated,
+                                       size_t start,
+                                       size_t n ) const
             {
-
-                const JacobianVecType& refJacs = this->jacobians();
+                const JacobianType* refJacs = &this->jacobians()[ start ];
                 size_t savePos = 0;
                 // sort out data which is out of image bounds:
-                for( size_t i = 0; i < this->size(); ++i ){
+                for( size_t i = 0; i < n; ++i ){
                     if( interpolated[ i ] >= 0.0f ){
                         jacobians[ savePos ] = refJacs[ i ];
-                        residuals[ savePos ] = residuals[ i ];
+                        residuals[ savePos ] = tileResiduals[ i ];
                         ++savePos;
                     }
                 }
-                residuals.erase( residuals.begin() + savePos, residuals.end() );
-                jacobians.erase( jacobians.begin() + savePos, jacobians.end() );
+                return savePos;
             }
 
             void updateOfflineData( const Matrix4f& world2Cam,
@@ -316,38 +332,43 @@ namespace cvt {
 
             const ScreenJacVec& screenJacobians() const { return _screenJacobians; }
 
-            virtual void recomputeJacobians( JacobianVecType& jacobians,
-                                             std::vector<float>& residuals,
-                                             const std::vector<Vector2f>& warpedPts,
-                                             const std::vector<float>& interpolated ) const
+            virtual size_t recomputeJacobians( JacobianType* jacobians,
+                                               float* residuals,
+                                               const float* tileResiduals,
+                                               const Vector2f* warpedPts,
+                                               const float* interpolated,
+                                               size_t start,
+                                               size_t n ) const
             {
-                size_t n = this->size();
-                std::vector<float> intGradX( n );
-                std::vector<float> intGradY( n );
-
-                // evaluate the gradients at the warped positions
+                float intGradX[ Base::TileSize ];
+                float intGradY[ Base::TileSize ];
                 SIMD* simd = SIMD::instance();
-                this->interpolateGradients( intGradX, _gradX, warpedPts, simd );
-                this->interpolateGradients( intGradY, _gradY, warpedPts, simd );
-
-                // sort out bad pixels (out of image)
-                const ScreenJacVec& sj = _screenJacobians;
+                const ScreenJacobianType* sj = &_screenJacobians[ start ];
                 GradientType grad;
                 size_t savePos = 0;
 
-                for( size_t i = 0; i < n; ++i ){
-                    if( interpolated[ i ] >= 0.0f ){
-                        grad.coeffRef( 0, 0 ) = intGradX[ i ];
-                        grad.coeffRef( 0, 1 ) = intGradY[ i ];
+                for( size_t t = 0; t < n; t += Base::TileSize ){
+                    size_t m = Math::min( n - t, Base::TileSize );
 
-                        // compute the Fwd jacobians
-                        Warp::computeJacobian( jacobians[ savePos ], sj[ i ], grad, interpolated[ i ] );
-                        residuals[ savePos ] = residuals[ i ];
-                        ++savePos;
+                    // evaluate the gradients at the warped positions
+                    this->interpolateGradients( intGradX, _gradX, warpedPts + t, m, simd );
+                    this->interpolateGradients( intGradY, _gradY, warpedPts + t, m, simd );
+
+                    // sort out bad pixels (out of image)
+                    for( size_t k = 0; k < m; ++k ){
+                        size_t i = t + k;
+                        if( interpolated[ i ] >= 0.0f ){
+                            grad.coeffRef( 0, 0 ) = intGradX[ k ];
+                            grad.coeffRef( 0, 1 ) = intGradY[ k ];
+
+                            // compute the Fwd jacobians
+                            Warp::computeJacobian( jacobians[ savePos ], sj[ i ], grad, interpolated[ i ] );
+                            residuals[ savePos ] = tileResiduals[ i ];
+                            ++savePos;
+                        }
                     }
                 }
-                residuals.erase( residuals.begin() + savePos, residuals.end() );
-                jacobians.erase( jacobians.begin() + savePos, jacobians.end() );
+                return savePos;
             }
 
 
@@ -494,38 +515,44 @@ namespace cvt {
                 _referenceGradients.erase( _referenceGradients.begin() + n, _referenceGradients.end() );
             }
 
-            void recomputeJacobians( JacobianVecType& jacobians,
-                                     std::vector<float>& residuals,
-                                     const std::vector<Vector2f>& warpedPts,
-                                     const std::vector<float>& interpolated ) const
+            size_t recomputeJacobians( JacobianType* jacobians,
+                                       float* residuals,
+                                       const float* tileResiduals,
+                                       const Vector2f* warpedPts,
+                                       const float* interpolated,
+                                       size_t start,
+                                       size_t n ) const
             {
-                size_t n = this->size();
-                std::vector<float> intGradX( n );
-                std::vector<float> intGradY( n );
-
-                // evaluate the gradients at the warped positions
+                float intGradX[ Base::TileSize ];
+                float intGradY[ Base::TileSize ];
                 SIMD* simd = SIMD::instance();
-                this->interpolateGradients( intGradX, this->_gradX, warpedPts, simd );
-                this->interpolateGradients( intGradY, this->_gradY, warpedPts, simd );
-
-                // sort out bad pixels (out of image)
-                const ScreenJacVec& sj = this->screenJacobians();
+                const ScreenJacobianType* sj = &this->screenJacobians()[ start ];
+                const GradientType* refGrad = &_referenceGradients[ start ];
                 GradientType grad;
                 size_t savePos = 0;
 
-                for( size_t i = 0; i < n; ++i ){
-                    if( interpolated[ i ] >= 0.0f ){
-                        grad.coeffRef( 0, 0 ) = 0.5 * ( intGradX[ i ] + _referenceGradients[ i ].coeffRef( 0, 0 ) );
-                        grad.coeffRef( 0, 1 ) = 0.5 * ( intGradY[ i ] + _referenceGradients[ i ].coeffRef( 0, 1 ) );
+                for( size_t t = 0; t < n; t += Base::TileSize ){
+                    size_t m = Math::min( n - t, Base::TileSize );
 
-                        // compute the ESM jacobians
-                        Warp::computeJacobian( jacobians[ savePos ], sj[ i ], grad, interpolated[ i ] );
-                        residuals[ savePos ] = residuals[ i ];
-                        ++savePos;
+                    // evaluate the gradients at the warped positions
+                    this->interpolateGradients( intGradX, this->_gradX, warpedPts + t, m, simd );
+                    this->interpolateGradients( intGradY, this->_gradY, warpedPts + t, m, simd );
+
+                    // sort out bad pixels (out of image)
+                    for( size_t k = 0; k < m; ++k ){
+                        size_t i = t + k;
+                        if( interpolated[ i ] >= 0.0f ){
+                            grad.coeffRef( 0, 0 ) = 0.5 * ( intGradX[ k ] + refGrad[ i ].coeffRef( 0, 0 ) );
+                            grad.coeffRef( 0, 1 ) = 0.5 * ( intGradY[ k ] + refGrad[ i ].coeffRef( 0, 1 ) );
+
+                            // compute the ESM jacobians
+                            Warp::computeJacobian( jacobians[ savePos ], sj[ i ], grad, interpolated[ i ] );
+                            residuals[ savePos ] = tileResiduals[ i ];
+                            ++savePos;
+                        }
                     }
                 }
-                residuals.erase( residuals.begin() + savePos, residuals.end() );
-                jacobians.erase( jacobians.begin() + savePos, jacobians.end() );
+                return savePos;
             }
 
             void updateOfflineData( const Matrix4f& pose,
@@ -71,8 +71,8 @@ namespace cvt {
 
         SIMD* simd = SIMD::instance();
 
-        std::vector<float> residuals;
-        typename CostFunction<Derived>::JacobianVectorType jacobians;
+        typename CostFunction<Derived>::ResidualVectorType& residuals = this->_residuals;
+        typename CostFunction<Derived>::JacobianVectorType& jacobians = this->_jacobians;
 
 
         // initial costs
@@ -122,9 +122,6 @@ namespace cvt {
             }
 
             result.iterations++;
-
-            residuals.clear();
-            jacobians.clear();
         }
     }
 
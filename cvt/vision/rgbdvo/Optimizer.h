@@ -92,6 +92,11 @@ namespace cvt {
 
             RobustEstimator<float>* _robustEstimator;
 
+            /* linearization of the current iteration, kept to avoid reallocations */
+            typename CostFuncType::ResidualVectorType   _residuals;
+            typename CostFuncType::JacobianVectorType   _jacobians;
+            SystemBuilder<HessianType, JacobianType>    _systemBuilder;
+
             float computeMedian( const float* residuals, size_t n ) const;
             float computeMAD( const float* residuals, size_t n, float median ) const;
             bool checkResult( const Result& res ) const;
@@ -209,7 +214,7 @@ namespace cvt {
 
         // this is an estimate for the standard deviation:
         _robustEstimator->setScale( 1.4826f * mad );
-        float costs = SystemBuilder::build( *_robustEstimator,
+        float costs = _systemBuilder.build( *_robustEstimator,
                                             hessian,
                                             deltaSum,
                                             jacobians,
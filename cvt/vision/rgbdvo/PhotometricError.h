@@ -218,39 +218,11 @@ namespace cvt {
                                                   JacobianVectorType& jacobians,
                                                   size_t scale )
     {
-        SIMD* simd = SIMD::instance();
-
         // retrieve corresponding scale space data
         IMapScoped<const float> gray( _grayPyr[ scale ] );
 
-        const IntensityData<Warp>* referenceData = ( const IntensityData<Warp>* )_reference.dataForScale( scale );
-
-        const size_t width = gray.width();
-        const size_t height = gray.height();
-
-        size_t n = referenceData->size();
-        std::vector<Vector2f> warpedPts( n );
-        std::vector<float> interpolatedPixels( n );
-        // resize the data storage
-        residuals.resize( n );
-        jacobians.resize( n );
-
-        // construct the projection matrix
-        Matrix4f projMat( referenceData->intrinsics() );
-
         // pose is already cam2World
-        projMat *= _warp.pose();
-
-        // project the points:
-        simd->projectPoints( &warpedPts[ 0 ], projMat, referenceData->points(), n );
-
-        // interpolate the pixel values
-        simd->warpBilinear1f( &interpolatedPixels[ 0 ], &warpedPts[ 0 ].x, gray.ptr(), gray.stride(), width, height, -10.0f, n );
-
-        // compute the residuals
-        _warp.computeResiduals( &residuals[ 0 ], referenceData->pixels(), &interpolatedPixels[ 0 ], n );
-
-        referenceData->recomputeJacobians( jacobians, residuals, warpedPts, interpolatedPixels );
+        _reference.recompute( residuals, jacobians, _warp, gray, scale );
     }
 
     template <class Warp>
@@ -72,7 +72,6 @@ namespace cvt
                                     JacobianVec& jacobians,
                                     const Warp& warp,
                                     const IMapScoped<const float>& gray,
-                                    const IMapScoped<const float>& depth,
                                     size_t octave ) = 0;
 
             const ReferencePoints*  dataForScale( size_t octave ){ return _referenceData[ octave ]; }
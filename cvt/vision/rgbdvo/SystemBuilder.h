@@ -25,8 +25,13 @@
 #ifndef CVT_SYSTEMBUILDER_H
 #define CVT_SYSTEMBUILDER_H
 
-#include <cvt/vision/RobustWeighting.h>
 #include <cvt/math/Math.h>
+#include <cvt/vision/RobustWeighting.h>
+#include <cvt/util/ParallelRows.h>
+
+#include <Eigen/StdVector>
+#include <vector>
+#include <algorithm>
 
 namespace cvt {
     template <class EigenMat>
@@ -43,35 +48,119 @@ namespace cvt {
         return false;
     }
 
+    template <class HessType, class JType>
     class SystemBuilder
     {
         public:
-            template <class HessType, class JType>
-            static float build( const RobustEstimator<float>& lossFunc,
+            /**
+             * \brief accumulate the robustly weighted normal equations H = J^T W J and b = J^T W r
+             *
+             * Large systems are split into bands of residuals, each band is summed into its own
+             * partial system on the ThreadPool and the partials are reduced in band order. The
+             * partials are kept between calls, one per thread.
+             *
+             * \return the mean squared residual
+             */
+            float build( const RobustEstimator<float>& lossFunc,
                          HessType& H,
                          JType& b,
                          const JType* jacobians,
                          const float* residuals,
                          size_t n )
             {
-                // standard: robust lossfunc
-                JType jtmp;
                 b.setZero();
                 H.setZero();
+                if( !n )
+                    return 0.0f;
 
-                float ssd = 0.0f;
-                for( size_t i = 0; i < n; ++i ){
-                    // compute the delta
-                    ssd += Math::sqr( residuals[ i ] );
+                /* ParallelRows uses at most one band per thread */
+                size_t numThreads = Math::max<size_t>( ParallelRows::numThreads(), 1 );
+                if( _partials.size() < numThreads )
+                    _partials.resize( numThreads );
 
-                    float weight = lossFunc.weight( residuals[ i ] );
-                    jtmp = weight * jacobians[ i ];
-                    H.noalias() += jtmp.transpose() * jacobians[ i ];
-                    b.noalias() += jtmp * residuals[ i ];
+                size_t rows = ( n + BandSize - 1 ) / BandSize;
+                Accumulate body( _partials, lossFunc, jacobians, residuals, n );
+                ParallelRows::run( body, BandSize * JType::SizeAtCompileTime, rows, numThreads );
 
-                }
+                float ssd = body.reduce( H, b );
                 return ssd / n;
             }
+
+        private:
+            /* number of residuals processed as one row of ParallelRows */
+            static const size_t BandSize = 64;
+
+            struct Partial {
+                EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+                size_t   start;
+                HessType H;
+                JType    b;
+                float    ssd;
+            };
+            typedef std::vector<Partial, Eigen::aligned_allocator<Partial> > PartialVector;
+
+            static bool startsBefore( const Partial& a, const Partial& b ) { return a.start < b.start; }
+
+            class Accumulate : public ParallelRows::Body
+            {
+                public:
+                    Accumulate( PartialVector& partials, const RobustEstimator<float>& lossFunc, const JType* jacobians, const float* residuals, size_t n ) :
+                        _partials( partials ),
+                        _numUsed( 0 ),
+                        _lossFunc( lossFunc ),
+                        _jacobians( jacobians ),
+                        _residuals( residuals ),
+                        _n( n )
+                    {
+                    }
+
+                    /* every band claims its own partial and records its start row */
+                    void process( size_t start, size_t end ) const
+                    {
+                        Partial& p = _partials[ __sync_fetch_and_add( &_numUsed, 1 ) ];
+                        p.start = start;
+                        p.H.setZero();
+                        p.b.setZero();
+                        p.ssd = 0.0f;
+
+                        size_t iend = Math::min( end * BandSize, _n );
+                        JType jtmp;
+                        for( size_t i = start * BandSize; i < iend; ++i ){
+                            // compute the delta
+                            p.ssd += Math::sqr( _residuals[ i ] );
+
+                            float weight = _lossFunc.weight( _residuals[ i ] );
+                            jtmp = weight * _jacobians[ i ];
+                            p.H.noalias() += jtmp.transpose() * _jacobians[ i ];
+                            p.b.noalias() += jtmp * _residuals[ i ];
+                        }
+                    }
+
+                    /* sum up the partial systems, the band order keeps the result deterministic */
+                    float reduce( HessType& H, JType& b ) const
+                    {
+                        std::sort( _partials.begin(), _partials.begin() + _numUsed, startsBefore );
+
+                        float ssd = 0.0f;
+                        for( size_t i = 0; i < _numUsed; i++ ){
+                            H.noalias() += _partials[ i ].H;
+                            b.noalias() += _partials[ i ].b;
+                            ssd += _partials[ i ].ssd;
+                        }
+                        return ssd;
+                    }
+
+                private:
+                    PartialVector&                  _partials;
+                    mutable size_t                  _numUsed;
+                    const RobustEstimator<float>&   _lossFunc;
+                    const JType*                    _jacobians;
+                    const float*                    _residuals;
+                    size_t                          _n;
+            };
+
+            PartialVector   _partials;
     };
 
 }
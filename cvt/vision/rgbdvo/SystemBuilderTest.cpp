@@ -0,0 +1,108 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+
+#include <cvt/util/CVTTest.h>
+
+#include <cvt/vision/rgbdvo/SystemBuilder.h>
+#include <cvt/util/ThreadPool.h>
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace cvt
+{
+    typedef Eigen::Matrix<float, 1, 6> SBJacType;
+    typedef Eigen::Matrix<float, 6, 6> SBHessType;
+    typedef std::vector<SBJacType, Eigen::aligned_allocator<SBJacType> > SBJacVector;
+
+    /* the serial accumulation of all residuals in order */
+    static float _sbReference( const RobustEstimator<float>& lossFunc, SBHessType& H, SBJacType& b,
+                               const SBJacVector& jacobians, const std::vector<float>& residuals )
+    {
+        float ssd = 0.0f;
+        SBJacType jtmp;
+        H.setZero();
+        b.setZero();
+        for( size_t i = 0; i < residuals.size(); ++i ){
+            ssd += Math::sqr( residuals[ i ] );
+            float weight = lossFunc.weight( residuals[ i ] );
+            jtmp = weight * jacobians[ i ];
+            H.noalias() += jtmp.transpose() * jacobians[ i ];
+            b.noalias() += jtmp * residuals[ i ];
+        }
+        return ssd / residuals.size();
+    }
+
+BEGIN_CVTTEST( RGBDSystemBuilder )
+
+bool result = true;
+bool b;
+
+/* enough residuals for several bands above the pixel threshold */
+const size_t n = 320 * 240;
+SBJacVector jacobians( n );
+std::vector<float> residuals( n );
+for( size_t i = 0; i < n; i++ ){
+    for( int k = 0; k < 6; k++ )
+        jacobians[ i ][ k ] = Math::rand( -1.0f, 1.0f );
+    residuals[ i ] = Math::rand( -0.5f, 0.5f );
+}
+
+Huber<float> huber;
+huber.setScale( 0.1f );
+
+SBHessType Href, H;
+SBJacType bref, bvec;
+float costsRef = _sbReference( huber, Href, bref, jacobians, residuals );
+
+SystemBuilder<SBHessType, SBJacType> builder;
+{
+    ParallelRows::ScopedNumThreads single( 1 );
+    float costs = builder.build( huber, H, bvec, &jacobians[ 0 ], &residuals[ 0 ], n );
+    b = costs == costsRef && H == Href && bvec == bref;
+}
+CVTTEST_PRINT( "single thread == serial", b );
+result &= b;
+
+size_t prevThreads = ThreadPool::instance().numThreads();
+ThreadPool::instance().setNumThreads( 4 );
+{
+    SBHessType H2;
+    SBJacType b2;
+    float costs = builder.build( huber, H, bvec, &jacobians[ 0 ], &residuals[ 0 ], n );
+    float costs2 = builder.build( huber, H2, b2, &jacobians[ 0 ], &residuals[ 0 ], n );
+    b = costs == costs2 && H == H2 && bvec == b2;
+    b &= Math::abs( costs - costsRef ) < 1e-4f * costsRef;
+    b &= ( H - Href ).norm() < 1e-4f * Href.norm() && ( bvec - bref ).norm() < 1e-4f * bref.norm();
+}
+ThreadPool::instance().setNumThreads( prevThreads );
+CVTTEST_PRINT( "threaded deterministic", b );
+result &= b;
+
+return result;
+
+END_CVTTEST
+
+}
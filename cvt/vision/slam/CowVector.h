@@ -0,0 +1,176 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_COWVECTOR_H
+#define CVT_COWVECTOR_H
+
+#include <Eigen/StdVector>
+#include <vector>
+
+namespace cvt
+{
+    /**
+     *	\brief	chunked vector with copy-on-write semantics
+     *
+     *	Elements are stored in reference counted chunks of CHUNKSIZE elements.
+     *	Copying the vector only copies the chunk pointers, a chunk is cloned the
+     *	first time it is accessed through a non-const method while shared.
+     *	Copies may be used from different threads: the reference counts are atomic
+     *	and a shared chunk is never modified. References returned by the
+     *	non-const accessors must not be kept across a copy of the vector.
+     *	The non-const accessors of a single vector are not thread-safe, even
+     *	for distinct elements: they may detach the same chunk.
+     */
+    template<typename T, size_t CHUNKSIZE = 64>
+    class CowVector
+    {
+        public:
+            CowVector();
+            CowVector( const CowVector& other );
+            ~CowVector();
+
+            CowVector& operator=( const CowVector& other );
+
+            size_t		size() const { return _size; }
+            bool		empty() const { return _size == 0; }
+
+            const T&	operator[]( size_t i ) const { return _chunks[ i / CHUNKSIZE ]->data[ i % CHUNKSIZE ]; }
+            T&			operator[]( size_t i )		 { return detach( i / CHUNKSIZE )->data[ i % CHUNKSIZE ]; }
+
+            void		push_back( const T& value );
+            void		resize( size_t n );
+            void		clear();
+
+        private:
+            struct Chunk {
+                Chunk() : refcnt( 1 ) { data.reserve( CHUNKSIZE ); }
+                Chunk( const Chunk& other ) : refcnt( 1 )
+                {
+                    data.reserve( CHUNKSIZE );
+                    data.insert( data.end(), other.data.begin(), other.data.end() );
+                }
+
+                int											refcnt;
+                std::vector<T, Eigen::aligned_allocator<T> > data;
+            };
+
+            Chunk*		detach( size_t c );
+            void		release( Chunk* chunk );
+
+            std::vector<Chunk*> _chunks;
+            size_t				_size;
+    };
+
+    template<typename T, size_t CHUNKSIZE>
+    inline CowVector<T, CHUNKSIZE>::CowVector() : _size( 0 )
+    {
+    }
+
+    template<typename T, size_t CHUNKSIZE>
+    inline CowVector<T, CHUNKSIZE>::CowVector( const CowVector& other ) :
+        _chunks( other._chunks ),
+        _size( other._size )
+    {
+        for( size_t i = 0; i < _chunks.size(); i++ )
+            __sync_add_and_fetch( &_chunks[ i ]->refcnt, 1 );
+    }
+
+    template<typename T, size_t CHUNKSIZE>
+    inline CowVector<T, CHUNKSIZE>::~CowVector()
+    {
+        clear();
+    }
+
+    template<typename T, size_t CHUNKSIZE>
+    inline CowVector<T, CHUNKSIZE>& CowVector<T, CHUNKSIZE>::operator=( const CowVector& other )
+    {
+        if( this == &other )
+            return *this;
+
+        for( size_t i = 0; i < other._chunks.size(); i++ )
+            __sync_add_and_fetch( &other._chunks[ i ]->refcnt, 1 );
+        clear();
+        _chunks = other._chunks;
+        _size = other._size;
+        return *this;
+    }
+
+    template<typename T, size_t CHUNKSIZE>
+    inline void CowVector<T, CHUNKSIZE>::push_back( const T& value )
+    {
+        if( _size == _chunks.size() * CHUNKSIZE )
+            _chunks.push_back( new Chunk() );
+        detach( _chunks.size() - 1 )->data.push_back( value );
+        _size++;
+    }
+
+    template<typename T, size_t CHUNKSIZE>
+    inline void CowVector<T, CHUNKSIZE>::resize( size_t n )
+    {
+        size_t nchunks = ( n + CHUNKSIZE - 1 ) / CHUNKSIZE;
+        while( _chunks.size() > nchunks ){
+            release( _chunks.back() );
+            _chunks.pop_back();
+        }
+        while( _chunks.size() < nchunks )
+            _chunks.push_back( new Chunk() );
+
+        for( size_t c = 0; c < nchunks; c++ ){
+            size_t len = c + 1 < nchunks ? CHUNKSIZE : n - c * CHUNKSIZE;
+            if( _chunks[ c ]->data.size() != len )
+                detach( c )->data.resize( len );
+        }
+        _size = n;
+    }
+
+    template<typename T, size_t CHUNKSIZE>
+    inline void CowVector<T, CHUNKSIZE>::clear()
+    {
+        for( size_t i = 0; i < _chunks.size(); i++ )
+            release( _chunks[ i ] );
+        _chunks.clear();
+        _size = 0;
+    }
+
+    template<typename T, size_t CHUNKSIZE>
+    inline typename CowVector<T, CHUNKSIZE>::Chunk* CowVector<T, CHUNKSIZE>::detach( size_t c )
+    {
+        Chunk* chunk = _chunks[ c ];
+        // the other owners only ever decrement the count, so seeing 1 means we own it
+        if( __sync_add_and_fetch( &chunk->refcnt, 0 ) != 1 ){
+            _chunks[ c ] = new Chunk( *chunk );
+            release( chunk );
+        }
+        return _chunks[ c ];
+    }
+
+    template<typename T, size_t CHUNKSIZE>
+    inline void CowVector<T, CHUNKSIZE>::release( Chunk* chunk )
+    {
+        if( __sync_sub_and_fetch( &chunk->refcnt, 1 ) == 0 )
+            delete chunk;
+    }
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/vision/slam/KeyframeDatabase.h>
+#include <cvt/math/Math.h>
+
+#include <algorithm>
+
+namespace cvt
+{
+	const uint32_t KeyframeDatabase::NO_SLOT;
+
+	struct KeyframeResultCmp {
+		bool operator()( const KeyframeDatabase::Result& a, const KeyframeDatabase::Result& b ) const
+		{
+			return a.score > b.score || ( a.score == b.score && a.keyframeId < b.keyframeId );
+		}
+	};
+
+	KeyframeDatabase::KeyframeDatabase() :
+		_freeIds( 0 )
+	{
+	}
+
+	void KeyframeDatabase::clear()
+	{
+		_inverted.clear();
+		_keyframes.clear();
+		_freeSlots.clear();
+		_slotOfId.clear();
+		_freeIds = 0;
+	}
+
+	void KeyframeDatabase::add( size_t keyframeId, const VocabularyTree::BowVector& bow, const VocabularyTree::FeatureVector& features )
+	{
+		remove( keyframeId );
+
+		uint32_t s;
+		if( _freeSlots.size() ) {
+			s = _freeSlots.back();
+			_freeSlots.pop_back();
+		} else {
+			s = _keyframes.size();
+			_keyframes.push_back( KeyframeEntry() );
+		}
+
+		KeyframeEntry& kf = _keyframes[ s ];
+		kf.id = keyframeId;
+		kf.bow = bow;
+		kf.features = features;
+
+		if( keyframeId >= _slotOfId.size() ) {
+			_freeIds += keyframeId - _slotOfId.size() + 1;
+			_slotOfId.resize( keyframeId + 1, NO_SLOT );
+		}
+		_slotOfId[ keyframeId ] = s;
+		_freeIds--;
+
+		if( bow.size() && bow.words.back() >= _inverted.size() )
+			_inverted.resize( bow.words.back() + 1 );
+		for( size_t i = 0; i < bow.size(); i++ ) {
+			Posting posting = { s, bow.values[ i ] };
+			_inverted[ bow.words[ i ] ].push_back( posting );
+		}
+	}
+
+	bool KeyframeDatabase::remove( size_t keyframeId )
+	{
+		if( !contains( keyframeId ) )
+			return false;
+
+		uint32_t s = _slotOfId[ keyframeId ];
+		KeyframeEntry& kf = _keyframes[ s ];
+		for( size_t i = 0; i < kf.bow.size(); i++ ) {
+			std::vector<Posting>& entries = _inverted[ kf.bow.words[ i ] ];
+			for( size_t j = 0; j < entries.size(); j++ ) {
+				if( entries[ j ].slot == s ) {
+					entries[ j ] = entries.back();
+					entries.pop_back();
+					break;
+				}
+			}
+		}
+		kf.bow.clear();
+		kf.features.clear();
+
+		_freeSlots.push_back( s );
+		_slotOfId[ keyframeId ] = NO_SLOT;
+		_freeIds++;
+		return true;
+	}
+
+	void KeyframeDatabase::query( std::vector<Result>& results, const VocabularyTree::BowVector& bow, size_t maxResults, float minScore ) const
+	{
+		results.clear();
+		if( !maxResults )
+			return;
+
+		/* the scores are accumulated in a hash table sized by the number of postings, never by the number of keyframes */
+		size_t numPostings = 0;
+		for( size_t i = 0; i < bow.size() && bow.words[ i ] < _inverted.size(); i++ )
+			numPostings += _inverted[ bow.words[ i ] ].size();
+		if( !numPostings )
+			return;
+
+		size_t capacity = 16;
+		while( capacity < 2 * numPostings )
+			capacity <<= 1;
+		const size_t mask = capacity - 1;
+		std::vector<uint32_t> slots( capacity, NO_SLOT );
+		std::vector<float> scores( capacity, 0.0f );
+		std::vector<uint32_t> touched;
+
+		/* accumulate a + b - | a - b | over the common words, see VocabularyTree::score */
+		for( size_t i = 0; i < bow.size(); i++ ) {
+			if( bow.words[ i ] >= _inverted.size() )
+				break;
+			const std::vector<Posting>& entries = _inverted[ bow.words[ i ] ];
+			const float q = bow.values[ i ];
+			for( size_t j = 0; j < entries.size(); j++ ) {
+				uint32_t s = entries[ j ].slot;
+				size_t h = ( s * 0x9e3779b1u ) & mask;
+				while( slots[ h ] != s && slots[ h ] != NO_SLOT )
+					h = ( h + 1 ) & mask;
+				if( slots[ h ] == NO_SLOT ) {
+					slots[ h ] = s;
+					touched.push_back( h );
+				}
+				scores[ h ] += q + entries[ j ].value - Math::abs( q - entries[ j ].value );
+			}
+		}
+
+		results.reserve( touched.size() );
+		for( size_t i = 0; i < touched.size(); i++ ) {
+			float score = 0.5f * scores[ touched[ i ] ];
+			if( score >= minScore && score > 0.0f ) {
+				Result r = { _keyframes[ slots[ touched[ i ] ] ].id, score };
+				results.push_back( r );
+			}
+		}
+
+		KeyframeResultCmp cmp;
+		if( results.size() > maxResults ) {
+			std::partial_sort( results.begin(), results.begin() + maxResults, results.end(), cmp );
+			results.resize( maxResults );
+		} else {
+			std::sort( results.begin(), results.end(), cmp );
+		}
+	}
+}
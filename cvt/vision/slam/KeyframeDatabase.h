@@ -0,0 +1,120 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_KEYFRAMEDATABASE_H
+#define CVT_KEYFRAMEDATABASE_H
+
+#include <cvt/vision/features/VocabularyTree.h>
+
+#include <vector>
+
+namespace cvt
+{
+	/**
+	 *	\class KeyframeDatabase
+	 *	\brief Inverted index from the words of a VocabularyTree to the keyframes containing them.
+	 *
+	 *	Queries only touch the keyframes sharing a word with the query, so the retrieval time
+	 *	depends on the number of common entries and not on the number of keyframes.
+	 *	The BowVector and the FeatureVector ( direct index ) of every keyframe are kept for
+	 *	guided matching with VocabularyTree::matchGuided.
+	 *	Queries may run concurrently, add/remove must not overlap with queries.
+	 */
+	class KeyframeDatabase
+	{
+		public:
+			struct Result {
+				size_t	keyframeId;
+				float	score;
+			};
+
+			KeyframeDatabase();
+
+			size_t	size() const { return _slotOfId.size() - _freeIds; }
+			bool	contains( size_t keyframeId ) const;
+			void	clear();
+
+			/* an existing entry of the keyframe is replaced */
+			void	add( size_t keyframeId, const VocabularyTree::BowVector& bow, const VocabularyTree::FeatureVector& features );
+			void	add( size_t keyframeId, const VocabularyTree::BowVector& bow );
+			bool	remove( size_t keyframeId );
+
+			const VocabularyTree::BowVector&	 bowVector( size_t keyframeId ) const;
+			const VocabularyTree::FeatureVector& featureVector( size_t keyframeId ) const;
+
+			/* the maxResults keyframes with the highest VocabularyTree::score >= minScore, best first */
+			void	query( std::vector<Result>& results, const VocabularyTree::BowVector& bow, size_t maxResults, float minScore = 0.0f ) const;
+
+		private:
+			struct Posting {
+				uint32_t slot;
+				float	 value;
+			};
+
+			struct KeyframeEntry {
+				size_t							id;
+				VocabularyTree::BowVector		bow;
+				VocabularyTree::FeatureVector	features;
+			};
+
+			size_t slot( size_t keyframeId ) const;
+
+			static const uint32_t NO_SLOT = ( uint32_t ) -1;
+
+			std::vector<std::vector<Posting> > _inverted;	/* postings of every word */
+			std::vector<KeyframeEntry>		 _keyframes;	/* slots, a free slot has an empty bow */
+			std::vector<uint32_t>			 _freeSlots;
+			std::vector<uint32_t>			 _slotOfId;
+			size_t							 _freeIds;		/* ids in _slotOfId without keyframe */
+	};
+
+	inline bool KeyframeDatabase::contains( size_t keyframeId ) const
+	{
+		return keyframeId < _slotOfId.size() && _slotOfId[ keyframeId ] != NO_SLOT;
+	}
+
+	inline void KeyframeDatabase::add( size_t keyframeId, const VocabularyTree::BowVector& bow )
+	{
+		add( keyframeId, bow, VocabularyTree::FeatureVector() );
+	}
+
+	inline const VocabularyTree::BowVector& KeyframeDatabase::bowVector( size_t keyframeId ) const
+	{
+		return _keyframes[ slot( keyframeId ) ].bow;
+	}
+
+	inline const VocabularyTree::FeatureVector& KeyframeDatabase::featureVector( size_t keyframeId ) const
+	{
+		return _keyframes[ slot( keyframeId ) ].features;
+	}
+
+	inline size_t KeyframeDatabase::slot( size_t keyframeId ) const
+	{
+		if( !contains( keyframeId ) )
+			throw CVTException( "keyframe for requested id does not exist" );
+		return _slotOfId[ keyframeId ];
+	}
+}
+
+#endif
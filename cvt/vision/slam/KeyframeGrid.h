@@ -0,0 +1,174 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#ifndef CVT_KEYFRAMEGRID_H
+#define CVT_KEYFRAMEGRID_H
+
+#include <cvt/math/Vector.h>
+#include <cvt/math/Math.h>
+
+#include <map>
+#include <vector>
+#include <algorithm>
+
+namespace cvt
+{
+    /**
+     *	\brief	uniform hash grid over keyframe camera centers
+     *
+     *	Radius queries only visit the cells overlapping the query sphere, so the
+     *	costs depend on the local keyframe density and not on the map size.
+     */
+    class KeyframeGrid
+    {
+        public:
+            KeyframeGrid( double cellSize = 1.0 );
+
+            void	clear();
+            void	setCellSize( double cellSize );
+            double	cellSize() const { return _cellSize; }
+            size_t	size() const { return _centers.size(); }
+
+            /* insert or move the keyframe with the given id */
+            void	set( size_t id, const Vector3d& center );
+
+            /* ids of the keyframes with center distance < radius to center, in ascending order */
+            void	query( std::vector<size_t>& ids, const Vector3d& center, double radius ) const;
+
+        private:
+            struct Cell {
+                Cell( int x, int y, int z ) : x( x ), y( y ), z( z ) {}
+
+                bool operator<( const Cell& other ) const
+                {
+                    if( x != other.x ) return x < other.x;
+                    if( y != other.y ) return y < other.y;
+                    return z < other.z;
+                }
+
+                int x, y, z;
+            };
+
+            typedef std::map<Cell, std::vector<size_t> > CellMap;
+
+            Cell	cellFor( const Vector3d& p ) const;
+            void	remove( size_t id );
+
+            /* smaller cells (e.g. of a zero query radius) are clamped, the cell coordinates have to fit into int */
+            static double minCellSize() { return 1e-3; }
+
+            double					_cellSize;
+            CellMap					_cells;
+            std::vector<Vector3d>	_centers;
+            std::vector<bool>		_valid;
+    };
+
+    inline KeyframeGrid::KeyframeGrid( double cellSize ) :
+        _cellSize( Math::max( cellSize, minCellSize() ) )
+    {
+    }
+
+    inline void KeyframeGrid::clear()
+    {
+        _cells.clear();
+        _centers.clear();
+        _valid.clear();
+    }
+
+    inline void KeyframeGrid::setCellSize( double cellSize )
+    {
+        cellSize = Math::max( cellSize, minCellSize() );
+        if( cellSize == _cellSize )
+            return;
+
+        _cellSize = cellSize;
+        _cells.clear();
+        for( size_t i = 0; i < _centers.size(); i++ ){
+            if( _valid[ i ] )
+                _cells[ cellFor( _centers[ i ] ) ].push_back( i );
+        }
+    }
+
+    inline KeyframeGrid::Cell KeyframeGrid::cellFor( const Vector3d& p ) const
+    {
+        return Cell( ( int )Math::floor( p.x / _cellSize ),
+                     ( int )Math::floor( p.y / _cellSize ),
+                     ( int )Math::floor( p.z / _cellSize ) );
+    }
+
+    inline void KeyframeGrid::remove( size_t id )
+    {
+        CellMap::iterator it = _cells.find( cellFor( _centers[ id ] ) );
+        if( it == _cells.end() )
+            return;
+        std::vector<size_t>& ids = it->second;
+        ids.erase( std::remove( ids.begin(), ids.end(), id ), ids.end() );
+        if( ids.empty() )
+            _cells.erase( it );
+    }
+
+    inline void KeyframeGrid::set( size_t id, const Vector3d& center )
+    {
+        if( id >= _centers.size() ){
+            _centers.resize( id + 1 );
+            _valid.resize( id + 1, false );
+        }
+
+        if( _valid[ id ] )
+            remove( id );
+
+        _centers[ id ] = center;
+        _valid[ id ] = true;
+        _cells[ cellFor( center ) ].push_back( id );
+    }
+
+    inline void KeyframeGrid::query( std::vector<size_t>& ids, const Vector3d& center, double radius ) const
+    {
+        ids.clear();
+        Vector3d r( radius, radius, radius );
+        Cell lo = cellFor( center - r );
+        Cell hi = cellFor( center + r );
+        double r2 = radius * radius;
+
+        for( int x = lo.x; x <= hi.x; x++ ){
+            for( int y = lo.y; y <= hi.y; y++ ){
+                for( int z = lo.z; z <= hi.z; z++ ){
+                    CellMap::const_iterator it = _cells.find( Cell( x, y, z ) );
+                    if( it == _cells.end() )
+                        continue;
+
+                    const std::vector<size_t>& cell = it->second;
+                    for( size_t i = 0; i < cell.size(); i++ ){
+                        Vector3d d = _centers[ cell[ i ] ] - center;
+                        if( d.lengthSqr() < r2 )
+                            ids.push_back( cell[ i ] );
+                    }
+                }
+            }
+        }
+        std::sort( ids.begin(), ids.end() );
+    }
+}
+
+#endif
@@ -23,8 +23,8 @@
 */
 
 #include <cvt/vision/slam/SlamMap.h>
-
-#include <set>
+#include <cvt/util/EigenBridge.h>
+#include <cvt/util/SIMD.h>
 
 namespace cvt
 {
@@ -42,12 +42,31 @@ namespace cvt
         _keyframes.clear();
         _features.clear();
         _numMeas = 0;
+        _index.invalidate();
+    }
+
+    void SlamMap::mergeEstimates( const SlamMap& snapshot )
+    {
+        if( snapshot.numKeyframes() > numKeyframes() || snapshot.numFeatures() > numFeatures() )
+            throw CVTException( "Snapshot does not belong to this map" );
+
+        for( size_t i = 0; i < snapshot.numKeyframes(); i++ )
+            _keyframes[ i ].setPose( snapshot._keyframes[ i ].pose().transformation() );
+        _index.invalidate();
+
+        for( size_t i = 0; i < snapshot.numFeatures(); i++ ){
+            MapFeature& f = _features[ i ];
+            f.estimate() = snapshot._features[ i ].estimate();
+            f.covariance() = snapshot._features[ i ].covariance();
+        }
     }
 
     size_t SlamMap::addKeyframe( const Eigen::Matrix4d& pose )
     {
         size_t id = _keyframes.size();
         _keyframes.push_back( Keyframe( pose, id ) );
+        if( _index.valid )
+            _index.dirty.push_back( id );
         return id;
     }
 
@@ -91,62 +110,103 @@ namespace cvt
         return kf;
     }
 
+    static inline Vector3d cameraCenter( const Eigen::Matrix4d& pose )
+    {
+        // keyframe poses map world to camera: c = -R^T t
+        Eigen::Vector3d c = -pose.block<3, 3>( 0, 0 ).transpose() * pose.block<3, 1>( 0, 3 );
+        return Vector3d( c[ 0 ], c[ 1 ], c[ 2 ] );
+    }
+
+    void SlamMap::updateIndex( double cellSize ) const
+    {
+        if( !_index.valid ){
+            _index.grid.clear();
+            _index.grid.setCellSize( cellSize );
+            for( size_t i = 0; i < _keyframes.size(); i++ )
+                _index.grid.set( i, cameraCenter( _keyframes[ i ].pose().transformation() ) );
+            _index.dirty.clear();
+            _index.valid = true;
+            return;
+        }
+
+        _index.grid.setCellSize( cellSize );
+        for( size_t i = 0; i < _index.dirty.size(); i++ ){
+            size_t id = _index.dirty[ i ];
+            _index.grid.set( id, cameraCenter( _keyframes[ id ].pose().transformation() ) );
+        }
+        _index.dirty.clear();
+    }
+
     void SlamMap::selectVisibleFeatures( std::vector<size_t> & visibleFeatureIds,
                                          std::vector<Vector2f> & projections,
                                          const Eigen::Matrix4d&	cameraPose /* this is the rig pose*/,
                                          const CameraCalibration& camCalib,
                                          double maxDistance ) const
     {
-        Eigen::Vector4d pointInCam;
-        Vector4f pic;
-        Vector4f sp;
-        Vector2f pointInScreen;
-
-        // this is a hack: we should store the image width/height with the calibration object!
-        size_t w = camCalib.width();
-        size_t h = camCalib.height();
+        // the distance of a keyframe to the camera is the distance of the camera centers
+        std::vector<size_t> keyframeIds;
+        Vector3d center = cameraCenter( cameraPose );
+        updateIndex( maxDistance );
+        _index.grid.query( keyframeIds, center, maxDistance );
+
+        // a feature is collected once per query: stamp it with the current epoch
+        if( _index.stamps.size() < _features.size() )
+            _index.stamps.resize( _features.size(), 0 );
+        if( ++_index.epoch == 0 ){
+            std::fill( _index.stamps.begin(), _index.stamps.end(), 0 );
+            _index.epoch = 1;
+        }
 
-        std::set<size_t> usedPoints;
-        for( size_t i = 0; i < _keyframes.size(); i++ ){
-            double kfDistance = _keyframes[ i ].distance( cameraPose );
-            if( kfDistance < maxDistance ){
-                // check if the points of this keyframe project to this camera
-                const Keyframe& kf = _keyframes[ i ];
-
-                Keyframe::MeasurementIterator iter = kf.measurementsBegin();
-                const Keyframe::MeasurementIterator measEnd = kf.measurementsEnd();
-
-                while( iter != measEnd ){
-                    size_t fId = iter->first;
-                    const MapFeature& feature = _features[ fId ];
-
-                    if( usedPoints.find( fId ) == usedPoints.end() ){
-                        pointInCam = cameraPose * feature.estimate();
-                        pointInCam /= pointInCam[ 3 ];
-
-                        if( pointInCam[ 2 ] > 0.0 ){
-                            pic[ 0 ] = ( float )pointInCam[ 0 ];
-                            pic[ 1 ] = ( float )pointInCam[ 1 ];
-                            pic[ 2 ] = ( float )pointInCam[ 2 ];
-                            pic[ 3 ] = ( float )pointInCam[ 3 ];
-
-                            // project it to the screen:
-                            sp = camCalib.projectionMatrix() * pic;
-                            pointInScreen.x = sp.x / sp.z;
-                            pointInScreen.y = sp.y / sp.z;
-
-                            if( pointInScreen.x > 0 &&
-                                pointInScreen.x < w &&
-                                pointInScreen.y > 0 &&
-                                pointInScreen.y < h ){
-                                usedPoints.insert( fId );
-                                visibleFeatureIds.push_back( fId );
-                                projections.push_back( pointInScreen );
-                            }
-                        }
-                    }
-                    ++iter;
+        std::vector<size_t>   candidates;
+        std::vector<Vector3f> points;
+        for( size_t i = 0; i < keyframeIds.size(); i++ ){
+            const Keyframe& kf = _keyframes[ keyframeIds[ i ] ];
+
+            Keyframe::MeasurementIterator iter = kf.measurementsBegin();
+            const Keyframe::MeasurementIterator measEnd = kf.measurementsEnd();
+            while( iter != measEnd ){
+                size_t fId = iter->first;
+                if( _index.stamps[ fId ] != _index.epoch ){
+                    _index.stamps[ fId ] = _index.epoch;
+                    const Eigen::Vector4d& p = _features[ fId ].estimate();
+                    candidates.push_back( fId );
+                    // relative to the camera center to keep float precision far from the origin
+                    points.push_back( Vector3f( p[ 0 ] / p[ 3 ] - center.x,
+                                                p[ 1 ] / p[ 3 ] - center.y,
+                                                p[ 2 ] / p[ 3 ] - center.z ) );
                 }
+                ++iter;
+            }
+        }
+
+        size_t n = candidates.size();
+        if( !n )
+            return;
+
+        // transform and project the local map in one pass each
+        Matrix4f pose;
+        EigenBridge::toCVT( pose, cameraPose );
+        pose[ 0 ][ 3 ] = pose[ 1 ][ 3 ] = pose[ 2 ][ 3 ] = 0.0f;
+        std::vector<Vector3f> pointsInCam( n );
+        std::vector<Vector2f> pointsInScreen( n );
+
+        SIMD* simd = SIMD::instance();
+        simd->transformPoints( &pointsInCam[ 0 ], pose, &points[ 0 ], n );
+        simd->projectPoints( &pointsInScreen[ 0 ], camCalib.projectionMatrix(), &pointsInCam[ 0 ], n );
+
+        // this is a hack: we should store the image width/height with the calibration object!
+        float w = camCalib.width();
+        float h = camCalib.height();
+
+        for( size_t i = 0; i < n; i++ ){
+            const Vector2f& pointInScreen = pointsInScreen[ i ];
+            if( pointsInCam[ i ].z > 0.0f &&
+                pointInScreen.x > 0 &&
+                pointInScreen.x < w &&
+                pointInScreen.y > 0 &&
+                pointInScreen.y < h ){
+                visibleFeatureIds.push_back( candidates[ i ] );
+                projections.push_back( pointInScreen );
             }
         }
     }
@@ -156,6 +216,7 @@ namespace cvt
         if( node->name() != "SlamMap" ){
             throw CVTException( "This is not a SlamMap node" );
         }
+        _index.invalidate();
 
         // get intrinsics:
         Matrix3d K;
@@ -28,12 +28,17 @@
 #include <cvt/vision/CameraCalibration.h>
 #include <cvt/vision/slam/Keyframe.h>
 #include <cvt/vision/slam/MapFeature.h>
+#include <cvt/vision/slam/CowVector.h>
+#include <cvt/vision/slam/KeyframeGrid.h>
 #include <cvt/io/xml/XMLSerializable.h>
 
-#include <Eigen/StdVector>
-
 namespace cvt
 {
+   /**
+    *	Keyframes and features are stored copy-on-write: copying a SlamMap is cheap
+    *	and yields a snapshot that can be modified (e.g. optimized) in another
+    *	thread while the original keeps growing.
+    */
    class SlamMap : public XMLSerializable
    {
       public:
@@ -43,6 +48,13 @@ namespace cvt
 
          void clear();
 
+         /**
+          *	\brief	copy the keyframe poses and feature estimates of a snapshot into this map
+          *	\param	snapshot	a copy of this map taken earlier, e.g. after optimizing it.
+          *						Keyframes and features added since the copy are left untouched.
+          */
+         void mergeEstimates( const SlamMap& snapshot );
+
         /**
          *	\brief		add a new keyframe to the map
          *	\param pose	the pose of the keyframe in the map: TODO: should be KF to world <- verify
@@ -87,6 +99,10 @@ namespace cvt
           *	\param	cameraPose		    pose of the camera
           *	\param	camCalib			calibration of the camera
           *	\param	maxDistance			maximum distance of keyframes that are taken into account for projection
+          *
+          *	Only the keyframes found in the spatial index are visited, the costs are bounded by the
+          *	size of the local map. The index is kept in the map, concurrent queries on the same map
+          *	are not allowed.
           */
 		 void   selectVisibleFeatures( std::vector<size_t>& visibleFeatureIds,
 									   std::vector<Vector2f>& projections,
@@ -97,7 +113,8 @@ namespace cvt
          const MapFeature&		featureForId( size_t id ) const  { return _features[ id ];}
 		 MapFeature&			featureForId( size_t id )		 { return _features[ id ];}
 		 const Keyframe&		keyframeForId( size_t id ) const { return _keyframes[ id ];}
-         Keyframe&				keyframeForId( size_t id )		 { return _keyframes[ id ];}
+         /* marks the keyframe for reindexing, use the const overload for read-only access */
+         Keyframe&				keyframeForId( size_t id )		 { markDirty( id ); return _keyframes[ id ];}
 		 const Eigen::Matrix3d&	intrinsics() const { return _intrinsics; }
          void setIntrinsics( const Eigen::Matrix3d & K ) { _intrinsics = K; }
 
@@ -115,14 +132,52 @@ namespace cvt
          void saveBinary( const cvt::String& filename ) const;
 
       private:
-		 typedef std::vector<Keyframe, Eigen::aligned_allocator<Keyframe> > KeyframeVectorType;
-         typedef std::vector<MapFeature, Eigen::aligned_allocator<MapFeature> > MapFeatureVectorType;
+		 typedef CowVector<Keyframe, 16>		KeyframeVectorType;
+         typedef CowVector<MapFeature, 256>	MapFeatureVectorType;
 
 		 KeyframeVectorType		_keyframes;
 		 MapFeatureVectorType	_features;
 		 Eigen::Matrix3d		_intrinsics;
          size_t					_numMeas;
+
+         /* keyframe grid and per feature visit stamps, not shared between copies */
+         struct SpatialIndex {
+             SpatialIndex() : epoch( 0 ), valid( false ) {}
+             SpatialIndex( const SpatialIndex& ) : epoch( 0 ), valid( false ) {}
+             SpatialIndex& operator=( const SpatialIndex& ) { invalidate(); return *this; }
+
+             void invalidate()
+             {
+                 grid.clear();
+                 dirty.clear();
+                 stamps.clear();
+                 epoch = 0;
+                 valid = false;
+             }
+
+             KeyframeGrid			grid;
+             std::vector<size_t>	dirty;
+             std::vector<uint32_t>	stamps;
+             uint32_t				epoch;
+             bool					valid;
+         };
+
+         void markDirty( size_t kfId );
+         void updateIndex( double cellSize ) const;
+
+         mutable SpatialIndex	_index;
    };
+
+   inline void SlamMap::markDirty( size_t kfId )
+   {
+       // the pose may be changed through the returned reference
+       if( !_index.valid || ( !_index.dirty.empty() && _index.dirty.back() == kfId ) )
+           return;
+       if( _index.dirty.size() < _keyframes.size() )
+           _index.dirty.push_back( kfId );
+       else
+           _index.invalidate();
+   }
 }
 
 #endif
@@ -0,0 +1,135 @@
+/*
+   The MIT License (MIT)
+
+   Copyright (c) 2011 - 2013, Philipp Heise and Sebastian Klose
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+   THE SOFTWARE.
+*/
+
+#include <cvt/util/CVTTest.h>
+#include <cvt/vision/slam/SlamMap.h>
+
+namespace cvt {
+
+	static void fillMap( SlamMap& map, size_t numKF, size_t numFeatures )
+	{
+		MapMeasurement mm;
+		mm.point.setZero();
+		mm.information.setIdentity();
+
+		for( size_t i = 0; i < numKF; i++ ){
+			Eigen::Matrix4d pose( Eigen::Matrix4d::Identity() );
+			pose( 0, 3 ) = i;
+			map.addKeyframe( pose );
+		}
+
+		for( size_t i = 0; i < numFeatures; i++ ){
+			MapFeature mf( Eigen::Vector4d( i, 0, 1, 1 ), Eigen::Matrix4d::Identity() );
+			map.addFeatureToKeyframe( mf, mm, i % numKF );
+		}
+	}
+
+BEGIN_CVTTEST( SlamMap )
+	bool ret = true;
+	bool b;
+
+	SlamMap map;
+	fillMap( map, 40, 1000 );
+
+	// modifying the head must not change the snapshot and vice versa
+	SlamMap snapshot( map );
+	Eigen::Matrix4d pose( Eigen::Matrix4d::Identity() );
+	pose( 1, 3 ) = 5.0;
+	snapshot.keyframeForId( 3 ).setPose( pose );
+	snapshot.featureForId( 700 ).estimate()[ 1 ] = 2.0;
+	fillMap( map, 5, 10 );
+
+	b = ( map.keyframeForId( 3 ).pose().transformation()( 1, 3 ) == 0.0 );
+	b &= ( map.featureForId( 700 ).estimate()[ 1 ] == 0.0 );
+	b &= ( snapshot.numKeyframes() == 40 && snapshot.numFeatures() == 1000 );
+	b &= ( map.numKeyframes() == 45 && map.numFeatures() == 1010 );
+	b &= ( snapshot.keyframeForId( 3 ).pose().transformation()( 1, 3 ) == 5.0 );
+	CVTTEST_PRINT( "snapshot isolation", b );
+	ret &= b;
+
+	// merging writes back the snapshot estimates, keeps the new data
+	map.mergeEstimates( snapshot );
+	b = ( map.keyframeForId( 3 ).pose().transformation()( 1, 3 ) == 5.0 );
+	b &= ( map.featureForId( 700 ).estimate()[ 1 ] == 2.0 );
+	b &= ( map.keyframeForId( 42 ).pose().transformation()( 0, 3 ) == 2.0 );
+	b &= ( map.numMeasurements() == 1010 );
+	CVTTEST_PRINT( "mergeEstimates", b );
+	ret &= b;
+
+	// only features of keyframes close to the camera are predicted
+	CameraCalibration calib;
+	calib.setIntrinsics( Matrix3f( 500.0f, 0.0f, 320.0f, 0.0f, 500.0f, 240.0f, 0.0f, 0.0f, 1.0f ) );
+	calib.setWidth( 640 );
+	calib.setHeight( 480 );
+
+	SlamMap local;
+	MapMeasurement mm;
+	mm.point.setZero();
+	mm.information.setIdentity();
+	for( size_t i = 0; i < 10; i++ ){
+		// world to camera, camera center at ( 10 * i, 0, 0 )
+		Eigen::Matrix4d kfPose( Eigen::Matrix4d::Identity() );
+		kfPose( 0, 3 ) = -10.0 * i;
+		size_t kf = local.addKeyframe( kfPose );
+		local.addFeatureToKeyframe( MapFeature( Eigen::Vector4d( 10.0 * i, 0.1, 2.0, 1.0 ), Eigen::Matrix4d::Identity() ), mm, kf );
+		local.addFeatureToKeyframe( MapFeature( Eigen::Vector4d( 10.0 * i, 0.0, -2.0, 1.0 ), Eigen::Matrix4d::Identity() ), mm, kf );
+	}
+
+	std::vector<size_t> ids;
+	std::vector<Vector2f> proj;
+	Eigen::Matrix4d camPose( Eigen::Matrix4d::Identity() );
+	camPose( 0, 3 ) = -41.0;
+	local.selectVisibleFeatures( ids, proj, camPose, calib, 3.0 );
+	b = ( ids.size() == 1 && ids[ 0 ] == 8 );
+	b &= ( proj.size() == 1 && Math::abs( proj[ 0 ].x - 70.0f ) < 1e-3f && Math::abs( proj[ 0 ].y - 265.0f ) < 1e-3f );
+
+	// moving a keyframe through the reference updates the index
+	Eigen::Matrix4d moved( Eigen::Matrix4d::Identity() );
+	moved( 0, 3 ) = -40.0;
+	local.keyframeForId( 0 ).setPose( moved );
+	local.featureForId( 0 ).estimate() = Eigen::Vector4d( 40.5, 0.0, 2.0, 1.0 );
+	ids.clear();
+	proj.clear();
+	local.selectVisibleFeatures( ids, proj, camPose, calib, 3.0 );
+	b &= ( ids.size() == 2 && ids[ 0 ] == 0 && ids[ 1 ] == 8 );
+
+	// a zero distance selects nothing and leaves the index usable
+	ids.clear();
+	proj.clear();
+	local.selectVisibleFeatures( ids, proj, camPose, calib, 0.0 );
+	b &= ids.empty() && proj.empty();
+	local.selectVisibleFeatures( ids, proj, camPose, calib, 3.0 );
+	b &= ( ids.size() == 2 && ids[ 0 ] == 0 && ids[ 1 ] == 8 );
+
+	KeyframeGrid grid( 0.0 );
+	grid.set( 0, Vector3d( 100.0, -20.0, 3.0 ) );
+	grid.query( ids, Vector3d( 100.0, -20.0, 3.0005 ), 0.001 );
+	b &= grid.cellSize() > 0.0 && ids.size() == 1 && ids[ 0 ] == 0;
+	CVTTEST_PRINT( "selectVisibleFeatures", b );
+	ret &= b;
+
+	return ret;
+END_CVTTEST
+
+}
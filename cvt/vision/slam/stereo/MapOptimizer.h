@@ -30,24 +30,57 @@
 
 namespace cvt
 {
+    /**
+     *	\brief	bundle adjusts a snapshot of a SlamMap in a background thread
+     *
+     *	The caller keeps extending its map while the snapshot is optimized, the
+     *	result is written back with mergeResult from the thread owning the map.
+     */
     class MapOptimizer : public Thread<SlamMap>
     {
         public:
             MapOptimizer();
             ~MapOptimizer();
 
+            /**
+             *	\brief	start optimizing a snapshot of map
+             *	\return	false if the previous optimization has not been merged yet
+             */
+            bool optimize( const SlamMap& map );
+
+            /**
+             *	\brief	merge the optimized poses and points into map, if available
+             *	\return	true if a result has been merged, false if the optimization
+             *			is still running or has failed - a failed run is dropped
+             */
+            bool mergeResult( SlamMap& map );
+
+            /* wait for a running optimization and drop its result */
+            void cancel();
+
             void execute( SlamMap* map );
             bool isRunning() const;
 
             void setMaxIterations( size_t iters ) { _termCrit.setMaxIterations( iters ); }
 
-        private:            
+        private:
+            enum State {
+                IDLE,
+                RUNNING,
+                FINISHED,
+                FAILED
+            };
+
+            State state() const { return ( State )__sync_add_and_fetch( ( int* )&_state, 0 ); }
+            void  setState( State s ) { __sync_synchronize(); __sync_lock_test_and_set( &_state, ( int )s ); }
+
             TerminationCriteria<double>	_termCrit;
-            bool						_isRunning;
+            SlamMap						_snapshot;
+            volatile int				_state;
     };
 
     inline MapOptimizer::MapOptimizer() :
-        _isRunning( false )
+        _state( IDLE )
     {
         _termCrit.setCostThreshold( 0.1 );
         _termCrit.setMaxIterations( 5 );
@@ -55,21 +88,63 @@ namespace cvt
 
     inline MapOptimizer::~MapOptimizer()
     {
-        if( _isRunning )
-            join();
+        cancel();
+    }
+
+    inline bool MapOptimizer::optimize( const SlamMap& map )
+    {
+        if( state() == FAILED )
+            cancel();
+        if( state() != IDLE )
+            return false;
+
+        _snapshot = map;
+        setState( RUNNING );
+        run( &_snapshot );
+        return true;
+    }
+
+    inline bool MapOptimizer::mergeResult( SlamMap& map )
+    {
+        if( state() == FAILED )
+            cancel();
+        if( state() != FINISHED )
+            return false;
+
+        join();
+        map.mergeEstimates( _snapshot );
+        _snapshot.clear();
+        setState( IDLE );
+        return true;
+    }
+
+    inline void MapOptimizer::cancel()
+    {
+        if( state() == IDLE )
+            return;
+
+        join();
+        _snapshot.clear();
+        setState( IDLE );
     }
 
     inline void MapOptimizer::execute( SlamMap* map )
     {
-        SparseBundleAdjustment sba;
-        _isRunning = true;
-        sba.optimize( *map, _termCrit );
-        _isRunning = false;
+        try {
+            SparseBundleAdjustment sba;
+            sba.optimize( *map, _termCrit );
+        } catch( ... ) {
+            // nothing may escape the thread, drop the snapshot and let the owner reset the state
+            map->clear();
+            setState( FAILED );
+            return;
+        }
+        setState( FINISHED );
     }
 
     inline bool MapOptimizer::isRunning() const
     {
-        return _isRunning;
+        return state() == RUNNING;
     }
 }
 
@@ -73,6 +73,11 @@ namespace cvt
         CVT_ASSERT( imgLeftGray.format() == IFormat::GRAY_UINT8, "INPUT IMAGES NEED TO BE GRAY_UINT8" );
         CVT_ASSERT( imgRightGray.format() == IFormat::GRAY_UINT8, "INPUT IMAGES NEED TO BE GRAY_UINT8" );
 
+        // pull in the result of the last bundle adjustment, the tracking below
+        // is relative to the active keyframe and follows the corrected map
+        if( _bundler.mergeResult( _map ) )
+            mapChanged.notify( _map );
+
         // prepare debug image
         imgLeftGray.convert( _debugMono, IFormat::RGBA_UINT8 );
 
@@ -92,7 +97,7 @@ namespace cvt
         Eigen::Matrix4d poseEigen = _pose.transformation().cast<double>();
 
         if( _activeKF > -1 ){
-            Eigen::Matrix4d kfPose = _map.keyframeForId( _activeKF ).pose().transformation();
+            Eigen::Matrix4d kfPose = static_cast<const SlamMap&>( _map ).keyframeForId( _activeKF ).pose().transformation();
             // transform the relative pose into
             poseEigen = _keyframeRelativePose * kfPose;
         }
@@ -154,7 +159,7 @@ namespace cvt
         }
 
         // update relative pose:
-        Eigen::Matrix4d kfPose = _map.keyframeForId( _activeKF ).pose().transformation();
+        Eigen::Matrix4d kfPose = static_cast<const SlamMap&>( _map ).keyframeForId( _activeKF ).pose().transformation();
 
         std::cout << "Keyframe Pose: " << kfPose << std::endl;
         // transform the relative pose into
@@ -438,8 +443,7 @@ namespace cvt
 
    void StereoSLAM::clear()
    {
-      if( _bundler.isRunning() )
-         _bundler.join();
+      _bundler.cancel();
 
       _map.clear();
 
@@ -466,11 +470,6 @@ namespace cvt
 		  std::cout << "Could only triangulate " << newPoints3d.size() << " new features " << std::endl;
 		  return;
 	  }
-	  // wait until current ba thread is ready
-	  if( _bundler.isRunning() ){
-		  _bundler.join();
-	  }
-
 	  keyframeAdded.notify();
 	  mapChanged.notify( _map );
 	  std::cout << "Triangulated: " << newPoints3d.size() << std::endl;
@@ -517,9 +516,10 @@ namespace cvt
        /* bundle adjust */
        static size_t lastNKF = 0;
        if( _params.useSBA && ( _map.numKeyframes() - lastNKF ) > _params.sbaDeltaKeyframes ){
+           // the optimizer works on a snapshot, if it is still busy try again with the next keyframe
            _bundler.setMaxIterations( _params.sbaIterations );
-           lastNKF = _map.numKeyframes();
-           _bundler.run( &_map );
+           if( _bundler.optimize( _map ) )
+               lastNKF = _map.numKeyframes();
        }
    }
 